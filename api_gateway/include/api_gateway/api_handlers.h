@@ -33,6 +33,7 @@ typedef struct api_request_tracker_t {
     int target_floor_for_task;                  /**< The floor the assigned elevator should go to. */
     char requesting_elevator_id_cabin[ID_STRING_MAX_LEN]; /**< For cabin requests: ID of the elevator. */
     movement_direction_enum_t requested_direction_floor; /**< For floor calls: UP/DOWN. */
+    uint16_t building_index;                    /**< Building the request belongs to (see building_registry.h). */
 
     // Potentially other fields like timestamp, retry count, etc.
 } api_request_tracker_t;
@@ -41,10 +42,21 @@ typedef struct api_request_tracker_t {
 // Esto evita tener que incluir coap_session.h y coap_net.h aquí si no son necesarios para otras declaraciones.
 struct coap_session_t;
 struct coap_context_t;
+struct gw_tracker_slot_t; // Definido en request_tracker.h
 
 // Declaración de la función helper para la gestión de sesiones DTLS (definida en main.c)
 coap_session_t* get_or_create_central_server_dtls_session(struct coap_context_t *ctx);
 
+/**
+ * @brief Aplica una recarga de configuración pedida con SIGHUP
+ *
+ * Ajusta el tiempo de vida de los trackers y, si cambió la dirección del
+ * servidor central, libera la sesión DTLS para que la siguiente solicitud
+ * abra una nueva. Compartida por los dos puntos de entrada (main.c y
+ * main_dynamic_port.c); se llama desde el bucle principal.
+ */
+void gw_apply_pending_config_reload(void);
+
 // --- Signal Handler ---
 /**
  * @brief Manejador de señal para SIGINT (Ctrl+C)
@@ -78,6 +90,32 @@ coap_response_t hnd_central_server_response_gw(coap_session_t *session_from_serv
                                              const coap_pdu_t *received_from_central,
                                              const coap_mid_t mid_from_server);
 
+/**
+ * @brief Manejador de NACKs para solicitudes al servidor central
+ * @param session Sesión CoAP por la que se envió la solicitud
+ * @param sent PDU enviado que no obtuvo respuesta
+ * @param reason Motivo del NACK
+ * @param mid Message ID del PDU enviado
+ * 
+ * Libera el tracker de una solicitud que ya no recibirá respuesta.
+ * 
+ * @see request_tracker.h
+ */
+void hnd_central_server_nack_gw(coap_session_t *session,
+                                const coap_pdu_t *sent,
+                                const coap_nack_reason_t reason,
+                                const coap_mid_t mid);
+
+/**
+ * @brief Notifica el abandono de una solicitud sin respuesta
+ * @param slot Slot del tracker expirado o rechazado (no se libera aquí)
+ * 
+ * Callback para gw_tracker_expire(); también lo usa el manejador de NACKs.
+ * 
+ * @see request_tracker.h
+ */
+void hnd_tracker_timeout_gw(struct gw_tracker_slot_t *slot);
+
 // --- Resource Handlers (for requests FROM Clients TO Gateway) ---
 
 /**
@@ -0,0 +1,104 @@
+/**
+ * @file building_registry.h
+ * @brief Registro de edificios gestionados por un único proceso API Gateway
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Un mismo proceso puede gestionar varios grupos de ascensores
+ * (elevator_group_state_t), uno por edificio. Cada edificio se identifica
+ * por un índice estable (0..GW_MAX_BUILDINGS-1) que acompaña a:
+ * - Los frames CAN (simulated_can_frame_t::building_index)
+ * - Los trackers de solicitudes al servidor central
+ * - La serialización JSON del estado enviada al servidor central
+ *
+ * Todos los edificios comparten el contexto CoAP y la sesión DTLS con el
+ * servidor central, evitando un handshake, una carga de claves PSK y un
+ * logger por edificio.
+ *
+ * El índice 0 corresponde siempre a @c managed_elevator_group, de modo que
+ * el código y las pruebas que trabajan con un único edificio no cambian.
+ *
+ * @see elevator_state_manager.h
+ * @see can_bridge.h
+ */
+#ifndef BUILDING_REGISTRY_H
+#define BUILDING_REGISTRY_H
+
+#include <stdint.h>
+#include "api_gateway/elevator_state_manager.h"
+#include "api_gateway/hall_call_registry.h"
+
+#ifndef GW_MAX_BUILDINGS
+/**
+ * @brief Número máximo de edificios por proceso
+ *
+ * Puede redefinirse en tiempo de compilación (-DGW_MAX_BUILDINGS=N).
+ */
+#define GW_MAX_BUILDINGS 128
+#endif
+
+/**
+ * @brief Índice del edificio por defecto (managed_elevator_group)
+ */
+#define GW_BUILDING_INDEX_DEFAULT 0
+
+/**
+ * @brief Reinicia el registro dejándolo sin edificios
+ *
+ * Libera los grupos de los edificios con índice > 0. El grupo del índice 0
+ * (managed_elevator_group) es estático: solo se liberan sus tablas.
+ */
+void gw_building_registry_init(void);
+
+/**
+ * @brief Libera todos los edificios registrados (equivalente a gw_building_registry_init)
+ */
+void gw_building_registry_cleanup(void);
+
+/**
+ * @brief Registra (o reinicializa) un edificio
+ * @param edificio_id ID del edificio (ej: "E1")
+ * @param num_elevadores Número de ascensores del edificio
+ * @param num_pisos Número de pisos del edificio
+ * @return Índice del edificio, o -1 si el registro está lleno o falla la memoria
+ *
+ * Si ya existe un edificio con ese ID se reinicializa su grupo y se
+ * devuelve su índice. El primer edificio registrado ocupa el índice 0.
+ */
+int gw_building_add(const char *edificio_id, int num_elevadores, int num_pisos);
+
+/**
+ * @brief Obtiene el grupo de ascensores de un edificio
+ * @param building_index Índice devuelto por gw_building_add()
+ * @return Puntero al grupo, o NULL si el índice no está registrado
+ *
+ * Si no se ha registrado ningún edificio, el índice 0 devuelve igualmente
+ * managed_elevator_group para conservar el comportamiento de un solo edificio.
+ */
+elevator_group_state_t* gw_building_get(uint16_t building_index);
+
+/**
+ * @brief Obtiene la tabla de llamadas de piso de un edificio
+ * @param building_index Índice devuelto por gw_building_add()
+ * @return Puntero a la tabla, o NULL si el índice no está registrado
+ *
+ * La tabla se vacía cada vez que el edificio se (re)inicializa con
+ * gw_building_add().
+ */
+gw_hall_call_table_t* gw_building_hall_calls(uint16_t building_index);
+
+/**
+ * @brief Busca un edificio por su ID
+ * @param edificio_id ID del edificio
+ * @return Índice del edificio, o -1 si no está registrado
+ */
+int gw_building_find(const char *edificio_id);
+
+/**
+ * @brief Número de edificios registrados
+ * @return Edificios en el registro (al menos 1 si solo se usa managed_elevator_group)
+ */
+uint16_t gw_building_count(void);
+
+#endif // BUILDING_REGISTRY_H
@@ -21,8 +21,9 @@
  * - 0x200: Solicitudes de cabina (cabin requests) con destino
  * - 0x300: Notificaciones de llegada de ascensores
  * 
- * El puente mantiene un buffer circular de trackers para correlacionar
- * respuestas del servidor central con las solicitudes CAN originales.
+ * Las solicitudes CAN pendientes se registran en el slab unificado de
+ * trackers (request_tracker.h) para correlacionar las respuestas del
+ * servidor central con los frames CAN originales.
  * 
  * @see can_bridge.c
  * @see elevator_state_manager.h
@@ -43,28 +44,41 @@
  * 
  * Representa un frame CAN estándar con ID, datos y longitud.
  * Utilizada para la comunicación entre el simulador de ascensores
- * y el API Gateway.
+ * y el API Gateway. El índice de edificio indica a qué grupo de
+ * ascensores del proceso pertenece el frame.
  */
 typedef struct {
     uint32_t id;      ///< CAN ID (identificador del mensaje)
     uint8_t data[8]; ///< Datos CAN (hasta 8 bytes según estándar CAN)
     uint8_t dlc;     ///< Data Length Code (0-8, número de bytes válidos)
+    uint16_t building_index; ///< Edificio de origen/destino (building_registry.h, 0 = por defecto)
 } simulated_can_frame_t;
 
+/**
+ * @brief Valor de data[0] en un frame 0x101 que confirma una llamada de piso
+ *        ya registrada pero aún sin ascensor asignado
+ *
+ * Se envía (DLC 1) cuando una pulsación repetida se absorbe en la solicitud
+ * en vuelo al servidor central; la asignación llegará después en otro 0x101
+ * con el índice real del ascensor. Ningún grupo alcanza 255 ascensores.
+ */
+#define GW_CAN_ELEVATOR_PENDING 0xFF
+
 /**
  * @brief Tracker para correlacionar solicitudes CAN con respuestas CoAP
  * 
- * Estructura utilizada para asociar un token CoAP de una solicitud
- * enviada al servidor central con la información original del frame CAN
- * que la originó. Permite correlacionar respuestas para enviar
- * confirmaciones apropiadas vía CAN.
+ * Estructura que guarda la información original del frame CAN que
+ * originó una solicitud al servidor central. Se almacena en un slot del
+ * slab de trackers; el token CoAP de la solicitud identifica ese slot,
+ * por lo que no se guarda aquí.
  */
 typedef struct {
-    coap_binary_t coap_token;        ///< Token de la solicitud CoAP enviada al servidor central
     uint32_t original_can_id;        ///< ID del frame CAN original que originó la solicitud
+    uint16_t building_index;         ///< Edificio del frame original (building_registry.h)
     gw_request_type_t request_type;  ///< Tipo de solicitud original (floor call, cabin request)
     int target_floor_for_task;       ///< Piso destino de la tarea asignada
     int call_reference_floor;        ///< Piso origen de la llamada (para floor calls)
+    movement_direction_enum_t requested_direction; ///< Dirección solicitada (para floor calls)
     char requesting_elevator_id_if_cabin[ID_STRING_MAX_LEN]; ///< ID del ascensor si fue cabin request
 } can_origin_tracker_t;
 
@@ -161,25 +175,37 @@ void ag_can_bridge_register_send_callback(can_send_callback_t callback);
  *       el esquema específico del sistema de ascensores
  * 
  * @see forward_can_originated_request_to_central_server()
- * @see store_can_tracker()
+ * @see gw_tracker_alloc()
  * @see simulated_can_frame_t
  */
 void ag_can_bridge_process_incoming_frame(simulated_can_frame_t* frame, struct coap_context_t *coap_context);
 
+/**
+ * @brief Vuelve a enviar al servidor central una solicitud de origen CAN
+ * @param coap_context Contexto CoAP del gateway
+ * @param request Datos de la solicitud original (edificio, ID CAN, tipo, pisos)
+ * 
+ * Genera la misma solicitud que produjo el frame original con un tracker
+ * nuevo; la respuesta llega al bus como la de cualquier otro frame. Se usa
+ * para reanudar las solicitudes que estaban en vuelo antes de un reinicio
+ * (ver state_store.h).
+ */
+void ag_can_bridge_resubmit_request(struct coap_context_t *coap_context, const can_origin_tracker_t *request);
+
 /**
  * @brief Busca un tracker de origen CAN basado en un token CoAP
  * @param token El token CoAP de la respuesta recibida del servidor central
  * @return Puntero al can_origin_tracker_t si se encuentra, NULL en caso contrario
  * 
- * Esta función busca en el buffer circular de trackers CAN un tracker
- * que corresponda al token CoAP especificado. Se utiliza para correlacionar
- * respuestas del servidor central con solicitudes CAN originales.
+ * Esta función localiza el tracker CAN que corresponde al token CoAP
+ * especificado. Se utiliza para correlacionar respuestas del servidor
+ * central con solicitudes CAN originales.
  * 
  * **Características de la búsqueda:**
- * - Comparación binaria exacta del token (longitud + contenido)
- * - Búsqueda lineal en buffer circular
- * - No remueve el tracker de la lista (a diferencia de find_and_remove_central_request_tracker)
- * - Thread-safe para lecturas concurrentes
+ * - O(1): el token codifica índice de slot y generación
+ * - Tokens de solicitudes ya liberadas no coinciden (generación distinta)
+ * - Solo devuelve trackers de origen CAN
+ * - No libera el slot (ver gw_tracker_release())
  * 
  * **Uso típico:**
  * 1. Se recibe respuesta del servidor central con token
@@ -187,7 +213,7 @@ void ag_can_bridge_process_incoming_frame(simulated_can_frame_t* frame, struct c
  * 3. Se extrae información del frame CAN original
  * 4. Se genera respuesta CAN apropiada
  * 
- * @see store_can_tracker()
+ * @see gw_tracker_lookup()
  * @see can_origin_tracker_t
  * @see ag_can_bridge_send_response_frame()
  */
@@ -228,4 +254,19 @@ can_origin_tracker_t* find_can_tracker(coap_bin_const_t token);
  */
 void ag_can_bridge_send_response_frame(uint32_t original_can_id, coap_pdu_code_t response_code, cJSON* server_response_json);
 
+/**
+ * @brief Envía una respuesta CAN dirigida al bus de un edificio concreto
+ * @param building_index Edificio al que pertenece el frame original
+ * @param original_can_id El ID del frame CAN original que originó esta respuesta
+ * @param response_code El código de respuesta CoAP recibido del servidor central
+ * @param server_response_json Respuesta JSON del servidor central (puede ser NULL)
+ * 
+ * Igual que ag_can_bridge_send_response_frame(), que equivale a esta
+ * función con el edificio por defecto (índice 0).
+ * 
+ * @see ag_can_bridge_send_response_frame()
+ * @see building_registry.h
+ */
+void ag_can_bridge_send_building_response_frame(uint16_t building_index, uint32_t original_can_id, coap_pdu_code_t response_code, cJSON* server_response_json);
+
 #endif // CAN_BRIDGE_H 
\ No newline at end of file
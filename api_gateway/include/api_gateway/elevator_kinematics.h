@@ -0,0 +1,121 @@
+/**
+ * @file elevator_kinematics.h
+ * @brief Simulación cinemática de las cabinas con paso de tiempo fijo
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Sustituye al paso de simulación que movía cada cabina un piso por
+ * iteración del bucle principal. Cada cabina tiene una posición y una
+ * velocidad continuas y sigue un perfil trapezoidal: acelera hasta la
+ * velocidad nominal y frena a tiempo para detenerse en el piso destino. Las
+ * puertas recorren ABRIENDO → ABIERTA → CERRANDO → CERRADA con duraciones
+ * configurables, y la cabina no arranca hasta tenerlas cerradas.
+ *
+ * **Paso fijo:** gw_kinematics_advance() recibe el reloj monotónico y
+ * ejecuta tantos pasos de GW_SIM_TICK_MS como hayan transcurrido, así que
+ * los tiempos simulados no dependen de lo rápido que gire el bucle de E/S
+ * ni de cuándo venza exactamente su temporizador.
+ *
+ * Las columnas del grupo (piso_actual, estado_puerta, direccion_movimiento,
+ * ocupado, destino_actual) siguen siendo el estado publicado: piso_actual
+ * es el piso más cercano a la cabina y cambia al cruzar la mitad de la
+ * altura entre pisos. La posición y la velocidad viven en este módulo.
+ * Si piso_actual cambia fuera del modelo (frame 0x300 del bus, estado
+ * restaurado), el siguiente paso coloca la cabina en ese piso, también en
+ * marcha, y limita su velocidad a la que aún permite frenar en el destino.
+ *
+ * Una tarea se completa cuando la cabina se detiene en su destino; en ese
+ * momento el ascensor queda libre para el servidor central y las puertas
+ * empiezan a abrirse.
+ *
+ * @see gateway_config.h (gw_sim_params_t)
+ * @see elevator_state_manager.h
+ */
+#ifndef ELEVATOR_KINEMATICS_H
+#define ELEVATOR_KINEMATICS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "api_gateway/elevator_state_manager.h"
+#include "api_gateway/gateway_config.h"
+
+/**
+ * @brief Pasos máximos recuperados en una llamada a gw_kinematics_advance()
+ *
+ * Si el proceso estuvo detenido más tiempo (depurador, suspensión), el
+ * tiempo sobrante se descarta en lugar de simularlo de golpe.
+ */
+#define GW_KINEMATICS_MAX_CATCHUP_STEPS 200
+
+/**
+ * @brief Estado cinemático de una cabina
+ */
+typedef struct {
+    double position_m;       ///< Altura sobre el piso 0
+    double velocity_mps;     ///< Velocidad con signo (> 0 subiendo)
+    int32_t door_timer_ms;   ///< Tiempo restante de la fase de puertas actual
+    int16_t floor;           ///< piso_actual que publicó el modelo (detecta cambios externos)
+} gw_car_motion_t;
+
+/**
+ * @brief Reinicia el módulo: descarta las cabinas y el tiempo acumulado
+ */
+void gw_kinematics_init(void);
+
+/**
+ * @brief Libera el estado de todas las cabinas
+ */
+void gw_kinematics_cleanup(void);
+
+/**
+ * @brief Avanza la simulación de todos los edificios hasta @p now_ms
+ * @param now_ms Reloj monotónico en milisegundos (gw_tracker_now_ms())
+ * @return Pasos fijos ejecutados
+ *
+ * La primera llamada solo fija el origen de tiempos. Usa el paso y los
+ * parámetros de gw_config().
+ */
+unsigned int gw_kinematics_advance(uint64_t now_ms);
+
+/**
+ * @brief Ejecuta un paso fijo sobre un edificio
+ * @param group Grupo de ascensores (debe estar en building_registry.h)
+ * @param params Parámetros del modelo
+ * @param dt_ms Duración del paso
+ * @param steps Pasos consecutivos a ejecutar
+ *
+ * Abre y cierra la sección de escritura del grupo una vez para todos los
+ * pasos.
+ */
+void gw_kinematics_step_group(elevator_group_state_t *group, const gw_sim_params_t *params,
+                              uint32_t dt_ms, unsigned int steps);
+
+/**
+ * @brief Consulta el estado cinemático de una cabina
+ * @param building_index Índice del edificio
+ * @param elevator_index Índice del ascensor en el grupo
+ * @param out Estado de la cabina
+ * @return false si la cabina aún no se ha simulado
+ */
+bool gw_kinematics_get_car(uint16_t building_index, int elevator_index, gw_car_motion_t *out);
+
+/**
+ * @brief Indica si un paso fijo dejaría el edificio sin cambios
+ * @param group Grupo de ascensores
+ * @return true si ninguna cabina tiene tarea, se mueve o tiene puertas sin cerrar
+ *
+ * Permite a un planificador de eventos discretos no programar pasos
+ * mientras el edificio está en reposo.
+ */
+bool gw_kinematics_group_idle(const elevator_group_state_t *group);
+
+/**
+ * @brief Tiempo de viaje teórico entre dos pisos parados (sin puertas)
+ * @param params Parámetros del modelo
+ * @param floors Pisos a recorrer
+ * @return Milisegundos del perfil trapezoidal (o triangular si no se alcanza la velocidad nominal)
+ */
+double gw_kinematics_travel_time_ms(const gw_sim_params_t *params, int floors);
+
+#endif // ELEVATOR_KINEMATICS_H
@@ -30,14 +30,17 @@
 
 #include <cJSON.h>
 #include <stdbool.h> // Para bool
+#include <stddef.h>  // Para size_t
+#include <stdint.h>  // Para uint32_t
 
 /**
- * @brief Número máximo de ascensores por gateway
+ * @brief Número máximo de ascensores por grupo
  * 
- * Define el límite máximo de ascensores que puede gestionar
- * un solo API Gateway. Ajustar según los requisitos del sistema.
+ * Las tablas de estado de cada grupo se dimensionan en tiempo de ejecución
+ * según su número real de ascensores. El límite solo refleja que el índice
+ * del ascensor viaja en un byte de los frames CAN (0xFF queda reservado).
  */
-#define MAX_ELEVATORS_PER_GATEWAY 6
+#define MAX_ELEVATORS_PER_GATEWAY 255
 
 /**
  * @brief Longitud máxima para strings de identificación
@@ -63,6 +66,15 @@
  */
 #define STATUS_STRING_MAX_LEN 16
 
+/**
+ * @brief Tamaño del buffer en pila para el payload JSON hacia el servidor central
+ * 
+ * Suficiente para grupos de hasta 8 ascensores con IDs normales.
+ * Los payloads mayores se formatean en un buffer reservado al efecto
+ * (ver elevator_group_write_json_for_server()).
+ */
+#define GW_JSON_PAYLOAD_BUF_SIZE 2048
+
 /**
  * @brief Enumeración de estados de puertas de ascensor
  * 
@@ -104,34 +116,87 @@ typedef enum {
 } gw_request_type_t;
 
 /**
- * @brief Estado de un ascensor individual
+ * @brief Datos fríos de un ascensor: identificadores de ascensor y tarea
+ * 
+ * Solo se leen al serializar o al registrar eventos, por lo que se guardan
+ * aparte del estado que recorre cada paso de simulación.
+ */
+typedef struct {
+    char ascensor_id[ID_STRING_MAX_LEN];    ///< ID único del ascensor (ej: "E1A1")
+    char tarea_actual_id[TASK_ID_MAX_LEN];  ///< ID de la tarea asignada por el servidor central ("" si no hay)
+} elevator_ids_t;
+
+/**
+ * @brief Bytes de caché JSON reservados por ascensor del grupo
+ * 
+ * Cubre un ascensor con IDs de longitud máxima. Si el fragmento codificado
+ * no cabe (p. ej. IDs con muchos caracteres escapados), se escribe
+ * directamente en cada payload sin cachear.
+ */
+#define GW_JSON_CACHE_BYTES_PER_ELEVATOR 256
+
+/**
+ * @brief Fragmento JSON "elevadores_estado" ya codificado
  * 
- * Estructura que contiene toda la información de estado
- * de un ascensor específico gestionado por el gateway.
+ * Contiene el array completo (de '[' a ']') tal y como aparece en el
+ * payload para el servidor central. Es válido mientras @c version coincida
+ * con la versión de estado del grupo.
  */
 typedef struct {
-    char ascensor_id[ID_STRING_MAX_LEN];                ///< ID único del ascensor (ej: "E1A1")
-    char id_edificio_str[ID_STRING_MAX_LEN];           ///< ID del edificio (ej: "E1")
-    int piso_actual;                                    ///< Piso actual del ascensor
-    door_state_enum_t estado_puerta_enum;              ///< Estado actual de las puertas
-    char tarea_actual_id[TASK_ID_MAX_LEN];             ///< ID de la tarea asignada por el servidor central
-    int destino_actual;                                 ///< Piso objetivo de la tarea actual (-1 si no hay)
-    movement_direction_enum_t direccion_movimiento_enum; ///< Dirección de movimiento actual
-    bool ocupado;                                       ///< True si el ascensor está asignado a una tarea
-} elevator_status_t;
+    uint32_t version;   ///< Versión de estado codificada (0 = vacío)
+    uint32_t len;       ///< Bytes válidos en @c data
+    uint32_t capacity;  ///< Tamaño de @c data (0 si el grupo no tiene caché)
+    char *data;         ///< Array JSON codificado (dentro del bloque del grupo)
+} elevator_json_cache_t;
 
 /**
  * @brief Estado del grupo de ascensores gestionado por el gateway
  * 
- * Estructura que contiene el estado completo de todos los ascensores
- * de un edificio gestionados por un API Gateway específico.
+ * El estado de los ascensores se guarda por columnas (SoA), indexado por
+ * la posición del ascensor en el grupo (0..num_elevadores_en_grupo-1):
+ * - **Estado caliente**: piso, destino, puertas, dirección y ocupación en
+ *   enteros pequeños y contiguos; un grupo de hasta 8 ascensores ocupa una
+ *   sola línea de caché
+ * - **Estado frío**: IDs de ascensor y de tarea en @c ids
+ * 
+ * Todas las tablas y la caché JSON viven en un único bloque alineado a
+ * línea de caché que reserva init_elevator_group() y libera
+ * elevator_group_destroy().
+ * 
+ * Cualquier cambio en los ascensores debe ir seguido de
+ * elevator_group_mark_dirty() para invalidar el fragmento JSON cacheado.
+ * 
+ * **Concurrencia:** un único hilo escritor modifica el grupo vivo entre
+ * elevator_group_write_begin() y elevator_group_write_end(), que nunca
+ * bloquean. Los lectores de otros hilos (métricas, registro) no leen el
+ * grupo vivo: obtienen una copia coherente con
+ * elevator_group_read_snapshot() (seqlock).
  */
 typedef struct {
-    elevator_status_t ascensores[MAX_ELEVATORS_PER_GATEWAY]; ///< Array de ascensores del grupo
+    int16_t *piso_actual;            ///< Piso actual de cada ascensor
+    int16_t *destino_actual;         ///< Piso objetivo de la tarea actual (-1 si no hay)
+    uint8_t *estado_puerta;          ///< door_state_enum_t de cada ascensor
+    uint8_t *direccion_movimiento;   ///< movement_direction_enum_t de cada ascensor
+    bool *ocupado;                   ///< True si el ascensor está asignado a una tarea
+    elevator_ids_t *ids;             ///< IDs de ascensor y tarea de cada ascensor
     int num_elevadores_en_grupo;                             ///< Número de ascensores en el grupo
     char edificio_id_str_grupo[ID_STRING_MAX_LEN];          ///< ID del edificio gestionado
+    uint16_t building_index;                                 ///< Índice en building_registry.h (lo fija gw_building_add())
+    uint32_t state_version;                                  ///< Versión del estado; se incrementa en cada cambio
+    elevator_json_cache_t json_cache;                        ///< "elevadores_estado" codificado para state_version
+    uint32_t seq;                                            ///< Contador seqlock: impar durante una escritura
+    size_t state_bytes;                                      ///< Bytes de estado (columnas e IDs) al inicio de @c storage
+    void *storage;                                           ///< Bloque que contiene todas las tablas del grupo
 } elevator_group_state_t;
 
+/**
+ * @brief Intentos de copia de un snapshot antes de rendirse
+ * 
+ * Cada intento fallido corresponde a una escritura concurrente; el
+ * escritor nunca espera al lector.
+ */
+#define GW_SNAPSHOT_MAX_RETRIES 1000
+
 /**
  * @brief Detalles específicos de solicitud para serialización JSON
  * 
@@ -163,11 +228,21 @@ typedef struct {
  * la configuración especificada, estableciendo IDs únicos, posiciones
  * iniciales y estados por defecto para todos los ascensores.
  * 
+ * Las tablas del grupo se reservan a la medida de @p num_elevadores. El
+ * grupo debe estar a cero o haber sido inicializado antes; en ese caso se
+ * liberan sus tablas anteriores.
+ * 
  * @see elevator_group_state_t
- * @see elevator_status_t
+ * @see elevator_group_destroy()
  */
 void init_elevator_group(elevator_group_state_t *group, const char* edificio_id_str, int num_elevadores, int num_pisos);
 
+/**
+ * @brief Libera las tablas de un grupo de ascensores y lo deja a cero
+ * @param group Grupo a liberar (puede estar a cero)
+ */
+void elevator_group_destroy(elevator_group_state_t *group);
+
 /**
  * @brief Serializa el estado del grupo de ascensores a JSON para el servidor central
  * @param group Puntero al estado del grupo de ascensores
@@ -188,6 +263,86 @@ cJSON* elevator_group_to_json_for_server(const elevator_group_state_t *group,
                                            gw_request_type_t request_type, 
                                            const api_request_details_for_json_t* details);
 
+/**
+ * @brief Obtiene el índice de un ascensor a partir de su ID
+ * @param group Grupo de ascensores
+ * @param elevator_id ID del ascensor con formato "<edificio>A<n>" (ej: "E1A2")
+ * @return Índice del ascensor en el grupo (n - 1), o -1 si el ID no pertenece al grupo
+ * 
+ * Decodifica el número tras la última 'A' y comprueba solo esa entrada del
+ * grupo, sin recorrer el array de ascensores.
+ */
+int elevator_group_find_index(const elevator_group_state_t *group, const char *elevator_id);
+
+/**
+ * @brief Registra un cambio en el estado del grupo
+ * @param group Grupo modificado
+ * 
+ * Incrementa la versión de estado, lo que invalida el fragmento
+ * "elevadores_estado" cacheado. La versión nunca vuelve a 0.
+ */
+void elevator_group_mark_dirty(elevator_group_state_t *group);
+
+/**
+ * @brief Abre una sección de escritura sobre el grupo vivo
+ * @param group Grupo que se va a modificar
+ * 
+ * Deja el contador seqlock impar: los snapshots que se tomen hasta
+ * elevator_group_write_end() se descartan y se repiten. No bloquea ni
+ * admite anidamiento; init_elevator_group() y elevator_group_destroy() no
+ * pueden solaparse con lectores.
+ */
+void elevator_group_write_begin(elevator_group_state_t *group);
+
+/**
+ * @brief Cierra la sección de escritura abierta con elevator_group_write_begin()
+ * @param group Grupo modificado
+ */
+void elevator_group_write_end(elevator_group_state_t *group);
+
+/**
+ * @brief Copia de forma coherente el estado de un grupo vivo
+ * @param live Grupo vivo (puede estar modificándose en otro hilo)
+ * @param snapshot Grupo de destino, a cero o de un snapshot anterior
+ * @return true si la copia es coherente, false si tras GW_SNAPSHOT_MAX_RETRIES
+ *         intentos seguía habiendo escrituras o no hubo memoria
+ * 
+ * Copia las columnas de estado, los IDs y la versión de estado. Las tablas
+ * de @p snapshot solo se reservan cuando cambia el tamaño del grupo, por lo
+ * que un lector que reutiliza su snapshot no reserva memoria. El snapshot
+ * admite todas las funciones de lectura y serialización del grupo y se
+ * libera con elevator_group_destroy().
+ */
+bool elevator_group_read_snapshot(const elevator_group_state_t *live, elevator_group_state_t *snapshot);
+
+/**
+ * @brief Escribe el payload JSON para el servidor central sin reservar memoria
+ * @param group Puntero al estado del grupo de ascensores (se actualiza su caché JSON)
+ * @param request_type El tipo de la solicitud original que motiva este payload
+ * @param details Puntero a estructura con detalles específicos de la solicitud (puede ser NULL)
+ * @param buf Buffer de destino (puede ser NULL si @p buf_size es 0)
+ * @param buf_size Tamaño del buffer en bytes
+ * @return Longitud del JSON completo sin el terminador nulo, o -1 si @p group es NULL
+ * 
+ * Produce exactamente los mismos bytes que cJSON_PrintUnformatted() sobre
+ * el resultado de elevator_group_to_json_for_server(), pero formateando
+ * directamente en @p buf. Sigue la semántica de snprintf(): si el valor
+ * devuelto es >= @p buf_size la salida se ha truncado y el llamador puede
+ * repetir la llamada con un buffer de ese tamaño + 1.
+ * 
+ * El array "elevadores_estado" se codifica una sola vez por versión de
+ * estado y se reutiliza en las llamadas siguientes; solo la cabecera
+ * propia de cada solicitud se formatea de nuevo.
+ * 
+ * @see elevator_group_to_json_for_server()
+ * @see elevator_group_mark_dirty()
+ * @see GW_JSON_PAYLOAD_BUF_SIZE
+ */
+int elevator_group_write_json_for_server(elevator_group_state_t *group,
+                                         gw_request_type_t request_type,
+                                         const api_request_details_for_json_t* details,
+                                         char *buf, size_t buf_size);
+
 /**
  * @brief Actualiza el estado de un ascensor tras recibir asignación de tarea
  * @param group Puntero al grupo de ascensores
@@ -200,7 +355,7 @@ cJSON* elevator_group_to_json_for_server(const elevator_group_state_t *group,
  * recibir una asignación de tarea del servidor central. Establece la tarea,
  * destino, dirección de movimiento y marca el ascensor como ocupado.
  * 
- * @see elevator_status_t
+ * @see elevator_group_state_t
  */
 void assign_task_to_elevator(elevator_group_state_t *group, const char* elevator_id_to_update, const char* task_id, int target_floor, int current_request_floor);
 
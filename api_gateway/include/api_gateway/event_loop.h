@@ -0,0 +1,126 @@
+/**
+ * @file event_loop.h
+ * @brief Bucle de eventos del API Gateway basado en epoll y timerfd
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Este módulo integra en un único epoll:
+ * - El descriptor de libcoap (coap_context_get_coap_fd), preparado en cada
+ *   vuelta con coap_io_prepare_epoll() para respetar sus retransmisiones
+ * - Un timerfd por cada temporizador registrado: periódico (pasos de
+ *   simulación) o de un solo disparo al instante que indique su función de
+ *   deadline, con resolución de nanosegundos (inyección de peticiones)
+ * - Un timerfd de un solo disparo armado al deadline del tracker más
+ *   antiguo del slab (request_tracker.h)
+ * - Descriptores adicionales registrados con gw_event_loop_watch_fd()
+ *   (p. ej. el socket SocketCAN de socketcan_backend.h)
+ *
+ * Cada fuente se atiende exactamente cuando vence y el proceso duerme en
+ * epoll_wait() el resto del tiempo. Si libcoap no se compiló con soporte
+ * epoll, se recurre a coap_io_process() con un timeout igual al del
+ * próximo temporizador, acotado al periodo más corto de los temporizadores
+ * periódicos (y a 1 s) para no dormir indefinidamente sin deadlines.
+ *
+ * El handshake DTLS con el servidor central también avanza en este bucle:
+ * get_or_create_central_server_dtls_session() no espera a que termine.
+ *
+ * @see request_tracker.h
+ * @see main.c
+ */
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <signal.h>
+#include <coap3/coap.h>
+
+/**
+ * @brief Número máximo de temporizadores por bucle
+ */
+#define GW_LOOP_MAX_TIMERS 8
+
+/**
+ * @brief Callback de un temporizador del bucle
+ * @param arg Argumento registrado junto al temporizador
+ */
+typedef void (*gw_loop_timer_cb_t)(void *arg);
+
+/**
+ * @brief Próximo vencimiento de un temporizador de un solo disparo
+ * @param arg Argumento registrado junto al temporizador
+ * @return Instante absoluto en ns de CLOCK_MONOTONIC, o 0 si no hay ninguno
+ */
+typedef uint64_t (*gw_loop_deadline_fn_t)(void *arg);
+
+/**
+ * @brief Temporizador del bucle de eventos
+ *
+ * Con @c next_deadline a NULL es periódico. Si no, se consulta en cada
+ * vuelta del bucle y el timerfd se rearma cuando el instante cambia; el
+ * callback se invoca una vez por vencimiento y debe hacer avanzar el
+ * deadline (p. ej. ejecutando los eventos vencidos).
+ */
+typedef struct {
+    const char *name;            ///< Nombre para logging
+    unsigned int interval_ms;    ///< Periodo en milisegundos (> 0; se ignora con next_deadline)
+    gw_loop_timer_cb_t callback; ///< Función a invocar en cada vencimiento
+    void *arg;                   ///< Argumento para el callback y para next_deadline
+    gw_loop_deadline_fn_t next_deadline; ///< Opcional: temporizador de un solo disparo
+} gw_loop_timer_t;
+
+/**
+ * @brief Número máximo de descriptores adicionales vigilados por el bucle
+ */
+#define GW_LOOP_MAX_WATCHES 4
+
+/**
+ * @brief Callback invocado cuando un descriptor vigilado es legible
+ * @param fd Descriptor legible
+ * @param arg Argumento registrado junto al descriptor
+ */
+typedef void (*gw_loop_fd_cb_t)(int fd, void *arg);
+
+/**
+ * @brief Registra un descriptor adicional para el próximo gw_event_loop_run()
+ * @param fd Descriptor no bloqueante a vigilar (EPOLLIN)
+ * @param on_readable Callback a invocar cuando el descriptor sea legible
+ * @param arg Argumento para el callback
+ * @return 0 si se registró, -1 si no quedan huecos o los parámetros son inválidos
+ *
+ * El callback debe leer hasta EAGAIN. En el bucle de respaldo sin epoll se
+ * invoca en cada vuelta.
+ */
+int gw_event_loop_watch_fd(int fd, gw_loop_fd_cb_t on_readable, void *arg);
+
+/**
+ * @brief Registra una función a invocar al final de cada vuelta del bucle
+ * @param hook Función a invocar (NULL la desactiva)
+ * @param arg Argumento para la función
+ *
+ * Se ejecuta después de atender todos los eventos de la vuelta, lo que
+ * permite agrupar en una sola operación las salidas generadas por varios
+ * eventos (p. ej. vaciar la cola de frames CAN con sendmmsg()).
+ */
+void gw_event_loop_set_flush_hook(gw_loop_timer_cb_t hook, void *arg);
+
+/**
+ * @brief Ejecuta el bucle de eventos hasta que se active la bandera de salida
+ * @param ctx Contexto CoAP del gateway
+ * @param timers Temporizadores a atender
+ * @param num_timers Número de temporizadores (máximo GW_LOOP_MAX_TIMERS)
+ * @param quit_flag Bandera de salida (p. ej. quit_main_loop)
+ * @return 0 si se salió por la bandera, -1 si hubo un error irrecuperable
+ *
+ * Si un temporizador vence varias veces antes de ser atendido (el proceso
+ * estuvo ocupado), su callback se invoca una vez por cada vencimiento para
+ * que la simulación avance según el tiempo real transcurrido, con un
+ * máximo de GW_LOOP_MAX_CATCHUP invocaciones por disparo.
+ */
+int gw_event_loop_run(coap_context_t *ctx,
+                      const gw_loop_timer_t *timers,
+                      size_t num_timers,
+                      volatile sig_atomic_t *quit_flag);
+
+#endif // EVENT_LOOP_H
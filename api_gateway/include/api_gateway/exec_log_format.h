@@ -0,0 +1,220 @@
+/**
+ * @file exec_log_format.h
+ * @brief Formatos de salida del registro de ejecuciones y su lectura
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * El logger de ejecuciones (execution_logger.h) encola cada evento como un
+ * exec_log_record_t y su hilo escritor lo vuelca en uno de estos formatos,
+ * elegido con la variable de entorno GATEWAY_LOG_FORMAT:
+ *
+ * - **markdown** (por defecto): el reporte legible de siempre (.md)
+ * - **jsonl**: una línea JSON por evento, con una cabecera y un resumen
+ *   final con las estadísticas (.jsonl)
+ * - **binary**: los registros tal cual, de tamaño fijo (.bin)
+ *
+ * Los formatos estructurados se convierten después, fuera del gateway, con
+ * la herramienta exec_report, que usa el lector de este módulo y las mismas
+ * funciones de escritura Markdown que el logger.
+ *
+ * **Disposición del formato binario** (orden de bytes del host):
+ * ```
+ * +-------------------------------+ 0
+ * | exec_log_bin_header_t         |
+ * +-------------------------------+
+ * | exec_log_record_t x N         |  eventos en orden de escritura
+ * +-------------------------------+
+ * | exec_log_record_t (resumen)   |  type == EXEC_LOG_SUMMARY_TYPE, solo si
+ * +-------------------------------+  el gateway terminó con exec_logger_finish()
+ * ```
+ *
+ * @see execution_logger.h
+ */
+
+#ifndef EXEC_LOG_FORMAT_H
+#define EXEC_LOG_FORMAT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include "api_gateway/execution_logger.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Número mágico del formato binario ("GLOG" en little-endian)
+ */
+#define EXEC_LOG_BIN_MAGIC 0x474F4C47u
+
+/**
+ * @brief Versión de los formatos estructurados (binario y JSONL)
+ *
+ * La versión 2 añade al resumen las latencias por etapa
+ * (execution_stats_t::stage_latency). La versión 3 guarda el código de las
+ * respuestas CoAP sin formatear en args[0] y solo el payload como cadena.
+ * La versión 4 añade al resumen las solicitudes expiradas y las respondidas
+ * localmente.
+ */
+#define EXEC_LOG_FORMAT_VERSION 4
+
+#define EXEC_LOG_TEXT_SIZE 472           ///< Bytes para las cadenas de un evento
+#define EXEC_LOG_MAX_STRINGS 4           ///< Cadenas máximas por evento
+#define EXEC_LOG_SUMMARY_TYPE 0xFF       ///< exec_log_record_t::type del registro de resumen
+
+/**
+ * @brief Formato del archivo de ejecución
+ */
+typedef enum {
+    EXEC_LOG_FORMAT_MARKDOWN,   ///< Reporte Markdown (.md)
+    EXEC_LOG_FORMAT_JSONL,      ///< JSON por líneas (.jsonl)
+    EXEC_LOG_FORMAT_BINARY      ///< Registros binarios (.bin)
+} exec_log_format_t;
+
+/**
+ * @brief Evento del registro de ejecución, en formato binario de tamaño fijo
+ *
+ * Las cadenas se guardan consecutivas en @c text separadas por '\0' (ver
+ * exec_log_pack_strings()). Si no caben se recortan y se marca su bit en
+ * @c truncated. El significado de @c args depende del tipo de evento.
+ */
+typedef struct {
+    uint64_t time_ns;                    ///< ns desde el inicio del registro (reloj monotónico)
+    uint8_t type;                        ///< log_event_type_t, o EXEC_LOG_SUMMARY_TYPE
+    uint8_t generic;                     ///< 1 si viene de exec_logger_log_event()
+    uint8_t truncated;                   ///< Bit i a 1 si la cadena i se recortó
+    uint8_t data[8];                     ///< Datos del frame CAN
+    uint32_t can_id;                     ///< ID del frame CAN
+    int32_t args[3];                     ///< Argumentos enteros según el tipo (CAN: DLC y bytes copiados)
+    char text[EXEC_LOG_TEXT_SIZE];       ///< Cadenas empaquetadas (resumen: execution_stats_t)
+} exec_log_record_t;
+
+// El resumen binario guarda execution_stats_t en el área de texto
+_Static_assert(sizeof(execution_stats_t) <= EXEC_LOG_TEXT_SIZE,
+               "execution_stats_t debe caber en exec_log_record_t::text");
+
+/**
+ * @brief Cabecera del formato binario
+ */
+typedef struct {
+    uint32_t magic;              ///< EXEC_LOG_BIN_MAGIC
+    uint16_t version;            ///< EXEC_LOG_FORMAT_VERSION
+    uint16_t record_size;        ///< sizeof(exec_log_record_t)
+    int64_t start_sec;           ///< Inicio del registro (CLOCK_REALTIME), segundos
+    int64_t start_nsec;          ///< Inicio del registro, nanosegundos
+} exec_log_bin_header_t;
+
+/**
+ * @brief Lector secuencial de un archivo JSONL o binario
+ */
+typedef struct {
+    exec_log_format_t format;    ///< Formato detectado al abrir
+    FILE *file;                  ///< Archivo abierto
+    struct timespec start;       ///< Inicio del registro (reloj de pared)
+    execution_stats_t stats;     ///< Resumen final, válido si has_summary
+    bool has_summary;            ///< true si se leyó el resumen final
+    char *line;                  ///< Buffer de línea (JSONL)
+    size_t line_capacity;        ///< Capacidad de line
+} exec_log_reader_t;
+
+/**
+ * @brief Interpreta el nombre de un formato ("markdown", "jsonl", "binary")
+ * @param name Nombre del formato (no distingue mayúsculas)
+ * @param format Formato reconocido
+ * @return true si el nombre es válido
+ */
+bool exec_log_format_from_name(const char *name, exec_log_format_t *format);
+
+/**
+ * @brief Extensión de archivo del formato, sin punto ("md", "jsonl", "bin")
+ */
+const char *exec_log_format_extension(exec_log_format_t format);
+
+/**
+ * @brief Etiqueta del tipo de evento en los reportes ("CAN-TX", "ERROR"...)
+ */
+const char *exec_log_event_label(log_event_type_t type);
+
+/**
+ * @brief Nombre de una etapa de latencia en los reportes ("CAN RX → JSON"...)
+ */
+const char *exec_log_stage_label(gw_span_stage_t stage);
+
+/**
+ * @brief Copia cadenas consecutivas en el área de texto del registro
+ * @param rec Registro destino
+ * @param strings Cadenas a copiar (NULL se guarda como "N/A")
+ * @param count Número de cadenas (máximo EXEC_LOG_MAX_STRINGS)
+ *
+ * Las primeras cadenas tienen prioridad: la última (normalmente el payload)
+ * es la que se recorta cuando no cabe todo.
+ */
+void exec_log_pack_strings(exec_log_record_t *rec, const char *const *strings, int count);
+
+/**
+ * @brief Recupera las cadenas empaquetadas con exec_log_pack_strings()
+ */
+void exec_log_unpack_strings(const exec_log_record_t *rec, const char **strings, int count);
+
+/**
+ * @brief Escribe el inicio del archivo (cabecera Markdown, línea de cabecera
+ * JSONL o exec_log_bin_header_t)
+ * @param out Archivo de salida
+ * @param format Formato
+ * @param start Inicio del registro (reloj de pared)
+ */
+void exec_log_write_header(FILE *out, exec_log_format_t format, const struct timespec *start);
+
+/**
+ * @brief Escribe un evento
+ * @param out Archivo de salida
+ * @param format Formato
+ * @param rec Evento
+ * @param start Inicio del registro, para el timestamp de pared del Markdown
+ */
+void exec_log_write_event(FILE *out, exec_log_format_t format, const exec_log_record_t *rec,
+                          const struct timespec *start);
+
+/**
+ * @brief Escribe el cierre del archivo con las estadísticas finales
+ * @param out Archivo de salida
+ * @param format Formato
+ * @param stats Estadísticas de la ejecución
+ * @param end Instante de finalización (reloj de pared)
+ */
+void exec_log_write_footer(FILE *out, exec_log_format_t format, const execution_stats_t *stats,
+                           const struct timespec *end);
+
+/**
+ * @brief Abre un archivo JSONL o binario y lee su cabecera
+ * @param reader Lector a inicializar
+ * @param path Ruta del archivo
+ * @return 0 en caso de éxito, -1 si no se pudo abrir o no es un registro válido
+ */
+int exec_log_reader_open(exec_log_reader_t *reader, const char *path);
+
+/**
+ * @brief Lee el siguiente evento
+ * @param reader Lector abierto
+ * @param rec Evento leído
+ * @return 1 si se leyó un evento, 0 al final del archivo, -1 si está corrupto
+ *
+ * El resumen final no se devuelve como evento: se guarda en reader->stats.
+ * Un registro sin resumen (gateway terminado sin exec_logger_finish()) se
+ * lee igualmente hasta el último evento completo.
+ */
+int exec_log_reader_next(exec_log_reader_t *reader, exec_log_record_t *rec);
+
+/**
+ * @brief Cierra el lector
+ */
+void exec_log_reader_close(exec_log_reader_t *reader);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EXEC_LOG_FORMAT_H
@@ -14,11 +14,18 @@
  * - Captura de eventos CoAP, CAN y simulación
  * - Estadísticas automáticas de rendimiento
  * - Timestamps precisos para cada evento
+ * - Registro sin formateo ni E/S en las rutas CAN/CoAP: los eventos se
+ *   encolan en binario y un hilo escritor genera el Markdown
+ * - Histogramas de latencia por etapa de las solicitudes CAN (request_span.h)
  * 
  * **Estructura de archivos:**
  * ```
- * api_gateway/logs/YYYY-MM-DD/ejecucion_HH-MM-SS.md
+ * api_gateway/logs/YYYY-MM-DD/ejecucion_HH-MM-SS-mmm.md
  * ```
+ *
+ * Con GATEWAY_LOG_FORMAT=jsonl o GATEWAY_LOG_FORMAT=binary el archivo es
+ * ejecucion_HH-MM-SS-mmm.jsonl o .bin, y el reporte Markdown/PDF se genera
+ * después con la herramienta exec_report (ver exec_log_format.h).
  */
 
 #ifndef EXECUTION_LOGGER_H
@@ -26,7 +33,10 @@
 
 #include <stdio.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <time.h>
+#include <stdint.h>
+#include "api_gateway/request_span.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -73,6 +83,18 @@ typedef struct {
     char details[MAX_LOG_MESSAGE];                 ///< Detalles adicionales
 } log_event_t;
 
+/**
+ * @brief Resumen del histograma de latencias de una etapa (µs)
+ */
+typedef struct {
+    uint32_t samples;               ///< Solicitudes medidas
+    uint32_t mean_us;               ///< Media
+    uint32_t p50_us;                ///< Percentil 50
+    uint32_t p90_us;                ///< Percentil 90
+    uint32_t p99_us;                ///< Percentil 99
+    uint32_t max_us;                ///< Máximo
+} exec_stage_latency_t;
+
 /**
  * @brief Estadísticas de ejecución
  */
@@ -88,6 +110,10 @@ typedef struct {
     double execution_duration_sec;  ///< Duración total en segundos
     char building_id[32];           ///< ID del edificio simulado
     int building_requests;          ///< Número de peticiones del edificio
+    int dropped_events;             ///< Eventos no escritos por tener la cola llena
+    exec_stage_latency_t stage_latency[GW_SPAN_STAGE_COUNT]; ///< Latencia por gw_span_stage_t
+    int requests_timed_out;         ///< Solicitudes CAN expiradas sin respuesta del servidor central
+    int requests_answered_locally;  ///< Llamadas de piso respondidas con una asignación existente
 } execution_stats_t;
 
 // ============================================================================
@@ -167,10 +193,14 @@ void exec_logger_log_coap_sent(const char* method, const char* uri, const char*
 
 /**
  * @brief Registra una respuesta CoAP recibida
- * @param code Código de respuesta CoAP
- * @param payload Payload de la respuesta (puede ser NULL)
+ * @param code Código de respuesta CoAP sin formatear (coap_pdu_code_t: clase << 5 | detalle)
+ * @param payload Payload de la respuesta tal como llega en la PDU, sin terminador (puede ser NULL)
+ * @param payload_len Bytes de @p payload
+ *
+ * El hilo escritor es quien formatea el código ("2.01"); el payload se copia
+ * directamente al registro y se recorta si no cabe.
  */
-void exec_logger_log_coap_received(const char* code, const char* payload);
+void exec_logger_log_coap_received(unsigned int code, const uint8_t *payload, size_t payload_len);
 
 /**
  * @brief Registra la asignación de una tarea
@@ -204,6 +234,18 @@ void exec_logger_log_task_completed(const char* task_id, const char* elevator_id
  */
 void exec_logger_log_error(const char* error_code, const char* error_message);
 
+/**
+ * @brief Registra las latencias de una solicitud completada
+ * @param span Instantes de la solicitud; las etapas con algún extremo a 0 se ignoran
+ * @param outcome Desenlace de la solicitud
+ *
+ * Puede llamarse desde cualquier hilo. Con GW_SPAN_OUTCOME_SERVED cada etapa
+ * alimenta su histograma y exec_logger_get_stats() / el reporte final
+ * muestran sus percentiles; los demás desenlaces solo incrementan
+ * requests_timed_out o requests_answered_locally.
+ */
+void exec_logger_record_request_span(const gw_request_span_t *span, gw_span_outcome_t outcome);
+
 /**
  * @brief Obtiene las estadísticas actuales de ejecución
  * @return Puntero a las estadísticas (solo lectura)
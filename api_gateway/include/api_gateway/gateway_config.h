@@ -0,0 +1,203 @@
+/**
+ * @file gateway_config.h
+ * @brief Configuración tipada del API Gateway
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * La configuración se lee una sola vez de gateway.env (y de la línea de
+ * comandos), se valida y se guarda en una estructura inmutable. El resto del
+ * gateway consulta gw_config() en lugar de llamar a getenv() y limpiar
+ * cadenas en cada solicitud.
+ *
+ * **Precedencia** de cada clave: valor de gateway.env, variable de entorno
+ * del proceso y, por último, el valor por defecto de coap_config.h. Los
+ * valores se recortan (espacios, '\\r', '\\n') al cargarlos.
+ *
+ * **Rutas de recursos:** FLOOR_CALL_RESOURCE y CABIN_REQUEST_RESOURCE se
+ * guardan ya normalizadas y divididas en los segmentos de las opciones
+ * Uri-Path, listas para coap_add_option() sin construir un URI por
+ * solicitud.
+ *
+ * **Recarga en caliente:** SIGHUP marca una recarga que el bucle principal
+ * aplica con gw_config_reload_if_requested(). La nueva configuración se
+ * construye aparte y sustituye a la actual con un único cambio de puntero;
+ * si no es válida se conserva la anterior. Los campos de arranque (IP y
+ * puerto de escucha, interfaz CAN, ficheros de estado y diario, número de
+ * edificios y paso de simulación) no cambian en una recarga.
+ *
+ * @see coap_config.h
+ */
+#ifndef GATEWAY_CONFIG_H
+#define GATEWAY_CONFIG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Longitud máxima de una IPv4 en texto, con terminador
+ */
+#define GW_CONFIG_IP_MAX 16
+
+/**
+ * @brief Longitud máxima de un nombre de interfaz CAN (IF_NAMESIZE)
+ */
+#define GW_CONFIG_IFNAME_MAX 16
+
+/**
+ * @brief Longitud máxima de una ruta de fichero de la configuración
+ */
+#define GW_CONFIG_FILE_MAX 256
+
+/**
+ * @brief Longitud máxima de la ruta de un recurso del servidor central
+ */
+#define GW_CONFIG_RESOURCE_MAX 64
+
+/**
+ * @brief Segmentos máximos (opciones Uri-Path) de la ruta de un recurso
+ */
+#define GW_CONFIG_URI_MAX_SEGMENTS 8
+
+/**
+ * @brief Periodo por defecto del paso fijo de la simulación cinemática (ms)
+ */
+#define GW_SIM_DEFAULT_TICK_MS 50
+
+/**
+ * @brief Velocidad nominal por defecto de la cabina (m/s)
+ */
+#define GW_SIM_DEFAULT_SPEED_MPS 1.6
+
+/**
+ * @brief Aceleración y deceleración por defecto de la cabina (m/s²)
+ */
+#define GW_SIM_DEFAULT_ACCEL_MPS2 1.0
+
+/**
+ * @brief Altura por defecto entre pisos consecutivos (m)
+ */
+#define GW_SIM_DEFAULT_FLOOR_HEIGHT_M 3.0
+
+/**
+ * @brief Duraciones por defecto de apertura, espera y cierre de puertas (ms)
+ */
+#define GW_SIM_DEFAULT_DOOR_OPEN_MS 2000
+#define GW_SIM_DEFAULT_DOOR_DWELL_MS 3000
+#define GW_SIM_DEFAULT_DOOR_CLOSE_MS 2500
+
+/**
+ * @brief Multiplicador por defecto de la reproducción del escenario
+ */
+#define GW_SIM_DEFAULT_PLAYBACK_SPEED 1.0
+
+/**
+ * @brief Parámetros del modelo cinemático de las cabinas
+ *
+ * @see elevator_kinematics.h
+ */
+typedef struct {
+    double speed_mps;         ///< GW_SIM_SPEED_MPS: velocidad nominal
+    double acceleration_mps2; ///< GW_SIM_ACCEL_MPS2: aceleración y deceleración
+    double floor_height_m;    ///< GW_SIM_FLOOR_HEIGHT_M: altura entre pisos
+    uint32_t door_open_ms;    ///< GW_SIM_DOOR_OPEN_MS: apertura de puertas
+    uint32_t door_dwell_ms;   ///< GW_SIM_DOOR_DWELL_MS: puertas abiertas
+    uint32_t door_close_ms;   ///< GW_SIM_DOOR_CLOSE_MS: cierre de puertas
+} gw_sim_params_t;
+
+/**
+ * @brief Ruta de un recurso del servidor central preparada para la PDU
+ *
+ * @c path guarda la ruta normalizada con '/' inicial; cada segmento es el
+ * valor de una opción Uri-Path y se localiza por desplazamiento y longitud
+ * dentro de @c path.
+ */
+typedef struct {
+    char path[GW_CONFIG_RESOURCE_MAX];                   ///< Ruta normalizada (p. ej. "/peticion_piso")
+    uint8_t num_segments;                                ///< Número de opciones Uri-Path
+    uint8_t segment_offset[GW_CONFIG_URI_MAX_SEGMENTS];  ///< Inicio de cada segmento en @c path
+    uint8_t segment_len[GW_CONFIG_URI_MAX_SEGMENTS];     ///< Longitud de cada segmento
+} gw_uri_path_t;
+
+/**
+ * @brief Configuración validada del gateway
+ */
+typedef struct {
+    // Campos de arranque (no cambian en una recarga)
+    char listen_ip[GW_CONFIG_IP_MAX];            ///< GW_LISTEN_IP
+    uint16_t listen_port;                        ///< GW_LISTEN_PORT o puerto de la línea de comandos
+    char can_interface[GW_CONFIG_IFNAME_MAX];    ///< GW_CAN_INTERFACE (vacío: simulador en proceso)
+    char state_file[GW_CONFIG_FILE_MAX];         ///< GW_STATE_FILE (vacío: sin persistencia)
+    char journal_file[GW_CONFIG_FILE_MAX];       ///< GW_JOURNAL_FILE (vacío: sin diario)
+    int sim_num_buildings;                       ///< GW_SIM_NUM_BUILDINGS (>= 1)
+    char sim_scenario_file[GW_CONFIG_FILE_MAX];  ///< GW_SIM_SCENARIO_FILE: escenario JSON o binario (scenario_binary.h)
+    uint32_t sim_tick_ms;                        ///< GW_SIM_TICK_MS: paso fijo de la simulación cinemática
+    uint64_t sim_seed;                           ///< GW_SIM_SEED: semilla del generador global (0: reloj y PID)
+
+    // Campos recargables
+    char central_server_ip[GW_CONFIG_IP_MAX];    ///< CENTRAL_SERVER_IP
+    uint16_t central_server_port;                ///< CENTRAL_SERVER_PORT
+    uint32_t coap_request_timeout_ms;            ///< COAP_REQUEST_TIMEOUT_MS (> 0)
+    uint32_t coap_max_retries;                   ///< COAP_MAX_RETRIES
+    gw_uri_path_t floor_call_path;               ///< FLOOR_CALL_RESOURCE
+    gw_uri_path_t cabin_request_path;            ///< CABIN_REQUEST_RESOURCE
+    gw_sim_params_t sim;                         ///< Modelo cinemático (GW_SIM_*)
+    double sim_playback_speed;                   ///< GW_SIM_PLAYBACK_SPEED: multiplicador de los instantes del escenario
+
+    uint32_t generation;                         ///< Se incrementa con cada configuración instalada
+} gw_config_t;
+
+/**
+ * @brief Carga, valida e instala la configuración inicial
+ * @param env_file Fichero de configuración (p. ej. "gateway.env"); puede no existir
+ * @param listen_port_override Puerto de escucha de la línea de comandos (0 = usar GW_LISTEN_PORT)
+ * @return 0 si la configuración es válida, -1 si algún valor no lo es
+ *
+ * Con valores inválidos no se instala nada y gw_config() sigue devolviendo
+ * la configuración por defecto.
+ */
+int gw_config_load(const char *env_file, uint16_t listen_port_override);
+
+/**
+ * @brief Configuración actual
+ * @return Configuración instalada; nunca NULL (valores por defecto si no se ha cargado)
+ *
+ * El puntero sigue siendo válido al menos hasta la siguiente recarga
+ * posterior a la que lo sustituya.
+ */
+const gw_config_t* gw_config(void);
+
+/**
+ * @brief Vuelve a leer el fichero de configuración e instala el resultado
+ * @return 0 si se instaló una configuración nueva, -1 si no era válida
+ */
+int gw_config_reload(void);
+
+/**
+ * @brief Manejador de SIGHUP: solo marca la recarga pendiente
+ * @param signum Número de señal (no utilizado)
+ */
+void gw_config_handle_sighup(int signum);
+
+/**
+ * @brief Aplica una recarga pendiente marcada por SIGHUP
+ * @return true si se instaló una configuración nueva
+ *
+ * Se llama desde el bucle principal, fuera del manejador de señal.
+ */
+bool gw_config_reload_if_requested(void);
+
+/**
+ * @brief Tiempo máximo en vuelo de una solicitud al servidor central
+ * @param config Configuración
+ * @return coap_request_timeout_ms * (coap_max_retries + 1)
+ */
+uint64_t gw_config_request_lifetime_ms(const gw_config_t *config);
+
+/**
+ * @brief Libera las configuraciones instaladas y vuelve a los valores por defecto
+ */
+void gw_config_cleanup(void);
+
+#endif // GATEWAY_CONFIG_H
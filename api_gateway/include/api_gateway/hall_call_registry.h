@@ -0,0 +1,120 @@
+/**
+ * @file hall_call_registry.h
+ * @brief Registro de llamadas de piso activas para coalescer pulsaciones repetidas
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Cada edificio mantiene una tabla de llamadas de piso (botones externos)
+ * indexada por piso y dirección con dos bitsets:
+ * - **pending**: hay una solicitud en vuelo hacia el servidor central
+ * - **assigned**: el servidor central ya asignó un ascensor a esa llamada
+ *
+ * Cuando llega una pulsación repetida (mismo piso y dirección) el puente CAN
+ * consulta la tabla antes de contactar al servidor central:
+ * - Si la llamada está pendiente, la pulsación se absorbe: se acusa con un
+ *   0x101 sin ascensor (GW_CAN_ELEVATOR_PENDING) y la respuesta de la
+ *   solicitud en curso atiende a ambas
+ * - Si la llamada ya está asignada y el ascensor sigue en camino, se
+ *   responde localmente con la asignación existente
+ * - En otro caso se trata como una llamada nueva
+ *
+ * Una asignación deja de ser válida en cuanto el ascensor asignado termina
+ * su tarea o cambia de destino; se comprueba contra el estado del grupo en
+ * cada consulta, sin depender de notificaciones de llegada.
+ *
+ * @see can_bridge.h
+ * @see building_registry.h
+ */
+#ifndef HALL_CALL_REGISTRY_H
+#define HALL_CALL_REGISTRY_H
+
+#include <stdint.h>
+#include "api_gateway/elevator_state_manager.h"
+
+/**
+ * @brief Número de pisos direccionables por una llamada de piso CAN (data[0])
+ */
+#define GW_HALL_CALL_MAX_FLOORS 256
+
+/**
+ * @brief Palabras de 64 bits por bitset (un bit por piso y dirección)
+ */
+#define GW_HALL_CALL_WORDS ((GW_HALL_CALL_MAX_FLOORS * 2 + 63) / 64)
+
+/**
+ * @brief Valor de assigned_elevator para llamadas sin ascensor asignado
+ */
+#define GW_HALL_CALL_NO_ELEVATOR 0xFF
+
+/**
+ * @brief Resultado de consultar una llamada de piso en la tabla
+ */
+typedef enum {
+    GW_HALL_CALL_NEW = 0,  ///< No hay solicitud ni asignación vigente: reenviar al servidor central
+    GW_HALL_CALL_PENDING,  ///< Ya hay una solicitud en vuelo para ese piso y dirección
+    GW_HALL_CALL_ASSIGNED  ///< Un ascensor ya está asignado y en camino
+} gw_hall_call_status_t;
+
+/**
+ * @brief Tabla de llamadas de piso de un edificio
+ */
+typedef struct {
+    uint64_t pending[GW_HALL_CALL_WORDS];   ///< Bit (piso * 2 + dir): solicitud en vuelo
+    uint64_t assigned[GW_HALL_CALL_WORDS];  ///< Bit (piso * 2 + dir): asignación recibida
+    uint8_t assigned_elevator[GW_HALL_CALL_MAX_FLOORS][2]; ///< Índice del ascensor asignado por piso y dirección
+    uint32_t coalesced_pending;             ///< Pulsaciones absorbidas por una solicitud en vuelo
+    uint32_t answered_locally;              ///< Pulsaciones respondidas con una asignación existente
+} gw_hall_call_table_t;
+
+/**
+ * @brief Vacía la tabla (sin llamadas pendientes ni asignadas)
+ * @param table Tabla a reiniciar
+ */
+void gw_hall_call_table_reset(gw_hall_call_table_t *table);
+
+/**
+ * @brief Consulta el estado de una llamada de piso
+ * @param table Tabla del edificio
+ * @param group Grupo de ascensores del edificio (para validar asignaciones)
+ * @param floor Piso de la llamada
+ * @param direction MOVING_UP o MOVING_DOWN
+ * @param elevator_index_out Índice del ascensor asignado si el resultado es GW_HALL_CALL_ASSIGNED (puede ser NULL)
+ * @return Estado de la llamada
+ *
+ * Las asignaciones cuyo ascensor ya no va hacia @p floor se descartan
+ * durante la consulta. Pisos o direcciones fuera de rango devuelven
+ * siempre GW_HALL_CALL_NEW.
+ */
+gw_hall_call_status_t gw_hall_call_check(gw_hall_call_table_t *table,
+                                         const elevator_group_state_t *group,
+                                         int floor,
+                                         movement_direction_enum_t direction,
+                                         int *elevator_index_out);
+
+/**
+ * @brief Marca una llamada como pendiente de respuesta del servidor central
+ * @param table Tabla del edificio
+ * @param floor Piso de la llamada
+ * @param direction MOVING_UP o MOVING_DOWN
+ */
+void gw_hall_call_mark_pending(gw_hall_call_table_t *table, int floor, movement_direction_enum_t direction);
+
+/**
+ * @brief Cierra la solicitud pendiente de una llamada
+ * @param table Tabla del edificio
+ * @param group Grupo de ascensores del edificio
+ * @param floor Piso de la llamada
+ * @param direction MOVING_UP o MOVING_DOWN
+ * @param assigned_elevator_id ID del ascensor asignado, o NULL si la solicitud falló
+ *
+ * Con un ascensor asignado la llamada pasa a estado asignado; sin él queda
+ * libre y la próxima pulsación se reenviará al servidor central.
+ */
+void gw_hall_call_resolve(gw_hall_call_table_t *table,
+                          const elevator_group_state_t *group,
+                          int floor,
+                          movement_direction_enum_t direction,
+                          const char *assigned_elevator_id);
+
+#endif // HALL_CALL_REGISTRY_H
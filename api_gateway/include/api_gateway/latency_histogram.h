@@ -0,0 +1,125 @@
+/**
+ * @file latency_histogram.h
+ * @brief Histograma de latencias de rango dinámico alto (HDR)
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Registra latencias en microsegundos entre 1 µs y GW_LATENCY_HIST_MAX_US
+ * con 3 cifras significativas (error relativo < 0,1 %), en memoria
+ * constante y con registro O(1): los valores se agrupan en cubos de
+ * potencias de dos subdivididos linealmente, como HdrHistogram.
+ *
+ * Frente a guardar todas las muestras y ordenarlas, los percentiles altos
+ * (p99,9, p99,99) salen exactos hasta la resolución del cubo sin importar
+ * cuántas peticiones se midan, y dos histogramas se combinan sumando
+ * contadores.
+ *
+ * @see coap_loadgen.c
+ */
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * @brief Mayor latencia distinguible (≈ 71 minutos); las mayores se registran con este valor
+ */
+#define GW_LATENCY_HIST_MAX_US ((uint64_t)1 << 32)
+
+/**
+ * @brief Histograma de latencias
+ */
+typedef struct {
+    uint64_t *counts;    ///< Contadores por cubo
+    size_t counts_len;   ///< Número de contadores
+    uint64_t total;      ///< Muestras registradas
+    uint64_t min_us;     ///< Menor muestra (UINT64_MAX sin muestras)
+    uint64_t max_us;     ///< Mayor muestra
+    double sum_us;       ///< Suma de las muestras (media)
+} gw_latency_hist_t;
+
+/**
+ * @brief Reserva un histograma vacío
+ * @return true si hubo memoria
+ */
+bool gw_latency_hist_init(gw_latency_hist_t *hist);
+
+/**
+ * @brief Libera los contadores (acepta un histograma no inicializado a cero)
+ */
+void gw_latency_hist_free(gw_latency_hist_t *hist);
+
+/**
+ * @brief Vacía el histograma sin liberar memoria
+ */
+void gw_latency_hist_reset(gw_latency_hist_t *hist);
+
+/**
+ * @brief Registra una latencia
+ * @param hist Histograma
+ * @param value_us Latencia en µs (0 cuenta como 1 µs)
+ */
+void gw_latency_hist_record(gw_latency_hist_t *hist, uint64_t value_us);
+
+/**
+ * @brief Registra @p count veces la misma latencia
+ * @param hist Histograma
+ * @param value_us Latencia en µs
+ * @param count Repeticiones (p. ej. pasajeros de un grupo)
+ */
+void gw_latency_hist_record_count(gw_latency_hist_t *hist, uint64_t value_us, uint64_t count);
+
+/**
+ * @brief Registra una latencia corrigiendo la omisión coordinada
+ * @param hist Histograma
+ * @param value_us Latencia medida
+ * @param expected_interval_us Intervalo esperado entre peticiones del emisor (0: sin corrección)
+ *
+ * Si un emisor en bucle cerrado espera @p value_us a una respuesta lenta,
+ * deja de enviar las peticiones que tocaban entretanto, que habrían visto
+ * latencias value - intervalo, value - 2·intervalo... Se registran también
+ * esas muestras para que los percentiles no oculten la pausa.
+ */
+void gw_latency_hist_record_corrected(gw_latency_hist_t *hist, uint64_t value_us, uint64_t expected_interval_us);
+
+/**
+ * @brief Suma a @p dst las muestras de @p src
+ */
+void gw_latency_hist_merge(gw_latency_hist_t *dst, const gw_latency_hist_t *src);
+
+/**
+ * @brief Latencia del percentil @p percentile
+ * @param hist Histograma
+ * @param percentile Percentil entre 0 y 100
+ * @return Límite superior del cubo que contiene el percentil (0 sin muestras)
+ */
+uint64_t gw_latency_hist_percentile(const gw_latency_hist_t *hist, double percentile);
+
+/**
+ * @brief Media de las muestras en µs (0 sin muestras)
+ */
+double gw_latency_hist_mean(const gw_latency_hist_t *hist);
+
+/**
+ * @brief Imprime una línea con muestras, media y percentiles 50/90/99/99,9/99,99 y máximo en ms
+ * @param hist Histograma
+ * @param out Salida
+ * @param label Nombre de la serie
+ */
+void gw_latency_hist_print(const gw_latency_hist_t *hist, FILE *out, const char *label);
+
+/**
+ * @brief Escribe la distribución por percentiles en formato CSV
+ * @param hist Histograma
+ * @param out Salida; columnas "percentil,latencia_us,muestras"
+ *
+ * Los puntos se concentran cerca de 100 (cada fila reduce a la mitad la
+ * distancia restante), como la salida de percentiles de HdrHistogram.
+ */
+void gw_latency_hist_write_csv(const gw_latency_hist_t *hist, FILE *out);
+
+#endif // LATENCY_HISTOGRAM_H
@@ -0,0 +1,226 @@
+/**
+ * @file passenger_kpi.h
+ * @brief Seguimiento de pasajeros e indicadores de servicio de la simulación
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Sigue cada llamada de piso simulada (un grupo de pasajeros con origen,
+ * dirección y, si se conoce, destino) por sus hitos:
+ *
+ * 1. Pulsación del botón de piso
+ * 2. Asignación de un ascensor por el servidor central
+ * 3. Llegada de una cabina al piso de origen (embarque)
+ * 4. Llegada de la cabina al piso destino (desembarque)
+ *
+ * y acumula, por pasajero, las distribuciones de los indicadores con los
+ * que se juzga un sistema de ascensores:
+ *
+ * - **Tiempo hasta asignación**: pulsación → asignación
+ * - **Tiempo de espera**: pulsación → llegada de la cabina al origen
+ * - **Tiempo en cabina**: embarque → llegada al destino
+ * - **Tiempo de viaje**: pulsación → llegada al destino
+ *
+ * Los pasajeros de un piso embarcan en la primera cabina que se detiene en
+ * él y va en su sentido, esté o no asignada a su llamada. Los pasajeros sin destino conocido
+ * (escenarios JSON, cuyas llamadas de piso no lo incluyen) salen del
+ * seguimiento al embarcar: cuentan para asignación y espera, no para viaje.
+ *
+ * El simulador informa de los hitos con el reloj virtual (ms) de la cola de
+ * eventos; el módulo no conoce la cola ni el modelo cinemático.
+ *
+ * @see headless_sim.c
+ * @see latency_histogram.h
+ */
+#ifndef PASSENGER_KPI_H
+#define PASSENGER_KPI_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "api_gateway/building_registry.h"
+#include "api_gateway/latency_histogram.h"
+
+/**
+ * @brief Pisos seguidos por edificio (0 .. GW_KPI_MAX_FLOORS - 1)
+ */
+#define GW_KPI_MAX_FLOORS 256
+
+/**
+ * @brief Instante de un hito que aún no ha ocurrido
+ */
+#define GW_KPI_NO_TIME UINT64_MAX
+
+/**
+ * @brief Fase del viaje de un grupo de pasajeros
+ */
+typedef enum {
+    GW_PASSENGER_WAITING = 0,   ///< Esperando en el piso de origen
+    GW_PASSENGER_RIDING,        ///< En cabina hacia el destino
+    GW_PASSENGER_DELIVERED,     ///< Llegó al destino
+    GW_PASSENGER_BOARDED_NO_DEST ///< Embarcó sin destino conocido; fin del seguimiento
+} gw_passenger_state_t;
+
+/**
+ * @brief Viaje de un grupo de pasajeros
+ */
+typedef struct {
+    uint64_t press_ms;         ///< Pulsación del botón de piso
+    uint64_t assigned_ms;      ///< Primera asignación (GW_KPI_NO_TIME si no la hubo)
+    uint64_t pickup_ms;        ///< Llegada de la cabina al origen
+    uint64_t arrival_ms;       ///< Llegada al destino
+    int32_t next;              ///< Siguiente de la lista de espera o de cabina (-1 fin)
+    uint16_t building_index;   ///< Edificio (building_registry.h)
+    uint16_t count;            ///< Pasajeros del grupo
+    int16_t origin;            ///< Piso de origen
+    int16_t destination;       ///< Piso destino (-1 si se desconoce)
+    int16_t car;               ///< Ascensor asignado y después el de embarque (-1 ninguno)
+    uint8_t direction;         ///< MOVING_UP o MOVING_DOWN
+    uint8_t state;             ///< gw_passenger_state_t
+} gw_passenger_t;
+
+/**
+ * @brief Listas de pasajeros de un edificio
+ */
+typedef struct {
+    int32_t *waiting;          ///< Cabeza de la lista de espera por piso y dirección (piso * 2 + subiendo)
+    int32_t *riding;           ///< Cabeza de la lista de cada cabina
+    int num_cars;              ///< Cabinas del edificio
+} gw_kpi_building_t;
+
+/**
+ * @brief Seguimiento de todos los pasajeros de una simulación
+ */
+typedef struct {
+    gw_passenger_t *passengers;              ///< Todos los viajes, en orden de pulsación
+    size_t num_passengers;                   ///< Viajes registrados
+    size_t capacity;                         ///< Capacidad de @c passengers
+    gw_kpi_building_t buildings[GW_MAX_BUILDINGS];
+    gw_latency_hist_t assignment;            ///< Pulsación → asignación (µs, por pasajero)
+    gw_latency_hist_t wait;                  ///< Pulsación → embarque
+    gw_latency_hist_t ride;                  ///< Embarque → destino
+    gw_latency_hist_t journey;               ///< Pulsación → destino
+    uint64_t people;                         ///< Pasajeros registrados
+    uint64_t people_delivered;               ///< Pasajeros que llegaron a su destino
+    uint64_t people_no_destination;          ///< Pasajeros que embarcaron sin destino conocido
+} gw_kpi_tracker_t;
+
+/**
+ * @brief Prepara un seguimiento vacío
+ * @return false si no hubo memoria para los histogramas
+ */
+bool gw_kpi_init(gw_kpi_tracker_t *tracker);
+
+/**
+ * @brief Libera los viajes, las listas y los histogramas
+ */
+void gw_kpi_free(gw_kpi_tracker_t *tracker);
+
+/**
+ * @brief Reserva las listas de un edificio
+ * @param tracker Seguimiento
+ * @param building_index Índice del edificio
+ * @param num_cars Ascensores del edificio
+ * @return false si el índice no es válido o no hubo memoria
+ */
+bool gw_kpi_add_building(gw_kpi_tracker_t *tracker, uint16_t building_index, int num_cars);
+
+/**
+ * @brief Registra la pulsación de una llamada de piso
+ * @param tracker Seguimiento
+ * @param building_index Edificio
+ * @param floor Piso de origen
+ * @param direction MOVING_UP o MOVING_DOWN
+ * @param destination Piso destino, o -1 si se desconoce
+ * @param count Pasajeros del grupo (0 cuenta como 1)
+ * @param now_ms Instante de la pulsación
+ * @return Índice del viaje, o -1 si el edificio o el piso no se siguen
+ */
+int32_t gw_kpi_press(gw_kpi_tracker_t *tracker, uint16_t building_index, int floor,
+                     movement_direction_enum_t direction, int destination, uint16_t count, uint64_t now_ms);
+
+/**
+ * @brief Registra la asignación de un ascensor a una llamada de piso
+ *
+ * Los pasajeros que esperan en ese piso y dirección pasan a tener el
+ * ascensor @p car; el tiempo hasta asignación solo se mide la primera vez.
+ */
+void gw_kpi_assigned(gw_kpi_tracker_t *tracker, uint16_t building_index, int floor,
+                     movement_direction_enum_t direction, int car, uint64_t now_ms);
+
+/**
+ * @brief Indica si hay pasajeros esperando en un piso y dirección
+ * @param car_out Ascensor asignado al primero de ellos, o -1 (puede ser NULL)
+ */
+bool gw_kpi_has_waiting(const gw_kpi_tracker_t *tracker, uint16_t building_index, int floor,
+                        movement_direction_enum_t direction, int *car_out);
+
+/**
+ * @brief Registra que una cabina se ha detenido en un piso
+ * @param tracker Seguimiento
+ * @param building_index Edificio
+ * @param car Ascensor
+ * @param floor Piso de la parada
+ * @param now_ms Instante de la parada
+ * @return Pasajeros que embarcaron en la parada
+ *
+ * Desembarcan los pasajeros de la cabina cuyo destino es @p floor y
+ * embarcan los que esperan en el piso en el sentido de los que siguen a
+ * bordo; si la cabina queda vacía embarcan los de ambos sentidos. Los que
+ * no embarcan siguen esperando.
+ */
+int gw_kpi_car_stop(gw_kpi_tracker_t *tracker, uint16_t building_index, int car, int floor, uint64_t now_ms);
+
+/**
+ * @brief Sentido de los pasajeros a bordo de una cabina
+ * @param tracker Seguimiento
+ * @param building_index Edificio
+ * @param car Ascensor
+ * @param floor Piso actual de la cabina
+ * @return MOVING_UP o MOVING_DOWN según el destino del primero que no baja en
+ *         @p floor, o STOPPED si la cabina va vacía
+ *
+ * Es el sentido con el que gw_kpi_car_stop() decide quién embarca.
+ */
+movement_direction_enum_t gw_kpi_riders_direction(const gw_kpi_tracker_t *tracker, uint16_t building_index,
+                                                   int car, int floor);
+
+/**
+ * @brief Destino más cercano de los pasajeros de una cabina
+ * @param tracker Seguimiento
+ * @param building_index Edificio
+ * @param car Ascensor
+ * @param floor Piso actual de la cabina
+ * @return Piso destino, o -1 si la cabina va vacía
+ */
+int gw_kpi_next_destination(const gw_kpi_tracker_t *tracker, uint16_t building_index, int car, int floor);
+
+/**
+ * @brief Pasajeros que esperan o viajan todavía
+ */
+uint64_t gw_kpi_people_in_progress(const gw_kpi_tracker_t *tracker);
+
+/**
+ * @brief Imprime los indicadores: pasajeros servidos y percentiles en segundos
+ */
+void gw_kpi_print(const gw_kpi_tracker_t *tracker, FILE *out);
+
+/**
+ * @brief Escribe un viaje por línea en CSV
+ *
+ * Columnas: edificio,pasajeros,origen,destino,direccion,ascensor,
+ * pulsacion_ms,asignacion_ms,embarque_ms,llegada_ms,estado. Los hitos que
+ * no ocurrieron quedan vacíos.
+ */
+bool gw_kpi_write_csv(const gw_kpi_tracker_t *tracker, FILE *out);
+
+/**
+ * @brief Escribe el resumen de indicadores en JSON
+ *
+ * Un objeto con los recuentos de pasajeros y, por indicador
+ * ("asignacion", "espera", "cabina", "viaje"), muestras, media, máximo y
+ * percentiles 50/90/95/99 en segundos.
+ */
+bool gw_kpi_write_json(const gw_kpi_tracker_t *tracker, FILE *out);
+
+#endif // PASSENGER_KPI_H
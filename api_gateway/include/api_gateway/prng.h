@@ -0,0 +1,99 @@
+/**
+ * @file prng.h
+ * @brief Generador pseudoaleatorio con semilla explícita (xoshiro256**)
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Sustituye a rand()/srand(): el estado es explícito, así que cada edificio
+ * o generador de tráfico tiene su propia secuencia y una misma semilla
+ * reproduce exactamente la misma ejecución, sin depender de qué otro
+ * código haya consumido números de un estado global oculto.
+ *
+ * - Generador: xoshiro256** (Blackman y Vigna), 256 bits de estado,
+ *   periodo 2^256 - 1 y unos pocos ciclos por número
+ * - Siembra: splitmix64 expande la semilla de 64 bits al estado completo
+ * - Flujos independientes: gw_prng_seed_stream() combina semilla y número
+ *   de flujo (p. ej. índice del edificio)
+ *
+ * @note No es un generador criptográfico.
+ *
+ * @see traffic_generator.h
+ */
+#ifndef PRNG_H
+#define PRNG_H
+
+#include <stdint.h>
+
+/**
+ * @brief Estado del generador
+ */
+typedef struct {
+    uint64_t s[4]; ///< Estado de xoshiro256** (nunca todo a cero)
+} gw_prng_t;
+
+/**
+ * @brief Inicializa el generador a partir de una semilla
+ * @param rng Generador
+ * @param seed Semilla; cualquier valor, incluido 0, es válido
+ */
+void gw_prng_seed(gw_prng_t *rng, uint64_t seed);
+
+/**
+ * @brief Inicializa el flujo @p stream de una semilla
+ * @param rng Generador
+ * @param seed Semilla común
+ * @param stream Número de flujo; flujos distintos dan secuencias no correlacionadas
+ */
+void gw_prng_seed_stream(gw_prng_t *rng, uint64_t seed, uint64_t stream);
+
+/**
+ * @brief Siguiente número de 64 bits
+ */
+uint64_t gw_prng_next(gw_prng_t *rng);
+
+/**
+ * @brief Número uniforme en [0, 1) con 53 bits de precisión
+ */
+double gw_prng_uniform(gw_prng_t *rng);
+
+/**
+ * @brief Entero uniforme en [0, @p n) sin sesgo de módulo
+ * @param rng Generador
+ * @param n Límite superior exclusivo; con 0 devuelve 0
+ */
+uint32_t gw_prng_below(gw_prng_t *rng, uint32_t n);
+
+/**
+ * @brief Muestra de una exponencial de tasa @p rate
+ * @param rng Generador
+ * @param rate Tasa (> 0), en eventos por unidad de tiempo
+ * @return Tiempo hasta el próximo evento en la misma unidad
+ */
+double gw_prng_exponential(gw_prng_t *rng, double rate);
+
+/**
+ * @brief Muestra de una Poisson de media @p mean
+ * @param rng Generador
+ * @param mean Media (>= 0); pensado para medias pequeñas (tamaños de grupo)
+ */
+uint32_t gw_prng_poisson(gw_prng_t *rng, double mean);
+
+/**
+ * @brief Generador compartido del proceso
+ * @return Generador global; si no se ha sembrado con gw_prng_global_seed()
+ *         se siembra con el reloj y el PID en el primer uso
+ *
+ * Lo usan la selección aleatoria de edificios (simulation_loader.h) y de
+ * claves PSK. No es seguro entre hilos.
+ */
+gw_prng_t* gw_prng_global(void);
+
+/**
+ * @brief Siembra el generador global
+ * @param seed Semilla (GW_SIM_SEED); 0 pide una semilla del reloj y el PID
+ * @return Semilla efectiva, para registrarla y repetir la ejecución
+ */
+uint64_t gw_prng_global_seed(uint64_t seed);
+
+#endif // PRNG_H
@@ -0,0 +1,77 @@
+/**
+ * @file request_span.h
+ * @brief Marcas de tiempo de una solicitud desde el frame CAN hasta la respuesta CAN
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Cada solicitud de origen CAN guarda en su slot del slab de trackers
+ * (request_tracker.h) un instante de CLOCK_MONOTONIC en ns por cada punto
+ * de su recorrido por el gateway:
+ *
+ * ```
+ * CAN RX ──► JSON listo ──► CoAP TX ─ ─ ─ ─ ─► CoAP RX ──► CAN TX
+ *   │ codificación │  envío  │ servidor central │ respuesta │
+ *   └──────────────────────── total ────────────────────────┘
+ * ```
+ *
+ * Al enviar la respuesta CAN el span completo se entrega al logger de
+ * ejecuciones, que acumula un histograma por etapa (ver
+ * exec_logger_record_request_span()). La contribución del gateway a la
+ * latencia de una llamada es el total menos la etapa del servidor central.
+ * Las solicitudes que expiran sin respuesta y las pulsaciones que el gateway
+ * responde con una asignación existente también se entregan, pero solo se
+ * cuentan: no alimentan los histogramas (gw_span_outcome_t).
+ *
+ * Solo contiene tipos: se incluye tanto desde el gateway como desde las
+ * herramientas offline que leen las estadísticas.
+ *
+ * @see request_tracker.h
+ * @see execution_logger.h
+ */
+#ifndef REQUEST_SPAN_H
+#define REQUEST_SPAN_H
+
+#include <stdint.h>
+
+/**
+ * @brief Puntos del recorrido de una solicitud
+ */
+typedef enum {
+    GW_SPAN_CAN_RX = 0,     ///< Frame CAN recibido por el puente
+    GW_SPAN_JSON_DONE,      ///< Payload JSON para el servidor central generado
+    GW_SPAN_COAP_TX,        ///< Petición entregada a libcoap
+    GW_SPAN_COAP_RX,        ///< Respuesta del servidor central recibida
+    GW_SPAN_CAN_TX,         ///< Respuesta CAN entregada al bus
+    GW_SPAN_POINT_COUNT     ///< Número de puntos
+} gw_span_point_t;
+
+/**
+ * @brief Etapas medidas entre dos puntos del recorrido
+ */
+typedef enum {
+    GW_SPAN_STAGE_ENCODE = 0,   ///< CAN RX → JSON listo
+    GW_SPAN_STAGE_SEND,         ///< JSON listo → CoAP TX
+    GW_SPAN_STAGE_SERVER,       ///< CoAP TX → CoAP RX (red y servidor central)
+    GW_SPAN_STAGE_RESPONSE,     ///< CoAP RX → CAN TX
+    GW_SPAN_STAGE_TOTAL,        ///< CAN RX → CAN TX
+    GW_SPAN_STAGE_COUNT         ///< Número de etapas
+} gw_span_stage_t;
+
+/**
+ * @brief Desenlace de una solicitud de origen CAN
+ */
+typedef enum {
+    GW_SPAN_OUTCOME_SERVED = 0, ///< Respondida por el servidor central
+    GW_SPAN_OUTCOME_TIMED_OUT,  ///< Expirada sin respuesta (deadline o NACK)
+    GW_SPAN_OUTCOME_LOCAL       ///< Respondida por el gateway con una asignación existente
+} gw_span_outcome_t;
+
+/**
+ * @brief Instantes de una solicitud (ns de CLOCK_MONOTONIC, 0 = no alcanzado)
+ */
+typedef struct {
+    uint64_t ns[GW_SPAN_POINT_COUNT];   ///< Instante de cada gw_span_point_t
+} gw_request_span_t;
+
+#endif // REQUEST_SPAN_H
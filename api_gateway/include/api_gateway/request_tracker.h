@@ -0,0 +1,210 @@
+/**
+ * @file request_tracker.h
+ * @brief Slab unificado de trackers de solicitudes al servidor central
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Este archivo define el almacén único de trackers para todas las solicitudes
+ * que el API Gateway envía al servidor central, tanto las originadas por
+ * clientes CoAP (api_request_tracker_t) como las originadas por frames CAN
+ * (can_origin_tracker_t).
+ *
+ * **Codificación del token CoAP (8 bytes):**
+ * - Bytes 0-3: índice del slot en el slab (big-endian)
+ * - Bytes 4-7: generación del slot en el momento de la reserva (big-endian)
+ *
+ * La correlación de una respuesta es un acceso directo al array más una
+ * comparación de generación: no hay búsquedas lineales y un token tardío
+ * de una solicitud ya liberada nunca coincide con el ocupante actual del
+ * slot. Un slot ocupado nunca se sobrescribe; si el slab está lleno la
+ * reserva falla y el llamador descarta la solicitud.
+ *
+ * @note Los tokens son únicos por gateway y solo viajan dentro de la sesión
+ *       DTLS con el servidor central, por lo que no necesitan ser aleatorios.
+ *
+ * @see api_handlers.h
+ * @see can_bridge.h
+ */
+#ifndef REQUEST_TRACKER_H
+#define REQUEST_TRACKER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <coap3/coap.h>
+#include "api_gateway/api_handlers.h" // Para api_request_tracker_t
+#include "api_gateway/can_bridge.h"   // Para can_origin_tracker_t
+#include "api_gateway/request_span.h" // Para gw_request_span_t
+
+#ifndef GW_TRACKER_SLAB_CAPACITY
+/**
+ * @brief Número de slots del slab de trackers
+ *
+ * Limita el número de solicitudes en vuelo hacia el servidor central.
+ * Puede redefinirse en tiempo de compilación (-DGW_TRACKER_SLAB_CAPACITY=N).
+ */
+#define GW_TRACKER_SLAB_CAPACITY 1024
+#endif
+
+/**
+ * @brief Longitud en bytes de los tokens generados por el slab
+ */
+#define GW_TRACKER_TOKEN_LEN 8
+
+/**
+ * @brief Tiempo máximo por defecto que una solicitud puede seguir en vuelo
+ *
+ * Equivale a COAP_REQUEST_TIMEOUT_MS * (COAP_MAX_RETRIES + 1) con los
+ * valores por defecto de coap_config.h. Ver gw_tracker_set_timeout_ms().
+ */
+#define GW_TRACKER_DEFAULT_TIMEOUT_MS 20000
+
+/**
+ * @brief Origen de la solicitud asociada a un slot
+ */
+typedef enum {
+    GW_TRACKER_ORIGIN_NONE = 0, ///< Slot libre
+    GW_TRACKER_ORIGIN_API,      ///< Solicitud de un cliente CoAP
+    GW_TRACKER_ORIGIN_CAN       ///< Solicitud originada por un frame CAN
+} gw_tracker_origin_t;
+
+/**
+ * @brief Slot del slab de trackers
+ *
+ * El contenido útil depende de @c origin. La generación se incrementa en
+ * cada reserva y forma parte del token enviado al servidor central.
+ * Los slots ocupados se encadenan en orden de deadline_ms ascendente (los
+ * empates quedan tras los slots ya enlazados), así que la cabeza de la lista
+ * es siempre el próximo en expirar aunque el timeout cambie con solicitudes
+ * en vuelo.
+ * El span no se persiste con la solicitud (state_store.h): sus instantes
+ * solo tienen sentido dentro del proceso que los tomó.
+ */
+typedef struct gw_tracker_slot_t {
+    gw_tracker_origin_t origin;     ///< Origen de la solicitud (NONE si el slot está libre)
+    uint32_t generation;            ///< Generación actual del slot
+    uint64_t deadline_ms;           ///< Instante (CLOCK_MONOTONIC, ms) en que expira la solicitud
+    uint32_t prev_live;             ///< Slot ocupado anterior en orden de deadline
+    uint32_t next_live;             ///< Slot ocupado siguiente en orden de deadline
+    gw_request_span_t span;         ///< Instantes de la solicitud (request_span.h)
+    union {
+        api_request_tracker_t api;  ///< Datos de una solicitud de origen CoAP
+        can_origin_tracker_t can;   ///< Datos de una solicitud de origen CAN
+    } data;
+} gw_tracker_slot_t;
+
+/**
+ * @brief Reinicia el slab liberando cualquier tracker en vuelo
+ *
+ * Libera los recursos propios de los trackers de origen API (token original,
+ * log_tag y sesión del cliente) y deja todos los slots libres.
+ */
+void gw_tracker_init(void);
+
+/**
+ * @brief Libera todos los trackers en vuelo (equivalente a gw_tracker_init)
+ */
+void gw_tracker_cleanup(void);
+
+/**
+ * @brief Reserva un slot libre y genera su token
+ * @param origin Origen de la solicitud (API o CAN)
+ * @param token_out Buffer de GW_TRACKER_TOKEN_LEN bytes donde se escribe el token
+ * @return Puntero al slot reservado (con @c data y @c span a cero), o NULL si el slab está lleno
+ *
+ * La reserva es O(1): se reutilizan primero los slots liberados y después
+ * los que nunca se han usado.
+ */
+gw_tracker_slot_t* gw_tracker_alloc(gw_tracker_origin_t origin, uint8_t token_out[GW_TRACKER_TOKEN_LEN]);
+
+/**
+ * @brief Localiza el slot correspondiente a un token
+ * @param token Token CoAP recibido en la respuesta del servidor central
+ * @return Puntero al slot si el token es válido y el slot sigue vivo, NULL en caso contrario
+ *
+ * Decodifica índice y generación del token; no recorre el slab.
+ */
+gw_tracker_slot_t* gw_tracker_lookup(coap_bin_const_t token);
+
+/**
+ * @brief Libera un slot y los recursos de su tracker
+ * @param slot Slot devuelto por gw_tracker_alloc() o gw_tracker_lookup()
+ *
+ * Para trackers de origen API libera token original, log_tag y la
+ * referencia a la sesión del cliente.
+ */
+void gw_tracker_release(gw_tracker_slot_t *slot);
+
+/**
+ * @brief Número de solicitudes actualmente en vuelo
+ * @return Slots ocupados en el slab
+ */
+size_t gw_tracker_in_flight(void);
+
+/**
+ * @brief Contador de cambios del slab
+ * @return Número de reservas, liberaciones y reinicios desde el arranque
+ *
+ * Permite detectar si el conjunto de solicitudes en vuelo ha cambiado sin
+ * recorrer el slab.
+ */
+uint64_t gw_tracker_change_count(void);
+
+/**
+ * @brief Callback de recorrido de los slots ocupados
+ * @param slot Slot ocupado (no debe liberarse durante el recorrido)
+ * @param arg Argumento pasado a gw_tracker_for_each()
+ */
+typedef void (*gw_tracker_visit_cb_t)(const gw_tracker_slot_t *slot, void *arg);
+
+/**
+ * @brief Recorre los slots ocupados por orden de deadline (el próximo en expirar primero)
+ * @param visit Callback a invocar por cada slot (puede ser NULL para solo contar)
+ * @param arg Argumento para @p visit
+ * @return Número de slots visitados
+ */
+size_t gw_tracker_for_each(gw_tracker_visit_cb_t visit, void *arg);
+
+/**
+ * @brief Callback invocado para cada tracker expirado antes de liberarlo
+ * @param slot Slot expirado (sigue ocupado durante la llamada)
+ */
+typedef void (*gw_tracker_expired_cb_t)(gw_tracker_slot_t *slot);
+
+/**
+ * @brief Configura el tiempo máximo en vuelo de las solicitudes
+ * @param timeout_ms Milisegundos desde la reserva hasta la expiración
+ *
+ * Afecta a las reservas posteriores a la llamada; las solicitudes en vuelo
+ * conservan su deadline. Se puede llamar en cualquier momento (recarga de
+ * configuración por SIGHUP).
+ */
+void gw_tracker_set_timeout_ms(uint64_t timeout_ms);
+
+/**
+ * @brief Instante de expiración más próximo entre los slots ocupados
+ * @return Deadline en ms de CLOCK_MONOTONIC, o 0 si no hay solicitudes en vuelo
+ */
+uint64_t gw_tracker_next_deadline_ms(void);
+
+/**
+ * @brief Libera los trackers cuyo deadline ya ha pasado
+ * @param now_ms Instante actual en ms de CLOCK_MONOTONIC
+ * @param on_expired Callback a invocar por cada tracker expirado (puede ser NULL)
+ * @return Número de trackers expirados
+ */
+size_t gw_tracker_expire(uint64_t now_ms, gw_tracker_expired_cb_t on_expired);
+
+/**
+ * @brief Reloj monotónico usado para los deadlines de los trackers
+ * @return Milisegundos de CLOCK_MONOTONIC
+ */
+uint64_t gw_tracker_now_ms(void);
+
+/**
+ * @brief Reloj monotónico usado para los spans de las solicitudes
+ * @return Nanosegundos de CLOCK_MONOTONIC
+ */
+uint64_t gw_tracker_now_ns(void);
+
+#endif // REQUEST_TRACKER_H
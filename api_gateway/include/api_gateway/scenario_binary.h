@@ -0,0 +1,202 @@
+/**
+ * @file scenario_binary.h
+ * @brief Formato binario precompilado de escenarios de simulación
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * gw_scenario_compile traduce simulation_data.json a un fichero binario que
+ * los gateways proyectan en memoria de solo lectura con mmap(). Todos los
+ * procesos de una máquina comparten así las mismas páginas de la caché de
+ * ficheros y el arranque no analiza texto: elegir un edificio es leer su
+ * entrada del índice y convertir sus registros.
+ *
+ * **Disposición del fichero** (orden de bytes del host):
+ * ```
+ * +-------------------------------+ 0
+ * | gw_scenario_bin_header_t      |
+ * +-------------------------------+ records_offset (alineado a 64)
+ * | gw_scenario_record_t x N      |  peticiones de todos los edificios, contiguas
+ * +-------------------------------+ buildings_offset
+ * | gw_scenario_building_t x M    |  índice: ID y rango de registros de cada edificio
+ * +-------------------------------+
+ * ```
+ *
+ * Cada registro ocupa 16 bytes y guarda la dirección de las llamadas de
+ * piso como movement_direction_enum_t, no como texto. El instante de
+ * llegada se resuelve al compilar: el "instante_ms" del JSON si lo hay o,
+ * si no, el de la petición anterior más el intervalo de compilación.
+ *
+ * Los loaders de simulation_loader.h reconocen el formato por su número
+ * mágico, así que GW_SIM_SCENARIO_FILE puede apuntar a un .json o a un .bin.
+ *
+ * @see simulation_loader.h
+ * @see scenario_stream.h
+ */
+#ifndef SCENARIO_BINARY_H
+#define SCENARIO_BINARY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "api_gateway/simulation_loader.h"
+
+/**
+ * @brief Número mágico ("GSCN" en little-endian)
+ */
+#define GW_SCENARIO_BIN_MAGIC 0x4E435347u
+
+/**
+ * @brief Versión del formato
+ */
+#define GW_SCENARIO_BIN_VERSION 1
+
+/**
+ * @brief Bit de gw_scenario_record_t::flags: el instante venía en el escenario
+ *
+ * Sin él, offset_ms es el que asignó el intervalo de compilación y la
+ * petición se convierte sin instante (peticion_simulacion_t::tiene_instante).
+ */
+#define GW_SCENARIO_REC_INSTANTE 0x01u
+
+/**
+ * @brief Cabecera del fichero
+ */
+typedef struct {
+    uint32_t magic;              ///< GW_SCENARIO_BIN_MAGIC
+    uint16_t version;            ///< GW_SCENARIO_BIN_VERSION
+    uint16_t record_size;        ///< sizeof(gw_scenario_record_t)
+    uint32_t num_buildings;      ///< Entradas del índice
+    uint32_t building_size;      ///< sizeof(gw_scenario_building_t)
+    uint64_t num_records;        ///< Registros de petición
+    uint64_t records_offset;     ///< Inicio de los registros
+    uint64_t buildings_offset;   ///< Inicio del índice de edificios
+} gw_scenario_bin_header_t;
+
+/**
+ * @brief Entrada del índice de edificios
+ */
+typedef struct {
+    char id_edificio[16];        ///< ID terminado en '\0'
+    uint64_t first_record;       ///< Primer registro del edificio
+    uint32_t num_records;        ///< Registros del edificio
+    uint32_t duration_ms;        ///< Instante de la última petición
+} gw_scenario_building_t;
+
+/**
+ * @brief Registro de petición de tamaño fijo
+ */
+typedef struct {
+    uint32_t offset_ms;          ///< Instante de llegada relativo al inicio del edificio
+    uint8_t tipo;                ///< tipo_peticion_t
+    uint8_t direccion;           ///< movement_direction_enum_t (llamadas de piso)
+    uint8_t indice_ascensor;     ///< Ascensor (solicitudes de cabina)
+    uint8_t flags;               ///< GW_SCENARIO_REC_* (el resto de bits a 0)
+    int16_t piso_origen;         ///< Piso de la llamada
+    int16_t piso_destino;        ///< Destino de la solicitud de cabina
+    uint16_t pasajeros;          ///< Pasajeros de la petición (0 en ficheros anteriores: 1)
+    uint16_t reservado2;         ///< 0
+} gw_scenario_record_t;
+
+_Static_assert(sizeof(gw_scenario_record_t) == 16, "gw_scenario_record_t debe ocupar 16 bytes");
+_Static_assert(sizeof(gw_scenario_building_t) == 32, "gw_scenario_building_t debe ocupar 32 bytes");
+
+/**
+ * @brief Escenario binario proyectado en memoria
+ */
+typedef struct {
+    void *base;                              ///< Inicio de la proyección
+    size_t size;                             ///< Bytes proyectados
+    const gw_scenario_bin_header_t *header;  ///< Cabecera
+    const gw_scenario_building_t *buildings; ///< Índice de edificios
+    const gw_scenario_record_t *records;     ///< Registros de petición
+} gw_scenario_map_t;
+
+/**
+ * @brief Escritor incremental de escenarios binarios (opaco)
+ *
+ * Permite volcar escenarios que no existen como JSON, p. ej. millones de
+ * peticiones de traffic_generator.h, sin mantenerlos en memoria.
+ */
+typedef struct gw_scenario_bin_writer_t gw_scenario_bin_writer_t;
+
+/**
+ * @brief Indica si un fichero empieza por el número mágico del formato binario
+ */
+bool gw_scenario_bin_is_binary(const char *path);
+
+/**
+ * @brief Compila un escenario JSON al formato binario
+ * @param json_path Escenario de entrada (formato de simulation_data.json)
+ * @param bin_path Fichero de salida
+ * @param interval_ms Separación entre peticiones consecutivas sin "instante_ms"
+ * @return true si se escribió el fichero completo
+ *
+ * Lee el JSON en streaming y escribe primero en "<bin_path>.tmp", que se
+ * renombra al terminar: los gateways que ya tengan proyectado el fichero
+ * anterior siguen viendo una versión completa.
+ */
+bool gw_scenario_bin_compile(const char *json_path, const char *bin_path, uint32_t interval_ms);
+
+/**
+ * @brief Empieza a escribir un escenario binario
+ * @param bin_path Fichero de salida (se escribe en "<bin_path>.tmp")
+ * @param interval_ms Separación entre peticiones consecutivas sin instante
+ * @return Escritor, o NULL si no se pudo crear el fichero temporal
+ */
+gw_scenario_bin_writer_t* gw_scenario_bin_writer_open(const char *bin_path, uint32_t interval_ms);
+
+/**
+ * @brief Empieza un edificio; las peticiones siguientes le pertenecen
+ * @param writer Escritor
+ * @param id_edificio ID (menos de 16 caracteres)
+ * @return false si el ID no cabe o no hay memoria para el índice
+ */
+bool gw_scenario_bin_writer_building(gw_scenario_bin_writer_t *writer, const char *id_edificio);
+
+/**
+ * @brief Añade una petición al edificio actual
+ * @param writer Escritor
+ * @param peticion Petición; su instante, si lo tiene, no debe ser anterior al de la previa
+ * @return false si no hay edificio, algún campo no cabe en el registro o falla la escritura
+ */
+bool gw_scenario_bin_writer_request(gw_scenario_bin_writer_t *writer, const peticion_simulacion_t *peticion);
+
+/**
+ * @brief Termina el fichero y libera el escritor
+ * @param writer Escritor (puede ser NULL)
+ * @param commit true para escribir el índice y renombrar a bin_path; false descarta lo escrito
+ * @return true si el fichero quedó completo en bin_path
+ *
+ * Tras un error en gw_scenario_bin_writer_building() o
+ * gw_scenario_bin_writer_request() el fichero se descarta aunque se pida
+ * commit.
+ */
+bool gw_scenario_bin_writer_close(gw_scenario_bin_writer_t *writer, bool commit);
+
+/**
+ * @brief Proyecta un escenario binario en memoria de solo lectura
+ * @param path Fichero compilado con gw_scenario_bin_compile()
+ * @param map Proyección resultante
+ * @return true si la cabecera y el índice son coherentes con el tamaño del fichero
+ */
+bool gw_scenario_bin_map(const char *path, gw_scenario_map_t *map);
+
+/**
+ * @brief Deshace la proyección
+ */
+void gw_scenario_bin_unmap(gw_scenario_map_t *map);
+
+/**
+ * @brief Busca un edificio por ID
+ * @return Índice en map->buildings, o -1 si no existe
+ */
+int gw_scenario_bin_find(const gw_scenario_map_t *map, const char *id_edificio);
+
+/**
+ * @brief Convierte un registro en petición de simulación
+ * @return false si el tipo o la dirección del registro no son válidos
+ */
+bool gw_scenario_bin_to_request(const gw_scenario_record_t *record, peticion_simulacion_t *out);
+
+#endif // SCENARIO_BINARY_H
@@ -0,0 +1,95 @@
+/**
+ * @file scenario_stream.h
+ * @brief Lectura en streaming de ficheros de escenario JSON
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Analizador incremental (estilo SAX) del formato de simulation_data.json.
+ * En lugar de leer el fichero completo y construir el árbol cJSON, recorre
+ * el fichero con un búfer fijo y entrega los edificios y sus peticiones a
+ * medida que se piden:
+ *
+ * ```c
+ * gw_scenario_stream_t *s = gw_scenario_open("simulation_data.json");
+ * char id[16];
+ * while (gw_scenario_next_building(s, id, sizeof(id)) == 1) {
+ *     peticion_simulacion_t p;
+ *     while (gw_scenario_next_request(s, &p) == 1) { ... }
+ * }
+ * gw_scenario_close(s);
+ * ```
+ *
+ * Pasar al siguiente edificio sin leer sus peticiones las salta sin
+ * materializarlas, así que la memoria no depende del tamaño del fichero y
+ * llegar a un edificio concreto solo cuesta recorrer los bytes anteriores.
+ * gw_scenario_building_offset() y gw_scenario_seek_building() permiten
+ * volver a un edificio ya visto.
+ *
+ * Las claves de cada objeto pueden aparecer en cualquier orden; las claves
+ * desconocidas se ignoran. Si "peticiones" precede a "id_edificio" el
+ * fichero debe admitir fseeko() para volver al array.
+ *
+ * @see simulation_loader.h
+ */
+#ifndef SCENARIO_STREAM_H
+#define SCENARIO_STREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "api_gateway/simulation_loader.h"
+
+/**
+ * @brief Lector de un fichero de escenario (opaco)
+ */
+typedef struct gw_scenario_stream_t gw_scenario_stream_t;
+
+/**
+ * @brief Abre un escenario y se sitúa antes del primer edificio
+ * @param path Ruta del fichero JSON
+ * @return Lector, o NULL si no se puede abrir o no contiene "edificios"
+ */
+gw_scenario_stream_t* gw_scenario_open(const char *path);
+
+/**
+ * @brief Cierra el lector y libera su búfer
+ */
+void gw_scenario_close(gw_scenario_stream_t *stream);
+
+/**
+ * @brief Avanza al siguiente edificio
+ * @param stream Lector
+ * @param id_out Destino del ID del edificio (se trunca a @p id_size - 1)
+ * @param id_size Tamaño de @p id_out
+ * @return 1 si hay edificio, 0 al final del array, -1 si el JSON es inválido
+ *
+ * Las peticiones no leídas del edificio anterior se saltan.
+ */
+int gw_scenario_next_building(gw_scenario_stream_t *stream, char *id_out, size_t id_size);
+
+/**
+ * @brief Lee la siguiente petición del edificio actual
+ * @param stream Lector
+ * @param out Petición leída
+ * @return 1 si hay petición, 0 al final del edificio, -1 si es inválida
+ *
+ * Aplica las mismas validaciones que cargar_datos_simulacion(): tipo
+ * conocido y campos numéricos o de texto según el tipo.
+ */
+int gw_scenario_next_request(gw_scenario_stream_t *stream, peticion_simulacion_t *out);
+
+/**
+ * @brief Posición en el fichero del edificio actual
+ * @return Desplazamiento en bytes de su objeto JSON, o -1 sin edificio actual
+ */
+int64_t gw_scenario_building_offset(const gw_scenario_stream_t *stream);
+
+/**
+ * @brief Vuelve a un edificio obtenido con gw_scenario_building_offset()
+ * @param stream Lector
+ * @param offset Desplazamiento del edificio
+ * @return 0 si el siguiente gw_scenario_next_building() devolverá ese edificio, -1 si error
+ */
+int gw_scenario_seek_building(gw_scenario_stream_t *stream, int64_t offset);
+
+#endif // SCENARIO_STREAM_H
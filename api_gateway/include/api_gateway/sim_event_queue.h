@@ -0,0 +1,124 @@
+/**
+ * @file sim_event_queue.h
+ * @brief Cola de eventos discretos con reloj virtual para la simulación
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Montículo binario de eventos ordenados por instante (y por orden de
+ * programación a igualdad de instante). El reloj de la cola es virtual:
+ * solo avanza al extraer eventos, así que la misma secuencia se puede
+ * ejecutar a ritmo real o tan rápido como permita la CPU.
+ *
+ * **Usos:**
+ * - Gateway: mi_simulador_ascensor.c programa las peticiones del escenario
+ *   y el temporizador del bucle de E/S ejecuta los eventos vencidos según
+ *   el reloj monotónico (gw_sim_queue_run_until())
+ * - gw_headless_sim: peticiones, respuestas del servidor central simulado
+ *   y pasos cinemáticos se ejecutan sin esperas hasta vaciar la cola
+ *
+ * Las callbacks pueden programar nuevos eventos en la misma cola, incluso
+ * para el instante actual; se ejecutan en la misma llamada.
+ *
+ * @see headless_sim.c
+ * @see elevator_kinematics.h
+ */
+#ifndef SIM_EVENT_QUEUE_H
+#define SIM_EVENT_QUEUE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct gw_sim_queue_t;
+struct gw_sim_event_t;
+
+/**
+ * @brief Acción de un evento
+ * @param queue Cola que ejecuta el evento (su reloj vale event->time_ms)
+ * @param event Evento vencido; deja de ser válido al retornar
+ */
+typedef void (*gw_sim_event_cb_t)(struct gw_sim_queue_t *queue, const struct gw_sim_event_t *event);
+
+/**
+ * @brief Evento programado
+ */
+typedef struct gw_sim_event_t {
+    uint64_t time_ms;         ///< Instante virtual de ejecución
+    uint64_t seq;             ///< Orden de programación (desempate FIFO)
+    gw_sim_event_cb_t cb;     ///< Acción
+    void *arg;                ///< Argumento libre de la acción
+    uint16_t building_index;  ///< Edificio afectado (building_registry.h)
+    int32_t value;            ///< Dato libre (índice de petición, ascensor...)
+} gw_sim_event_t;
+
+/**
+ * @brief Cola de eventos con su reloj virtual
+ */
+typedef struct gw_sim_queue_t {
+    gw_sim_event_t *heap;     ///< Montículo mínimo por (time_ms, seq)
+    size_t count;             ///< Eventos programados
+    size_t capacity;          ///< Capacidad reservada de @ref heap
+    uint64_t now_ms;          ///< Reloj virtual
+    uint64_t next_seq;        ///< Siguiente número de secuencia
+    uint64_t executed;        ///< Eventos ejecutados desde gw_sim_queue_init()
+} gw_sim_queue_t;
+
+/**
+ * @brief Inicializa una cola vacía con el reloj en @p start_ms
+ */
+void gw_sim_queue_init(gw_sim_queue_t *queue, uint64_t start_ms);
+
+/**
+ * @brief Libera los eventos pendientes y la memoria de la cola
+ */
+void gw_sim_queue_free(gw_sim_queue_t *queue);
+
+/**
+ * @brief Programa un evento en un instante absoluto
+ * @param queue Cola destino
+ * @param time_ms Instante virtual; si ya pasó se ejecuta en el instante actual
+ * @param cb Acción (no NULL)
+ * @param arg Argumento de la acción
+ * @param building_index Edificio afectado
+ * @param value Dato libre
+ * @return true si se programó, false sin memoria o sin acción
+ */
+bool gw_sim_queue_schedule(gw_sim_queue_t *queue, uint64_t time_ms, gw_sim_event_cb_t cb,
+                           void *arg, uint16_t building_index, int32_t value);
+
+/**
+ * @brief Programa un evento @p delay_ms después del instante actual
+ * @see gw_sim_queue_schedule()
+ */
+bool gw_sim_queue_schedule_in(gw_sim_queue_t *queue, uint64_t delay_ms, gw_sim_event_cb_t cb,
+                              void *arg, uint16_t building_index, int32_t value);
+
+/**
+ * @brief Ejecuta en orden los eventos con instante <= @p until_ms
+ * @param queue Cola a ejecutar
+ * @param until_ms Límite del reloj virtual (UINT64_MAX: hasta vaciar la cola)
+ * @return Eventos ejecutados
+ *
+ * Al terminar el reloj vale @p until_ms; con UINT64_MAX queda en el
+ * instante del último evento ejecutado.
+ */
+size_t gw_sim_queue_run_until(gw_sim_queue_t *queue, uint64_t until_ms);
+
+/**
+ * @brief Instante del próximo evento
+ * @return Instante virtual, o UINT64_MAX si la cola está vacía
+ */
+uint64_t gw_sim_queue_next_time(const gw_sim_queue_t *queue);
+
+/**
+ * @brief Reloj virtual actual
+ */
+uint64_t gw_sim_queue_now(const gw_sim_queue_t *queue);
+
+/**
+ * @brief Eventos pendientes
+ */
+size_t gw_sim_queue_size(const gw_sim_queue_t *queue);
+
+#endif // SIM_EVENT_QUEUE_H
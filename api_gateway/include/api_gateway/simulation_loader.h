@@ -10,7 +10,11 @@
  * múltiples escenarios de edificios y peticiones variadas.
  * 
  * **Funcionalidades principales:**
- * - Carga de datos de simulación desde JSON
+ * - Carga de datos de simulación desde JSON en streaming (scenario_stream.h)
+ *   o desde el formato binario precompilado (scenario_binary.h), que se
+ *   reconoce automáticamente
+ * - Carga parcial: los N primeros edificios, uno concreto o uno aleatorio,
+ *   sin materializar el resto del fichero
  * - Selección aleatoria de edificios
  * - Ejecución secuencial de peticiones
  * - Gestión de memoria para datos de simulación
@@ -28,6 +32,9 @@
 #include <coap3/coap.h>
 #include <cjson/cJSON.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include "api_gateway/sim_event_queue.h"
+#include "api_gateway/elevator_state_manager.h" // movement_direction_enum_t
 
 /**
  * @defgroup simulation_data Estructuras de Datos de Simulación
@@ -57,11 +64,15 @@ typedef struct {
     
     // Para llamadas de piso
     int piso_origen;              /**< Piso desde el cual se llama */
-    char direccion[8];            /**< Dirección: "up" o "down" */
+    movement_direction_enum_t direccion; /**< MOVING_UP o MOVING_DOWN ("up"/"down" en el JSON) */
     
     // Para solicitudes de cabina
     int indice_ascensor;          /**< Índice del ascensor (0-based) */
     int piso_destino;             /**< Piso destino solicitado */
+
+    bool tiene_instante;          /**< El escenario fija el instante de llegada */
+    uint32_t instante_ms;         /**< Llegada en ms desde el inicio del edificio ("instante_ms") */
+    uint16_t pasajeros;           /**< Pasajeros que llegan con la petición ("pasajeros", 1 por defecto) */
 } peticion_simulacion_t;
 
 /**
@@ -114,18 +125,69 @@ typedef struct {
  *       "id_edificio": "E001",
  *       "peticiones": [
  *         {"tipo": "llamada_piso", "piso_origen": 0, "direccion": "up"},
- *         {"tipo": "solicitud_cabina", "indice_ascensor": 0, "piso_destino": 5}
+ *         {"tipo": "solicitud_cabina", "indice_ascensor": 0, "piso_destino": 5},
+ *         {"instante_ms": 2150, "tipo": "llamada_piso", "piso_origen": 3, "direccion": "down", "pasajeros": 2}
  *       ]
  *     }
  *   ]
  * }
  * ```
+ *
+ * "instante_ms" es opcional y fija la llegada de la petición respecto al
+ * inicio del edificio; debe ser no decreciente dentro de cada edificio. Sin
+ * él la petición llega un intervalo después de la anterior. "pasajeros"
+ * también es opcional (1 a 65535, por defecto 1).
  * 
+ * El fichero se lee de forma incremental: la memoria usada es la de los
+ * datos cargados, no la del texto JSON. Si @p archivo_json es un escenario
+ * compilado con gw_scenario_compile se proyecta con mmap() en lugar de
+ * analizarse; lo mismo vale para el resto de funciones de carga.
+ *
  * @see liberar_datos_simulacion()
- * @see cJSON_Parse()
+ * @see cargar_primeros_edificios()
  */
 bool cargar_datos_simulacion(const char *archivo_json, datos_simulacion_t *datos);
 
+/**
+ * @brief Carga los @p max_edificios primeros edificios de un escenario
+ * @param archivo_json Ruta al archivo JSON
+ * @param max_edificios Máximo de edificios a cargar (>= 1)
+ * @param datos Estructura destino
+ * @return true si se cargó al menos un edificio
+ *
+ * La lectura se detiene tras el último edificio pedido; el resto del
+ * fichero no se lee.
+ */
+bool cargar_primeros_edificios(const char *archivo_json, int max_edificios, datos_simulacion_t *datos);
+
+/**
+ * @brief Carga un único edificio, elegido por ID o por posición
+ * @param archivo_json Ruta al archivo JSON
+ * @param indice Posición del edificio (0-based); se ignora si @p id_edificio no es NULL
+ * @param id_edificio ID del edificio, o NULL para elegir por @p indice
+ * @param datos Estructura destino; queda con un edificio
+ * @return true si el edificio existe y es válido
+ *
+ * Los edificios anteriores se recorren sin copiar sus peticiones.
+ */
+bool cargar_edificio_simulacion(const char *archivo_json, int indice, const char *id_edificio,
+                                datos_simulacion_t *datos);
+
+/**
+ * @brief Carga un edificio elegido uniformemente al azar
+ * @param archivo_json Ruta al archivo JSON
+ * @param datos Estructura destino; queda con un edificio
+ * @return true si se cargó
+ *
+ * Recorre el fichero una vez con muestreo de reservorio (solo guarda la
+ * posición del candidato) y vuelve al elegido para leer sus peticiones.
+ * Equivale a cargar_datos_simulacion() + seleccionar_edificio_aleatorio()
+ * sin cargar todos los edificios.
+ *
+ * @note Usa el generador global de prng.h (GW_SIM_SEED)
+ */
+bool cargar_edificio_aleatorio(const char *archivo_json, datos_simulacion_t *datos);
+
 /**
  * @brief Libera la memoria utilizada por los datos de simulación
  * @param datos Puntero a la estructura de datos a liberar
@@ -147,9 +209,8 @@ void liberar_datos_simulacion(datos_simulacion_t *datos);
  * seleccionar un edificio de la lista cargada. La selección es
  * uniforme entre todos los edificios disponibles.
  * 
- * @note Inicializa el generador aleatorio con el tiempo actual
- * @see srand()
- * @see rand()
+ * @note Usa el generador global de prng.h (GW_SIM_SEED)
+ * @see gw_prng_global()
  */
 edificio_simulacion_t* seleccionar_edificio_aleatorio(datos_simulacion_t *datos);
 
@@ -187,6 +248,45 @@ int ejecutar_peticiones_edificio(edificio_simulacion_t *edificio, coap_context_t
  */
 int convertir_direccion_string(const char *direccion_str);
 
+/**
+ * @brief Plan de peticiones de un edificio sobre una cola de eventos
+ *
+ * La cola solo contiene la próxima petición del plan; cada petición
+ * programa la siguiente al ejecutarse, así que la cola crece con el número
+ * de edificios y no con el de peticiones.
+ *
+ * Cada ronda empieza un intervalo después de la última petición de la
+ * anterior (la primera, en inicio_ms). Dentro de la ronda, una petición con
+ * tiene_instante llega en inicio_ronda + instante_ms y una sin él, un
+ * intervalo después de la anterior.
+ */
+typedef struct {
+    edificio_simulacion_t *edificio; /**< Escenario del edificio */
+    uint16_t building_index;         /**< Índice en el registro (evento.building_index) */
+    uint64_t inicio_ms;              /**< Instante virtual de la primera petición */
+    uint32_t intervalo_ms;           /**< Separación entre peticiones consecutivas */
+    int rondas;                      /**< Veces que se repite el escenario (>= 1) */
+    gw_sim_event_cb_t accion;        /**< Acción de cada petición */
+    int siguiente;                   /**< Próxima petición del plan (0 .. num_peticiones * rondas) */
+    uint64_t inicio_ronda_ms;        /**< Instante virtual en que empezó la ronda en curso */
+    uint64_t ultima_ms;              /**< Instante virtual de la última petición programada */
+} plan_peticiones_t;
+
+/**
+ * @brief Programa las peticiones de un plan en una cola de eventos
+ * @param cola Cola de eventos discretos
+ * @param plan Plan con edificio, instante inicial, intervalo, rondas y
+ *        acción; debe seguir vivo mientras queden eventos en la cola
+ * @return true si se programó la primera petición
+ *
+ * Sin instantes en el escenario, la petición k (contando todas las rondas)
+ * se ejecuta en inicio_ms + k * intervalo_ms. La acción recibe la petición
+ * en evento.arg y su posición dentro del escenario en evento.value.
+ *
+ * @see sim_event_queue.h
+ */
+bool programar_peticiones_edificio(gw_sim_queue_t *cola, plan_peticiones_t *plan);
+
 /** @} */ // end of simulation_functions group
 
 #endif // SIMULATION_LOADER_H 
\ No newline at end of file
@@ -0,0 +1,97 @@
+/**
+ * @file socketcan_backend.h
+ * @brief Backend SocketCAN del puente CAN con E/S de frames por lotes
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Este módulo conecta el puente CAN-CoAP (can_bridge.h) a una interfaz
+ * SocketCAN real o virtual (p. ej. @c vcan0) en lugar del callback del
+ * simulador en proceso.
+ *
+ * **Recepción:**
+ * - Socket CAN_RAW no bloqueante vigilado por el bucle de eventos
+ * - Filtros del kernel para 0x100, 0x200 y 0x300: el resto del tráfico
+ *   del bus se descarta antes de llegar a espacio de usuario
+ * - Lectura por lotes con recvmmsg() hasta vaciar el socket; cada frame se
+ *   entrega a ag_can_bridge_process_incoming_frame()
+ *
+ * **Edificios:** los frames estándar (11 bits) pertenecen al edificio 0.
+ * Los demás edificios usan IDs extendidos de 29 bits con el índice de
+ * edificio por encima del ID base: (edificio << 11) | 0x100.
+ *
+ * **Envío:**
+ * - Se registra como callback de envío del puente CAN
+ * - Los frames de respuesta se encolan y se envían juntos con sendmmsg()
+ *   al final de cada vuelta del bucle (ag_socketcan_flush())
+ *
+ * **Prueba con vcan0:**
+ * @code
+ * sudo modprobe vcan
+ * sudo ip link add dev vcan0 type vcan && sudo ip link set up vcan0
+ * GW_CAN_INTERFACE=vcan0 ./api_gateway
+ * cansend vcan0 100#0300      # llamada de piso 3 subiendo
+ * candump vcan0               # respuestas 0x101/0x201/0xFE
+ * @endcode
+ *
+ * @see can_bridge.h
+ * @see event_loop.h
+ */
+#ifndef SOCKETCAN_BACKEND_H
+#define SOCKETCAN_BACKEND_H
+
+#include <stddef.h>
+#include <coap3/coap.h>
+
+/**
+ * @brief Número máximo de frames leídos o enviados por llamada al sistema
+ */
+#define AG_SOCKETCAN_BATCH_SIZE 32
+
+/**
+ * @brief Desplazamiento del índice de edificio dentro de un ID CAN extendido
+ */
+#define AG_SOCKETCAN_BUILDING_SHIFT 11
+
+/**
+ * @brief Tamaño solicitado para el buffer de recepción del socket (bytes)
+ *
+ * Un buffer grande absorbe ráfagas del bus mientras el gateway atiende
+ * otros eventos.
+ */
+#define AG_SOCKETCAN_RCVBUF_BYTES (1024 * 1024)
+
+/**
+ * @brief Abre el socket SocketCAN y lo registra como backend del puente CAN
+ * @param ifname Nombre de la interfaz CAN (p. ej. "vcan0")
+ * @param coap_context Contexto CoAP al que se reenvían los frames recibidos
+ * @return Descriptor del socket (no bloqueante), o -1 en caso de error
+ *
+ * Instala los filtros del kernel, registra el callback de envío del puente
+ * CAN (sustituyendo al del simulador) y deja el socket listo para
+ * gw_event_loop_watch_fd() con ag_socketcan_on_readable().
+ */
+int ag_socketcan_open(const char *ifname, coap_context_t *coap_context);
+
+/**
+ * @brief Lee por lotes todos los frames pendientes del socket
+ * @param fd Descriptor del socket devuelto por ag_socketcan_open()
+ * @param arg No utilizado (firma compatible con gw_loop_fd_cb_t)
+ *
+ * Repite recvmmsg() hasta EAGAIN y entrega cada frame estándar válido a
+ * ag_can_bridge_process_incoming_frame().
+ */
+void ag_socketcan_on_readable(int fd, void *arg);
+
+/**
+ * @brief Envía con sendmmsg() los frames de respuesta encolados
+ * @param arg No utilizado (firma compatible con gw_loop_timer_cb_t)
+ */
+void ag_socketcan_flush(void *arg);
+
+/**
+ * @brief Envía los frames pendientes y cierra el socket
+ */
+void ag_socketcan_close(void);
+
+#endif // SOCKETCAN_BACKEND_H
@@ -0,0 +1,196 @@
+/**
+ * @file state_journal.h
+ * @brief Diario binario de transiciones de estado del gateway
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Registro de solo anexado con un registro de tamaño fijo por transición:
+ * asignaciones, movimientos y llegadas de ascensores, y solicitudes enviadas
+ * al servidor central y sus respuestas. A diferencia del informe Markdown de
+ * execution_logger.h, el diario está pensado para máquinas: la herramienta
+ * gw_journal_replay reconstruye a partir de él la línea temporal completa
+ * del estado de todos los edificios.
+ *
+ * **Formato del fichero** (orden de bytes de la máquina):
+ * - Cabecera gw_journal_file_header_t (magic "GWJL")
+ * - Registros gw_journal_record_t consecutivos de 24 bytes
+ *
+ * Los registros se acumulan en un buffer en memoria y se escriben con un
+ * único write() cuando se llena o en gw_journal_flush(). Un registro
+ * incompleto al final del fichero (caída del proceso) se descarta al
+ * reabrirlo o al reproducirlo; si una escritura falla a medias, el fichero
+ * se recorta al último registro completo antes de reintentar.
+ *
+ * **Sesiones:** las marcas de tiempo son de CLOCK_MONOTONIC y vuelven a
+ * empezar tras un reinicio de la máquina. Al anexar a un diario existente se
+ * escribe primero un registro SESSION_STARTED con la hora de pared; los
+ * registros posteriores solo son comparables con los de su misma sesión.
+ *
+ * **Configuración:** variable GW_JOURNAL_FILE de gateway.env (vacía o
+ * ausente desactiva el diario; las llamadas de registro no hacen nada).
+ *
+ * @see execution_logger.h
+ */
+#ifndef STATE_JOURNAL_H
+#define STATE_JOURNAL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Identificador del fichero de diario ("GWJL" en little-endian)
+ */
+#define GW_JOURNAL_MAGIC 0x4C4A5747u
+
+/**
+ * @brief Versión del formato; cambia con cualquier cambio de disposición
+ */
+#define GW_JOURNAL_VERSION 1
+
+/**
+ * @brief Registros acumulados en memoria antes de escribir al fichero
+ */
+#define GW_JOURNAL_BUFFER_RECORDS 4096
+
+/**
+ * @brief Valor de gw_journal_record_t::elevator sin ascensor asociado
+ */
+#define GW_JOURNAL_NO_ELEVATOR 0xFF
+
+/**
+ * @brief Tipos de transición registrados
+ *
+ * Significado de los campos de gw_journal_record_t según el tipo:
+ * | Tipo              | floor          | target_floor   | ref                | aux                    |
+ * |-------------------|----------------|----------------|--------------------|------------------------|
+ * | BUILDING_ADDED    | nº de pisos    | -              | hash del ID        | nº de ascensores       |
+ * | TASK_ASSIGNED     | piso actual    | destino        | hash de la tarea   | dirección              |
+ * | ELEVATOR_MOVED    | piso nuevo     | destino        | -                  | dirección              |
+ * | ELEVATOR_ARRIVED  | piso           | -              | hash de la tarea   | -                      |
+ * | REQUEST_SENT      | piso de origen | piso destino   | ID CAN original    | gw_request_type_t      |
+ * | RESPONSE_RECEIVED | -              | piso asignado  | ID CAN original    | código CoAP            |
+ * | SESSION_STARTED   | -              | -              | CLOCK_REALTIME en ns (32 bits bajos) | ídem (32 bits altos) |
+ */
+typedef enum {
+    GW_JOURNAL_BUILDING_ADDED = 1,  ///< Edificio registrado en building_registry.h
+    GW_JOURNAL_TASK_ASSIGNED,       ///< Tarea asignada a un ascensor
+    GW_JOURNAL_ELEVATOR_MOVED,      ///< Ascensor en un piso nuevo
+    GW_JOURNAL_ELEVATOR_ARRIVED,    ///< Ascensor llegó a su destino y liberó la tarea
+    GW_JOURNAL_REQUEST_SENT,        ///< Solicitud CAN reenviada al servidor central
+    GW_JOURNAL_RESPONSE_RECEIVED,   ///< Respuesta del servidor central a una solicitud CAN
+    GW_JOURNAL_SESSION_STARTED,     ///< Diario reabierto para anexar: nueva base de CLOCK_MONOTONIC
+    GW_JOURNAL_EVENT_COUNT          ///< Número de tipos (no es un tipo válido)
+} gw_journal_event_t;
+
+/**
+ * @brief Cabecera del fichero de diario
+ */
+typedef struct {
+    uint32_t magic;            ///< GW_JOURNAL_MAGIC
+    uint16_t version;          ///< GW_JOURNAL_VERSION
+    uint16_t record_size;      ///< sizeof(gw_journal_record_t)
+    uint64_t created_realtime_ns; ///< CLOCK_REALTIME al crear el fichero
+    uint64_t created_monotonic_ns; ///< CLOCK_MONOTONIC en el mismo instante
+} gw_journal_file_header_t;
+
+/**
+ * @brief Registro de una transición (24 bytes)
+ */
+typedef struct {
+    uint64_t timestamp_ns;  ///< CLOCK_MONOTONIC en nanosegundos
+    uint8_t type;           ///< gw_journal_event_t
+    uint8_t elevator;       ///< Índice del ascensor en el grupo, o GW_JOURNAL_NO_ELEVATOR
+    uint16_t building;      ///< Índice del edificio (building_registry.h)
+    int16_t floor;          ///< Ver gw_journal_event_t
+    int16_t target_floor;   ///< Ver gw_journal_event_t
+    uint32_t ref;           ///< Ver gw_journal_event_t
+    uint32_t aux;           ///< Ver gw_journal_event_t
+} gw_journal_record_t;
+
+_Static_assert(sizeof(gw_journal_record_t) == 24, "gw_journal_record_t debe ocupar 24 bytes");
+
+/**
+ * @brief Abre el diario para anexar registros
+ * @param path Ruta del fichero; se crea si no existe
+ * @return 0 si el diario queda abierto, -1 en caso de error
+ *
+ * Un fichero existente debe tener una cabecera válida; se recorta cualquier
+ * registro incompleto del final antes de anexar y se anota un registro
+ * GW_JOURNAL_SESSION_STARTED.
+ */
+int gw_journal_open(const char *path);
+
+/**
+ * @brief Indica si el diario está abierto
+ */
+bool gw_journal_is_open(void);
+
+/**
+ * @brief Anexa una transición al buffer del diario
+ * @param type Tipo de transición
+ * @param building Índice del edificio
+ * @param elevator Índice del ascensor, o GW_JOURNAL_NO_ELEVATOR
+ * @param floor Ver gw_journal_event_t
+ * @param target_floor Ver gw_journal_event_t
+ * @param ref Ver gw_journal_event_t
+ * @param aux Ver gw_journal_event_t
+ *
+ * Con el diario cerrado no hace nada. Si el buffer se llena se escribe al
+ * fichero antes de anexar.
+ */
+void gw_journal_record(gw_journal_event_t type, uint16_t building, uint8_t elevator,
+                       int16_t floor, int16_t target_floor, uint32_t ref, uint32_t aux);
+
+/**
+ * @brief Escribe al fichero los registros acumulados
+ * @return true si no quedan registros pendientes
+ *
+ * Si la escritura falla, lo escrito a medias se recorta y los registros
+ * siguen en el buffer para el próximo intento. Si ni siquiera se puede
+ * recortar, el diario se cierra para no anexar registros desalineados.
+ */
+bool gw_journal_flush(void);
+
+/**
+ * @brief Escribe los registros pendientes y cierra el diario
+ */
+void gw_journal_close(void);
+
+/**
+ * @brief Hash FNV-1a de un ID de edificio o tarea para los campos @c ref
+ * @param id Cadena terminada en '\0' (NULL o vacía devuelve 0)
+ * @return Hash de 32 bits
+ */
+uint32_t gw_journal_hash_id(const char *id);
+
+/**
+ * @brief Callback para cada registro de un diario reproducido
+ * @param record Registro
+ * @param arg Argumento pasado a gw_journal_replay()
+ * @return true para continuar, false para detener la reproducción
+ */
+typedef bool (*gw_journal_visit_cb_t)(const gw_journal_record_t *record, void *arg);
+
+/**
+ * @brief Recorre los registros de un fichero de diario
+ * @param path Ruta del fichero
+ * @param header_out Cabecera leída (puede ser NULL)
+ * @param visit Callback para cada registro
+ * @param arg Argumento para @p visit
+ * @return Número de registros visitados, o -1 si el fichero no es un diario válido
+ *
+ * El fichero se mapea en memoria y se recorre sin copias; un registro
+ * incompleto al final se ignora.
+ */
+long gw_journal_replay(const char *path, gw_journal_file_header_t *header_out,
+                       gw_journal_visit_cb_t visit, void *arg);
+
+/**
+ * @brief Nombre legible de un tipo de transición
+ * @param type Tipo de transición
+ * @return Nombre del tipo, o "DESCONOCIDO"
+ */
+const char* gw_journal_event_to_string(uint8_t type);
+
+#endif // STATE_JOURNAL_H
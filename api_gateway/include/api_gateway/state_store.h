@@ -0,0 +1,105 @@
+/**
+ * @file state_store.h
+ * @brief Persistencia del estado del gateway en un fichero mapeado en memoria
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Guarda opcionalmente el estado de los grupos de ascensores y las
+ * solicitudes de origen CAN en vuelo en un fichero mapeado con mmap(), que
+ * se actualiza en el sitio. Un gateway reiniciado recupera en milisegundos
+ * las posiciones, tareas y destinos de sus ascensores en lugar de
+ * anunciarlos todos en el piso 0, y vuelve a enviar al servidor central las
+ * solicitudes CAN que quedaron sin respuesta.
+ *
+ * **Formato del fichero** (orden de bytes y disposición de la máquina):
+ * - Cabecera: magic "GWST", versión, tamaño y checksum FNV-1a del contenido
+ * - Un registro por edificio: ID, número de ascensores y columnas de estado
+ *   e IDs tal como están en memoria (elevator_state_manager.h)
+ * - Un registro por solicitud CAN en vuelo: ID del edificio y
+ *   can_origin_tracker_t
+ *
+ * La cabecera se escribe después del contenido. Si el proceso muere a mitad
+ * de una actualización el checksum no coincide y el gateway arranca en frío.
+ * Las solicitudes de clientes CoAP no se guardan: su intercambio muere con
+ * el proceso.
+ *
+ * **Configuración:** variable GW_STATE_FILE de gateway.env (vacía o ausente
+ * desactiva la persistencia).
+ *
+ * @see elevator_state_manager.h
+ * @see request_tracker.h
+ * @see building_registry.h
+ */
+#ifndef STATE_STORE_H
+#define STATE_STORE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "api_gateway/can_bridge.h" // Para can_origin_tracker_t
+
+/**
+ * @brief Identificador del fichero de estado ("GWST" en little-endian)
+ */
+#define GW_STATE_FILE_MAGIC 0x54535747u
+
+/**
+ * @brief Versión del formato; cambia con cualquier cambio de disposición
+ */
+#define GW_STATE_FILE_VERSION 1
+
+/**
+ * @brief Granularidad con la que crece el fichero de estado (bytes)
+ */
+#define GW_STATE_FILE_GROWTH (64 * 1024)
+
+/**
+ * @brief Callback para reanudar una solicitud CAN recuperada del fichero
+ * @param request Solicitud con @c building_index ya traducido al registro actual
+ * @param arg Argumento pasado a gw_state_store_restore()
+ */
+typedef void (*gw_state_resubmit_cb_t)(const can_origin_tracker_t *request, void *arg);
+
+/**
+ * @brief Abre (o crea) el fichero de estado y lo mapea en memoria
+ * @param path Ruta del fichero
+ * @return 0 si el fichero queda mapeado, -1 en caso de error
+ *
+ * Un fichero existente solo se considera recuperable si magic, versión,
+ * tamaño y checksum son válidos; en otro caso se sobrescribirá en la
+ * siguiente sincronización.
+ */
+int gw_state_store_open(const char *path);
+
+/**
+ * @brief Indica si el fichero abierto contiene un estado recuperable
+ * @return true si gw_state_store_restore() tiene algo que recuperar
+ */
+bool gw_state_store_has_snapshot(void);
+
+/**
+ * @brief Recupera el estado guardado sobre los edificios ya registrados
+ * @param resubmit Callback para cada solicitud CAN en vuelo (puede ser NULL)
+ * @param arg Argumento para @p resubmit
+ * @return Número de edificios recuperados
+ *
+ * Solo se recuperan los edificios registrados con el mismo ID y número de
+ * ascensores; las solicitudes de edificios no registrados se descartan.
+ */
+int gw_state_store_restore(gw_state_resubmit_cb_t resubmit, void *arg);
+
+/**
+ * @brief Vuelca al fichero el estado actual si ha cambiado
+ * @return true si se escribió el fichero
+ *
+ * Compara las versiones de estado de los grupos y el contador de cambios
+ * de los trackers con los del último volcado; sin cambios no escribe nada.
+ */
+bool gw_state_store_sync(void);
+
+/**
+ * @brief Vuelca el estado pendiente, sincroniza el fichero a disco y lo cierra
+ */
+void gw_state_store_close(void);
+
+#endif // STATE_STORE_H
@@ -0,0 +1,181 @@
+/**
+ * @file traffic_generator.h
+ * @brief Generador determinista de tráfico sintético de pasajeros
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Produce, para un edificio, la secuencia de peticiones de simulación
+ * (peticion_simulacion_t con instante_ms) de un tráfico de pasajeros:
+ *
+ * - Llegadas de grupos según un proceso de Poisson cuya tasa cambia por
+ *   fases (p. ej. subida de la mañana, tráfico entre plantas, bajada)
+ * - Origen y destino de cada grupo según una matriz origen/destino: los
+ *   patrones predefinidos (subida, bajada, entre plantas, mixto) o una
+ *   matriz de pesos leída de un CSV
+ * - Tamaño de grupo 1 + Poisson(media - 1); el grupo comparte origen y
+ *   destino
+ *
+ * Cada grupo genera una llamada de piso en su instante de llegada (con el
+ * destino del grupo en piso_destino) y, tras el tiempo de embarque, una
+ * solicitud de cabina en un ascensor elegido al azar, ambas con el número
+ * de pasajeros. Con car_calls a false se omite la solicitud de cabina: un
+ * simulador que sigue a los pasajeros la pide él mismo en la cabina que
+ * los recoge. Las peticiones salen ordenadas
+ * por instante y se generan bajo demanda: la memoria no depende de la
+ * duración del escenario, así que pueden volcarse millones de peticiones
+ * al formato binario (scenario_binary.h) o inyectarse directamente en una
+ * cola de eventos (gw_traffic_schedule()).
+ *
+ * Con la misma semilla, perfil y número de flujo la secuencia es idéntica
+ * (prng.h).
+ *
+ * @see prng.h
+ * @see scenario_binary.h
+ * @see sim_event_queue.h
+ */
+#ifndef TRAFFIC_GENERATOR_H
+#define TRAFFIC_GENERATOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "api_gateway/simulation_loader.h"
+#include "api_gateway/sim_event_queue.h"
+
+/**
+ * @brief Número máximo de fases de un perfil
+ */
+#define GW_TRAFFIC_MAX_PHASES 16
+
+/**
+ * @brief Número máximo de pisos de un perfil
+ */
+#define GW_TRAFFIC_MAX_FLOORS 128
+
+/**
+ * @brief Patrón origen/destino de una fase
+ */
+typedef enum {
+    GW_TRAFFIC_UP_PEAK,     ///< "up-peak": del acceso a cualquier otro piso
+    GW_TRAFFIC_DOWN_PEAK,   ///< "down-peak": de cualquier piso al acceso
+    GW_TRAFFIC_INTER_FLOOR, ///< "inter-floor": entre pisos distintos, sin pasar por el acceso
+    GW_TRAFFIC_MIXED,       ///< "mixed": 40 % subida, 40 % bajada, 20 % entre plantas
+    GW_TRAFFIC_OD_MATRIX    ///< "od": matriz de pesos del perfil (od_matrix)
+} gw_traffic_pattern_t;
+
+/**
+ * @brief Tramo del escenario con tasa y patrón constantes
+ */
+typedef struct {
+    uint32_t start_ms;            ///< Inicio de la fase desde el principio del escenario
+    gw_traffic_pattern_t pattern; ///< Patrón origen/destino
+    double arrivals_per_min;      ///< Llegadas de grupos por minuto (>= 0)
+} gw_traffic_phase_t;
+
+/**
+ * @brief Perfil de tráfico de un edificio
+ */
+typedef struct {
+    int num_floors;               ///< Pisos del edificio (2 .. GW_TRAFFIC_MAX_FLOORS)
+    int lobby_floor;              ///< Piso de acceso (0 .. num_floors - 1)
+    int num_elevators;            ///< Ascensores entre los que se reparten las solicitudes de cabina
+    uint32_t duration_ms;         ///< Duración del escenario; no hay llegadas después
+    double mean_group_size;       ///< Pasajeros medios por llegada (>= 1)
+    uint32_t boarding_ms;         ///< Retardo entre la llamada de piso y la solicitud de cabina
+    bool car_calls;               ///< Emitir la solicitud de cabina de cada grupo (false: la genera quien lo embarca)
+    gw_traffic_phase_t phases[GW_TRAFFIC_MAX_PHASES]; ///< Fases por start_ms creciente; la primera en 0
+    int num_phases;               ///< Fases usadas (>= 1)
+    const double *od_matrix;      ///< Pesos num_floors x num_floors por filas (origen); solo para GW_TRAFFIC_OD_MATRIX
+} gw_traffic_profile_t;
+
+/**
+ * @brief Generador de un edificio (opaco)
+ */
+typedef struct gw_traffic_generator_t gw_traffic_generator_t;
+
+/**
+ * @brief Rellena un perfil con valores por defecto
+ *
+ * 14 pisos con acceso en el 0, 4 ascensores, una hora de tráfico mixto a
+ * 6 llegadas por minuto, grupos de 1 pasajero, 3 s de embarque y
+ * solicitudes de cabina (el edificio que registra el simulador del gateway).
+ */
+void gw_traffic_profile_defaults(gw_traffic_profile_t *profile);
+
+/**
+ * @brief Sustituye las fases de un perfil por las de una especificación
+ * @param profile Perfil a modificar
+ * @param spec Fases separadas por comas, cada una "<inicio_s>:<patrón>:<llegadas_por_min>",
+ *        p. ej. "0:up-peak:40,1800:inter-floor:10,3600:down-peak:40"
+ * @return true si la especificación es válida (inicios crecientes, el primero 0)
+ */
+bool gw_traffic_parse_phases(gw_traffic_profile_t *profile, const char *spec);
+
+/**
+ * @brief Lee una matriz origen/destino de un CSV
+ * @param path Fichero con @p num_floors filas de @p num_floors pesos (>= 0)
+ *        separados por comas; la fila es el origen y la columna el destino
+ * @param num_floors Pisos del perfil
+ * @return Matriz reservada con malloc() (liberar con free()), o NULL si el
+ *         fichero no es válido
+ */
+double* gw_traffic_load_od(const char *path, int num_floors);
+
+/**
+ * @brief Nombre de un patrón en las especificaciones de fases
+ */
+const char* gw_traffic_pattern_name(gw_traffic_pattern_t pattern);
+
+/**
+ * @brief Crea el generador de un edificio
+ * @param profile Perfil (se copia; od_matrix se copia si alguna fase la usa)
+ * @param seed Semilla común del escenario
+ * @param stream Flujo del edificio (p. ej. su índice); flujos distintos dan tráfico independiente
+ * @return Generador, o NULL si el perfil no es válido o no hay memoria
+ */
+gw_traffic_generator_t* gw_traffic_create(const gw_traffic_profile_t *profile, uint64_t seed, uint64_t stream);
+
+/**
+ * @brief Genera la siguiente petición
+ * @param generator Generador
+ * @param out Petición con tiene_instante, instante_ms y pasajeros
+ * @return true si hay petición, false si el escenario terminó
+ */
+bool gw_traffic_next(gw_traffic_generator_t *generator, peticion_simulacion_t *out);
+
+/**
+ * @brief Pasajeros generados hasta ahora
+ */
+uint64_t gw_traffic_passengers(const gw_traffic_generator_t *generator);
+
+/**
+ * @brief Libera un generador (acepta NULL)
+ */
+void gw_traffic_destroy(gw_traffic_generator_t *generator);
+
+/**
+ * @brief Inyección de un generador en una cola de eventos
+ *
+ * Como plan_peticiones_t, la cola solo contiene la próxima petición; la
+ * petición en curso se copia en @c actual, que es lo que recibe la acción
+ * en evento.arg y deja de ser válido cuando se ejecuta la siguiente.
+ */
+typedef struct {
+    gw_traffic_generator_t *generator; ///< Generador del edificio
+    uint16_t building_index;           ///< Índice en el registro (evento.building_index)
+    uint64_t inicio_ms;                ///< Instante virtual del inicio del escenario
+    gw_sim_event_cb_t accion;          ///< Acción de cada petición
+    peticion_simulacion_t actual;      ///< Petición entregada a la acción
+    peticion_simulacion_t siguiente;   ///< Petición ya generada y programada
+    int32_t emitidas;                  ///< Peticiones entregadas (evento.value)
+} gw_traffic_plan_t;
+
+/**
+ * @brief Programa la primera petición de un generador en una cola de eventos
+ * @param cola Cola de eventos discretos
+ * @param plan Plan; debe seguir vivo mientras queden eventos en la cola
+ * @return true si el generador produjo al menos una petición
+ */
+bool gw_traffic_schedule(gw_sim_queue_t *cola, gw_traffic_plan_t *plan);
+
+#endif // TRAFFIC_GENERATOR_H
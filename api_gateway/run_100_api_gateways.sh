@@ -11,6 +11,8 @@ LOG_DIR="mass_execution_logs"
 WAIT_TIME=30
 SERVER_IP="192.168.49.2"
 SERVER_PORT="5684"
+LOG_FORMAT="binary"
+REPORT_TOOL="build/exec_report"
 
 # Colores
 RED='\033[0;31m'
@@ -30,6 +32,7 @@ show_help() {
     echo "  -t, --time TIME    Tiempo de ejecución en segundos (default: 30)"
     echo "  -s, --server IP    IP del servidor (default: 192.168.49.2)"
     echo "  -p, --port PORT    Puerto del servidor (default: 5684)"
+    echo "  -f, --format FMT   Formato del registro de ejecución: markdown, jsonl, binary (default: binary)"
     echo "  -k, --kill         Solo matar procesos existentes"
     echo "  -c, --clean        Solo limpiar logs anteriores"
     echo "  --auto-clean       Limpiar logs automáticamente sin preguntar"
@@ -40,6 +43,8 @@ show_help() {
     echo "  • Si hay >50 logs individuales, pregunta si limpiarlos"
     echo "  • Con --auto-clean, limpia todo automáticamente"
     echo "  • Los logs del día actual siempre se conservan"
+    echo "  • Al terminar, exec_report resume los registros jsonl/binary en"
+    echo "    $LOG_DIR/informe_agregado.md"
     echo ""
     echo "EJEMPLOS:"
     echo "  $0                     # 100 instancias desde puerto 6000"
@@ -140,13 +145,13 @@ setup_log_directory() {
     
     # También limpiar logs individuales del sistema de logging si existen
     if [ -d "logs" ]; then
-        local old_logs_count=$(find logs -name "*.md" -type f 2>/dev/null | wc -l)
+        local old_logs_count=$(find logs \( -name "*.md" -o -name "*.jsonl" -o -name "*.bin" \) -type f 2>/dev/null | wc -l)
         if [ "$old_logs_count" -gt 50 ]; then
             if [ "$auto_clean_mode" = true ]; then
                 log_message $YELLOW "Modo automático: limpiando $old_logs_count logs individuales antiguos..."
                 # Mantener solo los logs del día actual
                 local today=$(date '+%Y-%m-%d')
-                find logs -name "*.md" -type f ! -path "*/logs/$today/*" -delete 2>/dev/null || true
+                find logs \( -name "*.md" -o -name "*.jsonl" -o -name "*.bin" \) -type f ! -path "*/logs/$today/*" -delete 2>/dev/null || true
                 log_message $GREEN "Logs individuales antiguos limpiados automáticamente (conservados los de hoy)"
             else
                 log_message $YELLOW "Detectados $old_logs_count logs individuales antiguos..."
@@ -155,7 +160,7 @@ setup_log_directory() {
                 if [[ $REPLY =~ ^[Yy]$ ]]; then
                     # Mantener solo los logs del día actual
                     local today=$(date '+%Y-%m-%d')
-                    find logs -name "*.md" -type f ! -path "*/logs/$today/*" -delete 2>/dev/null || true
+                    find logs \( -name "*.md" -o -name "*.jsonl" -o -name "*.bin" \) -type f ! -path "*/logs/$today/*" -delete 2>/dev/null || true
                     log_message $GREEN "Logs individuales antiguos limpiados (conservados los de hoy)"
                 fi
             fi
@@ -179,6 +184,7 @@ run_instance() {
         GATEWAY_INSTANCE_ID="${instance_id}" \
         GATEWAY_PORT="${port}" \
         GATEWAY_LOG_DIR="${instance_log_dir}" \
+        GATEWAY_LOG_FORMAT="${LOG_FORMAT}" \
         ./"$EXECUTABLE" "$port" > "$log_file" 2>&1 &
     local pid=$!
     
@@ -251,7 +257,7 @@ collect_statistics() {
     local total_logs=0
     
     if [ -d "logs" ]; then
-        total_logs=$(find logs -name "*.md" -type f 2>/dev/null | wc -l)
+        total_logs=$(find logs \( -name "*.md" -o -name "*.jsonl" -o -name "*.bin" \) -type f 2>/dev/null | wc -l)
     fi
     
     for i in $(seq 1 $NUM_INSTANCES); do
@@ -341,6 +347,35 @@ terminate_all_instances() {
     log_message $GREEN "Todas las instancias terminadas"
 }
 
+generate_aggregate_report() {
+    if [ "$LOG_FORMAT" = "markdown" ]; then
+        return 0
+    fi
+    if [ ! -x "$REPORT_TOOL" ]; then
+        log_message $YELLOW "No se encontró $REPORT_TOOL; informe agregado omitido"
+        return 0
+    fi
+
+    # Solo los registros escritos en esta ejecución
+    local logs=()
+    while IFS= read -r -d '' file; do
+        logs+=("$file")
+    done < <(find logs -path 'logs/instance_*' \( -name '*.jsonl' -o -name '*.bin' \) \
+                  -newer "$LOG_DIR/.inicio" -print0 2>/dev/null)
+
+    if [ ${#logs[@]} -eq 0 ]; then
+        log_message $YELLOW "No hay registros de ejecución para el informe agregado"
+        return 0
+    fi
+
+    local report_file="$LOG_DIR/informe_agregado.md"
+    if ./"$REPORT_TOOL" --aggregate -o "$report_file" "${logs[@]}"; then
+        log_message $GREEN "Informe agregado de ${#logs[@]} registros: $report_file"
+    else
+        log_message $YELLOW "exec_report terminó con errores; revisar $report_file"
+    fi
+}
+
 main() {
     local kill_only=false
     local clean_only=false
@@ -369,6 +404,10 @@ main() {
                 SERVER_PORT="$2"
                 shift 2
                 ;;
+            -f|--format)
+                LOG_FORMAT="$2"
+                shift 2
+                ;;
             -k|--kill)
                 kill_only=true
                 shift
@@ -416,6 +455,14 @@ main() {
         exit 1
     fi
     
+    case "$LOG_FORMAT" in
+        markdown|jsonl|binary) ;;
+        *)
+            log_message $RED "ERROR: Formato de registro debe ser markdown, jsonl o binary"
+            exit 1
+            ;;
+    esac
+    
     # Mostrar configuración
     log_message $GREEN "=== CONFIGURACIÓN DE PRUEBA MASIVA ==="
     echo "Instancias a ejecutar: $NUM_INSTANCES"
@@ -424,6 +471,7 @@ main() {
     echo "Servidor destino: $SERVER_IP:$SERVER_PORT"
     echo "Tiempo de ejecución: $WAIT_TIME segundos"
     echo "Ejecutable: $EXECUTABLE"
+    echo "Formato de registro: $LOG_FORMAT"
     echo ""
     echo "NOTA: Cada instancia escuchará en un puerto diferente."
     echo "Todas se conectarán al mismo servidor central."
@@ -432,6 +480,7 @@ main() {
     check_dependencies
     kill_existing_processes
     setup_log_directory $auto_clean
+    touch "$LOG_DIR/.inicio"
     
     # Ejecutar instancias
     log_message $GREEN "=== INICIANDO $NUM_INSTANCES INSTANCIAS ==="
@@ -475,6 +524,9 @@ main() {
     # Terminar instancias
     terminate_all_instances
     
+    # Convertir los registros fuera de los gateways, ya terminados
+    generate_aggregate_report
+    
     log_message $GREEN "=== PRUEBA MASIVA COMPLETADA ==="
     log_message $BLUE "Se demostró que $successful_starts API Gateways pueden ejecutarse"
     log_message $BLUE "simultáneamente conectándose al mismo servidor central."
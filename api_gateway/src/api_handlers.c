@@ -48,6 +48,10 @@
 #include <arpa/inet.h>
 #include <ctype.h> // Added for isprint
 #include "api_gateway/execution_logger.h" // Sistema de logging de ejecuciones
+#include "api_gateway/request_tracker.h"  // Slab unificado de trackers
+#include "api_gateway/building_registry.h" // Grupo de ascensores por edificio
+#include "api_gateway/state_journal.h"     // Diario binario de transiciones
+#include "api_gateway/gateway_config.h"    // Recarga en caliente (SIGHUP)
 
 /**
  * @brief Bandera para indicar si el bucle principal debe terminar
@@ -60,17 +64,6 @@
  */
 extern volatile sig_atomic_t quit_main_loop; // Se definirá en main.c
 
-/**
- * @brief Estado del grupo de ascensores gestionado por este gateway
- * 
- * Declaración externa para acceder al estado del grupo de ascensores
- * gestionado en main.c. Contiene información completa de todos los
- * ascensores del edificio.
- * 
- * @see elevator_group_state_t
- * @see main.c
- */
-extern elevator_group_state_t managed_elevator_group;
 
 /**
  * @brief Manejador de señal para SIGINT (Ctrl+C)
@@ -100,136 +93,29 @@ void handle_sigint_gw(int signum) {
  * @see get_or_create_central_server_dtls_session()
  */
 extern coap_session_t *g_dtls_session_to_central_server;
-// --- Fin: Gestión de Sesión DTLS Global ---
-
-
-// --- Inicio: Gestión de Trackers para solicitudes al Servidor Central ---
-
-/**
- * @brief Número máximo de solicitudes pendientes al servidor central
- * 
- * Define el límite de solicitudes que pueden estar pendientes de respuesta
- * del servidor central simultáneamente. Ajustar según la capacidad del sistema.
- */
-#define MAX_PENDING_REQUESTS_TO_CENTRAL 32
-
-/**
- * @brief Entrada de tracker para solicitudes al servidor central
- * 
- * Estructura que asocia un token de solicitud enviada al servidor central
- * con los datos del tracker original que contiene información de la
- * solicitud inicial del ascensor.
- */
-typedef struct {
-    coap_bin_const_t token; ///< Token de la solicitud enviada AL SERVIDOR CENTRAL
-    api_request_tracker_t *tracker_data; ///< Datos del tracker original (sesión del ascensor, token original, etc.)
-} central_request_entry_t;
-
-/**
- * @brief Array de solicitudes pendientes al servidor central
- * 
- * Almacena todas las solicitudes que han sido enviadas al servidor central
- * y están esperando respuesta. Se utiliza para correlacionar respuestas
- * con las solicitudes originales de los ascensores.
- */
-static central_request_entry_t pending_central_requests[MAX_PENDING_REQUESTS_TO_CENTRAL];
 
-/**
- * @brief Número actual de solicitudes pendientes al servidor central
- * 
- * Contador que mantiene el número de entradas activas en el array
- * pending_central_requests. Para un entorno multihilo, se necesitaría un mutex.
- */
-static int num_pending_central_requests = 0;
-
-/**
- * @brief Añade un tracker a la lista de solicitudes pendientes
- * @param token_to_central Token de la solicitud enviada al servidor central
- * @param tracker Datos del tracker original a asociar
- * 
- * Esta función almacena la asociación entre un token de solicitud al servidor
- * central y el tracker original que contiene información de la solicitud
- * del ascensor. Crea una copia del token para evitar problemas de memoria.
- * 
- * Si no hay espacio disponible o hay errores de memoria, libera automáticamente
- * el tracker para evitar fugas de memoria.
- * 
- * @see find_and_remove_central_request_tracker()
- */
-static void add_central_request_tracker(coap_bin_const_t token_to_central, api_request_tracker_t *tracker) {
-    if (num_pending_central_requests >= MAX_PENDING_REQUESTS_TO_CENTRAL) {
-        LOG_ERROR_GW("[TrackerMgmt] Demasiadas solicitudes pendientes al servidor central. No se puede rastrear la nueva (tracker 0x%p).", (void*)tracker);
-        // Liberar el tracker que no se puede almacenar para evitar fugas
-        if (tracker) {
-            if(tracker->original_token.s) coap_free((void*)tracker->original_token.s);
-            if(tracker->log_tag) free(tracker->log_tag);
-            if(tracker->original_elevator_session) coap_session_release(tracker->original_elevator_session);
-            free(tracker);
-        }
+void gw_apply_pending_config_reload(void) {
+    const gw_config_t *before = gw_config(); // Sigue siendo válida tras una recarga
+    if (!gw_config_reload_if_requested()) {
         return;
     }
-    // Guardar una copia del token_to_central, ya que el original podría ser temporal
-    uint8_t *token_copy_data = (uint8_t *)malloc(token_to_central.length);
-    if (!token_copy_data) {
-        LOG_ERROR_GW("[TrackerMgmt] Error al asignar memoria para la copia del token (tracker 0x%p).", (void*)tracker);
-        if (tracker) { // Liberar tracker si no podemos copiar el token
-            if(tracker->original_token.s) coap_free((void*)tracker->original_token.s);
-            if(tracker->log_tag) free(tracker->log_tag);
-            if(tracker->original_elevator_session) coap_session_release(tracker->original_elevator_session);
-            free(tracker);
-        }
-        return;
+    const gw_config_t *config = gw_config();
+    gw_tracker_set_timeout_ms(gw_config_request_lifetime_ms(config));
+    if ((strcmp(before->central_server_ip, config->central_server_ip) != 0 ||
+         before->central_server_port != config->central_server_port) && g_dtls_session_to_central_server) {
+        LOG_INFO_GW("[Config] Servidor central cambiado a %s:%u. Liberando la sesión DTLS actual.",
+                    config->central_server_ip, config->central_server_port);
+        coap_session_release(g_dtls_session_to_central_server);
+        g_dtls_session_to_central_server = NULL;
     }
-    memcpy(token_copy_data, token_to_central.s, token_to_central.length);
-    
-    pending_central_requests[num_pending_central_requests].token.length = token_to_central.length;
-    pending_central_requests[num_pending_central_requests].token.s = token_copy_data; // Guardamos la copia
-    pending_central_requests[num_pending_central_requests].tracker_data = tracker;
-    num_pending_central_requests++;
-    LOG_DEBUG_GW("[TrackerMgmt] Tracker (0x%p) añadido para token_to_central (len %zu). Pendientes: %d", 
-                 (void*)tracker, token_to_central.length, num_pending_central_requests);
 }
+// --- Fin: Gestión de Sesión DTLS Global ---
 
-/**
- * @brief Encuentra y remueve un tracker de la lista de solicitudes pendientes
- * @param received_token Token recibido en la respuesta del servidor central
- * @return Puntero al tracker encontrado, o NULL si no se encuentra
- * 
- * Esta función busca en la lista de solicitudes pendientes un tracker
- * que corresponda al token recibido en una respuesta del servidor central.
- * Si lo encuentra, lo remueve de la lista y libera la memoria del token copiado.
- * 
- * La función compacta el array después de remover una entrada para mantener
- * la integridad de la estructura de datos. Es responsabilidad del llamador
- * liberar la memoria del tracker retornado.
- * 
- * @note En un entorno multihilo, esta función requeriría sincronización
- * @see add_central_request_tracker()
- */
-static api_request_tracker_t* find_and_remove_central_request_tracker(coap_bin_const_t received_token) {
-    for (int i = 0; i < num_pending_central_requests; i++) {
-        if (coap_binary_equal(&pending_central_requests[i].token, &received_token)) {
-            api_request_tracker_t *found_tracker = pending_central_requests[i].tracker_data;
-            LOG_DEBUG_GW("[TrackerMgmt] Tracker (0x%p) encontrado para token (len %zu).", (void*)found_tracker, received_token.length);
-            
-            // Liberar la copia del token que almacenamos
-            if (pending_central_requests[i].token.s) {
-                free((void *)pending_central_requests[i].token.s); 
-            }
 
-            // Eliminar de la lista compactando (simple para array estático)
-            for (int j = i; j < num_pending_central_requests - 1; j++) {
-                pending_central_requests[j] = pending_central_requests[j + 1];
-            }
-            num_pending_central_requests--;
-            LOG_DEBUG_GW("[TrackerMgmt] Tracker removido. Pendientes: %d", num_pending_central_requests);
-            return found_tracker;
-        }
-    }
-    // LOG_WARN_GW("[TrackerMgmt] No se encontró tracker para token (len %zu).", received_token.length);
-    // Este WARN puede ser ruidoso si respuestas de CAN o send_arrival_update vienen aquí y no usan este sistema.
-    return NULL;
-}
+// --- Inicio: Gestión de Trackers para solicitudes al Servidor Central ---
+// Los trackers de origen API y CAN comparten el slab de request_tracker.c.
+// El token enviado al servidor central identifica el slot, así que la
+// correlación de respuestas no requiere búsquedas ni copias del token.
 // --- Fin: Gestión de Trackers ---
 
 // ---- HELPER FUNCTION ----
@@ -307,8 +193,8 @@ forward_request_to_central_server(
  * - 4.xx Client Error: Errores de solicitud
  * - 5.xx Server Error: Errores del servidor
  * 
- * @see add_central_request_tracker()
- * @see find_and_remove_central_request_tracker()
+ * @see gw_tracker_lookup()
+ * @see gw_tracker_release()
  * @see can_bridge.h
  */
 coap_response_t
@@ -318,18 +204,18 @@ hnd_central_server_response_gw(coap_session_t *session_from_server,
                                const coap_mid_t mid_from_server) {
     if (!received_from_central) {
         LOG_WARN_GW("[ResponseHandlerGW] Timeout o error: No se recibió PDU del Servidor Central.");
-        // No podemos obtener token aquí para limpiar un tracker específico si no hay PDU.
-        // Un sistema de timeouts para los trackers en pending_central_requests sería necesario para estos casos.
+        // Sin PDU no hay token; los slots de solicitudes sin respuesta se liberan en hnd_central_server_nack_gw.
         // La sesión DTLS global se maneja por el event_handler.
         return COAP_RESPONSE_OK;
     }
 
+    uint64_t coap_rx_ns = gw_tracker_now_ns(); // Antes de parsear y registrar la respuesta
     coap_pdu_code_t rcv_code = coap_pdu_get_code(received_from_central);
     LOG_INFO_GW("[ResponseHandlerGW] Servidor Central -> Gateway: Respuesta recibida (Code: %u.%02u). MID: %u",
                 COAP_RESPONSE_CLASS(rcv_code), COAP_RESPONSE_CODE(rcv_code), mid_from_server);
 
-    const uint8_t *data_from_central;
-    size_t data_len_from_central;
+    const uint8_t *data_from_central = NULL;
+    size_t data_len_from_central = 0;
     cJSON *json_response_from_central = NULL;
 
     if (coap_get_data(received_from_central, &data_len_from_central, &data_from_central)) {
@@ -345,18 +231,8 @@ hnd_central_server_response_gw(coap_session_t *session_from_server,
         LOG_DEBUG_GW("[ResponseHandlerGW] Respuesta de Servidor Central no contenía payload.");
     }
 
-    // Registrar respuesta CoAP en el logger
-    char code_str[16];
-    snprintf(code_str, sizeof(code_str), "%u.%02u", COAP_RESPONSE_CLASS(rcv_code), COAP_RESPONSE_CODE(rcv_code));
-    if (data_from_central && data_len_from_central > 0) {
-        char payload_str[256];
-        size_t copy_len = data_len_from_central < sizeof(payload_str) - 1 ? data_len_from_central : sizeof(payload_str) - 1;
-        memcpy(payload_str, data_from_central, copy_len);
-        payload_str[copy_len] = '\0';
-        exec_logger_log_coap_received(code_str, payload_str);
-    } else {
-        exec_logger_log_coap_received(code_str, NULL);
-    }
+    // Registrar respuesta CoAP en el logger (lo formatea su hilo escritor)
+    exec_logger_log_coap_received(rcv_code, data_from_central, data_len_from_central);
 
     coap_bin_const_t received_token = coap_pdu_get_token(received_from_central);
     // Log del token recibido
@@ -371,12 +247,16 @@ hnd_central_server_response_gw(coap_session_t *session_from_server,
         LOG_DEBUG_GW("[ResponseHandlerGW] Token recibido del servidor: NULO o vacío.");
     }
 
-    api_request_tracker_t *api_tracker = find_and_remove_central_request_tracker(received_token);
-    can_origin_tracker_t *can_tracker = NULL;
+    gw_tracker_slot_t *slot = gw_tracker_lookup(received_token);
+    if (slot) {
+        slot->span.ns[GW_SPAN_COAP_RX] = coap_rx_ns;
+    }
+    api_request_tracker_t *api_tracker = (slot && slot->origin == GW_TRACKER_ORIGIN_API) ? &slot->data.api : NULL;
+    can_origin_tracker_t *can_tracker = (slot && slot->origin == GW_TRACKER_ORIGIN_CAN) ? &slot->data.can : NULL;
 
     if (api_tracker) {
         const char* current_log_tag = api_tracker->log_tag ? api_tracker->log_tag : "ResponseHandlerGW_CoAP";
-        LOG_DEBUG_GW("[%s] Tracker de API (0x%p) encontrado y removido para token %s.", current_log_tag, (void*)api_tracker, token_hex_str_resp);
+        LOG_DEBUG_GW("[%s] Tracker de API (0x%p) encontrado para token %s.", current_log_tag, (void*)api_tracker, token_hex_str_resp);
 
         if (json_response_from_central) {
             cJSON *j_tarea_id = cJSON_GetObjectItemCaseSensitive(json_response_from_central, "tarea_id");
@@ -387,11 +267,14 @@ hnd_central_server_response_gw(coap_session_t *session_from_server,
                 LOG_INFO_GW("[%s] Servidor Central asignó tarea '%s' a ascensor '%s'. (CoAP Origin)", 
                             current_log_tag, j_tarea_id->valuestring, j_ascensor_asignado_id->valuestring);
                 int call_reference_floor = (api_tracker->request_type == GW_REQUEST_TYPE_FLOOR_CALL) ? api_tracker->origin_floor : 0; 
-                assign_task_to_elevator(&managed_elevator_group, 
-                                        j_ascensor_asignado_id->valuestring, 
-                                        j_tarea_id->valuestring, 
-                                        api_tracker->target_floor_for_task, 
-                                        call_reference_floor); 
+                elevator_group_state_t *group = gw_building_get(api_tracker->building_index);
+                if (group) {
+                    assign_task_to_elevator(group, 
+                                            j_ascensor_asignado_id->valuestring, 
+                                            j_tarea_id->valuestring, 
+                                            api_tracker->target_floor_for_task, 
+                                            call_reference_floor); 
+                }
             } else {
                 LOG_WARN_GW("[%s] Respuesta JSON del servidor no contiene tarea_id o ascensor_asignado_id válidos. (CoAP Origin)", current_log_tag);
             }
@@ -434,16 +317,10 @@ hnd_central_server_response_gw(coap_session_t *session_from_server,
              LOG_WARN_GW(ANSI_COLOR_YELLOW "[%s] API Tracker (0x%p) no tiene sesión original de ascensor. No se puede reenviar respuesta." ANSI_COLOR_RESET "\n", current_log_tag, (void*)api_tracker);
         }
         
-        // Clean up the API tracker (ya fue removido de la lista)
-        if(api_tracker->original_token.s) coap_free((void*)api_tracker->original_token.s);
-        if(api_tracker->log_tag) free(api_tracker->log_tag);
-        if(api_tracker->original_elevator_session) coap_session_release(api_tracker->original_elevator_session);
-        free(api_tracker);
+        // Liberar el slot (token original, log_tag y sesión del cliente)
+        gw_tracker_release(slot);
 
     } else {
-        // No se encontró API tracker. Intentar buscar tracker de CAN.
-        can_tracker = find_can_tracker(received_token); // find_can_tracker NO remueve de su lista
-
         if (can_tracker) {
             LOG_INFO_GW("[ResponseHandlerGW] Respuesta CoAP corresponde a una solicitud originada por CAN (ID: 0x%X). Token %s", can_tracker->original_can_id, token_hex_str_resp);
             
@@ -458,17 +335,44 @@ hnd_central_server_response_gw(coap_session_t *session_from_server,
                     LOG_INFO_GW("[ResponseHandlerGW] Servidor Central (vía CAN origin) asignó tarea '%s' a ascensor '%s'. Actualizando estado local.", 
                                 j_tarea_id->valuestring, j_ascensor_asignado_id->valuestring);
 
-                    assign_task_to_elevator(&managed_elevator_group, 
-                                            j_ascensor_asignado_id->valuestring, 
-                                            j_tarea_id->valuestring, 
-                                            can_tracker->target_floor_for_task, 
-                                            can_tracker->call_reference_floor); 
+                    elevator_group_state_t *group = gw_building_get(can_tracker->building_index);
+                    if (group) {
+                        assign_task_to_elevator(group, 
+                                                j_ascensor_asignado_id->valuestring, 
+                                                j_tarea_id->valuestring, 
+                                                can_tracker->target_floor_for_task, 
+                                                can_tracker->call_reference_floor); 
+                    }
                 } else {
                     LOG_WARN_GW("[ResponseHandlerGW] Respuesta JSON (vía CAN origin) del servidor no contiene tarea_id o ascensor_asignado_id válidos para actualizar estado.");
                 }
             }
-            ag_can_bridge_send_response_frame(can_tracker->original_can_id, rcv_code, json_response_from_central);
-            // El tracker CAN no se libera aquí, es parte de un buffer circular.
+            if (can_tracker->request_type == GW_REQUEST_TYPE_FLOOR_CALL) {
+                const char *assigned_id = NULL;
+                if (is_success_code_class && json_response_from_central) {
+                    cJSON *j_asignado = cJSON_GetObjectItemCaseSensitive(json_response_from_central, "ascensor_asignado_id");
+                    if (cJSON_IsString(j_asignado)) assigned_id = j_asignado->valuestring;
+                }
+                gw_hall_call_resolve(gw_building_hall_calls(can_tracker->building_index),
+                                     gw_building_get(can_tracker->building_index),
+                                     can_tracker->call_reference_floor, can_tracker->requested_direction, assigned_id);
+            }
+            if (gw_journal_is_open()) {
+                int assigned_index = -1;
+                if (is_success_code_class && json_response_from_central) {
+                    cJSON *j_asignado = cJSON_GetObjectItemCaseSensitive(json_response_from_central, "ascensor_asignado_id");
+                    if (cJSON_IsString(j_asignado)) {
+                        assigned_index = elevator_group_find_index(gw_building_get(can_tracker->building_index), j_asignado->valuestring);
+                    }
+                }
+                gw_journal_record(GW_JOURNAL_RESPONSE_RECEIVED, can_tracker->building_index,
+                                  assigned_index >= 0 ? (uint8_t)assigned_index : GW_JOURNAL_NO_ELEVATOR,
+                                  0, (int16_t)can_tracker->target_floor_for_task, can_tracker->original_can_id, rcv_code);
+            }
+            ag_can_bridge_send_building_response_frame(can_tracker->building_index, can_tracker->original_can_id, rcv_code, json_response_from_central);
+            slot->span.ns[GW_SPAN_CAN_TX] = gw_tracker_now_ns();
+            exec_logger_record_request_span(&slot->span, GW_SPAN_OUTCOME_SERVED);
+            gw_tracker_release(slot);
         } else {
             // No es un tracker de API y no es un tracker de CAN.
             // Podría ser una respuesta a una solicitud autoiniciada por el gateway (ej. send_arrival_update)
@@ -494,6 +398,69 @@ hnd_central_server_response_gw(coap_session_t *session_from_server,
 }
 
 
+/**
+ * @brief Descarta un tracker cuya solicitud no obtendrá respuesta
+ * @param slot Slot del tracker (sigue ocupado durante la llamada)
+ * 
+ * Si la solicitud era de origen CAN se notifica el error al simulador
+ * con un frame 0xFE. No libera el slot; lo hace el llamador.
+ * 
+ * @see gw_tracker_expire()
+ */
+void hnd_tracker_timeout_gw(struct gw_tracker_slot_t *slot) {
+    if (!slot) {
+        return;
+    }
+    if (slot->origin == GW_TRACKER_ORIGIN_CAN) {
+        LOG_WARN_GW("[ResponseHandlerGW] Solicitud CAN 0x%X sin respuesta del Servidor Central. Notificando error.", slot->data.can.original_can_id);
+        ag_can_bridge_send_building_response_frame(slot->data.can.building_index, slot->data.can.original_can_id, COAP_RESPONSE_CODE_SERVICE_UNAVAILABLE, NULL);
+        slot->span.ns[GW_SPAN_CAN_TX] = gw_tracker_now_ns();
+        exec_logger_record_request_span(&slot->span, GW_SPAN_OUTCOME_TIMED_OUT);
+        gw_journal_record(GW_JOURNAL_RESPONSE_RECEIVED, slot->data.can.building_index, GW_JOURNAL_NO_ELEVATOR,
+                          0, (int16_t)slot->data.can.target_floor_for_task, slot->data.can.original_can_id,
+                          COAP_RESPONSE_CODE_SERVICE_UNAVAILABLE);
+        if (slot->data.can.request_type == GW_REQUEST_TYPE_FLOOR_CALL) {
+            // Liberar la llamada para que la próxima pulsación se reenvíe
+            gw_hall_call_resolve(gw_building_hall_calls(slot->data.can.building_index), NULL,
+                                 slot->data.can.call_reference_floor, slot->data.can.requested_direction, NULL);
+        }
+    } else if (slot->origin == GW_TRACKER_ORIGIN_API) {
+        LOG_WARN_GW("[%s] Solicitud de cliente CoAP sin respuesta del Servidor Central.", slot->data.api.log_tag ? slot->data.api.log_tag : "ResponseHandlerGW_CoAP");
+    }
+}
+
+/**
+ * @brief Manejador de NACKs para solicitudes al servidor central
+ * @param session Sesión CoAP por la que se envió la solicitud
+ * @param sent PDU enviado que no obtuvo respuesta (puede ser NULL)
+ * @param reason Motivo del NACK (timeout, RST, error TLS, etc.)
+ * @param mid Message ID del PDU enviado
+ * 
+ * Cuando libcoap agota las retransmisiones o la sesión falla, la respuesta
+ * nunca llegará. Este manejador libera el slot del tracker asociado al
+ * token para que el slab no se agote con solicitudes huérfanas.
+ * 
+ * @see hnd_tracker_timeout_gw()
+ * @see gw_tracker_release()
+ */
+void
+hnd_central_server_nack_gw(coap_session_t *session,
+                           const coap_pdu_t *sent,
+                           const coap_nack_reason_t reason,
+                           const coap_mid_t mid) {
+    (void)session;
+    if (!sent) {
+        return;
+    }
+    gw_tracker_slot_t *slot = gw_tracker_lookup(coap_pdu_get_token(sent));
+    if (!slot) {
+        return;
+    }
+    LOG_WARN_GW("[ResponseHandlerGW] Solicitud al Servidor Central sin respuesta (NACK %d, MID: %u). Liberando tracker.", reason, mid);
+    hnd_tracker_timeout_gw(slot);
+    gw_tracker_release(slot);
+}
+
 // ---- RESOURCE HANDLERS ---- 
 // (Minor log changes in these handlers, mainly adding color/context)
 
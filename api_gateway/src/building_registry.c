@@ -0,0 +1,148 @@
+/**
+ * @file building_registry.c
+ * @brief Implementación del registro de edificios del API Gateway
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Los grupos se guardan como punteros: el índice 0 apunta a
+ * managed_elevator_group y el resto se reservan bajo demanda (grupo y tabla
+ * de llamadas de piso en un mismo bloque), de modo que un proceso con un
+ * solo edificio no paga la memoria de GW_MAX_BUILDINGS grupos.
+ *
+ * @see building_registry.h
+ */
+
+#include "api_gateway/building_registry.h"
+#include "api_gateway/logging_gw.h"
+#include "api_gateway/state_journal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Grupo del edificio por defecto (definido en main.c)
+ */
+extern elevator_group_state_t managed_elevator_group;
+
+/**
+ * @brief Estado reservado para cada edificio con índice > 0
+ */
+typedef struct {
+    elevator_group_state_t group;       ///< Grupo de ascensores del edificio
+    gw_hall_call_table_t hall_calls;    ///< Llamadas de piso activas del edificio
+} building_storage_t;
+
+/**
+ * @brief Grupos de ascensores por índice de edificio
+ */
+static elevator_group_state_t *building_groups[GW_MAX_BUILDINGS];
+
+/**
+ * @brief Tablas de llamadas de piso por índice de edificio
+ */
+static gw_hall_call_table_t *building_hall_calls[GW_MAX_BUILDINGS];
+
+/**
+ * @brief Bloques reservados para los edificios con índice > 0
+ */
+static building_storage_t *building_storage[GW_MAX_BUILDINGS];
+
+/**
+ * @brief Tabla de llamadas de piso del edificio por defecto
+ */
+static gw_hall_call_table_t default_hall_calls;
+
+/**
+ * @brief Número de edificios registrados
+ */
+static uint16_t num_buildings = 0;
+
+void gw_building_registry_init(void) {
+    for (uint16_t i = 1; i < GW_MAX_BUILDINGS; ++i) {
+        if (building_storage[i]) {
+            elevator_group_destroy(&building_storage[i]->group);
+        }
+        free(building_storage[i]);
+        building_storage[i] = NULL;
+        building_groups[i] = NULL;
+        building_hall_calls[i] = NULL;
+    }
+    elevator_group_destroy(&managed_elevator_group);
+    building_groups[GW_BUILDING_INDEX_DEFAULT] = &managed_elevator_group;
+    building_hall_calls[GW_BUILDING_INDEX_DEFAULT] = &default_hall_calls;
+    gw_hall_call_table_reset(&default_hall_calls);
+    num_buildings = 0;
+}
+
+void gw_building_registry_cleanup(void) {
+    gw_building_registry_init();
+}
+
+int gw_building_find(const char *edificio_id) {
+    if (!edificio_id) return -1;
+    for (uint16_t i = 0; i < num_buildings; ++i) {
+        if (strcmp(building_groups[i]->edificio_id_str_grupo, edificio_id) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int gw_building_add(const char *edificio_id, int num_elevadores, int num_pisos) {
+    if (!edificio_id) return -1;
+
+    int index = gw_building_find(edificio_id);
+    if (index < 0) {
+        if (num_buildings >= GW_MAX_BUILDINGS) {
+            LOG_ERROR_GW("[Buildings] Registro lleno (%d edificios). No se añade '%s'.", GW_MAX_BUILDINGS, edificio_id);
+            return -1;
+        }
+        index = num_buildings;
+        if (index == GW_BUILDING_INDEX_DEFAULT) {
+            building_groups[index] = &managed_elevator_group;
+            building_hall_calls[index] = &default_hall_calls;
+        } else if (!building_storage[index]) {
+            building_storage[index] = calloc(1, sizeof(building_storage_t));
+            if (!building_storage[index]) {
+                LOG_ERROR_GW("[Buildings] Sin memoria para el edificio '%s'.", edificio_id);
+                return -1;
+            }
+            building_groups[index] = &building_storage[index]->group;
+            building_hall_calls[index] = &building_storage[index]->hall_calls;
+        }
+        num_buildings++;
+    }
+
+    init_elevator_group(building_groups[index], edificio_id, num_elevadores, num_pisos);
+    building_groups[index]->building_index = (uint16_t)index;
+    gw_journal_record(GW_JOURNAL_BUILDING_ADDED, (uint16_t)index, GW_JOURNAL_NO_ELEVATOR,
+                      (int16_t)num_pisos, 0, gw_journal_hash_id(edificio_id), (uint32_t)num_elevadores);
+    gw_hall_call_table_reset(building_hall_calls[index]);
+    LOG_DEBUG_GW("[Buildings] Edificio '%s' registrado con índice %d (%u en total).", edificio_id, index, num_buildings);
+    return index;
+}
+
+elevator_group_state_t* gw_building_get(uint16_t building_index) {
+    if (building_index == GW_BUILDING_INDEX_DEFAULT) {
+        return &managed_elevator_group;
+    }
+    if (building_index >= num_buildings) {
+        return NULL;
+    }
+    return building_groups[building_index];
+}
+
+gw_hall_call_table_t* gw_building_hall_calls(uint16_t building_index) {
+    if (building_index == GW_BUILDING_INDEX_DEFAULT) {
+        return &default_hall_calls;
+    }
+    if (building_index >= num_buildings) {
+        return NULL;
+    }
+    return building_hall_calls[building_index];
+}
+
+uint16_t gw_building_count(void) {
+    return num_buildings > 0 ? num_buildings : 1;
+}
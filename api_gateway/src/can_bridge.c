@@ -21,10 +21,16 @@
  * - **0x200**: Solicitudes de cabina (cabin requests) con destino
  * - **0x300**: Notificaciones de llegada de ascensores
  * 
- * El puente mantiene un buffer circular de trackers para correlacionar
- * respuestas del servidor central con las solicitudes CAN originales.
+ * Las solicitudes CAN pendientes se registran en el slab unificado de
+ * trackers; el token CoAP enviado al servidor central identifica el slot.
+ * 
+ * Las llamadas de piso repetidas (mismo piso y dirección) no se reenvían:
+ * se absorben en la solicitud en vuelo (acuse 0x101 con data[0] =
+ * GW_CAN_ELEVATOR_PENDING) o se responden con la asignación existente
+ * (ver hall_call_registry.h).
  * 
  * @see can_bridge.h
+ * @see request_tracker.h
  * @see api_handlers.h
  * @see elevator_state_manager.h
  * @see coap_config.h
@@ -35,6 +41,11 @@
 #include "api_gateway/elevator_state_manager.h" // Para las enums y structs de estado, y elevator_group_to_json_for_server
 
 #include "api_gateway/execution_logger.h" // Sistema de logging de ejecuciones
+#include "api_gateway/request_tracker.h"  // Slab unificado de trackers
+#include "api_gateway/building_registry.h" // Grupo de ascensores por edificio
+#include "api_gateway/hall_call_registry.h" // Coalescencia de llamadas de piso
+#include "api_gateway/state_journal.h"      // Diario binario de transiciones
+#include "api_gateway/gateway_config.h"     // Rutas de recursos del servidor central
 
 #include <coap3/coap.h> 
 #include <stdio.h>
@@ -84,124 +95,24 @@ static void log_coap_token(const char *prefix, coap_bin_const_t token) {
  */
 static can_send_callback_t send_to_simulation_callback = NULL;
 
-/**
- * @brief Número máximo de trackers CAN simultáneos
- * 
- * Define el tamaño del buffer circular utilizado para almacenar
- * información de solicitudes originadas por CAN que están pendientes
- * de respuesta del servidor central.
- */
-#define MAX_CAN_ORIGIN_TRACKERS 10
-
-/**
- * @brief Buffer circular de trackers para solicitudes CAN
- * 
- * Array que almacena información de correlación entre solicitudes
- * CAN enviadas al servidor central y sus respuestas esperadas.
- * Se gestiona como un buffer circular para reutilizar entradas.
- * 
- * @see can_origin_tracker_t
- */
-static can_origin_tracker_t can_trackers[MAX_CAN_ORIGIN_TRACKERS];
-
-/**
- * @brief Índice del siguiente tracker CAN disponible
- * 
- * Índice que apunta a la siguiente posición disponible en el buffer
- * circular can_trackers. Se incrementa módulo MAX_CAN_ORIGIN_TRACKERS.
- */
-static int next_can_tracker_idx = 0;
-
-/**
- * @brief Estado del grupo de ascensores gestionado
- * 
- * Referencia externa al estado global del grupo de ascensores
- * definido en main.c. Se utiliza para acceder a información
- * del edificio y ascensores al procesar mensajes CAN.
- * 
- * @see main.c
- * @see elevator_group_state_t
- */
-extern elevator_group_state_t managed_elevator_group;
-
-/**
- * @brief Almacena un tracker CAN para correlación de respuestas
- * @param token Token CoAP de la solicitud enviada al servidor central
- * @param can_id ID del frame CAN original
- * @param req_type Tipo de solicitud (floor call, cabin request, etc.)
- * @param target_floor Piso destino de la tarea
- * @param ref_floor Piso de referencia (origen para floor calls)
- * @param elevator_id_if_cabin ID del ascensor (solo para cabin requests)
- * 
- * Esta función almacena información de correlación en el buffer circular
- * de trackers CAN. Crea una copia del token CoAP para evitar problemas
- * de memoria y libera automáticamente tokens anteriores si es necesario.
- * 
- * @see find_can_tracker()
- * @see can_origin_tracker_t
- */
-static void store_can_tracker(coap_bin_const_t token, uint32_t can_id, 
-                              gw_request_type_t req_type, int target_floor, int ref_floor,
-                              const char* elevator_id_if_cabin) {
-    if (token.length == 0 || token.s == NULL) return;
-
-    can_origin_tracker_t *tracker = &can_trackers[next_can_tracker_idx];
-    if (tracker->coap_token.s) { // Liberar token anterior si existe
-        coap_free(tracker->coap_token.s);
-    }
-    tracker->coap_token.length = token.length;
-    tracker->coap_token.s = (uint8_t *)coap_malloc(token.length);
-    if (!tracker->coap_token.s) {
-        LOG_ERROR_GW("[CAN_Bridge] Error al asignar memoria para token en tracker CAN.");
-        tracker->coap_token.length = 0;
-        return;
-    }
-    memcpy(tracker->coap_token.s, token.s, token.length);
-    tracker->original_can_id = can_id;
-    tracker->request_type = req_type;
-    tracker->target_floor_for_task = target_floor;
-    tracker->call_reference_floor = ref_floor;
-    if (elevator_id_if_cabin) {
-        strncpy(tracker->requesting_elevator_id_if_cabin, elevator_id_if_cabin, ID_STRING_MAX_LEN - 1);
-        tracker->requesting_elevator_id_if_cabin[ID_STRING_MAX_LEN - 1] = '\0';
-    } else {
-        tracker->requesting_elevator_id_if_cabin[0] = '\0';
-    }
-
-    log_coap_token("[CAN_Bridge] Stored token for CAN tracker", token);
-    LOG_DEBUG_GW("[CAN_Bridge] Stored CAN ID 0x%X at index %d", can_id, next_can_tracker_idx);
-    next_can_tracker_idx = (next_can_tracker_idx + 1) % MAX_CAN_ORIGIN_TRACKERS;
-}
-
 /**
  * @brief Busca un tracker CAN por token CoAP
  * @param token Token CoAP a buscar en los trackers almacenados
  * @return Puntero al tracker encontrado, o NULL si no se encuentra
  * 
- * Esta función busca en el buffer circular de trackers CAN un tracker
- * que corresponda al token CoAP especificado. Se utiliza para correlacionar
- * respuestas del servidor central con solicitudes CAN originales.
- * 
- * La búsqueda se realiza comparando tanto la longitud como el contenido
- * binario del token. No remueve el tracker de la lista (a diferencia
- * de find_and_remove_central_request_tracker).
+ * El token codifica el slot del slab unificado de trackers, por lo que la
+ * búsqueda es un acceso directo más una comprobación de generación. Solo
+ * devuelve trackers de origen CAN. No libera el slot; el llamador debe
+ * usar gw_tracker_release() una vez procesada la respuesta.
  * 
- * @see store_can_tracker()
+ * @see gw_tracker_lookup()
  * @see can_origin_tracker_t
  */
 can_origin_tracker_t* find_can_tracker(coap_bin_const_t token) {
     log_coap_token("[CAN_Bridge] Finding token for CAN tracker", token);
-    if (token.length == 0 || token.s == NULL) return NULL;
-    for (int i = 0; i < MAX_CAN_ORIGIN_TRACKERS; ++i) {
-        if (can_trackers[i].coap_token.length == token.length && 
-            can_trackers[i].coap_token.s && 
-            memcmp(can_trackers[i].coap_token.s, token.s, token.length) == 0) {
-            // LOG_DEBUG_GW("[CAN_Bridge] Found CAN tracker for token (len %zu) at index %d", token.length, i);
-            return &can_trackers[i];
-        }
-    }
-    // LOG_DEBUG_GW("[CAN_Bridge] No CAN tracker found for token (len %zu)", token.length);
-    return NULL;
+    gw_tracker_slot_t *slot = gw_tracker_lookup(token);
+    if (!slot || slot->origin != GW_TRACKER_ORIGIN_CAN) return NULL;
+    return &slot->data.can;
 }
 
 /**
@@ -212,9 +123,9 @@ can_origin_tracker_t* find_can_tracker(coap_bin_const_t token) {
  * 
  * Operaciones realizadas:
  * - Limpia el callback de envío CAN
- * - Libera memoria de tokens almacenados en trackers
- * - Inicializa a cero el buffer de trackers CAN
- * - Resetea el índice del buffer circular
+ * 
+ * Los trackers de solicitudes CAN viven en el slab unificado
+ * (request_tracker.h), que se inicializa con gw_tracker_init().
  * 
  * Debe llamarse una vez al inicio del programa antes de procesar
  * cualquier frame CAN o registrar callbacks.
@@ -225,13 +136,6 @@ can_origin_tracker_t* find_can_tracker(coap_bin_const_t token) {
 void ag_can_bridge_init(void) {
     LOG_INFO_GW("[CAN_Bridge] Inicializando el puente CAN simulado.");
     send_to_simulation_callback = NULL;
-    for (int i = 0; i < MAX_CAN_ORIGIN_TRACKERS; ++i) {
-        if (can_trackers[i].coap_token.s) {
-            coap_free(can_trackers[i].coap_token.s);
-        }
-        memset(&can_trackers[i], 0, sizeof(can_origin_tracker_t));
-    }
-    next_can_tracker_idx = 0;
 }
 
 /**
@@ -260,17 +164,42 @@ void ag_can_bridge_register_send_callback(can_send_callback_t callback) {
 // pero adaptada para orígenes CAN.
 static void forward_can_originated_request_to_central_server(
     coap_context_t *ctx,
+    uint16_t building_index,
     uint32_t original_can_id,
-    const char *central_server_path,
+    const gw_uri_path_t *central_server_path,
     const char *log_tag_param,
     gw_request_type_t request_type_param,
     int origin_floor_param,
     int target_floor_for_task_param,
     const char* requesting_elevator_id_cabin_param,
-    movement_direction_enum_t requested_direction_floor_param
+    movement_direction_enum_t requested_direction_floor_param,
+    uint64_t can_rx_ns
 ); // Definición más abajo
 
 
+/**
+ * @brief Rellena un frame de respuesta de éxito con una asignación
+ * @param frame Frame a rellenar (id, data y dlc)
+ * @param original_can_id ID del frame CAN que originó la solicitud
+ * @param elevator_index Índice del ascensor asignado (0xFF si se desconoce)
+ * @param tarea_id ID de la tarea (puede ser NULL); se trunca a los bytes libres
+ * 
+ * Formato: ID = original + 1, data[0] = índice del ascensor y a
+ * continuación los primeros caracteres del ID de tarea.
+ */
+static void fill_assignment_response_frame(simulated_can_frame_t *frame, uint32_t original_can_id,
+                                           uint8_t elevator_index, const char *tarea_id) {
+    uint8_t current_dlc = 0;
+    frame->id = original_can_id + 1;
+    frame->data[current_dlc++] = elevator_index;
+    if (tarea_id) {
+        size_t len = strnlen(tarea_id, CAN_MAX_DATA_LEN - current_dlc);
+        memcpy(&frame->data[current_dlc], tarea_id, len);
+        current_dlc += len;
+    }
+    frame->dlc = current_dlc;
+}
+
 /**
  * @brief Procesa un frame CAN entrante y lo convierte a solicitud CoAP
  * @param frame Puntero al frame CAN simulado a procesar
@@ -302,10 +231,12 @@ static void forward_can_originated_request_to_central_server(
  *       el esquema específico del sistema de ascensores
  * 
  * @see forward_can_originated_request_to_central_server()
- * @see store_can_tracker()
+ * @see gw_tracker_alloc()
  * @see simulated_can_frame_t
  */
 void ag_can_bridge_process_incoming_frame(simulated_can_frame_t* frame, coap_context_t *coap_ctx) {
+    // Inicio del span de la solicitud (ver request_span.h)
+    uint64_t can_rx_ns = gw_tracker_now_ns();
     if (!frame) {
         LOG_ERROR_GW("[CAN_Bridge] Frame CAN simulado nulo recibido.");
         return;
@@ -315,7 +246,13 @@ void ag_can_bridge_process_incoming_frame(simulated_can_frame_t* frame, coap_con
         return;
     }
 
-    LOG_INFO_GW("[CAN_Bridge] Procesando frame CAN ID: 0x%X, DLC: %d", frame->id, frame->dlc);
+    elevator_group_state_t *group = gw_building_get(frame->building_index);
+    if (!group) {
+        LOG_WARN_GW("[CAN_Bridge] Frame CAN ID 0x%X de edificio desconocido (índice %u). Descartado.", frame->id, frame->building_index);
+        return;
+    }
+
+    LOG_INFO_GW("[CAN_Bridge] Procesando frame CAN ID: 0x%X, DLC: %d (edificio %s)", frame->id, frame->dlc, group->edificio_id_str_grupo);
 
     // --- Lógica de ejemplo para interpretar IDs CAN ---
     // --- ¡DEBES ADAPTAR ESTO A TU ESQUEMA DE MENSAJES CAN! ---
@@ -325,16 +262,52 @@ void ag_can_bridge_process_incoming_frame(simulated_can_frame_t* frame, coap_con
                 int piso_origen = frame->data[0];
                 movement_direction_enum_t direccion = (frame->data[1] == 0) ? MOVING_UP : MOVING_DOWN; // 0=UP, 1=DOWN
                 LOG_INFO_GW("[CAN_Bridge] Llamada de piso CAN: Piso %d, Dirección %s", piso_origen, movement_direction_to_string(direccion));
-                
+
+                // Pulsaciones repetidas: no contactar al servidor central
+                int ascensor_asignado = -1;
+                gw_hall_call_status_t hall_status = gw_hall_call_check(gw_building_hall_calls(frame->building_index), group,
+                                                                       piso_origen, direccion, &ascensor_asignado);
+                if (hall_status == GW_HALL_CALL_PENDING) {
+                    LOG_INFO_GW("[CAN_Bridge] Llamada piso %d %s ya pendiente en el Servidor Central. Pulsación absorbida.",
+                                piso_origen, movement_direction_to_string(direccion));
+                    // Acuse local: la llamada consta, la asignación llegará con la respuesta en vuelo
+                    if (send_to_simulation_callback) {
+                        simulated_can_frame_t ack_frame;
+                        memset(&ack_frame, 0, sizeof(ack_frame));
+                        ack_frame.building_index = frame->building_index;
+                        fill_assignment_response_frame(&ack_frame, frame->id, GW_CAN_ELEVATOR_PENDING, NULL);
+                        send_to_simulation_callback(&ack_frame);
+                    }
+                    break;
+                }
+                if (hall_status == GW_HALL_CALL_ASSIGNED) {
+                    const elevator_ids_t *ids = &group->ids[ascensor_asignado];
+                    LOG_INFO_GW("[CAN_Bridge] Llamada piso %d %s ya asignada a %s (tarea %s). Respondiendo localmente.",
+                                piso_origen, movement_direction_to_string(direccion), ids->ascensor_id, ids->tarea_actual_id);
+                    if (send_to_simulation_callback) {
+                        simulated_can_frame_t response_frame;
+                        memset(&response_frame, 0, sizeof(response_frame));
+                        response_frame.building_index = frame->building_index;
+                        fill_assignment_response_frame(&response_frame, frame->id, (uint8_t)ascensor_asignado, ids->tarea_actual_id);
+                        send_to_simulation_callback(&response_frame);
+                    }
+                    gw_request_span_t local_span = {0};
+                    local_span.ns[GW_SPAN_CAN_RX] = can_rx_ns;
+                    local_span.ns[GW_SPAN_CAN_TX] = gw_tracker_now_ns();
+                    exec_logger_record_request_span(&local_span, GW_SPAN_OUTCOME_LOCAL);
+                    break;
+                }
+
                 forward_can_originated_request_to_central_server(
-                    coap_ctx, frame->id,
-                    getenv("FLOOR_CALL_RESOURCE"), 
+                    coap_ctx, frame->building_index, frame->id,
+                    &gw_config()->floor_call_path, 
                     "CAN_FloorCall", 
                     GW_REQUEST_TYPE_FLOOR_CALL, 
                     piso_origen, 
                     piso_origen, // Para floor call, el target inicial es el mismo piso origen
                     NULL, // No aplica elevator_id para el tracker aquí (es floor call)
-                    direccion);
+                    direccion,
+                    can_rx_ns);
             } else {
                 LOG_WARN_GW("[CAN_Bridge] Frame CAN 0x100 (Llamada Piso) con DLC insuficiente: %d", frame->dlc);
             }
@@ -342,27 +315,26 @@ void ag_can_bridge_process_incoming_frame(simulated_can_frame_t* frame, coap_con
 
         case 0x200: // Ejemplo: Solicitud de cabina
             if (frame->dlc >= 2) {
-                char elevator_id_str[atoi(getenv("ID_STRING_MAX_LEN"))];
-                int elevator_number = frame->data[0] + 1;
-                int max_building_id_len = atoi(getenv("ID_STRING_MAX_LEN")) - 1 /*null*/ - 1 /*A*/ - 3 /*NNN for elevator number*/;
-                if (max_building_id_len < 1) max_building_id_len = 1; // ensure at least 1 char for building id part
-
-                snprintf(elevator_id_str, sizeof(elevator_id_str), "%.*sA%d", 
-                         max_building_id_len,
-                         managed_elevator_group.edificio_id_str_grupo, 
-                         elevator_number);
+                // data[0] es el índice denso del ascensor: su ID ya está en el grupo
+                int elevator_index = frame->data[0];
+                if (elevator_index >= group->num_elevadores_en_grupo) {
+                    LOG_WARN_GW("[CAN_Bridge] Solicitud de cabina CAN para ascensor inexistente (idx %d, edificio %s).", elevator_index, group->edificio_id_str_grupo);
+                    break;
+                }
+                const char *elevator_id_str = group->ids[elevator_index].ascensor_id;
                 int piso_destino = frame->data[1];
                 LOG_INFO_GW("[CAN_Bridge] Solicitud de cabina CAN: Ascensor %s (idx %d), Piso Destino %d", elevator_id_str, frame->data[0], piso_destino);
 
                 forward_can_originated_request_to_central_server(
-                    coap_ctx, frame->id,
-                    getenv("CABIN_REQUEST_RESOURCE"), 
+                    coap_ctx, frame->building_index, frame->id,
+                    &gw_config()->cabin_request_path, 
                     "CAN_CabinReq", 
                     GW_REQUEST_TYPE_CABIN_REQUEST, 
                     -1, // No aplica origin_floor para cabin request aquí como ref_floor para el tracker (podría ser el actual del elevador)
                     piso_destino, 
                     elevator_id_str, // requesting_elevator_id_cabin_param
-                    DIRECTION_UNKNOWN);
+                    DIRECTION_UNKNOWN,
+                    can_rx_ns);
             } else {
                 LOG_WARN_GW("[CAN_Bridge] Frame CAN 0x200 (Solicitud Cabina) con DLC insuficiente: %d", frame->dlc);
             }
@@ -370,62 +342,59 @@ void ag_can_bridge_process_incoming_frame(simulated_can_frame_t* frame, coap_con
         
         case 0x300: // Ejemplo: Notificación de llegada (esto lo maneja la simulación interna, pero si viniera de CAN)
             if (frame->dlc >= 2) {
-                char elevator_id_str[atoi(getenv("ID_STRING_MAX_LEN"))];
-                int elevator_number = frame->data[0] + 1;
-                int max_building_id_len = atoi(getenv("ID_STRING_MAX_LEN")) - 1 /*null*/ - 1 /*A*/ - 3 /*NNN for elevator number*/;
-                if (max_building_id_len < 1) max_building_id_len = 1; // ensure at least 1 char for building id part
-                
-                snprintf(elevator_id_str, sizeof(elevator_id_str), "%.*sA%d", 
-                         max_building_id_len,
-                         managed_elevator_group.edificio_id_str_grupo, 
-                         elevator_number);
+                int elevator_index = frame->data[0];
                 int piso_actual = frame->data[1];
                 // Opcional: door_state frame->data[2]
-                LOG_INFO_GW("[CAN_Bridge] Notificación de llegada CAN: Ascensor %s, Piso %d", elevator_id_str, piso_actual);
+                bool found = elevator_index < group->num_elevadores_en_grupo;
+                LOG_INFO_GW("[CAN_Bridge] Notificación de llegada CAN: Ascensor %s, Piso %d",
+                            found ? group->ids[elevator_index].ascensor_id : "?", piso_actual);
                 
-                // Actualizar estado local directamente
-                bool found = false;
-                for (int i = 0; i < managed_elevator_group.num_elevadores_en_grupo; ++i) {
-                    elevator_status_t *elevator = &managed_elevator_group.ascensores[i];
-                    if (strcmp(elevator->ascensor_id, elevator_id_str) == 0) {
-                        found = true;
-                        LOG_INFO_GW("StateMgr: Ascensor %s llegó al piso %d. (Piso anterior: %d, Destino tarea: %d)", 
-                                    elevator->ascensor_id, piso_actual, elevator->piso_actual, elevator->destino_actual);
+                // Actualizar estado local directamente (acceso por índice denso)
+                if (found) {
+                    elevator_ids_t *ids = &group->ids[elevator_index];
+                    LOG_INFO_GW("StateMgr: Ascensor %s llegó al piso %d. (Piso anterior: %d, Destino tarea: %d)", 
+                                ids->ascensor_id, piso_actual, group->piso_actual[elevator_index], group->destino_actual[elevator_index]);
+                    
+                    // Registrar movimiento del ascensor en el logger
+                    exec_logger_log_elevator_moved(ids->ascensor_id, group->piso_actual[elevator_index], piso_actual, 
+                                                  movement_direction_to_string(group->direccion_movimiento[elevator_index]));
+                    
+                    elevator_group_write_begin(group);
+                    group->piso_actual[elevator_index] = piso_actual;
+                    elevator_group_mark_dirty(group);
+                    gw_journal_record(GW_JOURNAL_ELEVATOR_MOVED, frame->building_index, (uint8_t)elevator_index,
+                                      (int16_t)piso_actual, group->destino_actual[elevator_index], 0,
+                                      group->direccion_movimiento[elevator_index]);
+
+                    if (group->destino_actual[elevator_index] == piso_actual) {
+                        LOG_INFO_GW("StateMgr: Ascensor %s completó tarea %s en piso %d.", 
+                                    ids->ascensor_id, 
+                                    ids->tarea_actual_id[0] != '\0' ? ids->tarea_actual_id : "N/A", 
+                                    piso_actual);
                         
-                        // Registrar movimiento del ascensor en el logger
-                        exec_logger_log_elevator_moved(elevator->ascensor_id, elevator->piso_actual, piso_actual, 
-                                                      movement_direction_to_string(elevator->direccion_movimiento_enum));
-                        
-                        elevator->piso_actual = piso_actual;
-
-                        if (elevator->destino_actual == piso_actual) {
-                            LOG_INFO_GW("StateMgr: Ascensor %s completó tarea %s en piso %d.", 
-                                        elevator->ascensor_id, 
-                                        elevator->tarea_actual_id[0] != '\0' ? elevator->tarea_actual_id : "N/A", 
-                                        piso_actual);
-                            
-                            // Registrar completación de tarea en el logger
-                            if (elevator->tarea_actual_id[0] != '\0') {
-                                exec_logger_log_task_completed(elevator->tarea_actual_id, elevator->ascensor_id, piso_actual);
-                            }
-                            
-                            elevator->estado_puerta_enum = DOOR_OPEN;
-                            elevator->ocupado = false;
-                            elevator->tarea_actual_id[0] = '\0'; // Limpiar ID de tarea
-                            elevator->destino_actual = -1;        // Limpiar destino
-                            elevator->direccion_movimiento_enum = STOPPED;
-                            
-                            LOG_INFO_GW("[CAN_Bridge] Tarea completada por %s (vía CAN). Se notificará al servidor.", elevator_id_str);
-                        } else {
-                            LOG_WARN_GW("StateMgr: Ascensor %s llegó a piso %d, pero su destino final es %d. No se completa tarea aún.",
-                                        elevator->ascensor_id, piso_actual, elevator->destino_actual);
+                        // Registrar completación de tarea en el logger
+                        if (ids->tarea_actual_id[0] != '\0') {
+                            exec_logger_log_task_completed(ids->tarea_actual_id, ids->ascensor_id, piso_actual);
                         }
-                        break;
+                        gw_journal_record(GW_JOURNAL_ELEVATOR_ARRIVED, frame->building_index, (uint8_t)elevator_index,
+                                          (int16_t)piso_actual, 0, gw_journal_hash_id(ids->tarea_actual_id), 0);
+                        
+                        group->estado_puerta[elevator_index] = DOOR_OPEN;
+                        group->ocupado[elevator_index] = false;
+                        ids->tarea_actual_id[0] = '\0'; // Limpiar ID de tarea
+                        group->destino_actual[elevator_index] = -1;        // Limpiar destino
+                        group->direccion_movimiento[elevator_index] = STOPPED;
+                        
+                        LOG_INFO_GW("[CAN_Bridge] Tarea completada por %s (vía CAN). Se notificará al servidor.", ids->ascensor_id);
+                    } else {
+                        LOG_WARN_GW("StateMgr: Ascensor %s llegó a piso %d, pero su destino final es %d. No se completa tarea aún.",
+                                    ids->ascensor_id, piso_actual, group->destino_actual[elevator_index]);
                     }
+                    elevator_group_write_end(group);
                 }
 
                 if (!found) {
-                    LOG_ERROR_GW("StateMgr: notify_arrival - Ascensor con ID '%s' no encontrado en el grupo.", elevator_id_str);
+                    LOG_ERROR_GW("StateMgr: notify_arrival - Ascensor con índice %d no encontrado en el grupo %s.", elevator_index, group->edificio_id_str_grupo);
                 }
             } else {
                  LOG_WARN_GW("[CAN_Bridge] Frame CAN 0x300 (Notif. Llegada) con DLC insuficiente: %d", frame->dlc);
@@ -438,10 +407,55 @@ void ag_can_bridge_process_incoming_frame(simulated_can_frame_t* frame, coap_con
     }
 }
 
+/**
+ * @brief Reenvía al servidor central una solicitud de origen CAN ya conocida
+ */
+void ag_can_bridge_resubmit_request(coap_context_t *coap_ctx, const can_origin_tracker_t *request) {
+    if (!coap_ctx || !request) {
+        return;
+    }
+    switch (request->request_type) {
+        case GW_REQUEST_TYPE_FLOOR_CALL:
+            forward_can_originated_request_to_central_server(
+                coap_ctx, request->building_index, request->original_can_id,
+                &gw_config()->floor_call_path,
+                "CAN_FloorCall",
+                GW_REQUEST_TYPE_FLOOR_CALL,
+                request->call_reference_floor,
+                request->target_floor_for_task,
+                NULL,
+                request->requested_direction,
+                gw_tracker_now_ns());
+            break;
+        case GW_REQUEST_TYPE_CABIN_REQUEST:
+            forward_can_originated_request_to_central_server(
+                coap_ctx, request->building_index, request->original_can_id,
+                &gw_config()->cabin_request_path,
+                "CAN_CabinReq",
+                GW_REQUEST_TYPE_CABIN_REQUEST,
+                request->call_reference_floor,
+                request->target_floor_for_task,
+                request->requesting_elevator_id_if_cabin,
+                DIRECTION_UNKNOWN,
+                gw_tracker_now_ns());
+            break;
+        default:
+            LOG_WARN_GW("[CAN_Bridge] Tipo de solicitud %d no reenviable (CAN ID 0x%X).", request->request_type, request->original_can_id);
+            break;
+    }
+}
+
 /**
  * @brief Envía una respuesta (traducida de CoAP) como un frame CAN simulado a la simulación.
  */
 void ag_can_bridge_send_response_frame(uint32_t original_can_id, coap_pdu_code_t response_code, cJSON* server_response_json) {
+    ag_can_bridge_send_building_response_frame(GW_BUILDING_INDEX_DEFAULT, original_can_id, response_code, server_response_json);
+}
+
+/**
+ * @brief Envía una respuesta CAN al bus de un edificio concreto
+ */
+void ag_can_bridge_send_building_response_frame(uint16_t building_index, uint32_t original_can_id, coap_pdu_code_t response_code, cJSON* server_response_json) {
     if (!send_to_simulation_callback) {
         LOG_WARN_GW("[CAN_Bridge] Callback de envío a simulación no registrado. No se puede enviar respuesta CAN.");
         return;
@@ -450,6 +464,7 @@ void ag_can_bridge_send_response_frame(uint32_t original_can_id, coap_pdu_code_t
     simulated_can_frame_t response_frame;
     memset(&response_frame, 0, sizeof(simulated_can_frame_t));
     response_frame.dlc = 0; // Initialize DLC
+    response_frame.building_index = building_index;
 
     bool is_success_code = (COAP_RESPONSE_CLASS(response_code) == 2);
 
@@ -484,9 +499,7 @@ void ag_can_bridge_send_response_frame(uint32_t original_can_id, coap_pdu_code_t
         cJSON *j_ascensor_asignado_id = cJSON_GetObjectItemCaseSensitive(server_response_json, "ascensor_asignado_id");
         cJSON *j_tarea_id = cJSON_GetObjectItemCaseSensitive(server_response_json, "tarea_id");
 
-        response_frame.id = original_can_id + 1; // Example: Success CAN ID
-
-        uint8_t current_dlc = 0;
+        uint8_t elevator_index = 0xFF; // Error/unknown elevator index
         if (cJSON_IsString(j_ascensor_asignado_id) && j_ascensor_asignado_id->valuestring != NULL) {
             const char* assigned_id_str = j_ascensor_asignado_id->valuestring;
             // Attempt to extract elevator index number (e.g., from "E1A1" -> 0, "E1A2" -> 1)
@@ -495,33 +508,26 @@ void ag_can_bridge_send_response_frame(uint32_t original_can_id, coap_pdu_code_t
             if (num_part && *(num_part + 1) != '\0') { // Corrected: single backslash for null terminator
                 int elevator_num = atoi(num_part + 1);
                 if (elevator_num > 0) { // atoi returns 0 on error or for "A0"
-                    response_frame.data[current_dlc++] = (uint8_t)(elevator_num - 1);
+                    elevator_index = (uint8_t)(elevator_num - 1);
                 } else {
                     LOG_WARN_GW("[CAN_Bridge] No se pudo extraer número válido de ascensor de: %s", assigned_id_str);
-                    response_frame.data[current_dlc++] = 0xFF; // Error/unknown elevator index
                 }
             } else {
                 LOG_WARN_GW("[CAN_Bridge] Formato de ID de ascensor no esperado: %s", assigned_id_str);
-                response_frame.data[current_dlc++] = 0xFF; // Error/unknown elevator index
             }
         } else {
             LOG_WARN_GW("[CAN_Bridge] 'ascensor_asignado_id' no encontrado o no es string en JSON de éxito.");
-            response_frame.data[current_dlc++] = 0xFF; // Indicate missing assigned elevator
         }
 
+        const char *tarea_id = NULL;
         if (cJSON_IsString(j_tarea_id) && j_tarea_id->valuestring != NULL) {
-            strncpy((char*)&response_frame.data[current_dlc], j_tarea_id->valuestring, CAN_MAX_DATA_LEN - current_dlc);
-            // Ensure null termination if it fits, though CAN data isn't typically C-strings
-            if (strlen(j_tarea_id->valuestring) < (CAN_MAX_DATA_LEN - current_dlc)) {
-                 response_frame.data[current_dlc + strlen(j_tarea_id->valuestring)] = '\0'; // Corrected: single backslash for null terminator // if space allows
-            }
-            current_dlc += strnlen((char*)&response_frame.data[current_dlc], CAN_MAX_DATA_LEN - current_dlc);
+            tarea_id = j_tarea_id->valuestring;
         } else {
             LOG_WARN_GW("[CAN_Bridge] 'tarea_id' no encontrado o no es string en JSON de éxito.");
             // No specific byte for missing task_id, but DLC will be smaller
         }
-        
-        response_frame.dlc = current_dlc;
+
+        fill_assignment_response_frame(&response_frame, original_can_id, elevator_index, tarea_id);
         if (response_frame.dlc == 0) { // If somehow nothing was added
              LOG_WARN_GW("[CAN_Bridge] Respuesta de éxito pero no se generaron datos CAN para ID original 0x%X. Enviando error CAN.", original_can_id);
              response_frame.id = 0xFE; 
@@ -545,14 +551,16 @@ void ag_can_bridge_send_response_frame(uint32_t original_can_id, coap_pdu_code_t
 static void
 forward_can_originated_request_to_central_server(
     coap_context_t *ctx,
+    uint16_t building_index,
     uint32_t original_can_id,
-    const char *central_server_path,
+    const gw_uri_path_t *central_server_path,
     const char *log_tag_param,
     gw_request_type_t request_type_param,
     int origin_floor_param,
     int target_floor_for_task_param,
     const char* requesting_elevator_id_cabin_param,
-    movement_direction_enum_t requested_direction_floor_param
+    movement_direction_enum_t requested_direction_floor_param,
+    uint64_t can_rx_ns
 ) {
     if (!central_server_path || !log_tag_param) {
         LOG_ERROR_GW("[CAN_Fwd] Error: central_server_path o log_tag_param es NULL.");
@@ -584,19 +592,33 @@ forward_can_originated_request_to_central_server(
     }
     
     // ---- Generar Payload JSON ----
-    char *json_payload_str = NULL;
-    // Usamos &managed_elevator_group que es extern y está definida en main.c
-    cJSON *json_payload_obj = elevator_group_to_json_for_server(&managed_elevator_group, request_type_param, &json_details);
-    if (!json_payload_obj) {
+    // Se formatea directamente en un buffer en pila; solo los payloads que
+    // no caben usan un buffer reservado (json_payload_heap).
+    char json_payload_buf[GW_JSON_PAYLOAD_BUF_SIZE];
+    char *json_payload_str = json_payload_buf;
+    char *json_payload_heap = NULL;
+    // Estado del edificio que originó el frame
+    elevator_group_state_t *group = gw_building_get(building_index);
+    if (!group) {
+        LOG_ERROR_GW(ANSI_COLOR_RED "[%s] Error: Edificio %u no registrado." ANSI_COLOR_RESET "\n", log_tag_param, building_index);
+        return;
+    }
+    int json_len = elevator_group_write_json_for_server(group, request_type_param, &json_details,
+                                                        json_payload_buf, sizeof(json_payload_buf));
+    if (json_len < 0) {
         LOG_ERROR_GW(ANSI_COLOR_RED "[%s] Error: Fallo al generar JSON para origen CAN." ANSI_COLOR_RESET "\n", log_tag_param);
         return; // No hay tracker que liberar aquí, es estático.
     }
-    json_payload_str = cJSON_PrintUnformatted(json_payload_obj);
-    cJSON_Delete(json_payload_obj);
-    if (!json_payload_str) {
-        LOG_ERROR_GW(ANSI_COLOR_RED "[%s] Error: Fallo al convertir JSON a string para origen CAN." ANSI_COLOR_RESET "\n", log_tag_param);
-        return; // No hay tracker que liberar aquí
+    if ((size_t)json_len >= sizeof(json_payload_buf)) {
+        json_payload_heap = malloc((size_t)json_len + 1);
+        if (!json_payload_heap) {
+            LOG_ERROR_GW(ANSI_COLOR_RED "[%s] Error: Sin memoria para payload JSON de %d bytes (origen CAN)." ANSI_COLOR_RESET "\n", log_tag_param, json_len);
+            return; // No hay tracker que liberar aquí
+        }
+        elevator_group_write_json_for_server(group, request_type_param, &json_details, json_payload_heap, (size_t)json_len + 1);
+        json_payload_str = json_payload_heap;
     }
+    uint64_t json_done_ns = gw_tracker_now_ns();
     LOG_DEBUG_GW("[%s] Payload para Servidor Central (Origen CAN ID: 0x%X): %s", log_tag_param, original_can_id, json_payload_str);
 
     // ---- Sesión con el servidor central (DTLS) ----
@@ -604,7 +626,7 @@ forward_can_originated_request_to_central_server(
     coap_session_t *session_to_central = get_or_create_central_server_dtls_session(ctx);
     if (!session_to_central) {
         LOG_ERROR_GW(ANSI_COLOR_RED "[%s] Error creando/obteniendo sesión DTLS con servidor central para origen CAN." ANSI_COLOR_RESET "\n", log_tag_param);
-        free(json_payload_str);
+        free(json_payload_heap);
         return; // No hay tracker que liberar, y la sesión global se gestiona internamente
     }
 
@@ -612,85 +634,48 @@ forward_can_originated_request_to_central_server(
     coap_pdu_t *pdu_to_central = coap_new_pdu(COAP_MESSAGE_CON, COAP_REQUEST_CODE_POST, session_to_central);
     if (!pdu_to_central) {
         LOG_ERROR_GW(ANSI_COLOR_RED "[%s] Error creando PDU para servidor central (origen CAN)." ANSI_COLOR_RESET "\n", log_tag_param);
-        free(json_payload_str);
+        free(json_payload_heap);
         // La sesión global no se libera aquí
         return;
     }
 
-    // ---- Añadir Token NUEVO a la PDU para el servidor central ----
-    uint8_t token_data[8]; 
-    size_t token_length = sizeof(token_data);
-    coap_session_new_token(session_to_central, &token_length, token_data);
-    
-    if (!coap_add_token(pdu_to_central, token_length, token_data)) {
-         LOG_WARN_GW(ANSI_COLOR_YELLOW "[%s] Advertencia: Fallo al añadir NUEVO token a PDU (origen CAN)." ANSI_COLOR_RESET "\n", log_tag_param);
-    }
-    coap_bin_const_t pdu_token_to_central = coap_pdu_get_token(pdu_to_central);
-
-    // Guardar el tracker para esta solicitud CAN
-    store_can_tracker(pdu_token_to_central, original_can_id, request_type_param, target_floor_for_task_param, origin_floor_param, requesting_elevator_id_cabin_param);
-
-    // ---- Añadir Opciones de URI (Uri-Path) ----
-    char qualified_target_path[256];
-    const char* path_to_use = central_server_path;
-    
-    // Limpiar la cadena de caracteres de control y espacios
-    char cleaned_path[256];
-    size_t cleaned_len = 0;
-    for (size_t i = 0; path_to_use[i] != '\0' && i < sizeof(cleaned_path) - 1; i++) {
-        if (path_to_use[i] != '\r' && path_to_use[i] != '\n' && path_to_use[i] != '\t') {
-            cleaned_path[cleaned_len++] = path_to_use[i];
-        }
+    // ---- Reservar tracker en el slab; su token identifica el slot ----
+    uint8_t token_data[GW_TRACKER_TOKEN_LEN];
+    gw_tracker_slot_t *slot = gw_tracker_alloc(GW_TRACKER_ORIGIN_CAN, token_data);
+    if (!slot) {
+        LOG_ERROR_GW(ANSI_COLOR_RED "[%s] Error: No hay slots libres para rastrear la solicitud (origen CAN ID: 0x%X)." ANSI_COLOR_RESET "\n", log_tag_param, original_can_id);
+        coap_delete_pdu(pdu_to_central);
+        free(json_payload_heap);
+        return;
     }
-    cleaned_path[cleaned_len] = '\0';
-    
-    // Eliminar espacios al final
-    while (cleaned_len > 0 && (cleaned_path[cleaned_len-1] == ' ' || cleaned_path[cleaned_len-1] == '\t')) {
-        cleaned_path[--cleaned_len] = '\0';
+    slot->span.ns[GW_SPAN_CAN_RX] = can_rx_ns;
+    slot->span.ns[GW_SPAN_JSON_DONE] = json_done_ns;
+    can_origin_tracker_t *tracker = &slot->data.can;
+    tracker->original_can_id = original_can_id;
+    tracker->building_index = building_index;
+    tracker->request_type = request_type_param;
+    tracker->target_floor_for_task = target_floor_for_task_param;
+    tracker->call_reference_floor = origin_floor_param;
+    tracker->requested_direction = requested_direction_floor_param;
+    if (requesting_elevator_id_cabin_param) {
+        strncpy(tracker->requesting_elevator_id_if_cabin, requesting_elevator_id_cabin_param, ID_STRING_MAX_LEN - 1);
+        tracker->requesting_elevator_id_if_cabin[ID_STRING_MAX_LEN - 1] = '\0';
     }
-    
-    if (cleaned_path[0] == '/') {
-        strncpy(qualified_target_path, cleaned_path, sizeof(qualified_target_path) - 1);
-        qualified_target_path[sizeof(qualified_target_path) - 1] = '\0';
-    } else {
-        // Verificar que hay espacio suficiente para "/" + cleaned_path + null terminator
-        size_t cleaned_len = strlen(cleaned_path);
-        size_t max_path_len = sizeof(qualified_target_path) - 1; // Reservar espacio para null terminator
-        if (cleaned_len + 1 <= max_path_len) { // +1 para el "/"
-            int result = snprintf(qualified_target_path, sizeof(qualified_target_path), "/%s", cleaned_path);
-            if (result >= (int)sizeof(qualified_target_path)) {
-                // Truncación ocurrió, asegurar terminación nula
-                qualified_target_path[sizeof(qualified_target_path) - 1] = '\0';
-                LOG_WARN_GW("[%s] Warning: Path truncado en qualified_target_path", log_tag_param);
-            }
-        } else {
-            // Si es demasiado largo, truncar manualmente
-            strncpy(qualified_target_path, "/", sizeof(qualified_target_path) - 1);
-            size_t remaining_space = sizeof(qualified_target_path) - 2; // -2 para "/" y null terminator
-            strncat(qualified_target_path, cleaned_path, remaining_space);
-            qualified_target_path[sizeof(qualified_target_path) - 1] = '\0';
-            LOG_WARN_GW("[%s] Warning: Path demasiado largo, truncado", log_tag_param);
-        }
+
+    if (!coap_add_token(pdu_to_central, sizeof(token_data), token_data)) {
+        LOG_ERROR_GW(ANSI_COLOR_RED "[%s] Error: Fallo al añadir token a PDU (origen CAN)." ANSI_COLOR_RESET "\n", log_tag_param);
+        gw_tracker_release(slot);
+        coap_delete_pdu(pdu_to_central);
+        free(json_payload_heap);
+        return;
     }
+    log_coap_token("[CAN_Bridge] Stored token for CAN tracker", coap_pdu_get_token(pdu_to_central));
 
-    coap_uri_t *uri_obj = coap_new_uri((const uint8_t *)qualified_target_path, strlen(qualified_target_path));
-    if (uri_obj) {
-        coap_optlist_t *optlist_head = NULL;
-        // Usar la dirección remota de la sesión DTLS con el servidor central
-        const coap_address_t *remote_addr = coap_session_get_addr_remote(session_to_central);
-        if (remote_addr) {
-            if (coap_uri_into_optlist(uri_obj, remote_addr, &optlist_head, 1) == 1) {
-                coap_add_optlist_pdu(pdu_to_central, &optlist_head);
-                coap_delete_optlist(optlist_head);
-            } else {
-                LOG_ERROR_GW(ANSI_COLOR_RED "[%s] Error creando lista de opciones desde URI (origen CAN): %s" ANSI_COLOR_RESET "\n", log_tag_param, qualified_target_path);
-            }
-        } else {
-            LOG_ERROR_GW(ANSI_COLOR_RED "[%s] Error obteniendo dirección remota de la sesión DTLS para URI (origen CAN)." ANSI_COLOR_RESET "\n", log_tag_param);
-        }
-        coap_delete_uri(uri_obj);
-    } else {
-         LOG_ERROR_GW(ANSI_COLOR_RED "[%s] Error creando objeto URI desde path (origen CAN): %s" ANSI_COLOR_RESET "\n", log_tag_param, qualified_target_path);
+    // ---- Añadir Opciones de URI (Uri-Path) ----
+    // La ruta ya viene normalizada y dividida en segmentos desde la configuración
+    for (uint8_t i = 0; i < central_server_path->num_segments; ++i) {
+        coap_add_option(pdu_to_central, COAP_OPTION_URI_PATH, central_server_path->segment_len[i],
+                        (const uint8_t *)central_server_path->path + central_server_path->segment_offset[i]);
     }
 
     // ---- Añadir Opción Content-Format (application/json) ----
@@ -699,22 +684,24 @@ forward_can_originated_request_to_central_server(
                     coap_encode_var_safe(ct_buf, sizeof(ct_buf), COAP_MEDIATYPE_APPLICATION_JSON), ct_buf);
 
     // ---- Añadir Payload JSON ----
-    if (json_payload_str && strlen(json_payload_str) > 0) {
-        if (!coap_add_data(pdu_to_central, strlen(json_payload_str), (const uint8_t *)json_payload_str)) {
+    if (json_len > 0) {
+        if (!coap_add_data(pdu_to_central, (size_t)json_len, (const uint8_t *)json_payload_str)) {
             LOG_ERROR_GW(ANSI_COLOR_RED "[%s] Error: añadiendo payload JSON a PDU (origen CAN)." ANSI_COLOR_RESET "\n", log_tag_param);
             coap_delete_pdu(pdu_to_central); // Libera PDU y su token interno.
-            // El tracker CAN permanece en su array, no se libera con free.
-            free(json_payload_str);
+            gw_tracker_release(slot);
+            free(json_payload_heap);
             return;
         }
     }
 
     // ---- Verificar estado de sesión antes de enviar ----
+    // En handshake libcoap retiene la PDU hasta que la sesión se establezca
     coap_session_state_t session_state = coap_session_get_state(session_to_central);
-    if (session_state != COAP_SESSION_STATE_ESTABLISHED) {
-        LOG_ERROR_GW(ANSI_COLOR_RED "[%s] Error: Sesión DTLS no establecida (estado: %d). No se puede enviar petición." ANSI_COLOR_RESET "\n", log_tag_param, session_state);
+    if (session_state == COAP_SESSION_STATE_NONE) {
+        LOG_ERROR_GW(ANSI_COLOR_RED "[%s] Error: Sesión DTLS cerrada (estado: %d). No se puede enviar petición." ANSI_COLOR_RESET "\n", log_tag_param, session_state);
         coap_delete_pdu(pdu_to_central);
-        free(json_payload_str);
+        gw_tracker_release(slot);
+        free(json_payload_heap);
         return;
     }
     
@@ -723,19 +710,27 @@ forward_can_originated_request_to_central_server(
     
     // Registrar petición CoAP en el logger
     char method[] = "POST";
-    exec_logger_log_coap_sent(method, qualified_target_path, json_payload_str);
+    exec_logger_log_coap_sent(method, central_server_path->path, json_payload_str);
     
-    free(json_payload_str); // Payload copiado a la PDU
+    free(json_payload_heap); // Payload copiado a la PDU
 
     if (coap_send(session_to_central, pdu_to_central) == COAP_INVALID_MID) {
         LOG_ERROR_GW(ANSI_COLOR_RED "[%s] Error: enviando petición a servidor central (origen CAN)." ANSI_COLOR_RESET "\n", log_tag_param);
         // PDU es liberada por coap_send en error.
-        // El tracker CAN permanece en su array, se sobrescribirá eventualmente.
+        // No llegará respuesta: liberar el slot para no agotar el slab.
         // La sesión DTLS global NO se libera aquí.
-        // No hay 'tracker' dinámico que liberar aquí como en api_handlers.c: free(tracker); es INCORRECTO para can_bridge.
+        gw_tracker_release(slot);
     } else {
+        slot->span.ns[GW_SPAN_COAP_TX] = gw_tracker_now_ns();
         LOG_INFO_GW(ANSI_COLOR_GREEN "[%s] Gateway (Origen CAN ID: 0x%X) -> Central: Solicitud enviada, esperando rsp..." ANSI_COLOR_RESET "\n", log_tag_param, original_can_id);
-        // El tracker CAN está almacenado. La respuesta se asociará a través del token.
+        // El tracker CAN está en el slab. La respuesta se asociará a través del token.
+        gw_journal_record(GW_JOURNAL_REQUEST_SENT, building_index, GW_JOURNAL_NO_ELEVATOR,
+                          (int16_t)origin_floor_param, (int16_t)target_floor_for_task_param,
+                          original_can_id, request_type_param);
+        if (request_type_param == GW_REQUEST_TYPE_FLOOR_CALL) {
+            // Las pulsaciones repetidas se absorben hasta que llegue la respuesta
+            gw_hall_call_mark_pending(gw_building_hall_calls(building_index), origin_floor_param, requested_direction_floor_param);
+        }
         // La sesión DTLS global no se libera aquí.
     }
 } 
\ No newline at end of file
@@ -0,0 +1,668 @@
+/**
+ * @file coap_loadgen.c
+ * @brief Generador de carga CoAP/DTLS contra el servidor central
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Abre K sesiones DTLS-PSK con identidades "Gateway_Client_LoadGen_<pid>_<k>"
+ * (la clave de cada una sale de psk_keys.txt con el mismo algoritmo que el
+ * servidor, psk_manager_get_deterministic_key()) y envía a
+ * /peticion_piso y /peticion_cabina los mismos payloads que el gateway
+ * (elevator_group_write_json_for_server()), repartidos entre las sesiones.
+ *
+ * **Modos:**
+ * - Bucle abierto (--rate): peticiones a ritmo fijo, independiente de las
+ *   respuestas. La latencia "corregida" se mide desde el instante en que
+ *   tocaba enviar cada petición, no desde que salió: si el generador se
+ *   retrasa (sin huecos en vuelo, bucle ocupado) ese retraso cuenta, y los
+ *   percentiles no sufren la omisión coordinada. Las peticiones sin
+ *   respuesta (timeout o NACK) entran en "corregida" con el tiempo hasta que
+ *   se abandonaron. "servicio" mide desde el envío real y solo incluye las
+ *   respondidas.
+ * - Bucle cerrado (--concurrency): C peticiones en vuelo; cada respuesta
+ *   dispara la siguiente. Mide la capacidad máxima; solo hay latencia de
+ *   servicio.
+ *
+ * Los primeros --warmup-s segundos no se miden. Al final imprime el
+ * rendimiento (respuestas recibidas dentro de la ventana de medida, sin las
+ * que llegan al vaciar las pendientes), los resultados por código y los
+ * percentiles de latencia (latency_histogram.h); --csv vuelca la
+ * distribución completa.
+ *
+ * **Uso:**
+ * ```
+ * coap_loadgen [--server <ip>] [--port <puerto>] [--psk-file <psk_keys.txt>]
+ *              [--sessions <K>] (--rate <peticiones/s> | --concurrency <C>)
+ *              [--duration-s <s>] [--warmup-s <s>] [--cabin-ratio <0..1>]
+ *              [--floors <n>] [--elevators <n>] [--timeout-ms <ms>]
+ *              [--max-inflight <n>] [--seed <n>] [--csv <fichero>] [--verbose]
+ * ```
+ * Por defecto: 127.0.0.1:5684, 10 sesiones, bucle cerrado con concurrencia
+ * 10, 10 s de medida tras 1 s de calentamiento, mitad llamadas de piso.
+ *
+ * @see latency_histogram.h
+ * @see psk_manager.h
+ */
+
+#include <coap3/coap.h>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "api_gateway/elevator_state_manager.h"
+#include "api_gateway/latency_histogram.h"
+#include "api_gateway/prng.h"
+#include "psk_manager.h"
+
+/**
+ * @brief Máximo de sesiones DTLS simultáneas
+ */
+#define LOADGEN_MAX_SESSIONS 1024
+
+/**
+ * @brief Longitud del token: índice del hueco y generación
+ */
+#define LOADGEN_TOKEN_LEN 8
+
+/**
+ * @brief Espera máxima del bucle de E/S, para revisar plazos y el fin de la prueba
+ */
+#define LOADGEN_MAX_WAIT_MS 50
+
+/**
+ * @brief Tiempo máximo para establecer todas las sesiones
+ */
+#define LOADGEN_HANDSHAKE_TIMEOUT_MS 15000
+
+/**
+ * @brief Tamaño del búfer del payload JSON
+ */
+#define LOADGEN_PAYLOAD_MAX 2048
+
+/**
+ * @brief Sesión DTLS con el servidor central
+ */
+typedef struct {
+    coap_session_t *session;           ///< Sesión libcoap
+    char identity[64];                 ///< Identidad PSK presentada
+    elevator_group_state_t group;      ///< Edificio simulado cuyo estado va en los payloads
+    uint64_t started_ns;               ///< Inicio del establecimiento
+    bool established;                  ///< Handshake DTLS completado
+    bool failed;                       ///< La sesión se cerró o falló
+} loadgen_session_t;
+
+/**
+ * @brief Petición en vuelo
+ */
+typedef struct {
+    uint64_t intended_ns;              ///< Instante en que tocaba enviarla
+    uint64_t sent_ns;                  ///< Instante en que se envió
+    uint32_t generation;               ///< Distingue respuestas de usos anteriores del hueco
+    bool in_use;                       ///< Hueco ocupado
+    bool measured;                     ///< Enviada tras el calentamiento
+} loadgen_slot_t;
+
+/**
+ * @brief Estado de la prueba
+ */
+typedef struct {
+    loadgen_session_t sessions[LOADGEN_MAX_SESSIONS];
+    int num_sessions;
+    loadgen_slot_t *slots;             ///< Huecos de peticiones en vuelo
+    uint32_t *free_slots;              ///< Pila de huecos libres
+    uint32_t num_free;
+    uint32_t max_inflight;
+    int next_session;                  ///< Reparto por turnos entre sesiones
+    gw_prng_t rng;                     ///< Tipo, piso y ascensor de cada petición
+    double cabin_ratio;
+    int num_floors;
+    uint64_t timeout_ns;
+    uint64_t window_end_ns;            ///< Fin de la ventana de medida del rendimiento
+    gw_latency_hist_t corrected;       ///< Desde el instante previsto; las abandonadas, hasta el abandono
+    gw_latency_hist_t service;         ///< Desde el envío real
+    gw_latency_hist_t handshake;       ///< Establecimiento de sesiones
+    uint64_t sent;                     ///< Enviadas durante la medida
+    uint64_t ok;                       ///< Respuestas 2.xx
+    uint64_t rejected;                 ///< Respuestas 4.xx/5.xx
+    uint64_t in_window;                ///< Respuestas (2.xx a 5.xx) recibidas antes de window_end_ns
+    uint64_t nacks;                    ///< Sin respuesta según libcoap (retransmisiones agotadas, RST...)
+    uint64_t timeouts;                 ///< Sin respuesta en --timeout-ms
+    uint64_t send_errors;              ///< Fallos al construir o enviar la PDU
+    uint64_t late_starts;              ///< Peticiones de bucle abierto enviadas más de un intervalo tarde
+} loadgen_t;
+
+static loadgen_t lg;
+
+static volatile sig_atomic_t interrupted = 0;
+
+static void handle_sigint(int signum) {
+    (void)signum;
+    interrupted = 1;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void encode_token(uint8_t *token, uint32_t index, uint32_t generation) {
+    for (int i = 0; i < 4; ++i) {
+        token[i] = (uint8_t)(index >> (8 * i));
+        token[4 + i] = (uint8_t)(generation >> (8 * i));
+    }
+}
+
+/**
+ * @brief Hueco de una respuesta, o NULL si ya expiró o no es nuestra
+ */
+static loadgen_slot_t* lookup_slot(coap_bin_const_t token, uint32_t *index_out) {
+    if (token.length != LOADGEN_TOKEN_LEN) {
+        return NULL;
+    }
+    uint32_t index = 0;
+    uint32_t generation = 0;
+    for (int i = 0; i < 4; ++i) {
+        index |= (uint32_t)token.s[i] << (8 * i);
+        generation |= (uint32_t)token.s[4 + i] << (8 * i);
+    }
+    if (index >= lg.max_inflight || !lg.slots[index].in_use || lg.slots[index].generation != generation) {
+        return NULL;
+    }
+    *index_out = index;
+    return &lg.slots[index];
+}
+
+static void release_slot(uint32_t index) {
+    lg.slots[index].in_use = false;
+    lg.slots[index].generation++;
+    lg.free_slots[lg.num_free++] = index;
+}
+
+/**
+ * @brief Libera el hueco de una petición abandonada sin respuesta
+ *
+ * La latencia corregida no puede omitirla: bajo sobrecarga son justamente
+ * las peores. Se registra el tiempo desde el instante previsto hasta el
+ * abandono, que es una cota inferior de su latencia real.
+ */
+static void give_up_slot(uint32_t index, uint64_t now) {
+    loadgen_slot_t *slot = &lg.slots[index];
+    if (slot->measured) {
+        gw_latency_hist_record(&lg.corrected, (now - slot->intended_ns) / 1000u);
+    }
+    release_slot(index);
+}
+
+/**
+ * @brief Registra la latencia de una petición completada y libera su hueco
+ */
+static void complete_slot(uint32_t index, uint64_t done_ns) {
+    loadgen_slot_t *slot = &lg.slots[index];
+    if (slot->measured) {
+        gw_latency_hist_record(&lg.service, (done_ns - slot->sent_ns) / 1000u);
+        gw_latency_hist_record(&lg.corrected, (done_ns - slot->intended_ns) / 1000u);
+    }
+    release_slot(index);
+}
+
+static coap_response_t on_response(coap_session_t *session, const coap_pdu_t *sent,
+                                   const coap_pdu_t *received, const coap_mid_t mid) {
+    (void)session; (void)sent; (void)mid;
+    uint32_t index;
+    loadgen_slot_t *slot = lookup_slot(coap_pdu_get_token(received), &index);
+    if (!slot) {
+        return COAP_RESPONSE_OK; // Respuesta a una petición ya expirada
+    }
+    uint64_t done_ns = now_ns();
+    if (slot->measured) {
+        if (COAP_RESPONSE_CLASS(coap_pdu_get_code(received)) == 2) {
+            lg.ok++;
+        } else {
+            lg.rejected++;
+        }
+        lg.in_window += done_ns <= lg.window_end_ns ? 1 : 0;
+    }
+    complete_slot(index, done_ns);
+    return COAP_RESPONSE_OK;
+}
+
+static void on_nack(coap_session_t *session, const coap_pdu_t *sent,
+                    const coap_nack_reason_t reason, const coap_mid_t mid) {
+    (void)session; (void)reason; (void)mid;
+    uint32_t index;
+    if (!sent || !lookup_slot(coap_pdu_get_token(sent), &index)) {
+        return;
+    }
+    if (lg.slots[index].measured) {
+        lg.nacks++;
+    }
+    give_up_slot(index, now_ns());
+}
+
+static int on_event(coap_session_t *session, const coap_event_t event) {
+    loadgen_session_t *ls = coap_session_get_app_data(session);
+    if (!ls) {
+        return 0;
+    }
+    switch (event) {
+        case COAP_EVENT_DTLS_CONNECTED:
+            if (!ls->established) {
+                ls->established = true;
+                gw_latency_hist_record(&lg.handshake, (now_ns() - ls->started_ns) / 1000u);
+            }
+            break;
+        case COAP_EVENT_DTLS_CLOSED:
+        case COAP_EVENT_DTLS_ERROR:
+        case COAP_EVENT_SESSION_FAILED:
+            ls->failed = true;
+            break;
+        default:
+            break;
+    }
+    return 0;
+}
+
+/**
+ * @brief Añade las opciones Uri-Path de una ruta "a/b/c"
+ */
+static void add_uri_path(coap_pdu_t *pdu, const char *path) {
+    while (*path == '/') path++;
+    while (*path) {
+        const char *end = strchr(path, '/');
+        size_t len = end ? (size_t)(end - path) : strlen(path);
+        if (len > 0) {
+            coap_add_option(pdu, COAP_OPTION_URI_PATH, len, (const uint8_t *)path);
+        }
+        path += len;
+        while (*path == '/') path++;
+    }
+}
+
+/**
+ * @brief Envía una petición por la siguiente sesión establecida
+ * @param intended_ns Instante en que tocaba enviarla
+ * @param measured Cuenta para las estadísticas
+ * @return false si no hay huecos o sesiones disponibles
+ */
+static bool send_request(uint64_t intended_ns, bool measured) {
+    if (lg.num_free == 0) {
+        return false;
+    }
+    loadgen_session_t *ls = NULL;
+    for (int tries = 0; tries < lg.num_sessions && !ls; ++tries) {
+        loadgen_session_t *candidate = &lg.sessions[lg.next_session];
+        lg.next_session = (lg.next_session + 1) % lg.num_sessions;
+        if (candidate->established && !candidate->failed) {
+            ls = candidate;
+        }
+    }
+    if (!ls) {
+        return false;
+    }
+
+    bool cabin = gw_prng_uniform(&lg.rng) < lg.cabin_ratio;
+    api_request_details_for_json_t details;
+    memset(&details, 0, sizeof(details));
+    // El servidor central admite pisos 1..50
+    int max_floor = lg.num_floors > 50 ? 50 : lg.num_floors;
+    if (cabin) {
+        int elevator = (int)gw_prng_below(&lg.rng, (uint32_t)ls->group.num_elevadores_en_grupo);
+        snprintf(details.requesting_elevator_id_cr, sizeof(details.requesting_elevator_id_cr), "%s",
+                 ls->group.ids[elevator].ascensor_id);
+        details.target_floor_cr = 1 + (int)gw_prng_below(&lg.rng, (uint32_t)max_floor);
+    } else {
+        details.origin_floor_fc = 1 + (int)gw_prng_below(&lg.rng, (uint32_t)max_floor);
+        bool up = details.origin_floor_fc < max_floor && (details.origin_floor_fc == 1 || gw_prng_below(&lg.rng, 2));
+        details.direction_fc = up ? MOVING_UP : MOVING_DOWN;
+    }
+    char payload[LOADGEN_PAYLOAD_MAX];
+    int payload_len = elevator_group_write_json_for_server(&ls->group,
+                                                           cabin ? GW_REQUEST_TYPE_CABIN_REQUEST : GW_REQUEST_TYPE_FLOOR_CALL,
+                                                           &details, payload, sizeof(payload));
+    coap_pdu_t *pdu = coap_new_pdu(COAP_MESSAGE_CON, COAP_REQUEST_CODE_POST, ls->session);
+    if (payload_len <= 0 || payload_len >= (int)sizeof(payload) || !pdu) {
+        if (pdu) coap_delete_pdu(pdu);
+        lg.send_errors += measured ? 1 : 0;
+        return true; // No se reintenta: el hueco sigue libre
+    }
+
+    uint32_t index = lg.free_slots[--lg.num_free];
+    loadgen_slot_t *slot = &lg.slots[index];
+    uint8_t token[LOADGEN_TOKEN_LEN];
+    encode_token(token, index, slot->generation);
+    uint8_t ct_buf[2];
+    coap_add_token(pdu, sizeof(token), token);
+    add_uri_path(pdu, cabin ? "peticion_cabina" : "peticion_piso");
+    coap_add_option(pdu, COAP_OPTION_CONTENT_FORMAT,
+                    coap_encode_var_safe(ct_buf, sizeof(ct_buf), COAP_MEDIATYPE_APPLICATION_JSON), ct_buf);
+    coap_add_data(pdu, (size_t)payload_len, (const uint8_t *)payload);
+
+    slot->in_use = true;
+    slot->measured = measured;
+    slot->intended_ns = intended_ns;
+    slot->sent_ns = now_ns();
+    if (coap_send(ls->session, pdu) == COAP_INVALID_MID) {
+        lg.send_errors += measured ? 1 : 0;
+        release_slot(index);
+        return true;
+    }
+    lg.sent += measured ? 1 : 0;
+    return true;
+}
+
+/**
+ * @brief Expira las peticiones sin respuesta tras --timeout-ms
+ */
+static void expire_slots(uint64_t now) {
+    for (uint32_t i = 0; i < lg.max_inflight; ++i) {
+        loadgen_slot_t *slot = &lg.slots[i];
+        if (slot->in_use && now - slot->sent_ns >= lg.timeout_ns) {
+            lg.timeouts += slot->measured ? 1 : 0;
+            give_up_slot(i, now);
+        }
+    }
+}
+
+/**
+ * @brief Procesa E/S durante como mucho @p wait_ns
+ */
+static void process_io(coap_context_t *ctx, uint64_t wait_ns) {
+    uint32_t wait_ms = (uint32_t)((wait_ns + 999999u) / 1000000u);
+    if (wait_ms > LOADGEN_MAX_WAIT_MS) wait_ms = LOADGEN_MAX_WAIT_MS;
+    // coap_io_process(ctx, 0) espera indefinidamente
+    coap_io_process(ctx, wait_ms == 0 ? COAP_IO_NO_WAIT : wait_ms);
+}
+
+static void print_usage(const char *prog) {
+    fprintf(stderr, "Uso: %s [--server <ip>] [--port <puerto>] [--psk-file <psk_keys.txt>] [--sessions <K>]\n"
+                    "          (--rate <peticiones/s> | --concurrency <C>) [--duration-s <s>] [--warmup-s <s>]\n"
+                    "          [--cabin-ratio <0..1>] [--floors <n>] [--elevators <n>] [--timeout-ms <ms>]\n"
+                    "          [--max-inflight <n>] [--seed <n>] [--csv <fichero>] [--verbose]\n", prog);
+}
+
+int main(int argc, char *argv[]) {
+    const char *server_ip = "127.0.0.1";
+    const char *psk_file = "psk_keys.txt";
+    const char *csv_path = NULL;
+    int port = 5684;
+    int num_elevators = 4;
+    double rate = 0.0;
+    int concurrency = 0;
+    double duration_s = 10.0;
+    double warmup_s = 1.0;
+    uint32_t timeout_ms = 5000;
+    uint32_t max_inflight = 4096;
+    uint64_t seed = 0;
+    bool verbose = false;
+    lg.num_sessions = 10;
+    lg.cabin_ratio = 0.5;
+    lg.num_floors = 14;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--verbose") == 0) {
+            verbose = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        const char *value = argv[++i];
+        if (strcmp(argv[i - 1], "--server") == 0) server_ip = value;
+        else if (strcmp(argv[i - 1], "--port") == 0) port = atoi(value);
+        else if (strcmp(argv[i - 1], "--psk-file") == 0) psk_file = value;
+        else if (strcmp(argv[i - 1], "--sessions") == 0) lg.num_sessions = atoi(value);
+        else if (strcmp(argv[i - 1], "--rate") == 0) rate = strtod(value, NULL);
+        else if (strcmp(argv[i - 1], "--concurrency") == 0) concurrency = atoi(value);
+        else if (strcmp(argv[i - 1], "--duration-s") == 0) duration_s = strtod(value, NULL);
+        else if (strcmp(argv[i - 1], "--warmup-s") == 0) warmup_s = strtod(value, NULL);
+        else if (strcmp(argv[i - 1], "--cabin-ratio") == 0) lg.cabin_ratio = strtod(value, NULL);
+        else if (strcmp(argv[i - 1], "--floors") == 0) lg.num_floors = atoi(value);
+        else if (strcmp(argv[i - 1], "--elevators") == 0) num_elevators = atoi(value);
+        else if (strcmp(argv[i - 1], "--timeout-ms") == 0) timeout_ms = (uint32_t)strtoul(value, NULL, 10);
+        else if (strcmp(argv[i - 1], "--max-inflight") == 0) max_inflight = (uint32_t)strtoul(value, NULL, 10);
+        else if (strcmp(argv[i - 1], "--seed") == 0) seed = strtoull(value, NULL, 10);
+        else if (strcmp(argv[i - 1], "--csv") == 0) csv_path = value;
+        else {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (rate > 0.0 && concurrency > 0) {
+        fprintf(stderr, "Error: --rate y --concurrency son excluyentes.\n");
+        return EXIT_FAILURE;
+    }
+    if (rate <= 0.0 && concurrency <= 0) {
+        concurrency = lg.num_sessions;
+    }
+    if (lg.num_sessions < 1 || lg.num_sessions > LOADGEN_MAX_SESSIONS || port < 1 || port > 65535 ||
+        duration_s <= 0.0 || warmup_s < 0.0 || lg.cabin_ratio < 0.0 || lg.cabin_ratio > 1.0 ||
+        lg.num_floors < 2 || num_elevators < 1 || num_elevators > MAX_ELEVATORS_PER_GATEWAY ||
+        timeout_ms == 0 || max_inflight == 0) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (concurrency > 0 && (uint32_t)concurrency > max_inflight) {
+        max_inflight = (uint32_t)concurrency;
+    }
+
+    coap_address_t server_addr;
+    coap_address_init(&server_addr);
+    server_addr.addr.sin.sin_family = AF_INET;
+    server_addr.addr.sin.sin_port = htons((uint16_t)port);
+    if (inet_pton(AF_INET, server_ip, &server_addr.addr.sin.sin_addr) != 1) {
+        fprintf(stderr, "Error: dirección IPv4 inválida '%s'.\n", server_ip);
+        return EXIT_FAILURE;
+    }
+    if (psk_manager_init(psk_file) != 0) {
+        fprintf(stderr, "Error: no se pudieron cargar las claves PSK de '%s'.\n", psk_file);
+        return EXIT_FAILURE;
+    }
+
+    lg.max_inflight = max_inflight;
+    lg.timeout_ns = (uint64_t)timeout_ms * 1000000u;
+    lg.slots = calloc(max_inflight, sizeof(loadgen_slot_t));
+    lg.free_slots = malloc(max_inflight * sizeof(uint32_t));
+    if (!lg.slots || !lg.free_slots || !gw_latency_hist_init(&lg.corrected) ||
+        !gw_latency_hist_init(&lg.service) || !gw_latency_hist_init(&lg.handshake)) {
+        fprintf(stderr, "Error: sin memoria para %u peticiones en vuelo.\n", max_inflight);
+        return EXIT_FAILURE;
+    }
+    for (uint32_t i = 0; i < max_inflight; ++i) {
+        lg.free_slots[i] = max_inflight - 1 - i;
+    }
+    lg.num_free = max_inflight;
+    seed = gw_prng_global_seed(seed);
+    gw_prng_seed_stream(&lg.rng, seed, 0);
+
+    signal(SIGINT, handle_sigint);
+
+    // Las trazas del gestor de estado van a stdout; sin --verbose se descartan hasta el resumen
+    int stdout_original = -1;
+    if (!verbose) {
+        fflush(stdout);
+        stdout_original = dup(STDOUT_FILENO);
+        if (!freopen("/dev/null", "w", stdout)) {
+            stdout_original = -1;
+        }
+    }
+
+    coap_startup();
+    coap_set_log_level(verbose ? COAP_LOG_DEBUG : COAP_LOG_WARN);
+    coap_context_t *ctx = coap_new_context(NULL);
+    if (!ctx) {
+        fprintf(stderr, "Error: no se pudo crear el contexto CoAP.\n");
+        return EXIT_FAILURE;
+    }
+    coap_register_response_handler(ctx, on_response);
+    coap_register_nack_handler(ctx, on_nack);
+    coap_register_event_handler(ctx, on_event);
+
+    // ---- Sesiones: una identidad y un edificio por sesión ----
+    fprintf(stderr, "[LoadGen] Estableciendo %d sesiones DTLS-PSK con %s:%d...\n", lg.num_sessions, server_ip, port);
+    for (int k = 0; k < lg.num_sessions; ++k) {
+        loadgen_session_t *ls = &lg.sessions[k];
+        char key[128];
+        char building_id[16];
+        snprintf(ls->identity, sizeof(ls->identity), "Gateway_Client_LoadGen_%d_%03d", (int)getpid(), k);
+        snprintf(building_id, sizeof(building_id), "E%03d", k + 1);
+        if (psk_manager_get_deterministic_key(ls->identity, key, sizeof(key)) != 0) {
+            fprintf(stderr, "Error: sin clave PSK para '%s'.\n", ls->identity);
+            return EXIT_FAILURE;
+        }
+        init_elevator_group(&ls->group, building_id, num_elevators, lg.num_floors);
+        ls->started_ns = now_ns();
+        ls->session = coap_new_client_session_psk(ctx, NULL, &server_addr, COAP_PROTO_DTLS, ls->identity,
+                                                  (const uint8_t *)key, (unsigned)strlen(key));
+        if (!ls->session) {
+            fprintf(stderr, "Error: no se pudo crear la sesión '%s'.\n", ls->identity);
+            return EXIT_FAILURE;
+        }
+        coap_session_set_app_data(ls->session, ls);
+    }
+    uint64_t handshake_deadline = now_ns() + (uint64_t)LOADGEN_HANDSHAKE_TIMEOUT_MS * 1000000u;
+    int established = 0;
+    while (!interrupted && now_ns() < handshake_deadline) {
+        established = 0;
+        int failed = 0;
+        for (int k = 0; k < lg.num_sessions; ++k) {
+            loadgen_session_t *ls = &lg.sessions[k];
+            if (!ls->established && coap_session_get_state(ls->session) == COAP_SESSION_STATE_ESTABLISHED) {
+                ls->established = true;
+                gw_latency_hist_record(&lg.handshake, (now_ns() - ls->started_ns) / 1000u);
+            }
+            established += ls->established ? 1 : 0;
+            failed += ls->failed ? 1 : 0;
+        }
+        if (established + failed == lg.num_sessions) {
+            break;
+        }
+        process_io(ctx, (uint64_t)LOADGEN_MAX_WAIT_MS * 1000000u);
+    }
+    if (established == 0) {
+        fprintf(stderr, "Error: ninguna sesión DTLS se estableció con %s:%d.\n", server_ip, port);
+        return EXIT_FAILURE;
+    }
+    fprintf(stderr, "[LoadGen] %d/%d sesiones establecidas. %s durante %.1f s (+%.1f s de calentamiento)...\n",
+            established, lg.num_sessions, rate > 0.0 ? "Bucle abierto" : "Bucle cerrado", duration_s, warmup_s);
+
+    // ---- Carga ----
+    uint64_t start_ns = now_ns();
+    uint64_t measure_ns = start_ns + (uint64_t)(warmup_s * 1e9);
+    uint64_t end_ns = measure_ns + (uint64_t)(duration_s * 1e9);
+    lg.window_end_ns = end_ns;
+    uint64_t interval_ns = rate > 0.0 ? (uint64_t)(1e9 / rate) : 0;
+    uint64_t next_intended_ns = start_ns;
+    uint64_t last_expire_ns = start_ns;
+    uint64_t now = start_ns;
+    while (!interrupted && now < end_ns) {
+        if (rate > 0.0) {
+            // Todas las peticiones cuyo instante ya pasó, con su instante previsto
+            while (next_intended_ns <= now) {
+                bool measured = next_intended_ns >= measure_ns;
+                if (!send_request(next_intended_ns, measured)) {
+                    break; // Se reintenta en la siguiente vuelta sin perder el instante previsto
+                }
+                lg.late_starts += measured && now - next_intended_ns > interval_ns ? 1 : 0;
+                next_intended_ns += interval_ns;
+            }
+        } else {
+            // Acotado: un envío fallido deja el hueco libre y no debe repetirse sin fin
+            for (int attempts = 0; attempts < concurrency && lg.max_inflight - lg.num_free < (uint32_t)concurrency;
+                 ++attempts) {
+                uint64_t t = now_ns();
+                if (!send_request(t, t >= measure_ns)) {
+                    break;
+                }
+            }
+        }
+        uint64_t wait_ns = rate > 0.0 && next_intended_ns > now ? next_intended_ns - now : 0;
+        if (rate <= 0.0 || lg.num_free == 0) {
+            wait_ns = (uint64_t)LOADGEN_MAX_WAIT_MS * 1000000u; // Despierta con la próxima respuesta
+        }
+        if (end_ns - now < wait_ns) {
+            wait_ns = end_ns - now;
+        }
+        process_io(ctx, wait_ns);
+        now = now_ns();
+        if (now - last_expire_ns > 100000000u) {
+            expire_slots(now);
+            last_expire_ns = now;
+        }
+    }
+
+    // Las respuestas que lleguen al vaciar no cuentan para el rendimiento
+    uint64_t measured_until = now < end_ns ? now : end_ns;
+    lg.window_end_ns = measured_until;
+
+    // Esperar las respuestas pendientes
+    uint64_t drain_deadline = now_ns() + lg.timeout_ns;
+    while (!interrupted && lg.num_free < lg.max_inflight && now_ns() < drain_deadline) {
+        process_io(ctx, (uint64_t)LOADGEN_MAX_WAIT_MS * 1000000u);
+    }
+    lg.timeout_ns = 0;
+    expire_slots(now_ns()); // Lo que quede cuenta como sin respuesta
+    double elapsed_s = measured_until > measure_ns ? (double)(measured_until - measure_ns) / 1e9 : 0.0;
+
+    if (stdout_original >= 0) {
+        fflush(stdout);
+        dup2(stdout_original, STDOUT_FILENO);
+        close(stdout_original);
+    }
+    printf("=== CARGA COAP/DTLS CONTRA %s:%d ===\n", server_ip, port);
+    printf("Modo: %s, sesiones: %d/%d, semilla: %llu\n",
+           rate > 0.0 ? "bucle abierto" : "bucle cerrado", established, lg.num_sessions, (unsigned long long)seed);
+    if (rate > 0.0) {
+        printf("Ritmo objetivo: %.1f pet/s\n", rate);
+    } else {
+        printf("Concurrencia: %d\n", concurrency);
+    }
+    printf("Medida: %.2f s, enviadas: %llu, rendimiento: %.1f resp/s\n", elapsed_s,
+           (unsigned long long)lg.sent, elapsed_s > 0.0 ? (double)lg.in_window / elapsed_s : 0.0);
+    printf("Respuestas 2.xx: %llu, 4.xx/5.xx: %llu, NACK: %llu, sin respuesta: %llu, errores de envío: %llu\n",
+           (unsigned long long)lg.ok, (unsigned long long)lg.rejected, (unsigned long long)lg.nacks,
+           (unsigned long long)lg.timeouts, (unsigned long long)lg.send_errors);
+    if (rate > 0.0) {
+        printf("Envíos con más de un intervalo de retraso: %llu\n", (unsigned long long)lg.late_starts);
+        gw_latency_hist_print(&lg.corrected, stdout, "corregida");
+        if (lg.nacks + lg.timeouts > 0) {
+            printf("  (\"corregida\" incluye %llu peticiones sin respuesta, medidas hasta su abandono)\n",
+                   (unsigned long long)(lg.nacks + lg.timeouts));
+        }
+    }
+    gw_latency_hist_print(&lg.service, stdout, "servicio");
+    gw_latency_hist_print(&lg.handshake, stdout, "handshake");
+
+    int status = EXIT_SUCCESS;
+    if (csv_path) {
+        FILE *csv = fopen(csv_path, "w");
+        if (csv) {
+            gw_latency_hist_write_csv(rate > 0.0 ? &lg.corrected : &lg.service, csv);
+            fclose(csv);
+        } else {
+            fprintf(stderr, "Error: no se pudo escribir '%s': %s\n", csv_path, strerror(errno));
+            status = EXIT_FAILURE;
+        }
+    }
+
+    for (int k = 0; k < lg.num_sessions; ++k) {
+        coap_session_release(lg.sessions[k].session);
+        elevator_group_destroy(&lg.sessions[k].group);
+    }
+    coap_free_context(ctx);
+    coap_cleanup();
+    psk_manager_cleanup();
+    gw_latency_hist_free(&lg.corrected);
+    gw_latency_hist_free(&lg.service);
+    gw_latency_hist_free(&lg.handshake);
+    free(lg.slots);
+    free(lg.free_slots);
+    return status;
+}
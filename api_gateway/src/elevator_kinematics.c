@@ -0,0 +1,383 @@
+/**
+ * @file elevator_kinematics.c
+ * @brief Implementación de la simulación cinemática de las cabinas
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Cada paso fijo aplica a cada cabina, en este orden:
+ * 1. Fase de puertas: mientras no estén cerradas solo avanza su temporizador
+ * 2. Movimiento: acelera hacia la velocidad nominal sin superar la velocidad
+ *    de frenado que permite detenerse en el destino; la posición avanza con
+ *    la velocidad media del paso
+ * 3. Llegada: al detenerse en el destino completa la tarea y abre puertas
+ *
+ * @see elevator_kinematics.h
+ */
+
+#include "api_gateway/elevator_kinematics.h"
+#include "api_gateway/building_registry.h"
+#include "api_gateway/execution_logger.h"
+#include "api_gateway/state_journal.h"
+#include "api_gateway/logging_gw.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+/**
+ * @brief Distancia por debajo de la cual la cabina se considera nivelada (m)
+ */
+#define KINEMATICS_LEVEL_EPSILON_M 1e-6
+
+static gw_car_motion_t *building_cars[GW_MAX_BUILDINGS];   ///< Cabinas de cada edificio
+static int building_num_cars[GW_MAX_BUILDINGS];             ///< Cabinas reservadas por edificio
+static const void *building_group_storage[GW_MAX_BUILDINGS]; ///< Bloque del grupo al reservar (detecta reinicializaciones)
+
+static bool clock_started = false;   ///< Se ha fijado el origen de tiempos
+static uint64_t last_advance_ms = 0; ///< Reloj de la última llamada a gw_kinematics_advance()
+static uint64_t accumulated_ms = 0;  ///< Tiempo transcurrido aún no simulado
+
+/**
+ * @brief Piso más cercano a una altura
+ */
+static int nearest_floor(double position_m, double floor_height_m) {
+    return (int)lround(position_m / floor_height_m);
+}
+
+/**
+ * @brief Cabinas de un grupo, (re)creadas si el grupo cambió de tamaño o se reinicializó
+ */
+static gw_car_motion_t* group_cars(elevator_group_state_t *group, const gw_sim_params_t *params) {
+    uint16_t b = group->building_index;
+    if (b >= GW_MAX_BUILDINGS) {
+        return NULL;
+    }
+    int n = group->num_elevadores_en_grupo;
+    if (building_cars[b] && building_num_cars[b] == n && building_group_storage[b] == group->storage) {
+        return building_cars[b];
+    }
+    gw_car_motion_t *cars = realloc(building_cars[b], (size_t)n * sizeof(gw_car_motion_t));
+    if (!cars) {
+        LOG_ERROR_GW("[SimStep] Sin memoria para %d cabinas del edificio %s.", n, group->edificio_id_str_grupo);
+        return NULL;
+    }
+    for (int i = 0; i < n; ++i) {
+        cars[i].position_m = group->piso_actual[i] * params->floor_height_m;
+        cars[i].velocity_mps = 0.0;
+        cars[i].door_timer_ms = 0;
+        cars[i].floor = group->piso_actual[i];
+    }
+    building_cars[b] = cars;
+    building_num_cars[b] = n;
+    building_group_storage[b] = group->storage;
+    return cars;
+}
+
+/**
+ * @brief Ajusta la cabina a un piso_actual escrito fuera del modelo
+ *
+ * El piso informado manda: la cabina pasa a estar en él. Sin tarea (la
+ * notificación de llegada la completó) queda parada; con tarea conserva el
+ * sentido hacia el destino, limitada a la velocidad desde la que todavía
+ * puede frenar en él.
+ */
+static void resync_external_floor(elevator_group_state_t *group, int i, gw_car_motion_t *car,
+                                  const gw_sim_params_t *params) {
+    car->floor = group->piso_actual[i];
+    car->position_m = car->floor * params->floor_height_m;
+    if (!group->ocupado[i] || group->destino_actual[i] == -1) {
+        car->velocity_mps = 0.0;
+        return;
+    }
+    double dist = group->destino_actual[i] * params->floor_height_m - car->position_m;
+    if (car->velocity_mps == 0.0 || (car->velocity_mps > 0.0) != (dist > 0.0)) {
+        car->velocity_mps = 0.0; // Ya en el destino o pasado: vuelve a arrancar hacia él
+        return;
+    }
+    double max_speed = fmin(params->speed_mps, sqrt(2.0 * params->acceleration_mps2 * fabs(dist)));
+    car->velocity_mps = copysign(fmin(fabs(car->velocity_mps), max_speed), car->velocity_mps);
+}
+
+/**
+ * @brief Completa la tarea de un ascensor detenido en su destino
+ */
+static void complete_task(elevator_group_state_t *group, int i) {
+    elevator_ids_t *ids = &group->ids[i];
+    LOG_INFO_GW("[SimStep] Ascensor %s LLEGÓ a destino %d.", ids->ascensor_id, group->destino_actual[i]);
+    LOG_INFO_GW("StateMgr: Ascensor %s completó tarea %s en piso %d.",
+                ids->ascensor_id,
+                ids->tarea_actual_id[0] != '\0' ? ids->tarea_actual_id : "N/A",
+                group->piso_actual[i]);
+
+    // Registrar completación de tarea en el logger
+    if (ids->tarea_actual_id[0] != '\0') {
+        exec_logger_log_task_completed(ids->tarea_actual_id, ids->ascensor_id, group->piso_actual[i]);
+    }
+
+    gw_journal_record(GW_JOURNAL_ELEVATOR_ARRIVED, group->building_index, (uint8_t)i,
+                      group->piso_actual[i], 0, gw_journal_hash_id(ids->tarea_actual_id), 0);
+    group->ocupado[i] = false;
+    ids->tarea_actual_id[0] = '\0'; // Limpiar ID de tarea
+    group->destino_actual[i] = -1;  // Limpiar destino
+    group->direccion_movimiento[i] = STOPPED;
+    elevator_group_mark_dirty(group);
+}
+
+/**
+ * @brief Avanza la fase de puertas de una cabina
+ * @return true si las puertas están cerradas y la cabina puede moverse
+ */
+static bool door_step(elevator_group_state_t *group, int i, gw_car_motion_t *car,
+                      const gw_sim_params_t *params, int32_t dt_ms) {
+    uint8_t door = group->estado_puerta[i];
+    if (door == DOOR_CLOSED) {
+        return true;
+    }
+    if (door != DOOR_OPENING && door != DOOR_OPEN && door != DOOR_CLOSING) {
+        group->estado_puerta[i] = DOOR_CLOSED;
+        elevator_group_mark_dirty(group);
+        return true;
+    }
+
+    // Tarea al piso donde la cabina tiene las puertas abiertas: se atiende sin cerrar
+    if (door != DOOR_CLOSING && group->ocupado[i] && group->destino_actual[i] == group->piso_actual[i] &&
+        car->velocity_mps == 0.0) {
+        complete_task(group, i);
+        if (door == DOOR_OPEN) {
+            car->door_timer_ms = (int32_t)params->door_dwell_ms;
+        }
+        return false;
+    }
+
+    car->door_timer_ms -= dt_ms;
+    if (car->door_timer_ms > 0) {
+        return false;
+    }
+    // El sobrante del paso se descuenta de la fase siguiente
+    if (door == DOOR_OPENING) {
+        group->estado_puerta[i] = DOOR_OPEN;
+        car->door_timer_ms += (int32_t)params->door_dwell_ms;
+    } else if (door == DOOR_OPEN) {
+        LOG_DEBUG_GW("[SimStep] Ascensor %s cerrando puertas en piso %d.", group->ids[i].ascensor_id, group->piso_actual[i]);
+        group->estado_puerta[i] = DOOR_CLOSING;
+        car->door_timer_ms += (int32_t)params->door_close_ms;
+    } else {
+        group->estado_puerta[i] = DOOR_CLOSED;
+        car->door_timer_ms = 0;
+    }
+    elevator_group_mark_dirty(group);
+    return false;
+}
+
+/**
+ * @brief Actualiza piso_actual al piso más cercano, registrando cada piso cruzado
+ */
+static void update_floor(elevator_group_state_t *group, int i, gw_car_motion_t *car,
+                         const gw_sim_params_t *params) {
+    int floor = nearest_floor(car->position_m, params->floor_height_m);
+    while (group->piso_actual[i] != floor) {
+        group->piso_actual[i] += group->piso_actual[i] < floor ? 1 : -1;
+        gw_journal_record(GW_JOURNAL_ELEVATOR_MOVED, group->building_index, (uint8_t)i,
+                          group->piso_actual[i], group->destino_actual[i], 0, group->direccion_movimiento[i]);
+        LOG_INFO_GW("[SimStep] Ascensor %s %s a piso %d (Destino: %d, Tarea: %s)",
+                    group->ids[i].ascensor_id, group->direccion_movimiento[i] == MOVING_DOWN ? "BAJA" : "SUBE",
+                    group->piso_actual[i], group->destino_actual[i], group->ids[i].tarea_actual_id);
+        elevator_group_mark_dirty(group);
+    }
+    car->floor = floor;
+}
+
+/**
+ * @brief Mueve una cabina un paso hacia @p target_m
+ * @return true si la cabina se detuvo nivelada en @p target_m
+ */
+static bool move_step(gw_car_motion_t *car, const gw_sim_params_t *params, double target_m, double dt_s) {
+    double a = params->acceleration_mps2;
+    double dist = target_m - car->position_m;
+    double remaining = fabs(dist);
+    double speed = fabs(car->velocity_mps);
+
+    if (speed == 0.0 && remaining < KINEMATICS_LEVEL_EPSILON_M) {
+        car->position_m = target_m;
+        return true;
+    }
+
+    // Alejándose del destino (cambio de tarea en marcha): frenar antes de invertir
+    if (speed > 0.0 && (car->velocity_mps > 0.0) != (dist > 0.0)) {
+        double sign = car->velocity_mps > 0.0 ? 1.0 : -1.0;
+        double new_speed = fmax(speed - a * dt_s, 0.0);
+        car->position_m += sign * 0.5 * (speed + new_speed) * dt_s;
+        car->velocity_mps = sign * new_speed;
+        return false;
+    }
+
+    // Mayor velocidad final que aún permite detenerse en el destino tras recorrer
+    // este paso a velocidad media: v² + a·dt·v + a·dt·v0 - 2·a·d <= 0
+    double b = a * dt_s;
+    double disc = b * b - 4.0 * (b * speed - 2.0 * a * remaining);
+    double brake_speed = disc > 0.0 ? 0.5 * (sqrt(disc) - b) : 0.0;
+    double new_speed = fmax(fmin(fmin(speed + a * dt_s, params->speed_mps), brake_speed), 0.0);
+    double step = 0.5 * (speed + new_speed) * dt_s;
+    if (step >= remaining || (new_speed == 0.0 && remaining < a * dt_s * dt_s)) {
+        car->position_m = target_m;
+        car->velocity_mps = 0.0;
+        return true;
+    }
+    speed = new_speed;
+    car->position_m += dist > 0.0 ? step : -step;
+    car->velocity_mps = dist > 0.0 ? speed : -speed;
+    return false;
+}
+
+/**
+ * @brief Un paso fijo de una cabina
+ */
+static void car_step(elevator_group_state_t *group, int i, gw_car_motion_t *car,
+                     const gw_sim_params_t *params, uint32_t dt_ms) {
+    double h = params->floor_height_m;
+
+    // Cambios externos de piso, parada o en marcha (estado restaurado, frames 0x300)
+    if (group->piso_actual[i] != car->floor) {
+        resync_external_floor(group, i, car, params);
+    }
+
+    if (!door_step(group, i, car, params, (int32_t)dt_ms)) {
+        return;
+    }
+
+    bool has_task = group->ocupado[i] && group->destino_actual[i] != -1;
+    double target_m;
+    if (has_task) {
+        target_m = group->destino_actual[i] * h;
+    } else if (car->velocity_mps != 0.0) {
+        // Tarea retirada en marcha: detenerse en el primer piso alcanzable
+        double stop_m = car->position_m + copysign(car->velocity_mps * car->velocity_mps /
+                                                   (2.0 * params->acceleration_mps2), car->velocity_mps);
+        target_m = (car->velocity_mps > 0.0 ? ceil(stop_m / h - 1e-9) : floor(stop_m / h + 1e-9)) * h;
+    } else {
+        return; // Parado, sin tarea y con puertas cerradas
+    }
+
+    bool arrived = move_step(car, params, target_m, dt_ms / 1000.0);
+
+    uint8_t direction = car->velocity_mps > 0.0 ? MOVING_UP : car->velocity_mps < 0.0 ? MOVING_DOWN : STOPPED;
+    if (!arrived && direction != STOPPED && group->direccion_movimiento[i] != direction) {
+        group->direccion_movimiento[i] = direction;
+        elevator_group_mark_dirty(group);
+    }
+    update_floor(group, i, car, params);
+
+    if (arrived) {
+        if (has_task) {
+            complete_task(group, i);
+            group->estado_puerta[i] = DOOR_OPENING;
+            car->door_timer_ms = (int32_t)params->door_open_ms;
+        } else if (group->direccion_movimiento[i] != STOPPED) {
+            group->direccion_movimiento[i] = STOPPED;
+        }
+        elevator_group_mark_dirty(group);
+    }
+}
+
+void gw_kinematics_step_group(elevator_group_state_t *group, const gw_sim_params_t *params,
+                              uint32_t dt_ms, unsigned int steps) {
+    if (!group || !params || group->num_elevadores_en_grupo <= 0 || steps == 0) {
+        return;
+    }
+    gw_car_motion_t *cars = group_cars(group, params);
+    if (!cars) {
+        return;
+    }
+
+    elevator_group_write_begin(group); // Los lectores de otros hilos usan snapshots
+    for (unsigned int s = 0; s < steps; ++s) {
+        for (int i = 0; i < group->num_elevadores_en_grupo; ++i) {
+            car_step(group, i, &cars[i], params, dt_ms);
+        }
+    }
+    elevator_group_write_end(group);
+}
+
+unsigned int gw_kinematics_advance(uint64_t now_ms) {
+    if (!clock_started) {
+        clock_started = true;
+        last_advance_ms = now_ms;
+        return 0;
+    }
+    if (now_ms > last_advance_ms) {
+        accumulated_ms += now_ms - last_advance_ms;
+    }
+    last_advance_ms = now_ms;
+
+    const gw_config_t *config = gw_config();
+    uint32_t tick_ms = config->sim_tick_ms;
+    uint64_t steps = accumulated_ms / tick_ms;
+    accumulated_ms -= steps * tick_ms;
+    if (steps > GW_KINEMATICS_MAX_CATCHUP_STEPS) {
+        LOG_WARN_GW("[SimStep] Simulación retrasada %llu ms; se descartan %llu pasos.",
+                    (unsigned long long)(steps * tick_ms),
+                    (unsigned long long)(steps - GW_KINEMATICS_MAX_CATCHUP_STEPS));
+        steps = GW_KINEMATICS_MAX_CATCHUP_STEPS;
+    }
+    if (steps == 0) {
+        return 0;
+    }
+
+    uint16_t num_buildings = gw_building_count();
+    for (uint16_t b = 0; b < num_buildings; ++b) {
+        gw_kinematics_step_group(gw_building_get(b), &config->sim, tick_ms, (unsigned int)steps);
+    }
+    return (unsigned int)steps;
+}
+
+bool gw_kinematics_get_car(uint16_t building_index, int elevator_index, gw_car_motion_t *out) {
+    if (building_index >= GW_MAX_BUILDINGS || !building_cars[building_index] ||
+        elevator_index < 0 || elevator_index >= building_num_cars[building_index] || !out) {
+        return false;
+    }
+    *out = building_cars[building_index][elevator_index];
+    return true;
+}
+
+bool gw_kinematics_group_idle(const elevator_group_state_t *group) {
+    if (!group) {
+        return true;
+    }
+    uint16_t b = group->building_index;
+    bool has_cars = b < GW_MAX_BUILDINGS && building_cars[b] && building_group_storage[b] == group->storage;
+    for (int i = 0; i < group->num_elevadores_en_grupo; ++i) {
+        if (group->ocupado[i] || group->estado_puerta[i] != DOOR_CLOSED) {
+            return false;
+        }
+        if (has_cars && i < building_num_cars[b] && building_cars[b][i].velocity_mps != 0.0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+double gw_kinematics_travel_time_ms(const gw_sim_params_t *params, int floors) {
+    double distance = fabs((double)floors) * params->floor_height_m;
+    double v = params->speed_mps;
+    double a = params->acceleration_mps2;
+    if (distance >= v * v / a) {
+        return (distance / v + v / a) * 1000.0; // Trapezoidal: alcanza la velocidad nominal
+    }
+    return 2.0 * sqrt(distance / a) * 1000.0;   // Triangular
+}
+
+void gw_kinematics_init(void) {
+    gw_kinematics_cleanup();
+}
+
+void gw_kinematics_cleanup(void) {
+    for (int b = 0; b < GW_MAX_BUILDINGS; ++b) {
+        free(building_cars[b]);
+        building_cars[b] = NULL;
+        building_num_cars[b] = 0;
+        building_group_storage[b] = NULL;
+    }
+    clock_started = false;
+    last_advance_ms = 0;
+    accumulated_ms = 0;
+}
@@ -30,6 +30,7 @@
 
 #include "api_gateway/elevator_state_manager.h"
 #include "api_gateway/execution_logger.h"
+#include "api_gateway/state_journal.h"
 #include "api_gateway/logging_gw.h" // Para LOG_ERROR_GW, LOG_INFO_GW, etc. // Sistema de logging de ejecuciones
 #include <string.h> // For strcpy, memset, snprintf
 #include <stdio.h> // For snprintf
@@ -85,6 +86,62 @@ const char* movement_direction_to_string(movement_direction_enum_t direction) {
     }
 }
 
+/**
+ * @brief Alineación del bloque de tablas de un grupo (línea de caché)
+ */
+#define ELEVATOR_GROUP_ALIGN 64
+
+/**
+ * @brief Redondea un tamaño al siguiente múltiplo de ELEVATOR_GROUP_ALIGN
+ */
+static size_t align_up(size_t size) {
+    return (size + ELEVATOR_GROUP_ALIGN - 1) & ~(size_t)(ELEVATOR_GROUP_ALIGN - 1);
+}
+
+/**
+ * @brief Reserva el bloque de tablas de un grupo y reparte sus punteros
+ * @param group Grupo cuyas tablas se reservan
+ * @param num_elevadores Número de ascensores del grupo
+ * @return true si la reserva tuvo éxito
+ * 
+ * Disposición del bloque (cada sección empieza en línea de caché):
+ * 1. Estado caliente: piso y destino (int16_t), puerta, dirección y
+ *    ocupado (1 byte cada uno), contiguos
+ * 2. Tabla fría de IDs
+ * 3. Caché del fragmento JSON "elevadores_estado"
+ */
+static bool elevator_group_alloc(elevator_group_state_t *group, int num_elevadores) {
+    size_t n = (size_t)num_elevadores;
+    size_t hot_size = align_up(2 * n * sizeof(int16_t) + 3 * n);
+    size_t ids_size = align_up(n * sizeof(elevator_ids_t));
+    size_t cache_size = align_up(n * GW_JSON_CACHE_BYTES_PER_ELEVATOR + 2);
+
+    void *storage = NULL;
+    if (posix_memalign(&storage, ELEVATOR_GROUP_ALIGN, hot_size + ids_size + cache_size) != 0) {
+        return false;
+    }
+
+    char *base = storage;
+    group->storage = storage;
+    group->piso_actual = (int16_t *)base;
+    group->destino_actual = group->piso_actual + n;
+    group->estado_puerta = (uint8_t *)(group->destino_actual + n);
+    group->direccion_movimiento = group->estado_puerta + n;
+    group->ocupado = (bool *)(group->direccion_movimiento + n);
+    group->ids = (elevator_ids_t *)(base + hot_size);
+    group->json_cache.data = base + hot_size + ids_size;
+    group->json_cache.capacity = (uint32_t)cache_size;
+    group->num_elevadores_en_grupo = num_elevadores;
+    group->state_bytes = hot_size + ids_size;
+    return true;
+}
+
+void elevator_group_destroy(elevator_group_state_t *group) {
+    if (!group) return;
+    free(group->storage);
+    memset(group, 0, sizeof(*group));
+}
+
 /**
  * @brief Inicializa un grupo de ascensores con configuración específica
  * @param group Puntero al grupo de ascensores a inicializar
@@ -96,7 +153,8 @@ const char* movement_direction_to_string(movement_direction_enum_t direction) {
  * la configuración especificada. Realiza las siguientes operaciones:
  * 
  * 1. **Validación**: Verifica parámetros de entrada válidos
- * 2. **Limpieza**: Inicializa la estructura a cero
+ * 2. **Reserva**: Libera las tablas anteriores y reserva las nuevas a la
+ *    medida del grupo
  * 3. **Configuración del grupo**: Establece ID del edificio y número de ascensores
  * 4. **Inicialización individual**: Configura cada ascensor con:
  *    - ID único (formato: {edificio_id}A{numero})
@@ -107,7 +165,7 @@ const char* movement_direction_to_string(movement_direction_enum_t direction) {
  * 
  * @note El número de ascensores debe estar entre 1 y MAX_ELEVATORS_PER_GATEWAY
  * @see elevator_group_state_t
- * @see elevator_status_t
+ * @see elevator_group_destroy()
  */
 void init_elevator_group(elevator_group_state_t *group, const char* edificio_id_str, int num_elevadores, int num_pisos) {
     if (!group || !edificio_id_str) {
@@ -121,31 +179,33 @@ void init_elevator_group(elevator_group_state_t *group, const char* edificio_id_
         return;
     }
 
-    memset(group, 0, sizeof(elevator_group_state_t)); // Limpiar toda la estructura
+    elevator_group_destroy(group); // Liberar tablas anteriores y limpiar toda la estructura
+    if (!elevator_group_alloc(group, num_elevadores)) {
+        LOG_ERROR_GW("StateMgr: Sin memoria para las tablas de %d ascensores del edificio '%s'.", num_elevadores, edificio_id_str);
+        return;
+    }
     strncpy(group->edificio_id_str_grupo, edificio_id_str, ID_STRING_MAX_LEN - 1);
     group->edificio_id_str_grupo[ID_STRING_MAX_LEN - 1] = '\0'; // Asegurar null-termination
-    group->num_elevadores_en_grupo = num_elevadores;
+    group->state_version = 1; // Caché JSON vacía (json_cache.version == 0)
 
     LOG_INFO_GW("StateMgr: Inicializando %d ascensores para edificio '%s', %d pisos.", num_elevadores, edificio_id_str, num_pisos);
 
     for (int i = 0; i < num_elevadores; ++i) {
-        elevator_status_t *elevator = &group->ascensores[i];
-        snprintf(elevator->ascensor_id, ID_STRING_MAX_LEN, "%sA%d", edificio_id_str, i + 1);
-        strncpy(elevator->id_edificio_str, edificio_id_str, ID_STRING_MAX_LEN - 1);
-        elevator->id_edificio_str[ID_STRING_MAX_LEN - 1] = '\0';
-        
-        elevator->piso_actual = 0; // Todos empiezan en planta baja (piso 0)
-        elevator->estado_puerta_enum = DOOR_CLOSED;
-        elevator->tarea_actual_id[0] = '\0'; // Sin tarea
-        elevator->destino_actual = -1; // Sin destino
-        elevator->direccion_movimiento_enum = STOPPED;
-        elevator->ocupado = false;
+        elevator_ids_t *ids = &group->ids[i];
+        snprintf(ids->ascensor_id, ID_STRING_MAX_LEN, "%sA%d", edificio_id_str, i + 1);
+        ids->tarea_actual_id[0] = '\0'; // Sin tarea
+
+        group->piso_actual[i] = 0; // Todos empiezan en planta baja (piso 0)
+        group->estado_puerta[i] = DOOR_CLOSED;
+        group->destino_actual[i] = -1; // Sin destino
+        group->direccion_movimiento[i] = STOPPED;
+        group->ocupado[i] = false;
 
         LOG_DEBUG_GW("StateMgr: Ascensor %s inicializado: Piso %d, Puerta %s, Ocupado: %s", 
-                     elevator->ascensor_id, 
-                     elevator->piso_actual, 
-                     door_state_to_string(elevator->estado_puerta_enum),
-                     elevator->ocupado ? "Sí" : "No");
+                     ids->ascensor_id, 
+                     group->piso_actual[i], 
+                     door_state_to_string(group->estado_puerta[i]),
+                     group->ocupado[i] ? "Sí" : "No");
     }
 }
 
@@ -167,6 +227,8 @@ void init_elevator_group(elevator_group_state_t *group, const char* edificio_id_
  * - Para cada ascensor: ID, piso actual, estado puertas, disponibilidad
  * 
  * El llamador es responsable de liberar el objeto cJSON con cJSON_Delete().
+ * Para generar el payload en el camino de reenvío sin reservar memoria se
+ * usa elevator_group_write_json_for_server(), que produce los mismos bytes.
  * 
  * @see gw_request_type_t
  * @see api_request_details_for_json_t
@@ -219,29 +281,29 @@ cJSON* elevator_group_to_json_for_server(const elevator_group_state_t *group,
     cJSON_AddItemToObject(root, "elevadores_estado", elevadores_array);
 
     for (int i = 0; i < group->num_elevadores_en_grupo; ++i) {
-        const elevator_status_t *elevator = &group->ascensores[i];
+        const elevator_ids_t *ids = &group->ids[i];
         cJSON *elevator_json = cJSON_CreateObject();
         if (!elevator_json) {
-            LOG_ERROR_GW("StateMgr: Failed to create JSON object for elevator %s.", elevator->ascensor_id);
+            LOG_ERROR_GW("StateMgr: Failed to create JSON object for elevator %s.", ids->ascensor_id);
             cJSON_Delete(root); // Clean up partially created JSON
             return NULL;
         }
 
-        cJSON_AddStringToObject(elevator_json, "id_ascensor", elevator->ascensor_id);
-        cJSON_AddNumberToObject(elevator_json, "piso_actual", elevator->piso_actual);
-        cJSON_AddStringToObject(elevator_json, "estado_puerta", door_state_to_string(elevator->estado_puerta_enum));
+        cJSON_AddStringToObject(elevator_json, "id_ascensor", ids->ascensor_id);
+        cJSON_AddNumberToObject(elevator_json, "piso_actual", group->piso_actual[i]);
+        cJSON_AddStringToObject(elevator_json, "estado_puerta", door_state_to_string(group->estado_puerta[i]));
         
         // El servidor espera "disponible", que es lo inverso de nuestro "ocupado".
-        cJSON_AddBoolToObject(elevator_json, "disponible", !elevator->ocupado); 
+        cJSON_AddBoolToObject(elevator_json, "disponible", !group->ocupado[i]); 
 
-        if (elevator->tarea_actual_id[0] != '\0') {
-            cJSON_AddStringToObject(elevator_json, "tarea_actual_id", elevator->tarea_actual_id);
+        if (ids->tarea_actual_id[0] != '\0') {
+            cJSON_AddStringToObject(elevator_json, "tarea_actual_id", ids->tarea_actual_id);
         } else {
             cJSON_AddNullToObject(elevator_json, "tarea_actual_id");
         }
 
-        if (elevator->destino_actual != -1) {
-            cJSON_AddNumberToObject(elevator_json, "destino_actual", elevator->destino_actual);
+        if (group->destino_actual[i] != -1) {
+            cJSON_AddNumberToObject(elevator_json, "destino_actual", group->destino_actual[i]);
         } else {
             cJSON_AddNullToObject(elevator_json, "destino_actual");
         }
@@ -254,6 +316,244 @@ cJSON* elevator_group_to_json_for_server(const elevator_group_state_t *group,
     return root;
 }
 
+/**
+ * @brief Escritor JSON sobre un buffer de tamaño fijo
+ * 
+ * Cuenta todos los bytes que se escribirían aunque el buffer se llene, para
+ * poder devolver la longitud necesaria como snprintf().
+ */
+typedef struct {
+    char *buf;    ///< Buffer de destino (puede ser NULL)
+    size_t size;  ///< Tamaño del buffer
+    size_t len;   ///< Bytes generados hasta ahora (incluidos los que no cupieron)
+} json_writer_t;
+
+static void json_put_raw(json_writer_t *w, const char *s, size_t n) {
+    if (w->len < w->size) {
+        size_t room = w->size - w->len;
+        memcpy(w->buf + w->len, s, n < room ? n : room);
+    }
+    w->len += n;
+}
+
+static void json_put_char(json_writer_t *w, char c) {
+    if (w->len < w->size) {
+        w->buf[w->len] = c;
+    }
+    w->len++;
+}
+
+static void json_put_int(json_writer_t *w, int value) {
+    char tmp[16];
+    int n = snprintf(tmp, sizeof(tmp), "%d", value);
+    json_put_raw(w, tmp, (size_t)n);
+}
+
+/**
+ * @brief Escribe un string JSON con el mismo escapado que cJSON
+ */
+static void json_put_string(json_writer_t *w, const char *s) {
+    static const char hex[] = "0123456789abcdef";
+    json_put_char(w, '"');
+    const char *run = s;
+    for (; *s; ++s) {
+        unsigned char c = (unsigned char)*s;
+        if (c >= 32 && c != '"' && c != '\\') {
+            continue;
+        }
+        json_put_raw(w, run, (size_t)(s - run));
+        run = s + 1;
+        json_put_char(w, '\\');
+        switch (c) {
+            case '"':  json_put_char(w, '"'); break;
+            case '\\': json_put_char(w, '\\'); break;
+            case '\b': json_put_char(w, 'b'); break;
+            case '\f': json_put_char(w, 'f'); break;
+            case '\n': json_put_char(w, 'n'); break;
+            case '\r': json_put_char(w, 'r'); break;
+            case '\t': json_put_char(w, 't'); break;
+            default: {
+                char esc[5] = { 'u', '0', '0', hex[c >> 4], hex[c & 0x0F] };
+                json_put_raw(w, esc, sizeof(esc));
+                break;
+            }
+        }
+    }
+    json_put_raw(w, run, (size_t)(s - run));
+    json_put_char(w, '"');
+}
+
+#define JSON_PUT_LITERAL(w, lit) json_put_raw((w), (lit), sizeof(lit) - 1)
+
+/**
+ * @brief Escribe el array "elevadores_estado" (de '[' a ']')
+ */
+static void json_put_elevators(json_writer_t *w, const elevator_group_state_t *group) {
+    json_put_char(w, '[');
+    for (int i = 0; i < group->num_elevadores_en_grupo; ++i) {
+        const elevator_ids_t *ids = &group->ids[i];
+        if (i > 0) json_put_char(w, ',');
+        JSON_PUT_LITERAL(w, "{\"id_ascensor\":");
+        json_put_string(w, ids->ascensor_id);
+        JSON_PUT_LITERAL(w, ",\"piso_actual\":");
+        json_put_int(w, group->piso_actual[i]);
+        JSON_PUT_LITERAL(w, ",\"estado_puerta\":");
+        json_put_string(w, door_state_to_string(group->estado_puerta[i]));
+        if (group->ocupado[i]) {
+            JSON_PUT_LITERAL(w, ",\"disponible\":false");
+        } else {
+            JSON_PUT_LITERAL(w, ",\"disponible\":true");
+        }
+        JSON_PUT_LITERAL(w, ",\"tarea_actual_id\":");
+        if (ids->tarea_actual_id[0] != '\0') {
+            json_put_string(w, ids->tarea_actual_id);
+        } else {
+            JSON_PUT_LITERAL(w, "null");
+        }
+        JSON_PUT_LITERAL(w, ",\"destino_actual\":");
+        if (group->destino_actual[i] != -1) {
+            json_put_int(w, group->destino_actual[i]);
+        } else {
+            JSON_PUT_LITERAL(w, "null");
+        }
+        json_put_char(w, '}');
+    }
+    json_put_char(w, ']');
+}
+
+int elevator_group_find_index(const elevator_group_state_t *group, const char *elevator_id) {
+    if (!group || !elevator_id) return -1;
+
+    const char *num_part = strrchr(elevator_id, 'A');
+    if (!num_part || num_part[1] < '1' || num_part[1] > '9') return -1;
+
+    int number = 0;
+    for (const char *p = num_part + 1; *p; ++p) {
+        if (*p < '0' || *p > '9' || number > MAX_ELEVATORS_PER_GATEWAY) return -1;
+        number = number * 10 + (*p - '0');
+    }
+
+    int index = number - 1;
+    if (index >= group->num_elevadores_en_grupo ||
+        strcmp(group->ids[index].ascensor_id, elevator_id) != 0) {
+        return -1;
+    }
+    return index;
+}
+
+void elevator_group_mark_dirty(elevator_group_state_t *group) {
+    if (!group) return;
+    if (++group->state_version == 0) {
+        group->state_version = 1; // 0 queda reservado para "caché vacía"
+    }
+}
+
+void elevator_group_write_begin(elevator_group_state_t *group) {
+    if (!group) return;
+    __atomic_store_n(&group->seq, group->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE); // El contador impar se publica antes que los datos
+}
+
+void elevator_group_write_end(elevator_group_state_t *group) {
+    if (!group) return;
+    __atomic_store_n(&group->seq, group->seq + 1, __ATOMIC_RELEASE);
+}
+
+bool elevator_group_read_snapshot(const elevator_group_state_t *live, elevator_group_state_t *snapshot) {
+    if (!live || !snapshot || !live->storage) {
+        return false;
+    }
+
+    // El tamaño y el edificio solo cambian en init_elevator_group(), nunca
+    // en una sección de escritura
+    if (!snapshot->storage || snapshot->num_elevadores_en_grupo != live->num_elevadores_en_grupo) {
+        elevator_group_destroy(snapshot);
+        if (!elevator_group_alloc(snapshot, live->num_elevadores_en_grupo)) {
+            LOG_ERROR_GW("StateMgr: Sin memoria para el snapshot del edificio '%s'.", live->edificio_id_str_grupo);
+            return false;
+        }
+    }
+    memcpy(snapshot->edificio_id_str_grupo, live->edificio_id_str_grupo, ID_STRING_MAX_LEN);
+
+    for (int attempt = 0; attempt < GW_SNAPSHOT_MAX_RETRIES; ++attempt) {
+        uint32_t seq_before = __atomic_load_n(&live->seq, __ATOMIC_ACQUIRE);
+        if (seq_before & 1u) {
+            continue; // Escritura en curso
+        }
+        memcpy(snapshot->storage, live->storage, live->state_bytes);
+        uint32_t version = live->state_version;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE); // Las lecturas de datos terminan antes de releer el contador
+        if (__atomic_load_n(&live->seq, __ATOMIC_RELAXED) == seq_before) {
+            snapshot->state_version = version;
+            return true;
+        }
+    }
+    return false;
+}
+
+int elevator_group_write_json_for_server(elevator_group_state_t *group,
+                                         gw_request_type_t request_type,
+                                         const api_request_details_for_json_t* details,
+                                         char *buf, size_t buf_size) {
+    if (!group) {
+        LOG_ERROR_GW("StateMgr: elevator_group_write_json - group es NULL.");
+        return -1;
+    }
+
+    json_writer_t w = { buf, buf ? buf_size : 0, 0 };
+
+    JSON_PUT_LITERAL(&w, "{\"id_edificio\":");
+    json_put_string(&w, group->edificio_id_str_grupo);
+
+    if (details) {
+        switch (request_type) {
+            case GW_REQUEST_TYPE_FLOOR_CALL:
+                JSON_PUT_LITERAL(&w, ",\"piso_origen_llamada\":");
+                json_put_int(&w, details->origin_floor_fc);
+                JSON_PUT_LITERAL(&w, ",\"direccion_llamada\":");
+                json_put_string(&w, movement_direction_to_string(details->direction_fc));
+                break;
+            case GW_REQUEST_TYPE_CABIN_REQUEST:
+                JSON_PUT_LITERAL(&w, ",\"solicitando_ascensor_id\":");
+                json_put_string(&w, details->requesting_elevator_id_cr);
+                JSON_PUT_LITERAL(&w, ",\"piso_destino_solicitud\":");
+                json_put_int(&w, details->target_floor_cr);
+                break;
+            case GW_REQUEST_TYPE_UNKNOWN:
+            default:
+                LOG_WARN_GW("StateMgr: Unknown or unhandled request type (%d) for adding specific JSON details.", request_type);
+                break;
+        }
+    }
+
+    JSON_PUT_LITERAL(&w, ",\"elevadores_estado\":");
+    // El array de ascensores solo se codifica cuando cambia la versión de
+    // estado; los grupos sin versión (no inicializados) no usan la caché.
+    elevator_json_cache_t *cache = &group->json_cache;
+    if (group->state_version != 0 && cache->capacity > 0 && cache->version != group->state_version) {
+        json_writer_t cw = { cache->data, cache->capacity, 0 };
+        json_put_elevators(&cw, group);
+        if (cw.len <= cache->capacity) {
+            cache->len = (uint32_t)cw.len;
+            cache->version = group->state_version;
+        } else {
+            cache->version = 0; // No cabe: se escribe directamente en cada payload
+        }
+    }
+    if (group->state_version != 0 && cache->version == group->state_version) {
+        json_put_raw(&w, cache->data, cache->len);
+    } else {
+        json_put_elevators(&w, group);
+    }
+    JSON_PUT_LITERAL(&w, "}");
+
+    // Terminador nulo (no cuenta en la longitud devuelta)
+    if (w.size > 0) {
+        w.buf[w.len < w.size ? w.len : w.size - 1] = '\0';
+    }
+    return (int)w.len;
+}
+
 /**
  * @brief Actualiza el estado de un ascensor tras recibir asignación de tarea
  * @param group Puntero al grupo de ascensores
@@ -276,7 +576,6 @@ cJSON* elevator_group_to_json_for_server(const elevator_group_state_t *group,
  * del ascensor con el piso destino de la tarea.
  * 
  * @see elevator_group_state_t
- * @see elevator_status_t
  * @see exec_logger_log_task_assigned()
  */
 void assign_task_to_elevator(elevator_group_state_t *group, const char* elevator_id_to_update, const char* task_id, int target_floor, int current_request_floor) {
@@ -285,50 +584,52 @@ void assign_task_to_elevator(elevator_group_state_t *group, const char* elevator
         return;
     }
 
-    bool found = false;
-    for (int i = 0; i < group->num_elevadores_en_grupo; ++i) {
-        elevator_status_t *elevator = &group->ascensores[i];
-        if (strcmp(elevator->ascensor_id, elevator_id_to_update) == 0) {
-            strncpy(elevator->tarea_actual_id, task_id, TASK_ID_MAX_LEN - 1);
-            elevator->tarea_actual_id[TASK_ID_MAX_LEN - 1] = '\0';
-            elevator->destino_actual = target_floor;
-            elevator->ocupado = true;
-
-            // Determinar dirección de movimiento
-            // Si el ascensor ya está en el piso de la solicitud, la dirección es hacia el target_floor
-            // Si no, current_request_floor nos da el punto de partida para la nueva tarea.
-            int reference_floor_for_direction = elevator->piso_actual;
-            // Si el ascensor está siendo asignado a una tarea que no es donde está ahora mismo,
-            // y current_request_floor es válido, usarlo como referencia.
-            // Esto es útil si el ascensor estaba parado y se le asigna una llamada desde otro piso.
-            // Sin embargo, en nuestro modelo, el ascensor es asignado y *luego* se movería.
-            // Para simplificar: la dirección se basa en su piso_actual vs target_floor.
-            // La lógica de si puede recoger current_request_floor en el camino sería más compleja.
-
-            if (target_floor > elevator->piso_actual) {
-                elevator->direccion_movimiento_enum = MOVING_UP;
-            } else if (target_floor < elevator->piso_actual) {
-                elevator->direccion_movimiento_enum = MOVING_DOWN;
-            } else { // target_floor == elevator->piso_actual
-                // Si el destino es el piso actual, podría estar abriendo puertas, o es una tarea instantánea.
-                // Consideraremos que se detiene momentáneamente si no estaba ya parado.
-                elevator->direccion_movimiento_enum = STOPPED; 
-                // Aquí podríamos cambiar estado_puerta_enum a DOOR_OPENING si la lógica lo requiere.
-            }
+    int index = elevator_group_find_index(group, elevator_id_to_update);
+    bool found = index >= 0;
+    if (found) {
+        elevator_ids_t *ids = &group->ids[index];
+        elevator_group_write_begin(group);
+        strncpy(ids->tarea_actual_id, task_id, TASK_ID_MAX_LEN - 1);
+        ids->tarea_actual_id[TASK_ID_MAX_LEN - 1] = '\0';
+        group->destino_actual[index] = target_floor;
+        group->ocupado[index] = true;
+        elevator_group_mark_dirty(group);
 
-            LOG_INFO_GW("StateMgr: Tarea '%s' asignada a ascensor %s. Destino: piso %d. Piso actual: %d. Dirección: %s",
-                        elevator->tarea_actual_id, 
-                        elevator->ascensor_id,
-                        elevator->destino_actual,
-                        elevator->piso_actual,
-                        movement_direction_to_string(elevator->direccion_movimiento_enum));
-            
-            // Registrar asignación de tarea en el logger
-            exec_logger_log_task_assigned(elevator->tarea_actual_id, elevator->ascensor_id, elevator->destino_actual);
-            
-            found = true;
-            break;
+        // Determinar dirección de movimiento
+        // Si el ascensor ya está en el piso de la solicitud, la dirección es hacia el target_floor
+        // Si no, current_request_floor nos da el punto de partida para la nueva tarea.
+        int reference_floor_for_direction = group->piso_actual[index];
+        // Si el ascensor está siendo asignado a una tarea que no es donde está ahora mismo,
+        // y current_request_floor es válido, usarlo como referencia.
+        // Esto es útil si el ascensor estaba parado y se le asigna una llamada desde otro piso.
+        // Sin embargo, en nuestro modelo, el ascensor es asignado y *luego* se movería.
+        // Para simplificar: la dirección se basa en su piso_actual vs target_floor.
+        // La lógica de si puede recoger current_request_floor en el camino sería más compleja.
+
+        if (target_floor > group->piso_actual[index]) {
+            group->direccion_movimiento[index] = MOVING_UP;
+        } else if (target_floor < group->piso_actual[index]) {
+            group->direccion_movimiento[index] = MOVING_DOWN;
+        } else { // target_floor == group->piso_actual[index]
+            // Si el destino es el piso actual, podría estar abriendo puertas, o es una tarea instantánea.
+            // Consideraremos que se detiene momentáneamente si no estaba ya parado.
+            group->direccion_movimiento[index] = STOPPED; 
+            // Aquí podríamos cambiar estado_puerta a DOOR_OPENING si la lógica lo requiere.
         }
+        elevator_group_write_end(group);
+
+        LOG_INFO_GW("StateMgr: Tarea '%s' asignada a ascensor %s. Destino: piso %d. Piso actual: %d. Dirección: %s",
+                    ids->tarea_actual_id, 
+                    ids->ascensor_id,
+                    group->destino_actual[index],
+                    group->piso_actual[index],
+                    movement_direction_to_string(group->direccion_movimiento[index]));
+        
+        // Registrar asignación de tarea en el logger
+        exec_logger_log_task_assigned(ids->tarea_actual_id, ids->ascensor_id, group->destino_actual[index]);
+        gw_journal_record(GW_JOURNAL_TASK_ASSIGNED, group->building_index, (uint8_t)index,
+                          group->piso_actual[index], group->destino_actual[index],
+                          gw_journal_hash_id(ids->tarea_actual_id), group->direccion_movimiento[index]);
     }
 
     if (!found) {
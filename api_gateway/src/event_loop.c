@@ -0,0 +1,409 @@
+/**
+ * @file event_loop.c
+ * @brief Implementación del bucle de eventos epoll/timerfd del API Gateway
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * @see event_loop.h
+ */
+
+#include "api_gateway/event_loop.h"
+#include "api_gateway/api_handlers.h"    // hnd_tracker_timeout_gw
+#include "api_gateway/request_tracker.h" // Deadlines de trackers
+#include "api_gateway/logging_gw.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+
+/**
+ * @brief Número máximo de eventos atendidos por llamada a epoll_wait
+ */
+#define GW_LOOP_MAX_EVENTS 16
+
+/**
+ * @brief Vencimientos atrasados que se recuperan como máximo por disparo
+ *
+ * Evita ráfagas de pasos de simulación tras un bloqueo largo (p. ej. el
+ * proceso detenido en un depurador); los vencimientos sobrantes se descartan.
+ */
+#define GW_LOOP_MAX_CATCHUP 10
+
+/**
+ * @brief Espera máxima de coap_io_process() en el bucle de respaldo (ms)
+ *
+ * Se aplica cuando no hay temporizadores periódicos más cortos y ningún
+ * deadline vence antes, para que la bandera de salida y los descriptores
+ * vigilados se sigan atendiendo.
+ */
+#define GW_LOOP_MAX_POLL_WAIT_MS 1000u
+
+/**
+ * @brief Valor de data.u32 en epoll para el descriptor de libcoap
+ */
+#define GW_LOOP_TAG_COAP 0xFFFFFFFFu
+
+/**
+ * @brief Valor de data.u32 en epoll para el timerfd de trackers
+ */
+#define GW_LOOP_TAG_TRACKERS 0xFFFFFFFEu
+
+/**
+ * @brief Valor base de data.u32 en epoll para los descriptores vigilados
+ */
+#define GW_LOOP_TAG_WATCH_BASE 0x10000u
+
+/**
+ * @brief Descriptor adicional vigilado por el bucle
+ */
+typedef struct {
+    int fd;                       ///< Descriptor vigilado
+    gw_loop_fd_cb_t on_readable;  ///< Callback de lectura
+    void *arg;                    ///< Argumento del callback
+} gw_loop_watch_t;
+
+/**
+ * @brief Descriptores registrados con gw_event_loop_watch_fd()
+ */
+static gw_loop_watch_t loop_watches[GW_LOOP_MAX_WATCHES];
+
+/**
+ * @brief Número de descriptores registrados
+ */
+static size_t num_loop_watches = 0;
+
+/**
+ * @brief Función invocada al final de cada vuelta del bucle
+ */
+static gw_loop_timer_cb_t loop_flush_hook = NULL;
+
+/**
+ * @brief Argumento de loop_flush_hook
+ */
+static void *loop_flush_hook_arg = NULL;
+
+int gw_event_loop_watch_fd(int fd, gw_loop_fd_cb_t on_readable, void *arg) {
+    if (fd < 0 || !on_readable || num_loop_watches >= GW_LOOP_MAX_WATCHES) {
+        LOG_ERROR_GW("[EventLoop] No se pudo vigilar el descriptor %d.", fd);
+        return -1;
+    }
+    loop_watches[num_loop_watches].fd = fd;
+    loop_watches[num_loop_watches].on_readable = on_readable;
+    loop_watches[num_loop_watches].arg = arg;
+    num_loop_watches++;
+    return 0;
+}
+
+void gw_event_loop_set_flush_hook(gw_loop_timer_cb_t hook, void *arg) {
+    loop_flush_hook = hook;
+    loop_flush_hook_arg = arg;
+}
+
+/**
+ * @brief Invoca la función de fin de vuelta si está registrada
+ */
+static void run_flush_hook(void) {
+    if (loop_flush_hook) {
+        loop_flush_hook(loop_flush_hook_arg);
+    }
+}
+
+/**
+ * @brief Arma un timerfd de forma absoluta sobre CLOCK_MONOTONIC
+ * @param fd Descriptor del timerfd
+ * @param deadline_ms Instante de disparo en ms (0 desarma el timer)
+ * @param interval_ms Periodo en ms (0 para un solo disparo)
+ * @return 0 si tuvo éxito, -1 en caso de error
+ */
+static int arm_timerfd_abs(int fd, uint64_t deadline_ms, unsigned int interval_ms) {
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+    its.it_value.tv_sec = (time_t)(deadline_ms / 1000u);
+    its.it_value.tv_nsec = (long)(deadline_ms % 1000u) * 1000000L;
+    its.it_interval.tv_sec = (time_t)(interval_ms / 1000u);
+    its.it_interval.tv_nsec = (long)(interval_ms % 1000u) * 1000000L;
+    return timerfd_settime(fd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+/**
+ * @brief Arma un timerfd de un solo disparo en un instante absoluto en ns
+ * @param fd Descriptor del timerfd
+ * @param deadline_ns Instante de CLOCK_MONOTONIC en ns (0 desarma el timer)
+ * @return 0 si tuvo éxito, -1 en caso de error
+ */
+static int arm_timerfd_abs_ns(int fd, uint64_t deadline_ns) {
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+    its.it_value.tv_sec = (time_t)(deadline_ns / 1000000000u);
+    its.it_value.tv_nsec = (long)(deadline_ns % 1000000000u);
+    return timerfd_settime(fd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+/**
+ * @brief Lee y devuelve el número de vencimientos pendientes de un timerfd
+ * @param fd Descriptor del timerfd
+ * @return Vencimientos desde la última lectura (0 si no había ninguno)
+ */
+static uint64_t drain_timerfd(int fd) {
+    uint64_t expirations = 0;
+    if (read(fd, &expirations, sizeof(expirations)) != (ssize_t)sizeof(expirations)) {
+        return 0;
+    }
+    return expirations;
+}
+
+/**
+ * @brief Reprograma el timerfd de trackers al deadline más próximo
+ * @param fd Descriptor del timerfd de trackers
+ * @param armed_deadline_ms Deadline actualmente armado (se actualiza)
+ */
+static void rearm_tracker_timer(int fd, uint64_t *armed_deadline_ms) {
+    uint64_t next = gw_tracker_next_deadline_ms();
+    if (next == *armed_deadline_ms) {
+        return;
+    }
+    if (arm_timerfd_abs(fd, next, 0) == 0) {
+        *armed_deadline_ms = next;
+    }
+}
+
+/**
+ * @brief Reprograma un temporizador de un solo disparo a su próximo deadline
+ * @param fd Descriptor del timerfd del temporizador
+ * @param timer Temporizador con next_deadline
+ * @param armed_deadline_ns Deadline actualmente armado (se actualiza)
+ */
+static void rearm_deadline_timer(int fd, const gw_loop_timer_t *timer, uint64_t *armed_deadline_ns) {
+    uint64_t next = timer->next_deadline(timer->arg);
+    if (next == *armed_deadline_ns) {
+        return;
+    }
+    if (arm_timerfd_abs_ns(fd, next) == 0) {
+        *armed_deadline_ns = next;
+    }
+}
+
+/**
+ * @brief Bucle de respaldo cuando libcoap no expone un descriptor epoll
+ * @param ctx Contexto CoAP
+ * @param timers Temporizadores
+ * @param num_timers Número de temporizadores
+ * @param quit_flag Bandera de salida
+ * @return 0 si se salió por la bandera, -1 si coap_io_process falló
+ *
+ * Duerme en coap_io_process() hasta el próximo vencimiento y después
+ * atiende los temporizadores y trackers vencidos según CLOCK_MONOTONIC.
+ */
+static int run_polling_loop(coap_context_t *ctx, const gw_loop_timer_t *timers,
+                            size_t num_timers, volatile sig_atomic_t *quit_flag) {
+    uint64_t next_due[GW_LOOP_MAX_TIMERS];
+    uint64_t now = gw_tracker_now_ms();
+    uint64_t max_wait_ms = GW_LOOP_MAX_POLL_WAIT_MS;
+    for (size_t i = 0; i < num_timers; ++i) {
+        next_due[i] = now + timers[i].interval_ms;
+        if (!timers[i].next_deadline && timers[i].interval_ms > 0 && timers[i].interval_ms < max_wait_ms) {
+            max_wait_ms = timers[i].interval_ms;
+        }
+    }
+
+    while (!*quit_flag) {
+        now = gw_tracker_now_ms();
+        uint64_t wake = gw_tracker_next_deadline_ms();
+        for (size_t i = 0; i < num_timers; ++i) {
+            if (timers[i].next_deadline) {
+                // Sin timerfd la resolución es la de coap_io_process (ms)
+                uint64_t deadline_ns = timers[i].next_deadline(timers[i].arg);
+                next_due[i] = deadline_ns ? (deadline_ns + 999999u) / 1000000u : UINT64_MAX;
+            }
+            if (wake == 0 || next_due[i] < wake) wake = next_due[i];
+        }
+        // Sin nada programado (wake 0 o UINT64_MAX) se duerme como mucho max_wait_ms
+        uint32_t wait_ms = COAP_IO_NO_WAIT;
+        if (wake == 0 || wake > now) {
+            wait_ms = (uint32_t)((wake == 0 || wake - now > max_wait_ms) ? max_wait_ms : wake - now);
+        }
+
+        if (coap_io_process(ctx, wait_ms) < 0) {
+            LOG_ERROR_GW("[EventLoop] Error en coap_io_process.");
+            return -1;
+        }
+
+        now = gw_tracker_now_ms();
+        for (size_t i = 0; i < num_timers && !*quit_flag; ++i) {
+            if (timers[i].next_deadline) {
+                if (next_due[i] <= now) {
+                    timers[i].callback(timers[i].arg);
+                }
+                continue;
+            }
+            int runs = 0;
+            while (next_due[i] <= now && runs < GW_LOOP_MAX_CATCHUP) {
+                timers[i].callback(timers[i].arg);
+                next_due[i] += timers[i].interval_ms;
+                runs++;
+            }
+            if (next_due[i] <= now) {
+                next_due[i] = now + timers[i].interval_ms;
+            }
+        }
+        gw_tracker_expire(now, hnd_tracker_timeout_gw);
+
+        for (size_t i = 0; i < num_loop_watches; ++i) {
+            loop_watches[i].on_readable(loop_watches[i].fd, loop_watches[i].arg);
+        }
+        run_flush_hook();
+    }
+    return 0;
+}
+
+int gw_event_loop_run(coap_context_t *ctx,
+                      const gw_loop_timer_t *timers,
+                      size_t num_timers,
+                      volatile sig_atomic_t *quit_flag) {
+    if (!ctx || !quit_flag || num_timers > GW_LOOP_MAX_TIMERS || (num_timers > 0 && !timers)) {
+        LOG_ERROR_GW("[EventLoop] Parámetros inválidos para el bucle de eventos.");
+        return -1;
+    }
+
+    int coap_fd = coap_context_get_coap_fd(ctx);
+    if (coap_fd < 0) {
+        LOG_WARN_GW("[EventLoop] libcoap sin soporte epoll. Usando coap_io_process con timeouts por temporizador.");
+        return run_polling_loop(ctx, timers, num_timers, quit_flag);
+    }
+
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd < 0) {
+        LOG_ERROR_GW("[EventLoop] epoll_create1 falló: %s", strerror(errno));
+        return -1;
+    }
+
+    int timer_fds[GW_LOOP_MAX_TIMERS];
+    uint64_t armed_deadline_ns[GW_LOOP_MAX_TIMERS] = { 0 };
+    int tracker_fd = -1;
+    int result = -1;
+    size_t created = 0;
+    struct epoll_event ev;
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.u32 = GW_LOOP_TAG_COAP;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, coap_fd, &ev) < 0) {
+        LOG_ERROR_GW("[EventLoop] No se pudo registrar el descriptor de libcoap: %s", strerror(errno));
+        goto cleanup;
+    }
+
+    uint64_t now = gw_tracker_now_ms();
+    for (created = 0; created < num_timers; ++created) {
+        const gw_loop_timer_t *t = &timers[created];
+        int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        // Los de un solo disparo se arman al entrar en el bucle
+        if (fd < 0 || !t->callback || (!t->next_deadline && t->interval_ms == 0) ||
+            (!t->next_deadline && arm_timerfd_abs(fd, now + t->interval_ms, t->interval_ms) < 0)) {
+            LOG_ERROR_GW("[EventLoop] No se pudo crear el temporizador '%s'.", t->name ? t->name : "?");
+            if (fd >= 0) close(fd);
+            goto cleanup;
+        }
+        timer_fds[created] = fd;
+        ev.data.u32 = (uint32_t)created;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            LOG_ERROR_GW("[EventLoop] No se pudo registrar el temporizador '%s': %s", t->name ? t->name : "?", strerror(errno));
+            created++; // Cerrar también este descriptor
+            goto cleanup;
+        }
+        if (t->next_deadline) {
+            LOG_DEBUG_GW("[EventLoop] Temporizador '%s' de un solo disparo.", t->name ? t->name : "?");
+        } else {
+            LOG_DEBUG_GW("[EventLoop] Temporizador '%s' cada %u ms.", t->name ? t->name : "?", t->interval_ms);
+        }
+    }
+
+    tracker_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (tracker_fd < 0) {
+        LOG_ERROR_GW("[EventLoop] No se pudo crear el temporizador de trackers: %s", strerror(errno));
+        goto cleanup;
+    }
+    ev.data.u32 = GW_LOOP_TAG_TRACKERS;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, tracker_fd, &ev) < 0) {
+        LOG_ERROR_GW("[EventLoop] No se pudo registrar el temporizador de trackers: %s", strerror(errno));
+        goto cleanup;
+    }
+    uint64_t armed_tracker_deadline = 0;
+
+    for (size_t i = 0; i < num_loop_watches; ++i) {
+        ev.data.u32 = GW_LOOP_TAG_WATCH_BASE + (uint32_t)i;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, loop_watches[i].fd, &ev) < 0) {
+            LOG_ERROR_GW("[EventLoop] No se pudo vigilar el descriptor %d: %s", loop_watches[i].fd, strerror(errno));
+            goto cleanup;
+        }
+    }
+
+    LOG_INFO_GW("[EventLoop] Bucle de eventos epoll activo (%zu temporizadores).", num_timers);
+
+    struct epoll_event events[GW_LOOP_MAX_EVENTS];
+    while (!*quit_flag) {
+        // Los callbacks pueden haber reservado o liberado trackers y
+        // programado o consumido eventos de los temporizadores de un disparo
+        rearm_tracker_timer(tracker_fd, &armed_tracker_deadline);
+        for (size_t i = 0; i < num_timers; ++i) {
+            if (timers[i].next_deadline) {
+                rearm_deadline_timer(timer_fds[i], &timers[i], &armed_deadline_ns[i]);
+            }
+        }
+
+        // Atiende retransmisiones vencidas y devuelve el próximo timeout de libcoap
+        coap_tick_t coap_now;
+        coap_ticks(&coap_now);
+        unsigned int coap_timeout_ms = coap_io_prepare_epoll(ctx, coap_now);
+
+        int nfds = epoll_wait(epoll_fd, events, GW_LOOP_MAX_EVENTS,
+                              coap_timeout_ms == 0 ? -1 : (int)coap_timeout_ms);
+        if (nfds < 0) {
+            if (errno == EINTR) continue; // SIGINT: se revisa quit_flag
+            LOG_ERROR_GW("[EventLoop] epoll_wait falló: %s", strerror(errno));
+            goto cleanup;
+        }
+
+        for (int i = 0; i < nfds && !*quit_flag; ++i) {
+            uint32_t tag = events[i].data.u32;
+            if (tag == GW_LOOP_TAG_COAP) {
+                coap_io_process(ctx, COAP_IO_NO_WAIT);
+            } else if (tag == GW_LOOP_TAG_TRACKERS) {
+                drain_timerfd(tracker_fd);
+                armed_tracker_deadline = 0;
+                gw_tracker_expire(gw_tracker_now_ms(), hnd_tracker_timeout_gw);
+            } else if (tag >= GW_LOOP_TAG_WATCH_BASE && tag - GW_LOOP_TAG_WATCH_BASE < num_loop_watches) {
+                const gw_loop_watch_t *w = &loop_watches[tag - GW_LOOP_TAG_WATCH_BASE];
+                w->on_readable(w->fd, w->arg);
+            } else if (tag < num_timers && timers[tag].next_deadline) {
+                drain_timerfd(timer_fds[tag]);
+                armed_deadline_ns[tag] = 0;
+                timers[tag].callback(timers[tag].arg);
+            } else if (tag < num_timers) {
+                uint64_t expirations = drain_timerfd(timer_fds[tag]);
+                if (expirations > GW_LOOP_MAX_CATCHUP) {
+                    LOG_WARN_GW("[EventLoop] Temporizador '%s' atrasado %llu periodos; se recuperan %d.",
+                                timers[tag].name ? timers[tag].name : "?",
+                                (unsigned long long)expirations, GW_LOOP_MAX_CATCHUP);
+                    expirations = GW_LOOP_MAX_CATCHUP;
+                }
+                for (uint64_t n = 0; n < expirations; ++n) {
+                    timers[tag].callback(timers[tag].arg);
+                }
+            }
+        }
+        run_flush_hook();
+    }
+    result = 0;
+
+cleanup:
+    if (tracker_fd >= 0) close(tracker_fd);
+    for (size_t i = 0; i < created; ++i) {
+        close(timer_fds[i]);
+    }
+    close(epoll_fd);
+    return result;
+}
@@ -0,0 +1,893 @@
+/**
+ * @file exec_log_format.c
+ * @brief Escritura y lectura de los formatos del registro de ejecuciones
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * El Markdown es el reporte de siempre; el JSONL usa nombres de campo
+ * propios de cada tipo de evento (tabla event_fields()) para que se pueda
+ * consultar con herramientas como jq, y el lector los traduce de vuelta al
+ * mismo exec_log_record_t que escribe el gateway.
+ *
+ * @see exec_log_format.h
+ */
+
+// Para strnlen, getline, strcasecmp y localtime_r
+#define _POSIX_C_SOURCE 200809L
+
+#include "api_gateway/exec_log_format.h"
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <cjson/cJSON.h>
+
+// ============================================================================
+// ETAPAS DE LATENCIA
+// ============================================================================
+
+/**
+ * @brief Clave JSONL y etiqueta del reporte de cada gw_span_stage_t
+ */
+static const struct {
+    const char *key;
+    const char *label;
+} STAGES[GW_SPAN_STAGE_COUNT] = {
+    [GW_SPAN_STAGE_ENCODE]   = { "codificacion", "CAN RX → JSON" },
+    [GW_SPAN_STAGE_SEND]     = { "envio",        "JSON → CoAP TX" },
+    [GW_SPAN_STAGE_SERVER]   = { "servidor",     "CoAP TX → CoAP RX (servidor)" },
+    [GW_SPAN_STAGE_RESPONSE] = { "respuesta",    "CoAP RX → CAN TX" },
+    [GW_SPAN_STAGE_TOTAL]    = { "total",        "CAN RX → CAN TX (total)" },
+};
+
+const char *exec_log_stage_label(gw_span_stage_t stage) {
+    return (stage >= 0 && stage < GW_SPAN_STAGE_COUNT) ? STAGES[stage].label : "N/A";
+}
+
+// ============================================================================
+// CAMPOS DE CADA TIPO DE EVENTO
+// ============================================================================
+
+/**
+ * @brief Nombres de las cadenas y enteros de un tipo de evento en JSONL
+ */
+typedef struct {
+    int string_count;                             ///< Cadenas empaquetadas
+    const char *strings[EXEC_LOG_MAX_STRINGS];    ///< Nombre de cada cadena
+    int int_count;                                ///< Enteros de args usados
+    const char *ints[3];                          ///< Nombre de cada entero
+} exec_log_fields_t;
+
+static const exec_log_fields_t FIELDS_GENERIC        = { 2, { "descripcion", "detalles" }, 0, { NULL } };
+static const exec_log_fields_t FIELDS_SIM_START      = { 1, { "edificio" }, 1, { "peticiones" } };
+static const exec_log_fields_t FIELDS_SIM_END        = { 0, { NULL }, 2, { "exitosas", "total" } };
+static const exec_log_fields_t FIELDS_CAN            = { 1, { "descripcion" }, 1, { "dlc" } };
+static const exec_log_fields_t FIELDS_COAP_SENT      = { 3, { "metodo", "uri", "payload" }, 0, { NULL } };
+// El código ("codigo") va en args[0] y se escribe como "2.01" (ver coap_code_*)
+static const exec_log_fields_t FIELDS_COAP_RECEIVED  = { 1, { "payload" }, 0, { NULL } };
+static const exec_log_fields_t FIELDS_TASK_ASSIGNED  = { 2, { "tarea", "ascensor" }, 1, { "piso_destino" } };
+static const exec_log_fields_t FIELDS_ELEVATOR_MOVED = { 2, { "ascensor", "direccion" }, 2, { "desde", "hacia" } };
+static const exec_log_fields_t FIELDS_TASK_COMPLETED = { 2, { "tarea", "ascensor" }, 1, { "piso_final" } };
+static const exec_log_fields_t FIELDS_ERROR          = { 2, { "codigo", "mensaje" }, 0, { NULL } };
+
+/**
+ * @brief Campos de un evento, o NULL si el tipo no tiene forma propia
+ */
+static const exec_log_fields_t *event_fields(log_event_type_t type, bool generic) {
+    if (generic) return &FIELDS_GENERIC;
+    switch (type) {
+        case LOG_EVENT_SIMULATION_START: return &FIELDS_SIM_START;
+        case LOG_EVENT_SIMULATION_END:   return &FIELDS_SIM_END;
+        case LOG_EVENT_CAN_SENT:
+        case LOG_EVENT_CAN_RECEIVED:     return &FIELDS_CAN;
+        case LOG_EVENT_COAP_SENT:        return &FIELDS_COAP_SENT;
+        case LOG_EVENT_COAP_RECEIVED:    return &FIELDS_COAP_RECEIVED;
+        case LOG_EVENT_TASK_ASSIGNED:    return &FIELDS_TASK_ASSIGNED;
+        case LOG_EVENT_ELEVATOR_MOVED:   return &FIELDS_ELEVATOR_MOVED;
+        case LOG_EVENT_TASK_COMPLETED:   return &FIELDS_TASK_COMPLETED;
+        case LOG_EVENT_ERROR:            return &FIELDS_ERROR;
+        default:                         return NULL;
+    }
+}
+
+// ============================================================================
+// UTILIDADES
+// ============================================================================
+
+bool exec_log_format_from_name(const char *name, exec_log_format_t *format) {
+    if (!name || !format) return false;
+    if (strcasecmp(name, "markdown") == 0 || strcasecmp(name, "md") == 0) {
+        *format = EXEC_LOG_FORMAT_MARKDOWN;
+    } else if (strcasecmp(name, "jsonl") == 0) {
+        *format = EXEC_LOG_FORMAT_JSONL;
+    } else if (strcasecmp(name, "binary") == 0 || strcasecmp(name, "bin") == 0) {
+        *format = EXEC_LOG_FORMAT_BINARY;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char *exec_log_format_extension(exec_log_format_t format) {
+    switch (format) {
+        case EXEC_LOG_FORMAT_JSONL:  return "jsonl";
+        case EXEC_LOG_FORMAT_BINARY: return "bin";
+        default:                     return "md";
+    }
+}
+
+/**
+ * @brief Convierte el tipo de evento a etiqueta de texto profesional
+ */
+const char *exec_log_event_label(log_event_type_t type) {
+    switch (type) {
+        case LOG_EVENT_SYSTEM_START:     return "INICIO";
+        case LOG_EVENT_SYSTEM_END:       return "FIN";
+        case LOG_EVENT_SIMULATION_START: return "SIM-INICIO";
+        case LOG_EVENT_SIMULATION_END:   return "SIM-FIN";
+        case LOG_EVENT_BUILDING_SELECTED:return "EDIFICIO";
+        case LOG_EVENT_CAN_SENT:         return "CAN-TX";
+        case LOG_EVENT_CAN_RECEIVED:     return "CAN-RX";
+        case LOG_EVENT_COAP_SENT:        return "COAP-TX";
+        case LOG_EVENT_COAP_RECEIVED:    return "COAP-RX";
+        case LOG_EVENT_TASK_ASSIGNED:    return "TAREA-ASIG";
+        case LOG_EVENT_ELEVATOR_MOVED:   return "ASCENSOR-MOV";
+        case LOG_EVENT_TASK_COMPLETED:   return "TAREA-COMP";
+        case LOG_EVENT_ERROR:            return "ERROR";
+        default:                         return "INFO";
+    }
+}
+
+/**
+ * @brief Tipo de evento a partir de su etiqueta
+ * @return true si la etiqueta es conocida
+ */
+static bool event_type_from_label(const char *label, log_event_type_t *type) {
+    for (int t = LOG_EVENT_SYSTEM_START; t <= LOG_EVENT_ERROR; t++) {
+        if (strcmp(label, exec_log_event_label((log_event_type_t)t)) == 0) {
+            *type = (log_event_type_t)t;
+            return true;
+        }
+    }
+    return false;
+}
+
+void exec_log_pack_strings(exec_log_record_t *rec, const char *const *strings, int count) {
+    size_t used = 0;
+    for (int i = 0; i < count; i++) {
+        const char *s = strings[i] ? strings[i] : "N/A";
+        // Dejar sitio para el terminador de esta cadena y de las siguientes
+        size_t room = EXEC_LOG_TEXT_SIZE - used - (size_t)(count - i);
+        size_t len = strnlen(s, room + 1);
+        if (len > room) {
+            len = room;
+            rec->truncated |= (uint8_t)(1u << i);
+        }
+        memcpy(rec->text + used, s, len);
+        rec->text[used + len] = '\0';
+        used += len + 1;
+    }
+}
+
+void exec_log_unpack_strings(const exec_log_record_t *rec, const char **strings, int count) {
+    const char *p = rec->text;
+    const char *end = rec->text + EXEC_LOG_TEXT_SIZE;
+    for (int i = 0; i < count; i++) {
+        // Un registro leído de disco puede venir sin terminadores
+        size_t len = p < end ? strnlen(p, (size_t)(end - p)) : 0;
+        strings[i] = (p < end && len < (size_t)(end - p)) ? p : "";
+        p += len + 1;
+    }
+}
+
+/**
+ * @brief Formatea un código CoAP sin formatear (clase << 5 | detalle) como "2.01"
+ */
+static void coap_code_format(char *buffer, size_t size, int code) {
+    snprintf(buffer, size, "%u.%02u", ((unsigned int)code >> 5) & 0x7u, (unsigned int)code & 0x1Fu);
+}
+
+/**
+ * @brief Interpreta un código CoAP "2.01" (0 si no es válido)
+ */
+static int coap_code_parse(const char *text) {
+    unsigned int code_class, detail;
+    if (!text || sscanf(text, "%u.%u", &code_class, &detail) != 2 || code_class > 7 || detail > 31) {
+        return 0;
+    }
+    return (int)((code_class << 5) | detail);
+}
+
+/**
+ * @brief Marca que se añade a una cadena recortada al escribirla
+ */
+static const char *truncation_mark(const exec_log_record_t *rec, int index) {
+    return (rec->truncated & (1u << index)) ? " [...]" : "";
+}
+
+/**
+ * @brief Formatea un instante de pared con el formato dado de strftime
+ */
+static void format_wall_time(char *buffer, size_t size, const char *format, time_t when) {
+    struct tm tm_info;
+    localtime_r(&when, &tm_info);
+    strftime(buffer, size, format, &tm_info);
+}
+
+/**
+ * @brief Escribe una cadena JSON con las secuencias de escape necesarias
+ */
+static void write_json_string(FILE *out, const char *s) {
+    fputc('"', out);
+    for (const unsigned char *p = (const unsigned char *)s; *p; p++) {
+        switch (*p) {
+            case '"':  fputs("\\\"", out); break;
+            case '\\': fputs("\\\\", out); break;
+            case '\n': fputs("\\n", out); break;
+            case '\r': fputs("\\r", out); break;
+            case '\t': fputs("\\t", out); break;
+            default:
+                if (*p < 0x20) {
+                    fprintf(out, "\\u%04x", *p);
+                } else {
+                    fputc(*p, out);
+                }
+        }
+    }
+    fputc('"', out);
+}
+
+// ============================================================================
+// MARKDOWN
+// ============================================================================
+
+/**
+ * @brief Escribe el header del archivo Markdown
+ */
+static void write_markdown_header(FILE *log_file, const struct timespec *start) {
+    char timestamp[64];
+    format_wall_time(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", start->tv_sec);
+
+    fprintf(log_file, "---\n");
+    fprintf(log_file, "title: \"Reporte de Ejecución - API Gateway\"\n");
+    fprintf(log_file, "subtitle: \"Sistema de Control de Ascensores\"\n");
+    fprintf(log_file, "author: \"API Gateway v2.0\"\n");
+    fprintf(log_file, "date: \"%s\"\n", timestamp);
+    fprintf(log_file, "geometry: margin=2cm\n");
+    fprintf(log_file, "fontsize: 11pt\n");
+    fprintf(log_file, "documentclass: article\n");
+    fprintf(log_file, "header-includes:\n");
+    fprintf(log_file, "  - \\usepackage{fancyhdr}\n");
+    fprintf(log_file, "  - \\usepackage{graphicx}\n");
+    fprintf(log_file, "  - \\pagestyle{fancy}\n");
+    fprintf(log_file, "  - \\fancyhf{}\n");
+    fprintf(log_file, "  - \\rhead{API Gateway - Sistema de Ascensores}\n");
+    fprintf(log_file, "  - \\lfoot{%s}\n", timestamp);
+    fprintf(log_file, "  - \\rfoot{\\thepage}\n");
+    fprintf(log_file, "---\n\n");
+
+    fprintf(log_file, "\\newpage\n\n");
+
+    fprintf(log_file, "# Resumen Ejecutivo\n\n");
+    fprintf(log_file, "Este documento presenta el registro detallado de la ejecución del API Gateway ");
+    fprintf(log_file, "del Sistema de Control de Ascensores. El sistema actúa como intermediario entre ");
+    fprintf(log_file, "los controladores CAN de ascensores y el servidor central, proporcionando ");
+    fprintf(log_file, "comunicación segura mediante CoAP sobre DTLS-PSK.\n\n");
+
+    fprintf(log_file, "## Información del Sistema\n\n");
+    fprintf(log_file, "| **Parámetro** | **Valor** |\n");
+    fprintf(log_file, "|:--------------|:----------|\n");
+    fprintf(log_file, "| **Fecha de Ejecución** | %s |\n", timestamp);
+    fprintf(log_file, "| **Versión del Sistema** | 2.0 |\n");
+    fprintf(log_file, "| **Estado Inicial** | EN EJECUCION |\n");
+    fprintf(log_file, "| **Edificio Simulado** | *Pendiente de asignación* |\n");
+    fprintf(log_file, "| **Peticiones Programadas** | *Pendiente de configuración* |\n\n");
+
+    fprintf(log_file, "## Configuración Técnica\n\n");
+    fprintf(log_file, "### Protocolos de Comunicación\n\n");
+    fprintf(log_file, "- **Protocolo Principal:** CoAP (Constrained Application Protocol)\n");
+    fprintf(log_file, "- **Seguridad:** DTLS (Datagram Transport Layer Security)\n");
+    fprintf(log_file, "- **Transporte:** UDP (User Datagram Protocol)\n");
+    fprintf(log_file, "- **Puerto de Escucha:** 5683 (Puerto estándar CoAP)\n");
+    fprintf(log_file, "- **Servidor Central:** 192.168.49.2:30084 (Minikube Cluster)\n\n");
+
+    fprintf(log_file, "### Componentes del Sistema\n\n");
+    fprintf(log_file, "- **Simulador CAN:** Integrado para testing\n");
+    fprintf(log_file, "- **Gestor de Estado:** Mantenimiento del estado de ascensores\n");
+    fprintf(log_file, "- **Puente CAN-CoAP:** Transformación de mensajes\n");
+    fprintf(log_file, "- **Formato de Datos:** JSON para payloads\n");
+    fprintf(log_file, "- **Logging:** Sistema de registro de eventos en tiempo real\n\n");
+
+    fprintf(log_file, "\\newpage\n\n");
+    fprintf(log_file, "# Registro de Eventos\n\n");
+    fprintf(log_file, "La siguiente sección presenta el flujo cronológico de eventos durante la ejecución del sistema.\n\n");
+}
+
+/**
+ * @brief Escribe el footer del archivo Markdown con estadísticas finales
+ */
+static void write_markdown_footer(FILE *log_file, const execution_stats_t *stats, const struct timespec *end) {
+    char timestamp[64];
+    format_wall_time(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", end->tv_sec);
+
+    fprintf(log_file, "\n\\newpage\n\n");
+    fprintf(log_file, "# Estadísticas Finales de Ejecución\n\n");
+
+    fprintf(log_file, "## Resumen de Comunicaciones\n\n");
+    fprintf(log_file, "### Tráfico de Red\n\n");
+    fprintf(log_file, "| **Protocolo** | **Enviados** | **Recibidos** | **Total** |\n");
+    fprintf(log_file, "|:--------------|:-------------|:--------------|:----------|\n");
+    fprintf(log_file, "| **Frames CAN** | %d | %d | %d |\n",
+             stats->total_can_frames_sent, stats->total_can_frames_received,
+             stats->total_can_frames_sent + stats->total_can_frames_received);
+    fprintf(log_file, "| **Mensajes CoAP** | %d | %d | %d |\n\n",
+             stats->total_coap_requests, stats->total_coap_responses,
+             stats->total_coap_requests + stats->total_coap_responses);
+
+    fprintf(log_file, "## Gestión de Ascensores\n\n");
+    fprintf(log_file, "### Operaciones de Control\n\n");
+    fprintf(log_file, "| **Métrica** | **Cantidad** | **Porcentaje** |\n");
+    fprintf(log_file, "|:------------|:-------------|:---------------|\n");
+    fprintf(log_file, "| **Tareas Asignadas** | %d | 100%% |\n", stats->total_tasks_assigned);
+
+    if (stats->total_tasks_assigned > 0) {
+        double completion_rate = (100.0 * stats->total_tasks_completed) / stats->total_tasks_assigned;
+        fprintf(log_file, "| **Tareas Completadas** | %d | %.1f%% |\n", stats->total_tasks_completed, completion_rate);
+    } else {
+        fprintf(log_file, "| **Tareas Completadas** | %d | N/A |\n", stats->total_tasks_completed);
+    }
+
+    fprintf(log_file, "| **Movimientos de Ascensores** | %d | N/A |\n", stats->total_elevator_movements);
+    fprintf(log_file, "| **Errores Detectados** | %d | N/A |\n", stats->total_errors);
+    if (stats->dropped_events > 0) {
+        // Eventos que no se escribieron porque la cola estaba llena (sí cuentan arriba)
+        fprintf(log_file, "| **Eventos no Registrados** | %d | N/A |\n", stats->dropped_events);
+    }
+    if (stats->requests_timed_out > 0) {
+        fprintf(log_file, "| **Solicitudes Expiradas** | %d | N/A |\n", stats->requests_timed_out);
+    }
+    if (stats->requests_answered_locally > 0) {
+        // Pulsaciones repetidas atendidas sin el servidor central (fuera de la tabla de latencias)
+        fprintf(log_file, "| **Respondidas Localmente** | %d | N/A |\n", stats->requests_answered_locally);
+    }
+    fprintf(log_file, "\n");
+
+    fprintf(log_file, "## Análisis de Rendimiento\n\n");
+    fprintf(log_file, "### Métricas Temporales\n\n");
+    fprintf(log_file, "| **Parámetro** | **Valor** | **Unidad** |\n");
+    fprintf(log_file, "|:--------------|:----------|:-----------|\n");
+    fprintf(log_file, "| **Duración Total** | %.2f | segundos |\n", stats->execution_duration_sec);
+    fprintf(log_file, "| **Edificio Simulado** | %s | ID |\n", stats->building_id[0] ? stats->building_id : "N/A");
+    fprintf(log_file, "| **Peticiones del Edificio** | %d | cantidad |\n", stats->building_requests);
+
+    if (stats->building_requests > 0) {
+        // Duración / peticiones refleja el ritmo al que se envía el escenario, no la
+        // capacidad del sistema: los indicadores por pasajero los da gw_headless_sim
+        double avg_time = stats->execution_duration_sec / stats->building_requests;
+        fprintf(log_file, "| **Intervalo Medio entre Peticiones** | %.3f | segundos |\n", avg_time);
+    }
+
+    if (stats->stage_latency[GW_SPAN_STAGE_TOTAL].samples > 0) {
+        fprintf(log_file, "\n### Latencia por Etapa\n\n");
+        fprintf(log_file, "Solicitudes de origen CAN con respuesta del servidor central, medidas con reloj monotónico.\n\n");
+        fprintf(log_file, "| **Etapa** | **Muestras** | **Media (ms)** | **p50 (ms)** | **p90 (ms)** | **p99 (ms)** | **Máx (ms)** |\n");
+        fprintf(log_file, "|:----------|:-------------|:--------------|:-------------|:-------------|:-------------|:-------------|\n");
+        for (int i = 0; i < GW_SPAN_STAGE_COUNT; i++) {
+            const exec_stage_latency_t *lat = &stats->stage_latency[i];
+            fprintf(log_file, "| **%s** | %u | %.3f | %.3f | %.3f | %.3f | %.3f |\n",
+                    STAGES[i].label, lat->samples, lat->mean_us / 1000.0, lat->p50_us / 1000.0,
+                    lat->p90_us / 1000.0, lat->p99_us / 1000.0, lat->max_us / 1000.0);
+        }
+        // Lo que añade el gateway a cada llamada, sin la ida y vuelta al servidor
+        const exec_stage_latency_t *total = &stats->stage_latency[GW_SPAN_STAGE_TOTAL];
+        const exec_stage_latency_t *server = &stats->stage_latency[GW_SPAN_STAGE_SERVER];
+        if (server->samples > 0 && total->mean_us >= server->mean_us) {
+            fprintf(log_file, "\nContribución media del gateway: %.3f ms por solicitud.\n",
+                    (total->mean_us - server->mean_us) / 1000.0);
+        }
+    }
+
+    fprintf(log_file, "\n### Eficiencia del Sistema\n\n");
+    if (stats->total_errors == 0) {
+        fprintf(log_file, "**ESTADO: EJECUCION EXITOSA**\n\n");
+        fprintf(log_file, "- Sin errores detectados durante la ejecución\n");
+        fprintf(log_file, "- Todas las comunicaciones funcionaron correctamente\n");
+        fprintf(log_file, "- Sistema de simulación operativo y estable\n");
+        fprintf(log_file, "- Protocolo DTLS establecido correctamente\n");
+    } else {
+        fprintf(log_file, "**ESTADO: EJECUCION CON ADVERTENCIAS**\n\n");
+        fprintf(log_file, "- **%d errores** detectados durante la ejecución\n", stats->total_errors);
+        fprintf(log_file, "- Revisar la sección de eventos para análisis detallado\n");
+        fprintf(log_file, "- Verificar configuración de red y protocolos\n");
+    }
+
+    fprintf(log_file, "\n## Conclusiones\n\n");
+    fprintf(log_file, "Este reporte documenta la ejecución completa del API Gateway del Sistema de ");
+    fprintf(log_file, "Control de Ascensores. Los datos presentados permiten evaluar el rendimiento ");
+    fprintf(log_file, "del sistema y identificar áreas de mejora en futuras iteraciones.\n\n");
+
+    fprintf(log_file, "---\n\n");
+    fprintf(log_file, "**Reporte generado automáticamente**  \n");
+    fprintf(log_file, "Sistema de Control de Ascensores - API Gateway v2.0  \n");
+    fprintf(log_file, "Finalizado: %s\n", timestamp);
+}
+
+/**
+ * @brief Escribe un evento con el formato Markdown del reporte
+ */
+static void write_markdown_event(FILE *log_file, const exec_log_record_t *rec, const struct timespec *start) {
+    const char *s[EXEC_LOG_MAX_STRINGS] = { NULL };
+    const char *description = NULL;
+    char details[MAX_LOG_MESSAGE];
+    details[0] = '\0';
+
+    if (rec->generic) {
+        exec_log_unpack_strings(rec, s, 2);
+        description = s[0];
+        if (s[1][0] != '\0') {
+            snprintf(details, sizeof(details), "%s%s", s[1], truncation_mark(rec, 1));
+        }
+    } else {
+        switch ((log_event_type_t)rec->type) {
+            case LOG_EVENT_SIMULATION_START:
+                exec_log_unpack_strings(rec, s, 1);
+                description = "Iniciando simulación de ascensores";
+                snprintf(details, sizeof(details), "Edificio: %s\nPeticiones a ejecutar: %d",
+                         s[0], rec->args[0]);
+                break;
+
+            case LOG_EVENT_SIMULATION_END:
+                description = "Simulación completada";
+                snprintf(details, sizeof(details), "Peticiones exitosas: %d/%d\nTasa de éxito: %.1f%%",
+                         rec->args[0], rec->args[1],
+                         rec->args[1] > 0 ? (100.0 * rec->args[0] / rec->args[1]) : 0.0);
+                break;
+
+            case LOG_EVENT_CAN_SENT:
+            case LOG_EVENT_CAN_RECEIVED: {
+                exec_log_unpack_strings(rec, s, 1);
+                description = rec->type == LOG_EVENT_CAN_SENT ? "Frame CAN enviado" : "Frame CAN recibido";
+                char data_str[3 * sizeof(rec->data) + 1] = "";
+                for (int i = 0; i < rec->args[1] && i < (int)sizeof(rec->data); i++) {
+                    snprintf(data_str + 3 * i, sizeof(data_str) - 3 * (size_t)i, "%02X ", rec->data[i]);
+                }
+                snprintf(details, sizeof(details), "CAN ID: 0x%X\nDLC: %d\nDatos: %s\nDescripción: %s%s",
+                         rec->can_id, rec->args[0], data_str, s[0], truncation_mark(rec, 0));
+                break;
+            }
+
+            case LOG_EVENT_COAP_SENT:
+                exec_log_unpack_strings(rec, s, 3);
+                description = "Petición CoAP enviada";
+                snprintf(details, sizeof(details), "Método: %s\nURI: %s%s\nPayload: %s%s",
+                         s[0], s[1], truncation_mark(rec, 1), s[2], truncation_mark(rec, 2));
+                break;
+
+            case LOG_EVENT_COAP_RECEIVED: {
+                exec_log_unpack_strings(rec, s, 1);
+                description = "Respuesta CoAP recibida";
+                char code[8];
+                coap_code_format(code, sizeof(code), rec->args[0]);
+                snprintf(details, sizeof(details), "Código: %s\nPayload: %s%s",
+                         code, s[0], truncation_mark(rec, 0));
+                break;
+            }
+
+            case LOG_EVENT_TASK_ASSIGNED:
+                exec_log_unpack_strings(rec, s, 2);
+                description = "Tarea asignada a ascensor";
+                snprintf(details, sizeof(details), "Tarea: %s\nAscensor: %s\nPiso destino: %d",
+                         s[0], s[1], rec->args[0]);
+                break;
+
+            case LOG_EVENT_ELEVATOR_MOVED:
+                exec_log_unpack_strings(rec, s, 2);
+                description = "Ascensor en movimiento";
+                snprintf(details, sizeof(details), "Ascensor: %s\nDesde piso: %d\nHacia piso: %d\nDirección: %s",
+                         s[0], rec->args[0], rec->args[1], s[1]);
+                break;
+
+            case LOG_EVENT_TASK_COMPLETED:
+                exec_log_unpack_strings(rec, s, 2);
+                description = "Tarea completada";
+                snprintf(details, sizeof(details), "Tarea: %s\nAscensor: %s\nPiso final: %d",
+                         s[0], s[1], rec->args[0]);
+                break;
+
+            case LOG_EVENT_ERROR:
+                exec_log_unpack_strings(rec, s, 2);
+                description = "Error del sistema";
+                snprintf(details, sizeof(details), "Código: %s\nMensaje: %s%s",
+                         s[0], s[1], truncation_mark(rec, 1));
+                break;
+
+            default:
+                return;
+        }
+    }
+
+    // Instante de pared: inicio del registro más el desplazamiento monotónico
+    uint64_t wall_ns = (uint64_t)start->tv_nsec + rec->time_ns;
+    time_t wall_sec = start->tv_sec + (time_t)(wall_ns / 1000000000ULL);
+    char hms[16];
+    format_wall_time(hms, sizeof(hms), "%H:%M:%S", wall_sec);
+
+    // Formato profesional para eventos
+    fprintf(log_file, "## Evento: %s\n\n", exec_log_event_label((log_event_type_t)rec->type));
+    fprintf(log_file, "**Timestamp:** %s.%03d  \n", hms, (int)((wall_ns % 1000000000ULL) / 1000000ULL));
+    fprintf(log_file, "**Descripción:** %s  \n", description);
+
+    if (details[0] != '\0') {
+        fprintf(log_file, "**Detalles:**\n\n");
+        fprintf(log_file, "```\n%s\n```\n", details);
+    }
+
+    fprintf(log_file, "\n---\n\n");
+}
+
+// ============================================================================
+// JSONL
+// ============================================================================
+
+/**
+ * @brief Escribe un evento como una línea JSON
+ */
+static void write_jsonl_event(FILE *out, const exec_log_record_t *rec) {
+    const exec_log_fields_t *fields = event_fields((log_event_type_t)rec->type, rec->generic);
+    if (!fields) return;
+
+    const char *s[EXEC_LOG_MAX_STRINGS] = { NULL };
+    exec_log_unpack_strings(rec, s, fields->string_count);
+
+    fprintf(out, "{\"t_ns\":%llu,\"evento\":\"%s\"", (unsigned long long)rec->time_ns,
+            exec_log_event_label((log_event_type_t)rec->type));
+    if (rec->generic) {
+        fputs(",\"generico\":true", out);
+    }
+    if (!rec->generic && (rec->type == LOG_EVENT_CAN_SENT || rec->type == LOG_EVENT_CAN_RECEIVED)) {
+        fprintf(out, ",\"can_id\":%u,\"datos\":\"", rec->can_id);
+        for (int i = 0; i < rec->args[1] && i < (int)sizeof(rec->data); i++) {
+            fprintf(out, "%02X", rec->data[i]);
+        }
+        fputc('"', out);
+    }
+    if (!rec->generic && rec->type == LOG_EVENT_COAP_RECEIVED) {
+        char code[8];
+        coap_code_format(code, sizeof(code), rec->args[0]);
+        fprintf(out, ",\"codigo\":\"%s\"", code);
+    }
+    for (int i = 0; i < fields->int_count; i++) {
+        fprintf(out, ",\"%s\":%d", fields->ints[i], rec->args[i]);
+    }
+    for (int i = 0; i < fields->string_count; i++) {
+        fprintf(out, ",\"%s\":", fields->strings[i]);
+        write_json_string(out, s[i]);
+    }
+    if (rec->truncated) {
+        // Nombres de los campos recortados al encolar
+        fputs(",\"recortado\":[", out);
+        bool first = true;
+        for (int i = 0; i < fields->string_count; i++) {
+            if (rec->truncated & (1u << i)) {
+                fprintf(out, "%s\"%s\"", first ? "" : ",", fields->strings[i]);
+                first = false;
+            }
+        }
+        fputc(']', out);
+    }
+    fputs("}\n", out);
+}
+
+/**
+ * @brief Escribe la línea final con las estadísticas
+ */
+static void write_jsonl_summary(FILE *out, const execution_stats_t *stats) {
+    fprintf(out, "{\"resumen\":{\"can_enviados\":%d,\"can_recibidos\":%d,"
+                 "\"coap_peticiones\":%d,\"coap_respuestas\":%d,"
+                 "\"tareas_asignadas\":%d,\"tareas_completadas\":%d,"
+                 "\"movimientos\":%d,\"errores\":%d,\"descartados\":%d,"
+                 "\"expiradas\":%d,\"respondidas_localmente\":%d,"
+                 "\"duracion_s\":%.3f,\"peticiones_edificio\":%d,\"edificio\":",
+            stats->total_can_frames_sent, stats->total_can_frames_received,
+            stats->total_coap_requests, stats->total_coap_responses,
+            stats->total_tasks_assigned, stats->total_tasks_completed,
+            stats->total_elevator_movements, stats->total_errors, stats->dropped_events,
+            stats->requests_timed_out, stats->requests_answered_locally,
+            stats->execution_duration_sec, stats->building_requests);
+    write_json_string(out, stats->building_id);
+    fputs(",\"latencias\":{", out);
+    bool first = true;
+    for (int i = 0; i < GW_SPAN_STAGE_COUNT; i++) {
+        const exec_stage_latency_t *lat = &stats->stage_latency[i];
+        if (lat->samples == 0) continue;
+        fprintf(out, "%s\"%s\":{\"muestras\":%u,\"media_us\":%u,\"p50_us\":%u,"
+                     "\"p90_us\":%u,\"p99_us\":%u,\"max_us\":%u}",
+                first ? "" : ",", STAGES[i].key, lat->samples, lat->mean_us,
+                lat->p50_us, lat->p90_us, lat->p99_us, lat->max_us);
+        first = false;
+    }
+    fputs("}}}\n", out);
+}
+
+// ============================================================================
+// ESCRITURA
+// ============================================================================
+
+void exec_log_write_header(FILE *out, exec_log_format_t format, const struct timespec *start) {
+    if (!out || !start) return;
+    switch (format) {
+        case EXEC_LOG_FORMAT_JSONL:
+            fprintf(out, "{\"formato\":\"gw_exec_log\",\"version\":%d,\"inicio_s\":%lld,\"inicio_ns\":%ld}\n",
+                    EXEC_LOG_FORMAT_VERSION, (long long)start->tv_sec, (long)start->tv_nsec);
+            break;
+        case EXEC_LOG_FORMAT_BINARY: {
+            exec_log_bin_header_t header;
+            memset(&header, 0, sizeof(header));
+            header.magic = EXEC_LOG_BIN_MAGIC;
+            header.version = EXEC_LOG_FORMAT_VERSION;
+            header.record_size = (uint16_t)sizeof(exec_log_record_t);
+            header.start_sec = (int64_t)start->tv_sec;
+            header.start_nsec = (int64_t)start->tv_nsec;
+            fwrite(&header, sizeof(header), 1, out);
+            break;
+        }
+        default:
+            write_markdown_header(out, start);
+    }
+}
+
+void exec_log_write_event(FILE *out, exec_log_format_t format, const exec_log_record_t *rec,
+                          const struct timespec *start) {
+    if (!out || !rec) return;
+    switch (format) {
+        case EXEC_LOG_FORMAT_JSONL:
+            write_jsonl_event(out, rec);
+            break;
+        case EXEC_LOG_FORMAT_BINARY:
+            fwrite(rec, sizeof(*rec), 1, out);
+            break;
+        default:
+            if (start) write_markdown_event(out, rec, start);
+    }
+}
+
+void exec_log_write_footer(FILE *out, exec_log_format_t format, const execution_stats_t *stats,
+                           const struct timespec *end) {
+    if (!out || !stats) return;
+    switch (format) {
+        case EXEC_LOG_FORMAT_JSONL:
+            write_jsonl_summary(out, stats);
+            break;
+        case EXEC_LOG_FORMAT_BINARY: {
+            exec_log_record_t summary;
+            memset(&summary, 0, sizeof(summary));
+            summary.type = EXEC_LOG_SUMMARY_TYPE;
+            memcpy(summary.text, stats, sizeof(*stats));
+            fwrite(&summary, sizeof(summary), 1, out);
+            break;
+        }
+        default:
+            if (end) write_markdown_footer(out, stats, end);
+    }
+}
+
+// ============================================================================
+// LECTURA
+// ============================================================================
+
+int exec_log_reader_open(exec_log_reader_t *reader, const char *path) {
+    if (!reader || !path) return -1;
+    memset(reader, 0, sizeof(*reader));
+
+    FILE *file = fopen(path, "rb");
+    if (!file) return -1;
+    reader->file = file;
+
+    int first = fgetc(file);
+    if (first == '{') {
+        ungetc(first, file);
+        reader->format = EXEC_LOG_FORMAT_JSONL;
+        if (getline(&reader->line, &reader->line_capacity, file) < 0) {
+            exec_log_reader_close(reader);
+            return -1;
+        }
+        cJSON *header = cJSON_Parse(reader->line);
+        cJSON *version = cJSON_GetObjectItemCaseSensitive(header, "version");
+        cJSON *sec = cJSON_GetObjectItemCaseSensitive(header, "inicio_s");
+        cJSON *nsec = cJSON_GetObjectItemCaseSensitive(header, "inicio_ns");
+        bool valid = cJSON_IsNumber(version) && version->valueint == EXEC_LOG_FORMAT_VERSION &&
+                     cJSON_IsNumber(sec) && cJSON_IsNumber(nsec);
+        if (valid) {
+            reader->start.tv_sec = (time_t)sec->valuedouble;
+            reader->start.tv_nsec = (long)nsec->valuedouble;
+        }
+        cJSON_Delete(header);
+        if (!valid) {
+            exec_log_reader_close(reader);
+            return -1;
+        }
+        return 0;
+    }
+
+    ungetc(first, file);
+    reader->format = EXEC_LOG_FORMAT_BINARY;
+    exec_log_bin_header_t header;
+    if (fread(&header, sizeof(header), 1, file) != 1 ||
+        header.magic != EXEC_LOG_BIN_MAGIC ||
+        header.version != EXEC_LOG_FORMAT_VERSION ||
+        header.record_size != sizeof(exec_log_record_t)) {
+        exec_log_reader_close(reader);
+        return -1;
+    }
+    reader->start.tv_sec = (time_t)header.start_sec;
+    reader->start.tv_nsec = (long)header.start_nsec;
+    return 0;
+}
+
+/**
+ * @brief Entero de un objeto JSON, o el valor por defecto si falta
+ */
+static int json_int(const cJSON *object, const char *name, int fallback) {
+    const cJSON *item = cJSON_GetObjectItemCaseSensitive(object, name);
+    return cJSON_IsNumber(item) ? item->valueint : fallback;
+}
+
+/**
+ * @brief Entero sin signo de 32 bits de un objeto JSON (0 si falta)
+ *
+ * valueint se satura en INT_MAX, así que se parte de valuedouble.
+ */
+static uint32_t json_uint(const cJSON *object, const char *name) {
+    const cJSON *item = cJSON_GetObjectItemCaseSensitive(object, name);
+    if (!cJSON_IsNumber(item) || item->valuedouble < 0) return 0;
+    return item->valuedouble >= 4294967295.0 ? UINT32_MAX : (uint32_t)item->valuedouble;
+}
+
+/**
+ * @brief Lee la línea de resumen JSONL en reader->stats
+ */
+static void read_jsonl_summary(exec_log_reader_t *reader, const cJSON *summary) {
+    execution_stats_t *stats = &reader->stats;
+    memset(stats, 0, sizeof(*stats));
+    stats->total_can_frames_sent = json_int(summary, "can_enviados", 0);
+    stats->total_can_frames_received = json_int(summary, "can_recibidos", 0);
+    stats->total_coap_requests = json_int(summary, "coap_peticiones", 0);
+    stats->total_coap_responses = json_int(summary, "coap_respuestas", 0);
+    stats->total_tasks_assigned = json_int(summary, "tareas_asignadas", 0);
+    stats->total_tasks_completed = json_int(summary, "tareas_completadas", 0);
+    stats->total_elevator_movements = json_int(summary, "movimientos", 0);
+    stats->total_errors = json_int(summary, "errores", 0);
+    stats->dropped_events = json_int(summary, "descartados", 0);
+    stats->requests_timed_out = json_int(summary, "expiradas", 0);
+    stats->requests_answered_locally = json_int(summary, "respondidas_localmente", 0);
+    stats->building_requests = json_int(summary, "peticiones_edificio", 0);
+    const cJSON *duration = cJSON_GetObjectItemCaseSensitive(summary, "duracion_s");
+    stats->execution_duration_sec = cJSON_IsNumber(duration) ? duration->valuedouble : 0.0;
+    const cJSON *building = cJSON_GetObjectItemCaseSensitive(summary, "edificio");
+    if (cJSON_IsString(building) && building->valuestring) {
+        strncpy(stats->building_id, building->valuestring, sizeof(stats->building_id) - 1);
+    }
+    const cJSON *latencies = cJSON_GetObjectItemCaseSensitive(summary, "latencias");
+    for (int i = 0; i < GW_SPAN_STAGE_COUNT; i++) {
+        const cJSON *stage = cJSON_GetObjectItemCaseSensitive(latencies, STAGES[i].key);
+        exec_stage_latency_t *lat = &stats->stage_latency[i];
+        lat->samples = (uint32_t)json_uint(stage, "muestras");
+        lat->mean_us = (uint32_t)json_uint(stage, "media_us");
+        lat->p50_us = (uint32_t)json_uint(stage, "p50_us");
+        lat->p90_us = (uint32_t)json_uint(stage, "p90_us");
+        lat->p99_us = (uint32_t)json_uint(stage, "p99_us");
+        lat->max_us = (uint32_t)json_uint(stage, "max_us");
+    }
+    reader->has_summary = true;
+}
+
+/**
+ * @brief Reconstruye un evento a partir de su línea JSON
+ * @return true si la línea describe un evento válido
+ */
+static bool read_jsonl_event(const cJSON *line, exec_log_record_t *rec) {
+    const cJSON *label = cJSON_GetObjectItemCaseSensitive(line, "evento");
+    const cJSON *time_ns = cJSON_GetObjectItemCaseSensitive(line, "t_ns");
+    log_event_type_t type;
+    if (!cJSON_IsString(label) || !cJSON_IsNumber(time_ns) ||
+        !event_type_from_label(label->valuestring, &type)) {
+        return false;
+    }
+    bool generic = cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(line, "generico"));
+    const exec_log_fields_t *fields = event_fields(type, generic);
+    if (!fields) return false;
+
+    memset(rec, 0, sizeof(*rec));
+    rec->time_ns = (uint64_t)time_ns->valuedouble;
+    rec->type = (uint8_t)type;
+    rec->generic = generic ? 1 : 0;
+
+    for (int i = 0; i < fields->int_count; i++) {
+        rec->args[i] = json_int(line, fields->ints[i], 0);
+    }
+    if (!generic && (type == LOG_EVENT_CAN_SENT || type == LOG_EVENT_CAN_RECEIVED)) {
+        rec->can_id = (uint32_t)json_int(line, "can_id", 0);
+        const cJSON *data = cJSON_GetObjectItemCaseSensitive(line, "datos");
+        const char *hex = cJSON_IsString(data) ? data->valuestring : "";
+        int count = 0;
+        unsigned int byte;
+        while (count < (int)sizeof(rec->data) && hex[2 * count] && sscanf(hex + 2 * count, "%2x", &byte) == 1) {
+            rec->data[count++] = (uint8_t)byte;
+        }
+        rec->args[1] = count;
+    }
+    if (!generic && type == LOG_EVENT_COAP_RECEIVED) {
+        const cJSON *code = cJSON_GetObjectItemCaseSensitive(line, "codigo");
+        rec->args[0] = coap_code_parse(cJSON_IsString(code) ? code->valuestring : NULL);
+    }
+
+    const char *strings[EXEC_LOG_MAX_STRINGS] = { NULL };
+    for (int i = 0; i < fields->string_count; i++) {
+        const cJSON *item = cJSON_GetObjectItemCaseSensitive(line, fields->strings[i]);
+        strings[i] = cJSON_IsString(item) ? item->valuestring : NULL;
+    }
+    exec_log_pack_strings(rec, strings, fields->string_count);
+
+    const cJSON *truncated = cJSON_GetObjectItemCaseSensitive(line, "recortado");
+    const cJSON *name;
+    cJSON_ArrayForEach(name, truncated) {
+        for (int i = 0; i < fields->string_count; i++) {
+            if (cJSON_IsString(name) && strcmp(name->valuestring, fields->strings[i]) == 0) {
+                rec->truncated |= (uint8_t)(1u << i);
+            }
+        }
+    }
+    return true;
+}
+
+int exec_log_reader_next(exec_log_reader_t *reader, exec_log_record_t *rec) {
+    if (!reader || !reader->file || !rec) return -1;
+
+    if (reader->format == EXEC_LOG_FORMAT_BINARY) {
+        for (;;) {
+            size_t got = fread(rec, 1, sizeof(*rec), reader->file);
+            if (got == 0 && feof(reader->file)) return 0;
+            if (got != sizeof(*rec)) {
+                // Último registro a medias: el gateway terminó sin cerrar el archivo
+                return feof(reader->file) ? 0 : -1;
+            }
+            if (rec->type != EXEC_LOG_SUMMARY_TYPE) return 1;
+            memcpy(&reader->stats, rec->text, sizeof(reader->stats));
+            reader->stats.building_id[sizeof(reader->stats.building_id) - 1] = '\0';
+            reader->has_summary = true;
+        }
+    }
+
+    for (;;) {
+        ssize_t len = getline(&reader->line, &reader->line_capacity, reader->file);
+        if (len < 0) return 0;
+        if (len <= 1) continue;
+
+        cJSON *line = cJSON_Parse(reader->line);
+        if (!line) {
+            // Una última línea sin terminar se ignora; cualquier otra es corrupción
+            return feof(reader->file) || reader->line[len - 1] != '\n' ? 0 : -1;
+        }
+        const cJSON *summary = cJSON_GetObjectItemCaseSensitive(line, "resumen");
+        int result = 1;
+        if (cJSON_IsObject(summary)) {
+            read_jsonl_summary(reader, summary);
+            result = 0;
+        } else if (!read_jsonl_event(line, rec)) {
+            result = -1;
+        }
+        cJSON_Delete(line);
+        if (result != 0) return result;
+    }
+}
+
+void exec_log_reader_close(exec_log_reader_t *reader) {
+    if (!reader) return;
+    if (reader->file) {
+        fclose(reader->file);
+        reader->file = NULL;
+    }
+    free(reader->line);
+    reader->line = NULL;
+    reader->line_capacity = 0;
+}
@@ -0,0 +1,536 @@
+/**
+ * @file exec_report.c
+ * @brief Generador offline de reportes a partir de registros de ejecución
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Convierte los registros que escriben los gateways con
+ * GATEWAY_LOG_FORMAT=jsonl o GATEWAY_LOG_FORMAT=binary en el reporte
+ * Markdown de siempre y, opcionalmente, en PDF. Con --aggregate resume
+ * muchas ejecuciones (por ejemplo las 100 instancias de
+ * run_100_api_gateways.sh) en un único informe con totales y una fila por
+ * ejecución.
+ *
+ * **Uso:**
+ * ```
+ * exec_report [opciones] <archivo|directorio>...
+ * ```
+ * - -o, --output <ruta>: archivo de salida (con --aggregate o con una única entrada)
+ * - -a, --aggregate: un único informe agregado de todas las ejecuciones
+ * - --pdf: convierte cada .md generado con generate_pdf_report.sh
+ *
+ * Los directorios se recorren recursivamente buscando *.jsonl y *.bin. Sin
+ * -o, cada ejecución genera su .md junto al registro y el informe agregado
+ * se escribe en la salida estándar.
+ *
+ * @see exec_log_format.h
+ */
+
+// Para nftw, realpath y strdup
+#define _XOPEN_SOURCE 700
+
+#include "api_gateway/exec_log_format.h"
+
+#include <errno.h>
+#include <ftw.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * @brief Resultado de leer una ejecución
+ */
+typedef struct {
+    char *path;                  ///< Registro leído
+    execution_stats_t stats;     ///< Resumen final o, si falta, reconstruido de los eventos
+    bool complete;               ///< true si el registro tenía resumen final
+    bool readable;               ///< false si no se pudo abrir o estaba corrupto
+    unsigned long events;        ///< Eventos leídos
+} run_summary_t;
+
+/**
+ * @brief Lista de registros encontrados en las entradas
+ */
+typedef struct {
+    char **paths;
+    size_t count;
+    size_t capacity;
+} path_list_t;
+
+/**
+ * @brief Lista destino de collect_entry() (nftw no admite contexto)
+ */
+static path_list_t *collect_target = NULL;
+
+static void print_usage(const char *prog) {
+    fprintf(stderr, "Uso: %s [opciones] <archivo|directorio>...\n"
+                    "  -o, --output <ruta>  Archivo de salida (con --aggregate o una única entrada)\n"
+                    "  -a, --aggregate      Un único informe agregado de todas las ejecuciones\n"
+                    "  --pdf                Convierte cada .md generado con generate_pdf_report.sh\n", prog);
+}
+
+static bool has_extension(const char *path, const char *ext) {
+    const char *dot = strrchr(path, '.');
+    return dot && strcmp(dot + 1, ext) == 0;
+}
+
+static bool path_list_add(path_list_t *list, const char *path) {
+    if (list->count == list->capacity) {
+        size_t capacity = list->capacity ? list->capacity * 2 : 64;
+        char **paths = realloc(list->paths, capacity * sizeof(*paths));
+        if (!paths) return false;
+        list->paths = paths;
+        list->capacity = capacity;
+    }
+    list->paths[list->count] = strdup(path);
+    if (!list->paths[list->count]) return false;
+    list->count++;
+    return true;
+}
+
+static int collect_entry(const char *path, const struct stat *st, int type, struct FTW *ftw) {
+    (void)st;
+    (void)ftw;
+    if (type == FTW_F && (has_extension(path, "jsonl") || has_extension(path, "bin"))) {
+        if (!path_list_add(collect_target, path)) return -1;
+    }
+    return 0;
+}
+
+static int compare_paths(const void *a, const void *b) {
+    return strcmp(*(const char *const *)a, *(const char *const *)b);
+}
+
+/**
+ * @brief Añade una entrada de la línea de comandos (archivo o directorio)
+ */
+static bool collect_input(path_list_t *list, const char *input) {
+    struct stat st;
+    if (stat(input, &st) != 0) {
+        fprintf(stderr, "exec_report: no existe '%s'\n", input);
+        return false;
+    }
+    if (!S_ISDIR(st.st_mode)) {
+        return path_list_add(list, input);
+    }
+    collect_target = list;
+    return nftw(input, collect_entry, 16, FTW_PHYS) == 0;
+}
+
+/**
+ * @brief Cuenta un evento en las estadísticas reconstruidas
+ *
+ * Solo se usa cuando el registro no tiene resumen final (gateway terminado
+ * sin exec_logger_finish()); los eventos descartados por cola llena no se
+ * pueden recuperar.
+ */
+static void count_event(execution_stats_t *stats, const exec_log_record_t *rec) {
+    if (rec->generic) return;
+    switch ((log_event_type_t)rec->type) {
+        case LOG_EVENT_SIMULATION_START: {
+            const char *building;
+            exec_log_unpack_strings(rec, &building, 1);
+            strncpy(stats->building_id, building, sizeof(stats->building_id) - 1);
+            stats->building_requests = rec->args[0];
+            break;
+        }
+        case LOG_EVENT_CAN_SENT:       stats->total_can_frames_sent++; break;
+        case LOG_EVENT_CAN_RECEIVED:   stats->total_can_frames_received++; break;
+        case LOG_EVENT_COAP_SENT:      stats->total_coap_requests++; break;
+        case LOG_EVENT_COAP_RECEIVED:  stats->total_coap_responses++; break;
+        case LOG_EVENT_TASK_ASSIGNED:  stats->total_tasks_assigned++; break;
+        case LOG_EVENT_TASK_COMPLETED: stats->total_tasks_completed++; break;
+        case LOG_EVENT_ELEVATOR_MOVED: stats->total_elevator_movements++; break;
+        case LOG_EVENT_ERROR:          stats->total_errors++; break;
+        default: break;
+    }
+}
+
+/**
+ * @brief Lee una ejecución y, si se pide, escribe su reporte Markdown
+ * @param path Registro JSONL o binario
+ * @param md_out Reporte de salida, o NULL para solo resumir
+ * @param run Resultado de la lectura
+ */
+static void process_run(const char *path, FILE *md_out, run_summary_t *run) {
+    memset(run, 0, sizeof(*run));
+    run->path = (char *)path;
+
+    exec_log_reader_t reader;
+    if (exec_log_reader_open(&reader, path) != 0) {
+        fprintf(stderr, "exec_report: '%s' no es un registro JSONL o binario válido\n", path);
+        return;
+    }
+    run->readable = true;
+    if (md_out) {
+        exec_log_write_header(md_out, EXEC_LOG_FORMAT_MARKDOWN, &reader.start);
+    }
+
+    exec_log_record_t rec;
+    uint64_t last_ns = 0;
+    int result;
+    while ((result = exec_log_reader_next(&reader, &rec)) == 1) {
+        run->events++;
+        last_ns = rec.time_ns;
+        count_event(&run->stats, &rec);
+        if (md_out) {
+            exec_log_write_event(md_out, EXEC_LOG_FORMAT_MARKDOWN, &rec, &reader.start);
+        }
+    }
+    if (result < 0) {
+        fprintf(stderr, "exec_report: '%s' está corrupto tras %lu eventos\n", path, run->events);
+        run->readable = false;
+    }
+
+    run->complete = reader.has_summary;
+    if (reader.has_summary) {
+        run->stats = reader.stats;
+    } else {
+        run->stats.execution_duration_sec = (double)last_ns / 1e9;
+    }
+
+    if (md_out) {
+        struct timespec end = reader.start;
+        end.tv_sec += (time_t)run->stats.execution_duration_sec;
+        exec_log_write_footer(md_out, EXEC_LOG_FORMAT_MARKDOWN, &run->stats, &end);
+    }
+    exec_log_reader_close(&reader);
+}
+
+/**
+ * @brief Ruta del .md de una ejecución: la del registro con otra extensión
+ */
+static void markdown_path_for(const char *path, char *out, size_t size) {
+    snprintf(out, size, "%s", path);
+    char *dot = strrchr(out, '.');
+    char *slash = strrchr(out, '/');
+    if (dot && (!slash || dot > slash)) {
+        *dot = '\0';
+    }
+    size_t len = strlen(out);
+    snprintf(out + len, size - len, ".md");
+}
+
+/**
+ * @brief Convierte un .md a PDF con generate_pdf_report.sh
+ * @return true si el script terminó bien
+ *
+ * El script se busca en el directorio actual, en el padre (ejecución desde
+ * build/) y junto al directorio del ejecutable.
+ */
+static bool convert_to_pdf(const char *md_path, const char *prog) {
+    char candidates[3][PATH_MAX];
+    snprintf(candidates[0], PATH_MAX, "generate_pdf_report.sh");
+    snprintf(candidates[1], PATH_MAX, "../generate_pdf_report.sh");
+    snprintf(candidates[2], PATH_MAX, "%s", prog);
+    char *slash = strrchr(candidates[2], '/');
+    if (slash) {
+        snprintf(slash + 1, PATH_MAX - (size_t)(slash + 1 - candidates[2]), "../generate_pdf_report.sh");
+    } else {
+        candidates[2][0] = '\0';
+    }
+
+    char script[PATH_MAX];
+    char md_abs[PATH_MAX];
+    bool found = false;
+    for (int i = 0; i < 3 && !found; i++) {
+        found = candidates[i][0] && realpath(candidates[i], script) != NULL;
+    }
+    if (!found) {
+        fprintf(stderr, "exec_report: no se encontró generate_pdf_report.sh\n");
+        return false;
+    }
+    // El script cambia a su directorio, así que necesita la ruta absoluta;
+    // se lanza con bash porque en el repositorio no tiene permiso de ejecución
+    if (!realpath(md_path, md_abs)) {
+        return false;
+    }
+
+    // Sin pasar por la shell: las rutas llegan tal cual aunque tengan " o $
+    fflush(NULL);
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("exec_report: fork");
+        return false;
+    }
+    if (pid == 0) {
+        char *const argv[] = { "bash", script, md_abs, NULL };
+        execvp("bash", argv);
+        perror("exec_report: bash");
+        _exit(127);
+    }
+    int wstatus;
+    while (waitpid(pid, &wstatus, 0) < 0) {
+        if (errno != EINTR) {
+            return false;
+        }
+    }
+    return WIFEXITED(wstatus) && WEXITSTATUS(wstatus) == 0;
+}
+
+/**
+ * @brief Escribe la tabla de latencia por etapa de todas las ejecuciones
+ *
+ * Los resúmenes solo guardan percentiles, que no se pueden combinar: la
+ * media se pondera por muestras y para p99 se da el peor de las ejecuciones.
+ */
+static void write_aggregate_stage_latency(FILE *out, const run_summary_t *runs, size_t count) {
+    uint64_t samples[GW_SPAN_STAGE_COUNT] = {0};
+    double weighted_mean[GW_SPAN_STAGE_COUNT] = {0};
+    uint32_t worst_p99[GW_SPAN_STAGE_COUNT] = {0};
+    uint32_t max_us[GW_SPAN_STAGE_COUNT] = {0};
+
+    for (size_t i = 0; i < count; i++) {
+        for (int st = 0; st < GW_SPAN_STAGE_COUNT; st++) {
+            const exec_stage_latency_t *lat = &runs[i].stats.stage_latency[st];
+            if (lat->samples == 0) continue;
+            samples[st] += lat->samples;
+            weighted_mean[st] += (double)lat->mean_us * lat->samples;
+            if (lat->p99_us > worst_p99[st]) worst_p99[st] = lat->p99_us;
+            if (lat->max_us > max_us[st]) max_us[st] = lat->max_us;
+        }
+    }
+    if (samples[GW_SPAN_STAGE_TOTAL] == 0) {
+        return;
+    }
+
+    fprintf(out, "\n## Latencia por Etapa\n\n");
+    fprintf(out, "| **Etapa** | **Muestras** | **Media (ms)** | **Peor p99 (ms)** | **Máx (ms)** |\n");
+    fprintf(out, "|:----------|:-------------|:---------------|:------------------|:-------------|\n");
+    for (int st = 0; st < GW_SPAN_STAGE_COUNT; st++) {
+        double mean_ms = samples[st] ? weighted_mean[st] / samples[st] / 1000.0 : 0.0;
+        fprintf(out, "| **%s** | %llu | %.3f | %.3f | %.3f |\n",
+                exec_log_stage_label((gw_span_stage_t)st), (unsigned long long)samples[st],
+                mean_ms, worst_p99[st] / 1000.0, max_us[st] / 1000.0);
+    }
+}
+
+/**
+ * @brief Escribe el informe agregado de varias ejecuciones
+ */
+static void write_aggregate(FILE *out, const run_summary_t *runs, size_t count) {
+    execution_stats_t total;
+    memset(&total, 0, sizeof(total));
+    size_t complete = 0, unreadable = 0, with_errors = 0;
+    double max_duration = 0.0;
+
+    for (size_t i = 0; i < count; i++) {
+        const execution_stats_t *s = &runs[i].stats;
+        if (!runs[i].readable) unreadable++;
+        if (runs[i].complete) complete++;
+        if (s->total_errors > 0) with_errors++;
+        total.total_can_frames_sent += s->total_can_frames_sent;
+        total.total_can_frames_received += s->total_can_frames_received;
+        total.total_coap_requests += s->total_coap_requests;
+        total.total_coap_responses += s->total_coap_responses;
+        total.total_tasks_assigned += s->total_tasks_assigned;
+        total.total_tasks_completed += s->total_tasks_completed;
+        total.total_elevator_movements += s->total_elevator_movements;
+        total.total_errors += s->total_errors;
+        total.dropped_events += s->dropped_events;
+        total.requests_timed_out += s->requests_timed_out;
+        total.requests_answered_locally += s->requests_answered_locally;
+        total.execution_duration_sec += s->execution_duration_sec;
+        if (s->execution_duration_sec > max_duration) max_duration = s->execution_duration_sec;
+    }
+
+    time_t now = time(NULL);
+    char date[32];
+    strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", localtime(&now));
+
+    fprintf(out, "---\n");
+    fprintf(out, "title: \"Informe Agregado de Ejecuciones - API Gateway\"\n");
+    fprintf(out, "subtitle: \"Sistema de Control de Ascensores\"\n");
+    fprintf(out, "date: \"%s\"\n", date);
+    fprintf(out, "geometry: margin=2cm\n");
+    fprintf(out, "---\n\n");
+
+    fprintf(out, "# Resumen\n\n");
+    fprintf(out, "| **Parámetro** | **Valor** |\n");
+    fprintf(out, "|:--------------|:----------|\n");
+    fprintf(out, "| **Ejecuciones** | %zu |\n", count);
+    fprintf(out, "| **Con resumen final** | %zu |\n", complete);
+    fprintf(out, "| **Sin resumen (interrumpidas)** | %zu |\n", count - complete - unreadable);
+    fprintf(out, "| **Ilegibles o corruptas** | %zu |\n", unreadable);
+    fprintf(out, "| **Con errores** | %zu |\n", with_errors);
+    fprintf(out, "| **Duración media** | %.2f s |\n", count ? total.execution_duration_sec / count : 0.0);
+    fprintf(out, "| **Duración máxima** | %.2f s |\n\n", max_duration);
+
+    fprintf(out, "## Totales\n\n");
+    fprintf(out, "| **Métrica** | **Total** | **Media por ejecución** |\n");
+    fprintf(out, "|:------------|:----------|:------------------------|\n");
+#define AGG_ROW(label, field) \
+    fprintf(out, "| **%s** | %d | %.1f |\n", label, total.field, count ? (double)total.field / count : 0.0)
+    AGG_ROW("Frames CAN enviados", total_can_frames_sent);
+    AGG_ROW("Frames CAN recibidos", total_can_frames_received);
+    AGG_ROW("Peticiones CoAP", total_coap_requests);
+    AGG_ROW("Respuestas CoAP", total_coap_responses);
+    AGG_ROW("Tareas asignadas", total_tasks_assigned);
+    AGG_ROW("Tareas completadas", total_tasks_completed);
+    AGG_ROW("Movimientos de ascensores", total_elevator_movements);
+    AGG_ROW("Errores", total_errors);
+    AGG_ROW("Eventos no registrados", dropped_events);
+    AGG_ROW("Solicitudes expiradas", requests_timed_out);
+    AGG_ROW("Respondidas localmente", requests_answered_locally);
+#undef AGG_ROW
+    if (total.total_coap_requests > 0) {
+        fprintf(out, "\nRespuestas CoAP / peticiones: %.1f%%\n",
+                100.0 * total.total_coap_responses / total.total_coap_requests);
+    }
+    if (total.total_tasks_assigned > 0) {
+        fprintf(out, "\nTareas completadas / asignadas: %.1f%%\n",
+                100.0 * total.total_tasks_completed / total.total_tasks_assigned);
+    }
+
+    write_aggregate_stage_latency(out, runs, count);
+
+    fprintf(out, "\n## Ejecuciones\n\n");
+    fprintf(out, "| **Registro** | **Edificio** | **Duración (s)** | **CAN TX/RX** | **CoAP TX/RX** "
+                 "| **Tareas asig./comp.** | **p99 total (ms)** | **Errores** | **Estado** |\n");
+    fprintf(out, "|:-------------|:-------------|:-----------------|:--------------|:---------------"
+                 "|:----------------------|:-------------------|:------------|:-----------|\n");
+    for (size_t i = 0; i < count; i++) {
+        const execution_stats_t *s = &runs[i].stats;
+        const char *state = !runs[i].readable ? "ilegible" : runs[i].complete ? "completa" : "sin resumen";
+        const exec_stage_latency_t *lat = &s->stage_latency[GW_SPAN_STAGE_TOTAL];
+        char p99[16] = "N/A";
+        if (lat->samples > 0) {
+            snprintf(p99, sizeof(p99), "%.3f", lat->p99_us / 1000.0);
+        }
+        fprintf(out, "| %s | %s | %.2f | %d/%d | %d/%d | %d/%d | %s | %d | %s |\n",
+                runs[i].path, s->building_id[0] ? s->building_id : "N/A", s->execution_duration_sec,
+                s->total_can_frames_sent, s->total_can_frames_received,
+                s->total_coap_requests, s->total_coap_responses,
+                s->total_tasks_assigned, s->total_tasks_completed,
+                p99, s->total_errors, state);
+    }
+}
+
+/**
+ * @brief Opciones de la línea de comandos
+ */
+typedef struct {
+    const char *output;          ///< Ruta de -o, o NULL
+    bool aggregate;              ///< --aggregate
+    bool pdf;                    ///< --pdf
+} report_options_t;
+
+static void path_list_free(path_list_t *list) {
+    for (size_t i = 0; i < list->count; i++) {
+        free(list->paths[i]);
+    }
+    free(list->paths);
+}
+
+/**
+ * @brief Genera los reportes de todas las entradas
+ * @return EXIT_SUCCESS, o EXIT_FAILURE si algún registro o reporte falló
+ */
+static int generate_reports(const path_list_t *inputs, const report_options_t *opts, const char *prog) {
+    run_summary_t *runs = calloc(inputs->count, sizeof(*runs));
+    if (!runs) {
+        return EXIT_FAILURE;
+    }
+
+    int status = EXIT_SUCCESS;
+    for (size_t i = 0; i < inputs->count; i++) {
+        if (opts->aggregate) {
+            process_run(inputs->paths[i], NULL, &runs[i]);
+            continue;
+        }
+        char md_path[PATH_MAX];
+        if (opts->output) {
+            snprintf(md_path, sizeof(md_path), "%s", opts->output);
+        } else {
+            markdown_path_for(inputs->paths[i], md_path, sizeof(md_path));
+        }
+        FILE *md = fopen(md_path, "w");
+        if (!md) {
+            fprintf(stderr, "exec_report: no se pudo crear '%s'\n", md_path);
+            status = EXIT_FAILURE;
+            continue;
+        }
+        process_run(inputs->paths[i], md, &runs[i]);
+        fclose(md);
+        if (!runs[i].readable) {
+            status = EXIT_FAILURE;
+        }
+        printf("%s -> %s (%lu eventos%s)\n", inputs->paths[i], md_path, runs[i].events,
+               runs[i].complete ? "" : ", sin resumen final");
+        if (opts->pdf && !convert_to_pdf(md_path, prog)) {
+            status = EXIT_FAILURE;
+        }
+    }
+
+    if (opts->aggregate) {
+        FILE *out = opts->output ? fopen(opts->output, "w") : stdout;
+        if (!out) {
+            fprintf(stderr, "exec_report: no se pudo crear '%s'\n", opts->output);
+            status = EXIT_FAILURE;
+        } else {
+            write_aggregate(out, runs, inputs->count);
+            if (out != stdout) {
+                fclose(out);
+                fprintf(stderr, "Informe agregado de %zu ejecuciones: %s\n", inputs->count, opts->output);
+                if (opts->pdf && !convert_to_pdf(opts->output, prog)) {
+                    status = EXIT_FAILURE;
+                }
+            }
+        }
+    }
+
+    free(runs);
+    return status;
+}
+
+int main(int argc, char *argv[]) {
+    report_options_t opts = { NULL, false, false };
+    path_list_t inputs = { NULL, 0, 0 };
+    int status = EXIT_SUCCESS;
+
+    for (int i = 1; i < argc && status == EXIT_SUCCESS; i++) {
+        if ((strcmp(argv[i], "-o") == 0 || strcmp(argv[i], "--output") == 0) && i + 1 < argc) {
+            opts.output = argv[++i];
+        } else if (strcmp(argv[i], "-a") == 0 || strcmp(argv[i], "--aggregate") == 0) {
+            opts.aggregate = true;
+        } else if (strcmp(argv[i], "--pdf") == 0) {
+            opts.pdf = true;
+        } else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+            print_usage(argv[0]);
+            path_list_free(&inputs);
+            return EXIT_SUCCESS;
+        } else if (argv[i][0] != '-') {
+            if (!collect_input(&inputs, argv[i])) {
+                status = EXIT_FAILURE;
+            }
+        } else {
+            print_usage(argv[0]);
+            status = EXIT_FAILURE;
+        }
+    }
+
+    if (status == EXIT_SUCCESS && inputs.count == 0) {
+        fprintf(stderr, "exec_report: no se encontraron registros .jsonl ni .bin\n");
+        print_usage(argv[0]);
+        status = EXIT_FAILURE;
+    } else if (status == EXIT_SUCCESS && opts.output && !opts.aggregate && inputs.count > 1) {
+        fprintf(stderr, "exec_report: -o con varias ejecuciones requiere --aggregate\n");
+        status = EXIT_FAILURE;
+    } else if (status == EXIT_SUCCESS && opts.pdf && opts.aggregate && !opts.output) {
+        fprintf(stderr, "exec_report: --pdf con --aggregate requiere -o\n");
+        status = EXIT_FAILURE;
+    }
+
+    if (status == EXIT_SUCCESS) {
+        qsort(inputs.paths, inputs.count, sizeof(*inputs.paths), compare_paths);
+        status = generate_reports(&inputs, &opts, argv[0]);
+    }
+
+    path_list_free(&inputs);
+    return status;
+}
@@ -4,19 +4,57 @@
  * @author Sistema de Control de Ascensores
  * @date 2025
  * @version 1.0
+ *
+ * Las funciones exec_logger_log_*() se llaman desde las rutas CAN y CoAP,
+ * así que no formatean ni escriben: copian sus argumentos en un registro
+ * binario de tamaño fijo (tipo, instante monotónico, enteros y cadenas
+ * empaquetadas) y lo publican en una cola circular sin bloqueos. Un hilo
+ * escritor vacía la cola periódicamente y escribe los eventos en el formato
+ * elegido con GATEWAY_LOG_FORMAT (exec_log_format.h); al finalizar,
+ * exec_logger_finish() vacía lo que quede antes de escribir el resumen.
+ *
+ * Si la cola se llena el evento se descarta y se cuenta en
+ * execution_stats_t::dropped_events; los contadores de estadísticas se
+ * actualizan siempre (con incrementos atómicos) y no dependen de la cola.
+ * Los productores pueden estar en cualquier hilo: exec_logger_finish()
+ * desactiva el logger de forma atómica y espera a los que tengan una celda
+ * reservada antes de liberar la cola.
  */
 
-// Para clock_gettime con precisión de nanosegundos
-#define _POSIX_C_SOURCE 199309L
+// Para clock_gettime y nanosleep
+#define _POSIX_C_SOURCE 200809L
 
 #include "api_gateway/execution_logger.h"
+#include "api_gateway/exec_log_format.h"
+#include "api_gateway/latency_histogram.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
 #include <time.h>
+#include <pthread.h>
 #include <sys/stat.h>
 #include <errno.h>
 #include <unistd.h>  // Para getcwd
+#include <sched.h>   // Para sched_yield
+
+// ============================================================================
+// COLA DE EVENTOS
+// ============================================================================
+
+#define EXEC_LOG_RING_SLOTS 2048         ///< Capacidad de la cola (potencia de 2)
+#define EXEC_LOG_DRAIN_INTERVAL_MS 20    ///< Periodo del hilo escritor con la cola vacía
+
+/**
+ * @brief Posición de la cola (cola acotada de Vyukov)
+ *
+ * @c sequence vale la posición cuando la celda está libre para ese ticket y
+ * posición + 1 cuando el evento está publicado y listo para el escritor.
+ */
+typedef struct {
+    size_t sequence;
+    exec_log_record_t record;
+} exec_log_slot_t;
 
 // ============================================================================
 // VARIABLES GLOBALES PRIVADAS
@@ -24,9 +62,34 @@
 
 static FILE *log_file = NULL;                  ///< Archivo de log actual
 static execution_stats_t stats;                ///< Estadísticas de ejecución
-static time_t start_time;                      ///< Tiempo de inicio de ejecución
-static bool logger_active = false;             ///< Estado del logger
+static int logger_active = 0;                  ///< Estado del logger (acceso atómico: lo leen productores de cualquier hilo)
 static char current_log_path[MAX_LOG_PATH];    ///< Ruta del archivo actual
+static exec_log_format_t log_format = EXEC_LOG_FORMAT_MARKDOWN; ///< Formato del archivo actual
+
+static exec_log_slot_t *ring = NULL;           ///< Celdas de la cola de eventos
+static size_t ring_enqueue_pos = 0;            ///< Siguiente ticket de los productores
+static size_t ring_dequeue_pos = 0;            ///< Siguiente ticket del escritor
+static int ring_producers = 0;                 ///< Productores entre ring_claim() y ring_publish()
+static struct timespec base_realtime;          ///< Reloj de pared al iniciar
+static uint64_t base_mono_ns = 0;              ///< Reloj monotónico al iniciar
+static pthread_t writer_thread;                ///< Hilo que escribe los eventos
+static bool writer_running = false;            ///< true si writer_thread está lanzado
+static int writer_stop = 0;                    ///< Petición de parada del escritor
+
+static gw_latency_hist_t stage_hist[GW_SPAN_STAGE_COUNT]; ///< Latencias por gw_span_stage_t
+static bool stage_hist_ready = false;          ///< true si stage_hist está reservado
+static pthread_mutex_t stage_hist_lock = PTHREAD_MUTEX_INITIALIZER; ///< Protege stage_hist
+
+/**
+ * @brief Puntos inicial y final de cada etapa
+ */
+static const gw_span_point_t stage_points[GW_SPAN_STAGE_COUNT][2] = {
+    [GW_SPAN_STAGE_ENCODE]   = { GW_SPAN_CAN_RX,    GW_SPAN_JSON_DONE },
+    [GW_SPAN_STAGE_SEND]     = { GW_SPAN_JSON_DONE, GW_SPAN_COAP_TX },
+    [GW_SPAN_STAGE_SERVER]   = { GW_SPAN_COAP_TX,   GW_SPAN_COAP_RX },
+    [GW_SPAN_STAGE_RESPONSE] = { GW_SPAN_COAP_RX,   GW_SPAN_CAN_TX },
+    [GW_SPAN_STAGE_TOTAL]    = { GW_SPAN_CAN_RX,    GW_SPAN_CAN_TX },
+};
 
 // ============================================================================
 // FUNCIONES PRIVADAS
@@ -67,175 +130,226 @@ static void get_formatted_timestamp(char *buffer, size_t buffer_size, const char
 }
 
 /**
- * @brief Escribe el header del archivo Markdown
- */
-static void write_markdown_header(void) {
-    if (!log_file) return;
-    
-    char timestamp[64];
-    get_formatted_timestamp(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S");
-    
-    fprintf(log_file, "---\n");
-    fprintf(log_file, "title: \"Reporte de Ejecución - API Gateway\"\n");
-    fprintf(log_file, "subtitle: \"Sistema de Control de Ascensores\"\n");
-    fprintf(log_file, "author: \"API Gateway v2.0\"\n");
-    fprintf(log_file, "date: \"%s\"\n", timestamp);
-    fprintf(log_file, "geometry: margin=2cm\n");
-    fprintf(log_file, "fontsize: 11pt\n");
-    fprintf(log_file, "documentclass: article\n");
-    fprintf(log_file, "header-includes:\n");
-    fprintf(log_file, "  - \\usepackage{fancyhdr}\n");
-    fprintf(log_file, "  - \\usepackage{graphicx}\n");
-    fprintf(log_file, "  - \\pagestyle{fancy}\n");
-    fprintf(log_file, "  - \\fancyhf{}\n");
-    fprintf(log_file, "  - \\rhead{API Gateway - Sistema de Ascensores}\n");
-    fprintf(log_file, "  - \\lfoot{%s}\n", timestamp);
-    fprintf(log_file, "  - \\rfoot{\\thepage}\n");
-    fprintf(log_file, "---\n\n");
-    
-    fprintf(log_file, "\\newpage\n\n");
-    
-    fprintf(log_file, "# Resumen Ejecutivo\n\n");
-    fprintf(log_file, "Este documento presenta el registro detallado de la ejecución del API Gateway ");
-    fprintf(log_file, "del Sistema de Control de Ascensores. El sistema actúa como intermediario entre ");
-    fprintf(log_file, "los controladores CAN de ascensores y el servidor central, proporcionando ");
-    fprintf(log_file, "comunicación segura mediante CoAP sobre DTLS-PSK.\n\n");
-    
-    fprintf(log_file, "## Información del Sistema\n\n");
-    fprintf(log_file, "| **Parámetro** | **Valor** |\n");
-    fprintf(log_file, "|:--------------|:----------|\n");
-    fprintf(log_file, "| **Fecha de Ejecución** | %s |\n", timestamp);
-    fprintf(log_file, "| **Versión del Sistema** | 2.0 |\n");
-    fprintf(log_file, "| **Estado Inicial** | EN EJECUCION |\n");
-    fprintf(log_file, "| **Edificio Simulado** | *Pendiente de asignación* |\n");
-    fprintf(log_file, "| **Peticiones Programadas** | *Pendiente de configuración* |\n\n");
-    
-    fprintf(log_file, "## Configuración Técnica\n\n");
-    fprintf(log_file, "### Protocolos de Comunicación\n\n");
-    fprintf(log_file, "- **Protocolo Principal:** CoAP (Constrained Application Protocol)\n");
-    fprintf(log_file, "- **Seguridad:** DTLS (Datagram Transport Layer Security)\n");
-    fprintf(log_file, "- **Transporte:** UDP (User Datagram Protocol)\n");
-    fprintf(log_file, "- **Puerto de Escucha:** 5683 (Puerto estándar CoAP)\n");
-    fprintf(log_file, "- **Servidor Central:** 192.168.49.2:30084 (Minikube Cluster)\n\n");
-    
-    fprintf(log_file, "### Componentes del Sistema\n\n");
-    fprintf(log_file, "- **Simulador CAN:** Integrado para testing\n");
-    fprintf(log_file, "- **Gestor de Estado:** Mantenimiento del estado de ascensores\n");
-    fprintf(log_file, "- **Puente CAN-CoAP:** Transformación de mensajes\n");
-    fprintf(log_file, "- **Formato de Datos:** JSON para payloads\n");
-    fprintf(log_file, "- **Logging:** Sistema de registro de eventos en tiempo real\n\n");
-    
-    fprintf(log_file, "\\newpage\n\n");
-    fprintf(log_file, "# Registro de Eventos\n\n");
-    fprintf(log_file, "La siguiente sección presenta el flujo cronológico de eventos durante la ejecución del sistema.\n\n");
-    
-    fflush(log_file);
+ * @brief Lee el reloj monotónico en nanosegundos
+ */
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
 }
 
 /**
- * @brief Escribe el footer del archivo Markdown con estadísticas finales
+ * @brief Indica si el logger acepta eventos
  */
-static void write_markdown_footer(void) {
-    if (!log_file) return;
-    
-    char timestamp[64];
-    get_formatted_timestamp(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S");
-    
-    fprintf(log_file, "\n\\newpage\n\n");
-    fprintf(log_file, "# Estadísticas Finales de Ejecución\n\n");
-    
-    fprintf(log_file, "## Resumen de Comunicaciones\n\n");
-    fprintf(log_file, "### Tráfico de Red\n\n");
-    fprintf(log_file, "| **Protocolo** | **Enviados** | **Recibidos** | **Total** |\n");
-    fprintf(log_file, "|:--------------|:-------------|:--------------|:----------|\n");
-    fprintf(log_file, "| **Frames CAN** | %d | %d | %d |\n", 
-             stats.total_can_frames_sent, stats.total_can_frames_received, 
-             stats.total_can_frames_sent + stats.total_can_frames_received);
-    fprintf(log_file, "| **Mensajes CoAP** | %d | %d | %d |\n\n", 
-             stats.total_coap_requests, stats.total_coap_responses,
-             stats.total_coap_requests + stats.total_coap_responses);
-    
-    fprintf(log_file, "## Gestión de Ascensores\n\n");
-    fprintf(log_file, "### Operaciones de Control\n\n");
-    fprintf(log_file, "| **Métrica** | **Cantidad** | **Porcentaje** |\n");
-    fprintf(log_file, "|:------------|:-------------|:---------------|\n");
-    fprintf(log_file, "| **Tareas Asignadas** | %d | 100%% |\n", stats.total_tasks_assigned);
-    
-    if (stats.total_tasks_assigned > 0) {
-        double completion_rate = (100.0 * stats.total_tasks_completed) / stats.total_tasks_assigned;
-        fprintf(log_file, "| **Tareas Completadas** | %d | %.1f%% |\n", stats.total_tasks_completed, completion_rate);
-    } else {
-        fprintf(log_file, "| **Tareas Completadas** | %d | N/A |\n", stats.total_tasks_completed);
+static bool logger_is_on(void) {
+    return __atomic_load_n(&logger_active, __ATOMIC_ACQUIRE) != 0;
+}
+
+/**
+ * @brief Reserva los histogramas de latencia por etapa
+ * @return true si hubo memoria para todos
+ */
+static bool stage_hist_create(void) {
+    pthread_mutex_lock(&stage_hist_lock);
+    stage_hist_ready = true;
+    for (int i = 0; i < GW_SPAN_STAGE_COUNT; i++) {
+        stage_hist_ready = gw_latency_hist_init(&stage_hist[i]) && stage_hist_ready;
     }
-    
-    fprintf(log_file, "| **Movimientos de Ascensores** | %d | N/A |\n", stats.total_elevator_movements);
-    fprintf(log_file, "| **Errores Detectados** | %d | N/A |\n\n", stats.total_errors);
-    
-    fprintf(log_file, "## Análisis de Rendimiento\n\n");
-    fprintf(log_file, "### Métricas Temporales\n\n");
-    fprintf(log_file, "| **Parámetro** | **Valor** | **Unidad** |\n");
-    fprintf(log_file, "|:--------------|:----------|:-----------|\n");
-    fprintf(log_file, "| **Duración Total** | %.2f | segundos |\n", stats.execution_duration_sec);
-    fprintf(log_file, "| **Edificio Simulado** | %s | ID |\n", stats.building_id[0] ? stats.building_id : "N/A");
-    fprintf(log_file, "| **Peticiones del Edificio** | %d | cantidad |\n", stats.building_requests);
-    
-    if (stats.building_requests > 0) {
-        double avg_time = stats.execution_duration_sec / stats.building_requests;
-        fprintf(log_file, "| **Tiempo Promedio por Petición** | %.3f | segundos |\n", avg_time);
-        
-        if (avg_time > 0) {
-            double throughput = 1.0 / avg_time;
-            fprintf(log_file, "| **Throughput del Sistema** | %.2f | peticiones/segundo |\n", throughput);
+    pthread_mutex_unlock(&stage_hist_lock);
+    return stage_hist_ready;
+}
+
+/**
+ * @brief Libera los histogramas de latencia por etapa
+ */
+static void stage_hist_destroy(void) {
+    pthread_mutex_lock(&stage_hist_lock);
+    for (int i = 0; i < GW_SPAN_STAGE_COUNT; i++) {
+        gw_latency_hist_free(&stage_hist[i]);
+    }
+    stage_hist_ready = false;
+    pthread_mutex_unlock(&stage_hist_lock);
+}
+
+/**
+ * @brief Copia en stats.stage_latency el resumen de cada histograma
+ */
+static void summarize_stage_latency(void) {
+    pthread_mutex_lock(&stage_hist_lock);
+    for (int i = 0; stage_hist_ready && i < GW_SPAN_STAGE_COUNT; i++) {
+        const gw_latency_hist_t *hist = &stage_hist[i];
+        exec_stage_latency_t *out = &stats.stage_latency[i];
+        out->samples = hist->total > UINT32_MAX ? UINT32_MAX : (uint32_t)hist->total;
+        if (hist->total == 0) {
+            continue;
+        }
+        uint64_t values[] = {
+            (uint64_t)gw_latency_hist_mean(hist),
+            gw_latency_hist_percentile(hist, 50.0),
+            gw_latency_hist_percentile(hist, 90.0),
+            gw_latency_hist_percentile(hist, 99.0),
+            hist->max_us,
+        };
+        uint32_t *fields[] = { &out->mean_us, &out->p50_us, &out->p90_us, &out->p99_us, &out->max_us };
+        for (size_t k = 0; k < sizeof(values) / sizeof(values[0]); k++) {
+            *fields[k] = values[k] > UINT32_MAX ? UINT32_MAX : (uint32_t)values[k];
         }
     }
-    
-    fprintf(log_file, "\n### Eficiencia del Sistema\n\n");
-    if (stats.total_errors == 0) {
-        fprintf(log_file, "**ESTADO: EJECUCION EXITOSA**\n\n");
-        fprintf(log_file, "- Sin errores detectados durante la ejecución\n");
-        fprintf(log_file, "- Todas las comunicaciones funcionaron correctamente\n");
-        fprintf(log_file, "- Sistema de simulación operativo y estable\n");
-        fprintf(log_file, "- Protocolo DTLS establecido correctamente\n");
-    } else {
-        fprintf(log_file, "**ESTADO: EJECUCION CON ADVERTENCIAS**\n\n");
-        fprintf(log_file, "- **%d errores** detectados durante la ejecución\n", stats.total_errors);
-        fprintf(log_file, "- Revisar la sección de eventos para análisis detallado\n");
-        fprintf(log_file, "- Verificar configuración de red y protocolos\n");
+    pthread_mutex_unlock(&stage_hist_lock);
+}
+
+/**
+ * @brief Reserva una celda de la cola para un evento nuevo
+ * @param type Tipo de evento
+ * @param ticket Ticket de la celda, necesario para publicarla
+ * @return Registro a rellenar, o NULL si la cola está llena
+ *
+ * Puede llamarse desde varios hilos a la vez. No bloquea: si la cola está
+ * llena cuenta el evento como descartado. El productor queda contado en
+ * ring_producers hasta ring_publish(), de modo que exec_logger_finish() no
+ * libera la cola con una celda a medio escribir.
+ */
+static exec_log_record_t *ring_claim(log_event_type_t type, size_t *ticket) {
+    __atomic_add_fetch(&ring_producers, 1, __ATOMIC_SEQ_CST);
+    // Comprobar después de contarse: o finish ve al productor, o el productor ve el logger inactivo
+    if (!__atomic_load_n(&logger_active, __ATOMIC_SEQ_CST) || !ring) {
+        __atomic_sub_fetch(&ring_producers, 1, __ATOMIC_RELEASE);
+        return NULL;
     }
-    
-    fprintf(log_file, "\n## Conclusiones\n\n");
-    fprintf(log_file, "Este reporte documenta la ejecución completa del API Gateway del Sistema de ");
-    fprintf(log_file, "Control de Ascensores. Los datos presentados permiten evaluar el rendimiento ");
-    fprintf(log_file, "del sistema y identificar áreas de mejora en futuras iteraciones.\n\n");
-    
-    fprintf(log_file, "---\n\n");
-    fprintf(log_file, "**Reporte generado automáticamente**  \n");
-    fprintf(log_file, "Sistema de Control de Ascensores - API Gateway v2.0  \n");
-    fprintf(log_file, "Finalizado: %s\n", timestamp);
-    
-    fflush(log_file);
+
+    size_t pos = __atomic_load_n(&ring_enqueue_pos, __ATOMIC_RELAXED);
+    exec_log_slot_t *slot;
+    for (;;) {
+        slot = &ring[pos & (EXEC_LOG_RING_SLOTS - 1)];
+        size_t seq = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&ring_enqueue_pos, &pos, pos + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            __atomic_fetch_add(&stats.dropped_events, 1, __ATOMIC_RELAXED);
+            __atomic_sub_fetch(&ring_producers, 1, __ATOMIC_RELEASE);
+            return NULL;
+        } else {
+            pos = __atomic_load_n(&ring_enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+
+    exec_log_record_t *rec = &slot->record;
+    rec->time_ns = monotonic_ns() - base_mono_ns;
+    rec->type = (uint8_t)type;
+    rec->generic = 0;
+    rec->truncated = 0;
+    *ticket = pos;
+    return rec;
+}
+
+/**
+ * @brief Publica un registro reservado con ring_claim() para el escritor
+ */
+static void ring_publish(size_t ticket) {
+    exec_log_slot_t *slot = &ring[ticket & (EXEC_LOG_RING_SLOTS - 1)];
+    __atomic_store_n(&slot->sequence, ticket + 1, __ATOMIC_RELEASE);
+    __atomic_sub_fetch(&ring_producers, 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Escribe en el archivo todos los eventos publicados
+ * @return Número de eventos escritos
+ *
+ * Se detiene en la primera celda aún no publicada para conservar el orden;
+ * el resto se escribe en la siguiente pasada.
+ */
+static size_t ring_drain(void) {
+    size_t rendered = 0;
+    while (ring) {
+        exec_log_slot_t *slot = &ring[ring_dequeue_pos & (EXEC_LOG_RING_SLOTS - 1)];
+        size_t seq = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        if (seq != ring_dequeue_pos + 1) {
+            break;
+        }
+        exec_log_write_event(log_file, log_format, &slot->record, &base_realtime);
+        __atomic_store_n(&slot->sequence, ring_dequeue_pos + EXEC_LOG_RING_SLOTS, __ATOMIC_RELEASE);
+        ring_dequeue_pos++;
+        rendered++;
+    }
+    return rendered;
 }
 
 /**
- * @brief Convierte el tipo de evento a etiqueta de texto profesional
- */
-static const char* get_event_label(log_event_type_t type) {
-    switch (type) {
-        case LOG_EVENT_SYSTEM_START:     return "INICIO";
-        case LOG_EVENT_SYSTEM_END:       return "FIN";
-        case LOG_EVENT_SIMULATION_START: return "SIM-INICIO";
-        case LOG_EVENT_SIMULATION_END:   return "SIM-FIN";
-        case LOG_EVENT_BUILDING_SELECTED:return "EDIFICIO";
-        case LOG_EVENT_CAN_SENT:         return "CAN-TX";
-        case LOG_EVENT_CAN_RECEIVED:     return "CAN-RX";
-        case LOG_EVENT_COAP_SENT:        return "COAP-TX";
-        case LOG_EVENT_COAP_RECEIVED:    return "COAP-RX";
-        case LOG_EVENT_TASK_ASSIGNED:    return "TAREA-ASIG";
-        case LOG_EVENT_ELEVATOR_MOVED:   return "ASCENSOR-MOV";
-        case LOG_EVENT_TASK_COMPLETED:   return "TAREA-COMP";
-        case LOG_EVENT_ERROR:            return "ERROR";
-        default:                         return "INFO";
+ * @brief Bucle del hilo escritor
+ *
+ * Vacía la cola y vuelca el archivo una vez por tanda. Tras la petición de
+ * parada hace una última pasada para no perder eventos publicados antes.
+ */
+static void *writer_main(void *arg) {
+    (void)arg;
+    const struct timespec idle = { 0, EXEC_LOG_DRAIN_INTERVAL_MS * 1000000L };
+
+    for (;;) {
+        int stopping = __atomic_load_n(&writer_stop, __ATOMIC_ACQUIRE);
+        size_t rendered = ring_drain();
+        if (rendered > 0) {
+            fflush(log_file);
+        }
+        if (stopping) {
+            break;
+        }
+        if (rendered == 0) {
+            nanosleep(&idle, NULL);
+        }
     }
+    return NULL;
+}
+
+/**
+ * @brief Detiene el hilo escritor y espera a que termine
+ */
+static void stop_writer(void) {
+    if (!writer_running) return;
+    __atomic_store_n(&writer_stop, 1, __ATOMIC_RELEASE);
+    pthread_join(writer_thread, NULL);
+    writer_running = false;
+}
+
+/**
+ * @brief Crea la cola de eventos vacía
+ * @return true si se reservó la memoria
+ */
+static bool ring_create(void) {
+    ring = calloc(EXEC_LOG_RING_SLOTS, sizeof(exec_log_slot_t));
+    if (!ring) return false;
+    for (size_t i = 0; i < EXEC_LOG_RING_SLOTS; i++) {
+        ring[i].sequence = i;
+    }
+    ring_enqueue_pos = 0;
+    ring_dequeue_pos = 0;
+    return true;
+}
+
+/**
+ * @brief Encola un frame CAN enviado o recibido
+ *
+ * Guarda los bytes tal cual; el formato hexadecimal lo genera el escritor.
+ */
+static void log_can_frame(log_event_type_t type, unsigned int can_id, int dlc,
+                          const unsigned char* data, const char* description) {
+    size_t ticket;
+    exec_log_record_t *rec = ring_claim(type, &ticket);
+    if (!rec) return;
+    
+    const char *strings[] = { description };
+    rec->can_id = can_id;
+    rec->args[0] = dlc;
+    rec->args[1] = 0;
+    if (data && dlc > 0) {
+        rec->args[1] = dlc < (int)sizeof(rec->data) ? dlc : (int)sizeof(rec->data);
+        memcpy(rec->data, data, (size_t)rec->args[1]);
+    }
+    exec_log_pack_strings(rec, strings, 1);
+    ring_publish(ticket);
 }
 
 // ============================================================================
@@ -251,9 +365,11 @@ static const char* get_event_label(log_event_type_t type) {
  * 
  * **Operaciones realizadas:**
  * - Crea el directorio de logs con timestamp
- * - Abre el archivo de log con timestamp único
+ * - Abre el archivo de log con timestamp único, con la extensión del
+ *   formato elegido en GATEWAY_LOG_FORMAT (markdown, jsonl o binary)
  * - Inicializa las estadísticas de ejecución
- * - Escribe el header Markdown del reporte
+ * - Escribe la cabecera del archivo
+ * - Lanza el hilo escritor
  * - Marca el logger como activo
  * 
  * @see exec_logger_finish()
@@ -262,7 +378,13 @@ static const char* get_event_label(log_event_type_t type) {
 bool exec_logger_init(void) {
     // Inicializar estadísticas
     memset(&stats, 0, sizeof(execution_stats_t));
-    start_time = time(NULL);
+    
+    // Formato de salida: el Markdown de siempre salvo que se pida uno estructurado
+    const char* format_name = getenv("GATEWAY_LOG_FORMAT");
+    log_format = EXEC_LOG_FORMAT_MARKDOWN;
+    if (format_name && strlen(format_name) > 0 && !exec_log_format_from_name(format_name, &log_format)) {
+        printf("[EXEC_LOGGER] Aviso: GATEWAY_LOG_FORMAT='%s' no reconocido, usando markdown\n", format_name);
+    }
     
     // Debug: mostrar directorio actual de trabajo
     char cwd[1024];
@@ -346,7 +468,8 @@ bool exec_logger_init(void) {
     
     // Usar snprintf con verificación de tamaño
     int path_len = snprintf(current_log_path, sizeof(current_log_path), 
-                           "%s/ejecucion_%s.md", date_dir, time_str);
+                           "%s/ejecucion_%s.%s", date_dir, time_str,
+                           exec_log_format_extension(log_format));
     
     if (path_len >= sizeof(current_log_path)) {
         printf("[EXEC_LOGGER] Error: Ruta del archivo demasiado larga\n");
@@ -356,16 +479,38 @@ bool exec_logger_init(void) {
     printf("[EXEC_LOGGER] Intentando crear archivo: %s\n", current_log_path);
     
     // Abrir archivo de log
-    log_file = fopen(current_log_path, "w");
+    log_file = fopen(current_log_path, log_format == EXEC_LOG_FORMAT_BINARY ? "wb" : "w");
     if (!log_file) {
         printf("[EXEC_LOGGER] Error abriendo archivo de log: %s\n", strerror(errno));
         return false;
     }
     
+    // Cola de eventos y referencias de tiempo para los timestamps
+    if (!ring_create()) {
+        printf("[EXEC_LOGGER] Error reservando la cola de eventos\n");
+        fclose(log_file);
+        log_file = NULL;
+        return false;
+    }
+    clock_gettime(CLOCK_REALTIME, &base_realtime);
+    base_mono_ns = monotonic_ns();
+    if (!stage_hist_create()) {
+        // El registro de eventos sigue funcionando sin latencias
+        printf("[EXEC_LOGGER] Aviso: sin memoria para los histogramas de latencia\n");
+    }
+    
     // Escribir header
-    write_markdown_header();
+    exec_log_write_header(log_file, log_format, &base_realtime);
+    fflush(log_file);
+    
+    writer_stop = 0;
+    writer_running = pthread_create(&writer_thread, NULL, writer_main, NULL) == 0;
+    if (!writer_running) {
+        // Sin hilo los eventos se escriben al finalizar, hasta la capacidad de la cola
+        printf("[EXEC_LOGGER] Aviso: no se pudo crear el hilo escritor\n");
+    }
     
-    logger_active = true;
+    __atomic_store_n(&logger_active, 1, __ATOMIC_RELEASE);
     
     printf("[EXEC_LOGGER] Sistema de logging inicializado: %s\n", current_log_path);
     
@@ -379,84 +524,63 @@ bool exec_logger_init(void) {
  * @brief Finaliza el sistema de logging de ejecuciones
  * 
  * Esta función cierra el sistema de logging escribiendo las estadísticas
- * finales y cerrando el archivo de log. También intenta generar un PDF
- * del reporte usando pandoc si está disponible.
+ * finales y cerrando el archivo de log. No genera el PDF: la conversión con
+ * pandoc tarda varios segundos y se hace fuera del gateway con exec_report
+ * o generate_pdf_report.sh.
  * 
  * **Operaciones realizadas:**
  * - Calcula la duración total de ejecución
- * - Escribe el footer Markdown con estadísticas finales
+ * - Detiene el hilo escritor y escribe los eventos pendientes
+ * - Resume los histogramas de latencia por etapa en las estadísticas
+ * - Escribe el cierre del archivo con las estadísticas finales
  * - Cierra el archivo de log
- * - Intenta generar PDF del reporte
  * - Marca el logger como inactivo
  * 
+ * Los productores de otros hilos pueden seguir llamando a las funciones de
+ * registro: los que ya reservaron una celda se esperan antes de liberar la
+ * cola y los posteriores ven el logger inactivo y descartan el evento.
+ * 
  * @see exec_logger_init()
  * @see exec_logger_is_active()
  */
 void exec_logger_finish(void) {
-    if (!logger_active || !log_file) return;
+    if (!logger_is_on() || !log_file) return;
     
     // Calcular duración final
-    time_t end_time = time(NULL);
-    stats.execution_duration_sec = difftime(end_time, start_time);
+    struct timespec end_time;
+    clock_gettime(CLOCK_REALTIME, &end_time);
+    stats.execution_duration_sec = (double)(monotonic_ns() - base_mono_ns) / 1e9;
     
     // Registrar evento de fin
     exec_logger_log_event(LOG_EVENT_SYSTEM_END, "Sistema API Gateway finalizado", "Cerrando logging de ejecución");
+    __atomic_store_n(&logger_active, 0, __ATOMIC_SEQ_CST);
+    
+    // La cola no se libera hasta que publique el último productor en curso
+    while (__atomic_load_n(&ring_producers, __ATOMIC_SEQ_CST) != 0) {
+        sched_yield();
+    }
+    
+    // Escribir los eventos que queden en la cola
+    stop_writer();
+    ring_drain();
+    free(ring);
+    ring = NULL;
+    
+    summarize_stage_latency();
+    stage_hist_destroy();
     
     // Escribir footer con estadísticas
-    write_markdown_footer();
+    exec_log_write_footer(log_file, log_format, &stats, &end_time);
     
     // Cerrar archivo
     fclose(log_file);
     log_file = NULL;
-    logger_active = false;
     
     printf("[EXEC_LOGGER] Reporte de ejecución guardado en: %s\n", current_log_path);
-    
-    // Generar PDF automáticamente usando rutas relativas correctas
-    char pdf_command[MAX_LOG_PATH + 512];
-    
-    // Determinar si tenemos el script de PDF disponible y desde dónde ejecutar
-    struct stat script_stat;
-    if (stat("../generate_pdf_report.sh", &script_stat) == 0) {
-        // Script está en el directorio padre (desde build/)
-        snprintf(pdf_command, sizeof(pdf_command), 
-                 "cd .. && ./generate_pdf_report.sh \"%s\" 2>/dev/null", current_log_path);
-        printf("[EXEC_LOGGER] Script encontrado en directorio padre\n");
-    } else if (stat("generate_pdf_report.sh", &script_stat) == 0) {
-        // Script está en el directorio actual
-        snprintf(pdf_command, sizeof(pdf_command), 
-                 "./generate_pdf_report.sh \"%s\" 2>/dev/null", current_log_path);
-        printf("[EXEC_LOGGER] Script encontrado en directorio actual\n");
-    } else {
-        // No se encontró el script
-        printf("[EXEC_LOGGER] Nota: Script de PDF no encontrado. Para generar PDF manualmente:\n");
-        printf("  cd ..\n");
-        printf("  chmod +x generate_pdf_report.sh\n");
-        printf("  ./generate_pdf_report.sh \"%s\"\n", current_log_path);
-        return;
-    }
-    
-    printf("[EXEC_LOGGER] Generando PDF automáticamente...\n");
-    int result = system(pdf_command);
-    
-    if (result == 0) {
-        // Generar nombre del archivo PDF
-        char pdf_path[MAX_LOG_PATH];
-        strncpy(pdf_path, current_log_path, sizeof(pdf_path) - 1);
-        pdf_path[sizeof(pdf_path) - 1] = '\0';
-        
-        // Cambiar extensión .md por .pdf
-        char *dot = strrchr(pdf_path, '.');
-        if (dot && strcmp(dot, ".md") == 0) {
-            strcpy(dot, ".pdf");
-            printf("[EXEC_LOGGER] ✓ PDF generado exitosamente: %s\n", pdf_path);
-            printf("[EXEC_LOGGER] Para visualizar: xdg-open \"%s\" o abrir con visor PDF\n", pdf_path);
-        }
+    if (log_format == EXEC_LOG_FORMAT_MARKDOWN) {
+        printf("[EXEC_LOGGER] Para generar el PDF: ./generate_pdf_report.sh \"%s\"\n", current_log_path);
     } else {
-        printf("[EXEC_LOGGER] Nota: Para generar PDF manualmente:\n");
-        printf("  cd ..\n");
-        printf("  chmod +x generate_pdf_report.sh\n");
-        printf("  ./generate_pdf_report.sh \"%s\"\n", current_log_path);
+        printf("[EXEC_LOGGER] Para generar el reporte: exec_report [--pdf] \"%s\"\n", current_log_path);
     }
 }
 
@@ -473,25 +597,16 @@ void exec_logger_finish(void) {
  * @see exec_logger_is_active()
  */
 void exec_logger_log_event(log_event_type_t type, const char* description, const char* details) {
-    if (!logger_active || !log_file || !description) return;
+    if (!logger_is_on() || !description) return;
     
-    char timestamp[32];
-    get_formatted_timestamp(timestamp, sizeof(timestamp), "%H:%M:%S.%f");
+    size_t ticket;
+    exec_log_record_t *rec = ring_claim(type, &ticket);
+    if (!rec) return;
     
-    const char* label = get_event_label(type);
-    
-    // Formato profesional para eventos
-    fprintf(log_file, "## Evento: %s\n\n", label);
-    fprintf(log_file, "**Timestamp:** %s  \n", timestamp);
-    fprintf(log_file, "**Descripción:** %s  \n", description);
-    
-    if (details && strlen(details) > 0) {
-        fprintf(log_file, "**Detalles:**\n\n");
-        fprintf(log_file, "```\n%s\n```\n", details);
-    }
-    
-    fprintf(log_file, "\n---\n\n");
-    fflush(log_file);
+    const char *strings[] = { description, details ? details : "" };
+    rec->generic = 1;
+    exec_log_pack_strings(rec, strings, 2);
+    ring_publish(ticket);
 }
 
 /**
@@ -505,15 +620,19 @@ void exec_logger_log_event(log_event_type_t type, const char* description, const
  * @see exec_logger_log_simulation_end()
  */
 void exec_logger_log_simulation_start(const char* building_id, int num_requests) {
-    if (!logger_active || !building_id) return;
+    if (!logger_is_on() || !building_id) return;
     
     strncpy(stats.building_id, building_id, sizeof(stats.building_id) - 1);
     stats.building_requests = num_requests;
     
-    char details[256];
-    snprintf(details, sizeof(details), "Edificio: %s\nPeticiones a ejecutar: %d", building_id, num_requests);
+    size_t ticket;
+    exec_log_record_t *rec = ring_claim(LOG_EVENT_SIMULATION_START, &ticket);
+    if (!rec) return;
     
-    exec_logger_log_event(LOG_EVENT_SIMULATION_START, "Iniciando simulación de ascensores", details);
+    const char *strings[] = { building_id };
+    rec->args[0] = num_requests;
+    exec_log_pack_strings(rec, strings, 1);
+    ring_publish(ticket);
 }
 
 /**
@@ -527,14 +646,15 @@ void exec_logger_log_simulation_start(const char* building_id, int num_requests)
  * @see exec_logger_log_simulation_start()
  */
 void exec_logger_log_simulation_end(int successful_requests, int total_requests) {
-    if (!logger_active) return;
+    if (!logger_is_on()) return;
     
-    char details[256];
-    snprintf(details, sizeof(details), "Peticiones exitosas: %d/%d\nTasa de éxito: %.1f%%", 
-             successful_requests, total_requests, 
-             total_requests > 0 ? (100.0 * successful_requests / total_requests) : 0.0);
+    size_t ticket;
+    exec_log_record_t *rec = ring_claim(LOG_EVENT_SIMULATION_END, &ticket);
+    if (!rec) return;
     
-    exec_logger_log_event(LOG_EVENT_SIMULATION_END, "Simulación completada", details);
+    rec->args[0] = successful_requests;
+    rec->args[1] = total_requests;
+    ring_publish(ticket);
 }
 
 /**
@@ -550,25 +670,10 @@ void exec_logger_log_simulation_end(int successful_requests, int total_requests)
  * @see exec_logger_log_can_received()
  */
 void exec_logger_log_can_sent(unsigned int can_id, int dlc, const unsigned char* data, const char* description) {
-    if (!logger_active) return;
-    
-    stats.total_can_frames_sent++;
-    
-    char details[512];
-    char data_str[256] = "";
-    
-    if (data && dlc > 0) {
-        char temp[8];
-        for (int i = 0; i < dlc && i < 8; i++) {
-            snprintf(temp, sizeof(temp), "%02X ", data[i]);
-            strcat(data_str, temp);
-        }
-    }
-    
-    snprintf(details, sizeof(details), "CAN ID: 0x%X\nDLC: %d\nDatos: %s\nDescripción: %s", 
-             can_id, dlc, data_str, description ? description : "N/A");
+    if (!logger_is_on()) return;
     
-    exec_logger_log_event(LOG_EVENT_CAN_SENT, "Frame CAN enviado", details);
+    __atomic_fetch_add(&stats.total_can_frames_sent, 1, __ATOMIC_RELAXED);
+    log_can_frame(LOG_EVENT_CAN_SENT, can_id, dlc, data, description);
 }
 
 /**
@@ -584,25 +689,10 @@ void exec_logger_log_can_sent(unsigned int can_id, int dlc, const unsigned char*
  * @see exec_logger_log_can_sent()
  */
 void exec_logger_log_can_received(unsigned int can_id, int dlc, const unsigned char* data, const char* description) {
-    if (!logger_active) return;
-    
-    stats.total_can_frames_received++;
-    
-    char details[512];
-    char data_str[256] = "";
-    
-    if (data && dlc > 0) {
-        char temp[8];
-        for (int i = 0; i < dlc && i < 8; i++) {
-            snprintf(temp, sizeof(temp), "%02X ", data[i]);
-            strcat(data_str, temp);
-        }
-    }
+    if (!logger_is_on()) return;
     
-    snprintf(details, sizeof(details), "CAN ID: 0x%X\nDLC: %d\nDatos: %s\nDescripción: %s", 
-             can_id, dlc, data_str, description ? description : "N/A");
-    
-    exec_logger_log_event(LOG_EVENT_CAN_RECEIVED, "Frame CAN recibido", details);
+    __atomic_fetch_add(&stats.total_can_frames_received, 1, __ATOMIC_RELAXED);
+    log_can_frame(LOG_EVENT_CAN_RECEIVED, can_id, dlc, data, description);
 }
 
 /**
@@ -617,40 +707,51 @@ void exec_logger_log_can_received(unsigned int can_id, int dlc, const unsigned c
  * @see exec_logger_log_coap_received()
  */
 void exec_logger_log_coap_sent(const char* method, const char* uri, const char* payload) {
-    if (!logger_active) return;
+    if (!logger_is_on()) return;
     
-    stats.total_coap_requests++;
+    __atomic_fetch_add(&stats.total_coap_requests, 1, __ATOMIC_RELAXED);
     
-    char details[1024];
-    snprintf(details, sizeof(details), "Método: %s\nURI: %s\nPayload: %s", 
-             method ? method : "N/A", 
-             uri ? uri : "N/A", 
-             payload ? payload : "N/A");
+    size_t ticket;
+    exec_log_record_t *rec = ring_claim(LOG_EVENT_COAP_SENT, &ticket);
+    if (!rec) return;
     
-    exec_logger_log_event(LOG_EVENT_COAP_SENT, "Petición CoAP enviada", details);
+    const char *strings[] = { method, uri, payload };
+    exec_log_pack_strings(rec, strings, 3);
+    ring_publish(ticket);
 }
 
 /**
  * @brief Registra la recepción de un mensaje CoAP
- * @param code Código de respuesta CoAP (2.01, 4.04, etc.)
- * @param payload Payload del mensaje CoAP (puede ser NULL)
+ * @param code Código de respuesta CoAP sin formatear (clase << 5 | detalle)
+ * @param payload Payload de la PDU, sin terminador (puede ser NULL)
+ * @param payload_len Bytes de @p payload
  * 
  * Esta función registra la recepción de mensajes CoAP con información
- * del código de respuesta y payload para análisis de tráfico.
+ * del código de respuesta y payload para análisis de tráfico. El código
+ * viaja en args[0] y el payload se copia tal cual al área de texto.
  * 
  * @see exec_logger_log_coap_sent()
  */
-void exec_logger_log_coap_received(const char* code, const char* payload) {
-    if (!logger_active) return;
+void exec_logger_log_coap_received(unsigned int code, const uint8_t *payload, size_t payload_len) {
+    if (!logger_is_on()) return;
     
-    stats.total_coap_responses++;
+    __atomic_fetch_add(&stats.total_coap_responses, 1, __ATOMIC_RELAXED);
     
-    char details[1024];
-    snprintf(details, sizeof(details), "Código: %s\nPayload: %s", 
-             code ? code : "N/A", 
-             payload ? payload : "N/A");
+    size_t ticket;
+    exec_log_record_t *rec = ring_claim(LOG_EVENT_COAP_RECEIVED, &ticket);
+    if (!rec) return;
     
-    exec_logger_log_event(LOG_EVENT_COAP_RECEIVED, "Respuesta CoAP recibida", details);
+    rec->args[0] = (int)code;
+    if (payload && payload_len > 0) {
+        size_t len = payload_len < EXEC_LOG_TEXT_SIZE - 1 ? payload_len : EXEC_LOG_TEXT_SIZE - 1;
+        if (len < payload_len) rec->truncated = 1;
+        memcpy(rec->text, payload, len);
+        rec->text[len] = '\0';
+    } else {
+        const char *strings[] = { NULL };
+        exec_log_pack_strings(rec, strings, 1);
+    }
+    ring_publish(ticket);
 }
 
 /**
@@ -665,17 +766,18 @@ void exec_logger_log_coap_received(const char* code, const char* payload) {
  * @see exec_logger_log_task_completed()
  */
 void exec_logger_log_task_assigned(const char* task_id, const char* elevator_id, int target_floor) {
-    if (!logger_active) return;
+    if (!logger_is_on()) return;
     
-    stats.total_tasks_assigned++;
+    __atomic_fetch_add(&stats.total_tasks_assigned, 1, __ATOMIC_RELAXED);
     
-    char details[256];
-    snprintf(details, sizeof(details), "Tarea: %s\nAscensor: %s\nPiso destino: %d", 
-             task_id ? task_id : "N/A", 
-             elevator_id ? elevator_id : "N/A", 
-             target_floor);
+    size_t ticket;
+    exec_log_record_t *rec = ring_claim(LOG_EVENT_TASK_ASSIGNED, &ticket);
+    if (!rec) return;
     
-    exec_logger_log_event(LOG_EVENT_TASK_ASSIGNED, "Tarea asignada a ascensor", details);
+    const char *strings[] = { task_id, elevator_id };
+    rec->args[0] = target_floor;
+    exec_log_pack_strings(rec, strings, 2);
+    ring_publish(ticket);
 }
 
 /**
@@ -691,17 +793,19 @@ void exec_logger_log_task_assigned(const char* task_id, const char* elevator_id,
  * @see exec_logger_log_task_assigned()
  */
 void exec_logger_log_elevator_moved(const char* elevator_id, int from_floor, int to_floor, const char* direction) {
-    if (!logger_active) return;
+    if (!logger_is_on()) return;
     
-    stats.total_elevator_movements++;
+    __atomic_fetch_add(&stats.total_elevator_movements, 1, __ATOMIC_RELAXED);
     
-    char details[256];
-    snprintf(details, sizeof(details), "Ascensor: %s\nDesde piso: %d\nHacia piso: %d\nDirección: %s", 
-             elevator_id ? elevator_id : "N/A", 
-             from_floor, to_floor, 
-             direction ? direction : "N/A");
+    size_t ticket;
+    exec_log_record_t *rec = ring_claim(LOG_EVENT_ELEVATOR_MOVED, &ticket);
+    if (!rec) return;
     
-    exec_logger_log_event(LOG_EVENT_ELEVATOR_MOVED, "Ascensor en movimiento", details);
+    const char *strings[] = { elevator_id, direction };
+    rec->args[0] = from_floor;
+    rec->args[1] = to_floor;
+    exec_log_pack_strings(rec, strings, 2);
+    ring_publish(ticket);
 }
 
 /**
@@ -716,17 +820,18 @@ void exec_logger_log_elevator_moved(const char* elevator_id, int from_floor, int
  * @see exec_logger_log_task_assigned()
  */
 void exec_logger_log_task_completed(const char* task_id, const char* elevator_id, int final_floor) {
-    if (!logger_active) return;
+    if (!logger_is_on()) return;
     
-    stats.total_tasks_completed++;
+    __atomic_fetch_add(&stats.total_tasks_completed, 1, __ATOMIC_RELAXED);
     
-    char details[256];
-    snprintf(details, sizeof(details), "Tarea: %s\nAscensor: %s\nPiso final: %d", 
-             task_id ? task_id : "N/A", 
-             elevator_id ? elevator_id : "N/A", 
-             final_floor);
+    size_t ticket;
+    exec_log_record_t *rec = ring_claim(LOG_EVENT_TASK_COMPLETED, &ticket);
+    if (!rec) return;
     
-    exec_logger_log_event(LOG_EVENT_TASK_COMPLETED, "Tarea completada", details);
+    const char *strings[] = { task_id, elevator_id };
+    rec->args[0] = final_floor;
+    exec_log_pack_strings(rec, strings, 2);
+    ring_publish(ticket);
 }
 
 /**
@@ -740,16 +845,52 @@ void exec_logger_log_task_completed(const char* task_id, const char* elevator_id
  * @see exec_logger_log_event()
  */
 void exec_logger_log_error(const char* error_code, const char* error_message) {
-    if (!logger_active) return;
+    if (!logger_is_on()) return;
+    
+    __atomic_fetch_add(&stats.total_errors, 1, __ATOMIC_RELAXED);
     
-    stats.total_errors++;
+    size_t ticket;
+    exec_log_record_t *rec = ring_claim(LOG_EVENT_ERROR, &ticket);
+    if (!rec) return;
+    
+    const char *strings[] = { error_code, error_message };
+    exec_log_pack_strings(rec, strings, 2);
+    ring_publish(ticket);
+}
+
+/**
+ * @brief Registra las latencias de una solicitud completada
+ * @param span Instantes de la solicitud
+ * @param outcome Desenlace de la solicitud
+ * 
+ * Se llama una vez por solicitud al enviar la respuesta CAN, así que un
+ * mutex basta; las rutas de eventos siguen sin bloqueos. Las solicitudes
+ * expiradas o respondidas localmente solo se cuentan: mezclarlas con las
+ * servidas falsearía la contribución del gateway (total - servidor).
+ * 
+ * @see request_span.h
+ */
+void exec_logger_record_request_span(const gw_request_span_t *span, gw_span_outcome_t outcome) {
+    if (!logger_is_on() || !span) return;
     
-    char details[512];
-    snprintf(details, sizeof(details), "Código: %s\nMensaje: %s", 
-             error_code ? error_code : "N/A", 
-             error_message ? error_message : "N/A");
+    if (outcome == GW_SPAN_OUTCOME_TIMED_OUT) {
+        __atomic_fetch_add(&stats.requests_timed_out, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    if (outcome == GW_SPAN_OUTCOME_LOCAL) {
+        __atomic_fetch_add(&stats.requests_answered_locally, 1, __ATOMIC_RELAXED);
+        return;
+    }
     
-    exec_logger_log_event(LOG_EVENT_ERROR, "Error del sistema", details);
+    pthread_mutex_lock(&stage_hist_lock);
+    for (int i = 0; stage_hist_ready && i < GW_SPAN_STAGE_COUNT; i++) {
+        uint64_t from = span->ns[stage_points[i][0]];
+        uint64_t to = span->ns[stage_points[i][1]];
+        if (from != 0 && to >= from) {
+            gw_latency_hist_record(&stage_hist[i], (to - from) / 1000u);
+        }
+    }
+    pthread_mutex_unlock(&stage_hist_lock);
 }
 
 /**
@@ -757,12 +898,14 @@ void exec_logger_log_error(const char* error_code, const char* error_message) {
  * @return Puntero a las estadísticas actuales, o NULL si el logger no está activo
  * 
  * Esta función proporciona acceso de solo lectura a las estadísticas
- * actuales del sistema de logging para monitoreo en tiempo real.
+ * actuales del sistema de logging para monitoreo en tiempo real. Los
+ * percentiles de latencia se recalculan en cada llamada.
  * 
  * @see execution_stats_t
  * @see exec_logger_is_active()
  */
 const execution_stats_t* exec_logger_get_stats(void) {
+    summarize_stage_latency();
     return &stats;
 }
 
@@ -777,5 +920,5 @@ const execution_stats_t* exec_logger_get_stats(void) {
  * @see exec_logger_finish()
  */
 bool exec_logger_is_active(void) {
-    return logger_active;
+    return logger_is_on();
 } 
\ No newline at end of file
@@ -0,0 +1,439 @@
+/**
+ * @file gateway_config.c
+ * @brief Implementación de la configuración tipada del API Gateway
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * gateway.env se interpreta aquí directamente (líneas CLAVE=valor, '#' para
+ * comentarios) para poder releerlo en una recarga sin depender del orden en
+ * que otras bibliotecas cargaron el entorno.
+ *
+ * @see gateway_config.h
+ */
+
+#include "api_gateway/gateway_config.h"
+#include "api_gateway/coap_config.h"
+#include "api_gateway/logging_gw.h"
+
+#include <arpa/inet.h>
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Entradas máximas leídas de gateway.env
+ */
+#define GW_CONFIG_MAX_ENTRIES 64
+
+/**
+ * @brief Par CLAVE=valor de gateway.env
+ */
+typedef struct {
+    char key[48];                     ///< Clave
+    char value[GW_CONFIG_FILE_MAX];   ///< Valor recortado
+} config_entry_t;
+
+/**
+ * @brief Contenido de gateway.env
+ */
+typedef struct {
+    config_entry_t entries[GW_CONFIG_MAX_ENTRIES]; ///< Entradas en orden de aparición
+    int count;                                     ///< Entradas válidas
+} config_source_t;
+
+static gw_config_t *current_config = NULL;   ///< Configuración instalada (NULL: valores por defecto)
+static gw_config_t *retired_config = NULL;   ///< Configuración sustituida en la última recarga
+static gw_config_t default_config;           ///< Valores por defecto de coap_config.h
+static bool default_config_ready = false;    ///< default_config construida
+static uint32_t config_generation = 0;       ///< Última generación instalada
+static char config_env_file[GW_CONFIG_FILE_MAX]; ///< Fichero de la carga inicial
+static uint16_t config_port_override = 0;    ///< Puerto de la línea de comandos
+static volatile sig_atomic_t config_reload_requested = 0; ///< SIGHUP recibido
+
+/**
+ * @brief Recorta espacios y saltos de línea en el sitio
+ * @return Inicio de la cadena recortada
+ */
+static char* trim(char *s) {
+    while (isspace((unsigned char)*s)) s++;
+    size_t len = strlen(s);
+    while (len > 0 && isspace((unsigned char)s[len - 1])) s[--len] = '\0';
+    return s;
+}
+
+/**
+ * @brief Lee gateway.env
+ * @return true si el fichero existe (aunque esté vacío)
+ */
+static bool config_source_read(config_source_t *src, const char *path) {
+    src->count = 0;
+    FILE *f = path ? fopen(path, "r") : NULL;
+    if (!f) {
+        return false;
+    }
+    char line[512];
+    while (fgets(line, sizeof(line), f)) {
+        char *p = trim(line);
+        if (*p == '\0' || *p == '#') continue;
+        if (strncmp(p, "export ", 7) == 0) p = trim(p + 7);
+        char *eq = strchr(p, '=');
+        if (!eq) continue;
+        *eq = '\0';
+        char *key = trim(p);
+        char *value = trim(eq + 1);
+        size_t vlen = strlen(value);
+        if (vlen >= 2 && (value[0] == '"' || value[0] == '\'') && value[vlen - 1] == value[0]) {
+            value[vlen - 1] = '\0';
+            value++;
+        }
+        if (*key == '\0' || strlen(key) >= sizeof(src->entries[0].key)) continue;
+        if (src->count == GW_CONFIG_MAX_ENTRIES) {
+            LOG_WARN_GW("[Config] %s: más de %d entradas; se ignora '%s'.", path, GW_CONFIG_MAX_ENTRIES, key);
+            continue;
+        }
+        config_entry_t *entry = &src->entries[src->count++];
+        snprintf(entry->key, sizeof(entry->key), "%s", key);
+        snprintf(entry->value, sizeof(entry->value), "%s", value);
+    }
+    fclose(f);
+    return true;
+}
+
+/**
+ * @brief Valor de una clave: gateway.env, después el entorno del proceso
+ * @param buf Buffer para el valor recortado del entorno
+ * @return Valor recortado, o NULL si no está definida
+ */
+static const char* config_lookup(const config_source_t *src, const char *key, char *buf, size_t buf_size) {
+    if (src) {
+        // La última aparición gana, como al cargar el fichero en el entorno
+        for (int i = src->count - 1; i >= 0; --i) {
+            if (strcmp(src->entries[i].key, key) == 0) {
+                return src->entries[i].value;
+            }
+        }
+        const char *env = getenv(key);
+        if (env) {
+            snprintf(buf, buf_size, "%s", env);
+            return trim(buf);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Copia una cadena comprobando que cabe
+ */
+static bool config_copy_string(char *dst, size_t dst_size, const char *value, const char *key) {
+    if (strlen(value) >= dst_size) {
+        LOG_ERROR_GW("[Config] %s demasiado largo (máximo %zu caracteres): '%s'", key, dst_size - 1, value);
+        return false;
+    }
+    memcpy(dst, value, strlen(value) + 1);
+    return true;
+}
+
+/**
+ * @brief Interpreta un entero sin signo en [min, max]
+ */
+static bool config_parse_uint(const char *value, unsigned long min, unsigned long max, unsigned long *out, const char *key) {
+    char *end = NULL;
+    errno = 0;
+    unsigned long parsed = strtoul(value, &end, 10);
+    if (errno != 0 || end == value || *end != '\0' || value[0] == '-' || parsed < min || parsed > max) {
+        LOG_ERROR_GW("[Config] %s inválido: '%s' (se espera un entero entre %lu y %lu)", key, value, min, max);
+        return false;
+    }
+    *out = parsed;
+    return true;
+}
+
+/**
+ * @brief Interpreta un número real en (min, max]
+ */
+static bool config_parse_double(const char *value, double min, double max, double *out, const char *key) {
+    char *end = NULL;
+    errno = 0;
+    double parsed = strtod(value, &end);
+    if (errno != 0 || end == value || *end != '\0' || !(parsed > min && parsed <= max)) {
+        LOG_ERROR_GW("[Config] %s inválido: '%s' (se espera un número mayor que %g y hasta %g)", key, value, min, max);
+        return false;
+    }
+    *out = parsed;
+    return true;
+}
+
+/**
+ * @brief Comprueba una dirección IPv4 en texto
+ */
+static bool config_parse_ip(char *dst, const char *value, const char *key) {
+    struct in_addr addr;
+    if (inet_pton(AF_INET, value, &addr) != 1) {
+        LOG_ERROR_GW("[Config] %s no es una dirección IPv4 válida: '%s'", key, value);
+        return false;
+    }
+    return config_copy_string(dst, GW_CONFIG_IP_MAX, value, key);
+}
+
+/**
+ * @brief Normaliza la ruta de un recurso y la divide en segmentos Uri-Path
+ *
+ * Acepta la ruta con o sin '/' inicial o final. Rechaza segmentos vacíos,
+ * consultas ('?') y fragmentos ('#').
+ */
+static bool config_parse_uri_path(gw_uri_path_t *out, const char *value, const char *key) {
+    memset(out, 0, sizeof(*out));
+    while (*value == '/') value++;
+    size_t len = strlen(value);
+    while (len > 0 && value[len - 1] == '/') len--;
+    if (len == 0 || len + 1 >= sizeof(out->path) || memchr(value, '?', len) || memchr(value, '#', len)) {
+        LOG_ERROR_GW("[Config] %s no es una ruta de recurso válida: '%s'", key, value);
+        return false;
+    }
+
+    out->path[0] = '/';
+    memcpy(out->path + 1, value, len);
+    out->path[len + 1] = '\0';
+
+    size_t start = 1;
+    for (size_t i = 1; i <= len + 1; ++i) {
+        if (out->path[i] != '/' && out->path[i] != '\0') continue;
+        if (i == start || out->num_segments == GW_CONFIG_URI_MAX_SEGMENTS) {
+            LOG_ERROR_GW("[Config] %s: segmento vacío o más de %d segmentos en '%s'", key, GW_CONFIG_URI_MAX_SEGMENTS, out->path);
+            return false;
+        }
+        out->segment_offset[out->num_segments] = (uint8_t)start;
+        out->segment_len[out->num_segments] = (uint8_t)(i - start);
+        out->num_segments++;
+        start = i + 1;
+    }
+    return true;
+}
+
+/**
+ * @brief Construye y valida una configuración
+ * @param src Contenido de gateway.env, o NULL para usar solo los valores por defecto
+ * @param listen_port_override Puerto de la línea de comandos (0 = ninguno)
+ * @return true si todos los valores son válidos
+ */
+static bool config_build(gw_config_t *cfg, const config_source_t *src, uint16_t listen_port_override) {
+    char buf[GW_CONFIG_FILE_MAX];
+    const char *value;
+    unsigned long number;
+    bool ok = true;
+
+    memset(cfg, 0, sizeof(*cfg));
+
+#define CONFIG_STR_(x) #x
+#define CONFIG_STR(x) CONFIG_STR_(x)
+#define CONFIG_VALUE(key, fallback) \
+    ((value = config_lookup(src, key, buf, sizeof(buf))) != NULL ? value : (fallback))
+
+    ok &= config_parse_ip(cfg->listen_ip, CONFIG_VALUE("GW_LISTEN_IP", GW_LISTEN_IP), "GW_LISTEN_IP");
+    if (config_parse_uint(CONFIG_VALUE("GW_LISTEN_PORT", GW_LISTEN_PORT), 1, 65535, &number, "GW_LISTEN_PORT")) {
+        cfg->listen_port = (uint16_t)number;
+    } else {
+        ok = false;
+    }
+    if (listen_port_override) {
+        cfg->listen_port = listen_port_override;
+    }
+    ok &= config_copy_string(cfg->can_interface, sizeof(cfg->can_interface), CONFIG_VALUE("GW_CAN_INTERFACE", ""), "GW_CAN_INTERFACE");
+    ok &= config_copy_string(cfg->state_file, sizeof(cfg->state_file), CONFIG_VALUE("GW_STATE_FILE", ""), "GW_STATE_FILE");
+    ok &= config_copy_string(cfg->journal_file, sizeof(cfg->journal_file), CONFIG_VALUE("GW_JOURNAL_FILE", ""), "GW_JOURNAL_FILE");
+    if (config_parse_uint(CONFIG_VALUE("GW_SIM_NUM_BUILDINGS", "1"), 1, 65535, &number, "GW_SIM_NUM_BUILDINGS")) {
+        cfg->sim_num_buildings = (int)number;
+    } else {
+        ok = false;
+    }
+    ok &= config_copy_string(cfg->sim_scenario_file, sizeof(cfg->sim_scenario_file),
+                             CONFIG_VALUE("GW_SIM_SCENARIO_FILE", "simulation_data.json"), "GW_SIM_SCENARIO_FILE");
+
+    if (config_parse_uint(CONFIG_VALUE("GW_SIM_TICK_MS", CONFIG_STR(GW_SIM_DEFAULT_TICK_MS)), 1, 1000, &number, "GW_SIM_TICK_MS")) {
+        cfg->sim_tick_ms = (uint32_t)number;
+    } else {
+        ok = false;
+    }
+    if (config_parse_uint(CONFIG_VALUE("GW_SIM_SEED", "0"), 0, ULONG_MAX, &number, "GW_SIM_SEED")) {
+        cfg->sim_seed = (uint64_t)number;
+    } else {
+        ok = false;
+    }
+
+    ok &= config_parse_ip(cfg->central_server_ip, CONFIG_VALUE("CENTRAL_SERVER_IP", CENTRAL_SERVER_IP), "CENTRAL_SERVER_IP");
+    if (config_parse_uint(CONFIG_VALUE("CENTRAL_SERVER_PORT", CENTRAL_SERVER_PORT), 1, 65535, &number, "CENTRAL_SERVER_PORT")) {
+        cfg->central_server_port = (uint16_t)number;
+    } else {
+        ok = false;
+    }
+    if (src && (value = config_lookup(src, "COAP_REQUEST_TIMEOUT_MS", buf, sizeof(buf))) != NULL) {
+        ok &= config_parse_uint(value, 1, 3600000, &number, "COAP_REQUEST_TIMEOUT_MS");
+        cfg->coap_request_timeout_ms = (uint32_t)number;
+    } else {
+        cfg->coap_request_timeout_ms = COAP_REQUEST_TIMEOUT_MS;
+    }
+    if (src && (value = config_lookup(src, "COAP_MAX_RETRIES", buf, sizeof(buf))) != NULL) {
+        ok &= config_parse_uint(value, 0, 100, &number, "COAP_MAX_RETRIES");
+        cfg->coap_max_retries = (uint32_t)number;
+    } else {
+        cfg->coap_max_retries = COAP_MAX_RETRIES;
+    }
+    ok &= config_parse_uri_path(&cfg->floor_call_path, CONFIG_VALUE("FLOOR_CALL_RESOURCE", FLOOR_CALL_RESOURCE), "FLOOR_CALL_RESOURCE");
+    ok &= config_parse_uri_path(&cfg->cabin_request_path, CONFIG_VALUE("CABIN_REQUEST_RESOURCE", CABIN_REQUEST_RESOURCE), "CABIN_REQUEST_RESOURCE");
+
+    gw_sim_params_t *sim = &cfg->sim;
+    ok &= config_parse_double(CONFIG_VALUE("GW_SIM_SPEED_MPS", CONFIG_STR(GW_SIM_DEFAULT_SPEED_MPS)), 0.0, 20.0, &sim->speed_mps, "GW_SIM_SPEED_MPS");
+    ok &= config_parse_double(CONFIG_VALUE("GW_SIM_ACCEL_MPS2", CONFIG_STR(GW_SIM_DEFAULT_ACCEL_MPS2)), 0.0, 10.0, &sim->acceleration_mps2, "GW_SIM_ACCEL_MPS2");
+    ok &= config_parse_double(CONFIG_VALUE("GW_SIM_FLOOR_HEIGHT_M", CONFIG_STR(GW_SIM_DEFAULT_FLOOR_HEIGHT_M)), 0.0, 20.0, &sim->floor_height_m, "GW_SIM_FLOOR_HEIGHT_M");
+    if (config_parse_uint(CONFIG_VALUE("GW_SIM_DOOR_OPEN_MS", CONFIG_STR(GW_SIM_DEFAULT_DOOR_OPEN_MS)), 0, 60000, &number, "GW_SIM_DOOR_OPEN_MS")) {
+        sim->door_open_ms = (uint32_t)number;
+    } else {
+        ok = false;
+    }
+    if (config_parse_uint(CONFIG_VALUE("GW_SIM_DOOR_DWELL_MS", CONFIG_STR(GW_SIM_DEFAULT_DOOR_DWELL_MS)), 0, 600000, &number, "GW_SIM_DOOR_DWELL_MS")) {
+        sim->door_dwell_ms = (uint32_t)number;
+    } else {
+        ok = false;
+    }
+    if (config_parse_uint(CONFIG_VALUE("GW_SIM_DOOR_CLOSE_MS", CONFIG_STR(GW_SIM_DEFAULT_DOOR_CLOSE_MS)), 0, 60000, &number, "GW_SIM_DOOR_CLOSE_MS")) {
+        sim->door_close_ms = (uint32_t)number;
+    } else {
+        ok = false;
+    }
+    ok &= config_parse_double(CONFIG_VALUE("GW_SIM_PLAYBACK_SPEED", CONFIG_STR(GW_SIM_DEFAULT_PLAYBACK_SPEED)), 0.0, 1000.0,
+                              &cfg->sim_playback_speed, "GW_SIM_PLAYBACK_SPEED");
+
+#undef CONFIG_VALUE
+#undef CONFIG_STR
+#undef CONFIG_STR_
+    return ok;
+}
+
+/**
+ * @brief Sustituye la configuración actual con un único cambio de puntero
+ *
+ * La configuración sustituida se conserva hasta la siguiente recarga para
+ * que un lector que aún la use no lea memoria liberada.
+ */
+static void config_install(gw_config_t *cfg) {
+    cfg->generation = ++config_generation;
+    gw_config_t *previous = __atomic_exchange_n(&current_config, cfg, __ATOMIC_ACQ_REL);
+    free(retired_config);
+    retired_config = previous;
+}
+
+/**
+ * @brief Lee el fichero y construye una configuración nueva
+ * @return Configuración válida reservada en el heap, o NULL
+ */
+static gw_config_t* config_load_new(const char *env_file, uint16_t listen_port_override) {
+    config_source_t *src = calloc(1, sizeof(*src));
+    gw_config_t *cfg = malloc(sizeof(*cfg));
+    if (!src || !cfg) {
+        LOG_ERROR_GW("[Config] Sin memoria para cargar la configuración.");
+        free(src);
+        free(cfg);
+        return NULL;
+    }
+    if (!config_source_read(src, env_file)) {
+        LOG_WARN_GW("[Config] No se pudo leer '%s'. Se usan el entorno y los valores por defecto.", env_file ? env_file : "(null)");
+    }
+    bool ok = config_build(cfg, src, listen_port_override);
+    free(src);
+    if (!ok) {
+        free(cfg);
+        return NULL;
+    }
+    return cfg;
+}
+
+int gw_config_load(const char *env_file, uint16_t listen_port_override) {
+    snprintf(config_env_file, sizeof(config_env_file), "%s", env_file ? env_file : "");
+    config_port_override = listen_port_override;
+
+    gw_config_t *cfg = config_load_new(env_file, listen_port_override);
+    if (!cfg) {
+        LOG_ERROR_GW("[Config] Configuración de '%s' inválida.", config_env_file);
+        return -1;
+    }
+    config_install(cfg);
+    LOG_INFO_GW("[Config] Configuración cargada: escucha %s:%u, servidor central %s:%u, recursos %s y %s.",
+                cfg->listen_ip, cfg->listen_port, cfg->central_server_ip, cfg->central_server_port,
+                cfg->floor_call_path.path, cfg->cabin_request_path.path);
+    return 0;
+}
+
+const gw_config_t* gw_config(void) {
+    const gw_config_t *cfg = __atomic_load_n(&current_config, __ATOMIC_ACQUIRE);
+    if (cfg) {
+        return cfg;
+    }
+    if (!default_config_ready) {
+        config_build(&default_config, NULL, 0);
+        default_config_ready = true;
+    }
+    return &default_config;
+}
+
+int gw_config_reload(void) {
+    gw_config_t *cfg = config_load_new(config_env_file, config_port_override);
+    if (!cfg) {
+        LOG_ERROR_GW("[Config] Recarga de '%s' rechazada: se mantiene la configuración actual.", config_env_file);
+        return -1;
+    }
+
+    // Los campos de arranque se conservan: cambiarlos exige reiniciar
+    const gw_config_t *old = gw_config();
+    if (strcmp(old->listen_ip, cfg->listen_ip) != 0 || old->listen_port != cfg->listen_port ||
+        strcmp(old->can_interface, cfg->can_interface) != 0 || strcmp(old->state_file, cfg->state_file) != 0 ||
+        strcmp(old->journal_file, cfg->journal_file) != 0 || old->sim_num_buildings != cfg->sim_num_buildings ||
+        strcmp(old->sim_scenario_file, cfg->sim_scenario_file) != 0 || old->sim_tick_ms != cfg->sim_tick_ms ||
+        old->sim_seed != cfg->sim_seed) {
+        LOG_WARN_GW("[Config] Escucha, interfaz CAN, ficheros, número de edificios, paso de simulación y semilla solo cambian al reiniciar.");
+    }
+    memcpy(cfg->listen_ip, old->listen_ip, sizeof(cfg->listen_ip));
+    cfg->listen_port = old->listen_port;
+    memcpy(cfg->can_interface, old->can_interface, sizeof(cfg->can_interface));
+    memcpy(cfg->state_file, old->state_file, sizeof(cfg->state_file));
+    memcpy(cfg->journal_file, old->journal_file, sizeof(cfg->journal_file));
+    cfg->sim_num_buildings = old->sim_num_buildings;
+    memcpy(cfg->sim_scenario_file, old->sim_scenario_file, sizeof(cfg->sim_scenario_file));
+    cfg->sim_tick_ms = old->sim_tick_ms;
+    cfg->sim_seed = old->sim_seed;
+
+    config_install(cfg);
+    LOG_INFO_GW("[Config] Configuración recargada (generación %u): servidor central %s:%u, timeout %u ms x %u reintentos.",
+                cfg->generation, cfg->central_server_ip, cfg->central_server_port,
+                cfg->coap_request_timeout_ms, cfg->coap_max_retries);
+    return 0;
+}
+
+void gw_config_handle_sighup(int signum) {
+    (void)signum;
+    config_reload_requested = 1;
+}
+
+bool gw_config_reload_if_requested(void) {
+    if (!config_reload_requested) {
+        return false;
+    }
+    config_reload_requested = 0;
+    return gw_config_reload() == 0;
+}
+
+uint64_t gw_config_request_lifetime_ms(const gw_config_t *config) {
+    return (uint64_t)config->coap_request_timeout_ms * ((uint64_t)config->coap_max_retries + 1);
+}
+
+void gw_config_cleanup(void) {
+    gw_config_t *cfg = __atomic_exchange_n(&current_config, NULL, __ATOMIC_ACQ_REL);
+    free(cfg);
+    free(retired_config);
+    retired_config = NULL;
+    config_reload_requested = 0;
+}
@@ -0,0 +1,107 @@
+/**
+ * @file hall_call_registry.c
+ * @brief Implementación del registro de llamadas de piso activas
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * @see hall_call_registry.h
+ */
+
+#include "api_gateway/hall_call_registry.h"
+#include "api_gateway/logging_gw.h"
+
+#include <string.h>
+
+/**
+ * @brief Calcula el bit de una llamada de piso
+ * @param floor Piso de la llamada
+ * @param direction Dirección solicitada
+ * @return Posición del bit, o -1 si piso o dirección no son válidos
+ */
+static int hall_call_bit(int floor, movement_direction_enum_t direction) {
+    if (floor < 0 || floor >= GW_HALL_CALL_MAX_FLOORS) return -1;
+    if (direction == MOVING_UP) return floor * 2;
+    if (direction == MOVING_DOWN) return floor * 2 + 1;
+    return -1;
+}
+
+static inline bool bit_test(const uint64_t *set, int bit) {
+    return (set[bit >> 6] >> (bit & 63)) & 1u;
+}
+
+static inline void bit_set(uint64_t *set, int bit) {
+    set[bit >> 6] |= UINT64_C(1) << (bit & 63);
+}
+
+static inline void bit_clear(uint64_t *set, int bit) {
+    set[bit >> 6] &= ~(UINT64_C(1) << (bit & 63));
+}
+
+void gw_hall_call_table_reset(gw_hall_call_table_t *table) {
+    if (!table) return;
+    memset(table, 0, sizeof(*table));
+    memset(table->assigned_elevator, GW_HALL_CALL_NO_ELEVATOR, sizeof(table->assigned_elevator));
+}
+
+gw_hall_call_status_t gw_hall_call_check(gw_hall_call_table_t *table,
+                                         const elevator_group_state_t *group,
+                                         int floor,
+                                         movement_direction_enum_t direction,
+                                         int *elevator_index_out) {
+    int bit = hall_call_bit(floor, direction);
+    if (!table || bit < 0) {
+        return GW_HALL_CALL_NEW;
+    }
+
+    if (bit_test(table->pending, bit)) {
+        table->coalesced_pending++;
+        return GW_HALL_CALL_PENDING;
+    }
+
+    if (bit_test(table->assigned, bit)) {
+        int idx = table->assigned_elevator[floor][bit & 1];
+        // La asignación sigue vigente mientras el ascensor vaya hacia este piso
+        if (group && idx < group->num_elevadores_en_grupo &&
+            group->ocupado[idx] &&
+            group->destino_actual[idx] == floor) {
+            if (elevator_index_out) *elevator_index_out = idx;
+            table->answered_locally++;
+            return GW_HALL_CALL_ASSIGNED;
+        }
+        bit_clear(table->assigned, bit);
+        table->assigned_elevator[floor][bit & 1] = GW_HALL_CALL_NO_ELEVATOR;
+    }
+
+    return GW_HALL_CALL_NEW;
+}
+
+void gw_hall_call_mark_pending(gw_hall_call_table_t *table, int floor, movement_direction_enum_t direction) {
+    int bit = hall_call_bit(floor, direction);
+    if (!table || bit < 0) return;
+    bit_set(table->pending, bit);
+}
+
+void gw_hall_call_resolve(gw_hall_call_table_t *table,
+                          const elevator_group_state_t *group,
+                          int floor,
+                          movement_direction_enum_t direction,
+                          const char *assigned_elevator_id) {
+    int bit = hall_call_bit(floor, direction);
+    if (!table || bit < 0) return;
+
+    bit_clear(table->pending, bit);
+    bit_clear(table->assigned, bit);
+    table->assigned_elevator[floor][bit & 1] = GW_HALL_CALL_NO_ELEVATOR;
+
+    if (!group || !assigned_elevator_id) {
+        return;
+    }
+    int index = elevator_group_find_index(group, assigned_elevator_id);
+    if (index >= 0) {
+        bit_set(table->assigned, bit);
+        table->assigned_elevator[floor][bit & 1] = (uint8_t)index;
+        LOG_DEBUG_GW("[HallCalls] Llamada piso %d %s asignada a %s.", floor,
+                     movement_direction_to_string(direction), assigned_elevator_id);
+    }
+}
@@ -0,0 +1,596 @@
+/**
+ * @file headless_sim.c
+ * @brief Simulación por eventos discretos sin E/S ni esperas reales
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Ejecuta los escenarios de simulation_data.json, o tráfico sintético de
+ * traffic_generator.h, sobre el mismo estado del
+ * gateway (registro de edificios, llamadas de piso, modelo cinemático) pero
+ * sin libcoap, DTLS ni bus CAN: todo ocurre en una cola de eventos discretos
+ * (sim_event_queue.h) cuyo reloj virtual salta de evento en evento. Un día de
+ * tráfico de 100 edificios se simula en segundos en un único proceso.
+ *
+ * **Eventos:**
+ * - Petición del escenario (llamada de piso o solicitud de cabina)
+ * - Respuesta del servidor central simulado tras --central-latency-ms:
+ *   asigna la llamada al ascensor más cercano, prefiriendo los libres y
+ *   descartando los que llevan pasajeros en sentido contrario; las
+ *   solicitudes de cabina se asignan al propio ascensor, como hace
+ *   servidor_central
+ * - Paso cinemático cada GW_SIM_TICK_MS sobre los edificios en los que
+ *   alguna cabina tiene tarea, se mueve o tiene puertas abiertas; sin
+ *   edificios activos no se programan pasos
+ *
+ * **Pasajeros:** cada llamada de piso se sigue hasta su asignación, la
+ * llegada de una cabina al origen y, si se conoce el destino, la llegada a
+ * él (passenger_kpi.h). Con --traffic el destino se conoce: los pasajeros
+ * que embarcan piden su piso en esa cabina --boarding-ms después, en lugar
+ * de la solicitud de cabina al azar del generador. Como el gateway solo
+ * guarda una tarea por ascensor, tras cada parada con pasajeros a bordo se
+ * pide el destino más cercano, y las llamadas cuyo ascensor fue desviado
+ * por otra asignación se reenvían al servidor central en la siguiente
+ * parada. El
+ * resumen incluye las distribuciones de tiempo hasta asignación, espera,
+ * tiempo en cabina y viaje; --kpi-csv y --kpi-json las exportan.
+ *
+ * **Uso:**
+ * ```
+ * gw_headless_sim [--file <json>] [--env <gateway.env>] [--buildings <n>]
+ *                 [--interval-ms <ms>] [--central-latency-ms <ms>]
+ *                 [--repeat <n>] [--kpi-csv <csv>] [--kpi-json <json>] [--verbose]
+ * gw_headless_sim --traffic <fases> [--duration-s <s>] [--seed <n>] [--group-mean <m>]
+ *                 [--boarding-ms <ms>] [--env <gateway.env>] [--buildings <n>]
+ *                 [--central-latency-ms <ms>] [--kpi-csv <csv>] [--kpi-json <json>] [--verbose]
+ * ```
+ * - --buildings: edificios simulados, los primeros del fichero (por defecto todos, hasta GW_MAX_BUILDINGS)
+ * - --interval-ms: separación entre peticiones sin "instante_ms" (por defecto 2000)
+ * - --repeat: rondas del escenario de cada edificio, una tras otra
+ * - --traffic: en lugar del fichero, tráfico generado con esas fases
+ *   ("0:up-peak:40,1800:mixed:10", ver gw_traffic_parse_phases()); cada
+ *   edificio usa su propio flujo de la semilla
+ * - --duration-s, --group-mean: duración del tráfico (3600) y pasajeros medios por llegada (1)
+ * - --seed: semilla del tráfico (por defecto GW_SIM_SEED; 0 elige una y la muestra)
+ * - --boarding-ms: desde la llegada de la cabina hasta que los pasajeros piden su piso (3000)
+ * - --kpi-csv: un viaje por línea con sus hitos; --kpi-json: resumen de indicadores
+ * - --verbose: muestra las trazas del gateway (por defecto se descartan)
+ *
+ * Los parámetros cinemáticos salen de gateway.env (GW_SIM_*).
+ *
+ * @see sim_event_queue.h
+ * @see elevator_kinematics.h
+ * @see mi_simulador_ascensor.c
+ */
+
+#include "api_gateway/sim_event_queue.h"
+#include "api_gateway/simulation_loader.h"
+#include "api_gateway/building_registry.h"
+#include "api_gateway/elevator_kinematics.h"
+#include "api_gateway/gateway_config.h"
+#include "api_gateway/traffic_generator.h"
+#include "api_gateway/passenger_kpi.h"
+#include "api_gateway/prng.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * @brief Grupo del edificio por defecto (índice 0 del registro)
+ *
+ * En el gateway lo define main.c; building_registry.c lo referencia.
+ */
+elevator_group_state_t managed_elevator_group;
+
+/**
+ * @brief Progreso de un edificio simulado
+ */
+typedef struct {
+    edificio_simulacion_t *edificio; ///< Escenario del edificio
+    plan_peticiones_t plan;          ///< Peticiones del escenario en la cola
+    gw_traffic_plan_t trafico;       ///< Peticiones generadas en la cola (--traffic)
+    bool activo;                     ///< Recibe pasos cinemáticos
+} headless_building_t;
+
+/**
+ * @brief Estado global de la ejecución
+ */
+typedef struct {
+    headless_building_t edificios[GW_MAX_BUILDINGS];
+    int num_edificios;
+    uint32_t latencia_central_ms;    ///< Retardo de las respuestas del servidor central simulado
+    uint32_t embarque_ms;            ///< Desde la parada hasta la solicitud de cabina de los pasajeros
+    bool destinos_conocidos;         ///< Las llamadas de piso traen el destino del grupo (--traffic)
+    uint32_t siguiente_tarea;        ///< Contador para los IDs de tarea
+    uint64_t peticiones;             ///< Peticiones del escenario ejecutadas
+    uint64_t solicitudes_central;    ///< Solicitudes enviadas al servidor central simulado
+    uint64_t solicitudes_pasajeros;  ///< Solicitudes de cabina de pasajeros a bordo
+    uint64_t reenviadas;             ///< Llamadas reenviadas porque su ascensor fue desviado
+    uint64_t asignaciones;           ///< Tareas asignadas
+    uint64_t reemplazadas;           ///< Tareas sustituidas antes de completarse
+    uint64_t pulsaciones_absorbidas; ///< Llamadas absorbidas por el registro de llamadas de piso
+    uint64_t pasos_cinematicos;      ///< Pasos fijos simulados (todos los edificios)
+    bool paso_programado;            ///< Hay un paso cinemático en la cola
+    gw_kpi_tracker_t kpi;            ///< Viajes de los pasajeros
+} headless_context_t;
+
+static headless_context_t ctx;
+
+static void on_kinematics_step(gw_sim_queue_t *queue, const gw_sim_event_t *event);
+static void on_central_response(gw_sim_queue_t *queue, const gw_sim_event_t *event);
+static int32_t empaquetar_peticion(const peticion_simulacion_t *peticion);
+static void car_stopped(gw_sim_queue_t *queue, uint16_t building_index, int car, int floor);
+
+/**
+ * @brief Activa los pasos cinemáticos de un edificio
+ *
+ * Un único evento por paso recorre los edificios activos, de modo que el
+ * coste de la cola no crece con el número de edificios. El paso se alinea
+ * con la rejilla de GW_SIM_TICK_MS para que el resultado no dependa de
+ * cuándo llegó la petición dentro del paso.
+ */
+static void arm_kinematics(gw_sim_queue_t *queue, uint16_t building_index) {
+    ctx.edificios[building_index].activo = true;
+    if (ctx.paso_programado) {
+        return;
+    }
+    uint64_t tick_ms = gw_config()->sim_tick_ms;
+    uint64_t next_ms = (gw_sim_queue_now(queue) / tick_ms + 1) * tick_ms;
+    ctx.paso_programado = gw_sim_queue_schedule(queue, next_ms, on_kinematics_step, NULL, 0, 0);
+}
+
+static void on_kinematics_step(gw_sim_queue_t *queue, const gw_sim_event_t *event) {
+    (void)event;
+    const gw_config_t *config = gw_config();
+    bool alguno_activo = false;
+    for (uint16_t b = 0; b < gw_building_count(); ++b) {
+        headless_building_t *hb = &ctx.edificios[b];
+        if (!hb->activo) {
+            continue;
+        }
+        elevator_group_state_t *group = gw_building_get(b);
+        bool ocupado[MAX_ELEVATORS_PER_GATEWAY];
+        int16_t destino[MAX_ELEVATORS_PER_GATEWAY];
+        for (int i = 0; i < group->num_elevadores_en_grupo; ++i) {
+            ocupado[i] = group->ocupado[i];
+            destino[i] = group->destino_actual[i];
+        }
+        gw_kinematics_step_group(group, &config->sim, config->sim_tick_ms, 1);
+        ctx.pasos_cinematicos++;
+        // Una tarea completada es una parada: la cabina está en su destino
+        for (int i = 0; i < group->num_elevadores_en_grupo; ++i) {
+            if (ocupado[i] && !group->ocupado[i]) {
+                car_stopped(queue, b, i, destino[i]);
+            }
+        }
+        hb->activo = !gw_kinematics_group_idle(group); // En reposo: sin pasos hasta la próxima asignación
+        alguno_activo = alguno_activo || hb->activo;
+    }
+    ctx.paso_programado = alguno_activo &&
+        gw_sim_queue_schedule_in(queue, config->sim_tick_ms, on_kinematics_step, NULL, 0, 0);
+}
+
+/**
+ * @brief Ascensor que elegiría el servidor central para una llamada de piso
+ * @return Índice del ascensor más cercano, prefiriendo los libres, o -1 si
+ *         todos llevan pasajeros en sentido contrario
+ *
+ * Una cabina con pasajeros que van en sentido contrario no recogería a los
+ * de la llamada (gw_kpi_car_stop()): asignársela solo la haría parar en el
+ * piso y volver a reenviar la llamada, sin fin si es la más cercana. Sin
+ * candidata la llamada queda sin asignar y redispatch_waiting() la reenvía
+ * en la siguiente parada.
+ */
+static int central_choose_elevator(const elevator_group_state_t *group, uint16_t building_index, int piso,
+                                   movement_direction_enum_t direccion) {
+    int mejor = -1;
+    int mejor_coste = 0;
+    for (int i = 0; i < group->num_elevadores_en_grupo; ++i) {
+        movement_direction_enum_t a_bordo = gw_kpi_riders_direction(&ctx.kpi, building_index, i,
+                                                                     group->piso_actual[i]);
+        if (a_bordo != STOPPED && a_bordo != direccion) {
+            continue;
+        }
+        int coste = abs(group->piso_actual[i] - piso) + (group->ocupado[i] ? GW_HALL_CALL_MAX_FLOORS : 0);
+        if (mejor < 0 || coste < mejor_coste) {
+            mejor = i;
+            mejor_coste = coste;
+        }
+    }
+    return mejor;
+}
+
+/**
+ * @brief Envía una llamada de piso al servidor central simulado, como el puente CAN
+ */
+static void send_hall_call(gw_sim_queue_t *queue, uint16_t building_index, int floor,
+                           movement_direction_enum_t direction) {
+    peticion_simulacion_t llamada;
+    memset(&llamada, 0, sizeof(llamada));
+    llamada.tipo = PETICION_LLAMADA_PISO;
+    llamada.piso_origen = floor;
+    llamada.direccion = direction;
+    gw_hall_call_mark_pending(gw_building_hall_calls(building_index), floor, direction);
+    ctx.solicitudes_central++;
+    gw_sim_queue_schedule_in(queue, ctx.latencia_central_ms, on_central_response,
+                             NULL, building_index, empaquetar_peticion(&llamada));
+}
+
+/**
+ * @brief Reenvía las llamadas con pasajeros esperando cuyo ascensor ya no va hacia ellas
+ *
+ * Los pasajeros no vuelven a pulsar: sin el reenvío esperarían a que otra
+ * cabina se detuviera en su piso por casualidad. Se hace en cada parada,
+ * cuando al menos una cabina está libre; reenviarlas en cuanto se desvían
+ * asignaría otra cabina ocupada, que a su vez dejaría otra llamada sin
+ * atender, sin fin.
+ */
+static void redispatch_waiting(gw_sim_queue_t *queue, uint16_t building_index) {
+    elevator_group_state_t *group = gw_building_get(building_index);
+    gw_hall_call_table_t *llamadas = gw_building_hall_calls(building_index);
+    for (int floor = 0; floor < GW_KPI_MAX_FLOORS; ++floor) {
+        for (int d = 0; d < 2; ++d) {
+            movement_direction_enum_t direccion = d ? MOVING_UP : MOVING_DOWN;
+            if (gw_kpi_has_waiting(&ctx.kpi, building_index, floor, direccion, NULL) &&
+                gw_hall_call_check(llamadas, group, floor, direccion, NULL) == GW_HALL_CALL_NEW) {
+                ctx.reenviadas++;
+                send_hall_call(queue, building_index, floor, direccion);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Parada de una cabina: desembarcan y embarcan pasajeros y los de a bordo piden su piso
+ */
+static void car_stopped(gw_sim_queue_t *queue, uint16_t building_index, int car, int floor) {
+    gw_kpi_car_stop(&ctx.kpi, building_index, car, floor, gw_sim_queue_now(queue));
+    redispatch_waiting(queue, building_index);
+    int destino = gw_kpi_next_destination(&ctx.kpi, building_index, car, floor);
+    if (destino < 0) {
+        return;
+    }
+    peticion_simulacion_t cabina;
+    memset(&cabina, 0, sizeof(cabina));
+    cabina.tipo = PETICION_SOLICITUD_CABINA;
+    cabina.indice_ascensor = car;
+    cabina.piso_destino = destino;
+    ctx.solicitudes_central++;
+    ctx.solicitudes_pasajeros++;
+    gw_sim_queue_schedule_in(queue, (uint64_t)ctx.embarque_ms + ctx.latencia_central_ms, on_central_response,
+                             NULL, building_index, empaquetar_peticion(&cabina));
+}
+
+/**
+ * @brief Codifica en evento.value lo que la respuesta del servidor central necesita
+ *
+ * La petición original no sigue viva hasta la respuesta cuando sale del
+ * generador de tráfico (gw_traffic_plan_t reutiliza su copia), así que la
+ * respuesta viaja en el propio evento: tipo, dirección, ascensor y piso.
+ */
+static int32_t empaquetar_peticion(const peticion_simulacion_t *peticion) {
+    bool llamada = peticion->tipo == PETICION_LLAMADA_PISO;
+    uint32_t piso = (uint16_t)(llamada ? peticion->piso_origen : peticion->piso_destino);
+    uint32_t indice = llamada ? 0u : (uint8_t)peticion->indice_ascensor;
+    uint32_t sube = llamada && peticion->direccion == MOVING_UP ? 1u : 0u;
+    return (int32_t)((llamada ? 1u << 30 : 0u) | (sube << 29) | (indice << 16) | piso);
+}
+
+/**
+ * @brief Inversa de empaquetar_peticion()
+ */
+static void desempaquetar_peticion(int32_t value, peticion_simulacion_t *peticion) {
+    uint32_t bits = (uint32_t)value;
+    memset(peticion, 0, sizeof(*peticion));
+    int piso = (int16_t)(bits & 0xFFFFu);
+    if (bits & (1u << 30)) {
+        peticion->tipo = PETICION_LLAMADA_PISO;
+        peticion->piso_origen = piso;
+        peticion->direccion = (bits & (1u << 29)) ? MOVING_UP : MOVING_DOWN;
+    } else {
+        peticion->tipo = PETICION_SOLICITUD_CABINA;
+        peticion->indice_ascensor = (int)((bits >> 16) & 0xFFu);
+        peticion->piso_destino = piso;
+    }
+}
+
+/**
+ * @brief Respuesta del servidor central simulado a una petición
+ */
+static void on_central_response(gw_sim_queue_t *queue, const gw_sim_event_t *event) {
+    peticion_simulacion_t datos;
+    desempaquetar_peticion(event->value, &datos);
+    const peticion_simulacion_t *peticion = &datos;
+    elevator_group_state_t *group = gw_building_get(event->building_index);
+    if (!group) {
+        return;
+    }
+
+    char tarea_id[TASK_ID_MAX_LEN];
+    snprintf(tarea_id, sizeof(tarea_id), "T_SIM_%u", ++ctx.siguiente_tarea);
+    int indice = peticion->tipo == PETICION_LLAMADA_PISO
+                     ? central_choose_elevator(group, event->building_index, peticion->piso_origen,
+                                               peticion->direccion)
+                     : peticion->indice_ascensor;
+    if (peticion->tipo == PETICION_LLAMADA_PISO) {
+        movement_direction_enum_t direccion = peticion->direccion;
+        const char *ascensor_id = indice >= 0 ? group->ids[indice].ascensor_id : NULL;
+        if (ascensor_id) {
+            ctx.reemplazadas += group->ocupado[indice] ? 1 : 0;
+            assign_task_to_elevator(group, ascensor_id, tarea_id, peticion->piso_origen, peticion->piso_origen);
+            ctx.asignaciones++;
+            gw_kpi_assigned(&ctx.kpi, event->building_index, peticion->piso_origen, direccion, indice,
+                            gw_sim_queue_now(queue));
+        }
+        gw_hall_call_resolve(gw_building_hall_calls(event->building_index), group,
+                             peticion->piso_origen, direccion, ascensor_id);
+    } else {
+        ctx.reemplazadas += group->ocupado[indice] ? 1 : 0;
+        assign_task_to_elevator(group, group->ids[indice].ascensor_id, tarea_id, peticion->piso_destino, -1);
+        ctx.asignaciones++;
+    }
+    arm_kinematics(queue, event->building_index);
+}
+
+/**
+ * @brief Petición del escenario: mismo filtrado que el puente CAN antes de contactar al servidor central
+ */
+static void on_request(gw_sim_queue_t *queue, const gw_sim_event_t *event) {
+    const peticion_simulacion_t *peticion = event->arg;
+    elevator_group_state_t *group = gw_building_get(event->building_index);
+    if (!group || !peticion) {
+        return;
+    }
+    ctx.peticiones++;
+
+    if (peticion->tipo == PETICION_LLAMADA_PISO) {
+        movement_direction_enum_t direccion = peticion->direccion;
+        uint64_t ahora_ms = gw_sim_queue_now(queue);
+        gw_kpi_press(&ctx.kpi, event->building_index, peticion->piso_origen, direccion,
+                     ctx.destinos_conocidos ? peticion->piso_destino : -1, peticion->pasajeros, ahora_ms);
+        int asignado = -1;
+        gw_hall_call_status_t estado = gw_hall_call_check(gw_building_hall_calls(event->building_index), group,
+                                                          peticion->piso_origen, direccion, &asignado);
+        if (estado == GW_HALL_CALL_ASSIGNED) {
+            gw_kpi_assigned(&ctx.kpi, event->building_index, peticion->piso_origen, direccion, asignado, ahora_ms);
+        }
+        if (estado != GW_HALL_CALL_NEW) {
+            ctx.pulsaciones_absorbidas++;
+            return;
+        }
+        send_hall_call(queue, event->building_index, peticion->piso_origen, direccion);
+        return;
+    } else if (peticion->tipo == PETICION_SOLICITUD_CABINA) {
+        if (peticion->indice_ascensor < 0 || peticion->indice_ascensor >= group->num_elevadores_en_grupo) {
+            return;
+        }
+    } else {
+        return;
+    }
+    ctx.solicitudes_central++;
+    gw_sim_queue_schedule_in(queue, ctx.latencia_central_ms, on_central_response,
+                             NULL, event->building_index, empaquetar_peticion(peticion));
+}
+
+static double elapsed_seconds(const struct timespec *t0, const struct timespec *t1) {
+    return (double)(t1->tv_sec - t0->tv_sec) + (double)(t1->tv_nsec - t0->tv_nsec) / 1e9;
+}
+
+static void print_usage(const char *prog) {
+    fprintf(stderr, "Uso: %s [--file <json>] [--env <gateway.env>] [--buildings <n>] [--interval-ms <ms>]\n"
+                    "          [--central-latency-ms <ms>] [--repeat <n>] [--kpi-csv <csv>] [--kpi-json <json>] [--verbose]\n"
+                    "       %s --traffic <inicio_s>:<patrón>:<llegadas_por_min>,... [--duration-s <s>]\n"
+                    "          [--seed <n>] [--group-mean <m>] [--boarding-ms <ms>] [--env <gateway.env>]\n"
+                    "          [--buildings <n>] [--central-latency-ms <ms>] [--kpi-csv <csv>] [--kpi-json <json>]\n"
+                    "          [--verbose]\n", prog, prog);
+}
+
+int main(int argc, char *argv[]) {
+    const char *archivo = "simulation_data.json";
+    const char *env_file = "gateway.env";
+    int num_solicitados = GW_MAX_BUILDINGS;
+    uint32_t intervalo_ms = 2000;
+    int rondas = 1;
+    bool verbose = false;
+    const char *fases_trafico = NULL;
+    bool semilla_fijada = false;
+    uint64_t semilla = 0;
+    gw_traffic_profile_t perfil;
+    gw_traffic_profile_defaults(&perfil);
+    const char *archivo_kpi_csv = NULL;
+    const char *archivo_kpi_json = NULL;
+    ctx.latencia_central_ms = 20;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--file") == 0 && i + 1 < argc) {
+            archivo = argv[++i];
+        } else if (strcmp(argv[i], "--env") == 0 && i + 1 < argc) {
+            env_file = argv[++i];
+        } else if (strcmp(argv[i], "--buildings") == 0 && i + 1 < argc) {
+            num_solicitados = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--interval-ms") == 0 && i + 1 < argc) {
+            intervalo_ms = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--central-latency-ms") == 0 && i + 1 < argc) {
+            ctx.latencia_central_ms = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            rondas = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--traffic") == 0 && i + 1 < argc) {
+            fases_trafico = argv[++i];
+        } else if (strcmp(argv[i], "--duration-s") == 0 && i + 1 < argc) {
+            perfil.duration_ms = (uint32_t)(strtod(argv[++i], NULL) * 1000.0);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            semilla = strtoull(argv[++i], NULL, 10);
+            semilla_fijada = true;
+        } else if (strcmp(argv[i], "--group-mean") == 0 && i + 1 < argc) {
+            perfil.mean_group_size = strtod(argv[++i], NULL);
+        } else if (strcmp(argv[i], "--boarding-ms") == 0 && i + 1 < argc) {
+            perfil.boarding_ms = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--kpi-csv") == 0 && i + 1 < argc) {
+            archivo_kpi_csv = argv[++i];
+        } else if (strcmp(argv[i], "--kpi-json") == 0 && i + 1 < argc) {
+            archivo_kpi_json = argv[++i];
+        } else if (strcmp(argv[i], "--verbose") == 0) {
+            verbose = true;
+        } else {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (num_solicitados < 1 || rondas < 1 || intervalo_ms == 0) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (num_solicitados > GW_MAX_BUILDINGS) num_solicitados = GW_MAX_BUILDINGS;
+    if (fases_trafico && !gw_traffic_parse_phases(&perfil, fases_trafico)) {
+        return EXIT_FAILURE;
+    }
+
+    // Las trazas del gateway van a stdout; sin --verbose se descartan hasta el resumen
+    int stdout_original = -1;
+    if (!verbose) {
+        fflush(stdout);
+        stdout_original = dup(STDOUT_FILENO);
+        if (!freopen("/dev/null", "w", stdout)) {
+            stdout_original = -1;
+        }
+    }
+
+    datos_simulacion_t datos;
+    memset(&datos, 0, sizeof(datos));
+    if (gw_config_load(env_file, 0) != 0 ||
+        (!fases_trafico && (!cargar_primeros_edificios(archivo, num_solicitados, &datos) || datos.num_edificios <= 0))) {
+        fprintf(stderr, "Error: no se pudo cargar la configuración '%s' o el escenario '%s'.\n", env_file, archivo);
+        return EXIT_FAILURE;
+    }
+    if (!fases_trafico && num_solicitados > datos.num_edificios) num_solicitados = datos.num_edificios;
+    if (fases_trafico) {
+        semilla = gw_prng_global_seed(semilla_fijada ? semilla : gw_config()->sim_seed);
+        // Los pasajeros piden su piso en la cabina que los recoge (car_stopped())
+        perfil.car_calls = false;
+        ctx.destinos_conocidos = true;
+    }
+    ctx.embarque_ms = perfil.boarding_ms;
+    if (!gw_kpi_init(&ctx.kpi)) {
+        fprintf(stderr, "Error: sin memoria para el seguimiento de pasajeros.\n");
+        return EXIT_FAILURE;
+    }
+
+    gw_building_registry_init();
+    gw_kinematics_init();
+    gw_sim_queue_t queue;
+    gw_sim_queue_init(&queue, 0);
+    for (int i = 0; i < num_solicitados; ++i) {
+        char id_trafico[16];
+        snprintf(id_trafico, sizeof(id_trafico), "E%03d", i + 1);
+        edificio_simulacion_t *edificio = fases_trafico ? NULL : &datos.edificios[i];
+        int building_index = gw_building_add(edificio ? edificio->id_edificio : id_trafico,
+                                             perfil.num_elevators, perfil.num_floors);
+        if (building_index < 0 || !gw_kpi_add_building(&ctx.kpi, (uint16_t)building_index, perfil.num_elevators)) {
+            continue;
+        }
+        ctx.edificios[building_index].edificio = edificio;
+        ctx.num_edificios++;
+        if (fases_trafico) {
+            // Un flujo por edificio: añadir edificios no cambia el tráfico de los anteriores
+            gw_traffic_plan_t *plan = &ctx.edificios[building_index].trafico;
+            plan->generator = gw_traffic_create(&perfil, semilla, (uint64_t)i);
+            plan->building_index = (uint16_t)building_index;
+            plan->inicio_ms = 0;
+            plan->accion = on_request;
+            if (!plan->generator) {
+                fprintf(stderr, "Error: perfil de tráfico inválido.\n");
+                return EXIT_FAILURE;
+            }
+            gw_traffic_schedule(&queue, plan);
+        }
+    }
+    uint64_t peticiones_programadas = 0;
+    for (uint16_t b = 0; b < gw_building_count(); ++b) {
+        headless_building_t *hb = &ctx.edificios[b];
+        if (!hb->edificio) {
+            continue;
+        }
+        // Todos los edificios empiezan a la vez; sus rondas van una tras otra
+        hb->plan.edificio = hb->edificio;
+        hb->plan.building_index = b;
+        hb->plan.inicio_ms = 0;
+        hb->plan.intervalo_ms = intervalo_ms;
+        hb->plan.rondas = rondas;
+        hb->plan.accion = on_request;
+        if (programar_peticiones_edificio(&queue, &hb->plan)) {
+            peticiones_programadas += (uint64_t)hb->edificio->num_peticiones * (uint64_t)rondas;
+        }
+    }
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    gw_sim_queue_run_until(&queue, UINT64_MAX);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    int ocupados = 0;
+    for (uint16_t b = 0; b < gw_building_count(); ++b) {
+        elevator_group_state_t *group = gw_building_get(b);
+        for (int i = 0; group && i < group->num_elevadores_en_grupo; ++i) {
+            ocupados += group->ocupado[i] ? 1 : 0;
+        }
+    }
+
+    if (stdout_original >= 0) {
+        fflush(stdout);
+        dup2(stdout_original, STDOUT_FILENO);
+        close(stdout_original);
+    }
+    double wall_s = elapsed_seconds(&t0, &t1);
+    double virtual_s = (double)gw_sim_queue_now(&queue) / 1000.0;
+    printf("=== SIMULACIÓN POR EVENTOS DISCRETOS ===\n");
+    if (fases_trafico) {
+        printf("Edificios: %d, tráfico generado \"%s\" durante %.0f s, semilla: %llu\n",
+               ctx.num_edificios, fases_trafico, perfil.duration_ms / 1000.0, (unsigned long long)semilla);
+    } else {
+        printf("Edificios: %d, rondas: %d, peticiones programadas: %llu\n",
+               ctx.num_edificios, rondas, (unsigned long long)peticiones_programadas);
+    }
+    printf("Tiempo simulado: %.1f s en %.3f s reales (x%.0f)\n", virtual_s, wall_s,
+           wall_s > 0 ? virtual_s / wall_s : 0.0);
+    printf("Eventos ejecutados: %llu (pasos cinemáticos %llu)\n",
+           (unsigned long long)queue.executed, (unsigned long long)ctx.pasos_cinematicos);
+    printf("Peticiones: %llu, solicitudes al servidor central: %llu, pulsaciones absorbidas: %llu\n",
+           (unsigned long long)ctx.peticiones, (unsigned long long)ctx.solicitudes_central,
+           (unsigned long long)ctx.pulsaciones_absorbidas);
+    printf("Solicitudes de cabina de pasajeros a bordo: %llu, llamadas reenviadas por desvío: %llu\n",
+           (unsigned long long)ctx.solicitudes_pasajeros, (unsigned long long)ctx.reenviadas);
+    printf("Tareas asignadas: %llu, reemplazadas: %llu, completadas: %llu, en curso: %d\n",
+           (unsigned long long)ctx.asignaciones, (unsigned long long)ctx.reemplazadas,
+           (unsigned long long)(ctx.asignaciones - ctx.reemplazadas - (uint64_t)ocupados), ocupados);
+    gw_kpi_print(&ctx.kpi, stdout);
+
+    int estado = EXIT_SUCCESS;
+    const char *exportaciones[2] = {archivo_kpi_csv, archivo_kpi_json};
+    for (int e = 0; e < 2; ++e) {
+        if (!exportaciones[e]) {
+            continue;
+        }
+        FILE *salida = fopen(exportaciones[e], "w");
+        bool escrito = salida && (e == 0 ? gw_kpi_write_csv(&ctx.kpi, salida) : gw_kpi_write_json(&ctx.kpi, salida));
+        if (salida && fclose(salida) != 0) {
+            escrito = false;
+        }
+        if (!escrito) {
+            fprintf(stderr, "Error: no se pudieron escribir los indicadores en '%s'.\n", exportaciones[e]);
+            estado = EXIT_FAILURE;
+        }
+    }
+
+    gw_sim_queue_free(&queue);
+    for (uint16_t b = 0; b < gw_building_count(); ++b) {
+        gw_traffic_destroy(ctx.edificios[b].trafico.generator);
+    }
+    gw_kinematics_cleanup();
+    gw_building_registry_cleanup();
+    gw_kpi_free(&ctx.kpi);
+    liberar_datos_simulacion(&datos);
+    return estado;
+}
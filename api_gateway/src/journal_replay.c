@@ -0,0 +1,312 @@
+/**
+ * @file journal_replay.c
+ * @brief Herramienta de reproducción del diario binario del gateway
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Reconstruye a partir de un diario (state_journal.h) el estado de todos los
+ * ascensores registrados, transición a transición, sin contactar con el
+ * servidor central ni con el bus CAN. Sirve para depurar una ejecución o
+ * para análisis fuera de línea: el estado en cualquier instante se obtiene
+ * deteniendo la reproducción con --until-ms.
+ *
+ * **Uso:**
+ * ```
+ * gw_journal_replay <diario> [--timeline] [--until-ms <ms>]
+ * ```
+ * - --timeline: imprime cada transición con el estado resultante
+ * - --until-ms: detiene la reproducción a los <ms> milisegundos del primer registro
+ *
+ * Al terminar imprime el número de transiciones por tipo, la velocidad de
+ * reproducción y el estado final de cada edificio.
+ *
+ * Los tiempos se cuentan desde el primer registro. Cada registro
+ * SESSION_STARTED (diario reabierto, quizá tras un reinicio) toma una nueva
+ * base de CLOCK_MONOTONIC y la sesión continúa donde acabó la anterior, sin
+ * contar el tiempo que el gateway estuvo parado.
+ *
+ * @see state_journal.h
+ */
+
+#include "api_gateway/state_journal.h"
+#include "api_gateway/elevator_state_manager.h" // Para movement_direction_enum_t
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * @brief Edificios distintos que puede reconstruir la herramienta
+ */
+#define REPLAY_MAX_BUILDINGS 1024
+
+/**
+ * @brief Estado reconstruido de un ascensor
+ */
+typedef struct {
+    int16_t piso;         ///< Piso actual
+    int16_t destino;      ///< Destino de la tarea actual (-1 si no hay)
+    uint8_t direccion;    ///< movement_direction_enum_t
+    bool ocupado;         ///< Con tarea asignada
+    uint32_t tarea;       ///< Hash de la tarea actual (0 si no hay)
+    uint32_t pisos_recorridos; ///< Movimientos registrados
+    uint32_t tareas_completadas; ///< Llegadas registradas
+} replay_elevator_t;
+
+/**
+ * @brief Estado reconstruido de un edificio
+ */
+typedef struct {
+    bool registrado;                 ///< Se vio su registro BUILDING_ADDED
+    uint32_t id_hash;                ///< Hash del ID del edificio
+    int num_pisos;                   ///< Pisos del edificio
+    int num_elevadores;              ///< Ascensores del grupo
+    replay_elevator_t *elevadores;   ///< Estado de cada ascensor
+    uint32_t solicitudes;            ///< Solicitudes enviadas al servidor central
+    uint32_t respuestas_ok;          ///< Respuestas 2.xx
+    uint32_t respuestas_error;       ///< Respuestas de error o sin respuesta
+} replay_building_t;
+
+/**
+ * @brief Contexto de la reproducción
+ */
+typedef struct {
+    replay_building_t buildings[REPLAY_MAX_BUILDINGS]; ///< Edificios por índice
+    uint64_t per_type[GW_JOURNAL_EVENT_COUNT];          ///< Transiciones por tipo
+    uint64_t session_first_ns;                          ///< Marca del primer registro de la sesión actual
+    uint64_t session_base_ns;                           ///< Tiempo relativo al empezar la sesión actual
+    uint64_t last_ns;                                   ///< Tiempo relativo del último registro aplicado
+    uint64_t until_ns;                                  ///< Límite relativo (0 = sin límite)
+    uint64_t inconsistencies;                           ///< Registros que no encajan con el estado
+    bool timeline;                                      ///< Imprimir cada transición
+    bool started;                                       ///< Se ha visto el primer registro
+} replay_context_t;
+
+static const char* direction_name(uint8_t direction) {
+    switch (direction) {
+        case MOVING_UP:   return "SUBIENDO";
+        case MOVING_DOWN: return "BAJANDO";
+        case STOPPED:     return "PARADO";
+        default:          return "?";
+    }
+}
+
+/**
+ * @brief Ascensor de un registro, o NULL si el edificio o el índice no existen
+ */
+static replay_elevator_t* record_elevator(replay_context_t *ctx, const gw_journal_record_t *r) {
+    if (r->building >= REPLAY_MAX_BUILDINGS) return NULL;
+    replay_building_t *b = &ctx->buildings[r->building];
+    if (!b->registrado || r->elevator >= b->num_elevadores) return NULL;
+    return &b->elevadores[r->elevator];
+}
+
+/**
+ * @brief (Re)registra un edificio con todos sus ascensores en el piso 0
+ */
+static bool apply_building_added(replay_context_t *ctx, const gw_journal_record_t *r) {
+    if (r->building >= REPLAY_MAX_BUILDINGS || r->aux == 0 || r->aux > MAX_ELEVATORS_PER_GATEWAY) {
+        return false;
+    }
+    replay_building_t *b = &ctx->buildings[r->building];
+    replay_elevator_t *elevadores = realloc(b->elevadores, r->aux * sizeof(replay_elevator_t));
+    if (!elevadores) {
+        return false;
+    }
+    memset(b, 0, sizeof(*b));
+    b->registrado = true;
+    b->id_hash = r->ref;
+    b->num_pisos = r->floor;
+    b->num_elevadores = (int)r->aux;
+    b->elevadores = elevadores;
+    for (int i = 0; i < b->num_elevadores; ++i) {
+        memset(&elevadores[i], 0, sizeof(elevadores[i]));
+        elevadores[i].destino = -1;
+        elevadores[i].direccion = STOPPED;
+    }
+    return true;
+}
+
+/**
+ * @brief Aplica un registro al estado reconstruido
+ */
+static bool replay_apply(const gw_journal_record_t *r, void *arg) {
+    replay_context_t *ctx = arg;
+    if (!ctx->started) {
+        ctx->started = true;
+        ctx->session_first_ns = r->timestamp_ns;
+    } else if (r->type == GW_JOURNAL_SESSION_STARTED) {
+        ctx->session_first_ns = r->timestamp_ns;
+        ctx->session_base_ns = ctx->last_ns;
+    }
+    uint64_t rel_ns = ctx->session_base_ns + (r->timestamp_ns - ctx->session_first_ns);
+    if (ctx->until_ns && rel_ns > ctx->until_ns) {
+        return false;
+    }
+    ctx->last_ns = rel_ns;
+    if (r->type < GW_JOURNAL_EVENT_COUNT) {
+        ctx->per_type[r->type]++;
+    }
+
+    bool consistent = true;
+    replay_elevator_t *e = NULL;
+    replay_building_t *b = r->building < REPLAY_MAX_BUILDINGS ? &ctx->buildings[r->building] : NULL;
+    switch (r->type) {
+        case GW_JOURNAL_BUILDING_ADDED:
+            consistent = apply_building_added(ctx, r);
+            break;
+        case GW_JOURNAL_TASK_ASSIGNED:
+            if ((e = record_elevator(ctx, r)) != NULL) {
+                consistent = e->piso == r->floor;
+                e->piso = r->floor;
+                e->destino = r->target_floor;
+                e->direccion = (uint8_t)r->aux;
+                e->ocupado = true;
+                e->tarea = r->ref;
+            } else {
+                consistent = false;
+            }
+            break;
+        case GW_JOURNAL_ELEVATOR_MOVED:
+            if ((e = record_elevator(ctx, r)) != NULL) {
+                e->piso = r->floor;
+                e->direccion = (uint8_t)r->aux;
+                e->pisos_recorridos++;
+            } else {
+                consistent = false;
+            }
+            break;
+        case GW_JOURNAL_ELEVATOR_ARRIVED:
+            if ((e = record_elevator(ctx, r)) != NULL) {
+                consistent = e->ocupado && e->destino == r->floor;
+                e->piso = r->floor;
+                e->destino = -1;
+                e->direccion = STOPPED;
+                e->ocupado = false;
+                e->tarea = 0;
+                e->tareas_completadas++;
+            } else {
+                consistent = false;
+            }
+            break;
+        case GW_JOURNAL_REQUEST_SENT:
+            if (b) b->solicitudes++;
+            break;
+        case GW_JOURNAL_RESPONSE_RECEIVED:
+            if (b) {
+                if ((r->aux >> 5) == 2) b->respuestas_ok++;
+                else b->respuestas_error++;
+            }
+            break;
+        case GW_JOURNAL_SESSION_STARTED:
+            break;
+        default:
+            consistent = false;
+            break;
+    }
+    if (!consistent) {
+        ctx->inconsistencies++;
+    }
+
+    if (ctx->timeline) {
+        double rel_ms = (double)rel_ns / 1e6;
+        printf("[%12.3f ms] %-11s edificio %u", rel_ms, gw_journal_event_to_string(r->type), r->building);
+        if (r->elevator != GW_JOURNAL_NO_ELEVATOR) printf(" ascensor %u", r->elevator + 1);
+        switch (r->type) {
+            case GW_JOURNAL_BUILDING_ADDED:
+                printf(": %u ascensores, %d pisos", r->aux, r->floor);
+                break;
+            case GW_JOURNAL_REQUEST_SENT:
+                printf(": CAN 0x%X, origen %d, destino %d", r->ref, r->floor, r->target_floor);
+                break;
+            case GW_JOURNAL_RESPONSE_RECEIVED:
+                printf(": CAN 0x%X, código %u.%02u", r->ref, r->aux >> 5, r->aux & 0x1F);
+                break;
+            case GW_JOURNAL_SESSION_STARTED: {
+                time_t opened = (time_t)((((uint64_t)r->aux << 32) | r->ref) / 1000000000ull);
+                char date[32];
+                strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", localtime(&opened));
+                printf(": diario reabierto el %s", date);
+                break;
+            }
+            default:
+                if (e) printf(": piso %d, destino %d, %s%s", e->piso, e->destino, direction_name(e->direccion),
+                              e->ocupado ? ", ocupado" : "");
+                break;
+        }
+        printf("%s\n", consistent ? "" : "  [INCONSISTENTE]");
+    }
+    return true;
+}
+
+static void print_usage(const char *prog) {
+    fprintf(stderr, "Uso: %s <diario> [--timeline] [--until-ms <ms>]\n", prog);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    static replay_context_t ctx; // Grande: fuera de la pila
+    const char *path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--timeline") == 0) {
+            ctx.timeline = true;
+        } else if (strcmp(argv[i], "--until-ms") == 0 && i + 1 < argc) {
+            ctx.until_ns = strtoull(argv[++i], NULL, 10) * 1000000ull;
+        } else if (argv[i][0] != '-' && !path) {
+            path = argv[i];
+        } else {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (!path) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    struct timespec t0, t1;
+    gw_journal_file_header_t header;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    long applied = gw_journal_replay(path, &header, replay_apply, &ctx);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    if (applied < 0) {
+        fprintf(stderr, "Error: '%s' no es un diario válido (versión %d).\n", path, GW_JOURNAL_VERSION);
+        return EXIT_FAILURE;
+    }
+
+    double elapsed_s = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) / 1e9;
+    time_t created = (time_t)(header.created_realtime_ns / 1000000000ull);
+    printf("\n=== DIARIO: %s ===\n", path);
+    printf("Creado: %s", ctime(&created));
+    printf("Transiciones reproducidas: %ld (%.3f s de ejecución)\n", applied,
+           ctx.started ? (double)ctx.last_ns / 1e9 : 0.0);
+    for (int t = GW_JOURNAL_BUILDING_ADDED; t < GW_JOURNAL_EVENT_COUNT; ++t) {
+        printf("  %-11s %llu\n", gw_journal_event_to_string((uint8_t)t), (unsigned long long)ctx.per_type[t]);
+    }
+    printf("Inconsistencias: %llu\n", (unsigned long long)ctx.inconsistencies);
+    if (elapsed_s > 0) {
+        printf("Velocidad de reproducción: %.2f millones de transiciones/s\n", (double)applied / elapsed_s / 1e6);
+    }
+
+    printf("\n=== ESTADO FINAL ===\n");
+    for (int i = 0; i < REPLAY_MAX_BUILDINGS; ++i) {
+        replay_building_t *b = &ctx.buildings[i];
+        if (!b->registrado) continue;
+        printf("Edificio %d (id 0x%08X, %d pisos): %u solicitudes, %u respuestas OK, %u errores\n",
+               i, b->id_hash, b->num_pisos, b->solicitudes, b->respuestas_ok, b->respuestas_error);
+        for (int j = 0; j < b->num_elevadores; ++j) {
+            replay_elevator_t *e = &b->elevadores[j];
+            printf("  A%-3d piso %3d  destino %3d  %-8s %-8s pisos recorridos %u, tareas completadas %u\n",
+                   j + 1, e->piso, e->destino, direction_name(e->direccion), e->ocupado ? "ocupado" : "libre",
+                   e->pisos_recorridos, e->tareas_completadas);
+        }
+        free(b->elevadores);
+    }
+    return EXIT_SUCCESS;
+}
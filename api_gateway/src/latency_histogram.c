@@ -0,0 +1,193 @@
+/**
+ * @file latency_histogram.c
+ * @brief Implementación del histograma de latencias HDR
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Cubo b (b >= 0) cubre [1024·2^b, 2048·2^b) con 1024 subcubos de ancho
+ * 2^b; el cubo 0 cubre además [0, 1024) con ancho 1. El índice de un valor
+ * sale de su bit más alto, sin bucles ni divisiones.
+ *
+ * @see latency_histogram.h
+ */
+
+#include "api_gateway/latency_histogram.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief log2 de la mitad de subcubos por cubo (2048 subcubos: 3 cifras significativas)
+ */
+#define HIST_SUB_BUCKET_HALF_MAGNITUDE 10
+#define HIST_SUB_BUCKET_HALF_COUNT (1u << HIST_SUB_BUCKET_HALF_MAGNITUDE)
+#define HIST_SUB_BUCKET_COUNT (2u * HIST_SUB_BUCKET_HALF_COUNT)
+#define HIST_SUB_BUCKET_MASK ((uint64_t)HIST_SUB_BUCKET_COUNT - 1)
+
+/**
+ * @brief Cubos necesarios para llegar a GW_LATENCY_HIST_MAX_US
+ */
+static int bucket_count(void) {
+    uint64_t smallest_untrackable = HIST_SUB_BUCKET_COUNT;
+    int buckets = 1;
+    while (smallest_untrackable <= GW_LATENCY_HIST_MAX_US) {
+        smallest_untrackable <<= 1;
+        buckets++;
+    }
+    return buckets;
+}
+
+static size_t counts_index(uint64_t value) {
+    int pow2_ceiling = 64 - __builtin_clzll(value | HIST_SUB_BUCKET_MASK);
+    int bucket = pow2_ceiling - (HIST_SUB_BUCKET_HALF_MAGNITUDE + 1);
+    uint64_t sub_bucket = value >> bucket;
+    return ((size_t)(bucket + 1) << HIST_SUB_BUCKET_HALF_MAGNITUDE) + (size_t)sub_bucket - HIST_SUB_BUCKET_HALF_COUNT;
+}
+
+/**
+ * @brief Mayor valor que cae en el contador @p index
+ */
+static uint64_t highest_value_at(size_t index) {
+    int bucket = (int)(index >> HIST_SUB_BUCKET_HALF_MAGNITUDE) - 1;
+    uint64_t sub_bucket = (index & (HIST_SUB_BUCKET_HALF_COUNT - 1)) + HIST_SUB_BUCKET_HALF_COUNT;
+    if (bucket < 0) {
+        sub_bucket -= HIST_SUB_BUCKET_HALF_COUNT;
+        bucket = 0;
+    }
+    return (sub_bucket << bucket) + ((uint64_t)1 << bucket) - 1;
+}
+
+bool gw_latency_hist_init(gw_latency_hist_t *hist) {
+    if (!hist) {
+        return false;
+    }
+    memset(hist, 0, sizeof(*hist));
+    hist->counts_len = (size_t)(bucket_count() + 1) * HIST_SUB_BUCKET_HALF_COUNT;
+    hist->counts = calloc(hist->counts_len, sizeof(uint64_t));
+    if (!hist->counts) {
+        hist->counts_len = 0;
+        return false;
+    }
+    hist->min_us = UINT64_MAX;
+    return true;
+}
+
+void gw_latency_hist_free(gw_latency_hist_t *hist) {
+    if (!hist) {
+        return;
+    }
+    free(hist->counts);
+    memset(hist, 0, sizeof(*hist));
+}
+
+void gw_latency_hist_reset(gw_latency_hist_t *hist) {
+    if (!hist || !hist->counts) {
+        return;
+    }
+    memset(hist->counts, 0, hist->counts_len * sizeof(uint64_t));
+    hist->total = 0;
+    hist->min_us = UINT64_MAX;
+    hist->max_us = 0;
+    hist->sum_us = 0.0;
+}
+
+void gw_latency_hist_record(gw_latency_hist_t *hist, uint64_t value_us) {
+    gw_latency_hist_record_count(hist, value_us, 1);
+}
+
+void gw_latency_hist_record_count(gw_latency_hist_t *hist, uint64_t value_us, uint64_t count) {
+    if (!hist || !hist->counts || count == 0) {
+        return;
+    }
+    if (value_us == 0) {
+        value_us = 1;
+    } else if (value_us > GW_LATENCY_HIST_MAX_US) {
+        value_us = GW_LATENCY_HIST_MAX_US;
+    }
+    hist->counts[counts_index(value_us)] += count;
+    hist->total += count;
+    hist->sum_us += (double)value_us * (double)count;
+    if (value_us < hist->min_us) hist->min_us = value_us;
+    if (value_us > hist->max_us) hist->max_us = value_us;
+}
+
+void gw_latency_hist_record_corrected(gw_latency_hist_t *hist, uint64_t value_us, uint64_t expected_interval_us) {
+    gw_latency_hist_record(hist, value_us);
+    if (expected_interval_us == 0 || value_us <= expected_interval_us) {
+        return;
+    }
+    for (uint64_t missing = value_us - expected_interval_us; missing >= expected_interval_us;
+         missing -= expected_interval_us) {
+        gw_latency_hist_record(hist, missing);
+    }
+}
+
+void gw_latency_hist_merge(gw_latency_hist_t *dst, const gw_latency_hist_t *src) {
+    if (!dst || !src || !dst->counts || !src->counts || dst->counts_len != src->counts_len) {
+        return;
+    }
+    for (size_t i = 0; i < src->counts_len; ++i) {
+        dst->counts[i] += src->counts[i];
+    }
+    dst->total += src->total;
+    dst->sum_us += src->sum_us;
+    if (src->min_us < dst->min_us) dst->min_us = src->min_us;
+    if (src->max_us > dst->max_us) dst->max_us = src->max_us;
+}
+
+uint64_t gw_latency_hist_percentile(const gw_latency_hist_t *hist, double percentile) {
+    if (!hist || !hist->counts || hist->total == 0) {
+        return 0;
+    }
+    if (percentile < 0.0) percentile = 0.0;
+    if (percentile > 100.0) percentile = 100.0;
+    uint64_t target = (uint64_t)ceil(percentile / 100.0 * (double)hist->total);
+    if (target == 0) {
+        target = 1;
+    }
+    uint64_t seen = 0;
+    for (size_t i = 0; i < hist->counts_len; ++i) {
+        seen += hist->counts[i];
+        if (seen >= target) {
+            uint64_t value = highest_value_at(i);
+            return value < hist->max_us ? value : hist->max_us;
+        }
+    }
+    return hist->max_us;
+}
+
+double gw_latency_hist_mean(const gw_latency_hist_t *hist) {
+    return (hist && hist->total) ? hist->sum_us / (double)hist->total : 0.0;
+}
+
+void gw_latency_hist_print(const gw_latency_hist_t *hist, FILE *out, const char *label) {
+    if (!hist || !out) {
+        return;
+    }
+    fprintf(out, "%-10s n=%-9llu media=%8.3f p50=%8.3f p90=%8.3f p99=%8.3f p99.9=%8.3f p99.99=%8.3f max=%8.3f ms\n",
+            label ? label : "", (unsigned long long)hist->total, gw_latency_hist_mean(hist) / 1000.0,
+            gw_latency_hist_percentile(hist, 50.0) / 1000.0, gw_latency_hist_percentile(hist, 90.0) / 1000.0,
+            gw_latency_hist_percentile(hist, 99.0) / 1000.0, gw_latency_hist_percentile(hist, 99.9) / 1000.0,
+            gw_latency_hist_percentile(hist, 99.99) / 1000.0, hist->total ? hist->max_us / 1000.0 : 0.0);
+}
+
+void gw_latency_hist_write_csv(const gw_latency_hist_t *hist, FILE *out) {
+    if (!hist || !out) {
+        return;
+    }
+    fprintf(out, "percentil,latencia_us,muestras\n");
+    // 0, 50, 75, 87,5...: cada punto reduce a la mitad lo que falta hasta 100
+    for (int i = 0; i <= 20; ++i) {
+        double percentile = 100.0 * (1.0 - ldexp(1.0, -i));
+        uint64_t below = (uint64_t)ceil(percentile / 100.0 * (double)hist->total);
+        fprintf(out, "%.6f,%llu,%llu\n", percentile,
+                (unsigned long long)gw_latency_hist_percentile(hist, percentile), (unsigned long long)below);
+        if (below >= hist->total) {
+            return;
+        }
+    }
+    fprintf(out, "%.6f,%llu,%llu\n", 100.0, (unsigned long long)gw_latency_hist_percentile(hist, 100.0),
+            (unsigned long long)hist->total);
+}
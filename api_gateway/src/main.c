@@ -27,7 +27,7 @@
  */
 
 #include <stdio.h>    // For standard I/O (printf, fprintf)
-#include <stdlib.h>   // For EXIT_FAILURE, EXIT_SUCCESS, atoi, srand, time
+#include <stdlib.h>   // For EXIT_FAILURE, EXIT_SUCCESS, atoi
 #include <string.h>   // For strerror (potentially)
 #include <signal.h>   // For signal, sig_atomic_t
 #include <errno.h>    // For errno (potentially)
@@ -36,7 +36,7 @@
 #include <sys/socket.h> // For AF_INET
 #include <netinet/in.h> // For sockaddr_in, htons
 #include <arpa/inet.h>  // For inet_pton
-#include <time.h>     // For time() used in srand()
+#include <time.h>
 #include <stdbool.h>  // For bool type (simulación no-bloqueante)
 
 #include <coap3/coap.h> // Incluir este paraguas primero
@@ -48,6 +48,16 @@
 
 // NUEVA INCLUSIÓN PARA EL PUENTE CAN
 #include "api_gateway/can_bridge.h"
+#include "api_gateway/request_tracker.h"
+#include "api_gateway/building_registry.h"
+#include "api_gateway/event_loop.h"
+#include "api_gateway/socketcan_backend.h"
+#include "api_gateway/coap_config.h"
+#include "api_gateway/gateway_config.h"
+#include "api_gateway/elevator_kinematics.h"
+#include "api_gateway/state_store.h"
+#include "api_gateway/state_journal.h"
+#include "api_gateway/prng.h"
 
 // Include cJSON for payload generation
 #include <cJSON.h> 
@@ -134,14 +144,11 @@ volatile sig_atomic_t quit_main_loop = 0;
  */
 elevator_group_state_t managed_elevator_group;
 
-// --- Forward declaration for the new simulation function ---
-static void simulate_elevator_group_step(coap_context_t *ctx, elevator_group_state_t *group);
-// --- End Forward declaration ---
-
 // --- Prototipos para el simulador de ascensor (normalmente en mi_simulador_ascensor.h) ---
 void inicializar_mi_simulacion_ascensor(void); // No necesita ctx si usamos g_coap_context
 void simular_eventos_ascensor(void);
 bool procesar_siguiente_peticion_simulacion(void); // Nueva función no-bloqueante
+uint64_t obtener_proxima_peticion_simulacion_ns(void);
 // --- Fin Prototipos simulador ---
 
 /**
@@ -243,24 +250,43 @@ static int event_handler_gw(coap_session_t *session, coap_event_t event) {
     return 0;
 }
 
+/**
+ * @brief Tiempo máximo que se espera a que una sesión DTLS nueva se establezca
+ *
+ * Pasado este tiempo sin establecerse, la siguiente solicitud la descarta y
+ * abre otra.
+ */
+#define CENTRAL_DTLS_HANDSHAKE_TIMEOUT_MS 5000
+
+/**
+ * @brief Instante (gw_tracker_now_ms()) en que se creó la sesión global actual
+ */
+static uint64_t g_dtls_session_created_ms = 0;
+
 /**
  * @brief Obtiene o crea una sesión DTLS con el servidor central
  * @param ctx Contexto CoAP a utilizar para la sesión
- * @return Puntero a la sesión DTLS establecida, o NULL en caso de error
+ * @return Puntero a la sesión DTLS (establecida o en handshake), o NULL en caso de error
  * 
  * Esta función implementa un patrón singleton para la gestión de sesiones DTLS
  * con el servidor central. Reutiliza sesiones existentes cuando están activas
  * y crea nuevas sesiones cuando es necesario.
  * 
  * Comportamiento:
- * 1. Si existe una sesión activa y establecida, la reutiliza
- * 2. Si la sesión existe pero no está establecida, la libera y crea una nueva
+ * 1. Si existe una sesión establecida, o en handshake desde hace menos de
+ *    CENTRAL_DTLS_HANDSHAKE_TIMEOUT_MS, la reutiliza
+ * 2. Si la sesión falló o su handshake no terminó a tiempo, la libera y crea una nueva
  * 3. Si no existe sesión, crea una nueva con configuración DTLS-PSK
  * 4. Registra el manejador de eventos para gestión automática de la sesión
  * 
+ * Nunca espera al handshake: lo hace avanzar el bucle de eventos
+ * (event_loop.h) y libcoap retiene las PDUs enviadas a una sesión que aún
+ * no está establecida hasta que lo esté. Si el handshake falla, libcoap
+ * responde a esas PDUs con un NACK (hnd_central_server_nack_gw()).
+ * 
  * La función utiliza las siguientes configuraciones:
- * - IP del servidor: CENTRAL_SERVER_IP
- * - Puerto del servidor: CENTRAL_SERVER_PORT  
+ * - IP del servidor: CENTRAL_SERVER_IP (gw_config())
+ * - Puerto del servidor: CENTRAL_SERVER_PORT (gw_config())
  * - Identidad PSK: IDENTITY_TO_PRESENT_TO_SERVER
  * - Clave PSK: KEY_FOR_SERVER
  * 
@@ -268,111 +294,42 @@ static int event_handler_gw(coap_session_t *session, coap_event_t event) {
  * @see coap_config.h
  */
 coap_session_t* get_or_create_central_server_dtls_session(coap_context_t *ctx) {
-    static int creating_session = 0; // Evitar crear múltiples sesiones simultáneamente
-    
     if (!ctx) {
         LOG_ERROR_GW("[SessionHelper] Contexto CoAP es NULL. No se puede obtener/crear sesión.");
         return NULL;
     }
-    
-    // Si ya estamos creando una sesión, esperar
-    if (creating_session) {
-        LOG_DEBUG_GW("[SessionHelper] Ya se está creando una sesión. Esperando...");
-        int wait_count = 0;
-        while (creating_session && wait_count < 50) { // Esperar hasta 5 segundos
-            coap_io_process(ctx, 100);
-            wait_count++;
-        }
-        if (g_dtls_session_to_central_server && 
-            coap_session_get_state(g_dtls_session_to_central_server) == COAP_SESSION_STATE_ESTABLISHED) {
-            return g_dtls_session_to_central_server;
-        }
-    }
-
-    // Verificar si ya tenemos una sesión establecida y válida
-    if (g_dtls_session_to_central_server != NULL && 
-        coap_session_get_state(g_dtls_session_to_central_server) == COAP_SESSION_STATE_ESTABLISHED) {
-        LOG_DEBUG_GW("[SessionHelper] Reutilizando sesión DTLS-PSK establecida (0x%p) con servidor central.", (void*)g_dtls_session_to_central_server);
-        return g_dtls_session_to_central_server;
-    }
 
-    // Si la sesión existe pero está en estado CONNECTING, esperar un poco
-    if (g_dtls_session_to_central_server != NULL && 
-        coap_session_get_state(g_dtls_session_to_central_server) == COAP_SESSION_STATE_CONNECTING) {
-        LOG_INFO_GW("[SessionHelper] Sesión DTLS-PSK (0x%p) está conectando. Esperando establecimiento...", (void*)g_dtls_session_to_central_server);
-        
-        // Esperar hasta 5 segundos para que se establezca la sesión
-        int max_wait_attempts = 50; // 50 * 100ms = 5 segundos
-        int wait_count = 0;
-        
-        while (wait_count < max_wait_attempts) {
-            coap_io_process(ctx, 100); // Procesar eventos por 100ms
-            
-            if (coap_session_get_state(g_dtls_session_to_central_server) == COAP_SESSION_STATE_ESTABLISHED) {
-                LOG_INFO_GW("[SessionHelper] Sesión DTLS-PSK (0x%p) establecida exitosamente después de %d intentos.", 
-                           (void*)g_dtls_session_to_central_server, wait_count);
-                return g_dtls_session_to_central_server;
-            } else if (coap_session_get_state(g_dtls_session_to_central_server) == COAP_SESSION_STATE_NONE) {
-                LOG_WARN_GW("[SessionHelper] Sesión DTLS-PSK (0x%p) falló durante la conexión. Creando nueva sesión.", 
-                           (void*)g_dtls_session_to_central_server);
-                break;
-            }
-            
-            wait_count++;
+    if (g_dtls_session_to_central_server != NULL) {
+        coap_session_state_t state = coap_session_get_state(g_dtls_session_to_central_server);
+        if (state == COAP_SESSION_STATE_ESTABLISHED) {
+            LOG_DEBUG_GW("[SessionHelper] Reutilizando sesión DTLS-PSK establecida (0x%p) con servidor central.", (void*)g_dtls_session_to_central_server);
+            return g_dtls_session_to_central_server;
         }
-        
-        if (wait_count >= max_wait_attempts) {
-            LOG_WARN_GW("[SessionHelper] Timeout esperando establecimiento de sesión DTLS-PSK (0x%p). Creando nueva sesión.", 
-                       (void*)g_dtls_session_to_central_server);
+        uint64_t elapsed_ms = gw_tracker_now_ms() - g_dtls_session_created_ms;
+        if (state != COAP_SESSION_STATE_NONE && elapsed_ms < CENTRAL_DTLS_HANDSHAKE_TIMEOUT_MS) {
+            LOG_DEBUG_GW("[SessionHelper] Sesión DTLS-PSK (0x%p) en handshake (estado %d). La solicitud queda en cola.",
+                         (void*)g_dtls_session_to_central_server, state);
+            return g_dtls_session_to_central_server;
         }
-    }
-
-    // Si la sesión existe pero no está establecida, liberarla antes de crear una nueva.
-    if (g_dtls_session_to_central_server != NULL) {
-        LOG_INFO_GW("[SessionHelper] Liberando sesión DTLS-PSK existente (0x%p) para crear una nueva.", (void*)g_dtls_session_to_central_server);
+        // Si la sesión existe pero falló o no se estableció a tiempo, liberarla antes de crear una nueva.
+        LOG_WARN_GW("[SessionHelper] Sesión DTLS-PSK (0x%p) sin establecer tras %llu ms (estado %d). Creando nueva sesión.",
+                    (void*)g_dtls_session_to_central_server, (unsigned long long)elapsed_ms, state);
         coap_session_release(g_dtls_session_to_central_server);
         g_dtls_session_to_central_server = NULL;
     }
 
     LOG_INFO_GW("[SessionHelper] Creando NUEVA sesión DTLS-PSK con servidor central.");
-    creating_session = 1; // Marcar que estamos creando una sesión
     coap_address_t central_server_addr;
     coap_address_init(&central_server_addr);
     central_server_addr.addr.sin.sin_family = AF_INET;
     
-    // Obtener y limpiar la IP del servidor central
-    const char* server_ip_raw = getenv("CENTRAL_SERVER_IP") ?: "192.168.49.2";
-    char server_ip[16];
-    strncpy(server_ip, server_ip_raw, sizeof(server_ip) - 1);
-    server_ip[sizeof(server_ip) - 1] = '\0';
-    
-    // Remover caracteres de nueva línea
-    char *newline_server = strchr(server_ip, '\n');
-    if (newline_server) *newline_server = '\0';
-    newline_server = strchr(server_ip, '\r');
-    if (newline_server) *newline_server = '\0';
-    
-    LOG_INFO_GW("[SessionHelper] Debug - server_ip = '%s' (longitud: %d)", server_ip, (int)strlen(server_ip));
-    LOG_INFO_GW("[SessionHelper] Debug - CENTRAL_SERVER_IP env var = '%s'", getenv("CENTRAL_SERVER_IP") ?: "NULL");
-    
-    if (inet_pton(AF_INET, server_ip, &central_server_addr.addr.sin.sin_addr) <= 0) {
-        LOG_ERROR_GW("[SessionHelper] Error convirtiendo IP del servidor central: %s", server_ip);
+    const gw_config_t *config = gw_config();
+    if (inet_pton(AF_INET, config->central_server_ip, &central_server_addr.addr.sin.sin_addr) <= 0) {
+        LOG_ERROR_GW("[SessionHelper] Error convirtiendo IP del servidor central: %s", config->central_server_ip);
         return NULL;
     }
-    
-    // Obtener y limpiar el puerto del servidor central
-    const char* server_port_raw = getenv("CENTRAL_SERVER_PORT") ?: "5684";
-    char server_port_str[8];
-    strncpy(server_port_str, server_port_raw, sizeof(server_port_str) - 1);
-    server_port_str[sizeof(server_port_str) - 1] = '\0';
-    
-    // Remover caracteres de nueva línea
-    char *newline_server_port = strchr(server_port_str, '\n');
-    if (newline_server_port) *newline_server_port = '\0';
-    newline_server_port = strchr(server_port_str, '\r');
-    if (newline_server_port) *newline_server_port = '\0';
-    
-    central_server_addr.addr.sin.sin_port = htons(atoi(server_port_str));
+    central_server_addr.addr.sin.sin_port = htons(config->central_server_port);
+    LOG_INFO_GW("[SessionHelper] Servidor central: %s:%u", config->central_server_ip, config->central_server_port);
 
     // Generar identidad y clave únicas para esta instancia
     char* unique_identity = generate_unique_identity();
@@ -383,7 +340,6 @@ coap_session_t* get_or_create_central_server_dtls_session(coap_context_t *ctx) {
     setenv("KEY_FOR_SERVER", unique_psk_key, 1);
     
     LOG_INFO_GW("[SessionHelper] Usando identidad única: '%s'", unique_identity);
-    
     g_dtls_session_to_central_server = coap_new_client_session_psk(ctx,
                                                                    NULL, // local_if
                                                                    &central_server_addr,
@@ -399,6 +355,7 @@ coap_session_t* get_or_create_central_server_dtls_session(coap_context_t *ctx) {
     
     LOG_INFO_GW("[SessionHelper] NUEVA Sesión DTLS-PSK (0x%p) creada con servidor central. Identity: '%s'", (void*)g_dtls_session_to_central_server, unique_identity);
     coap_session_reference(g_dtls_session_to_central_server); // Tomamos una referencia explícita
+    g_dtls_session_created_ms = gw_tracker_now_ms();
     
     // Guardar el contexto para el event handler (si no lo hemos hecho ya o si cambia)
     if (g_coap_context_for_session_mgnt != ctx) {
@@ -406,195 +363,51 @@ coap_session_t* get_or_create_central_server_dtls_session(coap_context_t *ctx) {
         coap_register_event_handler(g_coap_context_for_session_mgnt, event_handler_gw);
         LOG_DEBUG_GW("[SessionHelper] Manejador de eventos CoAP registrado para la gestión de sesiones DTLS.");
     }
-
-    // Esperar a que la nueva sesión se establezca
-    LOG_INFO_GW("[SessionHelper] Esperando establecimiento de nueva sesión DTLS-PSK (0x%p)...", (void*)g_dtls_session_to_central_server);
-    
-    int max_wait_attempts = 50; // 50 * 100ms = 5 segundos
-    int wait_count = 0;
-    
-    while (wait_count < max_wait_attempts) {
-        coap_io_process(ctx, 100); // Procesar eventos por 100ms
-        
-        if (coap_session_get_state(g_dtls_session_to_central_server) == COAP_SESSION_STATE_ESTABLISHED) {
-            LOG_INFO_GW("[SessionHelper] Nueva sesión DTLS-PSK (0x%p) establecida exitosamente después de %d intentos.", 
-                       (void*)g_dtls_session_to_central_server, wait_count);
-            creating_session = 0; // Desmarcar que estamos creando una sesión
-            return g_dtls_session_to_central_server;
-        } else if (coap_session_get_state(g_dtls_session_to_central_server) == COAP_SESSION_STATE_NONE) {
-            LOG_ERROR_GW("[SessionHelper] Nueva sesión DTLS-PSK (0x%p) falló durante la conexión.", 
-                       (void*)g_dtls_session_to_central_server);
-            coap_session_release(g_dtls_session_to_central_server);
-            g_dtls_session_to_central_server = NULL;
-            creating_session = 0; // Desmarcar que estamos creando una sesión
-            return NULL;
-        }
-        
-        wait_count++;
-    }
-    
-    LOG_ERROR_GW("[SessionHelper] Timeout esperando establecimiento de nueva sesión DTLS-PSK (0x%p).", 
-               (void*)g_dtls_session_to_central_server);
-    coap_session_release(g_dtls_session_to_central_server);
-    g_dtls_session_to_central_server = NULL;
-    creating_session = 0; // Desmarcar que estamos creando una sesión
-    return NULL;
+    return g_dtls_session_to_central_server;
 }
 // --- Fin: Gestión de Sesión DTLS Global para Servidor Central ---
 
 /**
- * @brief Simula un paso de movimiento para todos los ascensores del grupo
- * @param ctx Contexto CoAP para logging y operaciones
- * @param group Grupo de ascensores a simular
- * 
- * Esta función implementa la lógica de simulación de movimiento de ascensores.
- * Se ejecuta periódicamente para actualizar el estado de todos los ascensores
- * que tienen tareas asignadas.
- * 
- * Funcionalidades implementadas:
- * - **Cierre de puertas**: Cierra puertas antes del movimiento
- * - **Determinación de dirección**: Calcula dirección basada en destino
- * - **Simulación de movimiento**: Mueve ascensores piso por piso
- * - **Detección de llegada**: Detecta cuando un ascensor llega a su destino
- * - **Completado de tareas**: Notifica llegadas y libera ascensores
- * 
- * La simulación maneja los siguientes estados:
- * - Ascensores ocupados con destino válido
- * - Movimiento hacia arriba (MOVING_UP)
- * - Movimiento hacia abajo (MOVING_DOWN)
- * - Llegada a destino y liberación
- * 
- * @see elevator_group_state_t
- * @see elevator_status_t
+ * @brief Callback del temporizador de paso de simulación
+ * @param arg No utilizado
+ *
+ * Avanza la simulación cinemática de todos los edificios registrados en
+ * building_registry.h hasta el instante actual (elevator_kinematics.h).
  */
-static void 
-simulate_elevator_group_step(coap_context_t *ctx, elevator_group_state_t *group) {
-    // Agregar logging detallado para diagnóstico
-    static int debug_counter = 0;
-    debug_counter++;
-    
-    // Log cada 10 iteraciones para no saturar los logs
-    if (debug_counter % 10 == 0) {
-        LOG_DEBUG_GW("[SimStep] === DIAGNÓSTICO SIMULADOR === Iteración %d", debug_counter);
-        LOG_DEBUG_GW("[SimStep] Grupo: %s, Ascensores: %d", 
-                    group ? group->edificio_id_str_grupo : "NULL",
-                    group ? group->num_elevadores_en_grupo : 0);
-    }
-    
-    if (!ctx || !group) {
-        LOG_ERROR_GW("[SimStep] Error: ctx o group es NULL.");
-        return;
-    }
+static void on_sim_step_timer(void *arg) {
+    (void)arg;
+    gw_apply_pending_config_reload();
+    gw_kinematics_advance(gw_tracker_now_ms());
+    gw_state_store_sync();
+    gw_journal_flush();
+}
 
-    int ascensores_ocupados = 0;
-    int ascensores_moviendo = 0;
-    
-    for (int i = 0; i < group->num_elevadores_en_grupo; ++i) {
-        elevator_status_t *elevator = &group->ascensores[i];
-        
-        // Contar ascensores ocupados
-        if (elevator->ocupado) {
-            ascensores_ocupados++;
-        }
-        
-        // Log detallado cada 10 iteraciones
-        if (debug_counter % 10 == 0) {
-            LOG_DEBUG_GW("[SimStep] Ascensor %s: Piso=%d, Destino=%d, Ocupado=%s, Tarea=%s", 
-                        elevator->ascensor_id,
-                        elevator->piso_actual,
-                        elevator->destino_actual,
-                        elevator->ocupado ? "SÍ" : "NO",
-                        elevator->tarea_actual_id[0] != '\0' ? elevator->tarea_actual_id : "NINGUNA");
-        }
+/**
+ * @brief Reenvía al servidor central una solicitud CAN recuperada del fichero de estado
+ * @param request Solicitud recuperada
+ * @param arg Contexto CoAP del gateway
+ */
+static void on_state_request_restored(const can_origin_tracker_t *request, void *arg) {
+    ag_can_bridge_resubmit_request((coap_context_t *)arg, request);
+}
 
-        if (elevator->ocupado && elevator->destino_actual != -1) {
-            ascensores_moviendo++;
-            
-            if (elevator->piso_actual != elevator->destino_actual) {
-                // Simulate door closing if it was open before movement
-                if (elevator->estado_puerta_enum != DOOR_CLOSED) {
-                    LOG_DEBUG_GW("[SimStep] Ascensor %s cerrando puertas en piso %d para moverse.", elevator->ascensor_id, elevator->piso_actual);
-                    elevator->estado_puerta_enum = DOOR_CLOSED; 
-                    // In a more complex sim, add DOOR_CLOSING state and delay
-                }
-
-                // Determine direction if somehow not set (should be set by assign_task)
-                if (elevator->direccion_movimiento_enum == STOPPED || elevator->direccion_movimiento_enum == DIRECTION_UNKNOWN) {
-                    if (elevator->destino_actual > elevator->piso_actual) {
-                        elevator->direccion_movimiento_enum = MOVING_UP;
-                    } else if (elevator->destino_actual < elevator->piso_actual) {
-                        elevator->direccion_movimiento_enum = MOVING_DOWN;
-                    }
-                }
-
-                // Simulate movement
-                if (elevator->direccion_movimiento_enum == MOVING_UP) {
-                    elevator->piso_actual++;
-                    LOG_INFO_GW("[SimStep] Ascensor %s SUBE a piso %d (Destino: %d, Tarea: %s)", 
-                                elevator->ascensor_id, elevator->piso_actual, elevator->destino_actual, elevator->tarea_actual_id);
-                } else if (elevator->direccion_movimiento_enum == MOVING_DOWN) {
-                    elevator->piso_actual--;
-                    LOG_INFO_GW("[SimStep] Ascensor %s BAJA a piso %d (Destino: %d, Tarea: %s)", 
-                                elevator->ascensor_id, elevator->piso_actual, elevator->destino_actual, elevator->tarea_actual_id);
-                } else {
-                     // Should not happen if moving, but good to log
-                    LOG_WARN_GW("[SimStep] Ascensor %s ocupado con destino %d pero dirección %s. No se mueve.", 
-                                elevator->ascensor_id, elevator->destino_actual, movement_direction_to_string(elevator->direccion_movimiento_enum));
-                }
-
-                // Check for arrival
-                if (elevator->piso_actual == elevator->destino_actual) {
-                    LOG_INFO_GW("[SimStep] Ascensor %s LLEGÓ a destino %d.", elevator->ascensor_id, elevator->destino_actual);
-                    
-                    LOG_INFO_GW("StateMgr: Ascensor %s completó tarea %s en piso %d.", 
-                                elevator->ascensor_id, 
-                                elevator->tarea_actual_id[0] != '\0' ? elevator->tarea_actual_id : "N/A", 
-                                elevator->piso_actual);
-                    
-                    // Registrar completación de tarea en el logger
-                    if (elevator->tarea_actual_id[0] != '\0') {
-                        exec_logger_log_task_completed(elevator->tarea_actual_id, elevator->ascensor_id, elevator->piso_actual);
-                    }
-                    
-                    elevator->estado_puerta_enum = DOOR_OPEN;
-                    elevator->ocupado = false;
-                    elevator->tarea_actual_id[0] = '\0'; // Limpiar ID de tarea
-                    elevator->destino_actual = -1;        // Limpiar destino
-                    elevator->direccion_movimiento_enum = STOPPED;
-                    
-                    LOG_INFO_GW("[SimStep] Tarea completada por %s.", elevator->ascensor_id);
-                }
-            } else { // Already at destination, but still marked occupied? 
-                     // This could happen if a task was to the current floor.
-                LOG_DEBUG_GW("[SimStep] Ascensor %s está ocupado y en su destino %d. Verificando si la tarea debe completarse.", 
-                             elevator->ascensor_id, elevator->destino_actual);
-                
-                LOG_INFO_GW("StateMgr: Ascensor %s completó tarea %s en piso %d.", 
-                            elevator->ascensor_id, 
-                            elevator->tarea_actual_id[0] != '\0' ? elevator->tarea_actual_id : "N/A", 
-                            elevator->piso_actual);
-                
-                // Registrar completación de tarea en el logger
-                if (elevator->tarea_actual_id[0] != '\0') {
-                    exec_logger_log_task_completed(elevator->tarea_actual_id, elevator->ascensor_id, elevator->piso_actual);
-                }
-                
-                elevator->estado_puerta_enum = DOOR_OPEN;
-                elevator->ocupado = false;
-                elevator->tarea_actual_id[0] = '\0'; // Limpiar ID de tarea
-                elevator->destino_actual = -1;        // Limpiar destino
-                elevator->direccion_movimiento_enum = STOPPED;
-                
-                LOG_INFO_GW("[SimStep] Tarea completada por %s (estaba en destino).", elevator->ascensor_id);
-            }
-        } // end if (elevator->ocupado && elevator->destino_actual != -1)
-    } // end for each elevator
-    
-    // Log estadísticas cada 10 iteraciones
-    if (debug_counter % 10 == 0) {
-        LOG_DEBUG_GW("[SimStep] ESTADÍSTICAS: Ocupados=%d, Moviendo=%d, Total=%d", 
-                    ascensores_ocupados, ascensores_moviendo, group->num_elevadores_en_grupo);
-    }
+/**
+ * @brief Callback del temporizador de inyección de peticiones simuladas
+ * @param arg No utilizado
+ */
+static void on_sim_request_timer(void *arg) {
+    (void)arg;
+    procesar_siguiente_peticion_simulacion();
+}
+
+/**
+ * @brief Deadline del temporizador de inyección: la próxima petición programada
+ * @param arg No utilizado
+ * @return Instante en ns de CLOCK_MONOTONIC, o 0 si la simulación terminó
+ */
+static uint64_t sim_request_deadline(void *arg) {
+    (void)arg;
+    return obtener_proxima_peticion_simulacion_ns();
 }
 
 /**
@@ -620,53 +433,48 @@ int main(int argc, char *argv[]) {
     }
     coap_context_t  *ctx = NULL;      // CoAP context
     coap_address_t   listen_addr;    // Address for the gateway to listen on
-    int result;                       // Result of CoAP I/O operations
-    // Obtener y limpiar el puerto
-    const char* port_raw = getenv("GW_LISTEN_PORT") ?: "5683";
-    char port_str[8];
-    strncpy(port_str, port_raw, sizeof(port_str) - 1);
-    port_str[sizeof(port_str) - 1] = '\0';
-    
-    // Remover caracteres de nueva línea
-    char *newline_port = strchr(port_str, '\n');
-    if (newline_port) *newline_port = '\0';
-    newline_port = strchr(port_str, '\r');
-    if (newline_port) *newline_port = '\0';
-    
-    int listen_port = atoi(port_str); // Puerto por defecto
-    
-    // Debug: mostrar valores cargados
-    printf("API Gateway: GW_LISTEN_IP = '%s'\n", getenv("GW_LISTEN_IP") ?: "NULL");
-    printf("API Gateway: GW_LISTEN_PORT = '%s'\n", getenv("GW_LISTEN_PORT") ?: "NULL");
+    int result;                       // Result of the event loop
 
     // Procesar argumentos de línea de comandos
+    uint16_t port_override = 0;
     if (argc > 1) {
         int custom_port = atoi(argv[1]);
         if (custom_port >= 1024 && custom_port <= 65535) {
-            listen_port = custom_port;
-            printf("API Gateway: Usando puerto personalizado %d\n", listen_port);
+            port_override = (uint16_t)custom_port;
+            printf("API Gateway: Usando puerto personalizado %d\n", custom_port);
         } else {
             fprintf(stderr, "Error: Puerto debe estar entre 1024 y 65535. Recibido: %s\n", argv[1]);
             printf("Uso: %s [puerto_escucha]\n", argv[0]);
             return EXIT_FAILURE;
         }
     } else {
-        printf("API Gateway: Usando puerto por defecto %d\n", listen_port);
         printf("Uso: %s [puerto_escucha] (opcional)\n", argv[0]);
     }
 
+    // Configuración validada una sola vez; SIGHUP la vuelve a leer
+    if (gw_config_load("gateway.env", port_override) != 0) {
+        fprintf(stderr, "API Gateway: Configuración inválida en gateway.env.\n");
+        return EXIT_FAILURE;
+    }
+    const gw_config_t *config = gw_config();
+    int listen_port = config->listen_port;
+    printf("API Gateway: Escuchando en %s:%d\n", config->listen_ip, listen_port);
+
     // Register the signal handler for SIGINT (Ctrl+C) for graceful shutdown.
     // Uses handle_sigint_gw from api_handlers.c
     signal(SIGINT, handle_sigint_gw); 
+    signal(SIGHUP, gw_config_handle_sighup);
 
-    // Seed the random number generator (if any CoAP operations rely on randomness, e.g. MIDs/Tokens if not handled by libcoap)
-    srand(time(NULL)); 
+    // Semilla de la selección de edificio y de clave PSK (GW_SIM_SEED); libcoap usa su propio generador
+    LOG_INFO_GW("[Main] Semilla del generador: %llu", (unsigned long long)gw_prng_global_seed(config->sim_seed));
 
     // Initialize the CoAP library stack.
     coap_startup();
 
     // INICIALIZAR EL PUENTE CAN SIMULADO
     ag_can_bridge_init();
+    gw_tracker_init();
+    gw_tracker_set_timeout_ms(gw_config_request_lifetime_ms(config));
     // NOTA: Tu simulación de ascensor C deberá llamar a 
     // ag_can_bridge_register_send_callback(tu_funcion_callback_can);
     // en algún momento después de esto y antes de enviar datos.
@@ -675,22 +483,8 @@ int main(int argc, char *argv[]) {
     coap_address_init(&listen_addr);
     listen_addr.addr.sin.sin_family = AF_INET; // IPv4
     
-    // Convert the listen IP string (from coap_config.h) to a network address.
-    const char* listen_ip_raw = getenv("GW_LISTEN_IP") ?: "0.0.0.0";
-    
-    // Limpiar caracteres de nueva línea del valor
-    char listen_ip[16];
-    strncpy(listen_ip, listen_ip_raw, sizeof(listen_ip) - 1);
-    listen_ip[sizeof(listen_ip) - 1] = '\0';
-    
-    // Remover caracteres de nueva línea
-    char *newline = strchr(listen_ip, '\n');
-    if (newline) *newline = '\0';
-    newline = strchr(listen_ip, '\r');
-    if (newline) *newline = '\0';
-    
-
-    
+    // Convert the listen IP string (GW_LISTEN_IP, ya validada) to a network address.
+    const char *listen_ip = config->listen_ip;
     if (inet_pton(AF_INET, listen_ip, &listen_addr.addr.sin.sin_addr) != 1) {
         fprintf(stderr, "API Gateway: Error converting listen IP address '%s'. Check GW_LISTEN_IP in gateway.env. Error: %s\n", listen_ip, strerror(errno));
         coap_cleanup(); // Cleanup libcoap before exiting
@@ -715,6 +509,7 @@ int main(int argc, char *argv[]) {
     // Register the global response handler for client requests made BY THIS API Gateway.
     // This handler (hnd_central_server_response_gw) will process responses from the Central Server.
     coap_register_response_handler(ctx, hnd_central_server_response_gw);
+    coap_register_nack_handler(ctx, hnd_central_server_nack_gw);
 
     // Create the CoAP server endpoint where the API Gateway will listen for client requests.
     coap_endpoint_t *endpoint = coap_new_endpoint(ctx, &listen_addr, COAP_PROTO_UDP);
@@ -733,7 +528,8 @@ int main(int argc, char *argv[]) {
     // NOTA: La inicialización se hará desde la simulación JSON, no aquí
     // Por ejemplo, Edificio E1 con 4 ascensores y 14 plantas
     // Los IDs de los ascensores serán E1A1, E1A2, E1A3, E1A4
-    init_elevator_group(&managed_elevator_group, "E1", 4, 14); 
+    gw_building_registry_init();
+    gw_building_add("E1", 4, 14);
     LOG_INFO_GW("API Gateway: Grupo de %d ascensores para edificio '%s' inicializado.", 
                 managed_elevator_group.num_elevadores_en_grupo, 
                 managed_elevator_group.edificio_id_str_grupo);
@@ -753,43 +549,78 @@ int main(int argc, char *argv[]) {
         LOG_WARN_GW("[Main] No se pudo inicializar el sistema de logging de ejecuciones. Continuando sin logging.");
     }
 
+    // Diario binario opcional (GW_JOURNAL_FILE en gateway.env); se abre antes
+    // de registrar los edificios para que el diario incluya su configuración
+    if (config->journal_file[0] && gw_journal_open(config->journal_file) != 0) {
+        LOG_WARN_GW("[Main] No se pudo abrir el diario '%s'. Continuando sin diario.", config->journal_file);
+    }
+
     // Simular algunos eventos de ascensor una vez que todo está listo
     simular_eventos_ascensor();
+    gw_kinematics_init();
 
-    // Main I/O processing loop.
-    // This loop continuously processes incoming CoAP messages and handles I/O operations.
-    // It will run until quit_main_loop is set by the signal handler.
-    while (!quit_main_loop) {
-        // Process CoAP I/O for up to 100 milliseconds (0.1 seconds).
-        // This function handles sending, receiving, and retransmissions.
-        // Reducido de 500ms a 100ms para permitir simulación más frecuente
-        result = coap_io_process(ctx, 100); 
-        if (result < 0) {
-            fprintf(stderr, "API Gateway: Error in coap_io_process. Shutting down.\n");
-            break; // Exit loop on critical error
+    // Estado persistente opcional (GW_STATE_FILE en gateway.env): recupera
+    // posiciones, tareas y solicitudes CAN en vuelo de la ejecución anterior
+    if (config->state_file[0]) {
+        if (gw_state_store_open(config->state_file) == 0) {
+            gw_state_store_restore(on_state_request_restored, ctx);
+        } else {
+            LOG_WARN_GW("[Main] No se pudo abrir el fichero de estado '%s'. Continuando sin persistencia.", config->state_file);
         }
-        // result >= 0: milliseconds spent in I/O, or 0 if no I/O was ready within the timeout.
-
-        // --- Procesar siguiente petición de simulación no-bloqueante ---
-        procesar_siguiente_peticion_simulacion();
+    }
 
-        // --- Simulate elevator group step (movimiento ascensor) ---
-        simulate_elevator_group_step(ctx, &managed_elevator_group);
+    // Backend SocketCAN opcional (GW_CAN_INTERFACE=vcan0 en gateway.env).
+    // Sustituye al callback del simulador para las respuestas CAN.
+    bool socketcan_active = false;
+    if (config->can_interface[0]) {
+        int can_fd = ag_socketcan_open(config->can_interface, ctx);
+        if (can_fd >= 0) {
+            gw_event_loop_watch_fd(can_fd, ag_socketcan_on_readable, NULL);
+            gw_event_loop_set_flush_hook(ag_socketcan_flush, NULL);
+            socketcan_active = true;
+        } else {
+            LOG_WARN_GW("[Main] No se pudo abrir la interfaz CAN '%s'. Continuando con el simulador en proceso.", config->can_interface);
+        }
+    }
 
-        // --- Procesamiento de frames CAN simulados (si los hubiera encolados o por sondeo) ---
-        // Si tu simulación C llama directamente a ag_can_bridge_process_incoming_frame(),
-        // no necesitas un sondeo explícito aquí a menos que tengas un buffer intermedio.
-        // Por ejemplo, si tu simulación C se ejecuta en un hilo separado y encola frames:
-        // process_any_queued_can_frames(ctx);
+    // Main I/O processing loop.
+    // epoll duerme hasta que llega un datagrama CoAP, vence una retransmisión,
+    // toca un paso de simulación o expira una solicitud al servidor central.
+    // It will run until quit_main_loop is set by the signal handler.
+    const gw_loop_timer_t loop_timers[] = {
+        { "sim_step", config->sim_tick_ms, on_sim_step_timer, NULL, NULL },
+        { "sim_requests", 0, on_sim_request_timer, NULL, sim_request_deadline },
+    };
+    // Con un bus CAN real las peticiones llegan por el socket, no del simulador
+    size_t num_loop_timers = socketcan_active ? 1 : sizeof(loop_timers) / sizeof(loop_timers[0]);
+    result = gw_event_loop_run(ctx, loop_timers, num_loop_timers, &quit_main_loop);
+    if (result < 0) {
+        fprintf(stderr, "API Gateway: Error in event loop. Shutting down.\n");
     }
 
     printf("API Gateway: Shutting down...\n");
     
+    // Enviar respuestas CAN pendientes y cerrar el socket
+    ag_socketcan_close();
+
+    // Volcar el estado final (incluidas las solicitudes CAN en vuelo) y cerrar el fichero
+    gw_state_store_close();
+    gw_journal_close();
+    gw_kinematics_cleanup();
+
+    // Liberar trackers de solicitudes que siguen en vuelo
+    gw_tracker_cleanup();
+
+    // Liberar los grupos de ascensores de edificios adicionales
+    gw_building_registry_cleanup();
+
     // Finalizar gestor de claves PSK
     psk_manager_cleanup();
     
     // Finalizar sistema de logging de ejecuciones
     exec_logger_finish();
+
+    gw_config_cleanup();
     
     if (g_dtls_session_to_central_server) {
         LOG_INFO_GW("[Main] Liberando sesión DTLS global con servidor central (0x%p) al salir.", (void*)g_dtls_session_to_central_server);
@@ -26,6 +26,14 @@
 #include "api_gateway/api_handlers.h"
 #include "api_gateway/elevator_state_manager.h"
 #include "api_gateway/can_bridge.h"
+#include "api_gateway/request_tracker.h"
+#include "api_gateway/building_registry.h"
+#include "api_gateway/event_loop.h"
+#include "api_gateway/state_store.h"
+#include "api_gateway/state_journal.h"
+#include "api_gateway/gateway_config.h"
+#include "api_gateway/elevator_kinematics.h"
+#include "api_gateway/prng.h"
 #include <cJSON.h>
 #include "api_gateway/logging_gw.h"
 #include "api_gateway/execution_logger.h"
@@ -61,10 +69,23 @@ static coap_context_t *g_coap_context_for_session_mgnt = NULL;
 static int dynamic_listen_port = 5683;
 
 // Forward declarations
-static void simulate_elevator_group_step(coap_context_t *ctx, elevator_group_state_t *group);
 void inicializar_mi_simulacion_ascensor(void);
 void simular_eventos_ascensor(void);
 
+// Callback del temporizador de paso de simulación (modelo cinemático de todos los edificios)
+static void on_sim_step_timer(void *arg) {
+    (void)arg;
+    gw_apply_pending_config_reload();
+    gw_kinematics_advance(gw_tracker_now_ms());
+    gw_state_store_sync();
+    gw_journal_flush();
+}
+
+// Reenvía al servidor central una solicitud CAN recuperada del fichero de estado
+static void on_state_request_restored(const can_origin_tracker_t *request, void *arg) {
+    ag_can_bridge_resubmit_request((coap_context_t *)arg, request);
+}
+
 // Event handler (copiado del original)
 static int event_handler_gw(coap_session_t *session, coap_event_t event) {
     if (event == COAP_EVENT_DTLS_CLOSED || event == COAP_EVENT_DTLS_ERROR || 
@@ -125,11 +146,12 @@ coap_session_t* get_or_create_central_server_dtls_session(coap_context_t *ctx) {
     coap_address_init(&server_addr);
     server_addr.addr.sin.sin_family = AF_INET;
     
-    if (inet_pton(AF_INET, getenv("CENTRAL_SERVER_IP"), &server_addr.addr.sin.sin_addr) != 1) {
-        LOG_ERROR_GW("[SessionHelper] Error convirtiendo IP del servidor central: %s", getenv("CENTRAL_SERVER_IP"));
+    const gw_config_t *config = gw_config();
+    if (inet_pton(AF_INET, config->central_server_ip, &server_addr.addr.sin.sin_addr) != 1) {
+        LOG_ERROR_GW("[SessionHelper] Error convirtiendo IP del servidor central: %s", config->central_server_ip);
         return NULL;
     }
-    server_addr.addr.sin.sin_port = htons(atoi(getenv("CENTRAL_SERVER_PORT")));
+    server_addr.addr.sin.sin_port = htons(config->central_server_port);
 
     // Generar identidad y clave únicas para esta instancia
     char* unique_identity = generate_unique_identity();
@@ -149,105 +171,16 @@ coap_session_t* get_or_create_central_server_dtls_session(coap_context_t *ctx) {
     );
 
     if (!g_dtls_session_to_central_server) {
-        LOG_ERROR_GW("[SessionHelper] Error creando sesión DTLS con servidor central %s:%s", 
-                     getenv("CENTRAL_SERVER_IP"), getenv("CENTRAL_SERVER_PORT"));
+        LOG_ERROR_GW("[SessionHelper] Error creando sesión DTLS con servidor central %s:%u", 
+                     config->central_server_ip, config->central_server_port);
         return NULL;
     }
 
-    LOG_INFO_GW("[SessionHelper] Nueva sesión DTLS creada con servidor central %s:%s", 
-                getenv("CENTRAL_SERVER_IP"), getenv("CENTRAL_SERVER_PORT"));
+    LOG_INFO_GW("[SessionHelper] Nueva sesión DTLS creada con servidor central %s:%u", 
+                config->central_server_ip, config->central_server_port);
     return g_dtls_session_to_central_server;
 }
 
-// Simulación (copiada del original)
-static void simulate_elevator_group_step(coap_context_t *ctx, elevator_group_state_t *group) {
-    if (!group || group->num_elevadores_en_grupo <= 0) {
-        return;
-    }
-
-    for (int i = 0; i < group->num_elevadores_en_grupo; ++i) {
-        elevator_status_t *elevator = &group->ascensores[i];
-
-        if (elevator->ocupado && elevator->destino_actual != -1) {
-            if (elevator->piso_actual != elevator->destino_actual) {
-                // Cerrar puertas antes del movimiento
-                if (elevator->estado_puerta_enum != DOOR_CLOSED) {
-                    LOG_DEBUG_GW("[SimStep] Ascensor %s cerrando puertas en piso %d.", 
-                                 elevator->ascensor_id, elevator->piso_actual);
-                    elevator->estado_puerta_enum = DOOR_CLOSED;
-                }
-
-                // Determinar dirección
-                if (elevator->direccion_movimiento_enum == STOPPED || 
-                    elevator->direccion_movimiento_enum == DIRECTION_UNKNOWN) {
-                    if (elevator->destino_actual > elevator->piso_actual) {
-                        elevator->direccion_movimiento_enum = MOVING_UP;
-                    } else if (elevator->destino_actual < elevator->piso_actual) {
-                        elevator->direccion_movimiento_enum = MOVING_DOWN;
-                    }
-                }
-
-                // Simular movimiento
-                if (elevator->direccion_movimiento_enum == MOVING_UP) {
-                    elevator->piso_actual++;
-                    LOG_INFO_GW("[SimStep] Ascensor %s SUBE a piso %d (Destino: %d)", 
-                                elevator->ascensor_id, elevator->piso_actual, elevator->destino_actual);
-                } else if (elevator->direccion_movimiento_enum == MOVING_DOWN) {
-                    elevator->piso_actual--;
-                    LOG_INFO_GW("[SimStep] Ascensor %s BAJA a piso %d (Destino: %d)", 
-                                elevator->ascensor_id, elevator->piso_actual, elevator->destino_actual);
-                }
-
-                // Verificar llegada
-                if (elevator->piso_actual == elevator->destino_actual) {
-                    LOG_INFO_GW("[SimStep] Ascensor %s LLEGÓ a destino %d.", 
-                                elevator->ascensor_id, elevator->destino_actual);
-                    
-                    LOG_INFO_GW("StateMgr: Ascensor %s completó tarea %s en piso %d.", 
-                                elevator->ascensor_id, 
-                                elevator->tarea_actual_id[0] != '\0' ? elevator->tarea_actual_id : "N/A", 
-                                elevator->piso_actual);
-                    
-                    // Registrar completación de tarea en el logger
-                    if (elevator->tarea_actual_id[0] != '\0') {
-                        exec_logger_log_task_completed(elevator->tarea_actual_id, elevator->ascensor_id, elevator->piso_actual);
-                    }
-                    
-                    elevator->estado_puerta_enum = DOOR_OPEN;
-                    elevator->ocupado = false;
-                    elevator->tarea_actual_id[0] = '\0'; // Limpiar ID de tarea
-                    elevator->destino_actual = -1;        // Limpiar destino
-                    elevator->direccion_movimiento_enum = STOPPED;
-                    
-                    LOG_INFO_GW("[SimStep] Tarea completada por %s.", elevator->ascensor_id);
-                }
-            } else {
-                // Ya en destino
-                LOG_DEBUG_GW("[SimStep] Ascensor %s está ocupado y en su destino %d.", 
-                             elevator->ascensor_id, elevator->destino_actual);
-                
-                LOG_INFO_GW("StateMgr: Ascensor %s completó tarea %s en piso %d.", 
-                            elevator->ascensor_id, 
-                            elevator->tarea_actual_id[0] != '\0' ? elevator->tarea_actual_id : "N/A", 
-                            elevator->piso_actual);
-                
-                // Registrar completación de tarea en el logger
-                if (elevator->tarea_actual_id[0] != '\0') {
-                    exec_logger_log_task_completed(elevator->tarea_actual_id, elevator->ascensor_id, elevator->piso_actual);
-                }
-                
-                elevator->estado_puerta_enum = DOOR_OPEN;
-                elevator->ocupado = false;
-                elevator->tarea_actual_id[0] = '\0'; // Limpiar ID de tarea
-                elevator->destino_actual = -1;        // Limpiar destino
-                elevator->direccion_movimiento_enum = STOPPED;
-                
-                LOG_INFO_GW("[SimStep] Tarea completada por %s (estaba en destino).", elevator->ascensor_id);
-            }
-        }
-    }
-}
-
 /**
  * @brief Función principal del API Gateway con puerto dinámico
  * @param argc Número de argumentos de línea de comandos
@@ -285,34 +218,48 @@ int main(int argc, char *argv[]) {
     int result;
 
     // Procesar argumentos de línea de comandos
+    int port_override = 0;
     if (argc > 1) {
-        dynamic_listen_port = atoi(argv[1]);
-        if (dynamic_listen_port < 1024 || dynamic_listen_port > 65535) {
-            fprintf(stderr, "Error: Puerto debe estar entre 1024 y 65535. Recibido: %d\n", dynamic_listen_port);
+        port_override = atoi(argv[1]);
+        if (port_override < 1024 || port_override > 65535) {
+            fprintf(stderr, "Error: Puerto debe estar entre 1024 y 65535. Recibido: %d\n", port_override);
             return EXIT_FAILURE;
         }
+    }
+
+    // Configuración validada una sola vez; SIGHUP la vuelve a leer
+    if (gw_config_load("gateway.env", (uint16_t)port_override) != 0) {
+        fprintf(stderr, "Error: Configuración inválida en gateway.env.\n");
+        return EXIT_FAILURE;
+    }
+    const gw_config_t *config = gw_config();
+    dynamic_listen_port = config->listen_port;
+    if (port_override) {
         printf("API Gateway: Usando puerto dinámico %d\n", dynamic_listen_port);
     } else {
         printf("API Gateway: Usando puerto por defecto %d\n", dynamic_listen_port);
         printf("Uso: %s [puerto_escucha]\n", argv[0]);
     }
 
-    // Registrar manejador de señales
+    // Registrar manejadores de señales
     signal(SIGINT, handle_sigint_gw);
-    srand(time(NULL));
+    signal(SIGHUP, gw_config_handle_sighup);
+    LOG_INFO_GW("[Main] Semilla del generador: %llu", (unsigned long long)gw_prng_global_seed(config->sim_seed));
 
     // Inicializar CoAP
     coap_startup();
 
     // Inicializar puente CAN
     ag_can_bridge_init();
+    gw_tracker_init();
+    gw_tracker_set_timeout_ms(gw_config_request_lifetime_ms(config));
 
     // Preparar dirección de escucha
     coap_address_init(&listen_addr);
     listen_addr.addr.sin.sin_family = AF_INET;
     
-    if (inet_pton(AF_INET, getenv("GW_LISTEN_IP"), &listen_addr.addr.sin.sin_addr) != 1) {
-        fprintf(stderr, "Error convirtiendo IP de escucha '%s': %s\n", getenv("GW_LISTEN_IP"), strerror(errno));
+    if (inet_pton(AF_INET, config->listen_ip, &listen_addr.addr.sin.sin_addr) != 1) {
+        fprintf(stderr, "Error convirtiendo IP de escucha '%s': %s\n", config->listen_ip, strerror(errno));
         coap_cleanup();
         return EXIT_FAILURE;
     }
@@ -330,6 +277,7 @@ int main(int argc, char *argv[]) {
     g_coap_context_for_session_mgnt = ctx;
     coap_register_event_handler(ctx, event_handler_gw);
     coap_register_response_handler(ctx, hnd_central_server_response_gw);
+    coap_register_nack_handler(ctx, hnd_central_server_nack_gw);
 
     // Crear endpoint de escucha
     coap_endpoint_t *endpoint = coap_new_endpoint(ctx, &listen_addr, COAP_PROTO_UDP);
@@ -341,11 +289,12 @@ int main(int argc, char *argv[]) {
     }
 
     printf("API Gateway: Escuchando en %s:%d para mensajes CoAP (UDP).\n", 
-           getenv("GW_LISTEN_IP"), dynamic_listen_port);
+           config->listen_ip, dynamic_listen_port);
     printf("(Ctrl+C para salir)\n");
 
     // Inicializar grupo de ascensores
-    init_elevator_group(&managed_elevator_group, "E1", 4, 14);
+    gw_building_registry_init();
+    gw_building_add("E1", 4, 14);
     LOG_INFO_GW("API Gateway: Grupo de %d ascensores para edificio '%s' inicializado.", 
                 managed_elevator_group.num_elevadores_en_grupo, 
                 managed_elevator_group.edificio_id_str_grupo);
@@ -358,24 +307,45 @@ int main(int argc, char *argv[]) {
         LOG_WARN_GW("[Main] No se pudo inicializar el sistema de logging. Continuando sin logging.");
     }
 
+    // Diario binario opcional: un fichero por puerto, abierto antes de registrar los edificios
+    if (config->journal_file[0]) {
+        char journal_file[GW_CONFIG_FILE_MAX + 8];
+        snprintf(journal_file, sizeof(journal_file), "%s.%d", config->journal_file, dynamic_listen_port);
+        gw_journal_open(journal_file);
+    }
+
     // Simular eventos
     simular_eventos_ascensor();
-
-    // Bucle principal
-    while (!quit_main_loop) {
-        result = coap_io_process(ctx, 500);
-        if (result < 0) {
-            fprintf(stderr, "Error en coap_io_process. Cerrando.\n");
-            break;
+    gw_kinematics_init();
+
+    // Estado persistente opcional: un fichero por puerto para no compartirlo entre instancias
+    if (config->state_file[0]) {
+        char state_file[GW_CONFIG_FILE_MAX + 8];
+        snprintf(state_file, sizeof(state_file), "%s.%d", config->state_file, dynamic_listen_port);
+        if (gw_state_store_open(state_file) == 0) {
+            gw_state_store_restore(on_state_request_restored, ctx);
         }
+    }
 
-        simulate_elevator_group_step(ctx, &managed_elevator_group);
+    // Bucle principal
+    const gw_loop_timer_t loop_timers[] = {
+        { "sim_step", config->sim_tick_ms, on_sim_step_timer, NULL, NULL },
+    };
+    result = gw_event_loop_run(ctx, loop_timers, sizeof(loop_timers) / sizeof(loop_timers[0]), &quit_main_loop);
+    if (result < 0) {
+        fprintf(stderr, "Error en el bucle de eventos. Cerrando.\n");
     }
 
     printf("API Gateway: Cerrando...\n");
     
     // Limpieza
     exec_logger_finish();
+    gw_state_store_close();
+    gw_journal_close();
+    gw_kinematics_cleanup();
+    gw_tracker_cleanup();
+    gw_building_registry_cleanup();
+    gw_config_cleanup();
     
     if (g_dtls_session_to_central_server) {
         LOG_INFO_GW("[Main] Liberando sesión DTLS global al salir.");
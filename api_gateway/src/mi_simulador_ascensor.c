@@ -23,8 +23,16 @@
  * procesar eventos y recibir respuestas del servidor central.
  * 
  * **Sistema de simulación JSON:**
- * Cada ejecución del API Gateway carga un archivo JSON con 100 edificios,
- * selecciona uno aleatoriamente y ejecuta sus 10 peticiones secuencialmente.
+ * Cada ejecución del API Gateway lee un archivo JSON con 100 edificios.
+ * Por defecto selecciona uno aleatoriamente y ejecuta sus 10 peticiones
+ * secuencialmente. Con GW_SIM_NUM_BUILDINGS=N en gateway.env simula los N
+ * primeros edificios en el mismo proceso, uno por índice del registro de
+ * edificios (building_registry.h). El archivo se lee en streaming y solo se
+ * cargan en memoria los edificios que se van a simular.
+ * 
+ * Las peticiones se programan en una cola de eventos discretos
+ * (sim_event_queue.h) cuyo reloj virtual sigue al reloj monotónico; la
+ * misma programación la ejecuta gw_headless_sim sin esperas.
  * 
  * @see can_bridge.h
  * @see elevator_state_manager.h
@@ -35,6 +43,10 @@
 #include "api_gateway/elevator_state_manager.h"
 #include "api_gateway/simulation_loader.h"
 #include "api_gateway/execution_logger.h"
+#include "api_gateway/building_registry.h" // Edificios simulados en el proceso
+#include "api_gateway/gateway_config.h"    // GW_SIM_NUM_BUILDINGS, GW_SIM_PLAYBACK_SPEED
+#include "api_gateway/sim_event_queue.h"   // Peticiones programadas
+#include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <unistd.h>
@@ -52,17 +64,6 @@
  */
 extern coap_context_t *g_coap_context;
 
-/**
- * @brief Grupo de ascensores gestionado
- * 
- * Referencia externa al grupo de ascensores principal definido en
- * main.c. Se utiliza para configurar el ID del edificio durante
- * la simulación.
- * 
- * @see elevator_group_state_t
- */
-extern elevator_group_state_t managed_elevator_group;
-
 /**
  * @brief Datos de simulación cargados desde JSON
  * 
@@ -71,12 +72,56 @@ extern elevator_group_state_t managed_elevator_group;
  */
 static datos_simulacion_t datos_simulacion_global;
 
+/**
+ * @brief Progreso de la simulación de un edificio
+ */
+typedef struct {
+    edificio_simulacion_t *edificio; ///< Datos del edificio cargados desde JSON
+    uint16_t building_index;         ///< Índice en el registro de edificios
+    int peticiones_ejecutadas;       ///< Peticiones ya enviadas al gateway
+    plan_peticiones_t plan;          ///< Programación de sus peticiones en la cola de eventos
+} edificio_en_simulacion_t;
+
 // Variables globales para manejo de simulación no-bloqueante
 static bool simulacion_activa = false;
-static int peticion_actual_index = 0;
-static edificio_simulacion_t *edificio_actual = NULL;
-static time_t tiempo_ultima_peticion = 0;
-static const int INTERVALO_PETICIONES_MS = 2000; // 2 segundos entre peticiones
+static edificio_en_simulacion_t edificios_en_simulacion[GW_MAX_BUILDINGS];
+static int num_edificios_en_simulacion = 0;
+
+static void enviar_llamada_de_piso_via_can(uint16_t building_index, int piso_origen, movement_direction_enum_t direccion);
+static void enviar_solicitud_cabina_via_can(uint16_t building_index, int indice_ascensor, int piso_destino);
+static void ejecutar_peticion_programada(gw_sim_queue_t *cola, const gw_sim_event_t *evento);
+static gw_sim_queue_t cola_peticiones;        ///< Peticiones pendientes (reloj virtual relativo al inicio)
+static uint64_t origen_simulacion_ns = 0;     ///< CLOCK_MONOTONIC (ns) en que el reloj virtual valía base_virtual_ms
+static uint64_t base_virtual_ms = 0;          ///< Reloj virtual en origen_simulacion_ns
+static double velocidad_reproduccion = 1.0;   ///< GW_SIM_PLAYBACK_SPEED vigente desde origen_simulacion_ns
+static const int INTERVALO_PETICIONES_MS = 2000; // 2 segundos entre peticiones sin "instante_ms"
+
+/**
+ * @brief Lee CLOCK_MONOTONIC en nanosegundos
+ */
+static uint64_t reloj_monotonico_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Aplica un cambio de GW_SIM_PLAYBACK_SPEED (recarga con SIGHUP)
+ * @param ahora_ns Instante actual de CLOCK_MONOTONIC
+ *
+ * El tramo ya transcurrido conserva el multiplicador anterior: el reloj
+ * virtual sigue desde donde estaba, solo cambia su ritmo.
+ */
+static void actualizar_velocidad_reproduccion(uint64_t ahora_ns) {
+    double velocidad = gw_config()->sim_playback_speed;
+    if (velocidad == velocidad_reproduccion) {
+        return;
+    }
+    base_virtual_ms += (uint64_t)((double)(ahora_ns - origen_simulacion_ns) * velocidad_reproduccion / 1e6);
+    origen_simulacion_ns = ahora_ns;
+    printf("[SIM_ASCENSOR] Velocidad de reproducción: x%.2f -> x%.2f\n", velocidad_reproduccion, velocidad);
+    velocidad_reproduccion = velocidad;
+}
 
 /**
  * @brief Callback para recibir frames CAN de respuesta del gateway
@@ -87,7 +132,8 @@ static const int INTERVALO_PETICIONES_MS = 2000; // 2 segundos entre peticiones
  * diferentes tipos de frames CAN de respuesta:
  * 
  * **Tipos de frames procesados:**
- * - 0x101: Respuesta a llamada de piso (0x100)
+ * - 0x101: Respuesta a llamada de piso (0x100); data[0] =
+ *   GW_CAN_ELEVATOR_PENDING si la llamada aún no tiene ascensor
  * - 0x201: Respuesta a solicitud de cabina (0x200)
  * - 0xFE: Error genérico del gateway
  * 
@@ -117,16 +163,16 @@ void mi_simulador_recibe_can_gw(simulated_can_frame_t* frame) {
            frame->dlc > 6 ? frame->data[6] : 0,
            frame->dlc > 7 ? frame->data[7] : 0);
 
-    // Registrar frame CAN recibido en el logger
-    char description[128];
+    // Registrar frame CAN recibido en el logger (descripción fija: los datos van en el frame)
+    const char *description;
     if (frame->id == 0x101) {
-        snprintf(description, sizeof(description), "Respuesta de llamada de piso del Gateway");
+        description = "Respuesta de llamada de piso del Gateway";
     } else if (frame->id == 0x201) {
-        snprintf(description, sizeof(description), "Respuesta de solicitud de cabina del Gateway");
+        description = "Respuesta de solicitud de cabina del Gateway";
     } else if (frame->id == 0xFE) {
-        snprintf(description, sizeof(description), "Error reportado por el Gateway");
+        description = "Error reportado por el Gateway";
     } else {
-        snprintf(description, sizeof(description), "Frame de respuesta desconocido del Gateway");
+        description = "Frame de respuesta desconocido del Gateway";
     }
     exec_logger_log_can_received(frame->id, frame->dlc, frame->data, description);
 
@@ -134,6 +180,10 @@ void mi_simulador_recibe_can_gw(simulated_can_frame_t* frame) {
     if (frame->id == 0x101) { // Respuesta a llamada de piso (0x100)
         if (frame->dlc >= 1) {
             int ascensor_idx_asignado = frame->data[0]; // Asume que el byte 0 es el índice del ascensor
+            if (ascensor_idx_asignado == GW_CAN_ELEVATOR_PENDING) {
+                printf("    Simulador -> Llamada de piso registrada, asignación pendiente.\n");
+                return;
+            }
             printf("    Simulador -> Respuesta de llamada de piso: Ascensor (índice %d) asignado.\n", ascensor_idx_asignado);
             if (frame->dlc > 1) {
                 char tarea_id_parcial[8] = {0};
@@ -170,12 +220,15 @@ void mi_simulador_recibe_can_gw(simulated_can_frame_t* frame) {
  * 
  * **Operaciones realizadas:**
  * - Registro del callback de respuesta CAN
- * - Carga de datos de simulación desde JSON
+ * - Carga desde GW_SIM_SCENARIO_FILE (JSON o binario compilado) de los
+ *   edificios a simular: uno aleatorio o los
+ *   GW_SIM_NUM_BUILDINGS primeros (gw_config_load() debe haberse llamado)
  * - Inicialización de estructuras internas
  * - Configuración de logging del simulador
  * 
  * @see ag_can_bridge_register_send_callback()
- * @see cargar_datos_simulacion()
+ * @see cargar_edificio_aleatorio()
+ * @see cargar_primeros_edificios()
  * @see mi_simulador_recibe_can_gw()
  */
 void inicializar_mi_simulacion_ascensor(void) {
@@ -183,10 +236,15 @@ void inicializar_mi_simulacion_ascensor(void) {
     printf("[SIM_ASCENSOR] Simulador de ascensor inicializado y callback CAN registrado.\n");
 
     // Cargar datos de simulación desde JSON
-    const char *archivo_simulacion = "simulation_data.json";
+    const char *archivo_simulacion = gw_config()->sim_scenario_file;
     printf("[SIM_ASCENSOR] Intentando cargar datos de simulación desde: %s\n", archivo_simulacion);
     
-    if (cargar_datos_simulacion(archivo_simulacion, &datos_simulacion_global)) {
+    int num_solicitados = gw_config()->sim_num_buildings;
+    if (num_solicitados > GW_MAX_BUILDINGS) num_solicitados = GW_MAX_BUILDINGS;
+    bool cargado = (num_solicitados <= 1)
+        ? cargar_edificio_aleatorio(archivo_simulacion, &datos_simulacion_global)
+        : cargar_primeros_edificios(archivo_simulacion, num_solicitados, &datos_simulacion_global);
+    if (cargado) {
         printf("[SIM_ASCENSOR] Datos de simulación cargados exitosamente desde %s\n", archivo_simulacion);
         printf("[SIM_ASCENSOR] Edificios cargados: %d, Datos válidos: %s\n", 
                datos_simulacion_global.num_edificios, 
@@ -221,6 +279,16 @@ void inicializar_mi_simulacion_ascensor(void) {
  * @see movement_direction_enum_t
  */
 void simular_llamada_de_piso_via_can(int piso_origen, movement_direction_enum_t direccion) {
+    enviar_llamada_de_piso_via_can(GW_BUILDING_INDEX_DEFAULT, piso_origen, direccion);
+}
+
+/**
+ * @brief Envía una llamada de piso simulada del bus CAN de un edificio
+ * @param building_index Índice del edificio en el registro
+ * @param piso_origen Piso desde el cual se realiza la llamada
+ * @param direccion Dirección solicitada (MOVING_UP o MOVING_DOWN)
+ */
+static void enviar_llamada_de_piso_via_can(uint16_t building_index, int piso_origen, movement_direction_enum_t direccion) {
     if (!g_coap_context) {
         printf("[SIM_ASCENSOR] Error: Contexto CoAP de Gateway no disponible.\n");
         return;
@@ -229,16 +297,16 @@ void simular_llamada_de_piso_via_can(int piso_origen, movement_direction_enum_t
     printf("[SIM_ASCENSOR] Enviando LLAMADA DE PISO a GW (vía CAN): Piso %d, Dir %s\n", 
            piso_origen, (direccion == MOVING_UP) ? "SUBIR" : "BAJAR");
     simulated_can_frame_t frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.building_index = building_index;
     frame.id = 0x100; // ID CAN para llamada de piso
     frame.data[0] = (uint8_t)piso_origen;
     frame.data[1] = (direccion == MOVING_UP) ? 0 : 1; // 0 para UP, 1 para DOWN
     frame.dlc = 2;
 
-    // Registrar frame CAN en el logger
-    char description[128];
-    snprintf(description, sizeof(description), "Llamada de piso desde piso %d, dirección %s", 
-             piso_origen, (direccion == MOVING_UP) ? "SUBIR" : "BAJAR");
-    exec_logger_log_can_sent(frame.id, frame.dlc, frame.data, description);
+    // Registrar frame CAN en el logger (piso y dirección van en data[0] y data[1])
+    exec_logger_log_can_sent(frame.id, frame.dlc, frame.data,
+                             direccion == MOVING_UP ? "Llamada de piso (SUBIR)" : "Llamada de piso (BAJAR)");
 
     ag_can_bridge_process_incoming_frame(&frame, g_coap_context);
 }
@@ -268,6 +336,16 @@ void simular_llamada_de_piso_via_can(int piso_origen, movement_direction_enum_t
  * @see simulated_can_frame_t
  */
 void simular_solicitud_cabina_via_can(int indice_ascensor, int piso_destino) {
+    enviar_solicitud_cabina_via_can(GW_BUILDING_INDEX_DEFAULT, indice_ascensor, piso_destino);
+}
+
+/**
+ * @brief Envía una solicitud de cabina simulada del bus CAN de un edificio
+ * @param building_index Índice del edificio en el registro
+ * @param indice_ascensor Índice del ascensor que realiza la solicitud (0-based)
+ * @param piso_destino Piso destino solicitado
+ */
+static void enviar_solicitud_cabina_via_can(uint16_t building_index, int indice_ascensor, int piso_destino) {
     if (!g_coap_context) {
         printf("[SIM_ASCENSOR] Error: Contexto CoAP de Gateway no disponible.\n");
         return;
@@ -275,16 +353,15 @@ void simular_solicitud_cabina_via_can(int indice_ascensor, int piso_destino) {
     printf("[SIM_ASCENSOR] Enviando SOLICITUD DE CABINA a GW (vía CAN): Ascensor idx %d, Piso Destino %d\n", 
            indice_ascensor, piso_destino);
     simulated_can_frame_t frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.building_index = building_index;
     frame.id = 0x200; // ID CAN para solicitud de cabina
     frame.data[0] = (uint8_t)indice_ascensor; // ej: 0 para el primer ascensor (E1A1)
     frame.data[1] = (uint8_t)piso_destino;
     frame.dlc = 2;
 
-    // Registrar frame CAN en el logger
-    char description[128];
-    snprintf(description, sizeof(description), "Solicitud de cabina desde ascensor índice %d al piso %d", 
-             indice_ascensor, piso_destino);
-    exec_logger_log_can_sent(frame.id, frame.dlc, frame.data, description);
+    // Registrar frame CAN en el logger (ascensor y piso destino van en data[0] y data[1])
+    exec_logger_log_can_sent(frame.id, frame.dlc, frame.data, "Solicitud de cabina");
 
     ag_can_bridge_process_incoming_frame(&frame, g_coap_context);
 }
@@ -309,7 +386,7 @@ void simular_solicitud_cabina_via_can(int indice_ascensor, int piso_destino) {
  * 4. Finalización automática al completar todas las peticiones
  * 
  * @note Esta función debe llamarse desde el main loop para ser no-bloqueante
- * @see simulate_elevator_group_step() - se ejecuta en paralelo
+ * @see gw_kinematics_advance() - se ejecuta en paralelo
  */
 void simular_eventos_ascensor(void) {
     printf("\n[SIM_ASCENSOR] === INICIANDO SIMULACIÓN NO-BLOQUEANTE DE EVENTOS CAN ===\n");
@@ -319,30 +396,63 @@ void simular_eventos_ascensor(void) {
         printf("[SIM_ASCENSOR] Configurando simulación desde JSON con %d edificios disponibles\n", 
                datos_simulacion_global.num_edificios);
 
-        // Seleccionar edificio aleatorio
-        edificio_actual = seleccionar_edificio_aleatorio(&datos_simulacion_global);
-        if (!edificio_actual) {
+        // Solo se cargaron los edificios a simular (uno aleatorio o los N primeros)
+        int num_solicitados = datos_simulacion_global.num_edificios;
+        if (num_solicitados > GW_MAX_BUILDINGS) num_solicitados = GW_MAX_BUILDINGS;
+
+        gw_building_registry_init();
+        num_edificios_en_simulacion = 0;
+        for (int i = 0; i < num_solicitados; ++i) {
+            edificio_simulacion_t *edificio = &datos_simulacion_global.edificios[i];
+
+            // Registrar el edificio; comparte contexto CoAP y sesión DTLS con el resto
+            int building_index = gw_building_add(edificio->id_edificio, 4, 14);
+            if (building_index < 0) {
+                continue;
+            }
+
+            edificio_en_simulacion_t *sim = &edificios_en_simulacion[num_edificios_en_simulacion++];
+            sim->edificio = edificio;
+            sim->building_index = (uint16_t)building_index;
+            sim->peticiones_ejecutadas = 0;
+
+            printf("[SIM_ASCENSOR] Sistema configurado para edificio: %s (índice %d)\n", edificio->id_edificio, building_index);
+            printf("[SIM_ASCENSOR] Ascensores disponibles: %sA1, %sA2, %sA3, %sA4\n", 
+                   edificio->id_edificio, edificio->id_edificio, 
+                   edificio->id_edificio, edificio->id_edificio);
+
+            // Registrar inicio de simulación
+            exec_logger_log_simulation_start(edificio->id_edificio, edificio->num_peticiones);
+        }
+
+        if (num_edificios_en_simulacion == 0) {
             printf("[SIM_ASCENSOR] Error: No se pudo seleccionar edificio. Usando simulación básica.\n");
+            gw_building_add("E1", 4, 14);
             goto simulacion_basica;
         }
 
-        // Configurar el ID del edificio en el sistema
-        init_elevator_group(&managed_elevator_group, edificio_actual->id_edificio, 4, 14);
-
-        printf("[SIM_ASCENSOR] Sistema configurado para edificio: %s\n", managed_elevator_group.edificio_id_str_grupo);
-        printf("[SIM_ASCENSOR] Ascensores disponibles: %sA1, %sA2, %sA3, %sA4\n", 
-               edificio_actual->id_edificio, edificio_actual->id_edificio, 
-               edificio_actual->id_edificio, edificio_actual->id_edificio);
-        printf("[SIM_ASCENSOR] Simulación NO-BLOQUEANTE: %d peticiones con %dms entre cada una\n", 
-               edificio_actual->num_peticiones, INTERVALO_PETICIONES_MS);
-
-        // Registrar inicio de simulación
-        exec_logger_log_simulation_start(edificio_actual->id_edificio, edificio_actual->num_peticiones);
+        printf("[SIM_ASCENSOR] Simulación NO-BLOQUEANTE: %d edificio(s), peticiones en su instante_ms "
+               "(o cada %dms si no lo indica) a velocidad x%.2f\n",
+               num_edificios_en_simulacion, INTERVALO_PETICIONES_MS, gw_config()->sim_playback_speed);
+
+        // Programar las peticiones: la primera de cada edificio un intervalo después del arranque
+        gw_sim_queue_init(&cola_peticiones, 0);
+        for (int i = 0; i < num_edificios_en_simulacion; ++i) {
+            edificio_en_simulacion_t *sim = &edificios_en_simulacion[i];
+            sim->plan.edificio = sim->edificio;
+            sim->plan.building_index = sim->building_index;
+            sim->plan.inicio_ms = (uint64_t)INTERVALO_PETICIONES_MS;
+            sim->plan.intervalo_ms = (uint32_t)INTERVALO_PETICIONES_MS;
+            sim->plan.rondas = 1;
+            sim->plan.accion = ejecutar_peticion_programada;
+            programar_peticiones_edificio(&cola_peticiones, &sim->plan);
+        }
 
         // Activar simulación no-bloqueante
         simulacion_activa = true;
-        peticion_actual_index = 0;
-        tiempo_ultima_peticion = time(NULL);
+        origen_simulacion_ns = reloj_monotonico_ns();
+        base_virtual_ms = 0;
+        velocidad_reproduccion = gw_config()->sim_playback_speed;
 
         printf("[SIM_ASCENSOR] ✅ Simulación no-bloqueante activada. El main loop manejará las peticiones.\n");
 
@@ -374,69 +484,121 @@ void simular_eventos_ascensor(void) {
 }
 
 /**
- * @brief Procesa la siguiente petición de la simulación no-bloqueante
- * 
- * Esta función debe llamarse desde el main loop para ejecutar las peticiones
- * de forma incremental, permitiendo que el simulador de movimiento funcione
- * en paralelo.
- * 
- * @return true si la simulación continúa, false si ha terminado
+ * @brief Ejecuta una petición del escenario programada en la cola de eventos
+ * @param cola Cola de peticiones
+ * @param evento Evento con la petición (arg) y su posición en el edificio (value)
  */
-bool procesar_siguiente_peticion_simulacion(void) {
-    if (!simulacion_activa || !edificio_actual) {
-        return false; // Simulación no activa o no configurada
-    }
-
-    // Verificar si han pasado suficientes milisegundos desde la última petición
-    time_t tiempo_actual = time(NULL);
-    if ((tiempo_actual - tiempo_ultima_peticion) < (INTERVALO_PETICIONES_MS / 1000)) {
-        return true; // Aún no es tiempo para la siguiente petición
+static void ejecutar_peticion_programada(gw_sim_queue_t *cola, const gw_sim_event_t *evento) {
+    (void)cola;
+    peticion_simulacion_t *peticion = evento->arg;
+    edificio_en_simulacion_t *sim = NULL;
+    for (int i = 0; i < num_edificios_en_simulacion; ++i) {
+        if (edificios_en_simulacion[i].building_index == evento->building_index) {
+            sim = &edificios_en_simulacion[i];
+            break;
+        }
     }
-
-    // Verificar si hemos completado todas las peticiones
-    if (peticion_actual_index >= edificio_actual->num_peticiones) {
-        printf("[SIM_ASCENSOR] === FIN SIMULACIÓN NO-BLOQUEANTE DEL EDIFICIO %s ===\n", edificio_actual->id_edificio);
-        printf("[SIM_ASCENSOR] Peticiones ejecutadas exitosamente: %d/%d\n", 
-               peticion_actual_index, edificio_actual->num_peticiones);
-        
-        // Registrar fin de simulación
-        exec_logger_log_simulation_end(peticion_actual_index, edificio_actual->num_peticiones);
-        
-        // Desactivar simulación
-        simulacion_activa = false;
-        edificio_actual = NULL;
-        peticion_actual_index = 0;
-        
-        return false; // Simulación terminada
+    if (!sim || !peticion) {
+        return;
     }
 
-    // Ejecutar la petición actual
-    peticion_simulacion_t *peticion = &edificio_actual->peticiones[peticion_actual_index];
-
-    printf("[SIM_ASCENSOR] --- Petición %d/%d (NO-BLOQUEANTE) ---\n", 
-           peticion_actual_index + 1, edificio_actual->num_peticiones);
+    printf("[SIM_ASCENSOR] --- Edificio %s: Petición %d/%d (NO-BLOQUEANTE) ---\n", 
+           sim->edificio->id_edificio, evento->value + 1, sim->edificio->num_peticiones);
 
     if (peticion->tipo == PETICION_LLAMADA_PISO) {
         printf("[SIM_ASCENSOR] Ejecutando llamada de piso: Piso %d, Dirección %s\n", 
-               peticion->piso_origen, peticion->direccion);
+               peticion->piso_origen, movement_direction_to_string(peticion->direccion));
 
-        movement_direction_enum_t direccion = convertir_direccion_string(peticion->direccion);
-        simular_llamada_de_piso_via_can(peticion->piso_origen, direccion);
+        enviar_llamada_de_piso_via_can(sim->building_index, peticion->piso_origen, peticion->direccion);
 
     } else if (peticion->tipo == PETICION_SOLICITUD_CABINA) {
         printf("[SIM_ASCENSOR] Ejecutando solicitud de cabina: Ascensor %d, Destino piso %d\n", 
                peticion->indice_ascensor, peticion->piso_destino);
 
-        simular_solicitud_cabina_via_can(peticion->indice_ascensor, peticion->piso_destino);
+        enviar_solicitud_cabina_via_can(sim->building_index, peticion->indice_ascensor, peticion->piso_destino);
 
     } else {
         printf("[SIM_ASCENSOR] Advertencia: Tipo de petición desconocido: %d\n", peticion->tipo);
         // Continuar con la siguiente petición
     }
 
-    // Actualizar estado para la siguiente petición
-    peticion_actual_index++;
-    tiempo_ultima_peticion = tiempo_actual;
+    sim->peticiones_ejecutadas++;
+}
+
+/**
+ * @brief Procesa las peticiones vencidas de la simulación no-bloqueante
+ * 
+ * Esta función debe llamarse desde el main loop. Ejecuta, en orden, las
+ * peticiones programadas cuyo instante ya ha pasado según el reloj
+ * monotónico (escalado por GW_SIM_PLAYBACK_SPEED), de modo que un
+ * temporizador que venza tarde no pierde ni reordena peticiones.
+ * 
+ * @return true si la simulación continúa, false si ha terminado
+ */
+bool procesar_siguiente_peticion_simulacion(void) {
+    if (!simulacion_activa || num_edificios_en_simulacion == 0) {
+        return false; // Simulación no activa o no configurada
+    }
+
+    uint64_t ahora_ns = reloj_monotonico_ns();
+    actualizar_velocidad_reproduccion(ahora_ns);
+    uint64_t virtual_ms = base_virtual_ms +
+        (uint64_t)((double)(ahora_ns - origen_simulacion_ns) * velocidad_reproduccion / 1e6);
+    gw_sim_queue_run_until(&cola_peticiones, virtual_ms);
+    if (gw_sim_queue_size(&cola_peticiones) > 0) {
+        return true; // Quedan peticiones programadas
+    }
+
+    // Todas las peticiones de todos los edificios se han ejecutado
+    int peticiones_ejecutadas = 0;
+    int peticiones_totales = 0;
+    for (int i = 0; i < num_edificios_en_simulacion; ++i) {
+        peticiones_ejecutadas += edificios_en_simulacion[i].peticiones_ejecutadas;
+        peticiones_totales += edificios_en_simulacion[i].edificio->num_peticiones;
+    }
+    if (num_edificios_en_simulacion == 1) {
+        printf("[SIM_ASCENSOR] === FIN SIMULACIÓN NO-BLOQUEANTE DEL EDIFICIO %s ===\n", edificios_en_simulacion[0].edificio->id_edificio);
+    } else {
+        printf("[SIM_ASCENSOR] === FIN SIMULACIÓN NO-BLOQUEANTE DE %d EDIFICIOS ===\n", num_edificios_en_simulacion);
+    }
+    printf("[SIM_ASCENSOR] Peticiones ejecutadas exitosamente: %d/%d\n", 
+           peticiones_ejecutadas, peticiones_totales);
+    
+    // Registrar fin de simulación
+    exec_logger_log_simulation_end(peticiones_ejecutadas, peticiones_totales);
+    
+    // Desactivar simulación
+    gw_sim_queue_free(&cola_peticiones);
+    simulacion_activa = false;
+    num_edificios_en_simulacion = 0;
+    
+    return false; // Simulación terminada
+}
 
-    return true; // Simulación continúa
-} 
\ No newline at end of file
+/**
+ * @brief Instante de la próxima petición de la simulación no-bloqueante
+ * @return Instante absoluto en ns de CLOCK_MONOTONIC, o 0 si no quedan peticiones
+ *
+ * El bucle de eventos de main.c arma con él el temporizador de un solo
+ * disparo que invoca procesar_siguiente_peticion_simulacion(), así que cada
+ * petición se inyecta en su instante y no en el siguiente múltiplo de un
+ * periodo fijo.
+ */
+uint64_t obtener_proxima_peticion_simulacion_ns(void) {
+    if (!simulacion_activa || gw_sim_queue_size(&cola_peticiones) == 0) {
+        return 0;
+    }
+    uint64_t ahora_ns = reloj_monotonico_ns();
+    actualizar_velocidad_reproduccion(ahora_ns);
+    uint64_t proxima_ms = gw_sim_queue_next_time(&cola_peticiones);
+    if (proxima_ms <= base_virtual_ms) {
+        return origen_simulacion_ns;
+    }
+    // Redondeo hacia arriba: al vencer, el reloj virtual ya ha llegado a proxima_ms
+    double espera_ns = (double)(proxima_ms - base_virtual_ms) * 1e6 / velocidad_reproduccion;
+    uint64_t espera = (uint64_t)espera_ns;
+    if ((double)espera < espera_ns) {
+        espera++;
+    }
+    return origen_simulacion_ns + espera;
+}
@@ -0,0 +1,322 @@
+/**
+ * @file passenger_kpi.c
+ * @brief Implementación del seguimiento de pasajeros de la simulación
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Los viajes viven en un vector que solo crece; las listas de espera (por
+ * piso y dirección) y de cabina se enlazan por índice dentro de él, así
+ * que una parada solo recorre los pasajeros de ese piso y esa cabina.
+ *
+ * @see passenger_kpi.h
+ */
+
+#include "api_gateway/passenger_kpi.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static int32_t* waiting_head(gw_kpi_tracker_t *tracker, uint16_t building_index, int floor,
+                             movement_direction_enum_t direction) {
+    if (!tracker || building_index >= GW_MAX_BUILDINGS || !tracker->buildings[building_index].waiting ||
+        floor < 0 || floor >= GW_KPI_MAX_FLOORS || (direction != MOVING_UP && direction != MOVING_DOWN)) {
+        return NULL;
+    }
+    return &tracker->buildings[building_index].waiting[floor * 2 + (direction == MOVING_UP ? 1 : 0)];
+}
+
+static int32_t* riding_head(gw_kpi_tracker_t *tracker, uint16_t building_index, int car) {
+    if (!tracker || building_index >= GW_MAX_BUILDINGS || !tracker->buildings[building_index].riding ||
+        car < 0 || car >= tracker->buildings[building_index].num_cars) {
+        return NULL;
+    }
+    return &tracker->buildings[building_index].riding[car];
+}
+
+static uint64_t ms_to_us(uint64_t from_ms, uint64_t to_ms) {
+    return to_ms > from_ms ? (to_ms - from_ms) * 1000u : 0;
+}
+
+bool gw_kpi_init(gw_kpi_tracker_t *tracker) {
+    if (!tracker) {
+        return false;
+    }
+    memset(tracker, 0, sizeof(*tracker));
+    if (!gw_latency_hist_init(&tracker->assignment) || !gw_latency_hist_init(&tracker->wait) ||
+        !gw_latency_hist_init(&tracker->ride) || !gw_latency_hist_init(&tracker->journey)) {
+        gw_kpi_free(tracker);
+        return false;
+    }
+    return true;
+}
+
+void gw_kpi_free(gw_kpi_tracker_t *tracker) {
+    if (!tracker) {
+        return;
+    }
+    for (int b = 0; b < GW_MAX_BUILDINGS; ++b) {
+        free(tracker->buildings[b].waiting);
+        free(tracker->buildings[b].riding);
+    }
+    free(tracker->passengers);
+    gw_latency_hist_free(&tracker->assignment);
+    gw_latency_hist_free(&tracker->wait);
+    gw_latency_hist_free(&tracker->ride);
+    gw_latency_hist_free(&tracker->journey);
+    memset(tracker, 0, sizeof(*tracker));
+}
+
+bool gw_kpi_add_building(gw_kpi_tracker_t *tracker, uint16_t building_index, int num_cars) {
+    if (!tracker || building_index >= GW_MAX_BUILDINGS || num_cars < 1) {
+        return false;
+    }
+    gw_kpi_building_t *b = &tracker->buildings[building_index];
+    free(b->waiting);
+    free(b->riding);
+    b->waiting = malloc(GW_KPI_MAX_FLOORS * 2 * sizeof(int32_t));
+    b->riding = malloc((size_t)num_cars * sizeof(int32_t));
+    if (!b->waiting || !b->riding) {
+        free(b->waiting);
+        free(b->riding);
+        memset(b, 0, sizeof(*b));
+        return false;
+    }
+    memset(b->waiting, 0xFF, GW_KPI_MAX_FLOORS * 2 * sizeof(int32_t)); // -1: lista vacía
+    memset(b->riding, 0xFF, (size_t)num_cars * sizeof(int32_t));
+    b->num_cars = num_cars;
+    return true;
+}
+
+int32_t gw_kpi_press(gw_kpi_tracker_t *tracker, uint16_t building_index, int floor,
+                     movement_direction_enum_t direction, int destination, uint16_t count, uint64_t now_ms) {
+    int32_t *head = waiting_head(tracker, building_index, floor, direction);
+    if (!head || tracker->num_passengers >= INT32_MAX) {
+        return -1;
+    }
+    if (tracker->num_passengers == tracker->capacity) {
+        size_t capacity = tracker->capacity ? tracker->capacity * 2 : 1024;
+        gw_passenger_t *grown = realloc(tracker->passengers, capacity * sizeof(gw_passenger_t));
+        if (!grown) {
+            return -1;
+        }
+        tracker->passengers = grown;
+        tracker->capacity = capacity;
+    }
+    int32_t id = (int32_t)tracker->num_passengers++;
+    gw_passenger_t *p = &tracker->passengers[id];
+    memset(p, 0, sizeof(*p));
+    p->press_ms = now_ms;
+    p->assigned_ms = GW_KPI_NO_TIME;
+    p->pickup_ms = GW_KPI_NO_TIME;
+    p->arrival_ms = GW_KPI_NO_TIME;
+    p->building_index = building_index;
+    p->count = count ? count : 1;
+    p->origin = (int16_t)floor;
+    p->destination = (int16_t)(destination >= 0 && destination < GW_KPI_MAX_FLOORS && destination != floor
+                                   ? destination : -1);
+    p->car = -1;
+    p->direction = (uint8_t)direction;
+    p->state = GW_PASSENGER_WAITING;
+    p->next = *head; // Embarcan todos a la vez: el orden de la lista no importa
+    *head = id;
+    tracker->people += p->count;
+    return id;
+}
+
+void gw_kpi_assigned(gw_kpi_tracker_t *tracker, uint16_t building_index, int floor,
+                     movement_direction_enum_t direction, int car, uint64_t now_ms) {
+    int32_t *head = waiting_head(tracker, building_index, floor, direction);
+    if (!head) {
+        return;
+    }
+    for (int32_t id = *head; id >= 0; id = tracker->passengers[id].next) {
+        gw_passenger_t *p = &tracker->passengers[id];
+        p->car = (int16_t)car;
+        if (p->assigned_ms == GW_KPI_NO_TIME) {
+            p->assigned_ms = now_ms;
+            gw_latency_hist_record_count(&tracker->assignment, ms_to_us(p->press_ms, now_ms), p->count);
+        }
+    }
+}
+
+bool gw_kpi_has_waiting(const gw_kpi_tracker_t *tracker, uint16_t building_index, int floor,
+                        movement_direction_enum_t direction, int *car_out) {
+    int32_t *head = waiting_head((gw_kpi_tracker_t *)tracker, building_index, floor, direction);
+    if (car_out) {
+        *car_out = head && *head >= 0 ? tracker->passengers[*head].car : -1;
+    }
+    return head && *head >= 0;
+}
+
+int gw_kpi_car_stop(gw_kpi_tracker_t *tracker, uint16_t building_index, int car, int floor, uint64_t now_ms) {
+    int32_t *riding = riding_head(tracker, building_index, car);
+    if (!riding) {
+        return 0;
+    }
+    // Desembarque
+    for (int32_t *link = riding; *link >= 0;) {
+        gw_passenger_t *p = &tracker->passengers[*link];
+        if (p->destination != floor) {
+            link = &p->next;
+            continue;
+        }
+        *link = p->next;
+        p->next = -1;
+        p->state = GW_PASSENGER_DELIVERED;
+        p->arrival_ms = now_ms;
+        gw_latency_hist_record_count(&tracker->ride, ms_to_us(p->pickup_ms, now_ms), p->count);
+        gw_latency_hist_record_count(&tracker->journey, ms_to_us(p->press_ms, now_ms), p->count);
+        tracker->people_delivered += p->count;
+    }
+
+    // Sentido de los que siguen a bordo: solo embarcan quienes van hacia el
+    // mismo lado. Con la cabina vacía embarcan los de ambos sentidos.
+    movement_direction_enum_t riders = gw_kpi_riders_direction(tracker, building_index, car, floor);
+    bool board_up = riders != MOVING_DOWN;
+    bool board_down = riders != MOVING_UP;
+
+    int boarded = 0;
+    for (int d = 0; d < 2; ++d) {
+        if (!(d ? board_up : board_down)) {
+            continue;
+        }
+        int32_t *waiting = waiting_head(tracker, building_index, floor, d ? MOVING_UP : MOVING_DOWN);
+        if (!waiting) {
+            return boarded;
+        }
+        while (*waiting >= 0) {
+            int32_t id = *waiting;
+            gw_passenger_t *p = &tracker->passengers[id];
+            *waiting = p->next;
+            p->pickup_ms = now_ms;
+            p->car = (int16_t)car;
+            gw_latency_hist_record_count(&tracker->wait, ms_to_us(p->press_ms, now_ms), p->count);
+            boarded += p->count;
+            if (p->destination < 0) {
+                p->next = -1;
+                p->state = GW_PASSENGER_BOARDED_NO_DEST;
+                tracker->people_no_destination += p->count;
+                continue;
+            }
+            p->state = GW_PASSENGER_RIDING;
+            p->next = *riding;
+            *riding = id;
+        }
+    }
+    return boarded;
+}
+
+movement_direction_enum_t gw_kpi_riders_direction(const gw_kpi_tracker_t *tracker, uint16_t building_index,
+                                                   int car, int floor) {
+    int32_t *riding = riding_head((gw_kpi_tracker_t *)tracker, building_index, car);
+    for (int32_t id = riding ? *riding : -1; id >= 0; id = tracker->passengers[id].next) {
+        int destination = tracker->passengers[id].destination;
+        if (destination != floor) {
+            return destination > floor ? MOVING_UP : MOVING_DOWN;
+        }
+    }
+    return STOPPED;
+}
+
+int gw_kpi_next_destination(const gw_kpi_tracker_t *tracker, uint16_t building_index, int car, int floor) {
+    int32_t *riding = riding_head((gw_kpi_tracker_t *)tracker, building_index, car);
+    int best = -1;
+    for (int32_t id = riding ? *riding : -1; id >= 0; id = tracker->passengers[id].next) {
+        int destination = tracker->passengers[id].destination;
+        if (best < 0 || abs(destination - floor) < abs(best - floor)) {
+            best = destination;
+        }
+    }
+    return best;
+}
+
+uint64_t gw_kpi_people_in_progress(const gw_kpi_tracker_t *tracker) {
+    return tracker ? tracker->people - tracker->people_delivered - tracker->people_no_destination : 0;
+}
+
+static void print_kpi_line(FILE *out, const char *label, const gw_latency_hist_t *hist) {
+    int width = 0; // Caracteres visibles: las tildes ocupan dos bytes en UTF-8
+    for (const char *c = label; *c; ++c) {
+        width += ((unsigned char)*c & 0xC0) != 0x80;
+    }
+    fprintf(out, "%s%*s n=%-8llu media=%7.2f p50=%7.2f p90=%7.2f p95=%7.2f p99=%7.2f max=%7.2f s\n", label,
+            width < 23 ? 23 - width : 0, "", (unsigned long long)hist->total, gw_latency_hist_mean(hist) / 1e6,
+            gw_latency_hist_percentile(hist, 50.0) / 1e6, gw_latency_hist_percentile(hist, 90.0) / 1e6,
+            gw_latency_hist_percentile(hist, 95.0) / 1e6, gw_latency_hist_percentile(hist, 99.0) / 1e6,
+            hist->total ? hist->max_us / 1e6 : 0.0);
+}
+
+void gw_kpi_print(const gw_kpi_tracker_t *tracker, FILE *out) {
+    if (!tracker || !out) {
+        return;
+    }
+    fprintf(out, "Pasajeros: %llu, llegados a destino: %llu, embarcados sin destino conocido: %llu, sin completar: %llu\n",
+            (unsigned long long)tracker->people, (unsigned long long)tracker->people_delivered,
+            (unsigned long long)tracker->people_no_destination,
+            (unsigned long long)gw_kpi_people_in_progress(tracker));
+    print_kpi_line(out, "Tiempo hasta asignación", &tracker->assignment);
+    print_kpi_line(out, "Tiempo de espera", &tracker->wait);
+    print_kpi_line(out, "Tiempo en cabina", &tracker->ride);
+    print_kpi_line(out, "Tiempo de viaje", &tracker->journey);
+}
+
+static void write_csv_time(FILE *out, uint64_t value_ms) {
+    if (value_ms != GW_KPI_NO_TIME) {
+        fprintf(out, "%llu", (unsigned long long)value_ms);
+    }
+    fputc(',', out);
+}
+
+bool gw_kpi_write_csv(const gw_kpi_tracker_t *tracker, FILE *out) {
+    static const char *const state_names[] = {"esperando", "en_cabina", "entregado", "sin_destino"};
+    if (!tracker || !out) {
+        return false;
+    }
+    fprintf(out, "edificio,pasajeros,origen,destino,direccion,ascensor,pulsacion_ms,asignacion_ms,embarque_ms,llegada_ms,estado\n");
+    for (size_t i = 0; i < tracker->num_passengers; ++i) {
+        const gw_passenger_t *p = &tracker->passengers[i];
+        elevator_group_state_t *group = gw_building_get(p->building_index);
+        fprintf(out, "%s,%u,%d,", group ? group->edificio_id_str_grupo : "", p->count, p->origin);
+        if (p->destination >= 0) {
+            fprintf(out, "%d", p->destination);
+        }
+        fprintf(out, ",%s,", movement_direction_to_string((movement_direction_enum_t)p->direction));
+        if (group && p->car >= 0 && p->car < group->num_elevadores_en_grupo) {
+            fprintf(out, "%s", group->ids[p->car].ascensor_id);
+        }
+        fprintf(out, ",%llu,", (unsigned long long)p->press_ms);
+        write_csv_time(out, p->assigned_ms);
+        write_csv_time(out, p->pickup_ms);
+        write_csv_time(out, p->arrival_ms);
+        fprintf(out, "%s\n", state_names[p->state]);
+    }
+    return !ferror(out);
+}
+
+static void write_json_kpi(FILE *out, const char *name, const gw_latency_hist_t *hist, bool last) {
+    fprintf(out, "    \"%s\": {\"muestras\": %llu, \"media_s\": %.3f, \"p50_s\": %.3f, \"p90_s\": %.3f, "
+                 "\"p95_s\": %.3f, \"p99_s\": %.3f, \"max_s\": %.3f}%s\n",
+            name, (unsigned long long)hist->total, gw_latency_hist_mean(hist) / 1e6,
+            gw_latency_hist_percentile(hist, 50.0) / 1e6, gw_latency_hist_percentile(hist, 90.0) / 1e6,
+            gw_latency_hist_percentile(hist, 95.0) / 1e6, gw_latency_hist_percentile(hist, 99.0) / 1e6,
+            hist->total ? hist->max_us / 1e6 : 0.0, last ? "" : ",");
+}
+
+bool gw_kpi_write_json(const gw_kpi_tracker_t *tracker, FILE *out) {
+    if (!tracker || !out) {
+        return false;
+    }
+    fprintf(out, "{\n");
+    fprintf(out, "  \"pasajeros\": %llu,\n", (unsigned long long)tracker->people);
+    fprintf(out, "  \"llegados\": %llu,\n", (unsigned long long)tracker->people_delivered);
+    fprintf(out, "  \"sin_destino\": %llu,\n", (unsigned long long)tracker->people_no_destination);
+    fprintf(out, "  \"sin_completar\": %llu,\n", (unsigned long long)gw_kpi_people_in_progress(tracker));
+    fprintf(out, "  \"indicadores\": {\n");
+    write_json_kpi(out, "asignacion", &tracker->assignment, false);
+    write_json_kpi(out, "espera", &tracker->wait, false);
+    write_json_kpi(out, "cabina", &tracker->ride, false);
+    write_json_kpi(out, "viaje", &tracker->journey, true);
+    fprintf(out, "  }\n}\n");
+    return !ferror(out);
+}
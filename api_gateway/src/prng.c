@@ -0,0 +1,133 @@
+/**
+ * @file prng.c
+ * @brief Implementación del generador xoshiro256** y sus distribuciones
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * @see prng.h
+ */
+
+#include "api_gateway/prng.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * @brief Generador global (gw_prng_global())
+ */
+static gw_prng_t global_rng;
+
+/**
+ * @brief Indica si global_rng ya se sembró
+ */
+static bool global_rng_seeded = false;
+
+/**
+ * @brief Paso de splitmix64: avanza @p state y devuelve un número mezclado
+ */
+static uint64_t splitmix64(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static uint64_t rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+void gw_prng_seed(gw_prng_t *rng, uint64_t seed) {
+    uint64_t state = seed;
+    for (int i = 0; i < 4; ++i) {
+        rng->s[i] = splitmix64(&state);
+    }
+}
+
+void gw_prng_seed_stream(gw_prng_t *rng, uint64_t seed, uint64_t stream) {
+    // Mezclar el flujo antes de combinarlo: flujos consecutivos no comparten estado
+    uint64_t state = stream;
+    gw_prng_seed(rng, seed ^ splitmix64(&state));
+}
+
+uint64_t gw_prng_next(gw_prng_t *rng) {
+    uint64_t *s = rng->s;
+    uint64_t result = rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return result;
+}
+
+double gw_prng_uniform(gw_prng_t *rng) {
+    return (double)(gw_prng_next(rng) >> 11) * 0x1.0p-53;
+}
+
+uint32_t gw_prng_below(gw_prng_t *rng, uint32_t n) {
+    if (n == 0) {
+        return 0;
+    }
+    // Multiplicación de Lemire: se rechaza solo la franja que introduciría sesgo
+    uint64_t m = (gw_prng_next(rng) >> 32) * (uint64_t)n;
+    uint32_t low = (uint32_t)m;
+    if (low < n) {
+        uint32_t threshold = (uint32_t)-n % n;
+        while (low < threshold) {
+            m = (gw_prng_next(rng) >> 32) * (uint64_t)n;
+            low = (uint32_t)m;
+        }
+    }
+    return (uint32_t)(m >> 32);
+}
+
+double gw_prng_exponential(gw_prng_t *rng, double rate) {
+    // 1 - U está en (0, 1]: el logaritmo nunca es infinito
+    return -log(1.0 - gw_prng_uniform(rng)) / rate;
+}
+
+uint32_t gw_prng_poisson(gw_prng_t *rng, double mean) {
+    if (!(mean > 0.0)) {
+        return 0;
+    }
+    if (mean < 30.0) {
+        // Knuth: producto de uniformes hasta bajar de e^-mean
+        double limit = exp(-mean);
+        double product = gw_prng_uniform(rng);
+        uint32_t k = 0;
+        while (product > limit) {
+            product *= gw_prng_uniform(rng);
+            k++;
+        }
+        return k;
+    }
+    // Medias grandes: aproximación normal (Box-Muller)
+    double u1 = 1.0 - gw_prng_uniform(rng);
+    double u2 = gw_prng_uniform(rng);
+    double normal = sqrt(-2.0 * log(u1)) * cos(6.283185307179586 * u2);
+    double value = floor(mean + sqrt(mean) * normal + 0.5);
+    return value > 0.0 ? (uint32_t)value : 0;
+}
+
+gw_prng_t* gw_prng_global(void) {
+    if (!global_rng_seeded) {
+        gw_prng_global_seed(0);
+    }
+    return &global_rng;
+}
+
+uint64_t gw_prng_global_seed(uint64_t seed) {
+    if (seed == 0) {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        seed = ((uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec) ^ ((uint64_t)getpid() << 32);
+    }
+    gw_prng_seed(&global_rng, seed);
+    global_rng_seeded = true;
+    return seed;
+}
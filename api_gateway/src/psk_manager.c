@@ -7,10 +7,10 @@
  */
 
 #include "psk_manager.h"
+#include "api_gateway/prng.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <time.h>
 
 /**
  * @brief Estructura para almacenar las claves PSK
@@ -74,9 +74,6 @@ int psk_manager_init(const char* keys_file_path) {
     g_psk_keys.count = index;
     fclose(file);
     
-    // Inicializar generador de números aleatorios
-    srand(time(NULL));
-    
     printf("PSK Manager: Cargadas %d claves desde %s\n", g_psk_keys.count, keys_file_path);
     return 0;
 }
@@ -91,7 +88,7 @@ int psk_manager_get_random_key(char* key_buffer, size_t buffer_size) {
     int max_attempts = 5;
     for (int attempt = 0; attempt < max_attempts; attempt++) {
         // Seleccionar clave aleatoria
-        int random_index = rand() % g_psk_keys.count;
+        int random_index = (int)gw_prng_below(gw_prng_global(), (uint32_t)g_psk_keys.count);
         const char* selected_key = g_psk_keys.keys[random_index];
         
         // Verificar que la clave no esté vacía
@@ -0,0 +1,258 @@
+/**
+ * @file request_tracker.c
+ * @brief Implementación del slab unificado de trackers de solicitudes
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Implementa un slab de tamaño fijo con lista libre en forma de pila.
+ * Los slots nunca usados se entregan mediante una marca de agua
+ * (@c slab_high_water), de modo que el array estático es válido sin
+ * inicialización explícita. Los slots ocupados forman una lista doble
+ * ordenada por deadline_ms: la cabeza es el próximo en expirar, lo que
+ * permite expirar solicitudes en O(1) por slot.
+ *
+ * @see request_tracker.h
+ */
+
+#include "api_gateway/request_tracker.h"
+#include "api_gateway/logging_gw.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * @brief Marca de fin de lista para prev_live/next_live
+ */
+#define GW_TRACKER_NIL UINT32_MAX
+
+/**
+ * @brief Slots del slab de trackers
+ */
+static gw_tracker_slot_t tracker_slab[GW_TRACKER_SLAB_CAPACITY];
+
+/**
+ * @brief Pila de índices de slots liberados
+ */
+static uint32_t free_slot_stack[GW_TRACKER_SLAB_CAPACITY];
+
+/**
+ * @brief Número de índices en free_slot_stack
+ */
+static uint32_t free_slot_top = 0;
+
+/**
+ * @brief Primer índice del slab que nunca se ha reservado
+ */
+static uint32_t slab_high_water = 0;
+
+/**
+ * @brief Número de slots ocupados
+ */
+static size_t slots_in_flight = 0;
+
+/**
+ * @brief Slot ocupado con el deadline más próximo
+ */
+static uint32_t live_head = GW_TRACKER_NIL;
+
+/**
+ * @brief Slot ocupado con el deadline más lejano
+ */
+static uint32_t live_tail = GW_TRACKER_NIL;
+
+/**
+ * @brief Reservas y liberaciones realizadas desde el arranque
+ */
+static uint64_t slab_change_count = 0;
+
+/**
+ * @brief Tiempo máximo en vuelo aplicado a las nuevas reservas
+ */
+static uint64_t tracker_timeout_ms = GW_TRACKER_DEFAULT_TIMEOUT_MS;
+
+uint64_t gw_tracker_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
+
+uint64_t gw_tracker_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Desengancha un slot de la lista de slots ocupados
+ * @param idx Índice del slot
+ */
+static void unlink_live_slot(uint32_t idx) {
+    gw_tracker_slot_t *slot = &tracker_slab[idx];
+    if (slot->prev_live != GW_TRACKER_NIL) tracker_slab[slot->prev_live].next_live = slot->next_live;
+    else live_head = slot->next_live;
+    if (slot->next_live != GW_TRACKER_NIL) tracker_slab[slot->next_live].prev_live = slot->prev_live;
+    else live_tail = slot->prev_live;
+    slot->prev_live = slot->next_live = GW_TRACKER_NIL;
+}
+
+/**
+ * @brief Engancha un slot en la lista de ocupados según su deadline_ms
+ * @param idx Índice del slot (deadline_ms ya asignado)
+ *
+ * Se recorre desde la cola: con un timeout constante el slot nuevo siempre
+ * va al final. Solo tras acortar el timeout (recarga por SIGHUP) adelanta a
+ * los slots reservados con el timeout anterior.
+ */
+static void link_live_slot(uint32_t idx) {
+    gw_tracker_slot_t *slot = &tracker_slab[idx];
+    uint32_t prev = live_tail;
+    while (prev != GW_TRACKER_NIL && tracker_slab[prev].deadline_ms > slot->deadline_ms) {
+        prev = tracker_slab[prev].prev_live;
+    }
+    uint32_t next = (prev != GW_TRACKER_NIL) ? tracker_slab[prev].next_live : live_head;
+    slot->prev_live = prev;
+    slot->next_live = next;
+    if (prev != GW_TRACKER_NIL) tracker_slab[prev].next_live = idx;
+    else live_head = idx;
+    if (next != GW_TRACKER_NIL) tracker_slab[next].prev_live = idx;
+    else live_tail = idx;
+}
+
+/**
+ * @brief Libera los recursos propios del contenido de un slot
+ * @param slot Slot cuyo contenido se va a descartar
+ */
+static void release_slot_resources(gw_tracker_slot_t *slot) {
+    if (slot->origin == GW_TRACKER_ORIGIN_API) {
+        api_request_tracker_t *api = &slot->data.api;
+        if (api->original_token.s) coap_free((void*)api->original_token.s);
+        if (api->log_tag) free(api->log_tag);
+        if (api->original_elevator_session) coap_session_release(api->original_elevator_session);
+    }
+}
+
+void gw_tracker_init(void) {
+    for (uint32_t i = 0; i < slab_high_water; ++i) {
+        release_slot_resources(&tracker_slab[i]);
+        tracker_slab[i].origin = GW_TRACKER_ORIGIN_NONE;
+        memset(&tracker_slab[i].data, 0, sizeof(tracker_slab[i].data));
+        // La generación se conserva para que tokens antiguos sigan sin coincidir
+    }
+    free_slot_top = 0;
+    slab_high_water = 0;
+    slots_in_flight = 0;
+    live_head = live_tail = GW_TRACKER_NIL;
+    slab_change_count++;
+}
+
+void gw_tracker_cleanup(void) {
+    if (slots_in_flight > 0) {
+        LOG_DEBUG_GW("[TrackerMgmt] Descartando %zu trackers en vuelo.", slots_in_flight);
+    }
+    gw_tracker_init();
+}
+
+gw_tracker_slot_t* gw_tracker_alloc(gw_tracker_origin_t origin, uint8_t token_out[GW_TRACKER_TOKEN_LEN]) {
+    uint32_t idx;
+    if (free_slot_top > 0) {
+        idx = free_slot_stack[--free_slot_top];
+    } else if (slab_high_water < GW_TRACKER_SLAB_CAPACITY) {
+        idx = slab_high_water++;
+    } else {
+        LOG_ERROR_GW("[TrackerMgmt] Slab de trackers lleno (%d solicitudes en vuelo).", GW_TRACKER_SLAB_CAPACITY);
+        return NULL;
+    }
+
+    gw_tracker_slot_t *slot = &tracker_slab[idx];
+    slot->generation++;
+    if (slot->generation == 0) slot->generation = 1; // 0 nunca es una generación viva
+    slot->origin = origin;
+    memset(&slot->data, 0, sizeof(slot->data));
+    memset(&slot->span, 0, sizeof(slot->span));
+    slot->deadline_ms = gw_tracker_now_ms() + tracker_timeout_ms;
+    link_live_slot(idx);
+    slots_in_flight++;
+    slab_change_count++;
+
+    token_out[0] = (uint8_t)(idx >> 24);
+    token_out[1] = (uint8_t)(idx >> 16);
+    token_out[2] = (uint8_t)(idx >> 8);
+    token_out[3] = (uint8_t)idx;
+    token_out[4] = (uint8_t)(slot->generation >> 24);
+    token_out[5] = (uint8_t)(slot->generation >> 16);
+    token_out[6] = (uint8_t)(slot->generation >> 8);
+    token_out[7] = (uint8_t)slot->generation;
+
+    LOG_DEBUG_GW("[TrackerMgmt] Slot %u (gen %u) reservado. En vuelo: %zu", idx, slot->generation, slots_in_flight);
+    return slot;
+}
+
+gw_tracker_slot_t* gw_tracker_lookup(coap_bin_const_t token) {
+    if (!token.s || token.length != GW_TRACKER_TOKEN_LEN) return NULL;
+
+    uint32_t idx = ((uint32_t)token.s[0] << 24) | ((uint32_t)token.s[1] << 16) |
+                   ((uint32_t)token.s[2] << 8) | (uint32_t)token.s[3];
+    uint32_t gen = ((uint32_t)token.s[4] << 24) | ((uint32_t)token.s[5] << 16) |
+                   ((uint32_t)token.s[6] << 8) | (uint32_t)token.s[7];
+
+    if (idx >= slab_high_water) return NULL;
+    gw_tracker_slot_t *slot = &tracker_slab[idx];
+    if (slot->origin == GW_TRACKER_ORIGIN_NONE || slot->generation != gen) return NULL;
+    return slot;
+}
+
+void gw_tracker_release(gw_tracker_slot_t *slot) {
+    if (!slot || slot->origin == GW_TRACKER_ORIGIN_NONE) return;
+    uint32_t idx = (uint32_t)(slot - tracker_slab);
+    if (idx >= slab_high_water) return;
+
+    release_slot_resources(slot);
+    unlink_live_slot(idx);
+    slot->origin = GW_TRACKER_ORIGIN_NONE;
+    free_slot_stack[free_slot_top++] = idx;
+    slots_in_flight--;
+    slab_change_count++;
+    LOG_DEBUG_GW("[TrackerMgmt] Slot %u liberado. En vuelo: %zu", idx, slots_in_flight);
+}
+
+size_t gw_tracker_in_flight(void) {
+    return slots_in_flight;
+}
+
+uint64_t gw_tracker_change_count(void) {
+    return slab_change_count;
+}
+
+size_t gw_tracker_for_each(gw_tracker_visit_cb_t visit, void *arg) {
+    size_t visited = 0;
+    for (uint32_t idx = live_head; idx != GW_TRACKER_NIL; idx = tracker_slab[idx].next_live) {
+        if (visit) visit(&tracker_slab[idx], arg);
+        visited++;
+    }
+    return visited;
+}
+
+void gw_tracker_set_timeout_ms(uint64_t timeout_ms) {
+    tracker_timeout_ms = timeout_ms;
+}
+
+uint64_t gw_tracker_next_deadline_ms(void) {
+    if (live_head == GW_TRACKER_NIL) return 0;
+    return tracker_slab[live_head].deadline_ms;
+}
+
+size_t gw_tracker_expire(uint64_t now_ms, gw_tracker_expired_cb_t on_expired) {
+    size_t expired = 0;
+    while (live_head != GW_TRACKER_NIL && tracker_slab[live_head].deadline_ms <= now_ms) {
+        gw_tracker_slot_t *slot = &tracker_slab[live_head];
+        if (on_expired) on_expired(slot);
+        gw_tracker_release(slot);
+        expired++;
+    }
+    if (expired > 0) {
+        LOG_WARN_GW("[TrackerMgmt] %zu solicitudes expiradas sin respuesta. En vuelo: %zu", expired, slots_in_flight);
+    }
+    return expired;
+}
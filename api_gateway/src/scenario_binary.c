@@ -0,0 +1,352 @@
+/**
+ * @file scenario_binary.c
+ * @brief Implementación del formato binario precompilado de escenarios
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * El escritor vuelca los registros según llegan (del JSON o de un
+ * generador) y deja el índice de edificios (pequeño) para el final, así que
+ * ni el escenario de entrada ni los registros se acumulan en memoria. La
+ * proyección se valida solo en la cabecera y el índice: los registros se
+ * comprueban al convertirlos, de modo que el arranque no toca las páginas
+ * de los edificios no elegidos.
+ *
+ * @see scenario_binary.h
+ */
+
+#include "api_gateway/scenario_binary.h"
+#include "api_gateway/scenario_stream.h"
+#include "api_gateway/elevator_state_manager.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * @brief Alineación del inicio de los registros (línea de caché)
+ */
+#define SCENARIO_BIN_ALIGN 64
+
+/**
+ * @brief Capacidad inicial del índice durante la compilación
+ */
+#define SCENARIO_BIN_INITIAL_BUILDINGS 64
+
+static uint64_t align_up(uint64_t value) {
+    return (value + SCENARIO_BIN_ALIGN - 1) & ~(uint64_t)(SCENARIO_BIN_ALIGN - 1);
+}
+
+bool gw_scenario_bin_is_binary(const char *path) {
+    uint32_t magic = 0;
+    FILE *f = path ? fopen(path, "rb") : NULL;
+    if (!f) {
+        return false;
+    }
+    bool binary = fread(&magic, sizeof(magic), 1, f) == 1 && magic == GW_SCENARIO_BIN_MAGIC;
+    fclose(f);
+    return binary;
+}
+
+/**
+ * @brief Traduce una petición leída del JSON a registro
+ * @return false si algún campo no cabe en el registro
+ */
+static bool request_to_record(const peticion_simulacion_t *peticion, uint32_t offset_ms,
+                              gw_scenario_record_t *record) {
+    memset(record, 0, sizeof(*record));
+    record->offset_ms = offset_ms;
+    record->flags = peticion->tiene_instante ? GW_SCENARIO_REC_INSTANTE : 0;
+    record->pasajeros = peticion->pasajeros;
+    record->tipo = (uint8_t)peticion->tipo;
+    if (peticion->tipo == PETICION_LLAMADA_PISO) {
+        record->direccion = (uint8_t)peticion->direccion;
+        record->piso_origen = (int16_t)peticion->piso_origen;
+        return peticion->piso_origen >= INT16_MIN && peticion->piso_origen <= INT16_MAX;
+    }
+    record->indice_ascensor = (uint8_t)peticion->indice_ascensor;
+    record->piso_destino = (int16_t)peticion->piso_destino;
+    return peticion->indice_ascensor >= 0 && peticion->indice_ascensor <= UINT8_MAX &&
+           peticion->piso_destino >= INT16_MIN && peticion->piso_destino <= INT16_MAX;
+}
+
+/**
+ * @brief Estado de un escritor de escenarios binarios
+ */
+struct gw_scenario_bin_writer_t {
+    FILE *out;                           ///< Fichero temporal
+    char bin_path[4096];                 ///< Destino final
+    char tmp_path[4096];                 ///< "<bin_path>.tmp"
+    uint32_t interval_ms;                ///< Separación de las peticiones sin instante
+    gw_scenario_bin_header_t header;     ///< Cabecera (se completa al cerrar)
+    gw_scenario_building_t *buildings;   ///< Índice acumulado
+    size_t capacity;                     ///< Capacidad de @ref buildings
+    bool ok;                             ///< Sin errores hasta ahora
+};
+
+gw_scenario_bin_writer_t* gw_scenario_bin_writer_open(const char *bin_path, uint32_t interval_ms) {
+    if (!bin_path) {
+        printf("[SIMULATION] Error: Parámetros nulos\n");
+        return NULL;
+    }
+    gw_scenario_bin_writer_t *w = calloc(1, sizeof(*w));
+    if (!w) {
+        printf("[SIMULATION] Error: No se pudo asignar memoria para el escritor\n");
+        return NULL;
+    }
+    if (snprintf(w->bin_path, sizeof(w->bin_path), "%s", bin_path) >= (int)sizeof(w->bin_path) ||
+        snprintf(w->tmp_path, sizeof(w->tmp_path), "%s.tmp", bin_path) >= (int)sizeof(w->tmp_path)) {
+        printf("[SIMULATION] Error: Ruta de salida demasiado larga: %s\n", bin_path);
+        free(w);
+        return NULL;
+    }
+    w->out = fopen(w->tmp_path, "wb");
+    if (!w->out) {
+        printf("[SIMULATION] Error: No se pudo crear %s: %s\n", w->tmp_path, strerror(errno));
+        free(w);
+        return NULL;
+    }
+    w->interval_ms = interval_ms;
+    w->header.version = GW_SCENARIO_BIN_VERSION;
+    w->header.record_size = sizeof(gw_scenario_record_t);
+    w->header.building_size = sizeof(gw_scenario_building_t);
+    w->header.records_offset = align_up(sizeof(w->header));
+
+    // Cabecera provisional (magic a 0) y relleno hasta los registros
+    static const uint8_t zeros[SCENARIO_BIN_ALIGN];
+    size_t padding = w->header.records_offset - sizeof(w->header);
+    w->ok = fwrite(&w->header, sizeof(w->header), 1, w->out) == 1 &&
+            fwrite(zeros, 1, padding, w->out) == padding;
+    return w;
+}
+
+bool gw_scenario_bin_writer_building(gw_scenario_bin_writer_t *w, const char *id_edificio) {
+    if (!w || !w->ok || !id_edificio || strlen(id_edificio) >= sizeof(w->buildings->id_edificio)) {
+        if (w) w->ok = false;
+        return false;
+    }
+    if (w->header.num_buildings == w->capacity) {
+        size_t nueva = w->capacity ? w->capacity * 2 : SCENARIO_BIN_INITIAL_BUILDINGS;
+        gw_scenario_building_t *tmp = realloc(w->buildings, nueva * sizeof(*w->buildings));
+        if (!tmp) {
+            printf("[SIMULATION] Error: No se pudo asignar memoria para edificios\n");
+            w->ok = false;
+            return false;
+        }
+        w->buildings = tmp;
+        w->capacity = nueva;
+    }
+    gw_scenario_building_t *building = &w->buildings[w->header.num_buildings++];
+    memset(building, 0, sizeof(*building));
+    strcpy(building->id_edificio, id_edificio);
+    building->first_record = w->header.num_records;
+    return true;
+}
+
+bool gw_scenario_bin_writer_request(gw_scenario_bin_writer_t *w, const peticion_simulacion_t *peticion) {
+    if (!w || !w->ok || !peticion || w->header.num_buildings == 0) {
+        if (w) w->ok = false;
+        return false;
+    }
+    gw_scenario_building_t *building = &w->buildings[w->header.num_buildings - 1];
+    uint64_t offset_ms = peticion->instante_ms;
+    if (!peticion->tiene_instante) {
+        offset_ms = building->num_records ? (uint64_t)building->duration_ms + w->interval_ms : 0;
+    } else if (building->num_records && offset_ms < building->duration_ms) {
+        offset_ms = building->duration_ms; // Igual que al programar el plan
+    }
+    gw_scenario_record_t record;
+    if (offset_ms > UINT32_MAX || !request_to_record(peticion, (uint32_t)offset_ms, &record)) {
+        printf("[SIMULATION] Error: Petición %s[%u] fuera de rango para el formato binario\n",
+               building->id_edificio, building->num_records);
+        w->ok = false;
+        return false;
+    }
+    if (fwrite(&record, sizeof(record), 1, w->out) != 1) {
+        w->ok = false;
+        return false;
+    }
+    building->duration_ms = (uint32_t)offset_ms;
+    building->num_records++;
+    w->header.num_records++;
+    return true;
+}
+
+bool gw_scenario_bin_writer_close(gw_scenario_bin_writer_t *w, bool commit) {
+    if (!w) {
+        return false;
+    }
+    bool ok = commit && w->ok;
+    if (ok && w->header.num_buildings == 0) {
+        printf("[SIMULATION] Error: No hay edificios\n");
+        ok = false;
+    }
+    gw_scenario_bin_header_t *header = &w->header;
+    if (ok) {
+        header->buildings_offset = header->records_offset + header->num_records * sizeof(gw_scenario_record_t);
+        header->magic = GW_SCENARIO_BIN_MAGIC;
+        ok = fwrite(w->buildings, sizeof(*w->buildings), header->num_buildings, w->out) == header->num_buildings &&
+             fseek(w->out, 0, SEEK_SET) == 0 && fwrite(header, sizeof(*header), 1, w->out) == 1;
+    }
+    if (fflush(w->out) != 0 || fsync(fileno(w->out)) != 0) {
+        ok = false;
+    }
+    if (fclose(w->out) != 0) {
+        ok = false;
+    }
+
+    if (!ok || rename(w->tmp_path, w->bin_path) != 0) {
+        if (ok) {
+            printf("[SIMULATION] Error: No se pudo renombrar %s a %s: %s\n", w->tmp_path, w->bin_path, strerror(errno));
+            ok = false;
+        }
+        remove(w->tmp_path);
+    } else {
+        printf("[SIMULATION] Escenario compilado en %s: %u edificios, %llu peticiones\n",
+               w->bin_path, header->num_buildings, (unsigned long long)header->num_records);
+    }
+    free(w->buildings);
+    free(w);
+    return ok;
+}
+
+bool gw_scenario_bin_compile(const char *json_path, const char *bin_path, uint32_t interval_ms) {
+    if (!json_path || !bin_path) {
+        printf("[SIMULATION] Error: Parámetros nulos\n");
+        return false;
+    }
+    gw_scenario_stream_t *stream = gw_scenario_open(json_path);
+    if (!stream) {
+        return false;
+    }
+    gw_scenario_bin_writer_t *writer = gw_scenario_bin_writer_open(bin_path, interval_ms);
+    if (!writer) {
+        gw_scenario_close(stream);
+        return false;
+    }
+
+    char id[sizeof(((gw_scenario_building_t *)0)->id_edificio)];
+    bool ok = true;
+    int r = 0;
+    while (ok && (r = gw_scenario_next_building(stream, id, sizeof(id))) == 1) {
+        ok = gw_scenario_bin_writer_building(writer, id);
+        peticion_simulacion_t peticion;
+        while (ok && (r = gw_scenario_next_request(stream, &peticion)) == 1) {
+            ok = gw_scenario_bin_writer_request(writer, &peticion);
+        }
+        ok = ok && r == 0;
+    }
+    ok = ok && r == 0;
+    gw_scenario_close(stream);
+    return gw_scenario_bin_writer_close(writer, ok);
+}
+
+bool gw_scenario_bin_map(const char *path, gw_scenario_map_t *map) {
+    if (!path || !map) {
+        return false;
+    }
+    memset(map, 0, sizeof(*map));
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        printf("[SIMULATION] Error: No se pudo abrir %s\n", path);
+        printf("[SIMULATION] Error detallado: %s\n", strerror(errno));
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(gw_scenario_bin_header_t)) {
+        printf("[SIMULATION] Error: %s no es un escenario binario válido\n", path);
+        close(fd);
+        return false;
+    }
+    void *base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);  // La proyección sigue viva sin el descriptor
+    if (base == MAP_FAILED) {
+        printf("[SIMULATION] Error: mmap de %s falló: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    map->base = base;
+    map->size = (size_t)st.st_size;
+    map->header = base;
+
+    const gw_scenario_bin_header_t *h = map->header;
+    uint64_t size = map->size;
+    bool valid = h->magic == GW_SCENARIO_BIN_MAGIC && h->version == GW_SCENARIO_BIN_VERSION &&
+                 h->record_size == sizeof(gw_scenario_record_t) &&
+                 h->building_size == sizeof(gw_scenario_building_t) &&
+                 h->records_offset % SCENARIO_BIN_ALIGN == 0 &&
+                 h->records_offset >= sizeof(*h) && h->records_offset <= size &&
+                 h->num_records <= (size - h->records_offset) / sizeof(gw_scenario_record_t) &&
+                 h->buildings_offset % sizeof(uint64_t) == 0 &&
+                 h->buildings_offset >= sizeof(*h) && h->buildings_offset <= size &&
+                 h->num_buildings <= (size - h->buildings_offset) / sizeof(gw_scenario_building_t);
+    if (valid) {
+        map->records = (const gw_scenario_record_t *)((const uint8_t *)base + h->records_offset);
+        map->buildings = (const gw_scenario_building_t *)((const uint8_t *)base + h->buildings_offset);
+        for (uint32_t i = 0; valid && i < h->num_buildings; ++i) {
+            const gw_scenario_building_t *b = &map->buildings[i];
+            valid = memchr(b->id_edificio, '\0', sizeof(b->id_edificio)) != NULL &&
+                    b->first_record <= h->num_records && b->num_records <= h->num_records - b->first_record;
+        }
+    }
+    if (!valid) {
+        printf("[SIMULATION] Error: %s no es un escenario binario válido (versión %u)\n", path, GW_SCENARIO_BIN_VERSION);
+        gw_scenario_bin_unmap(map);
+        return false;
+    }
+    return true;
+}
+
+void gw_scenario_bin_unmap(gw_scenario_map_t *map) {
+    if (!map) return;
+    if (map->base) {
+        munmap(map->base, map->size);
+    }
+    memset(map, 0, sizeof(*map));
+}
+
+int gw_scenario_bin_find(const gw_scenario_map_t *map, const char *id_edificio) {
+    if (!map || !map->header || !id_edificio) {
+        return -1;
+    }
+    for (uint32_t i = 0; i < map->header->num_buildings; ++i) {
+        if (strcmp(map->buildings[i].id_edificio, id_edificio) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+bool gw_scenario_bin_to_request(const gw_scenario_record_t *record, peticion_simulacion_t *out) {
+    if (!record || !out) {
+        return false;
+    }
+    memset(out, 0, sizeof(*out));
+    out->pasajeros = record->pasajeros ? record->pasajeros : 1;
+    if (record->flags & GW_SCENARIO_REC_INSTANTE) {
+        out->tiene_instante = true;
+        out->instante_ms = record->offset_ms;
+    }
+    if (record->tipo == PETICION_LLAMADA_PISO) {
+        if (record->direccion != MOVING_UP && record->direccion != MOVING_DOWN) {
+            return false;
+        }
+        out->tipo = PETICION_LLAMADA_PISO;
+        out->piso_origen = record->piso_origen;
+        out->direccion = (movement_direction_enum_t)record->direccion;
+        return true;
+    }
+    if (record->tipo == PETICION_SOLICITUD_CABINA) {
+        out->tipo = PETICION_SOLICITUD_CABINA;
+        out->indice_ascensor = record->indice_ascensor;
+        out->piso_destino = record->piso_destino;
+        return true;
+    }
+    return false;
+}
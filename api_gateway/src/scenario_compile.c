@@ -0,0 +1,118 @@
+/**
+ * @file scenario_compile.c
+ * @brief Herramienta de compilación de escenarios al formato binario
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Convierte un escenario JSON (simulation_data.json) al formato binario de
+ * scenario_binary.h, que los gateways proyectan con mmap() en lugar de
+ * analizar el JSON en cada arranque.
+ *
+ * **Uso:**
+ * ```
+ * gw_scenario_compile <entrada.json> <salida.bin> [--interval-ms <ms>]
+ * gw_scenario_compile --info <escenario.bin>
+ * ```
+ * - --interval-ms: separación entre peticiones sin "instante_ms" (por defecto 2000)
+ * - --info: valida un fichero compilado e imprime su contenido resumido
+ *
+ * @see scenario_binary.h
+ */
+
+#include "api_gateway/scenario_binary.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * @brief Separación por defecto entre peticiones (la del simulador del gateway)
+ */
+#define COMPILE_DEFAULT_INTERVAL_MS 2000
+
+static void print_usage(const char *prog) {
+    fprintf(stderr, "Uso: %s <entrada.json> <salida.bin> [--interval-ms <ms>]\n"
+                    "     %s --info <escenario.bin>\n", prog, prog);
+}
+
+/**
+ * @brief Valida un escenario compilado y resume su contenido
+ */
+static int print_info(const char *path) {
+    gw_scenario_map_t map;
+    if (!gw_scenario_bin_map(path, &map)) {
+        return EXIT_FAILURE;
+    }
+
+    uint64_t invalid = 0, floor_calls = 0;
+    uint32_t max_duration = 0;
+    peticion_simulacion_t peticion;
+    for (uint64_t k = 0; k < map.header->num_records; ++k) {
+        if (!gw_scenario_bin_to_request(&map.records[k], &peticion)) {
+            invalid++;
+        } else if (peticion.tipo == PETICION_LLAMADA_PISO) {
+            floor_calls++;
+        }
+    }
+    for (uint32_t i = 0; i < map.header->num_buildings; ++i) {
+        if (map.buildings[i].duration_ms > max_duration) {
+            max_duration = map.buildings[i].duration_ms;
+        }
+    }
+
+    printf("\n=== ESCENARIO BINARIO: %s ===\n", path);
+    printf("Versión: %u, tamaño: %zu bytes\n", map.header->version, map.size);
+    printf("Edificios: %u (primero %s, último %s)\n", map.header->num_buildings,
+           map.header->num_buildings ? map.buildings[0].id_edificio : "-",
+           map.header->num_buildings ? map.buildings[map.header->num_buildings - 1].id_edificio : "-");
+    printf("Peticiones: %llu (%llu llamadas de piso, %llu solicitudes de cabina)\n",
+           (unsigned long long)map.header->num_records, (unsigned long long)floor_calls,
+           (unsigned long long)(map.header->num_records - floor_calls - invalid));
+    printf("Duración máxima de un edificio: %.1f s\n", max_duration / 1000.0);
+    printf("Registros inválidos: %llu\n", (unsigned long long)invalid);
+
+    gw_scenario_bin_unmap(&map);
+    return invalid == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int main(int argc, char *argv[]) {
+    const char *input = NULL;
+    const char *output = NULL;
+    const char *info = NULL;
+    uint32_t interval_ms = COMPILE_DEFAULT_INTERVAL_MS;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--info") == 0 && i + 1 < argc) {
+            info = argv[++i];
+        } else if (strcmp(argv[i], "--interval-ms") == 0 && i + 1 < argc) {
+            interval_ms = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (argv[i][0] != '-' && !input) {
+            input = argv[i];
+        } else if (argv[i][0] != '-' && !output) {
+            output = argv[i];
+        } else {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (info) {
+        return print_info(info);
+    }
+    if (!input || !output) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    bool ok = gw_scenario_bin_compile(input, output, interval_ms);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    if (!ok) {
+        fprintf(stderr, "Error: no se pudo compilar '%s' en '%s'.\n", input, output);
+        return EXIT_FAILURE;
+    }
+    printf("Compilado en %.3f s\n", (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) / 1e9);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,609 @@
+/**
+ * @file scenario_stream.c
+ * @brief Implementación del lector en streaming de escenarios JSON
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Analizador descendente sobre un búfer fijo: solo conserva el carácter
+ * actual, la posición en el fichero y el estado (dentro del array de
+ * edificios, dentro de las peticiones de un edificio o en el resto del
+ * objeto edificio). Los valores que no interesan se saltan sin copiarlos.
+ *
+ * @see scenario_stream.h
+ */
+
+#define _FILE_OFFSET_BITS 64
+
+#include "api_gateway/scenario_stream.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+/**
+ * @brief Tamaño del búfer de lectura
+ */
+#define SCENARIO_BUFFER_SIZE 65536
+
+/**
+ * @brief Longitud máxima de claves y literales numéricos
+ */
+#define SCENARIO_TOKEN_MAX 64
+
+/**
+ * @brief Posición del lector dentro del documento
+ */
+typedef enum {
+    SCENARIO_IN_BUILDINGS,      ///< Entre edificios del array "edificios"
+    SCENARIO_IN_REQUESTS,       ///< Dentro del array "peticiones" del edificio actual
+    SCENARIO_IN_BUILDING_TAIL,  ///< Tras las peticiones, en el resto del objeto edificio
+    SCENARIO_AT_END,            ///< Array de edificios terminado
+    SCENARIO_FAILED             ///< Error de formato; el lector ya no avanza
+} scenario_state_t;
+
+struct gw_scenario_stream_t {
+    FILE *file;
+    char *buffer;
+    size_t length;              ///< Bytes válidos en el búfer
+    size_t pos;                 ///< Siguiente byte a consumir
+    int64_t buffer_offset;      ///< Posición en el fichero de buffer[0]
+    scenario_state_t state;
+    bool first_building;        ///< Sin coma antes del próximo edificio
+    bool first_member;          ///< Sin coma antes del próximo miembro del edificio
+    bool first_request;         ///< Sin coma antes de la próxima petición
+    int building_count;         ///< Edificios entregados (para los mensajes de error)
+    int request_count;          ///< Peticiones entregadas del edificio actual
+    uint32_t last_instante_ms;  ///< Último "instante_ms" del edificio actual (orden no decreciente)
+    int64_t building_offset;    ///< Inicio del objeto del edificio actual
+    char building_id[16];       ///< ID del edificio actual (para los mensajes de error)
+};
+
+static int64_t stream_offset(const gw_scenario_stream_t *s) {
+    return s->buffer_offset + (int64_t)s->pos;
+}
+
+static bool stream_fail(gw_scenario_stream_t *s, const char *what) {
+    if (s->state != SCENARIO_FAILED) {
+        printf("[SIMULATION] Error: %s (byte %lld)\n", what, (long long)stream_offset(s));
+        s->state = SCENARIO_FAILED;
+    }
+    return false;
+}
+
+static int peek_raw(gw_scenario_stream_t *s) {
+    if (s->pos == s->length) {
+        s->buffer_offset += (int64_t)s->length;
+        s->length = fread(s->buffer, 1, SCENARIO_BUFFER_SIZE, s->file);
+        s->pos = 0;
+        if (s->length == 0) {
+            return EOF;
+        }
+    }
+    return (unsigned char)s->buffer[s->pos];
+}
+
+static int next_raw(gw_scenario_stream_t *s) {
+    int c = peek_raw(s);
+    if (c != EOF) {
+        s->pos++;
+    }
+    return c;
+}
+
+/**
+ * @brief Salta espacios y devuelve (sin consumir) el siguiente carácter
+ */
+static int peek_token(gw_scenario_stream_t *s) {
+    int c;
+    while ((c = peek_raw(s)) == ' ' || c == '\n' || c == '\r' || c == '\t') {
+        s->pos++;
+    }
+    return c;
+}
+
+static bool expect_char(gw_scenario_stream_t *s, char expected) {
+    if (peek_token(s) != (unsigned char)expected) {
+        char what[48];
+        snprintf(what, sizeof(what), "se esperaba '%c'", expected);
+        return stream_fail(s, what);
+    }
+    s->pos++;
+    return true;
+}
+
+/**
+ * @brief Lee una cadena JSON
+ * @param out Destino (NULL para saltarla); se trunca a @p size - 1
+ *
+ * Los escapes simples se decodifican; \\uXXXX se conserva solo si es ASCII.
+ */
+static bool read_string(gw_scenario_stream_t *s, char *out, size_t size) {
+    if (!expect_char(s, '"')) {
+        return false;
+    }
+    size_t n = 0;
+    for (;;) {
+        int c = next_raw(s);
+        if (c == EOF) {
+            return stream_fail(s, "cadena sin terminar");
+        }
+        if (c == '"') {
+            break;
+        }
+        if (c == '\\') {
+            c = next_raw(s);
+            switch (c) {
+                case 'n': c = '\n'; break;
+                case 't': c = '\t'; break;
+                case 'r': c = '\r'; break;
+                case 'b': c = '\b'; break;
+                case 'f': c = '\f'; break;
+                case '"': case '\\': case '/': break;
+                case 'u': {
+                    unsigned code = 0;
+                    for (int i = 0; i < 4; i++) {
+                        int h = next_raw(s);
+                        if (h >= '0' && h <= '9') code = code * 16 + (unsigned)(h - '0');
+                        else if (h >= 'a' && h <= 'f') code = code * 16 + (unsigned)(h - 'a' + 10);
+                        else if (h >= 'A' && h <= 'F') code = code * 16 + (unsigned)(h - 'A' + 10);
+                        else return stream_fail(s, "escape \\u inválido");
+                    }
+                    c = code < 0x80 ? (int)code : '?';
+                    break;
+                }
+                default:
+                    return stream_fail(s, "escape inválido en cadena");
+            }
+        }
+        if (out && n + 1 < size) {
+            out[n++] = (char)c;
+        }
+    }
+    if (out && size > 0) {
+        out[n] = '\0';
+    }
+    return true;
+}
+
+/**
+ * @brief Lee un número JSON
+ * @param out Valor leído
+ * @return false si el siguiente valor no es un número
+ */
+static bool read_number(gw_scenario_stream_t *s, double *out) {
+    char token[SCENARIO_TOKEN_MAX];
+    size_t n = 0;
+    int c = peek_token(s);
+    while (c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E' || (c >= '0' && c <= '9')) {
+        if (n + 1 >= sizeof(token)) {
+            return stream_fail(s, "número demasiado largo");
+        }
+        token[n++] = (char)c;
+        s->pos++;
+        c = peek_raw(s);
+    }
+    token[n] = '\0';
+    char *end = NULL;
+    *out = strtod(token, &end);
+    if (n == 0 || *end != '\0') {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Salta un valor JSON completo (objeto, array, cadena o literal)
+ */
+static bool skip_value(gw_scenario_stream_t *s) {
+    int c = peek_token(s);
+    if (c == '"') {
+        return read_string(s, NULL, 0);
+    }
+    if (c != '{' && c != '[') {
+        size_t n = 0;
+        while (c == '-' || c == '+' || c == '.' || (c >= '0' && c <= '9') ||
+               (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
+            s->pos++;
+            n++;
+            c = peek_raw(s);
+        }
+        return n > 0 ? true : stream_fail(s, "valor inválido");
+    }
+
+    int depth = 0;
+    do {
+        c = peek_token(s);
+        if (c == EOF) {
+            return stream_fail(s, "fin de fichero inesperado");
+        }
+        if (c == '"') {
+            if (!read_string(s, NULL, 0)) {
+                return false;
+            }
+            continue;
+        }
+        s->pos++;
+        if (c == '{' || c == '[') {
+            depth++;
+        } else if (c == '}' || c == ']') {
+            depth--;
+        }
+    } while (depth > 0);
+    return true;
+}
+
+/**
+ * @brief Avanza al siguiente elemento de un array u objeto ya abierto
+ * @param first Indicador de primer elemento (se actualiza)
+ * @param close Carácter de cierre del contenedor
+ * @return 1 si hay elemento, 0 si se consumió el cierre, -1 si error
+ */
+static int next_element(gw_scenario_stream_t *s, bool *first, char close) {
+    int c = peek_token(s);
+    if (c == (unsigned char)close) {
+        s->pos++;
+        return 0;
+    }
+    if (!*first) {
+        if (c != ',') {
+            stream_fail(s, "se esperaba ',' entre elementos");
+            return -1;
+        }
+        s->pos++;
+    }
+    *first = false;
+    return 1;
+}
+
+/**
+ * @brief Lee la clave de un miembro de objeto y el ':' que la sigue
+ */
+static bool read_key(gw_scenario_stream_t *s, char *key, size_t size) {
+    return read_string(s, key, size) && expect_char(s, ':');
+}
+
+static bool seek_to(gw_scenario_stream_t *s, int64_t offset) {
+    if (offset >= s->buffer_offset && offset <= s->buffer_offset + (int64_t)s->length) {
+        // Todavía en el búfer: no hace falta volver a leer
+        s->pos = (size_t)(offset - s->buffer_offset);
+        return true;
+    }
+    if (fseeko(s->file, (off_t)offset, SEEK_SET) != 0) {
+        printf("[SIMULATION] Error: No se pudo posicionar en el byte %lld: %s\n",
+               (long long)offset, strerror(errno));
+        s->state = SCENARIO_FAILED;
+        return false;
+    }
+    s->buffer_offset = offset;
+    s->length = 0;
+    s->pos = 0;
+    return true;
+}
+
+gw_scenario_stream_t* gw_scenario_open(const char *path) {
+    if (!path) {
+        printf("[SIMULATION] Error: Parámetros nulos\n");
+        return NULL;
+    }
+    gw_scenario_stream_t *s = calloc(1, sizeof(*s));
+    if (!s || !(s->buffer = malloc(SCENARIO_BUFFER_SIZE))) {
+        printf("[SIMULATION] Error: No se pudo asignar memoria\n");
+        free(s);
+        return NULL;
+    }
+    s->file = fopen(path, "rb");
+    if (!s->file) {
+        printf("[SIMULATION] Error: No se pudo abrir %s\n", path);
+        printf("[SIMULATION] Error detallado: %s\n", strerror(errno));
+        gw_scenario_close(s);
+        return NULL;
+    }
+    s->building_offset = -1;
+
+    // Raíz: buscar "edificios" saltando cualquier otra clave
+    bool first = true;
+    char key[SCENARIO_TOKEN_MAX];
+    if (expect_char(s, '{')) {
+        int r;
+        while ((r = next_element(s, &first, '}')) == 1) {
+            if (!read_key(s, key, sizeof(key))) {
+                break;
+            }
+            if (strcmp(key, "edificios") == 0) {
+                if (peek_token(s) != '[') {
+                    printf("[SIMULATION] Error: 'edificios' no es array\n");
+                    break;
+                }
+                s->pos++;
+                s->state = SCENARIO_IN_BUILDINGS;
+                s->first_building = true;
+                return s;
+            }
+            if (!skip_value(s)) {
+                break;
+            }
+        }
+        if (r == 0) {
+            printf("[SIMULATION] Error: 'edificios' no es array\n");
+        }
+    }
+    gw_scenario_close(s);
+    return NULL;
+}
+
+void gw_scenario_close(gw_scenario_stream_t *stream) {
+    if (!stream) return;
+    if (stream->file) {
+        fclose(stream->file);
+    }
+    free(stream->buffer);
+    free(stream);
+}
+
+/**
+ * @brief Salta lo que quede del edificio actual hasta su '}'
+ */
+static bool finish_building(gw_scenario_stream_t *s) {
+    int r;
+    if (s->state == SCENARIO_IN_REQUESTS) {
+        while ((r = next_element(s, &s->first_request, ']')) == 1) {
+            if (!skip_value(s)) {
+                return false;
+            }
+        }
+        if (r < 0) {
+            return false;
+        }
+        s->state = SCENARIO_IN_BUILDING_TAIL;
+    }
+    if (s->state == SCENARIO_IN_BUILDING_TAIL) {
+        char key[SCENARIO_TOKEN_MAX];
+        while ((r = next_element(s, &s->first_member, '}')) == 1) {
+            if (!read_key(s, key, sizeof(key)) || !skip_value(s)) {
+                return false;
+            }
+        }
+        if (r < 0) {
+            return false;
+        }
+        s->state = SCENARIO_IN_BUILDINGS;
+    }
+    return s->state == SCENARIO_IN_BUILDINGS;
+}
+
+/**
+ * @brief Entra en el array de peticiones situado en la posición actual
+ */
+static bool enter_requests(gw_scenario_stream_t *s) {
+    if (peek_token(s) != '[') {
+        char what[64];
+        snprintf(what, sizeof(what), "Peticiones inválidas para %s", s->building_id);
+        return stream_fail(s, what);
+    }
+    s->pos++;
+    s->state = SCENARIO_IN_REQUESTS;
+    s->first_request = true;
+    s->request_count = 0;
+    s->last_instante_ms = 0;
+    return true;
+}
+
+int gw_scenario_next_building(gw_scenario_stream_t *stream, char *id_out, size_t id_size) {
+    if (!stream) {
+        return -1;
+    }
+    gw_scenario_stream_t *s = stream;
+    if (s->state == SCENARIO_AT_END) {
+        return 0;
+    }
+    if (!finish_building(s)) {
+        return -1;
+    }
+
+    int r = next_element(s, &s->first_building, ']');
+    if (r <= 0) {
+        if (r == 0) {
+            s->state = SCENARIO_AT_END;
+            s->building_offset = -1;
+        }
+        return r;
+    }
+    peek_token(s);
+    s->building_offset = stream_offset(s);
+    if (!expect_char(s, '{')) {
+        return -1;
+    }
+
+    s->first_member = true;
+    s->building_id[0] = '\0';
+    bool id_found = false;
+    int64_t requests_offset = -1;
+    char key[SCENARIO_TOKEN_MAX];
+    while ((r = next_element(s, &s->first_member, '}')) == 1) {
+        if (!read_key(s, key, sizeof(key))) {
+            return -1;
+        }
+        if (strcmp(key, "id_edificio") == 0) {
+            if (peek_token(s) != '"') {
+                char what[64];
+                snprintf(what, sizeof(what), "ID edificio inválido en %d", s->building_count);
+                stream_fail(s, what);
+                return -1;
+            }
+            if (!read_string(s, s->building_id, sizeof(s->building_id))) {
+                return -1;
+            }
+            id_found = true;
+            if (requests_offset >= 0) {
+                // Las peticiones venían antes del ID: volver a ellas
+                if (!seek_to(s, requests_offset) || !enter_requests(s)) {
+                    return -1;
+                }
+                break;
+            }
+        } else if (strcmp(key, "peticiones") == 0 && !id_found) {
+            peek_token(s);
+            requests_offset = stream_offset(s);
+            if (!skip_value(s)) {
+                return -1;
+            }
+        } else if (strcmp(key, "peticiones") == 0) {
+            if (!enter_requests(s)) {
+                return -1;
+            }
+            break;
+        } else if (!skip_value(s)) {
+            return -1;
+        }
+    }
+    if (r < 0) {
+        return -1;
+    }
+    if (r == 0) {
+        char what[64];
+        if (!id_found) {
+            snprintf(what, sizeof(what), "ID edificio inválido en %d", s->building_count);
+        } else {
+            snprintf(what, sizeof(what), "Peticiones inválidas para %s", s->building_id);
+        }
+        stream_fail(s, what);
+        return -1;
+    }
+
+    if (id_out && id_size > 0) {
+        strncpy(id_out, s->building_id, id_size - 1);
+        id_out[id_size - 1] = '\0';
+    }
+    s->building_count++;
+    return 1;
+}
+
+int gw_scenario_next_request(gw_scenario_stream_t *stream, peticion_simulacion_t *out) {
+    if (!stream || !out) {
+        return -1;
+    }
+    gw_scenario_stream_t *s = stream;
+    if (s->state == SCENARIO_FAILED) {
+        return -1;
+    }
+    if (s->state != SCENARIO_IN_REQUESTS) {
+        return 0;
+    }
+    int r = next_element(s, &s->first_request, ']');
+    if (r <= 0) {
+        if (r == 0) {
+            s->state = SCENARIO_IN_BUILDING_TAIL;
+        }
+        return r;
+    }
+    if (!expect_char(s, '{')) {
+        return -1;
+    }
+
+    char tipo[24] = "";
+    char direccion[8] = "";
+    char key[SCENARIO_TOKEN_MAX];
+    double piso_origen = 0, indice = 0, destino = 0, instante = 0, pasajeros = 1;
+    bool has_tipo = false, has_origen = false, has_direccion = false;
+    bool has_indice = false, has_destino = false, has_instante = false;
+    bool first = true;
+
+    memset(out, 0, sizeof(*out));
+    while ((r = next_element(s, &first, '}')) == 1) {
+        if (!read_key(s, key, sizeof(key))) {
+            return -1;
+        }
+        bool ok = true;
+        if (strcmp(key, "tipo") == 0 && peek_token(s) == '"') {
+            ok = has_tipo = read_string(s, tipo, sizeof(tipo));
+        } else if (strcmp(key, "direccion") == 0 && peek_token(s) == '"') {
+            ok = has_direccion = read_string(s, direccion, sizeof(direccion));
+        } else if (strcmp(key, "piso_origen") == 0 && read_number(s, &piso_origen)) {
+            has_origen = true;
+        } else if (strcmp(key, "indice_ascensor") == 0 && read_number(s, &indice)) {
+            has_indice = true;
+        } else if (strcmp(key, "piso_destino") == 0 && read_number(s, &destino)) {
+            has_destino = true;
+        } else if (strcmp(key, "instante_ms") == 0 && read_number(s, &instante)) {
+            has_instante = true;
+        } else if (strcmp(key, "pasajeros") == 0 && read_number(s, &pasajeros)) {
+            // Se valida tras leer el objeto
+        } else {
+            ok = s->state != SCENARIO_FAILED && skip_value(s);
+        }
+        if (!ok) {
+            return -1;
+        }
+    }
+    if (r < 0) {
+        return -1;
+    }
+
+    char what[96];
+    const char *id = s->building_id;
+    int idx = s->request_count;
+    if (!(pasajeros >= 1 && pasajeros <= UINT16_MAX)) {
+        snprintf(what, sizeof(what), "pasajeros inválido en %s[%d]", id, idx);
+        stream_fail(s, what);
+        return -1;
+    }
+    out->pasajeros = (uint16_t)pasajeros;
+    if (has_instante) {
+        if (!(instante >= s->last_instante_ms && instante <= UINT32_MAX)) {
+            snprintf(what, sizeof(what), "instante_ms inválido o decreciente en %s[%d]", id, idx);
+            stream_fail(s, what);
+            return -1;
+        }
+        out->tiene_instante = true;
+        out->instante_ms = (uint32_t)instante;
+        s->last_instante_ms = out->instante_ms;
+    }
+    if (!has_tipo) {
+        snprintf(what, sizeof(what), "Tipo inválido en %s[%d]", id, idx);
+    } else if (strcmp(tipo, "llamada_piso") == 0) {
+        out->tipo = PETICION_LLAMADA_PISO;
+        out->piso_origen = (int)piso_origen;
+        out->direccion = convertir_direccion_string(direccion);
+        if (!has_origen) {
+            snprintf(what, sizeof(what), "piso_origen inválido en %s[%d]", id, idx);
+        } else if (!has_direccion) {
+            snprintf(what, sizeof(what), "dirección inválida en %s[%d]", id, idx);
+        } else {
+            s->request_count++;
+            return 1;
+        }
+    } else if (strcmp(tipo, "solicitud_cabina") == 0) {
+        out->tipo = PETICION_SOLICITUD_CABINA;
+        out->indice_ascensor = (int)indice;
+        out->piso_destino = (int)destino;
+        if (!has_indice) {
+            snprintf(what, sizeof(what), "indice_ascensor inválido en %s[%d]", id, idx);
+        } else if (!has_destino) {
+            snprintf(what, sizeof(what), "piso_destino inválido en %s[%d]", id, idx);
+        } else {
+            s->request_count++;
+            return 1;
+        }
+    } else {
+        snprintf(what, sizeof(what), "Tipo '%s' desconocido en %s[%d]", tipo, id, idx);
+    }
+    stream_fail(s, what);
+    return -1;
+}
+
+int64_t gw_scenario_building_offset(const gw_scenario_stream_t *stream) {
+    return stream ? stream->building_offset : -1;
+}
+
+int gw_scenario_seek_building(gw_scenario_stream_t *stream, int64_t offset) {
+    if (!stream || offset < 0 || !seek_to(stream, offset)) {
+        return -1;
+    }
+    stream->state = SCENARIO_IN_BUILDINGS;
+    stream->first_building = true;
+    stream->building_offset = -1;
+    return 0;
+}
@@ -0,0 +1,143 @@
+/**
+ * @file sim_event_queue.c
+ * @brief Implementación de la cola de eventos discretos con reloj virtual
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * @see sim_event_queue.h
+ */
+
+#include "api_gateway/sim_event_queue.h"
+#include "api_gateway/logging_gw.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Capacidad inicial del montículo
+ */
+#define SIM_QUEUE_INITIAL_CAPACITY 64
+
+/**
+ * @brief Orden del montículo: instante y, a igualdad, orden de programación
+ */
+static bool event_before(const gw_sim_event_t *a, const gw_sim_event_t *b) {
+    return a->time_ms < b->time_ms || (a->time_ms == b->time_ms && a->seq < b->seq);
+}
+
+static void sift_up(gw_sim_event_t *heap, size_t i) {
+    gw_sim_event_t ev = heap[i];
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (!event_before(&ev, &heap[parent])) {
+            break;
+        }
+        heap[i] = heap[parent];
+        i = parent;
+    }
+    heap[i] = ev;
+}
+
+static void sift_down(gw_sim_event_t *heap, size_t count, size_t i) {
+    gw_sim_event_t ev = heap[i];
+    for (;;) {
+        size_t child = 2 * i + 1;
+        if (child >= count) {
+            break;
+        }
+        if (child + 1 < count && event_before(&heap[child + 1], &heap[child])) {
+            child++;
+        }
+        if (!event_before(&heap[child], &ev)) {
+            break;
+        }
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = ev;
+}
+
+void gw_sim_queue_init(gw_sim_queue_t *queue, uint64_t start_ms) {
+    if (!queue) return;
+    memset(queue, 0, sizeof(*queue));
+    queue->now_ms = start_ms;
+}
+
+void gw_sim_queue_free(gw_sim_queue_t *queue) {
+    if (!queue) return;
+    free(queue->heap);
+    queue->heap = NULL;
+    queue->count = 0;
+    queue->capacity = 0;
+}
+
+bool gw_sim_queue_schedule(gw_sim_queue_t *queue, uint64_t time_ms, gw_sim_event_cb_t cb,
+                           void *arg, uint16_t building_index, int32_t value) {
+    if (!queue || !cb) {
+        return false;
+    }
+    if (queue->count == queue->capacity) {
+        size_t capacity = queue->capacity ? queue->capacity * 2 : SIM_QUEUE_INITIAL_CAPACITY;
+        gw_sim_event_t *heap = realloc(queue->heap, capacity * sizeof(gw_sim_event_t));
+        if (!heap) {
+            LOG_ERROR_GW("[SimQueue] Sin memoria para %zu eventos.", capacity);
+            return false;
+        }
+        queue->heap = heap;
+        queue->capacity = capacity;
+    }
+
+    gw_sim_event_t *ev = &queue->heap[queue->count];
+    ev->time_ms = time_ms < queue->now_ms ? queue->now_ms : time_ms;
+    ev->seq = queue->next_seq++;
+    ev->cb = cb;
+    ev->arg = arg;
+    ev->building_index = building_index;
+    ev->value = value;
+    sift_up(queue->heap, queue->count++);
+    return true;
+}
+
+bool gw_sim_queue_schedule_in(gw_sim_queue_t *queue, uint64_t delay_ms, gw_sim_event_cb_t cb,
+                              void *arg, uint16_t building_index, int32_t value) {
+    if (!queue) {
+        return false;
+    }
+    return gw_sim_queue_schedule(queue, queue->now_ms + delay_ms, cb, arg, building_index, value);
+}
+
+size_t gw_sim_queue_run_until(gw_sim_queue_t *queue, uint64_t until_ms) {
+    if (!queue) {
+        return 0;
+    }
+    size_t executed = 0;
+    while (queue->count > 0 && queue->heap[0].time_ms <= until_ms) {
+        // Copiar antes de extraer: la acción puede programar y realojar el montículo
+        gw_sim_event_t ev = queue->heap[0];
+        queue->heap[0] = queue->heap[--queue->count];
+        if (queue->count > 0) {
+            sift_down(queue->heap, queue->count, 0);
+        }
+        queue->now_ms = ev.time_ms;
+        ev.cb(queue, &ev);
+        executed++;
+    }
+    if (until_ms != UINT64_MAX && until_ms > queue->now_ms) {
+        queue->now_ms = until_ms;
+    }
+    queue->executed += executed;
+    return executed;
+}
+
+uint64_t gw_sim_queue_next_time(const gw_sim_queue_t *queue) {
+    return (queue && queue->count > 0) ? queue->heap[0].time_ms : UINT64_MAX;
+}
+
+uint64_t gw_sim_queue_now(const gw_sim_queue_t *queue) {
+    return queue ? queue->now_ms : 0;
+}
+
+size_t gw_sim_queue_size(const gw_sim_queue_t *queue) {
+    return queue ? queue->count : 0;
+}
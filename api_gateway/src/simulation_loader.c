@@ -7,21 +7,236 @@
  */
 #include "api_gateway/simulation_loader.h"
 #include "api_gateway/elevator_state_manager.h"
+#include "api_gateway/scenario_stream.h"
+#include "api_gateway/scenario_binary.h"
+#include "api_gateway/prng.h"
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <time.h>
-#include <errno.h>
 
 extern elevator_group_state_t managed_elevator_group;
 
+/**
+ * @brief Capacidad inicial de los arrays de edificios y peticiones
+ */
+#define CAPACIDAD_INICIAL_SIMULACION 16
+
+/**
+ * @brief Lee las peticiones del edificio actual del lector
+ * @param stream Lector situado en un edificio
+ * @param edificio Edificio con el ID ya copiado; recibe las peticiones
+ * @return true si se leyeron todas, false si hay error de formato o memoria
+ *
+ * El array crece por duplicación y se ajusta al tamaño final, así que la
+ * memoria es proporcional a las peticiones del edificio, no al fichero.
+ */
+static bool leer_peticiones_edificio(gw_scenario_stream_t *stream, edificio_simulacion_t *edificio) {
+    int capacidad = 0;
+    peticion_simulacion_t peticion;
+    int r;
+
+    while ((r = gw_scenario_next_request(stream, &peticion)) == 1) {
+        if (edificio->num_peticiones == capacidad) {
+            int nueva = capacidad ? capacidad * 2 : CAPACIDAD_INICIAL_SIMULACION;
+            peticion_simulacion_t *peticiones = realloc(edificio->peticiones, nueva * sizeof(peticion_simulacion_t));
+            if (!peticiones) {
+                printf("[SIMULATION] Error: No memoria para peticiones de %s\n", edificio->id_edificio);
+                return false;
+            }
+            edificio->peticiones = peticiones;
+            capacidad = nueva;
+        }
+        edificio->peticiones[edificio->num_peticiones++] = peticion;
+    }
+    if (r < 0) {
+        return false;
+    }
+
+    if (edificio->num_peticiones == 0) {
+        printf("[SIMULATION] Advertencia: %s sin peticiones\n", edificio->id_edificio);
+    } else if (edificio->num_peticiones < capacidad) {
+        peticion_simulacion_t *ajustado = realloc(edificio->peticiones,
+                                                  edificio->num_peticiones * sizeof(peticion_simulacion_t));
+        if (ajustado) {
+            edificio->peticiones = ajustado;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Añade un edificio vacío a los datos de simulación
+ * @return Edificio añadido, o NULL sin memoria
+ */
+static edificio_simulacion_t* anadir_edificio(datos_simulacion_t *datos, int *capacidad) {
+    if (datos->num_edificios == *capacidad) {
+        int nueva = *capacidad ? *capacidad * 2 : CAPACIDAD_INICIAL_SIMULACION;
+        edificio_simulacion_t *edificios = realloc(datos->edificios, nueva * sizeof(edificio_simulacion_t));
+        if (!edificios) {
+            printf("[SIMULATION] Error: No se pudo asignar memoria para edificios\n");
+            return NULL;
+        }
+        datos->edificios = edificios;
+        *capacidad = nueva;
+    }
+    edificio_simulacion_t *edificio = &datos->edificios[datos->num_edificios++];
+    memset(edificio, 0, sizeof(edificio_simulacion_t));
+    return edificio;
+}
+
+/**
+ * @brief Cierra el lector y marca la carga como completada
+ */
+static bool finalizar_carga(gw_scenario_stream_t *stream, datos_simulacion_t *datos) {
+    gw_scenario_close(stream);
+
+    long total_peticiones = 0;
+    for (int i = 0; i < datos->num_edificios; i++) {
+        total_peticiones += datos->edificios[i].num_peticiones;
+    }
+    datos->datos_cargados = true;
+
+    printf("[SIMULATION] Cargados %d edificios con %ld peticiones totales\n",
+           datos->num_edificios, total_peticiones);
+    return true;
+}
+
+/**
+ * @brief Aborta una carga: cierra el lector y libera lo cargado
+ */
+static bool abortar_carga(gw_scenario_stream_t *stream, datos_simulacion_t *datos) {
+    gw_scenario_close(stream);
+    liberar_datos_simulacion(datos);
+    return false;
+}
+
+/**
+ * @brief Abre el escenario dejando @p datos vacío
+ */
+static gw_scenario_stream_t* abrir_escenario(const char *archivo_json, datos_simulacion_t *datos) {
+    if (!archivo_json || !datos) {
+        printf("[SIMULATION] Error: Parámetros nulos\n");
+        return NULL;
+    }
+    memset(datos, 0, sizeof(datos_simulacion_t));
+    printf("[SIMULATION] Intentando abrir archivo: %s\n", archivo_json);
+    return gw_scenario_open(archivo_json);
+}
+
+/**
+ * @brief Edificios que se cargan de un escenario binario
+ */
+typedef enum {
+    SELECCION_PRIMEROS,   ///< Los N primeros
+    SELECCION_INDICE,     ///< Uno por posición
+    SELECCION_ID,         ///< Uno por ID
+    SELECCION_ALEATORIA   ///< Uno al azar
+} seleccion_edificios_t;
+
+/**
+ * @brief Copia un edificio del escenario proyectado a los datos de simulación
+ */
+static bool copiar_edificio_binario(const gw_scenario_map_t *mapa, uint32_t indice,
+                                    datos_simulacion_t *datos, int *capacidad) {
+    const gw_scenario_building_t *origen = &mapa->buildings[indice];
+    edificio_simulacion_t *edificio = anadir_edificio(datos, capacidad);
+    if (!edificio) {
+        return false;
+    }
+    memcpy(edificio->id_edificio, origen->id_edificio, sizeof(edificio->id_edificio));
+    if (origen->num_records == 0) {
+        printf("[SIMULATION] Advertencia: %s sin peticiones\n", edificio->id_edificio);
+        return true;
+    }
+
+    edificio->peticiones = malloc(origen->num_records * sizeof(peticion_simulacion_t));
+    if (!edificio->peticiones) {
+        printf("[SIMULATION] Error: No memoria para peticiones de %s\n", edificio->id_edificio);
+        return false;
+    }
+    const gw_scenario_record_t *registros = &mapa->records[origen->first_record];
+    for (uint32_t k = 0; k < origen->num_records; ++k) {
+        if (!gw_scenario_bin_to_request(&registros[k], &edificio->peticiones[k])) {
+            printf("[SIMULATION] Error: Registro inválido en %s[%u]\n", edificio->id_edificio, k);
+            return false;
+        }
+        edificio->num_peticiones++;
+    }
+    return true;
+}
+
+/**
+ * @brief Carga edificios de un escenario compilado (scenario_binary.h)
+ * @param archivo Fichero binario
+ * @param seleccion Criterio de selección
+ * @param numero Máximo de edificios (SELECCION_PRIMEROS) o posición (SELECCION_INDICE)
+ * @param id_edificio ID buscado (SELECCION_ID)
+ * @param datos Estructura destino
+ *
+ * Solo se leen las páginas del índice y de los registros de los edificios
+ * elegidos; el resto del fichero no se toca.
+ */
+static bool cargar_binario(const char *archivo, seleccion_edificios_t seleccion, int numero,
+                           const char *id_edificio, datos_simulacion_t *datos) {
+    memset(datos, 0, sizeof(datos_simulacion_t));
+    printf("[SIMULATION] Proyectando escenario binario: %s\n", archivo);
+
+    gw_scenario_map_t mapa;
+    if (!gw_scenario_bin_map(archivo, &mapa)) {
+        return false;
+    }
+    int total = (int)mapa.header->num_buildings;
+    int primero = 0;
+    int cuantos = 1;
+    switch (seleccion) {
+        case SELECCION_PRIMEROS:
+            cuantos = numero < total ? numero : total;
+            break;
+        case SELECCION_INDICE:
+            primero = numero;
+            break;
+        case SELECCION_ID:
+            primero = gw_scenario_bin_find(&mapa, id_edificio);
+            break;
+        case SELECCION_ALEATORIA:
+            primero = total > 0 ? (int)gw_prng_below(gw_prng_global(), (uint32_t)total) : -1;
+            break;
+    }
+
+    bool ok = total > 0 && primero >= 0 && primero < total && cuantos > 0;
+    if (!ok) {
+        if (total == 0) {
+            printf("[SIMULATION] Error: No hay edificios\n");
+        } else if (id_edificio) {
+            printf("[SIMULATION] Error: No existe el edificio %s\n", id_edificio);
+        } else {
+            printf("[SIMULATION] Error: No existe el edificio de índice %d\n", numero);
+        }
+    }
+    int capacidad = 0;
+    for (int i = primero; ok && i < primero + cuantos; ++i) {
+        ok = copiar_edificio_binario(&mapa, (uint32_t)i, datos, &capacidad);
+    }
+    gw_scenario_bin_unmap(&mapa);
+
+    if (!ok) {
+        return abortar_carga(NULL, datos);
+    }
+    if (seleccion == SELECCION_ALEATORIA) {
+        printf("[SIMULATION] Edificio seleccionado: %s (índice %d de %d)\n",
+               datos->edificios[0].id_edificio, primero, total);
+    }
+    return finalizar_carga(NULL, datos);
+}
+
 /**
  * @brief Carga los datos de simulación desde un archivo JSON
  * @param archivo_json Ruta al archivo JSON con la configuración de simulación
  * @param datos Puntero a la estructura donde se almacenarán los datos cargados
  * @return true si se cargaron correctamente, false en caso de error
  * 
- * Esta función lee y parsea un archivo JSON que contiene la configuración
+ * Esta función lee un archivo JSON que contiene la configuración
  * de simulación de ascensores, incluyendo edificios y peticiones.
  * 
  * **Estructura JSON esperada:**
@@ -48,209 +263,151 @@ extern elevator_group_state_t managed_elevator_group;
  * ```
  * 
  * **Operaciones realizadas:**
- * - Apertura y lectura del archivo JSON
- * - Parsing y validación de la estructura JSON
- * - Asignación de memoria para edificios y peticiones
+ * - Lectura incremental del archivo (scenario_stream.h), sin cargarlo
+ *   entero en memoria ni construir el árbol cJSON
  * - Validación de tipos de peticiones y parámetros
- * - Inicialización de estructuras de datos
+ * - Asignación de memoria para edificios y peticiones a medida que se leen
  * 
  * En caso de error, libera automáticamente toda la memoria asignada.
  * 
+ * @see cargar_primeros_edificios()
  * @see liberar_datos_simulacion()
  * @see datos_simulacion_t
  * @see edificio_simulacion_t
  */
 bool cargar_datos_simulacion(const char *archivo_json, datos_simulacion_t *datos) {
-    if (!archivo_json || !datos) {
-        printf("[SIMULATION] Error: Parámetros nulos\n");
-        return false;
-    }
-
-    memset(datos, 0, sizeof(datos_simulacion_t));
-    
-    printf("[SIMULATION] Intentando abrir archivo: %s\n", archivo_json);
-
-    FILE *file = fopen(archivo_json, "r");
-    if (!file) {
-        printf("[SIMULATION] Error: No se pudo abrir %s\n", archivo_json);
-        printf("[SIMULATION] Error detallado: %s\n", strerror(errno));
-        return false;
-    }
-
-    printf("[SIMULATION] Archivo abierto exitosamente\n");
-
-    fseek(file, 0, SEEK_END);
-    long file_size = ftell(file);
-    fseek(file, 0, SEEK_SET);
-
-    printf("[SIMULATION] Tamaño del archivo: %ld bytes\n", file_size);
+    return cargar_primeros_edificios(archivo_json, INT_MAX, datos);
+}
 
-    if (file_size <= 0) {
-        printf("[SIMULATION] Error: Archivo vacío\n");
-        fclose(file);
-        return false;
+/**
+ * @brief Carga solo los primeros edificios de un escenario
+ * @see simulation_loader.h
+ */
+bool cargar_primeros_edificios(const char *archivo_json, int max_edificios, datos_simulacion_t *datos) {
+    if (datos && gw_scenario_bin_is_binary(archivo_json)) {
+        return cargar_binario(archivo_json, SELECCION_PRIMEROS, max_edificios, NULL, datos);
     }
-
-    char *json_string = malloc(file_size + 1);
-    if (!json_string) {
-        printf("[SIMULATION] Error: No se pudo asignar memoria\n");
-        fclose(file);
+    gw_scenario_stream_t *stream = abrir_escenario(archivo_json, datos);
+    if (!stream) {
         return false;
     }
 
-    size_t bytes_read = fread(json_string, 1, file_size, file);
-    json_string[bytes_read] = '\0';
-    fclose(file);
-
-    cJSON *json = cJSON_Parse(json_string);
-    free(json_string);
-
-    if (!json) {
-        printf("[SIMULATION] Error: JSON inválido\n");
-        return false;
+    int capacidad = 0;
+    char id[sizeof(datos->edificios->id_edificio)];
+    int r = 0;
+    while (datos->num_edificios < max_edificios &&
+           (r = gw_scenario_next_building(stream, id, sizeof(id))) == 1) {
+        edificio_simulacion_t *edificio = anadir_edificio(datos, &capacidad);
+        if (!edificio) {
+            return abortar_carga(stream, datos);
+        }
+        memcpy(edificio->id_edificio, id, sizeof(id));
+        if (!leer_peticiones_edificio(stream, edificio)) {
+            return abortar_carga(stream, datos);
+        }
     }
-
-    cJSON *edificios_json = cJSON_GetObjectItemCaseSensitive(json, "edificios");
-    if (!cJSON_IsArray(edificios_json)) {
-        printf("[SIMULATION] Error: 'edificios' no es array\n");
-        cJSON_Delete(json);
-        return false;
+    if (r < 0) {
+        return abortar_carga(stream, datos);
     }
-
-    int num_edificios = cJSON_GetArraySize(edificios_json);
-    if (num_edificios <= 0) {
+    if (datos->num_edificios <= 0) {
         printf("[SIMULATION] Error: No hay edificios\n");
-        cJSON_Delete(json);
-        return false;
+        return abortar_carga(stream, datos);
     }
+    return finalizar_carga(stream, datos);
+}
 
-    datos->edificios = malloc(num_edificios * sizeof(edificio_simulacion_t));
-    if (!datos->edificios) {
-        printf("[SIMULATION] Error: No se pudo asignar memoria para edificios\n");
-        cJSON_Delete(json);
+/**
+ * @brief Carga un único edificio, elegido por ID o por posición
+ * @see simulation_loader.h
+ */
+bool cargar_edificio_simulacion(const char *archivo_json, int indice, const char *id_edificio,
+                                datos_simulacion_t *datos) {
+    if (datos && gw_scenario_bin_is_binary(archivo_json)) {
+        return cargar_binario(archivo_json, id_edificio ? SELECCION_ID : SELECCION_INDICE, indice, id_edificio, datos);
+    }
+    gw_scenario_stream_t *stream = abrir_escenario(archivo_json, datos);
+    if (!stream) {
         return false;
     }
 
-    datos->num_edificios = num_edificios;
-
-    cJSON *edificio_json = NULL;
-    int edificio_idx = 0;
-    cJSON_ArrayForEach(edificio_json, edificios_json) {
-        edificio_simulacion_t *edificio = &datos->edificios[edificio_idx];
-        memset(edificio, 0, sizeof(edificio_simulacion_t));
-
-        cJSON *id_json = cJSON_GetObjectItemCaseSensitive(edificio_json, "id_edificio");
-        if (!cJSON_IsString(id_json)) {
-            printf("[SIMULATION] Error: ID edificio inválido en %d\n", edificio_idx);
-            liberar_datos_simulacion(datos);
-            cJSON_Delete(json);
-            return false;
+    char id[sizeof(datos->edificios->id_edificio)];
+    int r;
+    for (int i = 0; (r = gw_scenario_next_building(stream, id, sizeof(id))) == 1; i++) {
+        bool elegido = id_edificio ? strcmp(id, id_edificio) == 0 : i == indice;
+        if (!elegido) {
+            continue;  // next_building salta sus peticiones sin leerlas
         }
-
-        strncpy(edificio->id_edificio, id_json->valuestring, sizeof(edificio->id_edificio) - 1);
-
-        cJSON *peticiones_json = cJSON_GetObjectItemCaseSensitive(edificio_json, "peticiones");
-        if (!cJSON_IsArray(peticiones_json)) {
-            printf("[SIMULATION] Error: Peticiones inválidas para %s\n", edificio->id_edificio);
-            liberar_datos_simulacion(datos);
-            cJSON_Delete(json);
-            return false;
+        int capacidad = 0;
+        edificio_simulacion_t *edificio = anadir_edificio(datos, &capacidad);
+        if (!edificio) {
+            return abortar_carga(stream, datos);
         }
-
-        int num_peticiones = cJSON_GetArraySize(peticiones_json);
-        if (num_peticiones <= 0) {
-            printf("[SIMULATION] Advertencia: %s sin peticiones\n", edificio->id_edificio);
-            edificio_idx++;
-            continue;
+        memcpy(edificio->id_edificio, id, sizeof(id));
+        if (!leer_peticiones_edificio(stream, edificio)) {
+            return abortar_carga(stream, datos);
         }
-
-        edificio->peticiones = malloc(num_peticiones * sizeof(peticion_simulacion_t));
-        if (!edificio->peticiones) {
-            printf("[SIMULATION] Error: No memoria para peticiones de %s\n", edificio->id_edificio);
-            liberar_datos_simulacion(datos);
-            cJSON_Delete(json);
-            return false;
+        return finalizar_carga(stream, datos);
+    }
+    if (r == 0) {
+        if (id_edificio) {
+            printf("[SIMULATION] Error: No existe el edificio %s\n", id_edificio);
+        } else {
+            printf("[SIMULATION] Error: No existe el edificio de índice %d\n", indice);
         }
+    }
+    return abortar_carga(stream, datos);
+}
 
-        edificio->num_peticiones = num_peticiones;
-
-        cJSON *peticion_json = NULL;
-        int peticion_idx = 0;
-        cJSON_ArrayForEach(peticion_json, peticiones_json) {
-            peticion_simulacion_t *peticion = &edificio->peticiones[peticion_idx];
-            memset(peticion, 0, sizeof(peticion_simulacion_t));
-
-            cJSON *tipo_json = cJSON_GetObjectItemCaseSensitive(peticion_json, "tipo");
-            if (!cJSON_IsString(tipo_json)) {
-                printf("[SIMULATION] Error: Tipo inválido en %s[%d]\n", edificio->id_edificio, peticion_idx);
-                liberar_datos_simulacion(datos);
-                cJSON_Delete(json);
-                return false;
-            }
-
-            if (strcmp(tipo_json->valuestring, "llamada_piso") == 0) {
-                peticion->tipo = PETICION_LLAMADA_PISO;
-
-                cJSON *piso_json = cJSON_GetObjectItemCaseSensitive(peticion_json, "piso_origen");
-                if (!cJSON_IsNumber(piso_json)) {
-                    printf("[SIMULATION] Error: piso_origen inválido en %s[%d]\n", edificio->id_edificio, peticion_idx);
-                    liberar_datos_simulacion(datos);
-                    cJSON_Delete(json);
-                    return false;
-                }
-                peticion->piso_origen = piso_json->valueint;
-
-                cJSON *direccion_json = cJSON_GetObjectItemCaseSensitive(peticion_json, "direccion");
-                if (!cJSON_IsString(direccion_json)) {
-                    printf("[SIMULATION] Error: dirección inválida en %s[%d]\n", edificio->id_edificio, peticion_idx);
-                    liberar_datos_simulacion(datos);
-                    cJSON_Delete(json);
-                    return false;
-                }
-                strncpy(peticion->direccion, direccion_json->valuestring, sizeof(peticion->direccion) - 1);
-
-            } else if (strcmp(tipo_json->valuestring, "solicitud_cabina") == 0) {
-                peticion->tipo = PETICION_SOLICITUD_CABINA;
-
-                cJSON *indice_json = cJSON_GetObjectItemCaseSensitive(peticion_json, "indice_ascensor");
-                if (!cJSON_IsNumber(indice_json)) {
-                    printf("[SIMULATION] Error: indice_ascensor inválido en %s[%d]\n", edificio->id_edificio, peticion_idx);
-                    liberar_datos_simulacion(datos);
-                    cJSON_Delete(json);
-                    return false;
-                }
-                peticion->indice_ascensor = indice_json->valueint;
-
-                cJSON *destino_json = cJSON_GetObjectItemCaseSensitive(peticion_json, "piso_destino");
-                if (!cJSON_IsNumber(destino_json)) {
-                    printf("[SIMULATION] Error: piso_destino inválido en %s[%d]\n", edificio->id_edificio, peticion_idx);
-                    liberar_datos_simulacion(datos);
-                    cJSON_Delete(json);
-                    return false;
-                }
-                peticion->piso_destino = destino_json->valueint;
-
-            } else {
-                printf("[SIMULATION] Error: Tipo '%s' desconocido en %s[%d]\n", 
-                       tipo_json->valuestring, edificio->id_edificio, peticion_idx);
-                liberar_datos_simulacion(datos);
-                cJSON_Delete(json);
-                return false;
-            }
-
-            peticion_idx++;
+/**
+ * @brief Carga un edificio elegido al azar sin materializar los demás
+ * @see simulation_loader.h
+ */
+bool cargar_edificio_aleatorio(const char *archivo_json, datos_simulacion_t *datos) {
+    if (datos && gw_scenario_bin_is_binary(archivo_json)) {
+        return cargar_binario(archivo_json, SELECCION_ALEATORIA, 0, NULL, datos);
+    }
+    gw_scenario_stream_t *stream = abrir_escenario(archivo_json, datos);
+    if (!stream) {
+        return false;
+    }
+    gw_prng_t *rng = gw_prng_global();
+
+    // Muestreo de reservorio: una pasada, memoria constante, elección uniforme
+    int num_edificios = 0;
+    int indice_elegido = -1;
+    int64_t offset_elegido = -1;
+    int r;
+    while ((r = gw_scenario_next_building(stream, NULL, 0)) == 1) {
+        num_edificios++;
+        if (gw_prng_below(rng, (uint32_t)num_edificios) == 0) {
+            indice_elegido = num_edificios - 1;
+            offset_elegido = gw_scenario_building_offset(stream);
         }
-
-        edificio_idx++;
+    }
+    if (r < 0) {
+        return abortar_carga(stream, datos);
+    }
+    if (num_edificios == 0) {
+        printf("[SIMULATION] Error: No hay edificios\n");
+        return abortar_carga(stream, datos);
     }
 
-    cJSON_Delete(json);
-    datos->datos_cargados = true;
-
-    printf("[SIMULATION] Cargados %d edificios con %d peticiones totales\n", 
-           datos->num_edificios, datos->num_edificios * 10);
+    char id[sizeof(datos->edificios->id_edificio)];
+    int capacidad = 0;
+    edificio_simulacion_t *edificio = NULL;
+    if (gw_scenario_seek_building(stream, offset_elegido) != 0 ||
+        gw_scenario_next_building(stream, id, sizeof(id)) != 1 ||
+        !(edificio = anadir_edificio(datos, &capacidad))) {
+        return abortar_carga(stream, datos);
+    }
+    memcpy(edificio->id_edificio, id, sizeof(id));
+    if (!leer_peticiones_edificio(stream, edificio)) {
+        return abortar_carga(stream, datos);
+    }
 
-    return true;
+    printf("[SIMULATION] Edificio seleccionado: %s (índice %d de %d)\n",
+           edificio->id_edificio, indice_elegido, num_edificios);
+    return finalizar_carga(stream, datos);
 }
 
 /**
@@ -292,8 +449,8 @@ void liberar_datos_simulacion(datos_simulacion_t *datos) {
  * @return Puntero al edificio seleccionado, o NULL si no hay edificios
  * 
  * Esta función selecciona aleatoriamente un edificio de los disponibles
- * en los datos de simulación cargados. Utiliza la función rand() para
- * la selección aleatoria.
+ * en los datos de simulación cargados. Utiliza el generador global de
+ * prng.h para la selección aleatoria.
  * 
  * **Comportamiento:**
  * - Verifica que existan edificios disponibles
@@ -301,8 +458,8 @@ void liberar_datos_simulacion(datos_simulacion_t *datos) {
  * - Retorna el puntero al edificio seleccionado
  * - Registra la selección en el sistema de logging
  * 
- * @note Se debe llamar a srand() antes de usar esta función para
- *       garantizar aleatoriedad real.
+ * @note Con GW_SIM_SEED fijo (gw_prng_global_seed()) la elección se
+ *       repite entre ejecuciones.
  * 
  * @see datos_simulacion_t
  * @see edificio_simulacion_t
@@ -313,13 +470,7 @@ edificio_simulacion_t* seleccionar_edificio_aleatorio(datos_simulacion_t *datos)
         return NULL;
     }
 
-    static bool srand_inicializado = false;
-    if (!srand_inicializado) {
-        srand(time(NULL));
-        srand_inicializado = true;
-    }
-
-    int indice_aleatorio = rand() % datos->num_edificios;
+    int indice_aleatorio = (int)gw_prng_below(gw_prng_global(), (uint32_t)datos->num_edificios);
     edificio_simulacion_t *edificio_seleccionado = &datos->edificios[indice_aleatorio];
 
     printf("[SIMULATION] Edificio seleccionado: %s (índice %d de %d)\n", 
@@ -341,7 +492,8 @@ edificio_simulacion_t* seleccionar_edificio_aleatorio(datos_simulacion_t *datos)
  * - "down" → 1 (MOVING_DOWN)
  * - Otros valores → 0 (por defecto)
  * 
- * La función es insensible a mayúsculas y minúsculas.
+ * Se aplica una sola vez al cargar el escenario: peticion_simulacion_t y
+ * el formato binario guardan ya el valor numérico.
  * 
  * @see movement_direction_enum_t
  * @see simulated_can_frame_t
@@ -386,4 +538,67 @@ int convertir_direccion_string(const char *direccion_str) {
 int ejecutar_peticiones_edificio(edificio_simulacion_t *edificio, coap_context_t *ctx) {
     // Esta función no se usará directamente, la lógica estará en mi_simulador_ascensor.c
     return 0;
-} 
\ No newline at end of file
+} 
+
+/**
+ * @brief Programa en la cola la próxima petición del plan
+ */
+static bool programar_siguiente_peticion(gw_sim_queue_t *cola, plan_peticiones_t *plan);
+
+/**
+ * @brief Ejecuta la petición vencida de un plan y programa la siguiente
+ * @param cola Cola de eventos
+ * @param evento Evento con el plan en arg y el índice global en value
+ */
+static void ejecutar_peticion_del_plan(gw_sim_queue_t *cola, const gw_sim_event_t *evento) {
+    plan_peticiones_t *plan = evento->arg;
+    int num_peticiones = plan->edificio->num_peticiones;
+    gw_sim_event_t peticion_evento = *evento;
+    peticion_evento.arg = &plan->edificio->peticiones[evento->value % num_peticiones];
+    peticion_evento.value = evento->value % num_peticiones;
+
+    // Programar antes de ejecutar: la acción puede consultar el tamaño de la cola
+    plan->siguiente = evento->value + 1;
+    programar_siguiente_peticion(cola, plan);
+    plan->accion(cola, &peticion_evento);
+}
+
+static bool programar_siguiente_peticion(gw_sim_queue_t *cola, plan_peticiones_t *plan) {
+    if (plan->siguiente >= plan->edificio->num_peticiones * plan->rondas) {
+        return false;
+    }
+    int indice = plan->siguiente % plan->edificio->num_peticiones;
+    const peticion_simulacion_t *peticion = &plan->edificio->peticiones[indice];
+    uint64_t instante_ms;
+    if (plan->siguiente == 0) {
+        plan->inicio_ronda_ms = plan->inicio_ms;
+        instante_ms = plan->inicio_ronda_ms;
+    } else if (indice == 0) {
+        plan->inicio_ronda_ms = plan->ultima_ms + plan->intervalo_ms;
+        instante_ms = plan->inicio_ronda_ms;
+    } else {
+        instante_ms = plan->ultima_ms + plan->intervalo_ms;
+    }
+    if (peticion->tiene_instante) {
+        // Los instantes son relativos a la ronda; nunca antes que la petición anterior
+        instante_ms = plan->inicio_ronda_ms + peticion->instante_ms;
+        if (plan->siguiente > 0 && instante_ms < plan->ultima_ms) {
+            instante_ms = plan->ultima_ms;
+        }
+    }
+    plan->ultima_ms = instante_ms;
+    return gw_sim_queue_schedule(cola, instante_ms, ejecutar_peticion_del_plan, plan,
+                                 plan->building_index, plan->siguiente);
+}
+
+/**
+ * @brief Programa las peticiones de un plan en una cola de eventos
+ * @see simulation_loader.h
+ */
+bool programar_peticiones_edificio(gw_sim_queue_t *cola, plan_peticiones_t *plan) {
+    if (!cola || !plan || !plan->edificio || !plan->accion || plan->rondas < 1) {
+        return false;
+    }
+    plan->siguiente = 0;
+    return programar_siguiente_peticion(cola, plan);
+}
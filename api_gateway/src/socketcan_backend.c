@@ -0,0 +1,229 @@
+/**
+ * @file socketcan_backend.c
+ * @brief Implementación del backend SocketCAN del puente CAN
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Traduce entre @c struct can_frame del kernel y simulated_can_frame_t del
+ * puente CAN. La recepción y el envío se agrupan en lotes de
+ * AG_SOCKETCAN_BATCH_SIZE frames por llamada al sistema.
+ *
+ * @see socketcan_backend.h
+ */
+
+#define _GNU_SOURCE // recvmmsg/sendmmsg
+
+#include "api_gateway/socketcan_backend.h"
+#include "api_gateway/can_bridge.h"
+#include "api_gateway/logging_gw.h"
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+
+/**
+ * @brief Descriptor del socket CAN_RAW (-1 si no está abierto)
+ */
+static int can_socket_fd = -1;
+
+/**
+ * @brief Contexto CoAP al que se reenvían los frames recibidos
+ */
+static coap_context_t *can_coap_context = NULL;
+
+/**
+ * @brief Frames de respuesta pendientes de envío
+ */
+static struct can_frame tx_frames[AG_SOCKETCAN_BATCH_SIZE];
+
+/**
+ * @brief Número de frames en tx_frames
+ */
+static size_t tx_pending = 0;
+
+/**
+ * @brief Filtros del kernel: solo los IDs base que procesa el puente
+ *
+ * Los filtros estándar aceptan el edificio 0; los extendidos aceptan
+ * cualquier índice de edificio en los bits superiores.
+ */
+static const struct can_filter socketcan_rx_filters[] = {
+    { 0x100, CAN_SFF_MASK | CAN_EFF_FLAG | CAN_RTR_FLAG },                // Llamada de piso
+    { 0x200, CAN_SFF_MASK | CAN_EFF_FLAG | CAN_RTR_FLAG },                // Solicitud de cabina
+    { 0x300, CAN_SFF_MASK | CAN_EFF_FLAG | CAN_RTR_FLAG },                // Notificación de llegada
+    { CAN_EFF_FLAG | 0x100, CAN_SFF_MASK | CAN_EFF_FLAG | CAN_RTR_FLAG }, // Llamada de piso (edificio > 0)
+    { CAN_EFF_FLAG | 0x200, CAN_SFF_MASK | CAN_EFF_FLAG | CAN_RTR_FLAG }, // Solicitud de cabina (edificio > 0)
+    { CAN_EFF_FLAG | 0x300, CAN_SFF_MASK | CAN_EFF_FLAG | CAN_RTR_FLAG }, // Notificación de llegada (edificio > 0)
+};
+
+/**
+ * @brief Callback de envío del puente CAN: encola el frame para sendmmsg()
+ * @param frame Frame de respuesta generado por el puente
+ */
+static void socketcan_enqueue_frame(simulated_can_frame_t *frame) {
+    if (can_socket_fd < 0 || !frame) {
+        return;
+    }
+    if (tx_pending == AG_SOCKETCAN_BATCH_SIZE) {
+        ag_socketcan_flush(NULL);
+        if (tx_pending == AG_SOCKETCAN_BATCH_SIZE) {
+            LOG_WARN_GW("[SocketCAN] Cola de envío llena. Descartando frame ID 0x%X.", frame->id);
+            return;
+        }
+    }
+
+    struct can_frame *out = &tx_frames[tx_pending++];
+    memset(out, 0, sizeof(*out));
+    out->can_id = frame->id & CAN_SFF_MASK;
+    if (frame->building_index > 0) {
+        out->can_id |= CAN_EFF_FLAG | ((canid_t)frame->building_index << AG_SOCKETCAN_BUILDING_SHIFT);
+    }
+    out->can_dlc = frame->dlc > CAN_MAX_DLEN ? CAN_MAX_DLEN : frame->dlc;
+    memcpy(out->data, frame->data, out->can_dlc);
+}
+
+int ag_socketcan_open(const char *ifname, coap_context_t *coap_context) {
+    if (!ifname || !*ifname || !coap_context) {
+        return -1;
+    }
+
+    unsigned int ifindex = if_nametoindex(ifname);
+    if (ifindex == 0) {
+        LOG_ERROR_GW("[SocketCAN] Interfaz CAN '%s' no encontrada: %s", ifname, strerror(errno));
+        return -1;
+    }
+
+    int fd = socket(PF_CAN, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, CAN_RAW);
+    if (fd < 0) {
+        LOG_ERROR_GW("[SocketCAN] No se pudo crear el socket CAN_RAW: %s", strerror(errno));
+        return -1;
+    }
+
+    if (setsockopt(fd, SOL_CAN_RAW, CAN_RAW_FILTER, socketcan_rx_filters, sizeof(socketcan_rx_filters)) < 0) {
+        LOG_ERROR_GW("[SocketCAN] No se pudieron instalar los filtros CAN: %s", strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    int rcvbuf = AG_SOCKETCAN_RCVBUF_BYTES;
+    if (setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf)) < 0) {
+        LOG_WARN_GW("[SocketCAN] No se pudo ampliar SO_RCVBUF: %s", strerror(errno));
+    }
+
+    struct sockaddr_can addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = (int)ifindex;
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        LOG_ERROR_GW("[SocketCAN] No se pudo enlazar el socket a '%s': %s", ifname, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    can_socket_fd = fd;
+    can_coap_context = coap_context;
+    tx_pending = 0;
+    ag_can_bridge_register_send_callback(socketcan_enqueue_frame);
+
+    LOG_INFO_GW("[SocketCAN] Backend activo en '%s' (filtros 0x100/0x200/0x300, lotes de %d frames).",
+                ifname, AG_SOCKETCAN_BATCH_SIZE);
+    return fd;
+}
+
+void ag_socketcan_on_readable(int fd, void *arg) {
+    (void)arg;
+    struct can_frame rx_frames[AG_SOCKETCAN_BATCH_SIZE];
+    struct iovec iovs[AG_SOCKETCAN_BATCH_SIZE];
+    struct mmsghdr msgs[AG_SOCKETCAN_BATCH_SIZE];
+
+    memset(msgs, 0, sizeof(msgs));
+    for (int i = 0; i < AG_SOCKETCAN_BATCH_SIZE; ++i) {
+        iovs[i].iov_base = &rx_frames[i];
+        iovs[i].iov_len = sizeof(rx_frames[i]);
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    for (;;) {
+        int received = recvmmsg(fd, msgs, AG_SOCKETCAN_BATCH_SIZE, MSG_DONTWAIT, NULL);
+        if (received < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                LOG_ERROR_GW("[SocketCAN] recvmmsg falló: %s", strerror(errno));
+            }
+            return;
+        }
+
+        for (int i = 0; i < received; ++i) {
+            const struct can_frame *in = &rx_frames[i];
+            if (msgs[i].msg_len != sizeof(*in) || (in->can_id & (CAN_RTR_FLAG | CAN_ERR_FLAG))) {
+                continue; // CAN FD, remoto o de error: no se procesan
+            }
+            simulated_can_frame_t frame;
+            memset(&frame, 0, sizeof(frame));
+            frame.id = in->can_id & CAN_SFF_MASK;
+            if (in->can_id & CAN_EFF_FLAG) {
+                frame.building_index = (uint16_t)((in->can_id & CAN_EFF_MASK) >> AG_SOCKETCAN_BUILDING_SHIFT);
+            }
+            frame.dlc = in->can_dlc > CAN_MAX_DLEN ? CAN_MAX_DLEN : in->can_dlc;
+            memcpy(frame.data, in->data, frame.dlc);
+            ag_can_bridge_process_incoming_frame(&frame, can_coap_context);
+        }
+
+        if (received < AG_SOCKETCAN_BATCH_SIZE) {
+            return; // Socket vacío
+        }
+    }
+}
+
+void ag_socketcan_flush(void *arg) {
+    (void)arg;
+    if (can_socket_fd < 0 || tx_pending == 0) {
+        return;
+    }
+
+    struct iovec iovs[AG_SOCKETCAN_BATCH_SIZE];
+    struct mmsghdr msgs[AG_SOCKETCAN_BATCH_SIZE];
+    memset(msgs, 0, sizeof(msgs));
+    for (size_t i = 0; i < tx_pending; ++i) {
+        iovs[i].iov_base = &tx_frames[i];
+        iovs[i].iov_len = sizeof(tx_frames[i]);
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    int sent = sendmmsg(can_socket_fd, msgs, (unsigned int)tx_pending, MSG_DONTWAIT);
+    if (sent < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != ENOBUFS && errno != EINTR) {
+            LOG_ERROR_GW("[SocketCAN] sendmmsg falló: %s. Descartando %zu frames.", strerror(errno), tx_pending);
+            tx_pending = 0;
+        }
+        return; // Cola del driver llena: se reintenta en la próxima vuelta
+    }
+
+    // Conservar los frames no enviados para la próxima vuelta
+    size_t remaining = tx_pending - (size_t)sent;
+    if (remaining > 0) {
+        memmove(tx_frames, &tx_frames[sent], remaining * sizeof(tx_frames[0]));
+    }
+    tx_pending = remaining;
+}
+
+void ag_socketcan_close(void) {
+    if (can_socket_fd < 0) {
+        return;
+    }
+    ag_socketcan_flush(NULL);
+    if (tx_pending > 0) {
+        LOG_WARN_GW("[SocketCAN] %zu frames de respuesta sin enviar al cerrar.", tx_pending);
+    }
+    close(can_socket_fd);
+    can_socket_fd = -1;
+    can_coap_context = NULL;
+    tx_pending = 0;
+    ag_can_bridge_register_send_callback(NULL);
+}
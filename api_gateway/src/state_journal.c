@@ -0,0 +1,254 @@
+/**
+ * @file state_journal.c
+ * @brief Implementación del diario binario de transiciones de estado
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * @see state_journal.h
+ */
+
+#include "api_gateway/state_journal.h"
+#include "api_gateway/logging_gw.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static int journal_fd = -1;                                          ///< Descriptor del diario (-1 si está cerrado)
+static gw_journal_record_t journal_buffer[GW_JOURNAL_BUFFER_RECORDS]; ///< Registros pendientes de escribir
+static size_t journal_buffered = 0;                                  ///< Registros en @c journal_buffer
+static uint64_t journal_dropped = 0;                                 ///< Registros perdidos por errores de escritura
+static off_t journal_size = 0;                                       ///< Bytes válidos del fichero (cabecera y registros completos)
+
+/**
+ * @brief Lee un reloj en nanosegundos
+ */
+static uint64_t clock_ns(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Escribe un bloque completo, reintentando escrituras parciales
+ */
+static bool write_all(int fd, const void *data, size_t len) {
+    const uint8_t *p = data;
+    while (len > 0) {
+        ssize_t written = write(fd, p, len);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += written;
+        len -= (size_t)written;
+    }
+    return true;
+}
+
+/**
+ * @brief Comprueba la cabecera de un diario
+ */
+static bool journal_header_valid(const gw_journal_file_header_t *header) {
+    return header->magic == GW_JOURNAL_MAGIC && header->version == GW_JOURNAL_VERSION &&
+           header->record_size == sizeof(gw_journal_record_t);
+}
+
+int gw_journal_open(const char *path) {
+    if (!path || !*path) {
+        return -1;
+    }
+    gw_journal_close();
+
+    int fd = open(path, O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        LOG_ERROR_GW("[Journal] No se pudo abrir el diario '%s': %s", path, strerror(errno));
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        LOG_ERROR_GW("[Journal] fstat del diario '%s' falló: %s", path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    off_t valid_size = (off_t)sizeof(gw_journal_file_header_t);
+    if (st.st_size == 0) {
+        gw_journal_file_header_t header = {
+            .magic = GW_JOURNAL_MAGIC,
+            .version = GW_JOURNAL_VERSION,
+            .record_size = sizeof(gw_journal_record_t),
+            .created_realtime_ns = clock_ns(CLOCK_REALTIME),
+            .created_monotonic_ns = clock_ns(CLOCK_MONOTONIC),
+        };
+        if (!write_all(fd, &header, sizeof(header))) {
+            LOG_ERROR_GW("[Journal] No se pudo escribir la cabecera del diario '%s': %s", path, strerror(errno));
+            close(fd);
+            return -1;
+        }
+    } else {
+        gw_journal_file_header_t header;
+        if ((size_t)st.st_size < sizeof(header) || pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header) ||
+            !journal_header_valid(&header)) {
+            LOG_ERROR_GW("[Journal] '%s' no es un diario de la versión %d. No se anexa.", path, GW_JOURNAL_VERSION);
+            close(fd);
+            return -1;
+        }
+        // Recortar un registro incompleto de una ejecución interrumpida
+        size_t records = ((size_t)st.st_size - sizeof(header)) / sizeof(gw_journal_record_t);
+        valid_size = (off_t)(sizeof(header) + records * sizeof(gw_journal_record_t));
+        if (valid_size != st.st_size && ftruncate(fd, valid_size) != 0) {
+            LOG_ERROR_GW("[Journal] No se pudo recortar el diario '%s': %s", path, strerror(errno));
+            close(fd);
+            return -1;
+        }
+        LOG_INFO_GW("[Journal] Anexando al diario '%s' (%zu registros previos).", path, records);
+    }
+
+    journal_fd = fd;
+    journal_size = valid_size;
+    journal_buffered = 0;
+    journal_dropped = 0;
+    if (st.st_size != 0) {
+        // CLOCK_MONOTONIC pudo reiniciarse desde la última sesión: anotar la nueva base
+        uint64_t realtime_ns = clock_ns(CLOCK_REALTIME);
+        gw_journal_record(GW_JOURNAL_SESSION_STARTED, 0, GW_JOURNAL_NO_ELEVATOR, 0, 0,
+                          (uint32_t)realtime_ns, (uint32_t)(realtime_ns >> 32));
+    }
+    return 0;
+}
+
+bool gw_journal_is_open(void) {
+    return journal_fd >= 0;
+}
+
+void gw_journal_record(gw_journal_event_t type, uint16_t building, uint8_t elevator,
+                       int16_t floor, int16_t target_floor, uint32_t ref, uint32_t aux) {
+    if (journal_fd < 0) {
+        return;
+    }
+    if (journal_buffered == GW_JOURNAL_BUFFER_RECORDS && !gw_journal_flush()) {
+        journal_dropped++;
+        return;
+    }
+    gw_journal_record_t *record = &journal_buffer[journal_buffered++];
+    record->timestamp_ns = clock_ns(CLOCK_MONOTONIC);
+    record->type = (uint8_t)type;
+    record->elevator = elevator;
+    record->building = building;
+    record->floor = floor;
+    record->target_floor = target_floor;
+    record->ref = ref;
+    record->aux = aux;
+}
+
+bool gw_journal_flush(void) {
+    if (journal_fd < 0 || journal_buffered == 0) {
+        return true;
+    }
+    size_t len = journal_buffered * sizeof(gw_journal_record_t);
+    if (!write_all(journal_fd, journal_buffer, len)) {
+        LOG_ERROR_GW("[Journal] Error escribiendo %zu registros: %s", journal_buffered, strerror(errno));
+        // Quitar lo escrito a medias: el reintento del buffer no debe duplicar ni partir registros
+        if (ftruncate(journal_fd, journal_size) != 0) {
+            LOG_ERROR_GW("[Journal] No se pudo recortar el diario tras el error (%s). Se cierra; %zu registros perdidos.",
+                         strerror(errno), journal_buffered);
+            journal_dropped += journal_buffered;
+            close(journal_fd);
+            journal_fd = -1;
+            journal_buffered = 0;
+        }
+        return false;
+    }
+    journal_size += (off_t)len;
+    journal_buffered = 0;
+    return true;
+}
+
+void gw_journal_close(void) {
+    if (journal_fd < 0) {
+        return;
+    }
+    if (!gw_journal_flush()) {
+        journal_dropped += journal_buffered;
+    }
+    if (journal_dropped > 0) {
+        LOG_WARN_GW("[Journal] %llu registros no se pudieron escribir.", (unsigned long long)journal_dropped);
+    }
+    close(journal_fd);
+    journal_fd = -1;
+    journal_buffered = 0;
+}
+
+uint32_t gw_journal_hash_id(const char *id) {
+    if (!id || !*id) {
+        return 0;
+    }
+    uint32_t hash = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *)id; *p; ++p) {
+        hash ^= *p;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+long gw_journal_replay(const char *path, gw_journal_file_header_t *header_out,
+                       gw_journal_visit_cb_t visit, void *arg) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(gw_journal_file_header_t)) {
+        close(fd);
+        return -1;
+    }
+
+    size_t size = (size_t)st.st_size;
+    void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return -1;
+    }
+    madvise(map, size, MADV_SEQUENTIAL);
+
+    gw_journal_file_header_t header;
+    memcpy(&header, map, sizeof(header));
+    if (!journal_header_valid(&header)) {
+        munmap(map, size);
+        return -1;
+    }
+    if (header_out) {
+        *header_out = header;
+    }
+
+    // La cabecera (24 bytes) mantiene los registros alineados a 8
+    const gw_journal_record_t *records = (const gw_journal_record_t *)((const uint8_t *)map + sizeof(header));
+    size_t count = (size - sizeof(header)) / sizeof(gw_journal_record_t);
+    size_t visited = visit ? 0 : count;
+    while (visited < count && visit(&records[visited], arg)) {
+        visited++;
+    }
+
+    munmap(map, size);
+    return (long)visited;
+}
+
+const char* gw_journal_event_to_string(uint8_t type) {
+    switch (type) {
+        case GW_JOURNAL_BUILDING_ADDED:    return "EDIFICIO";
+        case GW_JOURNAL_TASK_ASSIGNED:     return "ASIGNACION";
+        case GW_JOURNAL_ELEVATOR_MOVED:    return "MOVIMIENTO";
+        case GW_JOURNAL_ELEVATOR_ARRIVED:  return "LLEGADA";
+        case GW_JOURNAL_REQUEST_SENT:      return "SOLICITUD";
+        case GW_JOURNAL_RESPONSE_RECEIVED: return "RESPUESTA";
+        case GW_JOURNAL_SESSION_STARTED:   return "SESION";
+        default:                           return "DESCONOCIDO";
+    }
+}
@@ -0,0 +1,363 @@
+/**
+ * @file state_store.c
+ * @brief Implementación de la persistencia del estado del gateway con mmap()
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * El fichero se mapea con MAP_SHARED y cada volcado escribe directamente en
+ * el mapeo: el kernel lo lleva a disco en segundo plano y sobrevive a la
+ * caída del proceso. Los registros se copian con memcpy(), por lo que no
+ * dependen de la alineación de sus posiciones dentro del fichero.
+ *
+ * @see state_store.h
+ */
+
+#include "api_gateway/state_store.h"
+#include "api_gateway/building_registry.h"
+#include "api_gateway/request_tracker.h"
+#include "api_gateway/logging_gw.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * @brief Cabecera del fichero de estado
+ */
+typedef struct {
+    uint32_t magic;             ///< GW_STATE_FILE_MAGIC (0 mientras se escribe el contenido)
+    uint16_t version;           ///< GW_STATE_FILE_VERSION
+    uint16_t header_size;       ///< sizeof(gw_state_file_header_t)
+    uint32_t num_buildings;     ///< Registros de edificio en el contenido
+    uint32_t num_can_requests;  ///< Registros de solicitud CAN en el contenido
+    uint64_t payload_size;      ///< Bytes de contenido tras la cabecera
+    uint64_t sync_count;        ///< Volcados realizados sobre este fichero
+    uint32_t checksum;          ///< FNV-1a de los @c payload_size bytes de contenido
+    uint32_t reserved;          ///< Relleno (0)
+} gw_state_file_header_t;
+
+/**
+ * @brief Registro de un edificio; le siguen @c state_bytes bytes de estado
+ */
+typedef struct {
+    char edificio_id[ID_STRING_MAX_LEN];  ///< ID del edificio
+    uint32_t num_elevadores;              ///< Ascensores del grupo guardado
+    uint32_t state_bytes;                 ///< Bytes de columnas e IDs (elevator_group_state_t::state_bytes)
+} gw_state_building_record_t;
+
+/**
+ * @brief Registro de una solicitud de origen CAN en vuelo
+ */
+typedef struct {
+    char edificio_id[ID_STRING_MAX_LEN];  ///< Edificio de la solicitud (el índice puede cambiar tras reiniciar)
+    can_origin_tracker_t request;         ///< Datos de la solicitud original
+} gw_state_request_record_t;
+
+static int store_fd = -1;                 ///< Descriptor del fichero (-1 si está cerrado)
+static uint8_t *store_map = NULL;         ///< Mapeo del fichero
+static size_t store_map_size = 0;         ///< Tamaño del mapeo (y del fichero)
+static bool store_restorable = false;     ///< El fichero contenía un estado válido al abrirlo
+static bool store_synced = false;         ///< Se ha volcado al menos una vez
+static uint64_t store_fingerprint = 0;    ///< Huella del estado en el último volcado
+static uint64_t store_sync_count = 0;     ///< Volcados realizados
+
+/**
+ * @brief FNV-1a de 32 bits
+ */
+static uint32_t fnv1a32(const uint8_t *data, size_t len) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; ++i) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Mezcla un valor en una huella FNV-1a de 64 bits
+ */
+static uint64_t fingerprint_mix(uint64_t hash, uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        hash ^= (uint8_t)(value >> (i * 8));
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+/**
+ * @brief Huella del estado a persistir: versiones de los grupos y cambios de trackers
+ */
+static uint64_t state_fingerprint(void) {
+    uint64_t hash = 14695981039346656037ull;
+    uint16_t num_buildings = gw_building_count();
+    hash = fingerprint_mix(hash, num_buildings);
+    for (uint16_t i = 0; i < num_buildings; ++i) {
+        const elevator_group_state_t *group = gw_building_get(i);
+        hash = fingerprint_mix(hash, group ? group->state_version : 0);
+    }
+    return fingerprint_mix(hash, gw_tracker_change_count());
+}
+
+/**
+ * @brief Mapea el fichero con el tamaño indicado, ampliándolo si hace falta
+ * @param size Tamaño mínimo del fichero
+ * @return true si el mapeo es válido
+ */
+static bool store_map_file(size_t size) {
+    size = (size + GW_STATE_FILE_GROWTH - 1) / GW_STATE_FILE_GROWTH * GW_STATE_FILE_GROWTH;
+    if (store_map && size <= store_map_size) {
+        return true;
+    }
+    if (store_map) {
+        munmap(store_map, store_map_size);
+        store_map = NULL;
+        store_map_size = 0;
+    }
+
+    struct stat st;
+    if (fstat(store_fd, &st) != 0) {
+        LOG_ERROR_GW("[StateStore] fstat falló: %s", strerror(errno));
+        return false;
+    }
+    if ((size_t)st.st_size > size) {
+        size = (size_t)st.st_size;
+    } else if ((size_t)st.st_size < size && ftruncate(store_fd, (off_t)size) != 0) {
+        LOG_ERROR_GW("[StateStore] No se pudo ampliar el fichero de estado a %zu bytes: %s", size, strerror(errno));
+        return false;
+    }
+
+    void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, store_fd, 0);
+    if (map == MAP_FAILED) {
+        LOG_ERROR_GW("[StateStore] mmap del fichero de estado falló: %s", strerror(errno));
+        return false;
+    }
+    store_map = map;
+    store_map_size = size;
+    return true;
+}
+
+/**
+ * @brief Comprueba la cabecera y el checksum del contenido mapeado
+ */
+static bool store_header_valid(const gw_state_file_header_t *header) {
+    if (header->magic != GW_STATE_FILE_MAGIC || header->version != GW_STATE_FILE_VERSION ||
+        header->header_size != sizeof(gw_state_file_header_t)) {
+        return false;
+    }
+    if (header->payload_size > store_map_size - sizeof(gw_state_file_header_t)) {
+        return false;
+    }
+    return fnv1a32(store_map + sizeof(gw_state_file_header_t), (size_t)header->payload_size) == header->checksum;
+}
+
+int gw_state_store_open(const char *path) {
+    if (!path || !*path) {
+        return -1;
+    }
+    gw_state_store_close();
+
+    store_fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (store_fd < 0) {
+        LOG_ERROR_GW("[StateStore] No se pudo abrir el fichero de estado '%s': %s", path, strerror(errno));
+        return -1;
+    }
+    if (!store_map_file(sizeof(gw_state_file_header_t))) {
+        close(store_fd);
+        store_fd = -1;
+        return -1;
+    }
+
+    gw_state_file_header_t header;
+    memcpy(&header, store_map, sizeof(header));
+    store_restorable = store_header_valid(&header);
+    store_synced = false;
+    store_sync_count = store_restorable ? header.sync_count : 0;
+    if (store_restorable) {
+        LOG_INFO_GW("[StateStore] Estado recuperable en '%s': %u edificios, %u solicitudes CAN en vuelo.",
+                    path, header.num_buildings, header.num_can_requests);
+    } else if (header.magic != 0) {
+        LOG_WARN_GW("[StateStore] Fichero de estado '%s' inválido o incompleto. Arranque en frío.", path);
+    } else {
+        LOG_INFO_GW("[StateStore] Fichero de estado '%s' sin estado previo. Arranque en frío.", path);
+    }
+    return 0;
+}
+
+bool gw_state_store_has_snapshot(void) {
+    return store_map && store_restorable;
+}
+
+int gw_state_store_restore(gw_state_resubmit_cb_t resubmit, void *arg) {
+    if (!gw_state_store_has_snapshot()) {
+        return 0;
+    }
+    store_restorable = false; // El siguiente volcado sobrescribe el fichero
+
+    gw_state_file_header_t header;
+    memcpy(&header, store_map, sizeof(header));
+    const uint8_t *p = store_map + sizeof(header);
+    const uint8_t *end = p + header.payload_size;
+    int restored = 0;
+
+    for (uint32_t i = 0; i < header.num_buildings; ++i) {
+        gw_state_building_record_t record;
+        if ((size_t)(end - p) < sizeof(record)) break;
+        memcpy(&record, p, sizeof(record));
+        p += sizeof(record);
+        if ((size_t)(end - p) < record.state_bytes) break;
+        record.edificio_id[ID_STRING_MAX_LEN - 1] = '\0';
+
+        int index = gw_building_find(record.edificio_id);
+        elevator_group_state_t *group = index >= 0 ? gw_building_get((uint16_t)index) : NULL;
+        if (group && group->storage && (uint32_t)group->num_elevadores_en_grupo == record.num_elevadores &&
+            group->state_bytes == record.state_bytes) {
+            elevator_group_write_begin(group);
+            memcpy(group->storage, p, record.state_bytes);
+            elevator_group_mark_dirty(group);
+            elevator_group_write_end(group);
+            restored++;
+            LOG_INFO_GW("[StateStore] Edificio '%s': estado de %u ascensores recuperado.", record.edificio_id, record.num_elevadores);
+        } else {
+            LOG_WARN_GW("[StateStore] Edificio '%s' (%u ascensores) no registrado con la misma configuración. Se ignora.",
+                        record.edificio_id, record.num_elevadores);
+        }
+        p += record.state_bytes;
+    }
+
+    uint32_t resubmitted = 0;
+    for (uint32_t i = 0; i < header.num_can_requests; ++i) {
+        gw_state_request_record_t record;
+        if ((size_t)(end - p) < sizeof(record)) break;
+        memcpy(&record, p, sizeof(record));
+        p += sizeof(record);
+        record.edificio_id[ID_STRING_MAX_LEN - 1] = '\0';
+
+        int index = gw_building_find(record.edificio_id);
+        if (index < 0) {
+            continue;
+        }
+        record.request.building_index = (uint16_t)index;
+        if (resubmit) {
+            resubmit(&record.request, arg);
+        }
+        resubmitted++;
+    }
+
+    LOG_INFO_GW("[StateStore] Recuperados %d edificios y %u solicitudes CAN en vuelo.", restored, resubmitted);
+    return restored;
+}
+
+/**
+ * @brief Contexto del volcado de solicitudes CAN en vuelo
+ */
+typedef struct {
+    uint8_t *out;    ///< Siguiente posición de escritura
+    uint32_t count;  ///< Registros escritos
+} store_request_writer_t;
+
+/**
+ * @brief Escribe el registro de un tracker de origen CAN
+ */
+static void store_write_request(const gw_tracker_slot_t *slot, void *arg) {
+    store_request_writer_t *writer = arg;
+    if (slot->origin != GW_TRACKER_ORIGIN_CAN) {
+        return;
+    }
+    const elevator_group_state_t *group = gw_building_get(slot->data.can.building_index);
+    if (!group) {
+        return;
+    }
+    gw_state_request_record_t record;
+    memset(&record, 0, sizeof(record));
+    memcpy(record.edificio_id, group->edificio_id_str_grupo, ID_STRING_MAX_LEN);
+    record.request = slot->data.can;
+    memcpy(writer->out, &record, sizeof(record));
+    writer->out += sizeof(record);
+    writer->count++;
+}
+
+bool gw_state_store_sync(void) {
+    if (!store_map || store_restorable) {
+        return false; // Cerrado, o pendiente de recuperar: no sobrescribir
+    }
+    uint64_t fingerprint = state_fingerprint();
+    if (store_synced && fingerprint == store_fingerprint) {
+        return false;
+    }
+
+    // Tamaño máximo del contenido
+    uint16_t num_buildings = gw_building_count();
+    size_t needed = sizeof(gw_state_file_header_t) + gw_tracker_in_flight() * sizeof(gw_state_request_record_t);
+    for (uint16_t i = 0; i < num_buildings; ++i) {
+        const elevator_group_state_t *group = gw_building_get(i);
+        if (group && group->storage) {
+            needed += sizeof(gw_state_building_record_t) + group->state_bytes;
+        }
+    }
+    if (!store_map_file(needed)) {
+        return false;
+    }
+
+    gw_state_file_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(store_map, &header, sizeof(header)); // magic = 0 mientras se escribe el contenido
+
+    uint8_t *payload = store_map + sizeof(header);
+    uint8_t *p = payload;
+    for (uint16_t i = 0; i < num_buildings; ++i) {
+        const elevator_group_state_t *group = gw_building_get(i);
+        if (!group || !group->storage) {
+            continue;
+        }
+        gw_state_building_record_t record;
+        memset(&record, 0, sizeof(record));
+        memcpy(record.edificio_id, group->edificio_id_str_grupo, ID_STRING_MAX_LEN);
+        record.num_elevadores = (uint32_t)group->num_elevadores_en_grupo;
+        record.state_bytes = (uint32_t)group->state_bytes;
+        memcpy(p, &record, sizeof(record));
+        p += sizeof(record);
+        memcpy(p, group->storage, group->state_bytes);
+        p += group->state_bytes;
+        header.num_buildings++;
+    }
+
+    store_request_writer_t writer = { p, 0 };
+    gw_tracker_for_each(store_write_request, &writer);
+    p = writer.out;
+
+    header.magic = GW_STATE_FILE_MAGIC;
+    header.version = GW_STATE_FILE_VERSION;
+    header.header_size = sizeof(header);
+    header.num_can_requests = writer.count;
+    header.payload_size = (uint64_t)(p - payload);
+    header.sync_count = ++store_sync_count;
+    header.checksum = fnv1a32(payload, (size_t)header.payload_size);
+    memcpy(store_map, &header, sizeof(header));
+
+    store_synced = true;
+    store_fingerprint = fingerprint;
+    return true;
+}
+
+void gw_state_store_close(void) {
+    if (store_map) {
+        store_restorable = false; // Al cerrar manda el estado actual
+        gw_state_store_sync();
+        if (msync(store_map, store_map_size, MS_SYNC) != 0) {
+            LOG_WARN_GW("[StateStore] msync del fichero de estado falló: %s", strerror(errno));
+        }
+        munmap(store_map, store_map_size);
+    }
+    if (store_fd >= 0) {
+        close(store_fd);
+    }
+    store_fd = -1;
+    store_map = NULL;
+    store_map_size = 0;
+    store_restorable = false;
+    store_synced = false;
+}
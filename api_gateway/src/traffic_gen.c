@@ -0,0 +1,208 @@
+/**
+ * @file traffic_gen.c
+ * @brief Herramienta de generación de escenarios de tráfico sintético
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Genera un escenario con el tráfico de traffic_generator.h para varios
+ * edificios, en el formato binario de scenario_binary.h (salida .bin) o en
+ * JSON con "instante_ms" y "pasajeros" (cualquier otra extensión). La
+ * generación es en streaming, así que el tamaño del escenario solo está
+ * limitado por el disco.
+ *
+ * **Uso:**
+ * ```
+ * gw_traffic_gen --out <escenario.bin|.json> [opciones]
+ * ```
+ * - --buildings <n>: edificios E001..En, cada uno con su flujo aleatorio (1)
+ * - --seed <n>: semilla; la misma semilla y opciones dan el mismo fichero (1)
+ * - --duration-s <s>: duración del tráfico de cada edificio (3600)
+ * - --phases <spec>: fases "<inicio_s>:<patrón>:<llegadas_por_min>,..." con
+ *   los patrones up-peak, down-peak, inter-floor, mixed y od ("0:mixed:6")
+ * - --floors <n>, --lobby <piso>, --elevators <n>: edificio (14, 0, 4)
+ * - --group-mean <m>: pasajeros medios por llegada (1)
+ * - --boarding-ms <ms>: retardo entre llamada de piso y solicitud de cabina (3000)
+ * - --od <fichero.csv>: matriz origen/destino del patrón od
+ *
+ * @see traffic_generator.h
+ */
+
+#include "api_gateway/traffic_generator.h"
+#include "api_gateway/scenario_binary.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * @brief Separación registrada en el binario para peticiones sin instante
+ *        (todas las generadas lo tienen; es la del simulador del gateway)
+ */
+#define TRAFFIC_GEN_INTERVAL_MS 2000
+
+static void print_usage(const char *prog) {
+    fprintf(stderr, "Uso: %s --out <escenario.bin|.json> [--buildings <n>] [--seed <n>] [--duration-s <s>]\n"
+                    "       [--phases <inicio_s>:<patrón>:<llegadas_por_min>,...] [--floors <n>] [--lobby <piso>]\n"
+                    "       [--elevators <n>] [--group-mean <m>] [--boarding-ms <ms>] [--od <matriz.csv>]\n"
+                    "Patrones: up-peak, down-peak, inter-floor, mixed, od\n", prog);
+}
+
+/**
+ * @brief Indica si la ruta termina en ".bin"
+ */
+static bool is_binary_output(const char *path) {
+    size_t len = strlen(path);
+    return len >= 4 && strcmp(path + len - 4, ".bin") == 0;
+}
+
+/**
+ * @brief Escribe una petición en JSON
+ */
+static void write_json_request(FILE *out, const peticion_simulacion_t *p, bool first) {
+    if (p->tipo == PETICION_LLAMADA_PISO) {
+        fprintf(out, "%s\n        {\"instante_ms\": %u, \"tipo\": \"llamada_piso\", \"piso_origen\": %d, "
+                     "\"direccion\": \"%s\", \"pasajeros\": %u}",
+                first ? "" : ",", p->instante_ms, p->piso_origen,
+                p->direccion == MOVING_UP ? "up" : "down", p->pasajeros);
+    } else {
+        fprintf(out, "%s\n        {\"instante_ms\": %u, \"tipo\": \"solicitud_cabina\", \"indice_ascensor\": %d, "
+                     "\"piso_destino\": %d, \"pasajeros\": %u}",
+                first ? "" : ",", p->instante_ms, p->indice_ascensor, p->piso_destino, p->pasajeros);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    const char *output = NULL;
+    const char *od_path = NULL;
+    const char *phases = NULL;
+    int buildings = 1;
+    uint64_t seed = 1;
+    gw_traffic_profile_t profile;
+    gw_traffic_profile_defaults(&profile);
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc) {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        if (strcmp(argv[i], "--out") == 0) {
+            output = argv[++i];
+        } else if (strcmp(argv[i], "--buildings") == 0) {
+            buildings = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--duration-s") == 0) {
+            profile.duration_ms = (uint32_t)(strtod(argv[++i], NULL) * 1000.0);
+        } else if (strcmp(argv[i], "--phases") == 0) {
+            phases = argv[++i];
+        } else if (strcmp(argv[i], "--floors") == 0) {
+            profile.num_floors = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--lobby") == 0) {
+            profile.lobby_floor = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--elevators") == 0) {
+            profile.num_elevators = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--group-mean") == 0) {
+            profile.mean_group_size = strtod(argv[++i], NULL);
+        } else if (strcmp(argv[i], "--boarding-ms") == 0) {
+            profile.boarding_ms = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--od") == 0) {
+            od_path = argv[++i];
+        } else {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (!output || buildings < 1 || buildings > 999999) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (phases && !gw_traffic_parse_phases(&profile, phases)) {
+        return EXIT_FAILURE;
+    }
+    double *od_matrix = NULL;
+    if (od_path) {
+        od_matrix = gw_traffic_load_od(od_path, profile.num_floors);
+        if (!od_matrix) {
+            return EXIT_FAILURE;
+        }
+        profile.od_matrix = od_matrix;
+    }
+
+    bool binary = is_binary_output(output);
+    gw_scenario_bin_writer_t *writer = NULL;
+    FILE *json = NULL;
+    if (binary) {
+        writer = gw_scenario_bin_writer_open(output, TRAFFIC_GEN_INTERVAL_MS);
+    } else {
+        json = fopen(output, "w");
+        if (json) {
+            fprintf(json, "{\n  \"edificios\": [");
+        }
+    }
+    if (!writer && !json) {
+        fprintf(stderr, "Error: no se pudo crear '%s'.\n", output);
+        free(od_matrix);
+        return EXIT_FAILURE;
+    }
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    bool ok = true;
+    uint64_t requests = 0;
+    uint64_t passengers = 0;
+    for (int b = 0; ok && b < buildings; ++b) {
+        char id[16];
+        snprintf(id, sizeof(id), "E%03d", b + 1);
+        gw_traffic_generator_t *generator = gw_traffic_create(&profile, seed, (uint64_t)b);
+        if (!generator) {
+            ok = false;
+            break;
+        }
+        if (binary) {
+            ok = gw_scenario_bin_writer_building(writer, id);
+        } else {
+            fprintf(json, "%s\n    {\n      \"id_edificio\": \"%s\",\n      \"peticiones\": [",
+                    b == 0 ? "" : ",", id);
+        }
+        peticion_simulacion_t peticion;
+        bool first = true;
+        while (ok && gw_traffic_next(generator, &peticion)) {
+            if (binary) {
+                ok = gw_scenario_bin_writer_request(writer, &peticion);
+            } else {
+                write_json_request(json, &peticion, first);
+            }
+            first = false;
+            requests++;
+        }
+        if (!binary) {
+            fprintf(json, "\n      ]\n    }");
+        }
+        passengers += gw_traffic_passengers(generator);
+        gw_traffic_destroy(generator);
+    }
+
+    if (binary) {
+        ok = gw_scenario_bin_writer_close(writer, ok);
+    } else {
+        fprintf(json, "\n  ]\n}\n");
+        ok = ok && !ferror(json);
+        ok = (fclose(json) == 0) && ok;
+        if (!ok) {
+            remove(output);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    free(od_matrix);
+    if (!ok) {
+        fprintf(stderr, "Error: no se pudo generar '%s'.\n", output);
+        return EXIT_FAILURE;
+    }
+    printf("Generado %s: %d edificios, %llu peticiones, %llu pasajeros (semilla %llu) en %.3f s\n",
+           output, buildings, (unsigned long long)requests, (unsigned long long)passengers,
+           (unsigned long long)seed,
+           (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) / 1e9);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,532 @@
+/**
+ * @file traffic_generator.c
+ * @brief Implementación del generador de tráfico sintético
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Las llegadas son un proceso de Poisson por tramos: dentro de una fase los
+ * huecos son exponenciales y, al cruzar el inicio de la siguiente, el
+ * tiempo se lleva a ese inicio y se vuelve a sortear con la nueva tasa (la
+ * exponencial no tiene memoria, así que el proceso resultante es exacto).
+ *
+ * Cada patrón se convierte en una distribución acumulada sobre los pares
+ * (origen, destino), construida la primera vez que una fase lo usa; un
+ * sorteo es una búsqueda binaria. Las solicitudes de cabina pendientes
+ * esperan en una cola FIFO: como el embarque es constante salen en el
+ * mismo orden que sus llamadas y basta mezclarlas con la próxima llegada.
+ *
+ * @see traffic_generator.h
+ */
+
+#include "api_gateway/traffic_generator.h"
+#include "api_gateway/prng.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Número de patrones (tamaño de la caché de distribuciones)
+ */
+#define TRAFFIC_NUM_PATTERNS 5
+
+/**
+ * @brief Capacidad inicial de la cola de solicitudes de cabina
+ */
+#define TRAFFIC_PENDING_INITIAL 64
+
+/**
+ * @brief Fracciones del patrón mixto (subida, bajada, entre plantas)
+ */
+#define TRAFFIC_MIXED_UP 0.4
+#define TRAFFIC_MIXED_DOWN 0.4
+#define TRAFFIC_MIXED_INTER 0.2
+
+struct gw_traffic_generator_t {
+    gw_traffic_profile_t profile;         ///< Copia del perfil
+    double *od_matrix;                    ///< Copia de la matriz origen/destino (o NULL)
+    double *cdf[TRAFFIC_NUM_PATTERNS];    ///< Distribución acumulada de pares por patrón
+    gw_prng_t rng;                        ///< Generador del edificio
+    int phase;                            ///< Fase de la próxima llegada
+    double clock_ms;                      ///< Instante de la última llegada sorteada
+    bool has_arrival;                     ///< arrival contiene una llamada aún no entregada
+    bool arrivals_done;                   ///< No habrá más llegadas
+    peticion_simulacion_t arrival;        ///< Próxima llamada de piso
+    peticion_simulacion_t *pending;       ///< Solicitudes de cabina pendientes (cola circular)
+    size_t pending_head;                  ///< Primera pendiente
+    size_t pending_count;                 ///< Pendientes en la cola
+    size_t pending_capacity;              ///< Capacidad de la cola
+    uint64_t passengers;                  ///< Pasajeros generados
+};
+
+void gw_traffic_profile_defaults(gw_traffic_profile_t *profile) {
+    if (!profile) {
+        return;
+    }
+    memset(profile, 0, sizeof(*profile));
+    profile->num_floors = 14;
+    profile->lobby_floor = 0;
+    profile->num_elevators = 4;
+    profile->duration_ms = 3600u * 1000u;
+    profile->mean_group_size = 1.0;
+    profile->boarding_ms = 3000;
+    profile->car_calls = true;
+    profile->phases[0].start_ms = 0;
+    profile->phases[0].pattern = GW_TRAFFIC_MIXED;
+    profile->phases[0].arrivals_per_min = 6.0;
+    profile->num_phases = 1;
+}
+
+const char* gw_traffic_pattern_name(gw_traffic_pattern_t pattern) {
+    switch (pattern) {
+        case GW_TRAFFIC_UP_PEAK: return "up-peak";
+        case GW_TRAFFIC_DOWN_PEAK: return "down-peak";
+        case GW_TRAFFIC_INTER_FLOOR: return "inter-floor";
+        case GW_TRAFFIC_MIXED: return "mixed";
+        case GW_TRAFFIC_OD_MATRIX: return "od";
+    }
+    return "?";
+}
+
+/**
+ * @brief Convierte el nombre de un patrón
+ * @return true si @p name (de longitud @p len) es un patrón conocido
+ */
+static bool parse_pattern(const char *name, size_t len, gw_traffic_pattern_t *out) {
+    for (int p = 0; p < TRAFFIC_NUM_PATTERNS; ++p) {
+        const char *candidate = gw_traffic_pattern_name((gw_traffic_pattern_t)p);
+        if (strlen(candidate) == len && strncmp(candidate, name, len) == 0) {
+            *out = (gw_traffic_pattern_t)p;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool gw_traffic_parse_phases(gw_traffic_profile_t *profile, const char *spec) {
+    if (!profile || !spec) {
+        return false;
+    }
+    gw_traffic_phase_t phases[GW_TRAFFIC_MAX_PHASES];
+    int count = 0;
+    const char *p = spec;
+    while (*p) {
+        if (count == GW_TRAFFIC_MAX_PHASES) {
+            printf("[SIMULATION] Error: Más de %d fases de tráfico\n", GW_TRAFFIC_MAX_PHASES);
+            return false;
+        }
+        char *end;
+        double start_s = strtod(p, &end);
+        if (end == p || *end != ':' || !(start_s >= 0.0) || start_s * 1000.0 > (double)UINT32_MAX) {
+            break;
+        }
+        const char *name = end + 1;
+        const char *colon = strchr(name, ':');
+        if (!colon || !parse_pattern(name, (size_t)(colon - name), &phases[count].pattern)) {
+            break;
+        }
+        double rate = strtod(colon + 1, &end);
+        if (end == colon + 1 || !(rate >= 0.0) || (*end != ',' && *end != '\0')) {
+            break;
+        }
+        phases[count].start_ms = (uint32_t)llround(start_s * 1000.0);
+        phases[count].arrivals_per_min = rate;
+        if ((count == 0 && phases[0].start_ms != 0) ||
+            (count > 0 && phases[count].start_ms <= phases[count - 1].start_ms)) {
+            break;
+        }
+        count++;
+        p = *end == ',' ? end + 1 : end;
+        if (*end == '\0') {
+            memcpy(profile->phases, phases, (size_t)count * sizeof(phases[0]));
+            profile->num_phases = count;
+            return true;
+        }
+    }
+    printf("[SIMULATION] Error: Fases de tráfico inválidas: %s\n", spec);
+    return false;
+}
+
+double* gw_traffic_load_od(const char *path, int num_floors) {
+    if (!path || num_floors < 2 || num_floors > GW_TRAFFIC_MAX_FLOORS) {
+        return NULL;
+    }
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        printf("[SIMULATION] Error: No se pudo abrir la matriz origen/destino %s\n", path);
+        return NULL;
+    }
+    double *matrix = calloc((size_t)num_floors * (size_t)num_floors, sizeof(double));
+    if (!matrix) {
+        fclose(file);
+        return NULL;
+    }
+
+    char line[4096];
+    int row = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), file)) {
+        const char *p = line;
+        while (*p == ' ' || *p == '\t') {
+            p++;
+        }
+        if (*p == '#' || *p == '\n' || *p == '\r' || *p == '\0') {
+            continue;
+        }
+        if (row == num_floors) {
+            ok = false;
+            break;
+        }
+        for (int col = 0; col < num_floors; ++col) {
+            char *end;
+            double weight = strtod(p, &end);
+            if (end == p || !(weight >= 0.0) || !isfinite(weight)) {
+                ok = false;
+                break;
+            }
+            matrix[row * num_floors + col] = weight;
+            while (*end == ' ' || *end == '\t') {
+                end++;
+            }
+            if (col + 1 < num_floors && *end != ',') {
+                ok = false;
+                break;
+            }
+            p = end + (col + 1 < num_floors ? 1 : 0);
+        }
+        row++;
+    }
+    fclose(file);
+    if (!ok || row != num_floors) {
+        printf("[SIMULATION] Error: Matriz origen/destino inválida en %s (se esperan %d filas de %d pesos)\n",
+               path, num_floors, num_floors);
+        free(matrix);
+        return NULL;
+    }
+    return matrix;
+}
+
+/**
+ * @brief Suma a @p weights la distribución de un patrón básico con peso total @p share
+ * @return false si el patrón no tiene ningún par válido
+ */
+static bool add_basic_pattern(const gw_traffic_generator_t *g, gw_traffic_pattern_t pattern,
+                              double share, double *weights) {
+    int n = g->profile.num_floors;
+    int lobby = g->profile.lobby_floor;
+    int pairs = 0;
+    for (int pass = 0; pass < 2; ++pass) {
+        for (int o = 0; o < n; ++o) {
+            for (int d = 0; d < n; ++d) {
+                bool valid;
+                switch (pattern) {
+                    case GW_TRAFFIC_UP_PEAK: valid = o == lobby && d != lobby; break;
+                    case GW_TRAFFIC_DOWN_PEAK: valid = d == lobby && o != lobby; break;
+                    default: valid = o != d && o != lobby && d != lobby; break;
+                }
+                if (!valid) {
+                    continue;
+                }
+                if (pass == 0) {
+                    pairs++;
+                } else {
+                    weights[o * n + d] += share / pairs;
+                }
+            }
+        }
+        if (pairs == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Distribución acumulada de los pares (origen, destino) de un patrón
+ * @return Tabla de num_floors² valores, o NULL si el patrón no tiene pares válidos
+ */
+static const double* pattern_cdf(gw_traffic_generator_t *g, gw_traffic_pattern_t pattern) {
+    if (g->cdf[pattern]) {
+        return g->cdf[pattern];
+    }
+    int n = g->profile.num_floors;
+    double *weights = calloc((size_t)n * (size_t)n, sizeof(double));
+    if (!weights) {
+        return NULL;
+    }
+    bool ok;
+    switch (pattern) {
+        case GW_TRAFFIC_MIXED:
+            ok = add_basic_pattern(g, GW_TRAFFIC_UP_PEAK, TRAFFIC_MIXED_UP, weights) &&
+                 add_basic_pattern(g, GW_TRAFFIC_DOWN_PEAK, TRAFFIC_MIXED_DOWN, weights);
+            // Con dos pisos no hay tráfico entre plantas: se reparte entre subida y bajada
+            if (ok) {
+                add_basic_pattern(g, GW_TRAFFIC_INTER_FLOOR, TRAFFIC_MIXED_INTER, weights);
+            }
+            break;
+        case GW_TRAFFIC_OD_MATRIX:
+            ok = g->od_matrix != NULL;
+            for (int i = 0; ok && i < n * n; ++i) {
+                // Un viaje al mismo piso no genera peticiones
+                weights[i] = (i / n == i % n) ? 0.0 : g->od_matrix[i];
+            }
+            break;
+        default:
+            ok = add_basic_pattern(g, pattern, 1.0, weights);
+            break;
+    }
+
+    double total = 0.0;
+    for (int i = 0; ok && i < n * n; ++i) {
+        total += weights[i];
+        weights[i] = total;
+    }
+    if (!ok || !(total > 0.0)) {
+        free(weights);
+        return NULL;
+    }
+    for (int i = 0; i < n * n; ++i) {
+        weights[i] /= total;
+    }
+    g->cdf[pattern] = weights;
+    return weights;
+}
+
+/**
+ * @brief Sortea un par (origen, destino) de una distribución acumulada
+ */
+static void sample_pair(gw_traffic_generator_t *g, const double *cdf, int *origin, int *destination) {
+    int n = g->profile.num_floors;
+    double u = gw_prng_uniform(&g->rng);
+    // Primer par con acumulado > u: nunca uno de peso nulo
+    int lo = 0;
+    int hi = n * n - 1;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (cdf[mid] > u) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    *origin = lo / n;
+    *destination = lo % n;
+}
+
+/**
+ * @brief Encola una solicitud de cabina
+ */
+static bool push_pending(gw_traffic_generator_t *g, const peticion_simulacion_t *peticion) {
+    if (g->pending_count == g->pending_capacity) {
+        size_t capacity = g->pending_capacity ? g->pending_capacity * 2 : TRAFFIC_PENDING_INITIAL;
+        peticion_simulacion_t *pending = malloc(capacity * sizeof(peticion_simulacion_t));
+        if (!pending) {
+            printf("[SIMULATION] Error: No se pudo asignar memoria para %zu solicitudes de cabina\n", capacity);
+            return false;
+        }
+        for (size_t i = 0; i < g->pending_count; ++i) {
+            pending[i] = g->pending[(g->pending_head + i) % g->pending_capacity];
+        }
+        free(g->pending);
+        g->pending = pending;
+        g->pending_head = 0;
+        g->pending_capacity = capacity;
+    }
+    g->pending[(g->pending_head + g->pending_count) % g->pending_capacity] = *peticion;
+    g->pending_count++;
+    return true;
+}
+
+/**
+ * @brief Fin de la fase @p phase (inicio de la siguiente o fin del escenario)
+ */
+static double phase_end_ms(const gw_traffic_generator_t *g, int phase) {
+    if (phase + 1 < g->profile.num_phases) {
+        return (double)g->profile.phases[phase + 1].start_ms;
+    }
+    return (double)g->profile.duration_ms;
+}
+
+/**
+ * @brief Sortea la próxima llegada y deja su llamada de piso en g->arrival
+ *
+ * La solicitud de cabina del grupo se encola para t + boarding_ms.
+ */
+static void draw_arrival(gw_traffic_generator_t *g) {
+    while (g->phase < g->profile.num_phases) {
+        const gw_traffic_phase_t *phase = &g->profile.phases[g->phase];
+        double end_ms = phase_end_ms(g, g->phase);
+        if (end_ms > (double)g->profile.duration_ms) {
+            end_ms = (double)g->profile.duration_ms;
+        }
+        double rate_per_ms = phase->arrivals_per_min / 60000.0;
+        double t = rate_per_ms > 0.0 ? g->clock_ms + gw_prng_exponential(&g->rng, rate_per_ms) : end_ms;
+        if (t >= end_ms) {
+            g->clock_ms = end_ms;
+            g->phase++;
+            continue;
+        }
+        g->clock_ms = t;
+
+        const double *cdf = pattern_cdf(g, phase->pattern);
+        int origin;
+        int destination;
+        sample_pair(g, cdf, &origin, &destination);
+        uint32_t group = 1 + gw_prng_poisson(&g->rng, g->profile.mean_group_size - 1.0);
+        if (group > UINT16_MAX) {
+            group = UINT16_MAX;
+        }
+        uint32_t instante_ms = (uint32_t)t;
+
+        memset(&g->arrival, 0, sizeof(g->arrival));
+        g->arrival.tipo = PETICION_LLAMADA_PISO;
+        g->arrival.piso_origen = origin;
+        g->arrival.direccion = destination > origin ? MOVING_UP : MOVING_DOWN;
+        g->arrival.piso_destino = destination;
+        g->arrival.tiene_instante = true;
+        g->arrival.instante_ms = instante_ms;
+        g->arrival.pasajeros = (uint16_t)group;
+
+        peticion_simulacion_t cabina;
+        memset(&cabina, 0, sizeof(cabina));
+        cabina.tipo = PETICION_SOLICITUD_CABINA;
+        cabina.indice_ascensor = (int)gw_prng_below(&g->rng, (uint32_t)g->profile.num_elevators);
+        cabina.piso_destino = destination;
+        cabina.tiene_instante = true;
+        cabina.instante_ms = (uint64_t)instante_ms + g->profile.boarding_ms > UINT32_MAX
+                                 ? UINT32_MAX : instante_ms + g->profile.boarding_ms;
+        cabina.pasajeros = (uint16_t)group;
+        if (g->profile.car_calls && !push_pending(g, &cabina)) {
+            break;
+        }
+        g->passengers += group;
+        g->has_arrival = true;
+        return;
+    }
+    g->arrivals_done = true;
+}
+
+gw_traffic_generator_t* gw_traffic_create(const gw_traffic_profile_t *profile, uint64_t seed, uint64_t stream) {
+    if (!profile || profile->num_floors < 2 || profile->num_floors > GW_TRAFFIC_MAX_FLOORS ||
+        profile->lobby_floor < 0 || profile->lobby_floor >= profile->num_floors ||
+        profile->num_elevators < 1 || !(profile->mean_group_size >= 1.0) ||
+        profile->num_phases < 1 || profile->num_phases > GW_TRAFFIC_MAX_PHASES ||
+        profile->phases[0].start_ms != 0) {
+        printf("[SIMULATION] Error: Perfil de tráfico inválido\n");
+        return NULL;
+    }
+    for (int i = 1; i < profile->num_phases; ++i) {
+        if (profile->phases[i].start_ms <= profile->phases[i - 1].start_ms) {
+            printf("[SIMULATION] Error: Las fases de tráfico deben empezar en instantes crecientes\n");
+            return NULL;
+        }
+    }
+
+    gw_traffic_generator_t *g = calloc(1, sizeof(*g));
+    if (!g) {
+        printf("[SIMULATION] Error: No se pudo asignar memoria para el generador de tráfico\n");
+        return NULL;
+    }
+    g->profile = *profile;
+    g->profile.od_matrix = NULL;
+    size_t cells = (size_t)profile->num_floors * (size_t)profile->num_floors;
+    if (profile->od_matrix) {
+        g->od_matrix = malloc(cells * sizeof(double));
+        if (!g->od_matrix) {
+            gw_traffic_destroy(g);
+            return NULL;
+        }
+        memcpy(g->od_matrix, profile->od_matrix, cells * sizeof(double));
+    }
+
+    // Validar los patrones por adelantado: un sorteo nunca encuentra una tabla vacía
+    for (int i = 0; i < profile->num_phases; ++i) {
+        if (profile->phases[i].arrivals_per_min > 0.0 && !pattern_cdf(g, profile->phases[i].pattern)) {
+            printf("[SIMULATION] Error: El patrón %s no tiene viajes posibles en %d pisos\n",
+                   gw_traffic_pattern_name(profile->phases[i].pattern), profile->num_floors);
+            gw_traffic_destroy(g);
+            return NULL;
+        }
+    }
+
+    gw_prng_seed_stream(&g->rng, seed, stream);
+    return g;
+}
+
+bool gw_traffic_next(gw_traffic_generator_t *generator, peticion_simulacion_t *out) {
+    if (!generator || !out) {
+        return false;
+    }
+    gw_traffic_generator_t *g = generator;
+    if (!g->has_arrival && !g->arrivals_done) {
+        draw_arrival(g);
+    }
+    // A igual instante sale antes la solicitud de cabina ya pendiente
+    if (g->pending_count > 0 &&
+        (!g->has_arrival || g->pending[g->pending_head].instante_ms <= g->arrival.instante_ms)) {
+        *out = g->pending[g->pending_head];
+        g->pending_head = (g->pending_head + 1) % g->pending_capacity;
+        g->pending_count--;
+        return true;
+    }
+    if (g->has_arrival) {
+        *out = g->arrival;
+        g->has_arrival = false;
+        return true;
+    }
+    return false;
+}
+
+uint64_t gw_traffic_passengers(const gw_traffic_generator_t *generator) {
+    return generator ? generator->passengers : 0;
+}
+
+void gw_traffic_destroy(gw_traffic_generator_t *generator) {
+    if (!generator) {
+        return;
+    }
+    for (int p = 0; p < TRAFFIC_NUM_PATTERNS; ++p) {
+        free(generator->cdf[p]);
+    }
+    free(generator->od_matrix);
+    free(generator->pending);
+    free(generator);
+}
+
+static bool programar_siguiente_trafico(gw_sim_queue_t *cola, gw_traffic_plan_t *plan);
+
+/**
+ * @brief Entrega la petición vencida de un plan de tráfico y programa la siguiente
+ * @param cola Cola de eventos
+ * @param evento Evento con el plan en arg
+ */
+static void ejecutar_peticion_trafico(gw_sim_queue_t *cola, const gw_sim_event_t *evento) {
+    gw_traffic_plan_t *plan = evento->arg;
+    plan->actual = plan->siguiente;
+    gw_sim_event_t peticion_evento = *evento;
+    peticion_evento.arg = &plan->actual;
+    peticion_evento.value = plan->emitidas++;
+
+    // Programar antes de ejecutar: la acción puede consultar el tamaño de la cola
+    programar_siguiente_trafico(cola, plan);
+    plan->accion(cola, &peticion_evento);
+}
+
+static bool programar_siguiente_trafico(gw_sim_queue_t *cola, gw_traffic_plan_t *plan) {
+    if (!gw_traffic_next(plan->generator, &plan->siguiente)) {
+        return false;
+    }
+    return gw_sim_queue_schedule(cola, plan->inicio_ms + plan->siguiente.instante_ms,
+                                 ejecutar_peticion_trafico, plan, plan->building_index,
+                                 plan->emitidas);
+}
+
+bool gw_traffic_schedule(gw_sim_queue_t *cola, gw_traffic_plan_t *plan) {
+    if (!cola || !plan || !plan->generator || !plan->accion) {
+        return false;
+    }
+    plan->emitidas = 0;
+    return programar_siguiente_trafico(cola, plan);
+}
@@ -0,0 +1,146 @@
+/**
+ * @file request_capture.h
+ * @brief Captura binaria de las peticiones recibidas por el servidor central
+ * @author Sistema de Control de Ascensores
+ * @version 2.0
+ * @date 2025
+ *
+ * @details Modo de captura opcional (`servidor_central --capture <archivo>`)
+ * que guarda cada petición de piso o de cabina tal como llega al manejador,
+ * ya descifrada por DTLS, junto con el instante de llegada y la identidad
+ * PSK del gateway. La herramienta `capture_replay` vuelve a inyectar esas
+ * peticiones en los manejadores para reproducir una ralentización sin
+ * gateways reales.
+ *
+ * **Formato del archivo** (enteros little-endian):
+ * - Cabecera (24 bytes): magic "SCCAPTUR", versión (uint32), reservado
+ *   (uint32), inicio de la captura en µs desde epoch Unix (uint64)
+ * - Registro (16 bytes + datos): instante de llegada en µs desde el inicio
+ *   (uint64, reloj monotónico), recurso (uint8), longitud de la identidad
+ *   (uint8), reservado (uint16), longitud del payload (uint32), seguidos de
+ *   la identidad y del payload
+ *
+ * @see request_handlers.h
+ * @see capture_replay.c
+ */
+
+#ifndef REQUEST_CAPTURE_H
+#define REQUEST_CAPTURE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <coap3/coap.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Versión del formato de captura
+ */
+#define CAPTURE_FORMAT_VERSION 1
+
+/**
+ * @brief Longitud máxima de la identidad PSK guardada
+ */
+#define CAPTURE_MAX_IDENTITY 255
+
+/**
+ * @brief Longitud máxima de un payload capturado
+ */
+#define CAPTURE_MAX_PAYLOAD (64 * 1024)
+
+/**
+ * @brief Recurso CoAP al que iba dirigida la petición capturada
+ */
+typedef enum {
+    CAPTURE_RESOURCE_FLOOR_CALL = 0,    /**< POST /peticion_piso */
+    CAPTURE_RESOURCE_CABIN_REQUEST = 1  /**< POST /peticion_cabina */
+} capture_resource_t;
+
+/**
+ * @brief Petición leída de un archivo de captura
+ */
+typedef struct {
+    uint64_t offset_us;                       /**< Llegada, en µs desde el inicio de la captura */
+    capture_resource_t resource;              /**< Recurso destino */
+    char identity[CAPTURE_MAX_IDENTITY + 1];  /**< Identidad PSK del gateway ("" si no había) */
+    uint8_t *payload;                         /**< Payload (malloc, lo libera el llamador; NULL si vacío) */
+    size_t payload_len;                       /**< Longitud del payload */
+} capture_record_t;
+
+/**
+ * @brief Lector secuencial de un archivo de captura
+ */
+typedef struct {
+    FILE *file;                 /**< Archivo abierto */
+    uint64_t start_unix_us;     /**< Inicio de la captura (µs desde epoch Unix) */
+} capture_reader_t;
+
+/**
+ * @brief Abre (trunca) el archivo de captura y activa la captura
+ *
+ * @param[in] path Ruta del archivo
+ * @return 0 en caso de éxito, -1 si no se pudo crear o escribir la cabecera
+ */
+int request_capture_open(const char *path);
+
+/**
+ * @brief Indica si la captura está activa
+ * @return 1 si se están guardando peticiones, 0 en caso contrario
+ */
+int request_capture_is_active(void);
+
+/**
+ * @brief Guarda una petición recibida
+ *
+ * @param[in] resource Recurso destino
+ * @param[in] session Sesión del gateway (para la identidad PSK; puede ser NULL)
+ * @param[in] data Payload recibido, o NULL si no traía datos
+ * @param[in] data_len Longitud del payload
+ *
+ * @details No hace nada si la captura no está activa. Un error de escritura
+ * desactiva la captura sin afectar al servicio.
+ */
+void request_capture_record(capture_resource_t resource, coap_session_t *session,
+                            const uint8_t *data, size_t data_len);
+
+/**
+ * @brief Vuelca al disco las peticiones pendientes del buffer
+ */
+void request_capture_flush(void);
+
+/**
+ * @brief Cierra el archivo de captura
+ */
+void request_capture_close(void);
+
+/**
+ * @brief Abre un archivo de captura para lectura y valida la cabecera
+ *
+ * @param[out] reader Lector a inicializar
+ * @param[in] path Ruta del archivo
+ * @return 0 en caso de éxito, -1 si no se pudo abrir o no es una captura válida
+ */
+int capture_reader_open(capture_reader_t *reader, const char *path);
+
+/**
+ * @brief Lee la siguiente petición
+ *
+ * @param[in] reader Lector abierto
+ * @param[out] record Petición leída (el llamador libera record->payload)
+ * @return 1 si se leyó una petición, 0 al final del archivo, -1 si está truncado o corrupto
+ */
+int capture_reader_next(capture_reader_t *reader, capture_record_t *record);
+
+/**
+ * @brief Cierra el lector
+ */
+void capture_reader_close(capture_reader_t *reader);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* REQUEST_CAPTURE_H */
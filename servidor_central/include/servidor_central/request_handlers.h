@@ -0,0 +1,70 @@
+/**
+ * @file request_handlers.h
+ * @brief Procesamiento de las peticiones de piso y de cabina del servidor central
+ * @author Sistema de Control de Ascensores
+ * @version 2.0
+ * @date 2025
+ *
+ * @details Este archivo declara el procesamiento de los payloads JSON de
+ * `POST /peticion_piso` y `POST /peticion_cabina` una vez superadas las
+ * comprobaciones de transporte (sesión DTLS establecida y Content-Format).
+ *
+ * Los manejadores CoAP de main.c hacen esas comprobaciones y delegan aquí;
+ * la herramienta de reproducción (capture_replay.c) llama a las mismas
+ * funciones en proceso, sin red ni cifrado.
+ *
+ * @see main.c
+ * @see request_capture.h
+ */
+
+#ifndef REQUEST_HANDLERS_H
+#define REQUEST_HANDLERS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <coap3/coap.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Genera un ID único para una tarea de ascensor
+ *
+ * @param[out] task_id_out Buffer donde se almacenará el ID generado
+ * @param[in] len Tamaño del buffer de salida en bytes
+ *
+ * @details Formato "T_{segundos_unix}{milisegundos}", p. ej. "T_1640995200123".
+ */
+void generate_unique_task_id(char *task_id_out, size_t len);
+
+/**
+ * @brief Procesa el payload de una llamada de piso y rellena la respuesta
+ *
+ * @param[in] data Payload JSON recibido, o NULL si la petición no traía datos
+ * @param[in] data_len Longitud del payload en bytes
+ * @param[out] response PDU de respuesta (código, Content-Format y datos)
+ *
+ * @details Valida los campos, ejecuta el algoritmo de selección de ascensor
+ * y responde con `tarea_id` y `ascensor_asignado_id`, o con un error JSON
+ * (4.00 payload inválido, 5.03 sin ascensores, 5.00 error interno).
+ */
+void process_floor_call_payload(const uint8_t *data, size_t data_len, coap_pdu_t *response);
+
+/**
+ * @brief Procesa el payload de una petición de cabina y rellena la respuesta
+ *
+ * @param[in] data Payload JSON recibido, o NULL si la petición no traía datos
+ * @param[in] data_len Longitud del payload en bytes
+ * @param[out] response PDU de respuesta (código, Content-Format y datos)
+ *
+ * @details El ascensor solicitante se auto-asigna la tarea si aparece en
+ * `elevadores_estado`; en otro caso se responde 4.00.
+ */
+void process_cabin_request_payload(const uint8_t *data, size_t data_len, coap_pdu_t *response);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* REQUEST_HANDLERS_H */
@@ -0,0 +1,359 @@
+/**
+ * @file capture_replay.c
+ * @brief Reproducción en proceso de una captura de peticiones del servidor central
+ * @author Sistema de Control de Ascensores
+ * @version 2.0
+ * @date 2025
+ *
+ * @details Herramienta para reproducir una ralentización del servidor central
+ * sin gateways reales. Lee un archivo generado con
+ * `servidor_central --capture <archivo>` y pasa cada petición directamente a
+ * los manejadores de request_handlers.c, sin red, sin DTLS y sin sesiones
+ * CoAP, midiendo el tiempo de cada llamada.
+ *
+ * **Uso:**
+ * ```
+ * capture_replay <captura> [--max-speed | --speed <factor>] [--repeat <n>] [--verbose]
+ * ```
+ *
+ * - Por defecto respeta los instantes de llegada originales (`--speed 1`);
+ *   `--speed 4` reproduce cuatro veces más rápido.
+ * - `--max-speed` encadena las peticiones sin esperas para medir el
+ *   throughput máximo de los manejadores.
+ * - `--repeat <n>` reproduce la captura n veces seguidas.
+ * - Los logs informativos por petición (stdout) se descartan salvo con
+ *   `--verbose`, porque su coste dominaría la medida.
+ *
+ * El informe incluye peticiones por recurso y por gateway (identidad PSK),
+ * códigos de respuesta, latencia por petición (media, p50, p90, p99, máx.),
+ * throughput y, al ritmo original, el retraso máximo acumulado respecto a
+ * los instantes capturados.
+ *
+ * @see request_capture.h
+ * @see request_handlers.h
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <coap3/coap.h>
+
+#include "servidor_central/request_capture.h"
+#include "servidor_central/request_handlers.h"
+
+/**
+ * @brief Tamaño máximo de la PDU de respuesta que rellenan los manejadores
+ */
+#define REPLAY_MAX_PDU_SIZE 4096
+
+/**
+ * @brief Gateways distintos que se desglosan en el informe
+ */
+#define REPLAY_MAX_GATEWAYS 64
+
+/**
+ * @brief Peticiones de un gateway en la captura
+ */
+typedef struct {
+    char identity[CAPTURE_MAX_IDENTITY + 1];    /**< Identidad PSK */
+    unsigned long requests;                     /**< Peticiones en la captura */
+} replay_gateway_t;
+
+/**
+ * @brief Captura cargada en memoria
+ */
+typedef struct {
+    capture_record_t *records;      /**< Peticiones en orden de llegada */
+    size_t count;                   /**< Peticiones cargadas */
+    size_t capacity;                /**< Capacidad de @c records */
+    int truncated;                  /**< 1 si el archivo terminaba en un registro incompleto */
+} replay_capture_t;
+
+/**
+ * @brief Reloj monotónico en ns
+ */
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Duerme hasta un instante absoluto del reloj monotónico
+ */
+static void sleep_until_ns(uint64_t target_ns) {
+    struct timespec ts;
+    ts.tv_sec = (time_t)(target_ns / 1000000000ULL);
+    ts.tv_nsec = (long)(target_ns % 1000000000ULL);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+}
+
+static int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Percentil de latencias ordenadas, en µs
+ */
+static double percentile_us(const uint64_t *sorted_ns, size_t count, double percentile) {
+    if (count == 0) {
+        return 0.0;
+    }
+    return (double)sorted_ns[(size_t)((double)(count - 1) * percentile / 100.0)] / 1000.0;
+}
+
+/**
+ * @brief Carga en memoria todas las peticiones de una captura
+ * @return 0 en caso de éxito, -1 si el archivo no es una captura válida
+ */
+static int load_capture(const char *path, replay_capture_t *capture) {
+    capture_reader_t reader;
+    if (capture_reader_open(&reader, path) != 0) {
+        fprintf(stderr, "No se pudo abrir '%s' o no es un archivo de captura válido\n", path);
+        return -1;
+    }
+    memset(capture, 0, sizeof(*capture));
+
+    capture_record_t record;
+    int rc;
+    while ((rc = capture_reader_next(&reader, &record)) == 1) {
+        if (capture->count == capture->capacity) {
+            size_t capacity = capture->capacity ? capture->capacity * 2 : 1024;
+            capture_record_t *records = realloc(capture->records, capacity * sizeof(*records));
+            if (!records) {
+                free(record.payload);
+                rc = -1;
+                break;
+            }
+            capture->records = records;
+            capture->capacity = capacity;
+        }
+        capture->records[capture->count++] = record;
+    }
+    capture->truncated = (rc == -1);
+    capture_reader_close(&reader);
+    return 0;
+}
+
+/**
+ * @brief Libera los payloads y el array de peticiones
+ */
+static void free_capture(replay_capture_t *capture) {
+    for (size_t i = 0; i < capture->count; i++) {
+        free(capture->records[i].payload);
+    }
+    free(capture->records);
+    memset(capture, 0, sizeof(*capture));
+}
+
+/**
+ * @brief Suma una petición al gateway con esa identidad
+ */
+static void count_gateway(replay_gateway_t *gateways, size_t *num_gateways, unsigned long *others,
+                          const char *identity) {
+    for (size_t i = 0; i < *num_gateways; i++) {
+        if (strcmp(gateways[i].identity, identity) == 0) {
+            gateways[i].requests++;
+            return;
+        }
+    }
+    if (*num_gateways < REPLAY_MAX_GATEWAYS) {
+        snprintf(gateways[*num_gateways].identity, sizeof(gateways[*num_gateways].identity), "%s", identity);
+        gateways[*num_gateways].requests = 1;
+        (*num_gateways)++;
+    } else {
+        (*others)++;
+    }
+}
+
+static void print_usage(const char *program) {
+    fprintf(stderr,
+            "Uso: %s <captura> [--max-speed | --speed <factor>] [--repeat <n>] [--verbose]\n"
+            "  --speed <factor>  Reproduce a <factor> veces el ritmo original (por defecto 1)\n"
+            "  --max-speed       Sin esperas entre peticiones (throughput máximo)\n"
+            "  --repeat <n>      Reproduce la captura n veces (por defecto 1)\n"
+            "  --verbose         Conserva los logs por petición de los manejadores\n",
+            program);
+}
+
+int main(int argc, char **argv) {
+    const char *path = NULL;
+    double speed = 1.0;
+    int max_speed = 0;
+    long repeat = 1;
+    int verbose = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--max-speed") == 0) {
+            max_speed = 1;
+        } else if (strcmp(argv[i], "--speed") == 0 && i + 1 < argc) {
+            speed = strtod(argv[++i], NULL);
+        } else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = strtol(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--verbose") == 0) {
+            verbose = 1;
+        } else if (argv[i][0] != '-' && !path) {
+            path = argv[i];
+        } else {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (!path || speed <= 0.0 || repeat < 1) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    replay_capture_t capture;
+    if (load_capture(path, &capture) != 0) {
+        return EXIT_FAILURE;
+    }
+    if (capture.truncated) {
+        fprintf(stderr, "Aviso: la captura termina en un registro incompleto; se usan %zu peticiones\n",
+                capture.count);
+    }
+    if (capture.count == 0) {
+        fprintf(stderr, "La captura no contiene peticiones\n");
+        free_capture(&capture);
+        return EXIT_FAILURE;
+    }
+
+    // El informe va a la salida estándar original; los logs de los
+    // manejadores (printf) se descartan salvo con --verbose
+    FILE *report = stdout;
+    if (!verbose) {
+        int report_fd = dup(STDOUT_FILENO);
+        FILE *report_file = report_fd >= 0 ? fdopen(report_fd, "w") : NULL;
+        if (report_file && freopen("/dev/null", "w", stdout)) {
+            report = report_file;
+        } else if (report_file) {
+            fclose(report_file);
+        }
+    }
+
+    coap_startup();
+    coap_set_log_level(COAP_LOG_WARN);
+
+    size_t total = capture.count * (size_t)repeat;
+    uint64_t *latencies_ns = malloc(total * sizeof(*latencies_ns));
+    if (!latencies_ns) {
+        fprintf(stderr, "Sin memoria para %zu muestras\n", total);
+        free_capture(&capture);
+        coap_cleanup();
+        return EXIT_FAILURE;
+    }
+
+    unsigned long per_resource[2] = { 0, 0 };
+    unsigned long per_class[6] = { 0, 0, 0, 0, 0, 0 };
+    unsigned long failed_pdus = 0;
+    uint64_t handler_ns = 0;
+    uint64_t max_lag_ns = 0;
+    size_t done = 0;
+
+    uint64_t first_offset_us = capture.records[0].offset_us;
+    uint64_t span_us = capture.records[capture.count - 1].offset_us - first_offset_us;
+    uint64_t replay_start_ns = monotonic_ns();
+    uint64_t pass_start_ns = replay_start_ns;
+
+    for (long pass = 0; pass < repeat; pass++) {
+        for (size_t i = 0; i < capture.count; i++) {
+            const capture_record_t *record = &capture.records[i];
+
+            uint64_t target_ns = 0;
+            if (!max_speed) {
+                target_ns = pass_start_ns +
+                            (uint64_t)((double)(record->offset_us - first_offset_us) * 1000.0 / speed);
+                uint64_t now_ns = monotonic_ns();
+                if (now_ns < target_ns) {
+                    sleep_until_ns(target_ns);
+                }
+            }
+
+            coap_pdu_t *response = coap_pdu_init(COAP_MESSAGE_ACK, COAP_EMPTY_CODE, 0, REPLAY_MAX_PDU_SIZE);
+            if (!response) {
+                failed_pdus++;
+                continue;
+            }
+
+            uint64_t begin_ns = monotonic_ns();
+            if (record->resource == CAPTURE_RESOURCE_FLOOR_CALL) {
+                process_floor_call_payload(record->payload, record->payload_len, response);
+            } else {
+                process_cabin_request_payload(record->payload, record->payload_len, response);
+            }
+            uint64_t end_ns = monotonic_ns();
+
+            if (!max_speed && begin_ns > target_ns && begin_ns - target_ns > max_lag_ns) {
+                max_lag_ns = begin_ns - target_ns;
+            }
+            latencies_ns[done++] = end_ns - begin_ns;
+            handler_ns += end_ns - begin_ns;
+            per_resource[record->resource]++;
+            unsigned code_class = COAP_RESPONSE_CLASS(coap_pdu_get_code(response));
+            per_class[code_class < 6 ? code_class : 0]++;
+            coap_delete_pdu(response);
+        }
+        // La siguiente pasada empieza tras el intervalo que cubría la captura
+        pass_start_ns += (uint64_t)((double)span_us * 1000.0 / speed);
+        if (max_speed || monotonic_ns() > pass_start_ns) {
+            pass_start_ns = monotonic_ns();
+        }
+    }
+    uint64_t wall_ns = monotonic_ns() - replay_start_ns;
+
+    replay_gateway_t gateways[REPLAY_MAX_GATEWAYS];
+    size_t num_gateways = 0;
+    unsigned long other_gateways = 0;
+    for (size_t i = 0; i < capture.count; i++) {
+        count_gateway(gateways, &num_gateways, &other_gateways,
+                      capture.records[i].identity[0] ? capture.records[i].identity : "(sin identidad)");
+    }
+
+    qsort(latencies_ns, done, sizeof(*latencies_ns), compare_u64);
+    double mean_us = done ? (double)handler_ns / (double)done / 1000.0 : 0.0;
+
+    fprintf(report, "=== Reproducción de captura: %s ===\n", path);
+    fprintf(report, "Modo: %s, pasadas: %ld\n",
+            max_speed ? "máxima velocidad" : (speed == 1.0 ? "ritmo original" : "ritmo acelerado"), repeat);
+    if (!max_speed && speed != 1.0) {
+        fprintf(report, "Factor de velocidad: %.2fx\n", speed);
+    }
+    fprintf(report, "Captura: %zu peticiones en %.3f s\n", capture.count, (double)span_us / 1e6);
+    fprintf(report, "Peticiones reproducidas: %zu (piso: %lu, cabina: %lu)\n",
+            done, per_resource[CAPTURE_RESOURCE_FLOOR_CALL], per_resource[CAPTURE_RESOURCE_CABIN_REQUEST]);
+    if (failed_pdus > 0) {
+        fprintf(report, "PDUs de respuesta no creadas: %lu\n", failed_pdus);
+    }
+    fprintf(report, "Respuestas: 2.xx %lu, 4.xx %lu, 5.xx %lu\n", per_class[2], per_class[4], per_class[5]);
+    fprintf(report, "Gateways en la captura: %zu\n", num_gateways);
+    for (size_t i = 0; i < num_gateways; i++) {
+        fprintf(report, "  %-40s %lu\n", gateways[i].identity, gateways[i].requests);
+    }
+    if (other_gateways > 0) {
+        fprintf(report, "  %-40s %lu\n", "(otros)", other_gateways);
+    }
+    fprintf(report, "Latencia de manejador (µs): media %.1f, p50 %.1f, p90 %.1f, p99 %.1f, máx %.1f\n",
+            mean_us, percentile_us(latencies_ns, done, 50.0), percentile_us(latencies_ns, done, 90.0),
+            percentile_us(latencies_ns, done, 99.0), percentile_us(latencies_ns, done, 100.0));
+    fprintf(report, "Tiempo en manejadores: %.3f s, tiempo total: %.3f s\n",
+            (double)handler_ns / 1e9, (double)wall_ns / 1e9);
+    fprintf(report, "Throughput de manejadores: %.0f peticiones/s\n",
+            handler_ns ? (double)done * 1e9 / (double)handler_ns : 0.0);
+    if (!max_speed) {
+        fprintf(report, "Retraso máximo respecto al ritmo capturado: %.3f ms\n", (double)max_lag_ns / 1e6);
+    }
+
+    if (report != stdout) {
+        fclose(report);
+    }
+    free(latencies_ns);
+    free_capture(&capture);
+    coap_cleanup();
+    return EXIT_SUCCESS;
+}
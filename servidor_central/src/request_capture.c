@@ -0,0 +1,271 @@
+/**
+ * @file request_capture.c
+ * @brief Implementación de la captura binaria de peticiones del servidor central
+ * @author Sistema de Control de Ascensores
+ * @version 2.0
+ * @date 2025
+ *
+ * @details Escritura y lectura del formato descrito en request_capture.h.
+ * La escritura se hace con un buffer de stdio grande y el bucle principal
+ * del servidor lo vuelca tras cada iteración (request_capture_flush()), de
+ * modo que capturar no añade una llamada al sistema por petición.
+ *
+ * @see request_capture.h
+ */
+
+#include "servidor_central/request_capture.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+
+#include "servidor_central/logging.h"
+
+/**
+ * @brief Identificador del formato al inicio del archivo
+ */
+static const uint8_t CAPTURE_MAGIC[8] = { 'S', 'C', 'C', 'A', 'P', 'T', 'U', 'R' };
+
+/**
+ * @brief Tamaño de la cabecera del archivo en bytes
+ */
+#define CAPTURE_FILE_HEADER_SIZE 24
+
+/**
+ * @brief Tamaño de la cabecera de cada registro en bytes
+ */
+#define CAPTURE_RECORD_HEADER_SIZE 16
+
+/**
+ * @brief Tamaño del buffer de escritura
+ */
+#define CAPTURE_WRITE_BUFFER_SIZE (256 * 1024)
+
+/**
+ * @brief Estado de la captura en curso
+ */
+typedef struct {
+    FILE *file;                 /**< Archivo de captura (NULL si inactiva) */
+    char *buffer;               /**< Buffer de stdio del archivo */
+    uint64_t start_mono_us;     /**< Inicio de la captura (reloj monotónico) */
+    uint64_t records;           /**< Peticiones guardadas */
+} capture_state_t;
+
+/**
+ * @brief Variable global con el estado de la captura
+ *
+ * @details Los manejadores CoAP se ejecutan en el hilo de coap_io_process(),
+ * por lo que no necesita sincronización.
+ */
+static capture_state_t g_capture = { NULL, NULL, 0, 0 };
+
+/**
+ * @brief Reloj monotónico en µs
+ */
+static uint64_t monotonic_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+/**
+ * @brief Codificación little-endian de los enteros del formato
+ * @{
+ */
+static void put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+static void put_u64(uint8_t *p, uint64_t v) {
+    for (int i = 0; i < 8; i++) {
+        p[i] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t get_u64(const uint8_t *p) {
+    return (uint64_t)get_u32(p) | ((uint64_t)get_u32(p + 4) << 32);
+}
+/** @} */
+
+int request_capture_open(const char *path) {
+    if (!path) {
+        return -1;
+    }
+    request_capture_close();
+
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        SRV_LOG_ERROR("Captura: no se pudo crear '%s'", path);
+        return -1;
+    }
+    char *buffer = malloc(CAPTURE_WRITE_BUFFER_SIZE);
+    if (buffer) {
+        setvbuf(file, buffer, _IOFBF, CAPTURE_WRITE_BUFFER_SIZE);
+    }
+
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    uint8_t header[CAPTURE_FILE_HEADER_SIZE];
+    memcpy(header, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC));
+    put_u32(header + 8, CAPTURE_FORMAT_VERSION);
+    put_u32(header + 12, 0);
+    put_u64(header + 16, (uint64_t)tv.tv_sec * 1000000ULL + (uint64_t)tv.tv_usec);
+    if (fwrite(header, sizeof(header), 1, file) != 1 || fflush(file) != 0) {
+        SRV_LOG_ERROR("Captura: no se pudo escribir la cabecera en '%s'", path);
+        fclose(file);
+        free(buffer);
+        return -1;
+    }
+
+    g_capture.file = file;
+    g_capture.buffer = buffer;
+    g_capture.start_mono_us = monotonic_us();
+    g_capture.records = 0;
+    SRV_LOG_INFO("Captura de peticiones activada en '%s'", path);
+    return 0;
+}
+
+int request_capture_is_active(void) {
+    return g_capture.file != NULL;
+}
+
+void request_capture_record(capture_resource_t resource, coap_session_t *session,
+                            const uint8_t *data, size_t data_len) {
+    if (!g_capture.file) {
+        return;
+    }
+    uint64_t offset_us = monotonic_us() - g_capture.start_mono_us;
+
+    const uint8_t *identity = NULL;
+    size_t identity_len = 0;
+    const coap_bin_const_t *psk_identity = session ? coap_session_get_psk_identity(session) : NULL;
+    if (psk_identity && psk_identity->s) {
+        identity = psk_identity->s;
+        identity_len = psk_identity->length > CAPTURE_MAX_IDENTITY ? CAPTURE_MAX_IDENTITY : psk_identity->length;
+    }
+    if (!data || data_len > CAPTURE_MAX_PAYLOAD) {
+        // Un payload mayor que el admitido por el lector se guarda vacío
+        data_len = 0;
+    }
+
+    uint8_t header[CAPTURE_RECORD_HEADER_SIZE];
+    put_u64(header, offset_us);
+    header[8] = (uint8_t)resource;
+    header[9] = (uint8_t)identity_len;
+    put_u16(header + 10, 0);
+    put_u32(header + 12, (uint32_t)data_len);
+
+    if (fwrite(header, sizeof(header), 1, g_capture.file) != 1 ||
+        (identity_len > 0 && fwrite(identity, identity_len, 1, g_capture.file) != 1) ||
+        (data_len > 0 && fwrite(data, data_len, 1, g_capture.file) != 1)) {
+        SRV_LOG_ERROR("Captura: error de escritura tras %llu peticiones, captura desactivada",
+                      (unsigned long long)g_capture.records);
+        request_capture_close();
+        return;
+    }
+    g_capture.records++;
+}
+
+void request_capture_flush(void) {
+    if (g_capture.file && fflush(g_capture.file) != 0) {
+        SRV_LOG_ERROR("Captura: error al volcar el archivo, captura desactivada");
+        request_capture_close();
+    }
+}
+
+void request_capture_close(void) {
+    if (!g_capture.file) {
+        return;
+    }
+    if (fclose(g_capture.file) != 0) {
+        SRV_LOG_ERROR("Captura: error al cerrar el archivo");
+    }
+    free(g_capture.buffer);
+    SRV_LOG_INFO("Captura cerrada: %llu peticiones guardadas", (unsigned long long)g_capture.records);
+    g_capture.file = NULL;
+    g_capture.buffer = NULL;
+}
+
+int capture_reader_open(capture_reader_t *reader, const char *path) {
+    if (!reader || !path) {
+        return -1;
+    }
+    memset(reader, 0, sizeof(*reader));
+
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return -1;
+    }
+    uint8_t header[CAPTURE_FILE_HEADER_SIZE];
+    if (fread(header, sizeof(header), 1, file) != 1 ||
+        memcmp(header, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC)) != 0 ||
+        get_u32(header + 8) != CAPTURE_FORMAT_VERSION) {
+        fclose(file);
+        return -1;
+    }
+    reader->file = file;
+    reader->start_unix_us = get_u64(header + 16);
+    return 0;
+}
+
+int capture_reader_next(capture_reader_t *reader, capture_record_t *record) {
+    if (!reader || !reader->file || !record) {
+        return -1;
+    }
+    uint8_t header[CAPTURE_RECORD_HEADER_SIZE];
+    size_t got = fread(header, 1, sizeof(header), reader->file);
+    if (got == 0 && feof(reader->file)) {
+        return 0;
+    }
+    if (got != sizeof(header)) {
+        return -1;
+    }
+
+    uint8_t resource = header[8];
+    size_t identity_len = header[9];
+    size_t payload_len = get_u32(header + 12);
+    if (resource > CAPTURE_RESOURCE_CABIN_REQUEST || payload_len > CAPTURE_MAX_PAYLOAD) {
+        return -1;
+    }
+
+    record->offset_us = get_u64(header);
+    record->resource = (capture_resource_t)resource;
+    record->payload = NULL;
+    record->payload_len = 0;
+    if (identity_len > 0 && fread(record->identity, identity_len, 1, reader->file) != 1) {
+        return -1;
+    }
+    record->identity[identity_len] = '\0';
+
+    if (payload_len > 0) {
+        record->payload = malloc(payload_len);
+        if (!record->payload) {
+            return -1;
+        }
+        if (fread(record->payload, payload_len, 1, reader->file) != 1) {
+            free(record->payload);
+            record->payload = NULL;
+            return -1;
+        }
+        record->payload_len = payload_len;
+    }
+    return 1;
+}
+
+void capture_reader_close(capture_reader_t *reader) {
+    if (reader && reader->file) {
+        fclose(reader->file);
+        reader->file = NULL;
+    }
+}
@@ -0,0 +1,614 @@
+/**
+ * @file request_handlers.c
+ * @brief Procesamiento de las peticiones de piso y de cabina del servidor central
+ * @author Sistema de Control de Ascensores
+ * @version 2.0
+ * @date 2025
+ * 
+ * @details Este archivo contiene el algoritmo de selección de ascensores y
+ * el procesamiento de los payloads JSON de las peticiones de piso y de
+ * cabina. No depende de la sesión CoAP: recibe el payload ya descifrado y
+ * rellena la PDU de respuesta, de modo que el servidor (main.c) y la
+ * herramienta de reproducción (capture_replay.c) comparten el mismo código.
+ * 
+ * @see request_handlers.h
+ */
+
+#include "servidor_central/request_handlers.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <cjson/cJSON.h>
+
+#include "servidor_central/logging.h"
+
+/**
+ * @brief Genera un ID único para una tarea de ascensor
+ * 
+ * @param[out] task_id_out Buffer donde se almacenará el ID generado
+ * @param[in] len Tamaño del buffer de salida en bytes
+ * 
+ * @details Esta función genera un identificador único para tareas de ascensor
+ * basado en el timestamp actual del sistema con precisión de milisegundos.
+ * 
+ * **Formato del ID generado:**
+ * ```
+ * "T_{segundos_unix}{milisegundos}"
+ * ```
+ * 
+ * **Ejemplo de ID:**
+ * - "T_1640995200123" donde:
+ *   - T_: Prefijo identificador de tarea
+ *   - 1640995200: Segundos desde epoch Unix
+ *   - 123: Milisegundos (3 dígitos)
+ * 
+ * **Características:**
+ * - Unicidad temporal garantizada
+ * - Formato legible y ordenable
+ * - Precisión de milisegundos
+ * - Compatible con sistemas distribuidos
+ * 
+ * **Limitaciones:**
+ * - No es thread-safe (para entornos multihilo usar sincronización)
+ * - Dependiente del reloj del sistema
+ * - Máximo 1,000 IDs por segundo (limitación de milisegundos)
+ * 
+ * **Uso típico:**
+ * ```c
+ * char task_id[32];
+ * generate_unique_task_id(task_id, sizeof(task_id));
+ * // task_id contiene "T_1640995200123"
+ * ```
+ * 
+ * @note El buffer de salida debe tener al menos 32 caracteres
+ * @note Para entornos multihilo considerar usar mutex o contadores atómicos
+ * @see gettimeofday()
+ * @see snprintf()
+ */
+void generate_unique_task_id(char *task_id_out, size_t len) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    snprintf(task_id_out, len, "T_%ld%03ld", (long)tv.tv_sec, (long)(tv.tv_usec / 1000));
+}
+
+/**
+ * @brief Algoritmo de selección inteligente de ascensores mejorado
+ * 
+ * @param[in] elevadores_estado Array JSON con el estado de todos los ascensores
+ * @param[in] piso_origen Piso desde donde se hace la llamada
+ * @param[in] direccion_llamada Dirección deseada ("SUBIENDO" o "BAJANDO")
+ * 
+ * @return ID del ascensor asignado (debe ser liberado por el caller) o NULL si no hay ascensores
+ * 
+ * @details Esta función implementa un algoritmo inteligente que:
+ * 
+ * **🧠 ALGORITMO MEJORADO:**
+ * 1. **Prioridad 1:** Ascensores disponibles más cercanos
+ * 2. **Prioridad 2:** Ascensores ocupados que van en la misma dirección y pueden recoger
+ * 3. **Prioridad 3:** Ascensores ocupados que terminarán cerca del origen
+ * 4. **Prioridad 4:** Cualquier ascensor disponible como último recurso
+ * 
+ * **📊 ANÁLISIS POR CATEGORÍAS:**
+ * - **DISPONIBLES:** Ascensores sin tarea actual (disponible=true)
+ * - **COMPATIBLES:** Ascensores ocupados que van en la misma dirección
+ * - **PRÓXIMOS:** Ascensores que terminarán cerca del piso origen
+ * - **CUALQUIERA:** Fallback si todos están ocupados
+ * 
+ * **🎯 CRITERIOS DE SELECCIÓN:**
+ * - Distancia al piso origen
+ * - Compatibilidad de dirección
+ * - Eficiencia de ruta
+ * - Tiempo estimado de disponibilidad
+ * 
+ * @note Esta función resuelve el problema crítico del algoritmo anterior
+ * @note El ID retornado debe ser liberado con free() por el caller
+ */
+static char* select_optimal_elevator(cJSON *elevadores_estado, int piso_origen, const char *direccion_llamada) {
+    if (!elevadores_estado || !cJSON_IsArray(elevadores_estado) || !direccion_llamada) {
+        SRV_LOG_ERROR("Invalid parameters for elevator selection");
+        return NULL;
+    }
+
+    int array_size = cJSON_GetArraySize(elevadores_estado);
+    if (array_size == 0) {
+        SRV_LOG_WARN("No elevators in the building");
+        return NULL;
+    }
+
+    SRV_LOG_INFO("🧠 ALGORITMO MEJORADO: Analizando %d ascensores para piso %d, dirección %s", 
+                 array_size, piso_origen, direccion_llamada);
+
+    // Estructuras para candidatos por prioridad
+    struct {
+        char *id;
+        int piso_actual;
+        int destino_actual;
+        int score;
+        int distance;
+        int disponible;
+        char *estado;
+    } *candidatos = malloc(array_size * sizeof(*candidatos));
+    
+    if (!candidatos) {
+        SRV_LOG_ERROR("Memory allocation failed for elevator candidates");
+        return NULL;
+    }
+
+    int num_candidatos = 0;
+    int num_disponibles = 0;
+    int num_compatibles = 0;
+    int num_ocupados = 0;
+
+    // Analizar todos los ascensores
+    for (int i = 0; i < array_size; i++) {
+        cJSON *elevator = cJSON_GetArrayItem(elevadores_estado, i);
+        if (!elevator) continue;
+
+        cJSON *j_id = cJSON_GetObjectItemCaseSensitive(elevator, "id_ascensor");
+        cJSON *j_piso = cJSON_GetObjectItemCaseSensitive(elevator, "piso_actual");
+        cJSON *j_disponible = cJSON_GetObjectItemCaseSensitive(elevator, "disponible");
+        cJSON *j_destino = cJSON_GetObjectItemCaseSensitive(elevator, "destino_actual");
+
+        if (!cJSON_IsString(j_id) || !cJSON_IsNumber(j_piso) || !cJSON_IsBool(j_disponible)) {
+            SRV_LOG_WARN("Ascensor %d: campos inválidos", i);
+            continue;
+        }
+
+        char *id = j_id->valuestring;
+        int piso_actual = j_piso->valueint;
+        int disponible = cJSON_IsTrue(j_disponible) ? 1 : 0;
+        int destino_actual = (j_destino && cJSON_IsNumber(j_destino)) ? j_destino->valueint : -1;
+
+        // Calcular métricas
+        int distance = abs(piso_actual - piso_origen);
+        int score = 0;
+        char *estado = "UNKNOWN";
+
+        if (disponible) {
+            // CATEGORÍA 1: DISPONIBLES
+            score = 1000 - distance; // Prioridad máxima, menor distancia = mayor score
+            estado = "DISPONIBLE";
+            num_disponibles++;
+        } else if (destino_actual != -1) {
+            // CATEGORÍA 2: OCUPADOS CON DESTINO
+            num_ocupados++;
+            
+            // Verificar si es compatible (va en la misma dirección y puede recoger)
+            int va_subiendo = (destino_actual > piso_actual);
+            int va_bajando = (destino_actual < piso_actual);
+            int puede_recoger = 0;
+            
+            if (strcmp(direccion_llamada, "SUBIENDO") == 0) {
+                // Llamada hacia arriba
+                if (va_subiendo && piso_actual <= piso_origen && piso_origen <= destino_actual) {
+                    puede_recoger = 1;
+                    estado = "COMPATIBLE_SUBIENDO";
+                }
+            } else if (strcmp(direccion_llamada, "BAJANDO") == 0) {
+                // Llamada hacia abajo
+                if (va_bajando && piso_actual >= piso_origen && piso_origen >= destino_actual) {
+                    puede_recoger = 1;
+                    estado = "COMPATIBLE_BAJANDO";
+                }
+            }
+            
+            if (puede_recoger) {
+                // CATEGORÍA 2: COMPATIBLES
+                score = 800 - distance; // Alta prioridad
+                num_compatibles++;
+            } else {
+                // CATEGORÍA 3: PRÓXIMOS (terminarán cerca)
+                int distancia_al_terminar = abs(destino_actual - piso_origen);
+                score = 600 - distancia_al_terminar; // Prioridad media
+                estado = "PRÓXIMO";
+            }
+        } else {
+            // CATEGORÍA 4: OCUPADOS SIN DESTINO CONOCIDO
+            score = 400 - distance; // Prioridad baja
+            estado = "OCUPADO_SIN_DESTINO";
+            num_ocupados++;
+        }
+
+        // Agregar candidato
+        candidatos[num_candidatos].id = strdup(id);
+        candidatos[num_candidatos].piso_actual = piso_actual;
+        candidatos[num_candidatos].destino_actual = destino_actual;
+        candidatos[num_candidatos].score = score;
+        candidatos[num_candidatos].distance = distance;
+        candidatos[num_candidatos].disponible = disponible;
+        candidatos[num_candidatos].estado = strdup(estado);
+        num_candidatos++;
+
+        SRV_LOG_DEBUG("📊 Candidato: %s | Piso: %d | Destino: %d | Score: %d | Estado: %s", 
+                     id, piso_actual, destino_actual, score, estado);
+    }
+
+    // Estadísticas del análisis
+    SRV_LOG_INFO("📈 ESTADÍSTICAS: Disponibles=%d, Compatibles=%d, Ocupados=%d, Total=%d", 
+                 num_disponibles, num_compatibles, num_ocupados, num_candidatos);
+
+    // Seleccionar el mejor candidato
+    char *selected_id = NULL;
+    int best_score = -1;
+    int best_index = -1;
+
+    for (int i = 0; i < num_candidatos; i++) {
+        if (candidatos[i].score > best_score) {
+            best_score = candidatos[i].score;
+            best_index = i;
+        }
+    }
+
+    if (best_index != -1) {
+        selected_id = strdup(candidatos[best_index].id);
+        SRV_LOG_INFO("🎯 SELECCIONADO: %s | Score: %d | Estado: %s | Piso: %d → %d", 
+                     candidatos[best_index].id,
+                     candidatos[best_index].score,
+                     candidatos[best_index].estado,
+                     candidatos[best_index].piso_actual,
+                     candidatos[best_index].destino_actual);
+        
+        // Logging adicional según el tipo de selección
+        if (candidatos[best_index].disponible) {
+            SRV_LOG_INFO("✅ ASIGNACIÓN ÓPTIMA: Ascensor disponible más cercano");
+        } else if (strstr(candidatos[best_index].estado, "COMPATIBLE")) {
+            SRV_LOG_INFO("🚀 ASIGNACIÓN INTELIGENTE: Ascensor compatible en ruta");
+        } else {
+            SRV_LOG_INFO("⏳ ASIGNACIÓN DIFERIDA: Ascensor ocupado, se asignará al terminar");
+        }
+    } else {
+        SRV_LOG_ERROR("🚫 ERROR CRÍTICO: No se pudo seleccionar ningún ascensor");
+    }
+
+    for (int i = 0; i < num_candidatos; i++) {
+        free(candidatos[i].id);
+        free(candidatos[i].estado);
+    }
+    free(candidatos);
+
+    return selected_id;
+}
+
+/**
+ * @brief Procesa el payload de una llamada de piso
+ * 
+ * @details Ver hnd_floor_call() en main.c para el formato JSON de la
+ * petición y de la respuesta.
+ * 
+ * @see select_optimal_elevator()
+ * @see generate_unique_task_id()
+ */
+void process_floor_call_payload(const uint8_t *data, size_t data_len, coap_pdu_t *response)
+{
+    if (data) {
+        SRV_LOG_DEBUG("Floor Call Payload: %.*s", (int)data_len, (char*)data);
+
+        cJSON *json_payload = cJSON_ParseWithLength((const char*)data, data_len);
+        if (!json_payload) {
+            SRV_LOG_ERROR("Error parsing JSON payload: %s", cJSON_GetErrorPtr());
+            coap_pdu_set_code(response, COAP_RESPONSE_CODE_BAD_REQUEST);
+            cJSON *error_json = cJSON_CreateObject();
+            cJSON_AddStringToObject(error_json, "error", "Invalid JSON payload");
+            cJSON_AddStringToObject(error_json, "details", cJSON_GetErrorPtr());
+            char *error_str = cJSON_PrintUnformatted(error_json);
+            coap_add_option(response, COAP_OPTION_CONTENT_FORMAT, coap_encode_var_safe( (uint8_t[2]){0}, 2, COAP_MEDIATYPE_APPLICATION_JSON), (uint8_t[2]){0});
+            coap_add_data(response, strlen(error_str), (const uint8_t*)error_str);
+            cJSON_Delete(error_json);
+            free(error_str);
+            return;
+        }
+
+        cJSON *j_id_edificio = cJSON_GetObjectItemCaseSensitive(json_payload, "id_edificio");
+        cJSON *j_piso_origen_llamada = cJSON_GetObjectItemCaseSensitive(json_payload, "piso_origen_llamada");
+        cJSON *j_direccion_llamada = cJSON_GetObjectItemCaseSensitive(json_payload, "direccion_llamada");
+        cJSON *j_elevadores_estado = cJSON_GetObjectItemCaseSensitive(json_payload, "elevadores_estado");
+
+        if (!cJSON_IsString(j_id_edificio) || !cJSON_IsNumber(j_piso_origen_llamada) ||
+            !cJSON_IsString(j_direccion_llamada) || !cJSON_IsArray(j_elevadores_estado)) {
+            SRV_LOG_ERROR("Missing or invalid fields in JSON payload for floor call (expected id_edificio, piso_origen_llamada, direccion_llamada, elevadores_estado).");
+            coap_pdu_set_code(response, COAP_RESPONSE_CODE_BAD_REQUEST);
+            cJSON *error_json = cJSON_CreateObject();
+            cJSON_AddStringToObject(error_json, "error", "Missing or invalid fields in JSON payload for floor call.");
+            cJSON_AddStringToObject(error_json, "expected_fields", "id_edificio (string), piso_origen_llamada (number), direccion_llamada (string), elevadores_estado (array)");
+            char *error_str = cJSON_PrintUnformatted(error_json);
+            coap_add_option(response, COAP_OPTION_CONTENT_FORMAT, coap_encode_var_safe( (uint8_t[2]){0}, 2, COAP_MEDIATYPE_APPLICATION_JSON), (uint8_t[2]){0});
+            coap_add_data(response, strlen(error_str), (const uint8_t*)error_str);
+            cJSON_Delete(error_json);
+            free(error_str);
+            cJSON_Delete(json_payload);
+            return;
+        }
+
+        char *id_edificio = j_id_edificio->valuestring;
+        int piso_origen = j_piso_origen_llamada->valueint;
+        char *direccion_llamada = j_direccion_llamada->valuestring;
+
+        // Validar rango de piso (asumiendo edificios de 1-50 pisos)
+        if (piso_origen < 1 || piso_origen > 50) {
+            SRV_LOG_ERROR("Invalid floor number: %d (must be between 1-50)", piso_origen);
+            coap_pdu_set_code(response, COAP_RESPONSE_CODE_BAD_REQUEST);
+            cJSON *error_json = cJSON_CreateObject();
+            cJSON_AddStringToObject(error_json, "error", "Invalid floor number");
+            cJSON_AddNumberToObject(error_json, "floor", piso_origen);
+            cJSON_AddStringToObject(error_json, "valid_range", "1-50");
+            char *error_str = cJSON_PrintUnformatted(error_json);
+            coap_add_option(response, COAP_OPTION_CONTENT_FORMAT, coap_encode_var_safe( (uint8_t[2]){0}, 2, COAP_MEDIATYPE_APPLICATION_JSON), (uint8_t[2]){0});
+            coap_add_data(response, strlen(error_str), (const uint8_t*)error_str);
+            cJSON_Delete(error_json);
+            free(error_str);
+            cJSON_Delete(json_payload);
+            return;
+        }
+
+        // Validar dirección de llamada
+        if (strcmp(direccion_llamada, "SUBIENDO") != 0 && strcmp(direccion_llamada, "BAJANDO") != 0) {
+            SRV_LOG_ERROR("Invalid call direction: %s (must be SUBIENDO or BAJANDO)", direccion_llamada);
+            coap_pdu_set_code(response, COAP_RESPONSE_CODE_BAD_REQUEST);
+            cJSON *error_json = cJSON_CreateObject();
+            cJSON_AddStringToObject(error_json, "error", "Invalid call direction");
+            cJSON_AddStringToObject(error_json, "direction", direccion_llamada);
+            cJSON_AddStringToObject(error_json, "valid_values", "SUBIENDO, BAJANDO");
+            char *error_str = cJSON_PrintUnformatted(error_json);
+            coap_add_option(response, COAP_OPTION_CONTENT_FORMAT, coap_encode_var_safe( (uint8_t[2]){0}, 2, COAP_MEDIATYPE_APPLICATION_JSON), (uint8_t[2]){0});
+            coap_add_data(response, strlen(error_str), (const uint8_t*)error_str);
+            cJSON_Delete(error_json);
+            free(error_str);
+            cJSON_Delete(json_payload);
+            return;
+        }
+
+        SRV_LOG_INFO("Floor call from Edificio '%s', Piso Origen Llamada %d, Direccion '%s'", id_edificio, piso_origen, direccion_llamada);
+
+        // Usar algoritmo de asignación inteligente mejorado
+        char *assigned_elevator_id = select_optimal_elevator(j_elevadores_estado, piso_origen, direccion_llamada);
+
+        if (assigned_elevator_id) {
+            char task_id[32];
+            generate_unique_task_id(task_id, sizeof(task_id));
+            
+            // Verificar que se pudo generar el task_id correctamente
+            if (strlen(task_id) == 0) {
+                SRV_LOG_ERROR("Internal error: Failed to generate task ID");
+                coap_pdu_set_code(response, COAP_RESPONSE_CODE_INTERNAL_ERROR);
+                cJSON *error_json = cJSON_CreateObject();
+                cJSON_AddStringToObject(error_json, "error", "Internal Server Error");
+                cJSON_AddStringToObject(error_json, "message", "Failed to generate task ID");
+                char *error_str = cJSON_PrintUnformatted(error_json);
+                coap_add_option(response, COAP_OPTION_CONTENT_FORMAT, coap_encode_var_safe( (uint8_t[2]){0}, 2, COAP_MEDIATYPE_APPLICATION_JSON), (uint8_t[2]){0});
+                coap_add_data(response, strlen(error_str), (const uint8_t*)error_str);
+                cJSON_Delete(error_json);
+                free(error_str);
+                free(assigned_elevator_id);
+                cJSON_Delete(json_payload);
+                return;
+            }
+            
+            SRV_LOG_INFO("Assigning task %s to elevator %s for floor call from piso %d (Edificio: %s)", 
+                        task_id, assigned_elevator_id, piso_origen, id_edificio);
+
+            cJSON *response_json = cJSON_CreateObject();
+            cJSON_AddStringToObject(response_json, "tarea_id", task_id);
+            cJSON_AddStringToObject(response_json, "ascensor_asignado_id", assigned_elevator_id);
+
+            char *response_str = cJSON_PrintUnformatted(response_json);
+            if (!response_str) {
+                SRV_LOG_ERROR("Internal error: Failed to create JSON response");
+                coap_pdu_set_code(response, COAP_RESPONSE_CODE_INTERNAL_ERROR);
+                cJSON *error_json = cJSON_CreateObject();
+                cJSON_AddStringToObject(error_json, "error", "Internal Server Error");
+                cJSON_AddStringToObject(error_json, "message", "Failed to create response");
+                char *error_str = cJSON_PrintUnformatted(error_json);
+                coap_add_option(response, COAP_OPTION_CONTENT_FORMAT, coap_encode_var_safe( (uint8_t[2]){0}, 2, COAP_MEDIATYPE_APPLICATION_JSON), (uint8_t[2]){0});
+                coap_add_data(response, strlen(error_str), (const uint8_t*)error_str);
+                cJSON_Delete(error_json);
+                free(error_str);
+                cJSON_Delete(response_json);
+                free(assigned_elevator_id);
+                cJSON_Delete(json_payload);
+                return;
+            }
+            
+            coap_pdu_set_code(response, COAP_RESPONSE_CODE_CONTENT);
+            coap_add_option(response, COAP_OPTION_CONTENT_FORMAT, coap_encode_var_safe( (uint8_t[2]){0}, 2, COAP_MEDIATYPE_APPLICATION_JSON), (uint8_t[2]){0});
+            coap_add_data(response, strlen(response_str), (const uint8_t *)response_str);
+
+            cJSON_Delete(response_json);
+            free(response_str);
+            free(assigned_elevator_id);
+        } else {
+            SRV_LOG_WARN("No elevators available for floor call from edificio '%s', piso %d", id_edificio, piso_origen);
+            coap_pdu_set_code(response, COAP_RESPONSE_CODE_SERVICE_UNAVAILABLE);
+            cJSON *error_json = cJSON_CreateObject();
+            cJSON_AddStringToObject(error_json, "error", "No elevators available at the moment.");
+            cJSON_AddStringToObject(error_json, "edificio", id_edificio);
+            cJSON_AddNumberToObject(error_json, "piso_origen", piso_origen);
+            cJSON_AddStringToObject(error_json, "suggestion", "Try again in a few moments");
+            char *error_str = cJSON_PrintUnformatted(error_json);
+            coap_add_option(response, COAP_OPTION_CONTENT_FORMAT, coap_encode_var_safe( (uint8_t[2]){0}, 2, COAP_MEDIATYPE_APPLICATION_JSON), (uint8_t[2]){0});
+            coap_add_data(response, strlen(error_str), (const uint8_t*)error_str);
+            cJSON_Delete(error_json);
+            free(error_str);
+        }
+        cJSON_Delete(json_payload);
+
+    } else {
+        SRV_LOG_ERROR("Received floor call request with no payload.");
+        coap_pdu_set_code(response, COAP_RESPONSE_CODE_BAD_REQUEST);
+        cJSON *error_json = cJSON_CreateObject();
+        cJSON_AddStringToObject(error_json, "error", "Missing payload for floor call request.");
+        char *error_str = cJSON_PrintUnformatted(error_json);
+        coap_add_option(response, COAP_OPTION_CONTENT_FORMAT, coap_encode_var_safe( (uint8_t[2]){0}, 2, COAP_MEDIATYPE_APPLICATION_JSON), (uint8_t[2]){0});
+        coap_add_data(response, strlen(error_str), (const uint8_t*)error_str);
+        cJSON_Delete(error_json);
+        free(error_str);
+    }
+}
+
+/**
+ * @brief Procesa el payload de una petición de cabina
+ * 
+ * @details Ver hnd_cabin_request() en main.c para el formato JSON de la
+ * petición y de la respuesta.
+ * 
+ * @see generate_unique_task_id()
+ */
+void process_cabin_request_payload(const uint8_t *data, size_t data_len, coap_pdu_t *response)
+{
+    if (data) {
+        SRV_LOG_DEBUG("Cabin Request Payload: %.*s", (int)data_len, (char*)data);
+
+        cJSON *json_payload = cJSON_ParseWithLength((const char*)data, data_len);
+        if (!json_payload) {
+            SRV_LOG_ERROR("Error parsing JSON payload for cabin request: %s", cJSON_GetErrorPtr());
+            coap_pdu_set_code(response, COAP_RESPONSE_CODE_BAD_REQUEST);
+            cJSON *error_json = cJSON_CreateObject();
+            cJSON_AddStringToObject(error_json, "error", "Invalid JSON payload for cabin request");
+            cJSON_AddStringToObject(error_json, "details", cJSON_GetErrorPtr());
+            char *error_str = cJSON_PrintUnformatted(error_json);
+            coap_add_option(response, COAP_OPTION_CONTENT_FORMAT, coap_encode_var_safe( (uint8_t[2]){0}, 2, COAP_MEDIATYPE_APPLICATION_JSON), (uint8_t[2]){0});
+            coap_add_data(response, strlen(error_str), (const uint8_t*)error_str);
+            cJSON_Delete(error_json);
+            free(error_str);
+            return;
+        }
+
+        cJSON *j_id_edificio = cJSON_GetObjectItemCaseSensitive(json_payload, "id_edificio");
+        cJSON *j_solicitando_ascensor_id = cJSON_GetObjectItemCaseSensitive(json_payload, "solicitando_ascensor_id");
+        cJSON *j_piso_destino_solicitud = cJSON_GetObjectItemCaseSensitive(json_payload, "piso_destino_solicitud");
+        cJSON *j_elevadores_estado = cJSON_GetObjectItemCaseSensitive(json_payload, "elevadores_estado");
+
+        if (!cJSON_IsString(j_id_edificio) || !cJSON_IsString(j_solicitando_ascensor_id) ||
+            !cJSON_IsNumber(j_piso_destino_solicitud) || !cJSON_IsArray(j_elevadores_estado)) {
+            SRV_LOG_ERROR("Missing or invalid fields in JSON payload for cabin request");
+            coap_pdu_set_code(response, COAP_RESPONSE_CODE_BAD_REQUEST);
+            cJSON *error_json = cJSON_CreateObject();
+            cJSON_AddStringToObject(error_json, "error", "Missing or invalid fields in JSON payload for cabin request");
+            cJSON_AddStringToObject(error_json, "expected_fields", "id_edificio (string), solicitando_ascensor_id (string), piso_destino_solicitud (number), elevadores_estado (array)");
+            char *error_str = cJSON_PrintUnformatted(error_json);
+            coap_add_option(response, COAP_OPTION_CONTENT_FORMAT, coap_encode_var_safe( (uint8_t[2]){0}, 2, COAP_MEDIATYPE_APPLICATION_JSON), (uint8_t[2]){0});
+            coap_add_data(response, strlen(error_str), (const uint8_t*)error_str);
+            cJSON_Delete(error_json);
+            free(error_str);
+            cJSON_Delete(json_payload);
+            return;
+        }
+
+        char *id_edificio = j_id_edificio->valuestring;
+        char *solicitando_ascensor_id = j_solicitando_ascensor_id->valuestring;
+        int piso_destino = j_piso_destino_solicitud->valueint;
+
+        // Validar rango de piso destino
+        if (piso_destino < 1 || piso_destino > 50) {
+            SRV_LOG_ERROR("Invalid destination floor: %d (must be between 1-50)", piso_destino);
+            coap_pdu_set_code(response, COAP_RESPONSE_CODE_BAD_REQUEST);
+            cJSON *error_json = cJSON_CreateObject();
+            cJSON_AddStringToObject(error_json, "error", "Invalid destination floor");
+            cJSON_AddNumberToObject(error_json, "destination_floor", piso_destino);
+            cJSON_AddStringToObject(error_json, "valid_range", "1-50");
+            char *error_str = cJSON_PrintUnformatted(error_json);
+            coap_add_option(response, COAP_OPTION_CONTENT_FORMAT, coap_encode_var_safe( (uint8_t[2]){0}, 2, COAP_MEDIATYPE_APPLICATION_JSON), (uint8_t[2]){0});
+            coap_add_data(response, strlen(error_str), (const uint8_t*)error_str);
+            cJSON_Delete(error_json);
+            free(error_str);
+            cJSON_Delete(json_payload);
+            return;
+        }
+
+        // Verificar que el ascensor solicitante existe en el array de estado
+        int ascensor_encontrado = 0;
+        int array_size = cJSON_GetArraySize(j_elevadores_estado);
+        for (int i = 0; i < array_size; i++) {
+            cJSON *elevator = cJSON_GetArrayItem(j_elevadores_estado, i);
+            if (elevator) {
+                cJSON *j_id_ascensor = cJSON_GetObjectItemCaseSensitive(elevator, "id_ascensor");
+                if (cJSON_IsString(j_id_ascensor) && 
+                    strcmp(j_id_ascensor->valuestring, solicitando_ascensor_id) == 0) {
+                    ascensor_encontrado = 1;
+                    break;
+                }
+            }
+        }
+
+        if (!ascensor_encontrado) {
+            SRV_LOG_ERROR("Requesting elevator '%s' not found in elevators state array", solicitando_ascensor_id);
+            coap_pdu_set_code(response, COAP_RESPONSE_CODE_BAD_REQUEST);
+            cJSON *error_json = cJSON_CreateObject();
+            cJSON_AddStringToObject(error_json, "error", "Requesting elevator not found");
+            cJSON_AddStringToObject(error_json, "elevator_id", solicitando_ascensor_id);
+            cJSON_AddStringToObject(error_json, "message", "Elevator must exist in elevators_estado array");
+            char *error_str = cJSON_PrintUnformatted(error_json);
+            coap_add_option(response, COAP_OPTION_CONTENT_FORMAT, coap_encode_var_safe( (uint8_t[2]){0}, 2, COAP_MEDIATYPE_APPLICATION_JSON), (uint8_t[2]){0});
+            coap_add_data(response, strlen(error_str), (const uint8_t*)error_str);
+            cJSON_Delete(error_json);
+            free(error_str);
+            cJSON_Delete(json_payload);
+            return;
+        }
+
+        SRV_LOG_INFO("Cabin request from Edificio '%s', Ascensor '%s', Destino %d", 
+                    id_edificio, solicitando_ascensor_id, piso_destino);
+
+        // Para solicitudes de cabina, el ascensor se auto-asigna
+        char task_id[32];
+        generate_unique_task_id(task_id, sizeof(task_id));
+        
+        if (strlen(task_id) == 0) {
+            SRV_LOG_ERROR("Internal error: Failed to generate task ID for cabin request");
+            coap_pdu_set_code(response, COAP_RESPONSE_CODE_INTERNAL_ERROR);
+            cJSON *error_json = cJSON_CreateObject();
+            cJSON_AddStringToObject(error_json, "error", "Internal Server Error");
+            cJSON_AddStringToObject(error_json, "message", "Failed to generate task ID");
+            char *error_str = cJSON_PrintUnformatted(error_json);
+            coap_add_option(response, COAP_OPTION_CONTENT_FORMAT, coap_encode_var_safe( (uint8_t[2]){0}, 2, COAP_MEDIATYPE_APPLICATION_JSON), (uint8_t[2]){0});
+            coap_add_data(response, strlen(error_str), (const uint8_t*)error_str);
+            cJSON_Delete(error_json);
+            free(error_str);
+            cJSON_Delete(json_payload);
+            return;
+        }
+
+        SRV_LOG_INFO("Self-assigning task %s to elevator %s for cabin request to floor %d", 
+                    task_id, solicitando_ascensor_id, piso_destino);
+
+        cJSON *response_json = cJSON_CreateObject();
+        cJSON_AddStringToObject(response_json, "tarea_id", task_id);
+        cJSON_AddStringToObject(response_json, "ascensor_asignado_id", solicitando_ascensor_id);
+
+        char *response_str = cJSON_PrintUnformatted(response_json);
+        if (!response_str) {
+            SRV_LOG_ERROR("Internal error: Failed to create JSON response for cabin request");
+            coap_pdu_set_code(response, COAP_RESPONSE_CODE_INTERNAL_ERROR);
+            cJSON *error_json = cJSON_CreateObject();
+            cJSON_AddStringToObject(error_json, "error", "Internal Server Error");
+            cJSON_AddStringToObject(error_json, "message", "Failed to create response");
+            char *error_str = cJSON_PrintUnformatted(error_json);
+            coap_add_option(response, COAP_OPTION_CONTENT_FORMAT, coap_encode_var_safe( (uint8_t[2]){0}, 2, COAP_MEDIATYPE_APPLICATION_JSON), (uint8_t[2]){0});
+            coap_add_data(response, strlen(error_str), (const uint8_t*)error_str);
+            cJSON_Delete(error_json);
+            free(error_str);
+            cJSON_Delete(response_json);
+            cJSON_Delete(json_payload);
+            return;
+        }
+        
+        coap_pdu_set_code(response, COAP_RESPONSE_CODE_CONTENT);
+        coap_add_option(response, COAP_OPTION_CONTENT_FORMAT, coap_encode_var_safe( (uint8_t[2]){0}, 2, COAP_MEDIATYPE_APPLICATION_JSON), (uint8_t[2]){0});
+        coap_add_data(response, strlen(response_str), (const uint8_t *)response_str);
+
+        cJSON_Delete(response_json);
+        free(response_str);
+        cJSON_Delete(json_payload);
+
+    } else {
+        SRV_LOG_ERROR("Received cabin request with no payload");
+        coap_pdu_set_code(response, COAP_RESPONSE_CODE_BAD_REQUEST);
+        cJSON *error_json = cJSON_CreateObject();
+        cJSON_AddStringToObject(error_json, "error", "Missing payload for cabin request");
+        char *error_str = cJSON_PrintUnformatted(error_json);
+        coap_add_option(response, COAP_OPTION_CONTENT_FORMAT, coap_encode_var_safe( (uint8_t[2]){0}, 2, COAP_MEDIATYPE_APPLICATION_JSON), (uint8_t[2]){0});
+        coap_add_data(response, strlen(error_str), (const uint8_t*)error_str);
+        cJSON_Delete(error_json);
+        free(error_str);
+    }
+}
@@ -9,6 +9,7 @@ static int sent_frame_count = 0;
 static simulated_can_frame_t received_frames[MAX_MOCK_CAN_FRAMES];
 static int received_frame_count = 0;
 static bool can_should_fail = false;
+static int central_session_requests = 0;
 
 // Mock de la variable global managed_elevator_group
 elevator_group_state_t managed_elevator_group;
@@ -16,6 +17,7 @@ elevator_group_state_t managed_elevator_group;
 // Mock de la función get_or_create_central_server_dtls_session
 coap_session_t* get_or_create_central_server_dtls_session(coap_context_t *ctx) {
     // Para las pruebas, simplemente retornamos un puntero mock
+    central_session_requests++;
     return (coap_session_t*)0x12345678; // Puntero mock
 }
 
@@ -54,23 +56,14 @@ void mock_can_reset(void) {
     sent_frame_count = 0;
     received_frame_count = 0;
     can_should_fail = false;
+    central_session_requests = 0;
     
-    // Inicializar el mock del grupo de ascensores
-    memset(&managed_elevator_group, 0, sizeof(elevator_group_state_t));
-    strcpy(managed_elevator_group.edificio_id_str_grupo, "E1");
-    managed_elevator_group.num_elevadores_en_grupo = 4;
+    // Inicializar el mock del grupo de ascensores (4 ascensores E1A1..E1A4)
+    init_elevator_group(&managed_elevator_group, "E1", 4, 14);
     
-    // Inicializar ascensores mock
-    for (int i = 0; i < 4; i++) {
-        elevator_status_t *elevator = &managed_elevator_group.ascensores[i];
-        snprintf(elevator->ascensor_id, sizeof(elevator->ascensor_id), "E1A%d", i + 1);
-        snprintf(elevator->id_edificio_str, sizeof(elevator->id_edificio_str), "E1");
-        elevator->piso_actual = 1;
-        elevator->ocupado = false;
-        elevator->estado_puerta_enum = DOOR_CLOSED;
-        elevator->direccion_movimiento_enum = STOPPED;
-        elevator->destino_actual = -1;
-        strcpy(elevator->tarea_actual_id, "");
+    // Ascensores mock parados en el piso 1
+    for (int i = 0; i < managed_elevator_group.num_elevadores_en_grupo; i++) {
+        managed_elevator_group.piso_actual[i] = 1;
     }
 }
 
@@ -100,6 +93,10 @@ int mock_can_get_received_frame_count(void) {
     return received_frame_count;
 }
 
+int mock_can_get_central_request_count(void) {
+    return central_session_requests;
+}
+
 // Funciones helper para crear frames de prueba
 simulated_can_frame_t mock_can_create_floor_call_frame(int floor, int direction) {
     simulated_can_frame_t frame = {
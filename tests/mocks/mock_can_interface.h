@@ -27,6 +27,7 @@ void mock_can_queue_received_frame(simulated_can_frame_t* frame);
 simulated_can_frame_t* mock_can_get_sent_frame(int index);
 int mock_can_get_sent_frame_count(void);
 int mock_can_get_received_frame_count(void);
+int mock_can_get_central_request_count(void); // Sesiones pedidas al servidor central
 
 // Funciones helper para crear frames de prueba
 simulated_can_frame_t mock_can_create_floor_call_frame(int floor, int direction);
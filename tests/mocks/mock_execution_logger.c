@@ -62,10 +62,13 @@ void exec_logger_log_coap_sent(const char* message) {
 
 /**
  * @brief Mock implementation for exec_logger_log_coap_received
- * @param message Message received
+ * @param code Raw CoAP response code
+ * @param payload Response payload (not NUL-terminated)
+ * @param payload_len Payload length in bytes
  */
-void exec_logger_log_coap_received(const char* message) {
-    printf("[MOCK] CoAP received: %s\n", message ? message : "NULL");
+void exec_logger_log_coap_received(unsigned int code, const uint8_t *payload, size_t payload_len) {
+    printf("[MOCK] CoAP received: %u.%02u, %.*s\n", (code >> 5) & 0x7u, code & 0x1Fu,
+           (int)payload_len, payload ? (const char *)payload : "");
 }
 
 /**
@@ -102,4 +105,31 @@ void exec_logger_log(const char* format, ...) {
     vprintf(format, args);
     printf("\n");
     va_end(args);
-} 
\ No newline at end of file
+} 
+
+/**
+ * @brief Spans recorded per gw_span_outcome_t
+ */
+static int span_counts[GW_SPAN_OUTCOME_LOCAL + 1];
+
+/**
+ * @brief Mock implementation for exec_logger_record_request_span
+ * @param span Timestamps of the completed request
+ * @param outcome How the request ended
+ */
+void exec_logger_record_request_span(const gw_request_span_t *span, gw_span_outcome_t outcome) {
+    printf("[MOCK] Request span: %s (outcome %d)\n", span ? "recorded" : "NULL", (int)outcome);
+    if (span && outcome >= GW_SPAN_OUTCOME_SERVED && outcome <= GW_SPAN_OUTCOME_LOCAL) {
+        span_counts[outcome]++;
+    }
+}
+
+int mock_exec_logger_span_count(gw_span_outcome_t outcome) {
+    return (outcome >= GW_SPAN_OUTCOME_SERVED && outcome <= GW_SPAN_OUTCOME_LOCAL) ? span_counts[outcome] : 0;
+}
+
+void mock_exec_logger_reset_spans(void) {
+    for (int i = 0; i <= GW_SPAN_OUTCOME_LOCAL; i++) {
+        span_counts[i] = 0;
+    }
+}
@@ -11,6 +11,10 @@
 #ifndef MOCK_EXECUTION_LOGGER_H
 #define MOCK_EXECUTION_LOGGER_H
 
+#include <stddef.h>
+#include <stdint.h>
+#include "api_gateway/request_span.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -47,9 +51,11 @@ void exec_logger_log_coap_sent(const char* message);
 
 /**
  * @brief Mock implementation for exec_logger_log_coap_received
- * @param message Message received
+ * @param code Raw CoAP response code
+ * @param payload Response payload (not NUL-terminated)
+ * @param payload_len Payload length in bytes
  */
-void exec_logger_log_coap_received(const char* message);
+void exec_logger_log_coap_received(unsigned int code, const uint8_t *payload, size_t payload_len);
 
 /**
  * @brief Mock implementation for exec_logger_log_floor_call
@@ -72,6 +78,24 @@ void exec_logger_log_cabin_request(const char* elevator_id, int target_floor);
  */
 void exec_logger_log(const char* format, ...);
 
+/**
+ * @brief Mock implementation for exec_logger_record_request_span
+ * @param span Timestamps of the completed request
+ * @param outcome How the request ended
+ */
+void exec_logger_record_request_span(const gw_request_span_t *span, gw_span_outcome_t outcome);
+
+/**
+ * @brief Number of spans recorded with the given outcome since the last reset
+ * @param outcome Outcome to count
+ */
+int mock_exec_logger_span_count(gw_span_outcome_t outcome);
+
+/**
+ * @brief Clears the recorded span counters
+ */
+void mock_exec_logger_reset_spans(void);
+
 #ifdef __cplusplus
 }
 #endif
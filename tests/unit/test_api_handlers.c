@@ -330,7 +330,7 @@ void test_elevator_state_integration(void) {
     char test_details[512] = "Integración con estado de ascensores fallida";
     
     // Inicializar grupo de ascensores para la prueba
-    elevator_group_state_t test_group;
+    elevator_group_state_t test_group = {0};
     init_elevator_group(&test_group, "EDIFICIO_TEST", 2, 10);  // 2 ascensores, 10 pisos
     
     // Verificar inicialización básica
@@ -338,8 +338,8 @@ void test_elevator_state_integration(void) {
     CU_ASSERT_STRING_EQUAL(test_group.edificio_id_str_grupo, "EDIFICIO_TEST");
     
     // Verificar que los ascensores se inicializaron
-    CU_ASSERT_STRING_NOT_EQUAL(test_group.ascensores[0].ascensor_id, "");
-    CU_ASSERT_STRING_EQUAL(test_group.ascensores[0].id_edificio_str, "EDIFICIO_TEST");
+    CU_ASSERT_STRING_NOT_EQUAL(test_group.ids[0].ascensor_id, "");
+    CU_ASSERT_EQUAL(strncmp(test_group.ids[0].ascensor_id, "EDIFICIO_TEST", strlen("EDIFICIO_TEST")), 0);
     
     // Crear detalles de solicitud para JSON
     api_request_details_for_json_t details;
@@ -373,6 +373,8 @@ void test_elevator_state_integration(void) {
                      "Verifica la correcta integración con el sistema de gestión de estado de ascensores",
                      test_passed,
                      test_details);
+
+    elevator_group_destroy(&test_group);
 }
 
 // ============================================================================
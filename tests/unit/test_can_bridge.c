@@ -12,6 +12,7 @@
  * - Recepción de tramas CAN
  * - Manejo de errores de comunicación
  * - Procesamiento de múltiples tramas
+ * - Pulsaciones repetidas de llamadas de piso (pendientes y asignadas)
  * - Validación de datos de tramas
  * 
  * @see can_bridge.h
@@ -26,7 +27,10 @@
 #include <time.h>
 
 #include "api_gateway/can_bridge.h"
+#include "api_gateway/building_registry.h"
+#include "api_gateway/hall_call_registry.h"
 #include "../mocks/mock_can_interface.h"
+#include "../mocks/mock_execution_logger.h"
 
 /**
  * @brief Variable global para el estado del setup de la suite
@@ -36,6 +40,14 @@
  */
 static FILE *report_file = NULL;
 
+/**
+ * @brief Contexto CoAP ficticio: el puente solo comprueba que no sea nulo
+ *
+ * Las pulsaciones repetidas nunca llegan a usarlo; si una prueba contactara
+ * al servidor central, lo detecta mock_can_get_central_request_count().
+ */
+static coap_context_t *const mock_coap_ctx = (coap_context_t *)0x12345678;
+
 /**
  * @brief Función de setup para la suite de pruebas del puente CAN
  * @return 0 si el setup es exitoso, código de error en caso contrario
@@ -347,6 +359,118 @@ void test_multiple_frame_reception(void) {
     CU_ASSERT_FALSE(mock_can_receive_frame(&received_frame)); // Cola vacía
 }
 
+// Test: Pulsación repetida de una llamada pendiente en el servidor central
+void test_floor_call_absorbed_while_pending(void) {
+    char details[512];
+    bool test_passed = true;
+
+    mock_can_reset(); // Grupo E1 con 4 ascensores en el piso 1, sin frames previos
+    ag_can_bridge_init();
+    ag_can_bridge_register_send_callback(mock_can_send_frame);
+    gw_hall_call_table_t *hall_calls = gw_building_hall_calls(GW_BUILDING_INDEX_DEFAULT);
+    gw_hall_call_table_reset(hall_calls);
+    gw_hall_call_mark_pending(hall_calls, 5, MOVING_UP);
+
+    simulated_can_frame_t frame = mock_can_create_floor_call_frame(5, 0); // Piso 5, UP
+    ag_can_bridge_process_incoming_frame(&frame, mock_coap_ctx);
+
+    int sent_count = mock_can_get_sent_frame_count();
+    simulated_can_frame_t *ack = mock_can_get_sent_frame(0);
+    int central_requests = mock_can_get_central_request_count();
+
+    if (central_requests != 0) {
+        test_passed = false;
+        snprintf(details, sizeof(details), "Solicitudes al servidor central: esperado 0, obtenido %d", central_requests);
+    } else if (sent_count != 1 || !ack) {
+        test_passed = false;
+        snprintf(details, sizeof(details), "Frames enviados al bus: esperado 1, obtenido %d", sent_count);
+    } else if (ack->id != 0x101 || ack->dlc != 1 || ack->data[0] != GW_CAN_ELEVATOR_PENDING) {
+        test_passed = false;
+        snprintf(details, sizeof(details), "Acuse incorrecto: ID=0x%X, DLC=%d, data[0]=0x%02X",
+                 ack->id, ack->dlc, ack->data[0]);
+    } else {
+        snprintf(details, sizeof(details), "Pulsación absorbida con acuse 0x101 pendiente y sin solicitud al servidor central");
+    }
+
+    write_test_result("test_floor_call_absorbed_while_pending",
+                     "Verifica que una pulsación repetida de una llamada pendiente se acusa sin contactar al servidor central",
+                     test_passed, details);
+
+    CU_ASSERT_EQUAL(central_requests, 0);
+    CU_ASSERT_EQUAL(sent_count, 1);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(ack);
+    CU_ASSERT_EQUAL(ack->id, 0x101);
+    CU_ASSERT_EQUAL(ack->dlc, 1);
+    CU_ASSERT_EQUAL(ack->data[0], GW_CAN_ELEVATOR_PENDING);
+    CU_ASSERT_EQUAL(hall_calls->coalesced_pending, 1);
+
+    ag_can_bridge_register_send_callback(NULL);
+}
+
+// Test: Pulsación repetida de una llamada ya asignada
+void test_floor_call_answered_when_assigned(void) {
+    char details[512];
+    bool test_passed = true;
+
+    mock_can_reset(); // Grupo E1 con 4 ascensores en el piso 1, sin frames previos
+    mock_exec_logger_reset_spans();
+    ag_can_bridge_init();
+    ag_can_bridge_register_send_callback(mock_can_send_frame);
+    gw_hall_call_table_t *hall_calls = gw_building_hall_calls(GW_BUILDING_INDEX_DEFAULT);
+    gw_hall_call_table_reset(hall_calls);
+
+    // E1A2 (índice 1) va hacia el piso 7 con la tarea T_42
+    managed_elevator_group.ocupado[1] = true;
+    managed_elevator_group.destino_actual[1] = 7;
+    snprintf(managed_elevator_group.ids[1].tarea_actual_id, sizeof(managed_elevator_group.ids[1].tarea_actual_id), "T_42");
+    gw_hall_call_mark_pending(hall_calls, 7, MOVING_DOWN);
+    gw_hall_call_resolve(hall_calls, &managed_elevator_group, 7, MOVING_DOWN,
+                         managed_elevator_group.ids[1].ascensor_id);
+
+    simulated_can_frame_t frame = mock_can_create_floor_call_frame(7, 1); // Piso 7, DOWN
+    ag_can_bridge_process_incoming_frame(&frame, mock_coap_ctx);
+
+    int sent_count = mock_can_get_sent_frame_count();
+    simulated_can_frame_t *response = mock_can_get_sent_frame(0);
+    int central_requests = mock_can_get_central_request_count();
+    int local_spans = mock_exec_logger_span_count(GW_SPAN_OUTCOME_LOCAL);
+
+    if (central_requests != 0) {
+        test_passed = false;
+        snprintf(details, sizeof(details), "Solicitudes al servidor central: esperado 0, obtenido %d", central_requests);
+    } else if (sent_count != 1 || !response) {
+        test_passed = false;
+        snprintf(details, sizeof(details), "Frames enviados al bus: esperado 1, obtenido %d", sent_count);
+    } else if (response->id != 0x101 || response->dlc != 5 || response->data[0] != 1 ||
+               memcmp(&response->data[1], "T_42", 4) != 0) {
+        test_passed = false;
+        snprintf(details, sizeof(details), "Respuesta incorrecta: ID=0x%X, DLC=%d, data[0]=%d",
+                 response->id, response->dlc, response->data[0]);
+    } else if (local_spans != 1) {
+        test_passed = false;
+        snprintf(details, sizeof(details), "Spans de respuesta local: esperado 1, obtenido %d", local_spans);
+    } else {
+        snprintf(details, sizeof(details), "Pulsación respondida localmente con E1A2 (tarea T_42)");
+    }
+
+    write_test_result("test_floor_call_answered_when_assigned",
+                     "Verifica que una pulsación repetida de una llamada asignada se responde con la asignación existente",
+                     test_passed, details);
+
+    CU_ASSERT_EQUAL(central_requests, 0);
+    CU_ASSERT_EQUAL(sent_count, 1);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(response);
+    CU_ASSERT_EQUAL(response->id, 0x101);
+    CU_ASSERT_EQUAL(response->dlc, 5);
+    CU_ASSERT_EQUAL(response->data[0], 1);
+    CU_ASSERT_EQUAL(memcmp(&response->data[1], "T_42", 4), 0);
+    CU_ASSERT_EQUAL(hall_calls->answered_locally, 1);
+    CU_ASSERT_EQUAL(local_spans, 1);
+    CU_ASSERT_EQUAL(mock_exec_logger_span_count(GW_SPAN_OUTCOME_SERVED), 0);
+
+    ag_can_bridge_register_send_callback(NULL);
+}
+
 // Función para cerrar el archivo de reporte
 void close_report_file(void) {
     if (report_file) {
@@ -375,7 +499,11 @@ CU_pSuite add_can_bridge_tests(void) {
         CU_add_test(suite, "test_can_send_error_handling", 
                     test_can_send_error_handling) == NULL ||
         CU_add_test(suite, "test_multiple_frame_reception", 
-                    test_multiple_frame_reception) == NULL) {
+                    test_multiple_frame_reception) == NULL ||
+        CU_add_test(suite, "test_floor_call_absorbed_while_pending",
+                    test_floor_call_absorbed_while_pending) == NULL ||
+        CU_add_test(suite, "test_floor_call_answered_when_assigned",
+                    test_floor_call_answered_when_assigned) == NULL) {
         return NULL;
     }
     
@@ -0,0 +1,436 @@
+/**
+ * @file test_elevator_kinematics.c
+ * @brief Pruebas unitarias para la simulación cinemática de las cabinas
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Este archivo contiene las pruebas unitarias para verificar el modelo
+ * cinemático de elevator_kinematics.c, incluyendo:
+ * - Tiempo de viaje del perfil trapezoidal y triangular
+ * - Límites de velocidad y aceleración en cada paso
+ * - Ciclo de puertas y espera a puertas cerradas antes de arrancar
+ * - Independencia del paso fijo respecto a la cadencia de llamadas
+ * - Cambios de piso externos (frames 0x300) con la cabina en marcha
+ *
+ * @see elevator_kinematics.h
+ * @see api_gateway/elevator_kinematics.c
+ */
+
+#include <CUnit/CUnit.h>
+#include <CUnit/Basic.h>
+#include <CUnit/Automated.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "api_gateway/elevator_kinematics.h"
+#include "api_gateway/building_registry.h"
+
+#define TEST_DT_MS 50
+
+static FILE *report_file = NULL;
+
+/**
+ * @brief Parámetros del modelo usados en las pruebas
+ */
+static gw_sim_params_t test_params(void) {
+    gw_sim_params_t params = {
+        .speed_mps = 2.0,
+        .acceleration_mps2 = 1.0,
+        .floor_height_m = 3.0,
+        .door_open_ms = 1000,
+        .door_dwell_ms = 2000,
+        .door_close_ms = 1500,
+    };
+    return params;
+}
+
+/**
+ * @brief Registra un edificio de prueba y devuelve su grupo
+ */
+static elevator_group_state_t* setup_building(int num_elevadores) {
+    gw_building_registry_init();
+    gw_kinematics_init();
+    int index = gw_building_add("E1", num_elevadores, 30);
+    return index >= 0 ? gw_building_get((uint16_t)index) : NULL;
+}
+
+/**
+ * @brief Simula hasta que el ascensor queda libre
+ * @return Milisegundos simulados, o -1 si no llega en @p max_ms
+ */
+static long run_until_idle(elevator_group_state_t *group, int elevator, const gw_sim_params_t *params, long max_ms) {
+    for (long t = 0; t <= max_ms; t += TEST_DT_MS) {
+        if (!group->ocupado[elevator]) {
+            return t;
+        }
+        gw_kinematics_step_group(group, params, TEST_DT_MS, 1);
+    }
+    return -1;
+}
+
+/**
+ * @brief Función de setup para la suite de pruebas cinemáticas
+ * @return 0 si el setup es exitoso
+ */
+int setup_elevator_kinematics_tests(void) {
+    if (!report_file) {
+        report_file = fopen("test_elevator_kinematics_report.txt", "w");
+        if (report_file) {
+            time_t now = time(NULL);
+            fprintf(report_file, "=== REPORTE DE PRUEBAS: SIMULACIÓN CINEMÁTICA ===\n");
+            fprintf(report_file, "Fecha: %s\n", ctime(&now));
+            fprintf(report_file, "=================================================\n\n");
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Función de teardown para la suite de pruebas cinemáticas
+ * @return 0 si el teardown es exitoso
+ */
+int teardown_elevator_kinematics_tests(void) {
+    gw_kinematics_cleanup();
+    gw_building_registry_cleanup();
+    return 0;
+}
+
+/**
+ * @brief Escribe el resultado de una prueba individual al archivo de reporte
+ * @param test_name Nombre de la prueba ejecutada
+ * @param description Descripción de lo que verifica la prueba
+ * @param passed Indica si la prueba pasó (true) o falló (false)
+ * @param details Detalles específicos del resultado de la prueba
+ */
+void write_test_result(const char* test_name, const char* description, bool passed, const char* details) {
+    if (report_file) {
+        fprintf(report_file, "PRUEBA: %s\n", test_name);
+        fprintf(report_file, "Descripción: %s\n", description);
+        fprintf(report_file, "Resultado: %s\n", passed ? "PASÓ" : "FALLÓ");
+        if (details) {
+            fprintf(report_file, "Detalles: %s\n", details);
+        }
+        fprintf(report_file, "----------------------------------------\n\n");
+        fflush(report_file);
+    }
+}
+
+// Test: Los tiempos de viaje siguen el perfil trapezoidal o triangular
+void test_kinematics_travel_time_matches_profile(void) {
+    char details[256];
+    gw_sim_params_t params = test_params();
+    elevator_group_state_t *group = setup_building(2);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(group);
+
+    // Viaje largo (10 pisos, 30 m): alcanza la velocidad nominal
+    assign_task_to_elevator(group, "E1A1", "T_LARGO", 10, 0);
+    long long_ms = run_until_idle(group, 0, &params, 60000);
+    double long_expected = gw_kinematics_travel_time_ms(&params, 10);
+
+    // Viaje corto (1 piso, 3 m): perfil triangular
+    assign_task_to_elevator(group, "E1A2", "T_CORTO", 1, 0);
+    uint8_t door_after_long = group->estado_puerta[0];
+    long short_ms = run_until_idle(group, 1, &params, 60000);
+    double short_expected = gw_kinematics_travel_time_ms(&params, 1);
+
+    bool passed = long_ms >= 0 && fabs(long_ms - long_expected) <= 2 * TEST_DT_MS &&
+                  short_ms >= 0 && fabs(short_ms - short_expected) <= 2 * TEST_DT_MS &&
+                  group->piso_actual[0] == 10 && group->piso_actual[1] == 1;
+    snprintf(details, sizeof(details), "10 pisos: %ld ms (teórico %.0f), 1 piso: %ld ms (teórico %.0f)",
+             long_ms, long_expected, short_ms, short_expected);
+    write_test_result("test_kinematics_travel_time_matches_profile",
+                     "Verifica los tiempos de viaje frente al perfil teórico",
+                     passed, details);
+
+    CU_ASSERT(long_ms >= 0);
+    CU_ASSERT(fabs(long_ms - long_expected) <= 2 * TEST_DT_MS);
+    CU_ASSERT_DOUBLE_EQUAL(long_expected, 17000.0, 1.0); // 30/2 + 2/1 s
+    CU_ASSERT(short_ms >= 0);
+    CU_ASSERT(fabs(short_ms - short_expected) <= 2 * TEST_DT_MS);
+    CU_ASSERT_EQUAL(group->piso_actual[0], 10);
+    CU_ASSERT_EQUAL(group->piso_actual[1], 1);
+    CU_ASSERT_EQUAL(door_after_long, DOOR_OPENING);
+}
+
+// Test: Ni la velocidad ni la aceleración superan los límites; el piso avanza de uno en uno
+void test_kinematics_respects_limits(void) {
+    char details[256];
+    gw_sim_params_t params = test_params();
+    elevator_group_state_t *group = setup_building(1);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(group);
+
+    assign_task_to_elevator(group, "E1A1", "T_LIMITES", 12, 0);
+    double max_speed = 0.0, max_accel = 0.0, prev_v = 0.0;
+    int prev_floor = 0, floor_jumps = 0, steps = 0;
+    gw_car_motion_t car;
+    while (group->ocupado[0] && steps < 2000) {
+        gw_kinematics_step_group(group, &params, TEST_DT_MS, 1);
+        steps++;
+        if (!gw_kinematics_get_car(group->building_index, 0, &car)) break;
+        max_speed = fmax(max_speed, fabs(car.velocity_mps));
+        double accel = fabs(car.velocity_mps - prev_v) / (TEST_DT_MS / 1000.0);
+        max_accel = fmax(max_accel, accel);
+        prev_v = car.velocity_mps;
+        if (abs(group->piso_actual[0] - prev_floor) > 1) floor_jumps++;
+        prev_floor = group->piso_actual[0];
+    }
+
+    bool passed = !group->ocupado[0] && max_speed <= params.speed_mps + 1e-9 &&
+                  max_accel <= params.acceleration_mps2 + 1e-9 && floor_jumps == 0 &&
+                  fabs(car.position_m - 36.0) < 1e-9;
+    snprintf(details, sizeof(details), "Velocidad máx %.3f m/s, aceleración máx %.3f m/s², saltos %d, posición %.3f m",
+             max_speed, max_accel, floor_jumps, car.position_m);
+    write_test_result("test_kinematics_respects_limits",
+                     "Verifica velocidad, aceleración y nivelación en el destino",
+                     passed, details);
+
+    CU_ASSERT_FALSE(group->ocupado[0]);
+    CU_ASSERT(max_speed <= params.speed_mps + 1e-9);
+    CU_ASSERT(max_accel <= params.acceleration_mps2 + 1e-9);
+    CU_ASSERT_EQUAL(floor_jumps, 0);
+    CU_ASSERT_DOUBLE_EQUAL(car.position_m, 36.0, 1e-9);
+    CU_ASSERT_DOUBLE_EQUAL(car.velocity_mps, 0.0, 1e-12);
+}
+
+// Test: Ciclo de puertas completo; una tarea nueva espera a que cierren
+void test_kinematics_door_cycle_blocks_departure(void) {
+    char details[256];
+    gw_sim_params_t params = test_params();
+    elevator_group_state_t *group = setup_building(1);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(group);
+
+    // Tarea al piso actual: llega al instante y abre puertas
+    assign_task_to_elevator(group, "E1A1", "T_AQUI", 0, 0);
+    gw_kinematics_step_group(group, &params, TEST_DT_MS, 1);
+    bool completed_in_place = !group->ocupado[0] && group->estado_puerta[0] == DOOR_OPENING;
+
+    // Nueva tarea durante la espera con puertas abiertas
+    gw_kinematics_step_group(group, &params, TEST_DT_MS, (params.door_open_ms + 500) / TEST_DT_MS);
+    bool open_after_opening = group->estado_puerta[0] == DOOR_OPEN;
+    assign_task_to_elevator(group, "E1A1", "T_ARRIBA", 3, 0);
+
+    long closed_at = -1;
+    long elapsed = 0;
+    gw_car_motion_t car;
+    bool moved_with_doors_open = false;
+    while (elapsed < 20000 && group->ocupado[0]) {
+        gw_kinematics_step_group(group, &params, TEST_DT_MS, 1);
+        elapsed += TEST_DT_MS;
+        gw_kinematics_get_car(group->building_index, 0, &car);
+        if (car.velocity_mps != 0.0 && group->estado_puerta[0] != DOOR_CLOSED) moved_with_doors_open = true;
+        if (closed_at < 0 && group->estado_puerta[0] == DOOR_CLOSED) closed_at = elapsed;
+    }
+    // Restaban 1500 ms de espera más 1500 ms de cierre
+    long expected_closed = (long)(params.door_dwell_ms - 500 + params.door_close_ms);
+
+    bool passed = completed_in_place && open_after_opening && !moved_with_doors_open &&
+                  labs(closed_at - expected_closed) <= TEST_DT_MS && !group->ocupado[0] && group->piso_actual[0] == 3;
+    snprintf(details, sizeof(details), "Cerradas a los %ld ms (esperado %ld), movimiento con puertas abiertas: %s, piso final %d",
+             closed_at, expected_closed, moved_with_doors_open ? "SÍ" : "NO", group->piso_actual[0]);
+    write_test_result("test_kinematics_door_cycle_blocks_departure",
+                     "Verifica el ciclo de puertas y que la cabina no arranca con puertas abiertas",
+                     passed, details);
+
+    CU_ASSERT_TRUE(completed_in_place);
+    CU_ASSERT_TRUE(open_after_opening);
+    CU_ASSERT_FALSE(moved_with_doors_open);
+    CU_ASSERT(labs(closed_at - expected_closed) <= TEST_DT_MS);
+    CU_ASSERT_FALSE(group->ocupado[0]);
+    CU_ASSERT_EQUAL(group->piso_actual[0], 3);
+}
+
+// Test: El resultado no depende de la cadencia con la que se llama a gw_kinematics_advance()
+void test_kinematics_advance_is_cadence_independent(void) {
+    char details[256];
+    const unsigned int tick = gw_config()->sim_tick_ms;
+    gw_car_motion_t regular, irregular;
+
+    // Llamadas puntuales cada paso
+    elevator_group_state_t *group = setup_building(1);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(group);
+    assign_task_to_elevator(group, "E1A1", "T_CADENCIA", 8, 0);
+    uint64_t now = 1000;
+    unsigned int regular_steps = gw_kinematics_advance(now);
+    while (now < 1000 + 6000) {
+        now += tick;
+        regular_steps += gw_kinematics_advance(now);
+    }
+    gw_kinematics_get_car(0, 0, &regular);
+    int regular_floor = group->piso_actual[0];
+
+    // Llamadas irregulares que suman el mismo tiempo
+    group = setup_building(1);
+    assign_task_to_elevator(group, "E1A1", "T_CADENCIA", 8, 0);
+    const uint64_t jitter[] = { 7, 130, 1, 49, 333, 12, 88 };
+    now = 1000;
+    unsigned int irregular_steps = gw_kinematics_advance(now);
+    for (size_t k = 0; now < 1000 + 6000; ++k) {
+        uint64_t inc = jitter[k % (sizeof(jitter) / sizeof(jitter[0]))];
+        now = (now + inc > 1000 + 6000) ? 1000 + 6000 : now + inc;
+        irregular_steps += gw_kinematics_advance(now);
+    }
+    gw_kinematics_get_car(0, 0, &irregular);
+    int irregular_floor = group->piso_actual[0];
+
+    // Un parón largo no se recupera más allá del límite
+    unsigned int catchup = gw_kinematics_advance(now + 3600000);
+
+    bool passed = regular_steps == irregular_steps && regular_steps == 6000 / tick &&
+                  fabs(regular.position_m - irregular.position_m) < 1e-9 &&
+                  regular_floor == irregular_floor && catchup == GW_KINEMATICS_MAX_CATCHUP_STEPS;
+    snprintf(details, sizeof(details), "Pasos %u / %u, posición %.4f / %.4f m, recuperación %u",
+             regular_steps, irregular_steps, regular.position_m, irregular.position_m, catchup);
+    write_test_result("test_kinematics_advance_is_cadence_independent",
+                     "Verifica que el paso fijo no depende de la cadencia del bucle",
+                     passed, details);
+
+    CU_ASSERT_EQUAL(regular_steps, irregular_steps);
+    CU_ASSERT_EQUAL(regular_steps, 6000 / tick);
+    CU_ASSERT_DOUBLE_EQUAL(regular.position_m, irregular.position_m, 1e-9);
+    CU_ASSERT_EQUAL(regular_floor, irregular_floor);
+    CU_ASSERT_EQUAL(catchup, GW_KINEMATICS_MAX_CATCHUP_STEPS);
+}
+
+// Test: Un piso informado por el bus con la cabina en marcha recoloca el modelo
+void test_kinematics_external_floor_mid_travel(void) {
+    char details[256];
+    gw_sim_params_t params = test_params();
+    elevator_group_state_t *group = setup_building(2);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(group);
+
+    // Subiendo del 0 al 10, el bus informa del piso 6 cuando el modelo va por el 3
+    assign_task_to_elevator(group, "E1A1", "T_SALTO", 10, 0);
+    int steps = 0;
+    while (group->piso_actual[0] < 3 && steps < 2000) {
+        gw_kinematics_step_group(group, &params, TEST_DT_MS, 1);
+        steps++;
+    }
+    elevator_group_write_begin(group);
+    group->piso_actual[0] = 6; // Como el manejador de 0x300 de can_bridge.c
+    elevator_group_write_end(group);
+
+    gw_car_motion_t car;
+    gw_kinematics_step_group(group, &params, TEST_DT_MS, 1);
+    gw_kinematics_get_car(group->building_index, 0, &car);
+    bool kept_report = group->piso_actual[0] == 6 && car.floor == 6 &&
+                       car.position_m >= 6 * params.floor_height_m && car.velocity_mps > 0.0;
+
+    // Sigue hacia el destino sin superar los límites ni saltar pisos
+    double max_speed = 0.0;
+    int prev_floor = group->piso_actual[0], floor_jumps = 0;
+    while (group->ocupado[0] && steps < 4000) {
+        gw_kinematics_step_group(group, &params, TEST_DT_MS, 1);
+        steps++;
+        gw_kinematics_get_car(group->building_index, 0, &car);
+        max_speed = fmax(max_speed, fabs(car.velocity_mps));
+        if (abs(group->piso_actual[0] - prev_floor) > 1) floor_jumps++;
+        prev_floor = group->piso_actual[0];
+    }
+    bool arrived = !group->ocupado[0] && group->piso_actual[0] == 10 && floor_jumps == 0 &&
+                   max_speed <= params.speed_mps + 1e-9 && fabs(car.position_m - 30.0) < 1e-9;
+
+    // Llegada informada por el bus antes que el modelo: la tarea ya está completada y la cabina se detiene
+    assign_task_to_elevator(group, "E1A2", "T_LLEGADA", 8, 0);
+    for (int k = 0; k < 80; ++k) {
+        gw_kinematics_step_group(group, &params, TEST_DT_MS, 1);
+    }
+    elevator_group_write_begin(group);
+    group->piso_actual[1] = 8;
+    group->ocupado[1] = false;
+    group->destino_actual[1] = -1;
+    group->estado_puerta[1] = DOOR_OPEN;
+    group->direccion_movimiento[1] = STOPPED;
+    elevator_group_write_end(group);
+    gw_kinematics_step_group(group, &params, TEST_DT_MS, 1);
+    gw_car_motion_t stopped;
+    gw_kinematics_get_car(group->building_index, 1, &stopped);
+    bool stopped_at_report = group->piso_actual[1] == 8 && stopped.velocity_mps == 0.0 &&
+                             fabs(stopped.position_m - 24.0) < 1e-9;
+
+    bool passed = kept_report && arrived && stopped_at_report;
+    snprintf(details, sizeof(details), "Piso informado conservado: %s, llegada al 10: %s (vel. máx %.3f m/s), parada en la llegada informada: %s",
+             kept_report ? "sí" : "no", arrived ? "sí" : "no", max_speed, stopped_at_report ? "sí" : "no");
+    write_test_result("test_kinematics_external_floor_mid_travel",
+                     "Verifica que un piso informado por el bus en marcha no lo sobrescribe el siguiente paso",
+                     passed, details);
+
+    CU_ASSERT_TRUE(kept_report);
+    CU_ASSERT_TRUE(arrived);
+    CU_ASSERT_TRUE(stopped_at_report);
+}
+
+/**
+ * @brief Limpia y cierra el archivo de reporte
+ */
+void close_report_file(void) {
+    if (report_file) {
+        fprintf(report_file, "=== FIN DEL REPORTE ===\n");
+        fclose(report_file);
+        report_file = NULL;
+    }
+}
+
+/**
+ * @brief Configura la suite de pruebas cinemáticas
+ * @return Puntero a la suite configurada, o NULL si hay error
+ */
+CU_pSuite add_elevator_kinematics_tests(void) {
+    CU_pSuite suite = CU_add_suite("Elevator Kinematics Tests",
+                                   setup_elevator_kinematics_tests,
+                                   teardown_elevator_kinematics_tests);
+
+    if (suite == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(suite, "test_kinematics_travel_time_matches_profile", test_kinematics_travel_time_matches_profile) == NULL ||
+        CU_add_test(suite, "test_kinematics_respects_limits", test_kinematics_respects_limits) == NULL ||
+        CU_add_test(suite, "test_kinematics_door_cycle_blocks_departure", test_kinematics_door_cycle_blocks_departure) == NULL ||
+        CU_add_test(suite, "test_kinematics_advance_is_cadence_independent", test_kinematics_advance_is_cadence_independent) == NULL ||
+        CU_add_test(suite, "test_kinematics_external_floor_mid_travel", test_kinematics_external_floor_mid_travel) == NULL) {
+        return NULL;
+    }
+
+    return suite;
+}
+
+// Main para ejecutar solo estas pruebas
+int main(int argc, char *argv[]) {
+    bool automated = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--automated") == 0) {
+            automated = true;
+        }
+    }
+
+    if (CU_initialize_registry() != CUE_SUCCESS) {
+        return CU_get_error();
+    }
+
+    if (add_elevator_kinematics_tests() == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    if (automated) {
+        CU_automated_run_tests();
+        CU_list_tests_to_file();
+    } else {
+        CU_basic_set_mode(CU_BRM_VERBOSE);
+        CU_basic_run_tests();
+    }
+
+    close_report_file();
+
+    printf("\n=== RESUMEN DE PRUEBAS: SIMULACIÓN CINEMÁTICA ===\n");
+    printf("Pruebas ejecutadas: %u\n", CU_get_number_of_tests_run());
+    printf("Fallos: %u\n", CU_get_number_of_failures());
+    printf("Reporte detallado guardado en: test_elevator_kinematics_report.txt\n");
+
+    CU_cleanup_registry();
+    return (CU_get_number_of_failures() == 0) ? 0 : 1;
+}
@@ -23,6 +23,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <pthread.h>
 
 #include "api_gateway/elevator_state_manager.h"
 
@@ -64,6 +65,7 @@ int setup_elevator_tests(void) {
 
 // Teardown ejecutado después de cada test
 int teardown_elevator_tests(void) {
+    elevator_group_destroy(&test_group);
     setup_called = 0;
     return 0;
 }
@@ -123,22 +125,20 @@ void test_init_elevator_group(void) {
     } else {
         // Verificar cada ascensor individualmente
         for (int i = 0; i < TEST_NUM_ELEVATORS; i++) {
-            elevator_status_t *elevator = &test_group.ascensores[i];
-            
-            if (strlen(elevator->ascensor_id) == 0) {
+            if (strlen(test_group.ids[i].ascensor_id) == 0) {
                 test_passed = false;
                 snprintf(details, sizeof(details), "Ascensor %d no tiene ID asignado", i);
                 break;
             }
             
-            if (elevator->piso_actual < 0) {
+            if (test_group.piso_actual[i] < 0) {
                 test_passed = false;
                 snprintf(details, sizeof(details), "Ascensor %d inicia en piso inválido: %d", 
-                        i, elevator->piso_actual);
+                        i, test_group.piso_actual[i]);
                 break;
             }
             
-            if (elevator->ocupado) {
+            if (test_group.ocupado[i]) {
                 test_passed = false;
                 snprintf(details, sizeof(details), "Ascensor %d inicia ocupado cuando debería estar libre", i);
                 break;
@@ -149,7 +149,7 @@ void test_init_elevator_group(void) {
             snprintf(details, sizeof(details), 
                     "Grupo inicializado correctamente: %d ascensores en edificio %s, piso inicial=%d", 
                     test_group.num_elevadores_en_grupo, test_group.edificio_id_str_grupo, 
-                    test_group.ascensores[0].piso_actual);
+                    test_group.piso_actual[0]);
         }
     }
     
@@ -160,8 +160,8 @@ void test_init_elevator_group(void) {
     // Assertions de CUnit
     CU_ASSERT_EQUAL(test_group.num_elevadores_en_grupo, TEST_NUM_ELEVATORS);
     CU_ASSERT_STRING_EQUAL(test_group.edificio_id_str_grupo, TEST_BUILDING_ID);
-    CU_ASSERT_TRUE(test_group.ascensores[0].piso_actual >= 0);
-    CU_ASSERT_FALSE(test_group.ascensores[0].ocupado);
+    CU_ASSERT_TRUE(test_group.piso_actual[0] >= 0);
+    CU_ASSERT_FALSE(test_group.ocupado[0]);
 }
 
 /**
@@ -193,32 +193,32 @@ void test_assign_task_to_elevator(void) {
     snprintf(elevator_id, sizeof(elevator_id), "%sA%d", TEST_BUILDING_ID, elevator_index + 1);
     assign_task_to_elevator(&test_group, elevator_id, task_id, target_floor, 1);
     
-    elevator_status_t *assigned_elevator = &test_group.ascensores[elevator_index];
+    const elevator_ids_t *assigned_ids = &test_group.ids[elevator_index];
     
     // Verificar asignación
-    if (strcmp(assigned_elevator->tarea_actual_id, task_id) != 0) {
+    if (strcmp(assigned_ids->tarea_actual_id, task_id) != 0) {
         test_passed = false;
         snprintf(details, sizeof(details), "ID de tarea incorrecto: esperado '%s', obtenido '%s'", 
-                task_id, assigned_elevator->tarea_actual_id);
-    } else if (assigned_elevator->destino_actual != target_floor) {
+                task_id, assigned_ids->tarea_actual_id);
+    } else if (test_group.destino_actual[elevator_index] != target_floor) {
         test_passed = false;
         snprintf(details, sizeof(details), "Destino incorrecto: esperado %d, obtenido %d", 
-                target_floor, assigned_elevator->destino_actual);
-    } else if (!assigned_elevator->ocupado) {
+                target_floor, test_group.destino_actual[elevator_index]);
+    } else if (!test_group.ocupado[elevator_index]) {
         test_passed = false;
         snprintf(details, sizeof(details), "Ascensor no marcado como ocupado después de asignación");
     } else {
         // Verificar dirección de movimiento
-        movement_direction_enum_t expected_direction = (target_floor > assigned_elevator->piso_actual) ? 
+        movement_direction_enum_t expected_direction = (target_floor > test_group.piso_actual[elevator_index]) ? 
                                                       MOVING_UP : MOVING_DOWN;
-        if (assigned_elevator->direccion_movimiento_enum != expected_direction) {
+        if (test_group.direccion_movimiento[elevator_index] != expected_direction) {
             test_passed = false;
             snprintf(details, sizeof(details), "Dirección incorrecta: esperado %d, obtenido %d", 
-                    expected_direction, assigned_elevator->direccion_movimiento_enum);
+                    expected_direction, test_group.direccion_movimiento[elevator_index]);
         } else {
             snprintf(details, sizeof(details), 
                     "Tarea asignada correctamente: ascensor %s, tarea %s, destino piso %d, dirección %s", 
-                    assigned_elevator->ascensor_id, task_id, target_floor,
+                    assigned_ids->ascensor_id, task_id, target_floor,
                     (expected_direction == MOVING_UP) ? "UP" : "DOWN");
         }
     }
@@ -228,9 +228,9 @@ void test_assign_task_to_elevator(void) {
                      test_passed, details);
     
     // Assertions de CUnit
-    CU_ASSERT_STRING_EQUAL(assigned_elevator->tarea_actual_id, task_id);
-    CU_ASSERT_EQUAL(assigned_elevator->destino_actual, target_floor);
-    CU_ASSERT_TRUE(assigned_elevator->ocupado);
+    CU_ASSERT_STRING_EQUAL(assigned_ids->tarea_actual_id, task_id);
+    CU_ASSERT_EQUAL(test_group.destino_actual[elevator_index], target_floor);
+    CU_ASSERT_TRUE(test_group.ocupado[elevator_index]);
 }
 
 /**
@@ -291,6 +291,297 @@ void test_elevator_group_to_json(void) {
     CU_ASSERT_PTR_NOT_NULL(json_obj);
 }
 
+/**
+ * @brief Prueba la búsqueda directa de ascensores por ID
+ * 
+ * Esta prueba verifica que:
+ * - Los IDs "<edificio>A<n>" se resuelven al índice n - 1
+ * - IDs de otro edificio, fuera de rango o mal formados devuelven -1
+ * 
+ * @test Búsqueda O(1) de ascensor por ID
+ * @expected Índices correctos para IDs válidos y -1 en el resto
+ */
+void test_elevator_group_find_index(void) {
+    char details[256];
+
+    init_elevator_group(&test_group, TEST_BUILDING_ID, 4, TEST_NUM_FLOORS);
+    int first = elevator_group_find_index(&test_group, test_group.ids[0].ascensor_id);
+    int last = elevator_group_find_index(&test_group, test_group.ids[3].ascensor_id);
+    int out_of_range = elevator_group_find_index(&test_group, "E1A5");
+    int other_building = elevator_group_find_index(&test_group, "E2A1");
+    int malformed = elevator_group_find_index(&test_group, "E1A01");
+    int no_number = elevator_group_find_index(&test_group, "E1A");
+
+    bool passed = first == 0 && last == 3 && out_of_range == -1 &&
+                  other_building == -1 && malformed == -1 && no_number == -1;
+    snprintf(details, sizeof(details), "Índices: %d, %d; inválidos: %d, %d, %d, %d",
+             first, last, out_of_range, other_building, malformed, no_number);
+    write_test_result("test_elevator_group_find_index",
+                     "Verifica la resolución directa de IDs de ascensor a índices",
+                     passed, details);
+
+    CU_ASSERT_EQUAL(first, 0);
+    CU_ASSERT_EQUAL(last, 3);
+    CU_ASSERT_EQUAL(out_of_range, -1);
+    CU_ASSERT_EQUAL(other_building, -1);
+    CU_ASSERT_EQUAL(malformed, -1);
+    CU_ASSERT_EQUAL(no_number, -1);
+}
+
+/**
+ * @brief Prueba las tablas de estado dimensionadas en tiempo de ejecución
+ * 
+ * Esta prueba verifica que:
+ * - Se admiten grupos de más de 6 ascensores
+ * - Las tablas de estado empiezan en línea de caché
+ * - Re-inicializar con otro tamaño sustituye las tablas del grupo
+ * - El último ascensor del grupo se resuelve y serializa correctamente
+ * 
+ * @test Grupo grande con estado por columnas
+ * @expected Grupo de 12 ascensores accesible por índice y serializable
+ */
+void test_elevator_group_runtime_size(void) {
+    char details[256];
+    char buffer[GW_JSON_PAYLOAD_BUF_SIZE];
+    const int large_group = 12;
+
+    init_elevator_group(&test_group, TEST_BUILDING_ID, 2, TEST_NUM_FLOORS);
+    init_elevator_group(&test_group, TEST_BUILDING_ID, large_group, TEST_NUM_FLOORS);
+    bool aligned = ((uintptr_t)test_group.piso_actual % 64) == 0 && ((uintptr_t)test_group.ids % 64) == 0;
+
+    char last_id[ID_STRING_MAX_LEN];
+    snprintf(last_id, sizeof(last_id), "%sA%d", TEST_BUILDING_ID, large_group);
+    int last = elevator_group_find_index(&test_group, last_id);
+    assign_task_to_elevator(&test_group, last_id, "T_LAST", 8, 0);
+
+    int len = elevator_group_write_json_for_server(&test_group, GW_REQUEST_TYPE_UNKNOWN, NULL, buffer, sizeof(buffer));
+    bool serialized = len > 0 && (size_t)len < sizeof(buffer) && strstr(buffer, "\"T_LAST\"") != NULL;
+
+    bool passed = test_group.num_elevadores_en_grupo == large_group && aligned && last == large_group - 1 &&
+                  test_group.ocupado[large_group - 1] && test_group.destino_actual[large_group - 1] == 8 && serialized;
+    snprintf(details, sizeof(details), "Ascensores: %d, alineado: %s, índice último: %d, JSON: %d bytes",
+             test_group.num_elevadores_en_grupo, aligned ? "sí" : "no", last, len);
+    write_test_result("test_elevator_group_runtime_size",
+                     "Verifica grupos de más de 6 ascensores con tablas reservadas a medida",
+                     passed, details);
+
+    CU_ASSERT_EQUAL(test_group.num_elevadores_en_grupo, large_group);
+    CU_ASSERT_TRUE(aligned);
+    CU_ASSERT_EQUAL(last, large_group - 1);
+    CU_ASSERT_TRUE(test_group.ocupado[large_group - 1]);
+    CU_ASSERT_EQUAL(test_group.destino_actual[large_group - 1], 8);
+    CU_ASSERT_TRUE(serialized);
+}
+
+/**
+ * @brief Prueba que el escritor JSON directo coincide byte a byte con cJSON
+ * 
+ * Esta prueba verifica que:
+ * - elevator_group_write_json_for_server() genera los mismos bytes que
+ *   cJSON_PrintUnformatted() sobre elevator_group_to_json_for_server()
+ * - Se cubren llamadas de piso y de cabina, tareas, nulls y escapado
+ * - Con un buffer pequeño devuelve la longitud necesaria sin desbordarlo
+ * 
+ * @test Escritor JSON sin reserva de memoria
+ * @expected Salida idéntica a la de cJSON y semántica de snprintf()
+ */
+void test_elevator_group_write_json_matches_cjson(void) {
+    char details[512];
+    bool test_passed = true;
+    char buffer[GW_JSON_PAYLOAD_BUF_SIZE];
+
+    init_elevator_group(&test_group, TEST_BUILDING_ID, 3, TEST_NUM_FLOORS);
+    assign_task_to_elevator(&test_group, test_group.ids[1].ascensor_id, "T_\"1\"\t", 7, 2);
+    test_group.piso_actual[2] = -1;
+    elevator_group_mark_dirty(&test_group);
+
+    api_request_details_for_json_t request_details;
+    memset(&request_details, 0, sizeof(request_details));
+    request_details.origin_floor_fc = 3;
+    request_details.direction_fc = MOVING_DOWN;
+    strcpy(request_details.requesting_elevator_id_cr, test_group.ids[0].ascensor_id);
+    request_details.target_floor_cr = 11;
+
+    const gw_request_type_t types[] = { GW_REQUEST_TYPE_FLOOR_CALL, GW_REQUEST_TYPE_CABIN_REQUEST };
+    for (size_t t = 0; t < sizeof(types) / sizeof(types[0]) && test_passed; ++t) {
+        cJSON *json_obj = elevator_group_to_json_for_server(&test_group, types[t], &request_details);
+        char *expected = cJSON_PrintUnformatted(json_obj);
+        int len = elevator_group_write_json_for_server(&test_group, types[t], &request_details, buffer, sizeof(buffer));
+
+        if (!expected || len != (int)strlen(expected) || strcmp(buffer, expected) != 0) {
+            test_passed = false;
+            snprintf(details, sizeof(details), "Tipo %d: salida distinta. Esperado: %.200s | Obtenido: %.200s",
+                     types[t], expected ? expected : "(null)", buffer);
+        }
+        free(expected);
+        cJSON_Delete(json_obj);
+    }
+
+    // Buffer insuficiente: se trunca pero devuelve la longitud completa
+    char small[16];
+    int full_len = elevator_group_write_json_for_server(&test_group, GW_REQUEST_TYPE_FLOOR_CALL, &request_details, buffer, sizeof(buffer));
+    int small_len = elevator_group_write_json_for_server(&test_group, GW_REQUEST_TYPE_FLOOR_CALL, &request_details, small, sizeof(small));
+    if (test_passed && (small_len != full_len || small[sizeof(small) - 1] != '\0')) {
+        test_passed = false;
+        snprintf(details, sizeof(details), "Buffer pequeño: longitud %d (esperada %d)", small_len, full_len);
+    }
+    if (test_passed) {
+        snprintf(details, sizeof(details), "Salida idéntica a cJSON (%d bytes en llamada de piso)", full_len);
+    }
+
+    write_test_result("test_elevator_group_write_json_matches_cjson",
+                     "Verifica que el escritor JSON directo produce los mismos bytes que cJSON",
+                     test_passed, details);
+
+    CU_ASSERT_TRUE(test_passed);
+    CU_ASSERT_EQUAL(small_len, full_len);
+}
+
+/**
+ * @brief Prueba la invalidación del fragmento JSON cacheado por versión de estado
+ * 
+ * Esta prueba verifica que:
+ * - Sin cambios de estado, el fragmento "elevadores_estado" se reutiliza
+ * - assign_task_to_elevator() incrementa la versión e invalida la caché
+ * - El payload regenerado refleja el nuevo estado
+ * 
+ * @test Caché del estado serializado del grupo
+ * @expected La caché solo se regenera tras un cambio de versión
+ */
+void test_elevator_group_json_cache_version(void) {
+    char details[256];
+    char first[GW_JSON_PAYLOAD_BUF_SIZE];
+    char second[GW_JSON_PAYLOAD_BUF_SIZE];
+
+    init_elevator_group(&test_group, TEST_BUILDING_ID, 2, TEST_NUM_FLOORS);
+    api_request_details_for_json_t request_details;
+    memset(&request_details, 0, sizeof(request_details));
+    request_details.origin_floor_fc = 4;
+    request_details.direction_fc = MOVING_UP;
+
+    elevator_group_write_json_for_server(&test_group, GW_REQUEST_TYPE_FLOOR_CALL, &request_details, first, sizeof(first));
+    uint32_t cached_version = test_group.json_cache.version;
+    request_details.origin_floor_fc = 6;
+    elevator_group_write_json_for_server(&test_group, GW_REQUEST_TYPE_FLOOR_CALL, &request_details, second, sizeof(second));
+    bool reused = test_group.json_cache.version == cached_version && strstr(second, "\"piso_origen_llamada\":6") != NULL;
+
+    uint32_t version_before = test_group.state_version;
+    assign_task_to_elevator(&test_group, test_group.ids[0].ascensor_id, "T_CACHE", 9, 4);
+    elevator_group_write_json_for_server(&test_group, GW_REQUEST_TYPE_FLOOR_CALL, &request_details, second, sizeof(second));
+    bool invalidated = test_group.state_version > version_before &&
+                       test_group.json_cache.version == test_group.state_version &&
+                       strstr(second, "\"T_CACHE\"") != NULL;
+
+    bool passed = cached_version != 0 && reused && invalidated;
+    snprintf(details, sizeof(details), "Versión cacheada: %u, reutilizada: %s, invalidada tras asignación: %s",
+             cached_version, reused ? "sí" : "no", invalidated ? "sí" : "no");
+    write_test_result("test_elevator_group_json_cache_version",
+                     "Verifica que el fragmento JSON se reutiliza hasta que cambia la versión de estado",
+                     passed, details);
+
+    CU_ASSERT_NOT_EQUAL(cached_version, 0);
+    CU_ASSERT_TRUE(reused);
+    CU_ASSERT_TRUE(invalidated);
+}
+
+/**
+ * @brief Iteraciones del escritor en la prueba de snapshots concurrentes
+ */
+#define SNAPSHOT_WRITER_ITERATIONS 200000
+
+static volatile int snapshot_writer_done = 0;
+
+/**
+ * @brief Escritor de la prueba de snapshots: mueve todos los ascensores a la vez
+ * @param arg Grupo vivo
+ * @return NULL
+ */
+static void *snapshot_writer_thread(void *arg) {
+    elevator_group_state_t *group = arg;
+    for (int k = 0; k < SNAPSHOT_WRITER_ITERATIONS; ++k) {
+        elevator_group_write_begin(group);
+        for (int i = 0; i < group->num_elevadores_en_grupo; ++i) {
+            group->piso_actual[i] = (int16_t)(k & 0x3FFF);
+            group->destino_actual[i] = (int16_t)(k & 0x3FFF);
+        }
+        elevator_group_mark_dirty(group);
+        elevator_group_write_end(group);
+    }
+    snapshot_writer_done = 1;
+    return NULL;
+}
+
+/**
+ * @brief Prueba los snapshots seqlock con un escritor concurrente
+ * 
+ * Esta prueba verifica que:
+ * - Un lector en otro hilo nunca observa una escritura a medias (todos los
+ *   ascensores en el mismo piso y con el mismo destino)
+ * - El snapshot conserva la versión de estado y se puede serializar
+ * - El snapshot reutiliza sus tablas entre lecturas
+ * 
+ * @test Snapshots coherentes sin bloquear al escritor
+ * @expected Ninguna copia incoherente
+ */
+void test_elevator_group_snapshot_concurrent(void) {
+    char details[256];
+    char buffer[GW_JSON_PAYLOAD_BUF_SIZE];
+    elevator_group_state_t snapshot;
+    memset(&snapshot, 0, sizeof(snapshot));
+
+    init_elevator_group(&test_group, TEST_BUILDING_ID, 8, TEST_NUM_FLOORS);
+    for (int i = 0; i < test_group.num_elevadores_en_grupo; ++i) {
+        test_group.destino_actual[i] = test_group.piso_actual[i]; // Estado inicial coherente con el del escritor
+    }
+    snapshot_writer_done = 0;
+    pthread_t writer;
+    int created = pthread_create(&writer, NULL, snapshot_writer_thread, &test_group);
+
+    int snapshots = 0;
+    int torn = 0;
+    void *first_storage = NULL;
+    bool storage_reused = true;
+    while (created == 0 && !snapshot_writer_done) {
+        if (!elevator_group_read_snapshot(&test_group, &snapshot)) {
+            continue;
+        }
+        if (!first_storage) first_storage = snapshot.storage;
+        storage_reused = storage_reused && snapshot.storage == first_storage;
+        snapshots++;
+        for (int i = 0; i < snapshot.num_elevadores_en_grupo; ++i) {
+            if (snapshot.piso_actual[i] != snapshot.piso_actual[0] ||
+                snapshot.destino_actual[i] != snapshot.piso_actual[0]) {
+                torn++;
+                break;
+            }
+        }
+    }
+    if (created == 0) {
+        pthread_join(writer, NULL);
+    }
+
+    bool final_copy = elevator_group_read_snapshot(&test_group, &snapshot) &&
+                      snapshot.state_version == test_group.state_version &&
+                      snapshot.piso_actual[7] == test_group.piso_actual[7];
+    int len = elevator_group_write_json_for_server(&snapshot, GW_REQUEST_TYPE_UNKNOWN, NULL, buffer, sizeof(buffer));
+    bool serialized = len > 0 && strstr(buffer, TEST_BUILDING_ID "A8") != NULL;
+
+    bool passed = created == 0 && torn == 0 && final_copy && serialized && storage_reused;
+    snprintf(details, sizeof(details), "Snapshots: %d, incoherentes: %d, copia final: %s, JSON: %d bytes",
+             snapshots, torn, final_copy ? "sí" : "no", len);
+    write_test_result("test_elevator_group_snapshot_concurrent",
+                     "Verifica que los snapshots seqlock son coherentes con un escritor concurrente",
+                     passed, details);
+
+    elevator_group_destroy(&snapshot);
+
+    CU_ASSERT_EQUAL(created, 0);
+    CU_ASSERT_EQUAL(torn, 0);
+    CU_ASSERT_TRUE(final_copy);
+    CU_ASSERT_TRUE(serialized);
+    CU_ASSERT_TRUE(storage_reused);
+}
+
 /**
  * @brief Limpia y cierra el archivo de reporte
  * 
@@ -325,7 +616,12 @@ CU_pSuite add_elevator_state_manager_tests(void) {
     // Añadir pruebas individuales
     if (CU_add_test(suite, "test_init_elevator_group", test_init_elevator_group) == NULL ||
         CU_add_test(suite, "test_assign_task_to_elevator", test_assign_task_to_elevator) == NULL ||
-        CU_add_test(suite, "test_elevator_group_to_json", test_elevator_group_to_json) == NULL) {
+        CU_add_test(suite, "test_elevator_group_to_json", test_elevator_group_to_json) == NULL ||
+        CU_add_test(suite, "test_elevator_group_find_index", test_elevator_group_find_index) == NULL ||
+        CU_add_test(suite, "test_elevator_group_runtime_size", test_elevator_group_runtime_size) == NULL ||
+        CU_add_test(suite, "test_elevator_group_write_json_matches_cjson", test_elevator_group_write_json_matches_cjson) == NULL ||
+        CU_add_test(suite, "test_elevator_group_json_cache_version", test_elevator_group_json_cache_version) == NULL ||
+        CU_add_test(suite, "test_elevator_group_snapshot_concurrent", test_elevator_group_snapshot_concurrent) == NULL) {
         return NULL;
     }
     
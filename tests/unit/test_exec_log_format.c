@@ -0,0 +1,421 @@
+/**
+ * @file test_exec_log_format.c
+ * @brief Pruebas unitarias para los formatos del registro de ejecución
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Este archivo contiene las pruebas unitarias para verificar la escritura y
+ * lectura de registros de exec_log_format.c, incluyendo:
+ * - Empaquetado de cadenas con recorte y marca del campo recortado
+ * - Ida y vuelta de eventos y resumen (con latencias por etapa) en formato JSONL y binario
+ * - Lectura de registros interrumpidos (sin resumen o con el último evento a medias)
+ *
+ * @see exec_log_format.h
+ */
+
+#include <CUnit/CUnit.h>
+#include <CUnit/Basic.h>
+#include <CUnit/Automated.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "api_gateway/exec_log_format.h"
+
+#define TEST_JSONL_FILE "test_exec_log_format_data.jsonl"
+#define TEST_BIN_FILE "test_exec_log_format_data.bin"
+#define TEST_CUT_FILE "test_exec_log_format_cut.bin"
+#define TEST_NUM_EVENTS 7
+
+static FILE *report_file = NULL;
+
+/**
+ * @brief Rellena un evento tipado con sus cadenas empaquetadas
+ */
+static void make_event(exec_log_record_t *rec, log_event_type_t type, uint64_t time_ns,
+                       const char *const *strings, int count) {
+    memset(rec, 0, sizeof(*rec));
+    rec->type = (uint8_t)type;
+    rec->time_ns = time_ns;
+    exec_log_pack_strings(rec, strings, count);
+}
+
+/**
+ * @brief Genera la secuencia de eventos de prueba
+ *
+ * Incluye un frame CAN con datos, una petición CoAP con payload recortado,
+ * una respuesta CoAP con el código sin formatear, un movimiento con
+ * argumentos enteros y un evento genérico.
+ */
+static void make_events(exec_log_record_t events[TEST_NUM_EVENTS]) {
+    const char *start[] = { "EDIFICIO_T" };
+    make_event(&events[0], LOG_EVENT_SIMULATION_START, 1000, start, 1);
+    events[0].args[0] = 25;
+
+    const char *can[] = { "Llamada de piso" };
+    make_event(&events[1], LOG_EVENT_CAN_RECEIVED, 2000, can, 1);
+    events[1].can_id = 0x201;
+    events[1].args[0] = 3;
+    events[1].args[1] = 3;
+    events[1].data[0] = 0xAB;
+    events[1].data[1] = 0x00;
+    events[1].data[2] = 0x7F;
+
+    static char payload[2 * EXEC_LOG_TEXT_SIZE];
+    memset(payload, 'p', sizeof(payload) - 1);
+    payload[sizeof(payload) - 1] = '\0';
+    const char *coap[] = { "POST", "/peticion_piso", payload };
+    make_event(&events[2], LOG_EVENT_COAP_SENT, 3000, coap, 3);
+
+    const char *moved[] = { "E1", "SUBIENDO" };
+    make_event(&events[3], LOG_EVENT_ELEVATOR_MOVED, 4000, moved, 2);
+    events[3].args[0] = 2;
+    events[3].args[1] = 9;
+
+    const char *error[] = { "COAP_001", "timeout \"servidor\"\n" };
+    make_event(&events[4], LOG_EVENT_ERROR, 5000, error, 2);
+
+    const char *generic[] = { "Sistema iniciado", "" };
+    make_event(&events[5], LOG_EVENT_SYSTEM_START, 6000, generic, 2);
+    events[5].generic = 1;
+
+    const char *response[] = { "{\"ascensor_asignado_id\":\"E1\"}" };
+    make_event(&events[6], LOG_EVENT_COAP_RECEIVED, 7000, response, 1);
+    events[6].args[0] = (2 << 5) | 1; // 2.01
+}
+
+/**
+ * @brief Compara dos eventos campo a campo (cadenas desempaquetadas)
+ */
+static bool same_event(const exec_log_record_t *a, const exec_log_record_t *b) {
+    if (a->type != b->type || a->generic != b->generic || a->time_ns != b->time_ns ||
+        a->truncated != b->truncated || a->can_id != b->can_id ||
+        memcmp(a->data, b->data, sizeof(a->data)) != 0 ||
+        memcmp(a->args, b->args, sizeof(a->args)) != 0) {
+        return false;
+    }
+    const char *sa[EXEC_LOG_MAX_STRINGS];
+    const char *sb[EXEC_LOG_MAX_STRINGS];
+    exec_log_unpack_strings(a, sa, EXEC_LOG_MAX_STRINGS);
+    exec_log_unpack_strings(b, sb, EXEC_LOG_MAX_STRINGS);
+    for (int i = 0; i < EXEC_LOG_MAX_STRINGS; i++) {
+        if (strcmp(sa[i], sb[i]) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Escribe los eventos de prueba y, si se pide, el resumen final
+ */
+static bool write_log(const char *path, exec_log_format_t format, const exec_log_record_t *events,
+                      const execution_stats_t *stats) {
+    FILE *f = fopen(path, format == EXEC_LOG_FORMAT_BINARY ? "wb" : "w");
+    if (!f) {
+        return false;
+    }
+    struct timespec start = { 1700000000, 123456789 };
+    exec_log_write_header(f, format, &start);
+    for (int i = 0; i < TEST_NUM_EVENTS; i++) {
+        exec_log_write_event(f, format, &events[i], &start);
+    }
+    if (stats) {
+        struct timespec end = { 1700000010, 0 };
+        exec_log_write_footer(f, format, stats, &end);
+    }
+    fclose(f);
+    return true;
+}
+
+/**
+ * @brief Lee un registro y comprueba eventos y resumen
+ * @param expected_events Eventos que se esperan leer (prefijo de los de prueba)
+ * @param stats Resumen esperado, o NULL si el registro no debe tenerlo
+ */
+static bool read_log_matches(const char *path, const exec_log_record_t *events, int expected_events,
+                             const execution_stats_t *stats) {
+    exec_log_reader_t reader;
+    if (exec_log_reader_open(&reader, path) != 0) {
+        return false;
+    }
+    bool ok = reader.start.tv_sec == 1700000000 && reader.start.tv_nsec == 123456789;
+    exec_log_record_t rec;
+    int count = 0;
+    int result;
+    while ((result = exec_log_reader_next(&reader, &rec)) == 1) {
+        ok = ok && count < expected_events && same_event(&rec, &events[count]);
+        count++;
+    }
+    ok = ok && result == 0 && count == expected_events && reader.has_summary == (stats != NULL);
+    if (ok && stats) {
+        ok = reader.stats.total_can_frames_received == stats->total_can_frames_received &&
+             reader.stats.total_coap_requests == stats->total_coap_requests &&
+             reader.stats.total_errors == stats->total_errors &&
+             reader.stats.dropped_events == stats->dropped_events &&
+             reader.stats.requests_timed_out == stats->requests_timed_out &&
+             reader.stats.requests_answered_locally == stats->requests_answered_locally &&
+             reader.stats.building_requests == stats->building_requests &&
+             strcmp(reader.stats.building_id, stats->building_id) == 0 &&
+             memcmp(reader.stats.stage_latency, stats->stage_latency, sizeof(stats->stage_latency)) == 0 &&
+             reader.stats.execution_duration_sec > 9.99 && reader.stats.execution_duration_sec < 10.01;
+    }
+    exec_log_reader_close(&reader);
+    return ok;
+}
+
+/**
+ * @brief Estadísticas de prueba coherentes con los eventos
+ */
+static void make_stats(execution_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+    stats->total_can_frames_received = 1;
+    stats->total_coap_requests = 1;
+    stats->total_elevator_movements = 1;
+    stats->total_errors = 1;
+    stats->dropped_events = 7;
+    stats->requests_timed_out = 3;
+    stats->requests_answered_locally = 5;
+    stats->building_requests = 25;
+    stats->execution_duration_sec = 10.0;
+    strcpy(stats->building_id, "EDIFICIO_T");
+    // Etapa de envío sin muestras: el resumen JSONL la omite y se lee a cero
+    for (int i = 0; i < GW_SPAN_STAGE_COUNT; i++) {
+        if (i == GW_SPAN_STAGE_SEND) continue;
+        exec_stage_latency_t *lat = &stats->stage_latency[i];
+        lat->samples = 40;
+        lat->mean_us = 1200u * (uint32_t)(i + 1);
+        lat->p50_us = 1000u * (uint32_t)(i + 1);
+        lat->p90_us = 2000u * (uint32_t)(i + 1);
+        lat->p99_us = 3000u * (uint32_t)(i + 1);
+        lat->max_us = i == GW_SPAN_STAGE_TOTAL ? UINT32_MAX : 4000u * (uint32_t)(i + 1);
+    }
+}
+
+/**
+ * @brief Función de setup para la suite de formatos del registro
+ * @return 0 si el setup es exitoso
+ */
+int setup_exec_log_format_tests(void) {
+    if (!report_file) {
+        report_file = fopen("test_exec_log_format_report.txt", "w");
+        if (report_file) {
+            time_t now = time(NULL);
+            fprintf(report_file, "=== REPORTE DE PRUEBAS: FORMATOS DEL REGISTRO DE EJECUCIÓN ===\n");
+            fprintf(report_file, "Fecha: %s\n", ctime(&now));
+            fprintf(report_file, "===============================================\n\n");
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Función de teardown para la suite de formatos del registro
+ * @return 0 si el teardown es exitoso
+ */
+int teardown_exec_log_format_tests(void) {
+    remove(TEST_JSONL_FILE);
+    remove(TEST_BIN_FILE);
+    remove(TEST_CUT_FILE);
+    return 0;
+}
+
+/**
+ * @brief Escribe el resultado de una prueba individual al archivo de reporte
+ * @param test_name Nombre de la prueba ejecutada
+ * @param description Descripción de lo que verifica la prueba
+ * @param passed Indica si la prueba pasó (true) o falló (false)
+ * @param details Detalles específicos del resultado de la prueba
+ */
+void write_test_result(const char* test_name, const char* description, bool passed, const char* details) {
+    if (report_file) {
+        fprintf(report_file, "PRUEBA: %s\n", test_name);
+        fprintf(report_file, "Descripción: %s\n", description);
+        fprintf(report_file, "Resultado: %s\n", passed ? "PASÓ" : "FALLÓ");
+        if (details) {
+            fprintf(report_file, "Detalles: %s\n", details);
+        }
+        fprintf(report_file, "----------------------------------------\n\n");
+        fflush(report_file);
+    }
+}
+
+// Test: Las cadenas se empaquetan en orden y solo se recorta la que no cabe
+void test_exec_log_pack_strings(void) {
+    char details[256];
+    exec_log_record_t rec;
+    memset(&rec, 0, sizeof(rec));
+
+    char big[EXEC_LOG_TEXT_SIZE + 100];
+    memset(big, 'x', sizeof(big) - 1);
+    big[sizeof(big) - 1] = '\0';
+    const char *in[] = { "POST", NULL, big };
+    exec_log_pack_strings(&rec, in, 3);
+
+    const char *out[3];
+    exec_log_unpack_strings(&rec, out, 3);
+    size_t big_len = strlen(out[2]);
+    bool ok = strcmp(out[0], "POST") == 0 && strcmp(out[1], "N/A") == 0 &&
+              big_len == EXEC_LOG_TEXT_SIZE - strlen("POST") - strlen("N/A") - 3 &&
+              rec.truncated == (1u << 2);
+    CU_ASSERT_TRUE(ok);
+
+    // Pedir más cadenas de las empaquetadas no sale del área de texto
+    const char *extra[EXEC_LOG_MAX_STRINGS];
+    exec_log_unpack_strings(&rec, extra, EXEC_LOG_MAX_STRINGS);
+    bool bounded = extra[3][0] == '\0';
+    CU_ASSERT_TRUE(bounded);
+
+    exec_log_format_t format;
+    bool names = exec_log_format_from_name("JSONL", &format) && format == EXEC_LOG_FORMAT_JSONL &&
+                 exec_log_format_from_name("bin", &format) && format == EXEC_LOG_FORMAT_BINARY &&
+                 !exec_log_format_from_name("xml", &format) &&
+                 strcmp(exec_log_format_extension(EXEC_LOG_FORMAT_MARKDOWN), "md") == 0;
+    CU_ASSERT_TRUE(names);
+
+    snprintf(details, sizeof(details), "cadena recortada a %zu bytes, máscara 0x%02X, nombres de formato: %s",
+             big_len, rec.truncated, names ? "ok" : "incorrectos");
+    write_test_result("test_exec_log_pack_strings",
+                      "Empaqueta cadenas con recorte de la última y lectura acotada",
+                      ok && bounded && names, details);
+}
+
+// Test: Eventos y resumen sobreviven a la escritura y lectura en ambos formatos
+void test_exec_log_roundtrip(void) {
+    char details[256];
+    exec_log_record_t events[TEST_NUM_EVENTS];
+    execution_stats_t stats;
+    make_events(events);
+    make_stats(&stats);
+
+    bool jsonl = write_log(TEST_JSONL_FILE, EXEC_LOG_FORMAT_JSONL, events, &stats) &&
+                 read_log_matches(TEST_JSONL_FILE, events, TEST_NUM_EVENTS, &stats);
+    CU_ASSERT_TRUE(jsonl);
+
+    bool binary = write_log(TEST_BIN_FILE, EXEC_LOG_FORMAT_BINARY, events, &stats) &&
+                  read_log_matches(TEST_BIN_FILE, events, TEST_NUM_EVENTS, &stats);
+    CU_ASSERT_TRUE(binary);
+
+    // Un archivo Markdown no se acepta como registro estructurado
+    exec_log_reader_t reader;
+    FILE *f = fopen(TEST_CUT_FILE, "w");
+    if (f) {
+        fputs("---\ntitle: \"Reporte\"\n---\n", f);
+        fclose(f);
+    }
+    bool rejected = exec_log_reader_open(&reader, TEST_CUT_FILE) != 0;
+    CU_ASSERT_TRUE(rejected);
+
+    snprintf(details, sizeof(details), "JSONL: %s, binario: %s, Markdown rechazado: %s",
+             jsonl ? "ok" : "distinto", binary ? "ok" : "distinto", rejected ? "sí" : "no");
+    write_test_result("test_exec_log_roundtrip",
+                      "Escribe y relee eventos y resumen en JSONL y binario",
+                      jsonl && binary && rejected, details);
+}
+
+// Test: Un registro interrumpido se lee hasta el último evento completo
+void test_exec_log_interrupted(void) {
+    char details[256];
+    exec_log_record_t events[TEST_NUM_EVENTS];
+    make_events(events);
+
+    // Sin resumen final (gateway terminado sin exec_logger_finish())
+    bool jsonl = write_log(TEST_JSONL_FILE, EXEC_LOG_FORMAT_JSONL, events, NULL) &&
+                 read_log_matches(TEST_JSONL_FILE, events, TEST_NUM_EVENTS, NULL);
+    CU_ASSERT_TRUE(jsonl);
+
+    // Binario cortado a mitad del último evento
+    bool cut = write_log(TEST_BIN_FILE, EXEC_LOG_FORMAT_BINARY, events, NULL);
+    FILE *in = fopen(TEST_BIN_FILE, "rb");
+    FILE *out = fopen(TEST_CUT_FILE, "wb");
+    if (in && out) {
+        long keep = (long)(sizeof(exec_log_bin_header_t) + (TEST_NUM_EVENTS - 1) * sizeof(exec_log_record_t) + 10);
+        int c;
+        for (long pos = 0; pos < keep && (c = fgetc(in)) != EOF; pos++) {
+            fputc(c, out);
+        }
+    }
+    if (in) fclose(in);
+    if (out) fclose(out);
+    cut = cut && read_log_matches(TEST_CUT_FILE, events, TEST_NUM_EVENTS - 1, NULL);
+    CU_ASSERT_TRUE(cut);
+
+    snprintf(details, sizeof(details), "JSONL sin resumen: %s, binario cortado: %s",
+             jsonl ? "leído" : "fallo", cut ? "leído" : "fallo");
+    write_test_result("test_exec_log_interrupted",
+                      "Lee registros sin resumen final o con el último evento incompleto",
+                      jsonl && cut, details);
+}
+
+/**
+ * @brief Limpia y cierra el archivo de reporte
+ */
+void close_report_file(void) {
+    if (report_file) {
+        fprintf(report_file, "=== FIN DEL REPORTE ===\n");
+        fclose(report_file);
+        report_file = NULL;
+    }
+}
+
+/**
+ * @brief Configura la suite de pruebas de formatos del registro
+ * @return Puntero a la suite configurada, o NULL si hay error
+ */
+CU_pSuite add_exec_log_format_tests(void) {
+    CU_pSuite suite = CU_add_suite("Execution Log Format Tests",
+                                   setup_exec_log_format_tests,
+                                   teardown_exec_log_format_tests);
+
+    if (suite == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(suite, "test_exec_log_pack_strings", test_exec_log_pack_strings) == NULL ||
+        CU_add_test(suite, "test_exec_log_roundtrip", test_exec_log_roundtrip) == NULL ||
+        CU_add_test(suite, "test_exec_log_interrupted", test_exec_log_interrupted) == NULL) {
+        return NULL;
+    }
+
+    return suite;
+}
+
+// Main para ejecutar solo estas pruebas
+int main(int argc, char *argv[]) {
+    bool automated = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--automated") == 0) {
+            automated = true;
+        }
+    }
+
+    if (CU_initialize_registry() != CUE_SUCCESS) {
+        return CU_get_error();
+    }
+
+    if (add_exec_log_format_tests() == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    if (automated) {
+        CU_automated_run_tests();
+        CU_list_tests_to_file();
+    } else {
+        CU_basic_set_mode(CU_BRM_VERBOSE);
+        CU_basic_run_tests();
+    }
+
+    close_report_file();
+
+    printf("\n=== RESUMEN DE PRUEBAS: FORMATOS DEL REGISTRO DE EJECUCIÓN ===\n");
+    printf("Pruebas ejecutadas: %u\n", CU_get_number_of_tests_run());
+    printf("Fallos: %u\n", CU_get_number_of_failures());
+    printf("Reporte detallado guardado en: test_exec_log_format_report.txt\n");
+
+    CU_cleanup_registry();
+    return (CU_get_number_of_failures() == 0) ? 0 : 1;
+}
@@ -0,0 +1,350 @@
+/**
+ * @file test_gateway_config.c
+ * @brief Pruebas unitarias para la configuración tipada del gateway
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Este archivo contiene las pruebas unitarias para verificar la carga de
+ * gateway.env en gw_config_t, incluyendo:
+ * - Lectura de valores con '\\r\\n', comentarios y comillas
+ * - Precedencia entre fichero, entorno del proceso y valores por defecto
+ * - División de las rutas de recursos en opciones Uri-Path
+ * - Rechazo de valores inválidos conservando la configuración anterior
+ * - Recarga por SIGHUP que conserva los campos de arranque
+ *
+ * @see gateway_config.h
+ * @see api_gateway/gateway_config.c
+ */
+
+#include <CUnit/CUnit.h>
+#include <CUnit/Basic.h>
+#include <CUnit/Automated.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "api_gateway/gateway_config.h"
+#include "api_gateway/coap_config.h"
+
+#define TEST_CONFIG_FILE "test_gateway_config.env"
+
+static FILE *report_file = NULL;
+
+/**
+ * @brief Escribe el fichero de configuración de prueba
+ */
+static void write_config_file(const char *content) {
+    FILE *f = fopen(TEST_CONFIG_FILE, "w");
+    if (f) {
+        fputs(content, f);
+        fclose(f);
+    }
+}
+
+/**
+ * @brief Copia un segmento Uri-Path como cadena terminada
+ */
+static const char* segment(const gw_uri_path_t *path, int index, char *buf) {
+    memcpy(buf, path->path + path->segment_offset[index], path->segment_len[index]);
+    buf[path->segment_len[index]] = '\0';
+    return buf;
+}
+
+/**
+ * @brief Función de setup para la suite de pruebas de configuración
+ * @return 0 si el setup es exitoso
+ */
+int setup_gateway_config_tests(void) {
+    unsetenv("CENTRAL_SERVER_PORT");
+    unsetenv("COAP_MAX_RETRIES");
+
+    if (!report_file) {
+        report_file = fopen("test_gateway_config_report.txt", "w");
+        if (report_file) {
+            time_t now = time(NULL);
+            fprintf(report_file, "=== REPORTE DE PRUEBAS: CONFIGURACIÓN DEL GATEWAY ===\n");
+            fprintf(report_file, "Fecha: %s\n", ctime(&now));
+            fprintf(report_file, "=====================================================\n\n");
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Función de teardown para la suite de pruebas de configuración
+ * @return 0 si el teardown es exitoso
+ */
+int teardown_gateway_config_tests(void) {
+    gw_config_cleanup();
+    unsetenv("CENTRAL_SERVER_PORT");
+    unsetenv("COAP_MAX_RETRIES");
+    unlink(TEST_CONFIG_FILE);
+    return 0;
+}
+
+/**
+ * @brief Escribe el resultado de una prueba individual al archivo de reporte
+ * @param test_name Nombre de la prueba ejecutada
+ * @param description Descripción de lo que verifica la prueba
+ * @param passed Indica si la prueba pasó (true) o falló (false)
+ * @param details Detalles específicos del resultado de la prueba
+ */
+void write_test_result(const char* test_name, const char* description, bool passed, const char* details) {
+    if (report_file) {
+        fprintf(report_file, "PRUEBA: %s\n", test_name);
+        fprintf(report_file, "Descripción: %s\n", description);
+        fprintf(report_file, "Resultado: %s\n", passed ? "PASÓ" : "FALLÓ");
+        if (details) {
+            fprintf(report_file, "Detalles: %s\n", details);
+        }
+        fprintf(report_file, "----------------------------------------\n\n");
+        fflush(report_file);
+    }
+}
+
+// Test: Valores con CRLF, comentarios y comillas; precedencia fichero > entorno > defecto
+void test_config_load_parses_env_file(void) {
+    char details[256];
+    gw_config_cleanup();
+    setenv("CENTRAL_SERVER_PORT", "7000", 1);
+    setenv("COAP_MAX_RETRIES", "9", 1);
+    write_config_file("# Configuración de prueba\r\n"
+                      "\r\n"
+                      "GW_LISTEN_IP=127.0.0.1\r\n"
+                      "GW_LISTEN_PORT = 6000 \r\n"
+                      "CENTRAL_SERVER_IP=\"10.0.0.7\"\r\n"
+                      "COAP_MAX_RETRIES=2\r\n"
+                      "GW_STATE_FILE='gw.state'\r\n");
+
+    int rc = gw_config_load(TEST_CONFIG_FILE, 0);
+    const gw_config_t *config = gw_config();
+
+    bool passed = rc == 0 && strcmp(config->listen_ip, "127.0.0.1") == 0 && config->listen_port == 6000 &&
+                  strcmp(config->central_server_ip, "10.0.0.7") == 0 && config->central_server_port == 7000 &&
+                  config->coap_max_retries == 2 && config->coap_request_timeout_ms == COAP_REQUEST_TIMEOUT_MS &&
+                  strcmp(config->state_file, "gw.state") == 0 && config->journal_file[0] == '\0' &&
+                  gw_config_request_lifetime_ms(config) == (uint64_t)COAP_REQUEST_TIMEOUT_MS * 3;
+    snprintf(details, sizeof(details), "rc=%d, escucha %s:%u, central %s:%u, reintentos %u, estado '%s'",
+             rc, config->listen_ip, config->listen_port, config->central_server_ip,
+             config->central_server_port, config->coap_max_retries, config->state_file);
+    write_test_result("test_config_load_parses_env_file",
+                     "Verifica la lectura de gateway.env y la precedencia sobre el entorno",
+                     passed, details);
+
+    CU_ASSERT_EQUAL(rc, 0);
+    CU_ASSERT_STRING_EQUAL(config->listen_ip, "127.0.0.1");
+    CU_ASSERT_EQUAL(config->listen_port, 6000);
+    CU_ASSERT_STRING_EQUAL(config->central_server_ip, "10.0.0.7");
+    CU_ASSERT_EQUAL(config->central_server_port, 7000); // Solo en el entorno
+    CU_ASSERT_EQUAL(config->coap_max_retries, 2);       // El fichero gana al entorno
+    CU_ASSERT_EQUAL(config->coap_request_timeout_ms, COAP_REQUEST_TIMEOUT_MS);
+    CU_ASSERT_STRING_EQUAL(config->state_file, "gw.state");
+    CU_ASSERT_EQUAL(config->journal_file[0], '\0');
+    CU_ASSERT_EQUAL(gw_config_request_lifetime_ms(config), (uint64_t)COAP_REQUEST_TIMEOUT_MS * 3);
+
+    unsetenv("CENTRAL_SERVER_PORT");
+    unsetenv("COAP_MAX_RETRIES");
+}
+
+// Test: Las rutas de recursos se normalizan y dividen en opciones Uri-Path
+void test_config_uri_path_segments(void) {
+    char details[256];
+    char buf[GW_CONFIG_RESOURCE_MAX];
+    gw_config_cleanup();
+    write_config_file("FLOOR_CALL_RESOURCE=peticion_piso\r\n"
+                      "CABIN_REQUEST_RESOURCE=/api/v1/peticion_cabina/\n"
+                      "GW_LISTEN_PORT=5683\n");
+
+    int rc = gw_config_load(TEST_CONFIG_FILE, 0);
+    const gw_config_t *config = gw_config();
+    const gw_uri_path_t *floor = &config->floor_call_path;
+    const gw_uri_path_t *cabin = &config->cabin_request_path;
+
+    bool passed = rc == 0 && strcmp(floor->path, "/peticion_piso") == 0 && floor->num_segments == 1 &&
+                  strcmp(cabin->path, "/api/v1/peticion_cabina") == 0 && cabin->num_segments == 3;
+    snprintf(details, sizeof(details), "rc=%d, piso '%s' (%u segmentos), cabina '%s' (%u segmentos)",
+             rc, floor->path, floor->num_segments, cabin->path, cabin->num_segments);
+    write_test_result("test_config_uri_path_segments",
+                     "Verifica la división de las rutas de recursos en segmentos Uri-Path",
+                     passed, details);
+
+    CU_ASSERT_EQUAL_FATAL(rc, 0);
+    CU_ASSERT_STRING_EQUAL(floor->path, "/peticion_piso");
+    CU_ASSERT_EQUAL_FATAL(floor->num_segments, 1);
+    CU_ASSERT_STRING_EQUAL(segment(floor, 0, buf), "peticion_piso");
+    CU_ASSERT_STRING_EQUAL(cabin->path, "/api/v1/peticion_cabina");
+    CU_ASSERT_EQUAL_FATAL(cabin->num_segments, 3);
+    CU_ASSERT_STRING_EQUAL(segment(cabin, 0, buf), "api");
+    CU_ASSERT_STRING_EQUAL(segment(cabin, 1, buf), "v1");
+    CU_ASSERT_STRING_EQUAL(segment(cabin, 2, buf), "peticion_cabina");
+}
+
+// Test: Un valor inválido se rechaza y se conserva la configuración anterior
+void test_config_rejects_invalid_values(void) {
+    char details[256];
+    gw_config_cleanup();
+    write_config_file("CENTRAL_SERVER_IP=10.0.0.1\nGW_LISTEN_PORT=5683\n");
+    int rc_valid = gw_config_load(TEST_CONFIG_FILE, 0);
+    const gw_config_t *before = gw_config();
+    uint32_t generation = before->generation;
+
+    const char *invalid[] = {
+        "CENTRAL_SERVER_IP=10.0.0.999\n",
+        "CENTRAL_SERVER_PORT=70000\n",
+        "CENTRAL_SERVER_PORT=56a4\n",
+        "COAP_REQUEST_TIMEOUT_MS=0\n",
+        "FLOOR_CALL_RESOURCE=piso//llamada\n",
+        "CABIN_REQUEST_RESOURCE=cabina?x=1\n",
+    };
+    int rejected = 0;
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); ++i) {
+        write_config_file(invalid[i]);
+        if (gw_config_reload() == -1) {
+            rejected++;
+        }
+    }
+    const gw_config_t *after = gw_config();
+
+    bool passed = rc_valid == 0 && rejected == (int)(sizeof(invalid) / sizeof(invalid[0])) &&
+                  after == before && after->generation == generation &&
+                  strcmp(after->central_server_ip, "10.0.0.1") == 0;
+    snprintf(details, sizeof(details), "Rechazados %d de %zu, generación %u -> %u, central '%s'",
+             rejected, sizeof(invalid) / sizeof(invalid[0]), generation, after->generation,
+             after->central_server_ip);
+    write_test_result("test_config_rejects_invalid_values",
+                     "Verifica que una configuración inválida no sustituye a la actual",
+                     passed, details);
+
+    CU_ASSERT_EQUAL(rc_valid, 0);
+    CU_ASSERT_EQUAL(rejected, (int)(sizeof(invalid) / sizeof(invalid[0])));
+    CU_ASSERT_PTR_EQUAL(after, before);
+    CU_ASSERT_EQUAL(after->generation, generation);
+    CU_ASSERT_STRING_EQUAL(after->central_server_ip, "10.0.0.1");
+
+    // Carga inicial inválida: se mantienen los valores por defecto
+    gw_config_cleanup();
+    write_config_file("GW_LISTEN_IP=localhost\n");
+    CU_ASSERT_EQUAL(gw_config_load(TEST_CONFIG_FILE, 0), -1);
+    CU_ASSERT_STRING_EQUAL(gw_config()->listen_ip, GW_LISTEN_IP);
+    CU_ASSERT_EQUAL(gw_config()->generation, 0);
+}
+
+// Test: SIGHUP recarga los campos recargables y conserva los de arranque
+void test_config_sighup_reload_keeps_startup_fields(void) {
+    char details[256];
+    gw_config_cleanup();
+    write_config_file("GW_LISTEN_PORT=5683\nGW_JOURNAL_FILE=a.journal\n"
+                      "CENTRAL_SERVER_IP=10.0.0.1\nCOAP_REQUEST_TIMEOUT_MS=1000\n");
+    int rc = gw_config_load(TEST_CONFIG_FILE, 6001);
+    const gw_config_t *first = gw_config();
+    uint32_t first_generation = first->generation;
+    bool reloaded_without_signal = gw_config_reload_if_requested();
+
+    write_config_file("GW_LISTEN_PORT=7777\nGW_JOURNAL_FILE=b.journal\n"
+                      "CENTRAL_SERVER_IP=10.0.0.2\nCOAP_REQUEST_TIMEOUT_MS=250\n");
+    signal(SIGHUP, gw_config_handle_sighup);
+    raise(SIGHUP);
+    signal(SIGHUP, SIG_DFL);
+    bool reloaded = gw_config_reload_if_requested();
+    bool reloaded_twice = gw_config_reload_if_requested();
+    const gw_config_t *config = gw_config();
+
+    bool passed = rc == 0 && !reloaded_without_signal && reloaded && !reloaded_twice &&
+                  config->generation == first_generation + 1 &&
+                  strcmp(config->central_server_ip, "10.0.0.2") == 0 && config->coap_request_timeout_ms == 250 &&
+                  config->listen_port == 6001 && strcmp(config->journal_file, "a.journal") == 0 &&
+                  strcmp(first->central_server_ip, "10.0.0.1") == 0;
+    snprintf(details, sizeof(details), "Generación %u -> %u, central %s, timeout %u ms, puerto %u, diario '%s'",
+             first_generation, config->generation, config->central_server_ip,
+             config->coap_request_timeout_ms, config->listen_port, config->journal_file);
+    write_test_result("test_config_sighup_reload_keeps_startup_fields",
+                     "Verifica la recarga por SIGHUP sin cambiar los campos de arranque",
+                     passed, details);
+
+    CU_ASSERT_EQUAL(rc, 0);
+    CU_ASSERT_FALSE(reloaded_without_signal);
+    CU_ASSERT_TRUE(reloaded);
+    CU_ASSERT_FALSE(reloaded_twice);
+    CU_ASSERT_EQUAL(config->generation, first_generation + 1);
+    CU_ASSERT_STRING_EQUAL(config->central_server_ip, "10.0.0.2");
+    CU_ASSERT_EQUAL(config->coap_request_timeout_ms, 250);
+    CU_ASSERT_EQUAL(config->listen_port, 6001);            // Puerto de la línea de comandos
+    CU_ASSERT_STRING_EQUAL(config->journal_file, "a.journal");
+    CU_ASSERT_STRING_EQUAL(first->central_server_ip, "10.0.0.1"); // La anterior sigue siendo legible
+}
+
+/**
+ * @brief Limpia y cierra el archivo de reporte
+ */
+void close_report_file(void) {
+    if (report_file) {
+        fprintf(report_file, "=== FIN DEL REPORTE ===\n");
+        fclose(report_file);
+        report_file = NULL;
+    }
+}
+
+/**
+ * @brief Configura la suite de pruebas de configuración
+ * @return Puntero a la suite configurada, o NULL si hay error
+ */
+CU_pSuite add_gateway_config_tests(void) {
+    CU_pSuite suite = CU_add_suite("Gateway Config Tests",
+                                   setup_gateway_config_tests,
+                                   teardown_gateway_config_tests);
+
+    if (suite == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(suite, "test_config_load_parses_env_file", test_config_load_parses_env_file) == NULL ||
+        CU_add_test(suite, "test_config_uri_path_segments", test_config_uri_path_segments) == NULL ||
+        CU_add_test(suite, "test_config_rejects_invalid_values", test_config_rejects_invalid_values) == NULL ||
+        CU_add_test(suite, "test_config_sighup_reload_keeps_startup_fields", test_config_sighup_reload_keeps_startup_fields) == NULL) {
+        return NULL;
+    }
+
+    return suite;
+}
+
+// Main para ejecutar solo estas pruebas
+int main(int argc, char *argv[]) {
+    bool automated = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--automated") == 0) {
+            automated = true;
+        }
+    }
+
+    if (CU_initialize_registry() != CUE_SUCCESS) {
+        return CU_get_error();
+    }
+
+    if (add_gateway_config_tests() == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    if (automated) {
+        CU_automated_run_tests();
+        CU_list_tests_to_file();
+    } else {
+        CU_basic_set_mode(CU_BRM_VERBOSE);
+        CU_basic_run_tests();
+    }
+
+    close_report_file();
+
+    printf("\n=== RESUMEN DE PRUEBAS: CONFIGURACIÓN DEL GATEWAY ===\n");
+    printf("Pruebas ejecutadas: %u\n", CU_get_number_of_tests_run());
+    printf("Fallos: %u\n", CU_get_number_of_failures());
+    printf("Reporte detallado guardado en: test_gateway_config_report.txt\n");
+
+    CU_cleanup_registry();
+    return (CU_get_number_of_failures() == 0) ? 0 : 1;
+}
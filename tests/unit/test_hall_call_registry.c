@@ -0,0 +1,233 @@
+/**
+ * @file test_hall_call_registry.c
+ * @brief Pruebas unitarias para el registro de llamadas de piso activas
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Este archivo contiene las pruebas unitarias para verificar la
+ * coalescencia de llamadas de piso en el gateway, incluyendo:
+ * - Absorción de pulsaciones repetidas con una solicitud en vuelo
+ * - Respuesta local mientras el ascensor asignado sigue en camino
+ * - Invalidación de la asignación al completarse la tarea
+ * - Liberación de la llamada cuando la solicitud falla
+ *
+ * @see hall_call_registry.h
+ * @see api_gateway/hall_call_registry.c
+ */
+
+#include <CUnit/CUnit.h>
+#include <CUnit/Basic.h>
+#include <CUnit/Automated.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "api_gateway/hall_call_registry.h"
+
+static FILE *report_file = NULL;
+static gw_hall_call_table_t table;
+static elevator_group_state_t group;
+
+/**
+ * @brief Función de setup para la suite de pruebas de llamadas de piso
+ * @return 0 si el setup es exitoso
+ *
+ * Prepara un grupo de dos ascensores y abre el archivo de reporte si aún
+ * no existe.
+ */
+int setup_hall_call_tests(void) {
+    init_elevator_group(&group, "E1", 2, 10);
+    gw_hall_call_table_reset(&table);
+
+    if (!report_file) {
+        report_file = fopen("test_hall_call_registry_report.txt", "w");
+        if (report_file) {
+            time_t now = time(NULL);
+            fprintf(report_file, "=== REPORTE DE PRUEBAS: LLAMADAS DE PISO ===\n");
+            fprintf(report_file, "Fecha: %s\n", ctime(&now));
+            fprintf(report_file, "============================================\n\n");
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Función de teardown para la suite de pruebas de llamadas de piso
+ * @return 0 si el teardown es exitoso
+ */
+int teardown_hall_call_tests(void) {
+    elevator_group_destroy(&group);
+    return 0;
+}
+
+/**
+ * @brief Escribe el resultado de una prueba individual al archivo de reporte
+ * @param test_name Nombre de la prueba ejecutada
+ * @param description Descripción de lo que verifica la prueba
+ * @param passed Indica si la prueba pasó (true) o falló (false)
+ * @param details Detalles específicos del resultado de la prueba
+ */
+void write_test_result(const char* test_name, const char* description, bool passed, const char* details) {
+    if (report_file) {
+        fprintf(report_file, "PRUEBA: %s\n", test_name);
+        fprintf(report_file, "Descripción: %s\n", description);
+        fprintf(report_file, "Resultado: %s\n", passed ? "PASÓ" : "FALLÓ");
+        if (details) {
+            fprintf(report_file, "Detalles: %s\n", details);
+        }
+        fprintf(report_file, "----------------------------------------\n\n");
+        fflush(report_file);
+    }
+}
+
+// Test: Las pulsaciones repetidas se absorben mientras hay una solicitud en vuelo
+void test_hall_call_pending_coalesced(void) {
+    char details[256];
+    gw_hall_call_table_reset(&table);
+
+    gw_hall_call_status_t first = gw_hall_call_check(&table, &group, 5, MOVING_UP, NULL);
+    gw_hall_call_mark_pending(&table, 5, MOVING_UP);
+    gw_hall_call_status_t second = gw_hall_call_check(&table, &group, 5, MOVING_UP, NULL);
+    gw_hall_call_status_t third = gw_hall_call_check(&table, &group, 5, MOVING_UP, NULL);
+    gw_hall_call_status_t other_dir = gw_hall_call_check(&table, &group, 5, MOVING_DOWN, NULL);
+
+    bool passed = first == GW_HALL_CALL_NEW && second == GW_HALL_CALL_PENDING &&
+                  third == GW_HALL_CALL_PENDING && other_dir == GW_HALL_CALL_NEW &&
+                  table.coalesced_pending == 2;
+    snprintf(details, sizeof(details), "Estados: %d/%d/%d, otra dirección: %d, absorbidas: %u",
+             first, second, third, other_dir, table.coalesced_pending);
+    write_test_result("test_hall_call_pending_coalesced",
+                     "Verifica que piso+dirección pendiente no se reenvía y otra dirección sí",
+                     passed, details);
+
+    CU_ASSERT_EQUAL(first, GW_HALL_CALL_NEW);
+    CU_ASSERT_EQUAL(second, GW_HALL_CALL_PENDING);
+    CU_ASSERT_EQUAL(third, GW_HALL_CALL_PENDING);
+    CU_ASSERT_EQUAL(other_dir, GW_HALL_CALL_NEW);
+    CU_ASSERT_EQUAL(table.coalesced_pending, 2);
+}
+
+// Test: Con un ascensor asignado en camino se responde localmente hasta que completa la tarea
+void test_hall_call_assigned_answered_locally(void) {
+    char details[256];
+    int elevator_index = -1;
+    gw_hall_call_table_reset(&table);
+
+    gw_hall_call_mark_pending(&table, 7, MOVING_DOWN);
+    group.ocupado[1] = true;
+    group.destino_actual[1] = 7;
+    gw_hall_call_resolve(&table, &group, 7, MOVING_DOWN, "E1A2");
+
+    gw_hall_call_status_t while_moving = gw_hall_call_check(&table, &group, 7, MOVING_DOWN, &elevator_index);
+
+    // El ascensor llega y completa la tarea: la asignación deja de ser válida
+    group.ocupado[1] = false;
+    group.destino_actual[1] = -1;
+    gw_hall_call_status_t after_arrival = gw_hall_call_check(&table, &group, 7, MOVING_DOWN, NULL);
+
+    bool passed = while_moving == GW_HALL_CALL_ASSIGNED && elevator_index == 1 &&
+                  after_arrival == GW_HALL_CALL_NEW && table.answered_locally == 1;
+    snprintf(details, sizeof(details), "En camino: %d (ascensor %d), tras llegada: %d",
+             while_moving, elevator_index, after_arrival);
+    write_test_result("test_hall_call_assigned_answered_locally",
+                     "Verifica la respuesta local con la asignación vigente y su invalidación",
+                     passed, details);
+
+    CU_ASSERT_EQUAL(while_moving, GW_HALL_CALL_ASSIGNED);
+    CU_ASSERT_EQUAL(elevator_index, 1);
+    CU_ASSERT_EQUAL(after_arrival, GW_HALL_CALL_NEW);
+    CU_ASSERT_EQUAL(table.answered_locally, 1);
+}
+
+// Test: Una solicitud fallida (timeout o error) libera la llamada
+void test_hall_call_failed_request_released(void) {
+    char details[256];
+    gw_hall_call_table_reset(&table);
+
+    gw_hall_call_mark_pending(&table, 3, MOVING_UP);
+    gw_hall_call_resolve(&table, NULL, 3, MOVING_UP, NULL);
+    gw_hall_call_status_t after_failure = gw_hall_call_check(&table, &group, 3, MOVING_UP, NULL);
+    gw_hall_call_status_t invalid = gw_hall_call_check(&table, &group, GW_HALL_CALL_MAX_FLOORS, MOVING_UP, NULL);
+
+    bool passed = after_failure == GW_HALL_CALL_NEW && invalid == GW_HALL_CALL_NEW;
+    snprintf(details, sizeof(details), "Tras fallo: %d, piso fuera de rango: %d", after_failure, invalid);
+    write_test_result("test_hall_call_failed_request_released",
+                     "Verifica que una solicitud sin asignación no bloquea nuevas pulsaciones",
+                     passed, details);
+
+    CU_ASSERT_EQUAL(after_failure, GW_HALL_CALL_NEW);
+    CU_ASSERT_EQUAL(invalid, GW_HALL_CALL_NEW);
+}
+
+/**
+ * @brief Limpia y cierra el archivo de reporte
+ */
+void close_report_file(void) {
+    if (report_file) {
+        fprintf(report_file, "=== FIN DEL REPORTE ===\n");
+        fclose(report_file);
+        report_file = NULL;
+    }
+}
+
+/**
+ * @brief Configura la suite de pruebas de llamadas de piso
+ * @return Puntero a la suite configurada, o NULL si hay error
+ */
+CU_pSuite add_hall_call_tests(void) {
+    CU_pSuite suite = CU_add_suite("Hall Call Registry Tests",
+                                   setup_hall_call_tests,
+                                   teardown_hall_call_tests);
+
+    if (suite == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(suite, "test_hall_call_pending_coalesced", test_hall_call_pending_coalesced) == NULL ||
+        CU_add_test(suite, "test_hall_call_assigned_answered_locally", test_hall_call_assigned_answered_locally) == NULL ||
+        CU_add_test(suite, "test_hall_call_failed_request_released", test_hall_call_failed_request_released) == NULL) {
+        return NULL;
+    }
+
+    return suite;
+}
+
+// Main para ejecutar solo estas pruebas
+int main(int argc, char *argv[]) {
+    bool automated = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--automated") == 0) {
+            automated = true;
+        }
+    }
+
+    if (CU_initialize_registry() != CUE_SUCCESS) {
+        return CU_get_error();
+    }
+
+    if (add_hall_call_tests() == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    if (automated) {
+        CU_automated_run_tests();
+        CU_list_tests_to_file();
+    } else {
+        CU_basic_set_mode(CU_BRM_VERBOSE);
+        CU_basic_run_tests();
+    }
+
+    close_report_file();
+
+    printf("\n=== RESUMEN DE PRUEBAS: LLAMADAS DE PISO ===\n");
+    printf("Pruebas ejecutadas: %u\n", CU_get_number_of_tests_run());
+    printf("Fallos: %u\n", CU_get_number_of_failures());
+    printf("Reporte detallado guardado en: test_hall_call_registry_report.txt\n");
+
+    CU_cleanup_registry();
+    return (CU_get_number_of_failures() == 0) ? 0 : 1;
+}
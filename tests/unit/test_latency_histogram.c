@@ -0,0 +1,310 @@
+/**
+ * @file test_latency_histogram.c
+ * @brief Pruebas unitarias para el histograma de latencias HDR
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Este archivo contiene las pruebas unitarias para verificar el
+ * histograma de latency_histogram.c, incluyendo:
+ * - Percentiles con error relativo menor que 0,1 % frente a los exactos
+ * - Mínimo, máximo, media y valores fuera de rango
+ * - Combinación de histogramas, vaciado y corrección de omisión coordinada
+ * - Volcado de la distribución en CSV
+ *
+ * @see latency_histogram.h
+ */
+
+#include <CUnit/CUnit.h>
+#include <CUnit/Basic.h>
+#include <CUnit/Automated.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "api_gateway/latency_histogram.h"
+#include "api_gateway/prng.h"
+
+#define TEST_SEED 20250101u
+#define TEST_SAMPLES 200000
+#define TEST_CSV_FILE "test_latency_histogram.csv"
+
+static FILE *report_file = NULL;
+
+static int comparar_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Percentil exacto de muestras ordenadas, con el mismo criterio de rango que el histograma
+ */
+static uint64_t percentil_exacto(const uint64_t *ordenadas, size_t n, double percentil) {
+    size_t rango = (size_t)ceil(percentil / 100.0 * (double)n);
+    return ordenadas[rango ? rango - 1 : 0];
+}
+
+/**
+ * @brief Función de setup para la suite del histograma de latencias
+ * @return 0 si el setup es exitoso
+ */
+int setup_latency_histogram_tests(void) {
+    if (!report_file) {
+        report_file = fopen("test_latency_histogram_report.txt", "w");
+        if (report_file) {
+            time_t now = time(NULL);
+            fprintf(report_file, "=== REPORTE DE PRUEBAS: HISTOGRAMA DE LATENCIAS ===\n");
+            fprintf(report_file, "Fecha: %s\n", ctime(&now));
+            fprintf(report_file, "===================================================\n\n");
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Función de teardown para la suite del histograma de latencias
+ * @return 0 si el teardown es exitoso
+ */
+int teardown_latency_histogram_tests(void) {
+    remove(TEST_CSV_FILE);
+    return 0;
+}
+
+/**
+ * @brief Escribe el resultado de una prueba individual al archivo de reporte
+ * @param test_name Nombre de la prueba ejecutada
+ * @param description Descripción de lo que verifica la prueba
+ * @param passed true si la prueba pasó, false si falló
+ * @param details Detalles adicionales sobre el resultado
+ */
+void write_test_result(const char* test_name, const char* description, bool passed, const char* details) {
+    if (report_file) {
+        fprintf(report_file, "PRUEBA: %s\n", test_name);
+        fprintf(report_file, "Descripción: %s\n", description);
+        fprintf(report_file, "Resultado: %s\n", passed ? "PASÓ" : "FALLÓ");
+        if (details) {
+            fprintf(report_file, "Detalles: %s\n", details);
+        }
+        fprintf(report_file, "----------------------------------------\n\n");
+        fflush(report_file);
+    }
+}
+
+/**
+ * @brief Prueba: percentiles dentro del 0,1 % de los exactos en una distribución de cola larga
+ */
+void test_latency_hist_percentiles(void) {
+    gw_latency_hist_t hist;
+    CU_ASSERT_TRUE_FATAL(gw_latency_hist_init(&hist));
+    uint64_t *muestras = malloc(TEST_SAMPLES * sizeof(uint64_t));
+    CU_ASSERT_PTR_NOT_NULL_FATAL(muestras);
+
+    // Log-normal entre ~50 µs y varios segundos: cubre muchos cubos
+    gw_prng_t rng;
+    gw_prng_seed_stream(&rng, TEST_SEED, 0);
+    for (int i = 0; i < TEST_SAMPLES; ++i) {
+        double u1 = gw_prng_uniform(&rng), u2 = gw_prng_uniform(&rng);
+        double normal = sqrt(-2.0 * log(1.0 - u1)) * cos(2.0 * M_PI * u2);
+        muestras[i] = (uint64_t)(2000.0 * exp(1.5 * normal)) + 1;
+        gw_latency_hist_record(&hist, muestras[i]);
+    }
+    qsort(muestras, TEST_SAMPLES, sizeof(uint64_t), comparar_u64);
+
+    static const double percentiles[] = {0.0, 25.0, 50.0, 90.0, 99.0, 99.9, 99.99, 100.0};
+    double peor_error = 0.0;
+    for (size_t i = 0; i < sizeof(percentiles) / sizeof(percentiles[0]); ++i) {
+        uint64_t exacto = percentil_exacto(muestras, TEST_SAMPLES, percentiles[i]);
+        uint64_t estimado = gw_latency_hist_percentile(&hist, percentiles[i]);
+        double error = fabs((double)estimado - (double)exacto) / (double)exacto;
+        CU_ASSERT_TRUE(estimado >= exacto);
+        if (error > peor_error) peor_error = error;
+    }
+    CU_ASSERT_TRUE(peor_error < 0.001);
+
+    double media_exacta = 0.0;
+    for (int i = 0; i < TEST_SAMPLES; ++i) media_exacta += (double)muestras[i];
+    media_exacta /= TEST_SAMPLES;
+    bool extremos = hist.total == TEST_SAMPLES && hist.min_us == muestras[0] &&
+                    hist.max_us == muestras[TEST_SAMPLES - 1] &&
+                    gw_latency_hist_percentile(&hist, 100.0) == muestras[TEST_SAMPLES - 1] &&
+                    fabs(gw_latency_hist_mean(&hist) - media_exacta) < 1e-6 * media_exacta;
+    CU_ASSERT_TRUE(extremos);
+
+    // Valores pequeños exactos; fuera de rango se recorta al máximo
+    gw_latency_hist_t pequeno;
+    CU_ASSERT_TRUE_FATAL(gw_latency_hist_init(&pequeno));
+    for (uint64_t v = 0; v < 1000; ++v) gw_latency_hist_record(&pequeno, v);
+    gw_latency_hist_record(&pequeno, UINT64_MAX);
+    bool exactos = gw_latency_hist_percentile(&pequeno, 50.0) == 500 && pequeno.min_us == 1 &&
+                   pequeno.max_us == GW_LATENCY_HIST_MAX_US &&
+                   gw_latency_hist_percentile(&pequeno, 100.0) == GW_LATENCY_HIST_MAX_US;
+    CU_ASSERT_TRUE(exactos);
+    gw_latency_hist_free(&pequeno);
+
+    char details[256];
+    snprintf(details, sizeof(details), "%d muestras, p50=%llu µs, p99.99=%llu µs, peor error relativo: %.5f%%, extremos y media: %s, valores pequeños exactos: %s",
+             TEST_SAMPLES, (unsigned long long)gw_latency_hist_percentile(&hist, 50.0),
+             (unsigned long long)gw_latency_hist_percentile(&hist, 99.99), peor_error * 100.0,
+             extremos ? "sí" : "no", exactos ? "sí" : "no");
+    write_test_result("test_latency_hist_percentiles",
+                      "Los percentiles tienen error relativo menor que 0,1 % y mínimo, máximo y media son exactos",
+                      peor_error < 0.001 && extremos && exactos, details);
+    free(muestras);
+    gw_latency_hist_free(&hist);
+}
+
+/**
+ * @brief Prueba: combinación, vaciado y corrección de la omisión coordinada
+ */
+void test_latency_hist_merge_and_correction(void) {
+    gw_latency_hist_t a, b, todo;
+    CU_ASSERT_TRUE_FATAL(gw_latency_hist_init(&a) && gw_latency_hist_init(&b) && gw_latency_hist_init(&todo));
+    gw_prng_t rng;
+    gw_prng_seed_stream(&rng, TEST_SEED, 1);
+    for (int i = 0; i < 10000; ++i) {
+        uint64_t v = 1 + gw_prng_below(&rng, 1000000);
+        gw_latency_hist_record(i % 2 ? &a : &b, v);
+        gw_latency_hist_record(&todo, v);
+    }
+    gw_latency_hist_merge(&a, &b);
+    bool igual = a.total == todo.total && a.min_us == todo.min_us && a.max_us == todo.max_us &&
+                 memcmp(a.counts, todo.counts, a.counts_len * sizeof(uint64_t)) == 0;
+    CU_ASSERT_TRUE(igual);
+
+    gw_latency_hist_reset(&a);
+    bool vacio = a.total == 0 && gw_latency_hist_percentile(&a, 99.0) == 0 && gw_latency_hist_mean(&a) == 0.0;
+    CU_ASSERT_TRUE(vacio);
+
+    // Una pausa de 100 ms con un envío cada 10 ms oculta 9 peticiones de 90, 80... 10 ms
+    gw_latency_hist_record_corrected(&a, 100000, 10000);
+    gw_latency_hist_record_corrected(&a, 5000, 10000);
+    bool corregido = a.total == 11 && a.min_us == 5000 && a.max_us == 100000 &&
+                     gw_latency_hist_percentile(&a, 50.0) >= 50000 && gw_latency_hist_percentile(&a, 50.0) < 50100;
+    CU_ASSERT_TRUE(corregido);
+
+    char details[256];
+    snprintf(details, sizeof(details), "combinación igual al histograma completo: %s, vaciado: %s, muestras con corrección: %llu (p50=%llu µs)",
+             igual ? "sí" : "no", vacio ? "sí" : "no", (unsigned long long)a.total,
+             (unsigned long long)gw_latency_hist_percentile(&a, 50.0));
+    write_test_result("test_latency_hist_merge_and_correction",
+                      "Combinar histogramas suma contadores y la corrección añade las peticiones no enviadas",
+                      igual && vacio && corregido, details);
+    gw_latency_hist_free(&a);
+    gw_latency_hist_free(&b);
+    gw_latency_hist_free(&todo);
+}
+
+/**
+ * @brief Prueba: volcado CSV de la distribución
+ */
+void test_latency_hist_csv(void) {
+    gw_latency_hist_t hist;
+    CU_ASSERT_TRUE_FATAL(gw_latency_hist_init(&hist));
+    for (uint64_t v = 1; v <= 1000; ++v) gw_latency_hist_record(&hist, v);
+
+    FILE *csv = fopen(TEST_CSV_FILE, "w");
+    CU_ASSERT_PTR_NOT_NULL_FATAL(csv);
+    gw_latency_hist_write_csv(&hist, csv);
+    fclose(csv);
+
+    csv = fopen(TEST_CSV_FILE, "r");
+    CU_ASSERT_PTR_NOT_NULL_FATAL(csv);
+    char linea[128];
+    bool cabecera = fgets(linea, sizeof(linea), csv) && strcmp(linea, "percentil,latencia_us,muestras\n") == 0;
+    int filas = 0;
+    bool monotono = true;
+    double percentil, ultimo_percentil = -1.0;
+    unsigned long long latencia, muestras, ultima_latencia = 0, ultimas_muestras = 0;
+    while (fscanf(csv, "%lf,%llu,%llu\n", &percentil, &latencia, &muestras) == 3) {
+        monotono = monotono && percentil > ultimo_percentil && latencia >= ultima_latencia;
+        ultimo_percentil = percentil;
+        ultima_latencia = latencia;
+        ultimas_muestras = muestras;
+        filas++;
+    }
+    fclose(csv);
+    bool final = ultimas_muestras == 1000 && ultima_latencia == 1000;
+    CU_ASSERT_TRUE(cabecera && monotono && final && filas > 5);
+
+    char details[256];
+    snprintf(details, sizeof(details), "cabecera: %s, filas: %d, crecientes: %s, última fila: %llu µs con %llu muestras",
+             cabecera ? "sí" : "no", filas, monotono ? "sí" : "no", ultima_latencia, ultimas_muestras);
+    write_test_result("test_latency_hist_csv",
+                      "El CSV lista percentiles crecientes hasta el máximo con todas las muestras",
+                      cabecera && monotono && final && filas > 5, details);
+    gw_latency_hist_free(&hist);
+}
+
+/**
+ * @brief Limpia y cierra el archivo de reporte
+ */
+void close_report_file(void) {
+    if (report_file) {
+        fprintf(report_file, "=== FIN DEL REPORTE ===\n");
+        fclose(report_file);
+        report_file = NULL;
+    }
+}
+
+/**
+ * @brief Configura la suite de pruebas del histograma de latencias
+ * @return Puntero a la suite configurada, o NULL si hay error
+ */
+CU_pSuite add_latency_histogram_tests(void) {
+    CU_pSuite suite = CU_add_suite("Latency Histogram Tests",
+                                   setup_latency_histogram_tests,
+                                   teardown_latency_histogram_tests);
+
+    if (suite == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(suite, "test_latency_hist_percentiles", test_latency_hist_percentiles) == NULL ||
+        CU_add_test(suite, "test_latency_hist_merge_and_correction", test_latency_hist_merge_and_correction) == NULL ||
+        CU_add_test(suite, "test_latency_hist_csv", test_latency_hist_csv) == NULL) {
+        return NULL;
+    }
+
+    return suite;
+}
+
+// Main para ejecutar solo estas pruebas
+int main(int argc, char *argv[]) {
+    bool automated = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--automated") == 0) {
+            automated = true;
+        }
+    }
+
+    if (CU_initialize_registry() != CUE_SUCCESS) {
+        return CU_get_error();
+    }
+
+    if (add_latency_histogram_tests() == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    if (automated) {
+        CU_automated_run_tests();
+        CU_list_tests_to_file();
+    } else {
+        CU_basic_set_mode(CU_BRM_VERBOSE);
+        CU_basic_run_tests();
+    }
+
+    close_report_file();
+
+    printf("\n=== RESUMEN DE PRUEBAS: HISTOGRAMA DE LATENCIAS ===\n");
+    printf("Pruebas ejecutadas: %u\n", CU_get_number_of_tests_run());
+    printf("Fallos: %u\n", CU_get_number_of_failures());
+    printf("Reporte detallado guardado en: test_latency_histogram_report.txt\n");
+
+    CU_cleanup_registry();
+    return (CU_get_number_of_failures() == 0) ? 0 : 1;
+}
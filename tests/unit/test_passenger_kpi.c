@@ -0,0 +1,349 @@
+/**
+ * @file test_passenger_kpi.c
+ * @brief Pruebas unitarias para el seguimiento de pasajeros de la simulación
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Este archivo contiene las pruebas unitarias para verificar el
+ * seguimiento de passenger_kpi.c, incluyendo:
+ * - Hitos de un viaje: pulsación, asignación, embarque y llegada
+ * - Tiempos por pasajero en grupos y pasajeros sin destino conocido
+ * - Embarque solo en el sentido de los pasajeros que siguen a bordo (gw_kpi_riders_direction())
+ * - Exportación de los viajes en CSV y del resumen en JSON
+ *
+ * @see passenger_kpi.h
+ */
+
+#include <CUnit/CUnit.h>
+#include <CUnit/Basic.h>
+#include <CUnit/Automated.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "api_gateway/passenger_kpi.h"
+#include "api_gateway/building_registry.h"
+
+#define TEST_CSV_FILE "test_passenger_kpi.csv"
+#define TEST_JSON_FILE "test_passenger_kpi.json"
+
+static FILE *report_file = NULL;
+
+/**
+ * @brief Función de setup para la suite del seguimiento de pasajeros
+ * @return 0 si el setup es exitoso
+ */
+int setup_passenger_kpi_tests(void) {
+    if (!report_file) {
+        report_file = fopen("test_passenger_kpi_report.txt", "w");
+        if (report_file) {
+            time_t now = time(NULL);
+            fprintf(report_file, "=== REPORTE DE PRUEBAS: SEGUIMIENTO DE PASAJEROS ===\n");
+            fprintf(report_file, "Fecha: %s\n", ctime(&now));
+            fprintf(report_file, "====================================================\n\n");
+        }
+    }
+    gw_building_registry_init();
+    return 0;
+}
+
+/**
+ * @brief Función de teardown para la suite del seguimiento de pasajeros
+ * @return 0 si el teardown es exitoso
+ */
+int teardown_passenger_kpi_tests(void) {
+    gw_building_registry_cleanup();
+    remove(TEST_CSV_FILE);
+    remove(TEST_JSON_FILE);
+    return 0;
+}
+
+/**
+ * @brief Escribe el resultado de una prueba individual al archivo de reporte
+ * @param test_name Nombre de la prueba ejecutada
+ * @param description Descripción de lo que verifica la prueba
+ * @param passed true si la prueba pasó, false si falló
+ * @param details Detalles adicionales sobre el resultado
+ */
+void write_test_result(const char* test_name, const char* description, bool passed, const char* details) {
+    if (report_file) {
+        fprintf(report_file, "PRUEBA: %s\n", test_name);
+        fprintf(report_file, "Descripción: %s\n", description);
+        fprintf(report_file, "Resultado: %s\n", passed ? "PASÓ" : "FALLÓ");
+        if (details) {
+            fprintf(report_file, "Detalles: %s\n", details);
+        }
+        fprintf(report_file, "----------------------------------------\n\n");
+        fflush(report_file);
+    }
+}
+
+/**
+ * @brief Prueba: hitos de un viaje y tiempos por pasajero
+ */
+void test_kpi_journey_milestones(void) {
+    gw_kpi_tracker_t kpi;
+    CU_ASSERT_TRUE_FATAL(gw_kpi_init(&kpi));
+    CU_ASSERT_TRUE_FATAL(gw_kpi_add_building(&kpi, 0, 2));
+
+    // Grupo de 2 al piso 5 y otro pasajero al 7, ambos desde el 0 subiendo
+    int32_t a = gw_kpi_press(&kpi, 0, 0, MOVING_UP, 5, 2, 1000);
+    gw_kpi_assigned(&kpi, 0, 0, MOVING_UP, 1, 1020);
+    int32_t b = gw_kpi_press(&kpi, 0, 0, MOVING_UP, 7, 1, 1500);
+    int car = -1;
+    bool esperando = gw_kpi_has_waiting(&kpi, 0, 0, MOVING_UP, &car) && car == -1 &&
+                     !gw_kpi_has_waiting(&kpi, 0, 0, MOVING_DOWN, NULL);
+    gw_kpi_assigned(&kpi, 0, 0, MOVING_UP, 1, 1600);
+    CU_ASSERT_TRUE(a == 0 && b == 1 && esperando);
+
+    // Una parada del otro ascensor en otro piso no cambia nada
+    int nadie = gw_kpi_car_stop(&kpi, 0, 0, 3, 5000);
+    int embarcados = gw_kpi_car_stop(&kpi, 0, 1, 0, 10000);
+    int siguiente = gw_kpi_next_destination(&kpi, 0, 1, 0);
+    gw_kpi_car_stop(&kpi, 0, 1, 5, 20000);
+    uint64_t en_curso = gw_kpi_people_in_progress(&kpi);
+    int ultimo = gw_kpi_next_destination(&kpi, 0, 1, 5);
+    gw_kpi_car_stop(&kpi, 0, 1, 7, 26000);
+
+    const gw_passenger_t *pa = &kpi.passengers[a];
+    const gw_passenger_t *pb = &kpi.passengers[b];
+    bool hitos = pa->assigned_ms == 1020 && pb->assigned_ms == 1600 && pa->pickup_ms == 10000 &&
+                 pa->arrival_ms == 20000 && pb->arrival_ms == 26000 && pb->car == 1 &&
+                 pa->state == GW_PASSENGER_DELIVERED && pb->state == GW_PASSENGER_DELIVERED;
+    // Tiempos por pasajero: el grupo de 2 cuenta dos veces
+    bool tiempos = kpi.assignment.total == 3 && kpi.wait.total == 3 && kpi.journey.total == 3 &&
+                   kpi.wait.max_us == 9000000 && kpi.wait.min_us == 8500000 &&
+                   kpi.ride.min_us == 10000000 && kpi.ride.max_us == 16000000 &&
+                   kpi.journey.max_us == 24500000 &&
+                   gw_latency_hist_percentile(&kpi.journey, 50.0) >= 19000000 &&
+                   gw_latency_hist_percentile(&kpi.journey, 50.0) < 19020000;
+    bool recuentos = nadie == 0 && embarcados == 3 && siguiente == 5 && ultimo == 7 && en_curso == 1 &&
+                     kpi.people == 3 && kpi.people_delivered == 3 && gw_kpi_people_in_progress(&kpi) == 0;
+    CU_ASSERT_TRUE(hitos);
+    CU_ASSERT_TRUE(tiempos);
+    CU_ASSERT_TRUE(recuentos);
+
+    char details[256];
+    snprintf(details, sizeof(details), "embarcados: %d, próximos destinos: %d y %d, espera máxima: %.1f s, viaje p50: %.1f s",
+             embarcados, siguiente, ultimo, kpi.wait.max_us / 1e6,
+             gw_latency_hist_percentile(&kpi.journey, 50.0) / 1e6);
+    write_test_result("test_kpi_journey_milestones",
+                      "Cada viaje registra asignación, embarque y llegada y los tiempos cuentan por pasajero",
+                      hitos && tiempos && recuentos, details);
+    gw_kpi_free(&kpi);
+}
+
+/**
+ * @brief Prueba: una cabina ocupada no recoge a quien espera en sentido contrario
+ */
+void test_kpi_boarding_direction(void) {
+    gw_kpi_tracker_t kpi;
+    CU_ASSERT_TRUE_FATAL(gw_kpi_init(&kpi));
+    CU_ASSERT_TRUE_FATAL(gw_kpi_add_building(&kpi, 0, 1));
+
+    // La cabina sube del 0 al 8; en el 4 esperan uno que sube al 6 y otro que baja al 1
+    int32_t rider = gw_kpi_press(&kpi, 0, 0, MOVING_UP, 8, 1, 0);
+    gw_kpi_car_stop(&kpi, 0, 0, 0, 1000);
+    int32_t up = gw_kpi_press(&kpi, 0, 4, MOVING_UP, 6, 1, 2000);
+    int32_t down = gw_kpi_press(&kpi, 0, 4, MOVING_DOWN, 1, 1, 2000);
+
+    int subiendo = gw_kpi_car_stop(&kpi, 0, 0, 4, 5000);
+    int siguiente = gw_kpi_next_destination(&kpi, 0, 0, 4);
+    movement_direction_enum_t a_bordo = gw_kpi_riders_direction(&kpi, 0, 0, 4);
+    bool sigue_esperando = gw_kpi_has_waiting(&kpi, 0, 4, MOVING_DOWN, NULL) &&
+                           kpi.passengers[down].state == GW_PASSENGER_WAITING;
+    gw_kpi_car_stop(&kpi, 0, 0, 6, 8000);
+    gw_kpi_car_stop(&kpi, 0, 0, 8, 11000);
+
+    // Vacía, la cabina vuelve al 4 y ahora sí recoge al que baja
+    movement_direction_enum_t vacia = gw_kpi_riders_direction(&kpi, 0, 0, 8);
+    int bajando = gw_kpi_car_stop(&kpi, 0, 0, 4, 15000);
+    gw_kpi_car_stop(&kpi, 0, 0, 1, 19000);
+
+    bool sentido = subiendo == 1 && siguiente == 6 && sigue_esperando && bajando == 1 &&
+                   a_bordo == MOVING_UP && vacia == STOPPED &&
+                   gw_kpi_riders_direction(&kpi, 0, 0, 4) == STOPPED &&
+                   kpi.passengers[up].pickup_ms == 5000 && kpi.passengers[down].pickup_ms == 15000;
+    bool tiempos = kpi.passengers[rider].state == GW_PASSENGER_DELIVERED &&
+                   kpi.passengers[up].state == GW_PASSENGER_DELIVERED &&
+                   kpi.passengers[down].state == GW_PASSENGER_DELIVERED &&
+                   kpi.wait.max_us == 13000000 && kpi.ride.max_us == 10000000 &&
+                   kpi.journey.max_us == 17000000 && gw_kpi_people_in_progress(&kpi) == 0;
+    CU_ASSERT_TRUE(sentido);
+    CU_ASSERT_TRUE(tiempos);
+
+    char details[256];
+    snprintf(details, sizeof(details), "embarcados subiendo: %d, bajando: %d, espera máxima: %.1f s, viaje máximo: %.1f s",
+             subiendo, bajando, kpi.wait.max_us / 1e6, kpi.journey.max_us / 1e6);
+    write_test_result("test_kpi_boarding_direction",
+                      "Con pasajeros a bordo solo embarcan los que van en su sentido; el resto sigue esperando",
+                      sentido && tiempos, details);
+    gw_kpi_free(&kpi);
+}
+
+/**
+ * @brief Prueba: pasajeros sin destino, pisos fuera de rango y edificios sin registrar
+ */
+void test_kpi_unknown_destination_and_limits(void) {
+    gw_kpi_tracker_t kpi;
+    CU_ASSERT_TRUE_FATAL(gw_kpi_init(&kpi));
+    CU_ASSERT_TRUE_FATAL(gw_kpi_add_building(&kpi, 3, 4));
+
+    int32_t sin_destino = gw_kpi_press(&kpi, 3, 4, MOVING_DOWN, -1, 0, 0);
+    int32_t mismo_piso = gw_kpi_press(&kpi, 3, 6, MOVING_DOWN, 6, 1, 0);
+    bool rechazados = gw_kpi_press(&kpi, 3, GW_KPI_MAX_FLOORS, MOVING_UP, 1, 1, 0) < 0 &&
+                      gw_kpi_press(&kpi, 3, -1, MOVING_UP, 1, 1, 0) < 0 &&
+                      gw_kpi_press(&kpi, 2, 1, MOVING_UP, 3, 1, 0) < 0 &&
+                      gw_kpi_press(&kpi, 3, 1, STOPPED, 3, 1, 0) < 0 &&
+                      gw_kpi_car_stop(&kpi, 3, 4, 4, 100) == 0 &&
+                      !gw_kpi_add_building(&kpi, GW_MAX_BUILDINGS, 1);
+
+    int embarcados = gw_kpi_car_stop(&kpi, 3, 2, 4, 7000);
+    bool sin_viaje = embarcados == 1 && kpi.people_no_destination == 1 && kpi.wait.total == 1 &&
+                     kpi.journey.total == 0 && kpi.assignment.total == 0 &&
+                     kpi.passengers[sin_destino].state == GW_PASSENGER_BOARDED_NO_DEST &&
+                     kpi.passengers[sin_destino].count == 1 &&
+                     gw_kpi_next_destination(&kpi, 3, 2, 4) == -1;
+    bool mismo = mismo_piso >= 0 && kpi.passengers[mismo_piso].destination == -1;
+    CU_ASSERT_TRUE(rechazados);
+    CU_ASSERT_TRUE(sin_viaje);
+    CU_ASSERT_TRUE(mismo);
+
+    char details[256];
+    snprintf(details, sizeof(details), "entradas inválidas rechazadas: %s, embarque sin destino fuera del seguimiento: %s, destino igual al origen descartado: %s",
+             rechazados ? "sí" : "no", sin_viaje ? "sí" : "no", mismo ? "sí" : "no");
+    write_test_result("test_kpi_unknown_destination_and_limits",
+                      "Los pasajeros sin destino solo cuentan para la espera y las entradas fuera de rango se ignoran",
+                      rechazados && sin_viaje && mismo, details);
+    gw_kpi_free(&kpi);
+}
+
+/**
+ * @brief Prueba: exportación de los viajes en CSV y del resumen en JSON
+ */
+void test_kpi_export(void) {
+    gw_kpi_tracker_t kpi;
+    CU_ASSERT_TRUE_FATAL(gw_kpi_init(&kpi));
+    int edificio = gw_building_add("E7", 2, 10);
+    CU_ASSERT_TRUE_FATAL(edificio >= 0 && gw_kpi_add_building(&kpi, (uint16_t)edificio, 2));
+
+    gw_kpi_press(&kpi, (uint16_t)edificio, 2, MOVING_UP, 8, 3, 100);
+    gw_kpi_assigned(&kpi, (uint16_t)edificio, 2, MOVING_UP, 0, 120);
+    gw_kpi_car_stop(&kpi, (uint16_t)edificio, 0, 2, 4100);
+    gw_kpi_car_stop(&kpi, (uint16_t)edificio, 0, 8, 12100);
+    gw_kpi_press(&kpi, (uint16_t)edificio, 9, MOVING_DOWN, 1, 1, 500);
+
+    FILE *csv = fopen(TEST_CSV_FILE, "w");
+    FILE *json = fopen(TEST_JSON_FILE, "w");
+    CU_ASSERT_PTR_NOT_NULL_FATAL(csv);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(json);
+    bool escrito = gw_kpi_write_csv(&kpi, csv) && gw_kpi_write_json(&kpi, json);
+    fclose(csv);
+    fclose(json);
+
+    char lineas[3][256];
+    memset(lineas, 0, sizeof(lineas));
+    csv = fopen(TEST_CSV_FILE, "r");
+    CU_ASSERT_PTR_NOT_NULL_FATAL(csv);
+    for (int i = 0; i < 3; ++i) {
+        if (!fgets(lineas[i], sizeof(lineas[i]), csv)) break;
+    }
+    fclose(csv);
+    bool csv_ok = strcmp(lineas[0], "edificio,pasajeros,origen,destino,direccion,ascensor,pulsacion_ms,asignacion_ms,embarque_ms,llegada_ms,estado\n") == 0 &&
+                  strcmp(lineas[1], "E7,3,2,8,SUBIENDO,E7A1,100,120,4100,12100,entregado\n") == 0 &&
+                  strcmp(lineas[2], "E7,1,9,1,BAJANDO,,500,,,,esperando\n") == 0;
+
+    char contenido[2048];
+    memset(contenido, 0, sizeof(contenido));
+    json = fopen(TEST_JSON_FILE, "r");
+    CU_ASSERT_PTR_NOT_NULL_FATAL(json);
+    size_t leidos = fread(contenido, 1, sizeof(contenido) - 1, json);
+    fclose(json);
+    bool json_ok = leidos > 0 && strstr(contenido, "\"pasajeros\": 4,") && strstr(contenido, "\"llegados\": 3,") &&
+                   strstr(contenido, "\"sin_completar\": 1,") &&
+                   strstr(contenido, "\"espera\": {\"muestras\": 3, \"media_s\": 4.000") &&
+                   strstr(contenido, "\"viaje\": {\"muestras\": 3, \"media_s\": 12.000");
+    CU_ASSERT_TRUE(escrito && csv_ok && json_ok);
+
+    char details[256];
+    snprintf(details, sizeof(details), "CSV con hitos y vacíos para los pendientes: %s, resumen JSON: %s",
+             csv_ok ? "sí" : "no", json_ok ? "sí" : "no");
+    write_test_result("test_kpi_export",
+                      "El CSV tiene un viaje por línea con sus hitos y el JSON resume los indicadores",
+                      escrito && csv_ok && json_ok, details);
+    gw_kpi_free(&kpi);
+}
+
+/**
+ * @brief Limpia y cierra el archivo de reporte
+ */
+void close_report_file(void) {
+    if (report_file) {
+        fprintf(report_file, "=== FIN DEL REPORTE ===\n");
+        fclose(report_file);
+        report_file = NULL;
+    }
+}
+
+/**
+ * @brief Configura la suite de pruebas del seguimiento de pasajeros
+ * @return Puntero a la suite configurada, o NULL si hay error
+ */
+CU_pSuite add_passenger_kpi_tests(void) {
+    CU_pSuite suite = CU_add_suite("Passenger KPI Tests",
+                                   setup_passenger_kpi_tests,
+                                   teardown_passenger_kpi_tests);
+
+    if (suite == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(suite, "test_kpi_journey_milestones", test_kpi_journey_milestones) == NULL ||
+        CU_add_test(suite, "test_kpi_boarding_direction", test_kpi_boarding_direction) == NULL ||
+        CU_add_test(suite, "test_kpi_unknown_destination_and_limits", test_kpi_unknown_destination_and_limits) == NULL ||
+        CU_add_test(suite, "test_kpi_export", test_kpi_export) == NULL) {
+        return NULL;
+    }
+
+    return suite;
+}
+
+// Main para ejecutar solo estas pruebas
+int main(int argc, char *argv[]) {
+    bool automated = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--automated") == 0) {
+            automated = true;
+        }
+    }
+
+    if (CU_initialize_registry() != CUE_SUCCESS) {
+        return CU_get_error();
+    }
+
+    if (add_passenger_kpi_tests() == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    if (automated) {
+        CU_automated_run_tests();
+        CU_list_tests_to_file();
+    } else {
+        CU_basic_set_mode(CU_BRM_VERBOSE);
+        CU_basic_run_tests();
+    }
+
+    close_report_file();
+
+    printf("\n=== RESUMEN DE PRUEBAS: SEGUIMIENTO DE PASAJEROS ===\n");
+    printf("Pruebas ejecutadas: %u\n", CU_get_number_of_tests_run());
+    printf("Fallos: %u\n", CU_get_number_of_failures());
+    printf("Reporte detallado guardado en: test_passenger_kpi_report.txt\n");
+
+    CU_cleanup_registry();
+    return (CU_get_number_of_failures() == 0) ? 0 : 1;
+}
@@ -0,0 +1,328 @@
+/**
+ * @file test_request_capture.c
+ * @brief Pruebas unitarias para la captura binaria de peticiones del servidor central
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Este archivo contiene las pruebas unitarias para verificar la escritura y
+ * lectura de archivos de captura de request_capture.c, incluyendo:
+ * - Ida y vuelta de peticiones de piso y de cabina (recurso, payload, instantes)
+ * - Payloads ausentes o mayores que CAPTURE_MAX_PAYLOAD guardados como vacíos
+ * - Lectura de una captura con el último registro a medias
+ * - Rechazo de archivos que no son capturas
+ *
+ * @see request_capture.h
+ */
+
+#include <CUnit/CUnit.h>
+#include <CUnit/Basic.h>
+#include <CUnit/Automated.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "servidor_central/request_capture.h"
+
+#define TEST_CAPTURE_FILE "test_request_capture_data.bin"
+#define TEST_CUT_FILE "test_request_capture_cut.bin"
+#define TEST_NUM_RECORDS 4
+
+static FILE *report_file = NULL;
+
+static const char *k_floor_payload = "{\"id_edificio\":\"E1\",\"piso_origen_llamada\":3,\"direccion_llamada\":\"up\"}";
+static const char *k_cabin_payload = "{\"id_edificio\":\"E1\",\"solicitando_ascensor_id\":\"E1A1\",\"piso_destino_solicitud\":7}";
+
+/**
+ * @brief Escribe la captura de prueba
+ *
+ * Guarda, en este orden, una llamada de piso, una solicitud de cabina, una
+ * petición sin payload y una con un payload de CAPTURE_MAX_PAYLOAD + 1 bytes.
+ *
+ * @return true si la captura se creó
+ */
+static bool write_capture(const char *path) {
+    if (request_capture_open(path) != 0) {
+        return false;
+    }
+    uint8_t *oversize = malloc(CAPTURE_MAX_PAYLOAD + 1);
+    if (!oversize) {
+        request_capture_close();
+        return false;
+    }
+    memset(oversize, 'x', CAPTURE_MAX_PAYLOAD + 1);
+
+    request_capture_record(CAPTURE_RESOURCE_FLOOR_CALL, NULL,
+                           (const uint8_t *)k_floor_payload, strlen(k_floor_payload));
+    request_capture_record(CAPTURE_RESOURCE_CABIN_REQUEST, NULL,
+                           (const uint8_t *)k_cabin_payload, strlen(k_cabin_payload));
+    request_capture_record(CAPTURE_RESOURCE_FLOOR_CALL, NULL, NULL, 0);
+    request_capture_record(CAPTURE_RESOURCE_CABIN_REQUEST, NULL, oversize, CAPTURE_MAX_PAYLOAD + 1);
+    request_capture_flush();
+    request_capture_close();
+    free(oversize);
+    return request_capture_is_active() == 0;
+}
+
+/**
+ * @brief Comprueba que un registro leído coincide con el esperado
+ */
+static bool record_matches(const capture_record_t *rec, capture_resource_t resource, const char *payload) {
+    if (rec->resource != resource || rec->identity[0] != '\0') {
+        return false;
+    }
+    if (!payload) {
+        return rec->payload == NULL && rec->payload_len == 0;
+    }
+    return rec->payload_len == strlen(payload) && rec->payload &&
+           memcmp(rec->payload, payload, rec->payload_len) == 0;
+}
+
+/**
+ * @brief Lee la captura y la compara con la escrita por write_capture()
+ * @param path Archivo a leer
+ * @param complete Registros completos esperados
+ * @param expected_end Valor esperado de capture_reader_next() tras ellos (0 o -1)
+ * @return true si todo coincide
+ */
+static bool read_capture_matches(const char *path, int complete, int expected_end) {
+    static const capture_resource_t resources[TEST_NUM_RECORDS] = {
+        CAPTURE_RESOURCE_FLOOR_CALL, CAPTURE_RESOURCE_CABIN_REQUEST,
+        CAPTURE_RESOURCE_FLOOR_CALL, CAPTURE_RESOURCE_CABIN_REQUEST
+    };
+    const char *payloads[TEST_NUM_RECORDS] = { k_floor_payload, k_cabin_payload, NULL, NULL };
+
+    capture_reader_t reader;
+    if (capture_reader_open(&reader, path) != 0) {
+        return false;
+    }
+    bool ok = reader.start_unix_us > 0;
+    uint64_t last_offset = 0;
+    for (int i = 0; i < complete && ok; i++) {
+        capture_record_t rec;
+        ok = capture_reader_next(&reader, &rec) == 1 &&
+             record_matches(&rec, resources[i], payloads[i]) &&
+             rec.offset_us >= last_offset;
+        if (ok) {
+            last_offset = rec.offset_us;
+            free(rec.payload);
+        }
+    }
+    if (ok) {
+        capture_record_t rec;
+        int end = capture_reader_next(&reader, &rec);
+        if (end == 1) {
+            free(rec.payload);
+        }
+        ok = end == expected_end;
+    }
+    capture_reader_close(&reader);
+    return ok;
+}
+
+/**
+ * @brief Copia los primeros @p keep bytes de un archivo
+ * @return Bytes del archivo original, o -1 si no se pudo copiar
+ */
+static long copy_prefix(const char *src, const char *dst, long keep) {
+    FILE *in = fopen(src, "rb");
+    FILE *out = fopen(dst, "wb");
+    long size = -1;
+    if (in && out) {
+        int c;
+        size = 0;
+        while ((c = fgetc(in)) != EOF) {
+            if (size < keep) {
+                fputc(c, out);
+            }
+            size++;
+        }
+    }
+    if (in) fclose(in);
+    if (out) fclose(out);
+    return size;
+}
+
+/**
+ * @brief Función de setup para la suite de captura de peticiones
+ * @return 0 si el setup es exitoso
+ */
+int setup_request_capture_tests(void) {
+    if (!report_file) {
+        report_file = fopen("test_request_capture_report.txt", "w");
+        if (report_file) {
+            time_t now = time(NULL);
+            fprintf(report_file, "=== REPORTE DE PRUEBAS: CAPTURA DE PETICIONES ===\n");
+            fprintf(report_file, "Fecha: %s\n", ctime(&now));
+            fprintf(report_file, "===============================================\n\n");
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Función de teardown para la suite de captura de peticiones
+ * @return 0 si el teardown es exitoso
+ */
+int teardown_request_capture_tests(void) {
+    remove(TEST_CAPTURE_FILE);
+    remove(TEST_CUT_FILE);
+    return 0;
+}
+
+/**
+ * @brief Escribe el resultado de una prueba individual al archivo de reporte
+ * @param test_name Nombre de la prueba ejecutada
+ * @param description Descripción de lo que verifica la prueba
+ * @param passed Indica si la prueba pasó (true) o falló (false)
+ * @param details Detalles específicos del resultado de la prueba
+ */
+void write_test_result(const char* test_name, const char* description, bool passed, const char* details) {
+    if (report_file) {
+        fprintf(report_file, "PRUEBA: %s\n", test_name);
+        fprintf(report_file, "Descripción: %s\n", description);
+        fprintf(report_file, "Resultado: %s\n", passed ? "PASÓ" : "FALLÓ");
+        if (details) {
+            fprintf(report_file, "Detalles: %s\n", details);
+        }
+        fprintf(report_file, "----------------------------------------\n\n");
+        fflush(report_file);
+    }
+}
+
+// Test: Las peticiones sobreviven a la escritura y lectura, y los payloads vacíos o enormes se guardan vacíos
+void test_request_capture_roundtrip(void) {
+    char details[256];
+
+    bool written = write_capture(TEST_CAPTURE_FILE);
+    CU_ASSERT_TRUE(written);
+
+    bool roundtrip = written && read_capture_matches(TEST_CAPTURE_FILE, TEST_NUM_RECORDS, 0);
+    CU_ASSERT_TRUE(roundtrip);
+
+    // Sin captura activa request_capture_record() no hace nada
+    request_capture_record(CAPTURE_RESOURCE_FLOOR_CALL, NULL,
+                           (const uint8_t *)k_floor_payload, strlen(k_floor_payload));
+    bool inactive = request_capture_is_active() == 0 &&
+                    read_capture_matches(TEST_CAPTURE_FILE, TEST_NUM_RECORDS, 0);
+    CU_ASSERT_TRUE(inactive);
+
+    snprintf(details, sizeof(details), "%d peticiones releídas: %s, payload de %d bytes guardado vacío, captura inactiva ignorada: %s",
+             TEST_NUM_RECORDS, roundtrip ? "ok" : "distintas", CAPTURE_MAX_PAYLOAD + 1, inactive ? "sí" : "no");
+    write_test_result("test_request_capture_roundtrip",
+                      "Escribe y relee peticiones de piso y de cabina con payloads vacíos y sobredimensionados",
+                      written && roundtrip && inactive, details);
+}
+
+// Test: Una captura con el último registro a medias se lee hasta el último completo
+void test_request_capture_truncated(void) {
+    char details[256];
+
+    bool written = write_capture(TEST_CAPTURE_FILE);
+    long size = written ? copy_prefix(TEST_CAPTURE_FILE, TEST_CUT_FILE, 0) : -1;
+
+    // El último registro (vacío) ocupa solo su cabecera de 16 bytes: cortar 6
+    bool cut = size > 6 && copy_prefix(TEST_CAPTURE_FILE, TEST_CUT_FILE, size - 6) == size &&
+               read_capture_matches(TEST_CUT_FILE, TEST_NUM_RECORDS - 1, -1);
+    CU_ASSERT_TRUE(cut);
+
+    // Cortar dentro del payload de la solicitud de cabina
+    long cabin_cut = 24 + 16 + (long)strlen(k_floor_payload) + 16 + 5;
+    bool cut_payload = size > cabin_cut && copy_prefix(TEST_CAPTURE_FILE, TEST_CUT_FILE, cabin_cut) == size &&
+                       read_capture_matches(TEST_CUT_FILE, 1, -1);
+    CU_ASSERT_TRUE(cut_payload);
+
+    // Solo la cabecera del archivo: captura válida y vacía
+    bool header_only = size > 24 && copy_prefix(TEST_CAPTURE_FILE, TEST_CUT_FILE, 24) == size &&
+                       read_capture_matches(TEST_CUT_FILE, 0, 0);
+    CU_ASSERT_TRUE(header_only);
+
+    // Un archivo que no es una captura se rechaza
+    capture_reader_t reader;
+    FILE *f = fopen(TEST_CUT_FILE, "wb");
+    if (f) {
+        fputs("NOTACAPTUREFILE_PADDING_", f);
+        fclose(f);
+    }
+    bool rejected = capture_reader_open(&reader, TEST_CUT_FILE) != 0 && reader.file == NULL;
+    CU_ASSERT_TRUE(rejected);
+
+    snprintf(details, sizeof(details), "archivo de %ld bytes; cortado en cabecera: %s, en payload: %s, solo cabecera: %s, magic inválido rechazado: %s",
+             size, cut ? "leído" : "fallo", cut_payload ? "leído" : "fallo",
+             header_only ? "vacío" : "fallo", rejected ? "sí" : "no");
+    write_test_result("test_request_capture_truncated",
+                      "Lee capturas interrumpidas hasta el último registro completo y rechaza archivos ajenos",
+                      cut && cut_payload && header_only && rejected, details);
+}
+
+/**
+ * @brief Limpia y cierra el archivo de reporte
+ */
+void close_report_file(void) {
+    if (report_file) {
+        fprintf(report_file, "=== FIN DEL REPORTE ===\n");
+        fclose(report_file);
+        report_file = NULL;
+    }
+}
+
+/**
+ * @brief Configura la suite de pruebas de captura de peticiones
+ * @return Puntero a la suite configurada, o NULL si hay error
+ */
+CU_pSuite add_request_capture_tests(void) {
+    CU_pSuite suite = CU_add_suite("Request Capture Tests",
+                                   setup_request_capture_tests,
+                                   teardown_request_capture_tests);
+
+    if (suite == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(suite, "test_request_capture_roundtrip", test_request_capture_roundtrip) == NULL ||
+        CU_add_test(suite, "test_request_capture_truncated", test_request_capture_truncated) == NULL) {
+        return NULL;
+    }
+
+    return suite;
+}
+
+// Main para ejecutar solo estas pruebas
+int main(int argc, char *argv[]) {
+    bool automated = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--automated") == 0) {
+            automated = true;
+        }
+    }
+
+    if (CU_initialize_registry() != CUE_SUCCESS) {
+        return CU_get_error();
+    }
+
+    if (add_request_capture_tests() == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    if (automated) {
+        CU_automated_run_tests();
+        CU_list_tests_to_file();
+    } else {
+        CU_basic_set_mode(CU_BRM_VERBOSE);
+        CU_basic_run_tests();
+    }
+
+    close_report_file();
+
+    printf("\n=== RESUMEN DE PRUEBAS: CAPTURA DE PETICIONES ===\n");
+    printf("Pruebas ejecutadas: %u\n", CU_get_number_of_tests_run());
+    printf("Fallos: %u\n", CU_get_number_of_failures());
+    printf("Reporte detallado guardado en: test_request_capture_report.txt\n");
+
+    CU_cleanup_registry();
+    return (CU_get_number_of_failures() == 0) ? 0 : 1;
+}
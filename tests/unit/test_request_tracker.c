@@ -0,0 +1,397 @@
+/**
+ * @file test_request_tracker.c
+ * @brief Pruebas unitarias para el slab unificado de trackers
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Este archivo contiene las pruebas unitarias para verificar el correcto
+ * funcionamiento del slab de trackers de solicitudes, incluyendo:
+ * - Reserva de slots y codificación del token (índice + generación)
+ * - Localización O(1) de trackers a partir del token
+ * - Rechazo de tokens obsoletos tras liberar un slot (y span de latencia a cero)
+ * - Comportamiento con el slab lleno (sin sobrescritura)
+ * - Expiración por deadline de las solicitudes sin respuesta
+ * - Orden de expiración al acortar el timeout con solicitudes en vuelo
+ *
+ * @see request_tracker.h
+ * @see api_gateway/request_tracker.c
+ */
+
+#include <CUnit/CUnit.h>
+#include <CUnit/Basic.h>
+#include <CUnit/Automated.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "api_gateway/request_tracker.h"
+
+static FILE *report_file = NULL;
+
+/**
+ * @brief Función de setup para la suite de pruebas del slab de trackers
+ * @return 0 si el setup es exitoso
+ *
+ * Reinicia el slab y abre el archivo de reporte si aún no existe.
+ */
+int setup_request_tracker_tests(void) {
+    gw_tracker_init();
+
+    if (!report_file) {
+        report_file = fopen("test_request_tracker_report.txt", "w");
+        if (report_file) {
+            time_t now = time(NULL);
+            fprintf(report_file, "=== REPORTE DE PRUEBAS: SLAB DE TRACKERS ===\n");
+            fprintf(report_file, "Fecha: %s\n", ctime(&now));
+            fprintf(report_file, "============================================\n\n");
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Función de teardown para la suite de pruebas del slab de trackers
+ * @return 0 si el teardown es exitoso
+ */
+int teardown_request_tracker_tests(void) {
+    gw_tracker_cleanup();
+    return 0;
+}
+
+/**
+ * @brief Escribe el resultado de una prueba individual al archivo de reporte
+ * @param test_name Nombre de la prueba ejecutada
+ * @param description Descripción de lo que verifica la prueba
+ * @param passed Indica si la prueba pasó (true) o falló (false)
+ * @param details Detalles específicos del resultado de la prueba
+ */
+void write_test_result(const char* test_name, const char* description, bool passed, const char* details) {
+    if (report_file) {
+        fprintf(report_file, "PRUEBA: %s\n", test_name);
+        fprintf(report_file, "Descripción: %s\n", description);
+        fprintf(report_file, "Resultado: %s\n", passed ? "PASÓ" : "FALLÓ");
+        if (details) {
+            fprintf(report_file, "Detalles: %s\n", details);
+        }
+        fprintf(report_file, "----------------------------------------\n\n");
+        fflush(report_file);
+    }
+}
+
+// Test: Reserva y localización de un tracker CAN por su token
+void test_tracker_alloc_and_lookup(void) {
+    char details[512];
+    bool test_passed = true;
+    uint8_t token[GW_TRACKER_TOKEN_LEN];
+
+    gw_tracker_init();
+    gw_tracker_slot_t *slot = gw_tracker_alloc(GW_TRACKER_ORIGIN_CAN, token);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(slot);
+    slot->data.can.original_can_id = 0x200;
+    slot->data.can.target_floor_for_task = 7;
+
+    coap_bin_const_t bin = { GW_TRACKER_TOKEN_LEN, token };
+    gw_tracker_slot_t *found = gw_tracker_lookup(bin);
+    can_origin_tracker_t *can_tracker = find_can_tracker(bin);
+
+    if (found != slot) {
+        test_passed = false;
+        snprintf(details, sizeof(details), "gw_tracker_lookup no devolvió el slot reservado");
+    } else if (!can_tracker || can_tracker->original_can_id != 0x200) {
+        test_passed = false;
+        snprintf(details, sizeof(details), "find_can_tracker no devolvió el tracker CAN esperado");
+    } else {
+        snprintf(details, sizeof(details), "Slot localizado por token, CAN ID 0x%X, en vuelo: %zu",
+                 can_tracker->original_can_id, gw_tracker_in_flight());
+    }
+
+    write_test_result("test_tracker_alloc_and_lookup",
+                     "Verifica que el token generado localiza el slot reservado",
+                     test_passed, details);
+
+    CU_ASSERT_PTR_EQUAL(found, slot);
+    CU_ASSERT_PTR_NOT_NULL(can_tracker);
+    CU_ASSERT_EQUAL(gw_tracker_in_flight(), 1);
+
+    gw_tracker_release(slot);
+    CU_ASSERT_EQUAL(gw_tracker_in_flight(), 0);
+}
+
+// Test: Un token de un slot liberado y reutilizado no debe coincidir
+void test_tracker_stale_token_rejected(void) {
+    char details[512];
+    bool test_passed = true;
+    uint8_t old_token[GW_TRACKER_TOKEN_LEN];
+    uint8_t new_token[GW_TRACKER_TOKEN_LEN];
+
+    gw_tracker_init();
+    gw_tracker_slot_t *first = gw_tracker_alloc(GW_TRACKER_ORIGIN_CAN, old_token);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(first);
+    first->span.ns[GW_SPAN_CAN_RX] = gw_tracker_now_ns();
+    first->span.ns[GW_SPAN_COAP_TX] = gw_tracker_now_ns();
+    CU_ASSERT_TRUE(first->span.ns[GW_SPAN_COAP_TX] >= first->span.ns[GW_SPAN_CAN_RX]);
+    gw_tracker_release(first);
+
+    gw_tracker_slot_t *second = gw_tracker_alloc(GW_TRACKER_ORIGIN_API, new_token);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(second);
+
+    coap_bin_const_t old_bin = { GW_TRACKER_TOKEN_LEN, old_token };
+    coap_bin_const_t new_bin = { GW_TRACKER_TOKEN_LEN, new_token };
+
+    if (second != first) {
+        test_passed = false;
+        snprintf(details, sizeof(details), "El slot liberado no se reutilizó");
+    } else if (gw_tracker_lookup(old_bin) != NULL) {
+        test_passed = false;
+        snprintf(details, sizeof(details), "El token obsoleto localizó el slot reutilizado");
+    } else if (find_can_tracker(new_bin) != NULL) {
+        test_passed = false;
+        snprintf(details, sizeof(details), "find_can_tracker devolvió un slot de origen API");
+    } else if (second->span.ns[GW_SPAN_CAN_RX] != 0 || second->span.ns[GW_SPAN_COAP_TX] != 0) {
+        test_passed = false;
+        snprintf(details, sizeof(details), "El slot reutilizado conserva los instantes de la solicitud anterior");
+    } else {
+        snprintf(details, sizeof(details), "Token obsoleto rechazado tras reutilizar el slot");
+    }
+
+    write_test_result("test_tracker_stale_token_rejected",
+                     "Verifica que la generación invalida tokens de solicitudes ya liberadas",
+                     test_passed, details);
+
+    CU_ASSERT_PTR_EQUAL(second, first);
+    CU_ASSERT_PTR_NULL(gw_tracker_lookup(old_bin));
+    CU_ASSERT_PTR_EQUAL(gw_tracker_lookup(new_bin), second);
+    CU_ASSERT_PTR_NULL(find_can_tracker(new_bin));
+}
+
+// Test: Con el slab lleno la reserva falla sin sobrescribir slots vivos
+void test_tracker_slab_full(void) {
+    char details[512];
+    bool test_passed = true;
+    uint8_t token[GW_TRACKER_TOKEN_LEN];
+    uint8_t first_token[GW_TRACKER_TOKEN_LEN];
+
+    gw_tracker_init();
+    for (int i = 0; i < GW_TRACKER_SLAB_CAPACITY; i++) {
+        if (!gw_tracker_alloc(GW_TRACKER_ORIGIN_CAN, i == 0 ? first_token : token)) {
+            test_passed = false;
+            snprintf(details, sizeof(details), "Reserva %d falló antes de llenar el slab", i);
+            break;
+        }
+    }
+
+    gw_tracker_slot_t *overflow = gw_tracker_alloc(GW_TRACKER_ORIGIN_CAN, token);
+    coap_bin_const_t first_bin = { GW_TRACKER_TOKEN_LEN, first_token };
+
+    if (test_passed) {
+        if (overflow != NULL) {
+            test_passed = false;
+            snprintf(details, sizeof(details), "Se reservó un slot con el slab lleno");
+        } else if (gw_tracker_lookup(first_bin) == NULL) {
+            test_passed = false;
+            snprintf(details, sizeof(details), "El primer tracker fue sobrescrito");
+        } else {
+            snprintf(details, sizeof(details), "Slab lleno con %d slots; reserva adicional rechazada",
+                     GW_TRACKER_SLAB_CAPACITY);
+        }
+    }
+
+    write_test_result("test_tracker_slab_full",
+                     "Verifica que un slab lleno no sobrescribe solicitudes en vuelo",
+                     test_passed, details);
+
+    CU_ASSERT_PTR_NULL(overflow);
+    CU_ASSERT_PTR_NOT_NULL(gw_tracker_lookup(first_bin));
+    CU_ASSERT_EQUAL(gw_tracker_in_flight(), GW_TRACKER_SLAB_CAPACITY);
+
+    gw_tracker_cleanup();
+    CU_ASSERT_EQUAL(gw_tracker_in_flight(), 0);
+}
+
+static int expired_callback_count = 0;
+
+/**
+ * @brief Callback de expiración usado por test_tracker_expire_by_deadline
+ * @param slot Slot expirado
+ */
+static void count_expired_slot(gw_tracker_slot_t *slot) {
+    if (slot && slot->origin == GW_TRACKER_ORIGIN_CAN) {
+        expired_callback_count++;
+    }
+}
+
+// Test: Los trackers sin respuesta expiran en orden al alcanzar su deadline
+void test_tracker_expire_by_deadline(void) {
+    char details[512];
+    bool test_passed = true;
+    uint8_t token[GW_TRACKER_TOKEN_LEN];
+
+    gw_tracker_init();
+    gw_tracker_set_timeout_ms(1000);
+    expired_callback_count = 0;
+
+    gw_tracker_slot_t *first = gw_tracker_alloc(GW_TRACKER_ORIGIN_CAN, token);
+    gw_tracker_slot_t *second = gw_tracker_alloc(GW_TRACKER_ORIGIN_CAN, token);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(first);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(second);
+
+    uint64_t deadline = gw_tracker_next_deadline_ms();
+    size_t early = gw_tracker_expire(deadline - 1, count_expired_slot);
+    size_t expired = gw_tracker_expire(second->deadline_ms, count_expired_slot);
+
+    if (deadline != first->deadline_ms) {
+        test_passed = false;
+        snprintf(details, sizeof(details), "El próximo deadline no corresponde al slot más antiguo");
+    } else if (early != 0) {
+        test_passed = false;
+        snprintf(details, sizeof(details), "Se expiraron %zu trackers antes de su deadline", early);
+    } else if (expired != 2 || expired_callback_count != 2) {
+        test_passed = false;
+        snprintf(details, sizeof(details), "Expirados: %zu, callbacks: %d (esperados 2)",
+                 expired, expired_callback_count);
+    } else {
+        snprintf(details, sizeof(details), "2 trackers expirados al alcanzar su deadline; en vuelo: %zu",
+                 gw_tracker_in_flight());
+    }
+
+    write_test_result("test_tracker_expire_by_deadline",
+                     "Verifica que las solicitudes sin respuesta se liberan al vencer su deadline",
+                     test_passed, details);
+
+    CU_ASSERT_EQUAL(early, 0);
+    CU_ASSERT_EQUAL(expired, 2);
+    CU_ASSERT_EQUAL(expired_callback_count, 2);
+    CU_ASSERT_EQUAL(gw_tracker_in_flight(), 0);
+    CU_ASSERT_EQUAL(gw_tracker_next_deadline_ms(), 0);
+
+    gw_tracker_set_timeout_ms(GW_TRACKER_DEFAULT_TIMEOUT_MS);
+}
+
+// Test: Acortar el timeout con solicitudes en vuelo no retrasa las nuevas
+void test_tracker_timeout_shortened_in_flight(void) {
+    char details[512];
+    bool test_passed = true;
+    uint8_t token[GW_TRACKER_TOKEN_LEN];
+
+    gw_tracker_init();
+    expired_callback_count = 0;
+
+    // Solicitud reservada con el timeout anterior, luego recarga (SIGHUP) más corta
+    gw_tracker_set_timeout_ms(60000);
+    gw_tracker_slot_t *old_slot = gw_tracker_alloc(GW_TRACKER_ORIGIN_CAN, token);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(old_slot);
+    gw_tracker_set_timeout_ms(1000);
+    gw_tracker_slot_t *new_slot = gw_tracker_alloc(GW_TRACKER_ORIGIN_CAN, token);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(new_slot);
+    uint64_t old_deadline = old_slot->deadline_ms;
+    uint64_t new_deadline = new_slot->deadline_ms;
+
+    uint64_t next = gw_tracker_next_deadline_ms();
+    size_t expired = gw_tracker_expire(new_deadline, count_expired_slot);
+    size_t visited = gw_tracker_for_each(NULL, NULL);
+    uint64_t remaining = gw_tracker_next_deadline_ms();
+
+    if (next != new_deadline) {
+        test_passed = false;
+        snprintf(details, sizeof(details), "El próximo deadline es %llu ms; esperado el de la reserva nueva (%llu ms)",
+                 (unsigned long long)next, (unsigned long long)new_deadline);
+    } else if (expired != 1 || gw_tracker_lookup((coap_bin_const_t){ GW_TRACKER_TOKEN_LEN, token }) != NULL) {
+        test_passed = false;
+        snprintf(details, sizeof(details), "Expirados en el deadline corto: %zu (esperado solo el nuevo)", expired);
+    } else if (visited != 1 || remaining != old_deadline) {
+        test_passed = false;
+        snprintf(details, sizeof(details), "Tras expirar quedan %zu slots con deadline %llu ms",
+                 visited, (unsigned long long)remaining);
+    } else {
+        snprintf(details, sizeof(details), "La reserva con timeout corto expira antes que la anterior (%llu ms antes)",
+                 (unsigned long long)(old_deadline - new_deadline));
+    }
+
+    write_test_result("test_tracker_timeout_shortened_in_flight",
+                     "Verifica que acortar el timeout por recarga no retrasa la expiración de las reservas nuevas",
+                     test_passed, details);
+
+    CU_ASSERT_EQUAL(next, new_deadline);
+    CU_ASSERT_EQUAL(expired, 1);
+    CU_ASSERT_EQUAL(expired_callback_count, 1);
+    CU_ASSERT_EQUAL(remaining, old_deadline);
+    CU_ASSERT_EQUAL(gw_tracker_in_flight(), 1);
+
+    gw_tracker_cleanup();
+    gw_tracker_set_timeout_ms(GW_TRACKER_DEFAULT_TIMEOUT_MS);
+}
+
+/**
+ * @brief Limpia y cierra el archivo de reporte
+ */
+void close_report_file(void) {
+    if (report_file) {
+        fprintf(report_file, "=== FIN DEL REPORTE ===\n");
+        fclose(report_file);
+        report_file = NULL;
+    }
+}
+
+/**
+ * @brief Configura la suite de pruebas del slab de trackers
+ * @return Puntero a la suite configurada, o NULL si hay error
+ */
+CU_pSuite add_request_tracker_tests(void) {
+    CU_pSuite suite = CU_add_suite("Request Tracker Slab Tests",
+                                   setup_request_tracker_tests,
+                                   teardown_request_tracker_tests);
+
+    if (suite == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(suite, "test_tracker_alloc_and_lookup", test_tracker_alloc_and_lookup) == NULL ||
+        CU_add_test(suite, "test_tracker_stale_token_rejected", test_tracker_stale_token_rejected) == NULL ||
+        CU_add_test(suite, "test_tracker_slab_full", test_tracker_slab_full) == NULL ||
+        CU_add_test(suite, "test_tracker_expire_by_deadline", test_tracker_expire_by_deadline) == NULL ||
+        CU_add_test(suite, "test_tracker_timeout_shortened_in_flight", test_tracker_timeout_shortened_in_flight) == NULL) {
+        return NULL;
+    }
+
+    return suite;
+}
+
+// Main para ejecutar solo estas pruebas
+int main(int argc, char *argv[]) {
+    bool automated = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--automated") == 0) {
+            automated = true;
+        }
+    }
+
+    if (CU_initialize_registry() != CUE_SUCCESS) {
+        return CU_get_error();
+    }
+
+    if (add_request_tracker_tests() == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    if (automated) {
+        CU_automated_run_tests();
+        CU_list_tests_to_file();
+    } else {
+        CU_basic_set_mode(CU_BRM_VERBOSE);
+        CU_basic_run_tests();
+    }
+
+    close_report_file();
+
+    printf("\n=== RESUMEN DE PRUEBAS: SLAB DE TRACKERS ===\n");
+    printf("Pruebas ejecutadas: %u\n", CU_get_number_of_tests_run());
+    printf("Fallos: %u\n", CU_get_number_of_failures());
+    printf("Reporte detallado guardado en: test_request_tracker_report.txt\n");
+
+    CU_cleanup_registry();
+    return (CU_get_number_of_failures() == 0) ? 0 : 1;
+}
@@ -0,0 +1,397 @@
+/**
+ * @file test_scenario_binary.c
+ * @brief Pruebas unitarias para el formato binario de escenarios
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Este archivo contiene las pruebas unitarias para verificar la
+ * compilación y proyección de escenarios de scenario_binary.c, incluyendo:
+ * - Compilación de un escenario JSON y equivalencia con la carga del JSON
+ * - Cargas parciales de simulation_loader.c sobre el fichero binario
+ * - Rechazo de ficheros truncados, incoherentes o con registros inválidos
+ *
+ * @see scenario_binary.h
+ * @see simulation_loader.h
+ */
+
+#include <CUnit/CUnit.h>
+#include <CUnit/Basic.h>
+#include <CUnit/Automated.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "api_gateway/scenario_binary.h"
+#include "api_gateway/simulation_loader.h"
+
+#define TEST_JSON_FILE "test_scenario_binary_data.json"
+#define TEST_BIN_FILE "test_scenario_binary_data.bin"
+#define TEST_NUM_BUILDINGS 2000
+#define TEST_NUM_REQUESTS 10
+#define TEST_INTERVAL_MS 1500
+#define TEST_BURST_BUILDING 3
+#define TEST_BURST_REQUESTS 5
+#define TEST_BURST_GAP_MS 100
+
+static FILE *report_file = NULL;
+
+/**
+ * @brief Genera un escenario JSON de prueba
+ *
+ * Edificio i: ID "B%04d"; petición j alterna llamada de piso y solicitud
+ * de cabina, y el edificio 7 no tiene peticiones. Las TEST_BURST_REQUESTS
+ * primeras peticiones del edificio TEST_BURST_BUILDING llevan "instante_ms"
+ * (una ráfaga cada TEST_BURST_GAP_MS); el resto no.
+ */
+static bool write_json_scenario(void) {
+    FILE *f = fopen(TEST_JSON_FILE, "w");
+    if (!f) {
+        return false;
+    }
+    fprintf(f, "{\"edificios\": [\n");
+    for (int i = 0; i < TEST_NUM_BUILDINGS; ++i) {
+        fprintf(f, "{\"id_edificio\": \"B%04d\", \"peticiones\": [", i);
+        for (int j = 0; i != 7 && j < TEST_NUM_REQUESTS; ++j) {
+            if (i == TEST_BURST_BUILDING && j < TEST_BURST_REQUESTS) {
+                fprintf(f, "{\"instante_ms\": %d, ", j * TEST_BURST_GAP_MS);
+            } else {
+                fprintf(f, "{");
+            }
+            if (j % 2 == 0) {
+                fprintf(f, "\"tipo\": \"llamada_piso\", \"piso_origen\": %d, \"direccion\": \"%s\"}",
+                        (i + j) % 14, (i * j) % 2 ? "down" : "up");
+            } else {
+                fprintf(f, "\"tipo\": \"solicitud_cabina\", \"indice_ascensor\": %d, \"piso_destino\": %d}",
+                        (i + j) % 4, (i + 3 * j) % 14);
+            }
+            fprintf(f, "%s", j + 1 < TEST_NUM_REQUESTS ? ", " : "");
+        }
+        fprintf(f, "]}%s\n", i + 1 < TEST_NUM_BUILDINGS ? "," : "");
+    }
+    fprintf(f, "]}\n");
+    fclose(f);
+    return true;
+}
+
+/**
+ * @brief Compara dos cargas edificio a edificio y petición a petición
+ */
+static bool same_data(const datos_simulacion_t *a, const datos_simulacion_t *b) {
+    if (a->num_edificios != b->num_edificios) {
+        return false;
+    }
+    for (int i = 0; i < a->num_edificios; ++i) {
+        const edificio_simulacion_t *ea = &a->edificios[i];
+        const edificio_simulacion_t *eb = &b->edificios[i];
+        if (strcmp(ea->id_edificio, eb->id_edificio) != 0 || ea->num_peticiones != eb->num_peticiones) {
+            return false;
+        }
+        for (int j = 0; j < ea->num_peticiones; ++j) {
+            const peticion_simulacion_t *pa = &ea->peticiones[j];
+            const peticion_simulacion_t *pb = &eb->peticiones[j];
+            if (pa->tipo != pb->tipo || pa->piso_origen != pb->piso_origen || pa->direccion != pb->direccion ||
+                pa->indice_ascensor != pb->indice_ascensor || pa->piso_destino != pb->piso_destino ||
+                pa->tiene_instante != pb->tiene_instante || pa->instante_ms != pb->instante_ms ||
+                pa->pasajeros != pb->pasajeros) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Copia el fichero binario aplicando un parche en @p offset
+ */
+static bool write_patched_copy(const char *path, long offset, const void *patch, size_t len, long truncate_to) {
+    FILE *in = fopen(TEST_BIN_FILE, "rb");
+    FILE *out = fopen(path, "wb");
+    if (!in || !out) {
+        if (in) fclose(in);
+        if (out) fclose(out);
+        return false;
+    }
+    int c;
+    long pos = 0;
+    while ((c = fgetc(in)) != EOF && (truncate_to < 0 || pos < truncate_to)) {
+        if (patch && pos >= offset && pos < offset + (long)len) {
+            c = ((const unsigned char *)patch)[pos - offset];
+        }
+        fputc(c, out);
+        pos++;
+    }
+    fclose(in);
+    fclose(out);
+    return true;
+}
+
+/**
+ * @brief Función de setup para la suite del formato binario
+ * @return 0 si el setup es exitoso
+ */
+int setup_scenario_binary_tests(void) {
+    if (!report_file) {
+        report_file = fopen("test_scenario_binary_report.txt", "w");
+        if (report_file) {
+            time_t now = time(NULL);
+            fprintf(report_file, "=== REPORTE DE PRUEBAS: ESCENARIOS BINARIOS ===\n");
+            fprintf(report_file, "Fecha: %s\n", ctime(&now));
+            fprintf(report_file, "===============================================\n\n");
+        }
+    }
+    return (write_json_scenario() && gw_scenario_bin_compile(TEST_JSON_FILE, TEST_BIN_FILE, TEST_INTERVAL_MS)) ? 0 : -1;
+}
+
+/**
+ * @brief Función de teardown para la suite del formato binario
+ * @return 0 si el teardown es exitoso
+ */
+int teardown_scenario_binary_tests(void) {
+    remove(TEST_JSON_FILE);
+    remove(TEST_BIN_FILE);
+    return 0;
+}
+
+/**
+ * @brief Escribe el resultado de una prueba individual al archivo de reporte
+ * @param test_name Nombre de la prueba ejecutada
+ * @param description Descripción de lo que verifica la prueba
+ * @param passed Indica si la prueba pasó (true) o falló (false)
+ * @param details Detalles específicos del resultado de la prueba
+ */
+void write_test_result(const char* test_name, const char* description, bool passed, const char* details) {
+    if (report_file) {
+        fprintf(report_file, "PRUEBA: %s\n", test_name);
+        fprintf(report_file, "Descripción: %s\n", description);
+        fprintf(report_file, "Resultado: %s\n", passed ? "PASÓ" : "FALLÓ");
+        if (details) {
+            fprintf(report_file, "Detalles: %s\n", details);
+        }
+        fprintf(report_file, "----------------------------------------\n\n");
+        fflush(report_file);
+    }
+}
+
+// Test: El fichero compilado reproduce el JSON y marca los instantes de llegada
+void test_scenario_binary_roundtrip(void) {
+    char details[256];
+    gw_scenario_map_t map;
+    CU_ASSERT_TRUE(gw_scenario_bin_is_binary(TEST_BIN_FILE));
+    CU_ASSERT_FALSE(gw_scenario_bin_is_binary(TEST_JSON_FILE));
+    CU_ASSERT_TRUE_FATAL(gw_scenario_bin_map(TEST_BIN_FILE, &map));
+
+    bool header_ok = map.header->num_buildings == TEST_NUM_BUILDINGS &&
+                     map.header->num_records == (uint64_t)(TEST_NUM_BUILDINGS - 1) * TEST_NUM_REQUESTS &&
+                     map.size == map.header->buildings_offset + TEST_NUM_BUILDINGS * sizeof(gw_scenario_building_t);
+    CU_ASSERT_TRUE(header_ok);
+
+    // Instantes k * intervalo dentro de cada edificio salvo la ráfaga; el edificio 7 está vacío
+    bool offsets_ok = map.buildings[7].num_records == 0 && gw_scenario_bin_find(&map, "B1999") == 1999 &&
+                      gw_scenario_bin_find(&map, "B9999") == -1;
+    for (uint32_t i = 0; offsets_ok && i < map.header->num_buildings; ++i) {
+        const gw_scenario_building_t *b = &map.buildings[i];
+        uint32_t esperado = 0;
+        for (uint32_t k = 0; offsets_ok && k < b->num_records; ++k) {
+            const gw_scenario_record_t *r = &map.records[b->first_record + k];
+            bool rafaga = i == TEST_BURST_BUILDING && k < TEST_BURST_REQUESTS;
+            esperado = rafaga ? k * TEST_BURST_GAP_MS : (k ? esperado + TEST_INTERVAL_MS : 0);
+            offsets_ok = r->offset_ms == esperado && (r->flags == GW_SCENARIO_REC_INSTANTE) == rafaga;
+        }
+        offsets_ok = offsets_ok && (b->num_records == 0 || b->duration_ms == esperado);
+    }
+    CU_ASSERT_TRUE(offsets_ok);
+    gw_scenario_bin_unmap(&map);
+    CU_ASSERT_PTR_NULL(map.base);
+
+    datos_simulacion_t desde_json, desde_bin;
+    bool same = cargar_datos_simulacion(TEST_JSON_FILE, &desde_json) &&
+                cargar_datos_simulacion(TEST_BIN_FILE, &desde_bin) && same_data(&desde_json, &desde_bin);
+    liberar_datos_simulacion(&desde_json);
+    liberar_datos_simulacion(&desde_bin);
+    CU_ASSERT_TRUE(same);
+
+    snprintf(details, sizeof(details), "cabecera: %s, instantes: %s, mismas peticiones que el JSON: %s",
+             header_ok ? "sí" : "no", offsets_ok ? "sí" : "no", same ? "sí" : "no");
+    write_test_result("test_scenario_binary_roundtrip",
+                      "Compila 2000 edificios y comprueba índice, instantes y equivalencia con el JSON",
+                      header_ok && offsets_ok && same, details);
+}
+
+// Test: Cargas parciales sobre el fichero binario
+void test_scenario_binary_partial_loads(void) {
+    char details[256];
+    datos_simulacion_t json, bin;
+
+    bool primeros = cargar_primeros_edificios(TEST_JSON_FILE, 25, &json) &&
+                    cargar_primeros_edificios(TEST_BIN_FILE, 25, &bin) &&
+                    bin.num_edificios == 25 && same_data(&json, &bin);
+    liberar_datos_simulacion(&json);
+    liberar_datos_simulacion(&bin);
+    CU_ASSERT_TRUE(primeros);
+
+    bool por_id = cargar_edificio_simulacion(TEST_JSON_FILE, 0, "B1500", &json) &&
+                  cargar_edificio_simulacion(TEST_BIN_FILE, 0, "B1500", &bin) && same_data(&json, &bin);
+    liberar_datos_simulacion(&json);
+    liberar_datos_simulacion(&bin);
+    CU_ASSERT_TRUE(por_id);
+
+    bool por_indice = cargar_edificio_simulacion(TEST_BIN_FILE, 7, NULL, &bin) && bin.num_edificios == 1 &&
+                      strcmp(bin.edificios[0].id_edificio, "B0007") == 0 && bin.edificios[0].num_peticiones == 0;
+    liberar_datos_simulacion(&bin);
+    CU_ASSERT_TRUE(por_indice);
+
+    bool inexistente = !cargar_edificio_simulacion(TEST_BIN_FILE, TEST_NUM_BUILDINGS, NULL, &bin) &&
+                       bin.edificios == NULL && !cargar_edificio_simulacion(TEST_BIN_FILE, 0, "X", &bin);
+    CU_ASSERT_TRUE(inexistente);
+
+    bool aleatorio = true;
+    for (int k = 0; k < 10 && aleatorio; ++k) {
+        aleatorio = cargar_edificio_aleatorio(TEST_BIN_FILE, &bin) && bin.num_edificios == 1 &&
+                    cargar_edificio_simulacion(TEST_JSON_FILE, 0, bin.edificios[0].id_edificio, &json) &&
+                    same_data(&json, &bin);
+        liberar_datos_simulacion(&json);
+        liberar_datos_simulacion(&bin);
+    }
+    CU_ASSERT_TRUE(aleatorio);
+
+    snprintf(details, sizeof(details), "25 primeros: %s, por ID: %s, por índice: %s, inexistente rechazado: %s, aleatorio: %s",
+             primeros ? "sí" : "no", por_id ? "sí" : "no", por_indice ? "sí" : "no",
+             inexistente ? "sí" : "no", aleatorio ? "sí" : "no");
+    write_test_result("test_scenario_binary_partial_loads",
+                      "Las cargas parciales dan el mismo resultado desde el binario que desde el JSON",
+                      primeros && por_id && por_indice && inexistente && aleatorio, details);
+}
+
+// Test: Ficheros corruptos se rechazan
+void test_scenario_binary_invalid(void) {
+    char details[256];
+    const char *corrupto = "test_scenario_binary_corrupt.bin";
+    gw_scenario_map_t map;
+    CU_ASSERT_TRUE_FATAL(gw_scenario_bin_map(TEST_BIN_FILE, &map));
+    gw_scenario_bin_header_t header = *map.header;
+    gw_scenario_building_t building = map.buildings[3];
+    long records_offset = (long)header.records_offset;
+    long buildings_offset = (long)header.buildings_offset;
+    gw_scenario_bin_unmap(&map);
+
+    // Truncado: el índice queda fuera del fichero
+    bool truncado = write_patched_copy(corrupto, 0, NULL, 0, buildings_offset + 100) &&
+                    !gw_scenario_bin_map(corrupto, &map);
+    CU_ASSERT_TRUE(truncado);
+
+    // Versión desconocida
+    gw_scenario_bin_header_t h = header;
+    h.version = GW_SCENARIO_BIN_VERSION + 1;
+    bool version = write_patched_copy(corrupto, 0, &h, sizeof(h), -1) && !gw_scenario_bin_map(corrupto, &map);
+    CU_ASSERT_TRUE(version);
+
+    // Edificio cuyo rango de registros se sale del fichero
+    gw_scenario_building_t b = building;
+    b.first_record = header.num_records - 2;
+    bool rango = write_patched_copy(corrupto, buildings_offset + 3 * (long)sizeof(b), &b, sizeof(b), -1) &&
+                 !gw_scenario_bin_map(corrupto, &map);
+    CU_ASSERT_TRUE(rango);
+
+    // Registro con tipo inválido: la proyección es válida pero la carga del edificio falla
+    gw_scenario_record_t r;
+    memset(&r, 0, sizeof(r));
+    r.tipo = 9;
+    datos_simulacion_t datos;
+    bool registro = write_patched_copy(corrupto, records_offset + (long)(building.first_record * sizeof(r)), &r, sizeof(r), -1) &&
+                    !cargar_edificio_simulacion(corrupto, 3, NULL, &datos) && datos.edificios == NULL &&
+                    cargar_edificio_simulacion(corrupto, 4, NULL, &datos);
+    liberar_datos_simulacion(&datos);
+    CU_ASSERT_TRUE(registro);
+    remove(corrupto);
+
+    // Un JSON inválido no deja fichero de salida ni temporal
+    FILE *f = fopen(TEST_JSON_FILE ".bad", "w");
+    if (f) {
+        fputs("{\"edificios\": [{\"id_edificio\": \"E1\", \"peticiones\": [{\"tipo\": \"x\"}]}]}", f);
+        fclose(f);
+    }
+    bool sin_salida = !gw_scenario_bin_compile(TEST_JSON_FILE ".bad", corrupto, TEST_INTERVAL_MS) &&
+                      fopen(corrupto, "rb") == NULL && fopen("test_scenario_binary_corrupt.bin.tmp", "rb") == NULL;
+    remove(TEST_JSON_FILE ".bad");
+    CU_ASSERT_TRUE(sin_salida);
+
+    snprintf(details, sizeof(details), "truncado: %s, versión: %s, rango: %s, registro inválido: %s, compilación fallida limpia: %s",
+             truncado ? "rechazado" : "aceptado", version ? "rechazada" : "aceptada", rango ? "rechazado" : "aceptado",
+             registro ? "rechazado" : "aceptado", sin_salida ? "sí" : "no");
+    write_test_result("test_scenario_binary_invalid",
+                      "Rechaza ficheros truncados, de otra versión, con índices fuera de rango o registros inválidos",
+                      truncado && version && rango && registro && sin_salida, details);
+}
+
+/**
+ * @brief Limpia y cierra el archivo de reporte
+ */
+void close_report_file(void) {
+    if (report_file) {
+        fprintf(report_file, "=== FIN DEL REPORTE ===\n");
+        fclose(report_file);
+        report_file = NULL;
+    }
+}
+
+/**
+ * @brief Configura la suite de pruebas del formato binario
+ * @return Puntero a la suite configurada, o NULL si hay error
+ */
+CU_pSuite add_scenario_binary_tests(void) {
+    CU_pSuite suite = CU_add_suite("Scenario Binary Tests",
+                                   setup_scenario_binary_tests,
+                                   teardown_scenario_binary_tests);
+
+    if (suite == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(suite, "test_scenario_binary_roundtrip", test_scenario_binary_roundtrip) == NULL ||
+        CU_add_test(suite, "test_scenario_binary_partial_loads", test_scenario_binary_partial_loads) == NULL ||
+        CU_add_test(suite, "test_scenario_binary_invalid", test_scenario_binary_invalid) == NULL) {
+        return NULL;
+    }
+
+    return suite;
+}
+
+// Main para ejecutar solo estas pruebas
+int main(int argc, char *argv[]) {
+    bool automated = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--automated") == 0) {
+            automated = true;
+        }
+    }
+
+    if (CU_initialize_registry() != CUE_SUCCESS) {
+        return CU_get_error();
+    }
+
+    if (add_scenario_binary_tests() == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    if (automated) {
+        CU_automated_run_tests();
+        CU_list_tests_to_file();
+    } else {
+        CU_basic_set_mode(CU_BRM_VERBOSE);
+        CU_basic_run_tests();
+    }
+
+    close_report_file();
+
+    printf("\n=== RESUMEN DE PRUEBAS: ESCENARIOS BINARIOS ===\n");
+    printf("Pruebas ejecutadas: %u\n", CU_get_number_of_tests_run());
+    printf("Fallos: %u\n", CU_get_number_of_failures());
+    printf("Reporte detallado guardado en: test_scenario_binary_report.txt\n");
+
+    CU_cleanup_registry();
+    return (CU_get_number_of_failures() == 0) ? 0 : 1;
+}
@@ -0,0 +1,369 @@
+/**
+ * @file test_scenario_stream.c
+ * @brief Pruebas unitarias para la lectura en streaming de escenarios
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Este archivo contiene las pruebas unitarias para verificar el lector
+ * incremental de scenario_stream.c y las cargas parciales de
+ * simulation_loader.c, incluyendo:
+ * - Claves en cualquier orden, claves desconocidas y escapes en cadenas
+ * - Carga de los N primeros edificios, de uno por ID o índice y de uno aleatorio
+ * - Rechazo de escenarios mal formados sin dejar memoria reservada
+ *
+ * @see scenario_stream.h
+ * @see simulation_loader.h
+ */
+
+#include <CUnit/CUnit.h>
+#include <CUnit/Basic.h>
+#include <CUnit/Automated.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "api_gateway/scenario_stream.h"
+#include "api_gateway/simulation_loader.h"
+
+#define TEST_SCENARIO_FILE "test_scenario_stream_data.json"
+#define TEST_LARGE_BUILDINGS 5000
+#define TEST_LARGE_REQUESTS 10
+
+static FILE *report_file = NULL;
+
+/**
+ * @brief Escribe @p contenido en el fichero de escenario de prueba
+ */
+static bool write_scenario(const char *contenido) {
+    FILE *f = fopen(TEST_SCENARIO_FILE, "w");
+    if (!f) {
+        return false;
+    }
+    fputs(contenido, f);
+    fclose(f);
+    return true;
+}
+
+/**
+ * @brief Genera un escenario grande con el formato de generate_simulation_data.py
+ *
+ * Edificio i: ID "E%04d"; petición j alterna llamada de piso (piso i % 14 + j)
+ * y solicitud de cabina (ascensor j % 4, destino i % 14).
+ */
+static bool write_large_scenario(void) {
+    FILE *f = fopen(TEST_SCENARIO_FILE, "w");
+    if (!f) {
+        return false;
+    }
+    fprintf(f, "{\n  \"edificios\": [\n");
+    for (int i = 0; i < TEST_LARGE_BUILDINGS; ++i) {
+        fprintf(f, "    {\n      \"id_edificio\": \"E%04d\",\n      \"peticiones\": [\n", i);
+        for (int j = 0; j < TEST_LARGE_REQUESTS; ++j) {
+            if (j % 2 == 0) {
+                fprintf(f, "        {\"tipo\": \"llamada_piso\", \"piso_origen\": %d, \"direccion\": \"%s\"}",
+                        i % 14 + j, (i + j) % 3 ? "up" : "down");
+            } else {
+                fprintf(f, "        {\"tipo\": \"solicitud_cabina\", \"indice_ascensor\": %d, \"piso_destino\": %d}",
+                        j % 4, i % 14);
+            }
+            fprintf(f, "%s\n", j + 1 < TEST_LARGE_REQUESTS ? "," : "");
+        }
+        fprintf(f, "      ]\n    }%s\n", i + 1 < TEST_LARGE_BUILDINGS ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    fclose(f);
+    return true;
+}
+
+/**
+ * @brief Comprueba que un edificio cargado coincide con write_large_scenario()
+ */
+static bool large_building_matches(const edificio_simulacion_t *edificio, int i) {
+    char id[16];
+    snprintf(id, sizeof(id), "E%04d", i);
+    if (strcmp(edificio->id_edificio, id) != 0 || edificio->num_peticiones != TEST_LARGE_REQUESTS) {
+        return false;
+    }
+    for (int j = 0; j < TEST_LARGE_REQUESTS; ++j) {
+        const peticion_simulacion_t *p = &edificio->peticiones[j];
+        if (j % 2 == 0) {
+            if (p->tipo != PETICION_LLAMADA_PISO || p->piso_origen != i % 14 + j ||
+                p->direccion != ((i + j) % 3 ? MOVING_UP : MOVING_DOWN)) {
+                return false;
+            }
+        } else if (p->tipo != PETICION_SOLICITUD_CABINA || p->indice_ascensor != j % 4 ||
+                   p->piso_destino != i % 14) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Función de setup para la suite del lector de escenarios
+ * @return 0 si el setup es exitoso
+ */
+int setup_scenario_stream_tests(void) {
+    if (!report_file) {
+        report_file = fopen("test_scenario_stream_report.txt", "w");
+        if (report_file) {
+            time_t now = time(NULL);
+            fprintf(report_file, "=== REPORTE DE PRUEBAS: LECTURA EN STREAMING DE ESCENARIOS ===\n");
+            fprintf(report_file, "Fecha: %s\n", ctime(&now));
+            fprintf(report_file, "=============================================================\n\n");
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Función de teardown para la suite del lector de escenarios
+ * @return 0 si el teardown es exitoso
+ */
+int teardown_scenario_stream_tests(void) {
+    remove(TEST_SCENARIO_FILE);
+    return 0;
+}
+
+/**
+ * @brief Escribe el resultado de una prueba individual al archivo de reporte
+ * @param test_name Nombre de la prueba ejecutada
+ * @param description Descripción de lo que verifica la prueba
+ * @param passed Indica si la prueba pasó (true) o falló (false)
+ * @param details Detalles específicos del resultado de la prueba
+ */
+void write_test_result(const char* test_name, const char* description, bool passed, const char* details) {
+    if (report_file) {
+        fprintf(report_file, "PRUEBA: %s\n", test_name);
+        fprintf(report_file, "Descripción: %s\n", description);
+        fprintf(report_file, "Resultado: %s\n", passed ? "PASÓ" : "FALLÓ");
+        if (details) {
+            fprintf(report_file, "Detalles: %s\n", details);
+        }
+        fprintf(report_file, "----------------------------------------\n\n");
+        fflush(report_file);
+    }
+}
+
+// Test: Claves desordenadas, claves desconocidas y peticiones antes del ID
+void test_scenario_stream_key_order(void) {
+    char details[256];
+    const char *escenario =
+        "{\"version\": 2, \"meta\": {\"nota\": \"llaves } y ] en \\\"cadena\\\"\", \"v\": [1, {\"a\": null}]},\n"
+        " \"edificios\": [\n"
+        "  {\"id_edificio\": \"E\\u0041\", \"extra\": [true, false],\n"
+        "   \"peticiones\": [{\"direccion\": \"down\", \"piso_origen\": 7, \"tipo\": \"llamada_piso\"},\n"
+        "                   {\"tipo\": \"solicitud_cabina\", \"comentario\": \"}\", \"piso_destino\": 2, \"indice_ascensor\": 1}]},\n"
+        "  {\"peticiones\": [{\"instante_ms\": 250, \"tipo\": \"llamada_piso\", \"piso_origen\": 3, \"direccion\": \"up\"}],\n"
+        "   \"otro\": {\"x\": -1.5e3}, \"id_edificio\": \"E2\"},\n"
+        "  {\"id_edificio\": \"E3\", \"peticiones\": []}\n"
+        " ]}\n";
+    CU_ASSERT_TRUE_FATAL(write_scenario(escenario));
+
+    gw_scenario_stream_t *s = gw_scenario_open(TEST_SCENARIO_FILE);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(s);
+
+    char id[16];
+    peticion_simulacion_t p;
+    bool ok = gw_scenario_next_building(s, id, sizeof(id)) == 1 && strcmp(id, "EA") == 0;
+    ok = ok && gw_scenario_next_request(s, &p) == 1 && p.tipo == PETICION_LLAMADA_PISO &&
+         p.piso_origen == 7 && p.direccion == MOVING_DOWN && !p.tiene_instante;
+    ok = ok && gw_scenario_next_request(s, &p) == 1 && p.tipo == PETICION_SOLICITUD_CABINA &&
+         p.indice_ascensor == 1 && p.piso_destino == 2;
+    ok = ok && gw_scenario_next_request(s, &p) == 0;
+    CU_ASSERT_TRUE(ok);
+
+    // E2: las peticiones preceden al ID
+    int64_t offset_e2 = -1;
+    bool ok_e2 = gw_scenario_next_building(s, id, sizeof(id)) == 1 && strcmp(id, "E2") == 0;
+    offset_e2 = gw_scenario_building_offset(s);
+    ok_e2 = ok_e2 && gw_scenario_next_request(s, &p) == 1 && p.piso_origen == 3 &&
+            p.direccion == MOVING_UP && p.tiene_instante && p.instante_ms == 250 &&
+            gw_scenario_next_request(s, &p) == 0;
+    CU_ASSERT_TRUE(ok_e2);
+
+    bool ok_e3 = gw_scenario_next_building(s, id, sizeof(id)) == 1 && strcmp(id, "E3") == 0 &&
+                 gw_scenario_next_request(s, &p) == 0 && gw_scenario_next_building(s, id, sizeof(id)) == 0;
+    CU_ASSERT_TRUE(ok_e3);
+
+    // Volver a E2 y saltar sus peticiones sin leerlas
+    bool ok_seek = gw_scenario_seek_building(s, offset_e2) == 0 &&
+                   gw_scenario_next_building(s, id, sizeof(id)) == 1 && strcmp(id, "E2") == 0 &&
+                   gw_scenario_next_building(s, id, sizeof(id)) == 1 && strcmp(id, "E3") == 0;
+    CU_ASSERT_TRUE(ok_seek);
+    gw_scenario_close(s);
+
+    snprintf(details, sizeof(details), "E1 con escapes: %s, peticiones antes del ID: %s, vacío: %s, vuelta a E2: %s",
+             ok ? "sí" : "no", ok_e2 ? "sí" : "no", ok_e3 ? "sí" : "no", ok_seek ? "sí" : "no");
+    write_test_result("test_scenario_stream_key_order",
+                      "Lee edificios con claves en cualquier orden y vuelve a un edificio ya visto",
+                      ok && ok_e2 && ok_e3 && ok_seek, details);
+}
+
+// Test: Cargas parciales sobre un escenario grande
+void test_scenario_stream_partial_loads(void) {
+    char details[256];
+    CU_ASSERT_TRUE_FATAL(write_large_scenario());
+
+    datos_simulacion_t datos;
+    bool todos = cargar_datos_simulacion(TEST_SCENARIO_FILE, &datos) &&
+                 datos.num_edificios == TEST_LARGE_BUILDINGS && datos.datos_cargados;
+    for (int i = 0; todos && i < TEST_LARGE_BUILDINGS; ++i) {
+        todos = large_building_matches(&datos.edificios[i], i);
+    }
+    liberar_datos_simulacion(&datos);
+    CU_ASSERT_TRUE(todos);
+
+    bool primeros = cargar_primeros_edificios(TEST_SCENARIO_FILE, 3, &datos) &&
+                    datos.num_edificios == 3 && large_building_matches(&datos.edificios[2], 2);
+    liberar_datos_simulacion(&datos);
+    CU_ASSERT_TRUE(primeros);
+
+    bool por_id = cargar_edificio_simulacion(TEST_SCENARIO_FILE, 0, "E4999", &datos) &&
+                  datos.num_edificios == 1 && large_building_matches(&datos.edificios[0], 4999);
+    liberar_datos_simulacion(&datos);
+    CU_ASSERT_TRUE(por_id);
+
+    bool por_indice = cargar_edificio_simulacion(TEST_SCENARIO_FILE, 1234, NULL, &datos) &&
+                      datos.num_edificios == 1 && large_building_matches(&datos.edificios[0], 1234);
+    liberar_datos_simulacion(&datos);
+    CU_ASSERT_TRUE(por_indice);
+
+    bool inexistente = !cargar_edificio_simulacion(TEST_SCENARIO_FILE, 0, "E9999", &datos) &&
+                       datos.num_edificios == 0 && datos.edificios == NULL;
+    CU_ASSERT_TRUE(inexistente);
+
+    bool aleatorio = true;
+    for (int k = 0; k < 5 && aleatorio; ++k) {
+        aleatorio = cargar_edificio_aleatorio(TEST_SCENARIO_FILE, &datos) && datos.num_edificios == 1 &&
+                    large_building_matches(&datos.edificios[0], atoi(datos.edificios[0].id_edificio + 1));
+        liberar_datos_simulacion(&datos);
+    }
+    CU_ASSERT_TRUE(aleatorio);
+
+    snprintf(details, sizeof(details),
+             "todos: %s, 3 primeros: %s, por ID: %s, por índice: %s, inexistente rechazado: %s, aleatorio: %s",
+             todos ? "sí" : "no", primeros ? "sí" : "no", por_id ? "sí" : "no",
+             por_indice ? "sí" : "no", inexistente ? "sí" : "no", aleatorio ? "sí" : "no");
+    write_test_result("test_scenario_stream_partial_loads",
+                      "Carga todos, los N primeros, uno por ID o índice y uno aleatorio de 5000 edificios",
+                      todos && primeros && por_id && por_indice && inexistente && aleatorio, details);
+}
+
+// Test: Escenarios mal formados se rechazan sin dejar datos a medias
+void test_scenario_stream_invalid(void) {
+    char details[256];
+    const char *invalidos[] = {
+        "{\"edificios\": [{\"id_edificio\": \"E1\", \"peticiones\": [{\"tipo\": \"teletransporte\"}]}]}",
+        "{\"edificios\": [{\"id_edificio\": \"E1\", \"peticiones\": [{\"tipo\": \"solicitud_cabina\", \"indice_ascensor\": 0}]}]}",
+        "{\"edificios\": [{\"id_edificio\": \"E1\", \"peticiones\": [{\"tipo\": \"llamada_piso\", \"piso_origen\": \"3\", \"direccion\": \"up\"}]}]}",
+        "{\"edificios\": [{\"id_edificio\": \"E1\", \"peticiones\": [{\"tipo\": \"solicitud_cabina\", \"indice_ascensor\": 0, \"piso_destino\": 1, \"instante_ms\": 500},"
+        " {\"tipo\": \"solicitud_cabina\", \"indice_ascensor\": 0, \"piso_destino\": 2, \"instante_ms\": 400}]}]}",
+        "{\"edificios\": [{\"id_edificio\": \"E1\", \"peticiones\": [{\"tipo\": \"llamada_piso\", \"piso_origen\": 0, \"direccion\": \"up\", \"instante_ms\": -5}]}]}",
+        "{\"edificios\": [{\"id_edificio\": 7, \"peticiones\": []}]}",
+        "{\"edificios\": [{\"id_edificio\": \"E1\"}]}",
+        "{\"edificios\": [{\"id_edificio\": \"E1\", \"peticiones\": [{\"tipo\": \"llamada_piso\", \"piso_or",
+        "{\"edificios\": [{\"id_edificio\": \"E1\", \"peticiones\": []} {\"id_edificio\": \"E2\"}]}",
+        "{\"otros\": []}",
+        "{\"edificios\": []}",
+        "[]",
+    };
+    const int num_invalidos = (int)(sizeof(invalidos) / sizeof(invalidos[0]));
+
+    int rechazados = 0;
+    for (int i = 0; i < num_invalidos; ++i) {
+        datos_simulacion_t datos;
+        CU_ASSERT_TRUE_FATAL(write_scenario(invalidos[i]));
+        bool cargado = cargar_datos_simulacion(TEST_SCENARIO_FILE, &datos);
+        if (!cargado && datos.edificios == NULL && datos.num_edificios == 0 && !datos.datos_cargados) {
+            rechazados++;
+        }
+        if (cargado) {
+            liberar_datos_simulacion(&datos);
+        }
+    }
+    CU_ASSERT_EQUAL(rechazados, num_invalidos);
+
+    datos_simulacion_t datos;
+    bool sin_fichero = !cargar_datos_simulacion("no_existe_test_scenario.json", &datos);
+    CU_ASSERT_TRUE(sin_fichero);
+
+    snprintf(details, sizeof(details), "rechazados %d de %d escenarios inválidos, fichero inexistente rechazado: %s",
+             rechazados, num_invalidos, sin_fichero ? "sí" : "no");
+    write_test_result("test_scenario_stream_invalid",
+                      "Rechaza tipos desconocidos, campos ausentes, instantes decrecientes, JSON truncado y escenarios sin edificios",
+                      rechazados == num_invalidos && sin_fichero, details);
+}
+
+/**
+ * @brief Limpia y cierra el archivo de reporte
+ */
+void close_report_file(void) {
+    if (report_file) {
+        fprintf(report_file, "=== FIN DEL REPORTE ===\n");
+        fclose(report_file);
+        report_file = NULL;
+    }
+}
+
+/**
+ * @brief Configura la suite de pruebas del lector de escenarios
+ * @return Puntero a la suite configurada, o NULL si hay error
+ */
+CU_pSuite add_scenario_stream_tests(void) {
+    CU_pSuite suite = CU_add_suite("Scenario Stream Tests",
+                                   setup_scenario_stream_tests,
+                                   teardown_scenario_stream_tests);
+
+    if (suite == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(suite, "test_scenario_stream_key_order", test_scenario_stream_key_order) == NULL ||
+        CU_add_test(suite, "test_scenario_stream_partial_loads", test_scenario_stream_partial_loads) == NULL ||
+        CU_add_test(suite, "test_scenario_stream_invalid", test_scenario_stream_invalid) == NULL) {
+        return NULL;
+    }
+
+    return suite;
+}
+
+// Main para ejecutar solo estas pruebas
+int main(int argc, char *argv[]) {
+    bool automated = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--automated") == 0) {
+            automated = true;
+        }
+    }
+
+    if (CU_initialize_registry() != CUE_SUCCESS) {
+        return CU_get_error();
+    }
+
+    if (add_scenario_stream_tests() == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    if (automated) {
+        CU_automated_run_tests();
+        CU_list_tests_to_file();
+    } else {
+        CU_basic_set_mode(CU_BRM_VERBOSE);
+        CU_basic_run_tests();
+    }
+
+    close_report_file();
+
+    printf("\n=== RESUMEN DE PRUEBAS: LECTURA EN STREAMING DE ESCENARIOS ===\n");
+    printf("Pruebas ejecutadas: %u\n", CU_get_number_of_tests_run());
+    printf("Fallos: %u\n", CU_get_number_of_failures());
+    printf("Reporte detallado guardado en: test_scenario_stream_report.txt\n");
+
+    CU_cleanup_registry();
+    return (CU_get_number_of_failures() == 0) ? 0 : 1;
+}
@@ -0,0 +1,358 @@
+/**
+ * @file test_sim_event_queue.c
+ * @brief Pruebas unitarias para la cola de eventos discretos
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Este archivo contiene las pruebas unitarias para verificar la cola de
+ * eventos de sim_event_queue.c, incluyendo:
+ * - Orden por instante y FIFO a igualdad de instante
+ * - Reloj virtual y eventos programados desde las propias acciones
+ * - Plan de peticiones de un edificio con varias rondas
+ *
+ * @see sim_event_queue.h
+ * @see api_gateway/sim_event_queue.c
+ */
+
+#include <CUnit/CUnit.h>
+#include <CUnit/Basic.h>
+#include <CUnit/Automated.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "api_gateway/sim_event_queue.h"
+#include "api_gateway/simulation_loader.h"
+
+#define TEST_NUM_EVENTS 2000
+
+static FILE *report_file = NULL;
+
+/**
+ * @brief Registro de los eventos ejecutados
+ */
+typedef struct {
+    uint64_t time_ms[TEST_NUM_EVENTS];
+    int32_t value[TEST_NUM_EVENTS];
+    void *arg[TEST_NUM_EVENTS];
+    size_t queue_size[TEST_NUM_EVENTS];
+    size_t count;
+} executed_log_t;
+
+static executed_log_t executed;
+
+static void record_event(gw_sim_queue_t *queue, const gw_sim_event_t *event) {
+    if (executed.count < TEST_NUM_EVENTS) {
+        executed.time_ms[executed.count] = gw_sim_queue_now(queue);
+        executed.value[executed.count] = event->value;
+        executed.arg[executed.count] = event->arg;
+        executed.queue_size[executed.count] = gw_sim_queue_size(queue);
+        executed.count++;
+    }
+}
+
+/**
+ * @brief Evento periódico: se reprograma value veces cada 50 ms
+ */
+static void periodic_event(gw_sim_queue_t *queue, const gw_sim_event_t *event) {
+    record_event(queue, event);
+    if (event->value > 0) {
+        gw_sim_queue_schedule_in(queue, 50, periodic_event, NULL, 0, event->value - 1);
+    }
+}
+
+/**
+ * @brief Evento que programa otro para el instante actual
+ */
+static void chained_event(gw_sim_queue_t *queue, const gw_sim_event_t *event) {
+    record_event(queue, event);
+    gw_sim_queue_schedule(queue, 0, record_event, NULL, 0, -1); // Instante pasado: se ejecuta ahora
+}
+
+/**
+ * @brief Función de setup para la suite de la cola de eventos
+ * @return 0 si el setup es exitoso
+ */
+int setup_sim_event_queue_tests(void) {
+    if (!report_file) {
+        report_file = fopen("test_sim_event_queue_report.txt", "w");
+        if (report_file) {
+            time_t now = time(NULL);
+            fprintf(report_file, "=== REPORTE DE PRUEBAS: COLA DE EVENTOS DISCRETOS ===\n");
+            fprintf(report_file, "Fecha: %s\n", ctime(&now));
+            fprintf(report_file, "====================================================\n\n");
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Función de teardown para la suite de la cola de eventos
+ * @return 0 si el teardown es exitoso
+ */
+int teardown_sim_event_queue_tests(void) {
+    return 0;
+}
+
+/**
+ * @brief Escribe el resultado de una prueba individual al archivo de reporte
+ * @param test_name Nombre de la prueba ejecutada
+ * @param description Descripción de lo que verifica la prueba
+ * @param passed Indica si la prueba pasó (true) o falló (false)
+ * @param details Detalles específicos del resultado de la prueba
+ */
+void write_test_result(const char* test_name, const char* description, bool passed, const char* details) {
+    if (report_file) {
+        fprintf(report_file, "PRUEBA: %s\n", test_name);
+        fprintf(report_file, "Descripción: %s\n", description);
+        fprintf(report_file, "Resultado: %s\n", passed ? "PASÓ" : "FALLÓ");
+        if (details) {
+            fprintf(report_file, "Detalles: %s\n", details);
+        }
+        fprintf(report_file, "----------------------------------------\n\n");
+        fflush(report_file);
+    }
+}
+
+// Test: Los eventos salen por instante y, a igualdad, en orden de programación
+void test_sim_queue_orders_events(void) {
+    char details[256];
+    gw_sim_queue_t queue;
+    gw_sim_queue_init(&queue, 0);
+    memset(&executed, 0, sizeof(executed));
+
+    // Instantes pseudoaleatorios con muchas repeticiones; value = orden de programación
+    uint32_t lcg = 12345;
+    bool all_scheduled = true;
+    for (int i = 0; i < TEST_NUM_EVENTS; ++i) {
+        lcg = lcg * 1103515245u + 12345u;
+        all_scheduled &= gw_sim_queue_schedule(&queue, (lcg >> 16) % 100, record_event, NULL, 0, i);
+    }
+    uint64_t first = gw_sim_queue_next_time(&queue);
+    size_t ran = gw_sim_queue_run_until(&queue, UINT64_MAX);
+
+    int out_of_order = 0;
+    for (size_t i = 1; i < executed.count; ++i) {
+        bool later = executed.time_ms[i] > executed.time_ms[i - 1];
+        bool same_fifo = executed.time_ms[i] == executed.time_ms[i - 1] && executed.value[i] > executed.value[i - 1];
+        if (!later && !same_fifo) out_of_order++;
+    }
+
+    bool passed = all_scheduled && ran == TEST_NUM_EVENTS && executed.count == TEST_NUM_EVENTS &&
+                  out_of_order == 0 && first == executed.time_ms[0] && gw_sim_queue_size(&queue) == 0 &&
+                  gw_sim_queue_next_time(&queue) == UINT64_MAX;
+    snprintf(details, sizeof(details), "Ejecutados %zu de %d, fuera de orden %d, reloj final %llu ms",
+             ran, TEST_NUM_EVENTS, out_of_order, (unsigned long long)gw_sim_queue_now(&queue));
+    write_test_result("test_sim_queue_orders_events",
+                     "Verifica el orden por instante y FIFO a igualdad de instante",
+                     passed, details);
+
+    CU_ASSERT_TRUE(all_scheduled);
+    CU_ASSERT_EQUAL(ran, TEST_NUM_EVENTS);
+    CU_ASSERT_EQUAL(out_of_order, 0);
+    CU_ASSERT_EQUAL(first, executed.time_ms[0]);
+    CU_ASSERT_EQUAL(gw_sim_queue_size(&queue), 0);
+    CU_ASSERT_EQUAL(gw_sim_queue_next_time(&queue), UINT64_MAX);
+    gw_sim_queue_free(&queue);
+}
+
+// Test: El reloj virtual avanza hasta el límite y las acciones pueden programar eventos
+void test_sim_queue_virtual_clock(void) {
+    char details[256];
+    gw_sim_queue_t queue;
+    gw_sim_queue_init(&queue, 1000);
+    memset(&executed, 0, sizeof(executed));
+
+    // Periódico en 1000, 1050, ..., 1500 y encadenado en 1120 (más su réplica inmediata)
+    gw_sim_queue_schedule(&queue, 1000, periodic_event, NULL, 0, 10);
+    gw_sim_queue_schedule(&queue, 1120, chained_event, NULL, 0, 100);
+    size_t first_run = gw_sim_queue_run_until(&queue, 1275);
+    uint64_t clock_after_first = gw_sim_queue_now(&queue);
+    size_t pending_after_first = gw_sim_queue_size(&queue);
+    bool chained_same_instant = executed.count >= 5 && executed.value[3] == 100 &&
+                                executed.value[4] == -1 && executed.time_ms[4] == 1120;
+
+    size_t second_run = gw_sim_queue_run_until(&queue, UINT64_MAX);
+    uint64_t clock_at_end = gw_sim_queue_now(&queue);
+
+    bool passed = first_run == 8 && clock_after_first == 1275 && pending_after_first == 1 &&
+                  chained_same_instant && second_run == 5 && clock_at_end == 1500 && queue.executed == 13;
+    snprintf(details, sizeof(details), "Primera tanda %zu (reloj %llu ms), segunda %zu (reloj %llu ms)",
+             first_run, (unsigned long long)clock_after_first, second_run, (unsigned long long)clock_at_end);
+    write_test_result("test_sim_queue_virtual_clock",
+                     "Verifica el reloj virtual y los eventos programados desde acciones",
+                     passed, details);
+
+    CU_ASSERT_EQUAL(first_run, 8);        // 1000..1250 (6) + 1120 + réplica
+    CU_ASSERT_EQUAL(clock_after_first, 1275);
+    CU_ASSERT_EQUAL(pending_after_first, 1);
+    CU_ASSERT_TRUE(chained_same_instant);
+    CU_ASSERT_EQUAL(second_run, 5);       // 1300..1500
+    CU_ASSERT_EQUAL(clock_at_end, 1500);
+    CU_ASSERT_EQUAL(queue.executed, 13);
+    gw_sim_queue_free(&queue);
+}
+
+// Test: El plan de un edificio programa sus peticiones una a una, ronda tras ronda
+void test_sim_queue_building_plan(void) {
+    char details[256];
+    peticion_simulacion_t peticiones[3];
+    memset(peticiones, 0, sizeof(peticiones));
+    edificio_simulacion_t edificio = { .id_edificio = "E001", .peticiones = peticiones, .num_peticiones = 3 };
+    plan_peticiones_t plan = {
+        .edificio = &edificio,
+        .building_index = 7,
+        .inicio_ms = 100,
+        .intervalo_ms = 10,
+        .rondas = 2,
+        .accion = record_event,
+    };
+
+    gw_sim_queue_t queue;
+    gw_sim_queue_init(&queue, 0);
+    memset(&executed, 0, sizeof(executed));
+    bool scheduled = programar_peticiones_edificio(&queue, &plan);
+    size_t initial_size = gw_sim_queue_size(&queue);
+    gw_sim_queue_run_until(&queue, UINT64_MAX);
+
+    bool times_ok = executed.count == 6;
+    bool args_ok = executed.count == 6;
+    size_t max_size = 0;
+    for (size_t i = 0; i < executed.count; ++i) {
+        times_ok &= executed.time_ms[i] == 100 + 10 * i;
+        args_ok &= executed.value[i] == (int32_t)(i % 3) && executed.arg[i] == &peticiones[i % 3];
+        if (executed.queue_size[i] > max_size) max_size = executed.queue_size[i];
+    }
+
+    bool passed = scheduled && initial_size == 1 && times_ok && args_ok && max_size <= 1;
+    snprintf(details, sizeof(details), "Peticiones ejecutadas %zu, tamaño máximo de la cola %zu",
+             executed.count, max_size);
+    write_test_result("test_sim_queue_building_plan",
+                     "Verifica instantes, peticiones y rondas del plan de un edificio",
+                     passed, details);
+
+    CU_ASSERT_TRUE(scheduled);
+    CU_ASSERT_EQUAL(initial_size, 1);
+    CU_ASSERT_TRUE(times_ok);
+    CU_ASSERT_TRUE(args_ok);
+    CU_ASSERT(max_size <= 1);
+    gw_sim_queue_free(&queue);
+}
+
+// Test: Las peticiones con instante_ms llegan en su instante, las demás un intervalo después
+void test_sim_queue_plan_arrival_offsets(void) {
+    char details[256];
+    peticion_simulacion_t peticiones[4];
+    memset(peticiones, 0, sizeof(peticiones));
+    peticiones[0].tiene_instante = true;  // Ráfaga: 0 y 3 ms
+    peticiones[0].instante_ms = 0;
+    peticiones[1].tiene_instante = true;
+    peticiones[1].instante_ms = 3;
+    peticiones[3].tiene_instante = true;  // Anterior a la petición 2: no adelanta a nadie
+    peticiones[3].instante_ms = 3;
+    edificio_simulacion_t edificio = { .id_edificio = "E001", .peticiones = peticiones, .num_peticiones = 4 };
+    plan_peticiones_t plan = {
+        .edificio = &edificio,
+        .building_index = 2,
+        .inicio_ms = 100,
+        .intervalo_ms = 10,
+        .rondas = 2,
+        .accion = record_event,
+    };
+
+    gw_sim_queue_t queue;
+    gw_sim_queue_init(&queue, 0);
+    memset(&executed, 0, sizeof(executed));
+    bool scheduled = programar_peticiones_edificio(&queue, &plan);
+    gw_sim_queue_run_until(&queue, UINT64_MAX);
+
+    // La segunda ronda empieza un intervalo después de la última petición (113 + 10)
+    const uint64_t expected[] = { 100, 103, 113, 113, 123, 126, 136, 136 };
+    bool times_ok = executed.count == 8;
+    for (size_t i = 0; times_ok && i < executed.count; ++i) {
+        times_ok = executed.time_ms[i] == expected[i] && executed.value[i] == (int32_t)(i % 4);
+    }
+
+    snprintf(details, sizeof(details), "Peticiones ejecutadas %zu, última en %llu ms",
+             executed.count, executed.count ? (unsigned long long)executed.time_ms[executed.count - 1] : 0ULL);
+    write_test_result("test_sim_queue_plan_arrival_offsets",
+                     "Verifica ráfagas con instante_ms, peticiones sin instante y el inicio de cada ronda",
+                     scheduled && times_ok, details);
+
+    CU_ASSERT_TRUE(scheduled);
+    CU_ASSERT_TRUE(times_ok);
+    gw_sim_queue_free(&queue);
+}
+
+/**
+ * @brief Limpia y cierra el archivo de reporte
+ */
+void close_report_file(void) {
+    if (report_file) {
+        fprintf(report_file, "=== FIN DEL REPORTE ===\n");
+        fclose(report_file);
+        report_file = NULL;
+    }
+}
+
+/**
+ * @brief Configura la suite de pruebas de la cola de eventos
+ * @return Puntero a la suite configurada, o NULL si hay error
+ */
+CU_pSuite add_sim_event_queue_tests(void) {
+    CU_pSuite suite = CU_add_suite("Sim Event Queue Tests",
+                                   setup_sim_event_queue_tests,
+                                   teardown_sim_event_queue_tests);
+
+    if (suite == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(suite, "test_sim_queue_orders_events", test_sim_queue_orders_events) == NULL ||
+        CU_add_test(suite, "test_sim_queue_virtual_clock", test_sim_queue_virtual_clock) == NULL ||
+        CU_add_test(suite, "test_sim_queue_building_plan", test_sim_queue_building_plan) == NULL ||
+        CU_add_test(suite, "test_sim_queue_plan_arrival_offsets", test_sim_queue_plan_arrival_offsets) == NULL) {
+        return NULL;
+    }
+
+    return suite;
+}
+
+// Main para ejecutar solo estas pruebas
+int main(int argc, char *argv[]) {
+    bool automated = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--automated") == 0) {
+            automated = true;
+        }
+    }
+
+    if (CU_initialize_registry() != CUE_SUCCESS) {
+        return CU_get_error();
+    }
+
+    if (add_sim_event_queue_tests() == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    if (automated) {
+        CU_automated_run_tests();
+        CU_list_tests_to_file();
+    } else {
+        CU_basic_set_mode(CU_BRM_VERBOSE);
+        CU_basic_run_tests();
+    }
+
+    close_report_file();
+
+    printf("\n=== RESUMEN DE PRUEBAS: COLA DE EVENTOS DISCRETOS ===\n");
+    printf("Pruebas ejecutadas: %u\n", CU_get_number_of_tests_run());
+    printf("Fallos: %u\n", CU_get_number_of_failures());
+    printf("Reporte detallado guardado en: test_sim_event_queue_report.txt\n");
+
+    CU_cleanup_registry();
+    return (CU_get_number_of_failures() == 0) ? 0 : 1;
+}
@@ -0,0 +1,387 @@
+/**
+ * @file test_state_journal.c
+ * @brief Pruebas unitarias para el diario binario de transiciones
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Este archivo contiene las pruebas unitarias para verificar el diario de
+ * transiciones de estado del gateway, incluyendo:
+ * - Registro de edificios y asignaciones desde los módulos del gateway
+ * - Escritura automática al llenarse el buffer
+ * - Anexado sobre un diario existente con un registro incompleto y marca de sesión
+ * - Recorte de una escritura fallida a medias
+ * - Rechazo de ficheros que no son diarios
+ *
+ * @see state_journal.h
+ * @see api_gateway/state_journal.c
+ */
+
+#include <CUnit/CUnit.h>
+#include <CUnit/Basic.h>
+#include <CUnit/Automated.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+
+#include "api_gateway/state_journal.h"
+#include "api_gateway/building_registry.h"
+
+#define TEST_JOURNAL_FILE "test_state_journal.journal"
+
+static FILE *report_file = NULL;
+
+/**
+ * @brief Resumen de un diario reproducido
+ */
+typedef struct {
+    long count;                                   ///< Registros visitados
+    long per_type[GW_JOURNAL_EVENT_COUNT];        ///< Registros por tipo
+    bool monotonic;                               ///< Marcas de tiempo no decrecientes
+    uint64_t last_ns;                             ///< Última marca vista
+    gw_journal_record_t last_assigned;            ///< Última asignación vista
+    uint32_t sequence_errors;                     ///< Registros MOVED fuera de secuencia
+    long session_index;                           ///< Posición del último SESSION_STARTED (-1 si no hay)
+} journal_summary_t;
+
+static bool summarize_record(const gw_journal_record_t *record, void *arg) {
+    journal_summary_t *summary = arg;
+    if (record->timestamp_ns < summary->last_ns) {
+        summary->monotonic = false;
+    }
+    summary->last_ns = record->timestamp_ns;
+    if (record->type < GW_JOURNAL_EVENT_COUNT) {
+        summary->per_type[record->type]++;
+    }
+    if (record->type == GW_JOURNAL_TASK_ASSIGNED) {
+        summary->last_assigned = *record;
+    }
+    if (record->type == GW_JOURNAL_SESSION_STARTED) {
+        summary->session_index = summary->count;
+    }
+    if (record->type == GW_JOURNAL_ELEVATOR_MOVED && record->ref != (uint32_t)summary->per_type[GW_JOURNAL_ELEVATOR_MOVED] - 1) {
+        summary->sequence_errors++;
+    }
+    summary->count++;
+    return true;
+}
+
+static long replay_summary(journal_summary_t *summary) {
+    memset(summary, 0, sizeof(*summary));
+    summary->monotonic = true;
+    summary->session_index = -1;
+    return gw_journal_replay(TEST_JOURNAL_FILE, NULL, summarize_record, summary);
+}
+
+/**
+ * @brief Función de setup para la suite de pruebas del diario
+ * @return 0 si el setup es exitoso
+ */
+int setup_state_journal_tests(void) {
+    unlink(TEST_JOURNAL_FILE);
+
+    if (!report_file) {
+        report_file = fopen("test_state_journal_report.txt", "w");
+        if (report_file) {
+            time_t now = time(NULL);
+            fprintf(report_file, "=== REPORTE DE PRUEBAS: DIARIO BINARIO ===\n");
+            fprintf(report_file, "Fecha: %s\n", ctime(&now));
+            fprintf(report_file, "==========================================\n\n");
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Función de teardown para la suite de pruebas del diario
+ * @return 0 si el teardown es exitoso
+ */
+int teardown_state_journal_tests(void) {
+    gw_journal_close();
+    gw_building_registry_cleanup();
+    unlink(TEST_JOURNAL_FILE);
+    return 0;
+}
+
+/**
+ * @brief Escribe el resultado de una prueba individual al archivo de reporte
+ * @param test_name Nombre de la prueba ejecutada
+ * @param description Descripción de lo que verifica la prueba
+ * @param passed Indica si la prueba pasó (true) o falló (false)
+ * @param details Detalles específicos del resultado de la prueba
+ */
+void write_test_result(const char* test_name, const char* description, bool passed, const char* details) {
+    if (report_file) {
+        fprintf(report_file, "PRUEBA: %s\n", test_name);
+        fprintf(report_file, "Descripción: %s\n", description);
+        fprintf(report_file, "Resultado: %s\n", passed ? "PASÓ" : "FALLÓ");
+        if (details) {
+            fprintf(report_file, "Detalles: %s\n", details);
+        }
+        fprintf(report_file, "----------------------------------------\n\n");
+        fflush(report_file);
+    }
+}
+
+// Test: El registro de edificios y las asignaciones quedan en el diario
+void test_journal_records_gateway_transitions(void) {
+    char details[256];
+    unlink(TEST_JOURNAL_FILE);
+
+    CU_ASSERT_EQUAL_FATAL(gw_journal_open(TEST_JOURNAL_FILE), 0);
+    gw_building_registry_init();
+    gw_building_add("E1", 4, 14);
+    int e2 = gw_building_add("E2", 3, 20);
+    assign_task_to_elevator(gw_building_get((uint16_t)e2), "E2A2", "T_42", 8, 3);
+    gw_journal_close();
+
+    journal_summary_t summary;
+    long count = replay_summary(&summary);
+    bool assignment_ok = summary.last_assigned.building == 1 && summary.last_assigned.elevator == 1 &&
+                         summary.last_assigned.floor == 0 && summary.last_assigned.target_floor == 8 &&
+                         summary.last_assigned.ref == gw_journal_hash_id("T_42") &&
+                         summary.last_assigned.aux == MOVING_UP;
+
+    bool passed = count == 3 && summary.per_type[GW_JOURNAL_BUILDING_ADDED] == 2 &&
+                  summary.per_type[GW_JOURNAL_TASK_ASSIGNED] == 1 && assignment_ok && summary.monotonic;
+    snprintf(details, sizeof(details), "Registros: %ld, edificios: %ld, asignaciones: %ld, asignación %s",
+             count, summary.per_type[GW_JOURNAL_BUILDING_ADDED], summary.per_type[GW_JOURNAL_TASK_ASSIGNED],
+             assignment_ok ? "correcta" : "incorrecta");
+    write_test_result("test_journal_records_gateway_transitions",
+                     "Verifica que registro de edificios y asignaciones se anotan con sus campos",
+                     passed, details);
+
+    CU_ASSERT_EQUAL(count, 3);
+    CU_ASSERT_EQUAL(summary.per_type[GW_JOURNAL_BUILDING_ADDED], 2);
+    CU_ASSERT_EQUAL(summary.per_type[GW_JOURNAL_TASK_ASSIGNED], 1);
+    CU_ASSERT_TRUE(assignment_ok);
+    CU_ASSERT_TRUE(summary.monotonic);
+}
+
+// Test: Al llenarse el buffer los registros se escriben sin perder ninguno
+void test_journal_buffer_flush_on_full(void) {
+    char details[256];
+    const long total = GW_JOURNAL_BUFFER_RECORDS * 3 + 17;
+    unlink(TEST_JOURNAL_FILE);
+
+    CU_ASSERT_EQUAL_FATAL(gw_journal_open(TEST_JOURNAL_FILE), 0);
+    for (long i = 0; i < total; ++i) {
+        gw_journal_record(GW_JOURNAL_ELEVATOR_MOVED, 0, 0, (int16_t)(i % 14), 13, (uint32_t)i, MOVING_UP);
+    }
+    // Antes de cerrar ya deben estar en el fichero los buffers completos
+    journal_summary_t before_close;
+    long on_disk = replay_summary(&before_close);
+    gw_journal_close();
+
+    journal_summary_t summary;
+    long count = replay_summary(&summary);
+
+    bool passed = on_disk == GW_JOURNAL_BUFFER_RECORDS * 3 && count == total &&
+                  summary.sequence_errors == 0 && summary.monotonic;
+    snprintf(details, sizeof(details), "En disco antes de cerrar: %ld, tras cerrar: %ld de %ld, fuera de secuencia: %u",
+             on_disk, count, total, summary.sequence_errors);
+    write_test_result("test_journal_buffer_flush_on_full",
+                     "Verifica la escritura automática del buffer lleno y el orden de los registros",
+                     passed, details);
+
+    CU_ASSERT_EQUAL(on_disk, GW_JOURNAL_BUFFER_RECORDS * 3);
+    CU_ASSERT_EQUAL(count, total);
+    CU_ASSERT_EQUAL(summary.sequence_errors, 0);
+}
+
+// Test: Reabrir un diario con un registro incompleto lo recorta y sigue anexando
+void test_journal_append_after_partial_record(void) {
+    char details[256];
+    unlink(TEST_JOURNAL_FILE);
+
+    CU_ASSERT_EQUAL_FATAL(gw_journal_open(TEST_JOURNAL_FILE), 0);
+    for (uint32_t i = 0; i < 5; ++i) {
+        gw_journal_record(GW_JOURNAL_ELEVATOR_MOVED, 0, 1, 2, 3, i, MOVING_UP);
+    }
+    gw_journal_close();
+
+    // Simular una caída a mitad de escritura: 10 bytes de un registro
+    FILE *f = fopen(TEST_JOURNAL_FILE, "ab");
+    CU_ASSERT_PTR_NOT_NULL_FATAL(f);
+    fwrite("0123456789", 1, 10, f);
+    fclose(f);
+
+    int reopened = gw_journal_open(TEST_JOURNAL_FILE);
+    for (uint32_t i = 5; i < 8; ++i) {
+        gw_journal_record(GW_JOURNAL_ELEVATOR_MOVED, 0, 1, 2, 3, i, MOVING_UP);
+    }
+    gw_journal_close();
+
+    journal_summary_t summary;
+    long count = replay_summary(&summary);
+
+    // 8 movimientos y la marca de la segunda sesión, justo tras los 5 primeros
+    bool passed = reopened == 0 && count == 9 && summary.sequence_errors == 0 &&
+                  summary.per_type[GW_JOURNAL_SESSION_STARTED] == 1 && summary.session_index == 5;
+    snprintf(details, sizeof(details), "Reapertura: %d, registros: %ld, fuera de secuencia: %u, sesión en %ld",
+             reopened, count, summary.sequence_errors, summary.session_index);
+    write_test_result("test_journal_append_after_partial_record",
+                     "Verifica que el registro incompleto se descarta, se marca la sesión nueva y los registros quedan alineados",
+                     passed, details);
+
+    CU_ASSERT_EQUAL(reopened, 0);
+    CU_ASSERT_EQUAL(count, 9);
+    CU_ASSERT_EQUAL(summary.sequence_errors, 0);
+    CU_ASSERT_EQUAL(summary.per_type[GW_JOURNAL_SESSION_STARTED], 1);
+    CU_ASSERT_EQUAL(summary.session_index, 5);
+}
+
+// Test: Una escritura que falla a medias se recorta y el reintento no duplica registros
+void test_journal_flush_error_keeps_records_aligned(void) {
+    char details[256];
+    const off_t good_size = (off_t)(sizeof(gw_journal_file_header_t) + 3 * sizeof(gw_journal_record_t));
+    unlink(TEST_JOURNAL_FILE);
+
+    CU_ASSERT_EQUAL_FATAL(gw_journal_open(TEST_JOURNAL_FILE), 0);
+    for (uint32_t i = 0; i < 3; ++i) {
+        gw_journal_record(GW_JOURNAL_ELEVATOR_MOVED, 0, 1, 2, 3, i, MOVING_UP);
+    }
+    CU_ASSERT_TRUE_FATAL(gw_journal_flush());
+    for (uint32_t i = 3; i < 20; ++i) {
+        gw_journal_record(GW_JOURNAL_ELEVATOR_MOVED, 0, 1, 2, 3, i, MOVING_UP);
+    }
+
+    // Con el tamaño limitado el write() deja dos registros y medio antes de fallar con EFBIG
+    struct rlimit saved_limit;
+    CU_ASSERT_EQUAL_FATAL(getrlimit(RLIMIT_FSIZE, &saved_limit), 0);
+    void (*saved_handler)(int) = signal(SIGXFSZ, SIG_IGN);
+    struct rlimit limit = { (rlim_t)good_size + 2 * sizeof(gw_journal_record_t) + 10, saved_limit.rlim_max };
+    CU_ASSERT_EQUAL_FATAL(setrlimit(RLIMIT_FSIZE, &limit), 0);
+    bool failed_flush = gw_journal_flush();
+    struct stat st;
+    off_t size_after_error = stat(TEST_JOURNAL_FILE, &st) == 0 ? st.st_size : -1;
+    setrlimit(RLIMIT_FSIZE, &saved_limit);
+    signal(SIGXFSZ, saved_handler);
+
+    bool still_open = gw_journal_is_open();
+    bool retried = gw_journal_flush();
+    gw_journal_close();
+
+    journal_summary_t summary;
+    long count = replay_summary(&summary);
+
+    bool passed = !failed_flush && size_after_error == good_size && still_open && retried &&
+                  count == 20 && summary.sequence_errors == 0;
+    snprintf(details, sizeof(details), "Tamaño tras el error: %lld (esperado %lld), reintento: %s, registros: %ld, fuera de secuencia: %u",
+             (long long)size_after_error, (long long)good_size, retried ? "ok" : "fallido", count, summary.sequence_errors);
+    write_test_result("test_journal_flush_error_keeps_records_aligned",
+                     "Verifica que un fallo de escritura a medias se recorta al último registro completo",
+                     passed, details);
+
+    CU_ASSERT_FALSE(failed_flush);
+    CU_ASSERT_EQUAL(size_after_error, good_size);
+    CU_ASSERT_TRUE(still_open);
+    CU_ASSERT_TRUE(retried);
+    CU_ASSERT_EQUAL(count, 20);
+    CU_ASSERT_EQUAL(summary.sequence_errors, 0);
+}
+
+// Test: Un fichero que no es un diario no se abre ni se reproduce
+void test_journal_rejects_foreign_file(void) {
+    char details[256];
+    unlink(TEST_JOURNAL_FILE);
+
+    FILE *f = fopen(TEST_JOURNAL_FILE, "wb");
+    CU_ASSERT_PTR_NOT_NULL_FATAL(f);
+    fputs("# Ejecución del gateway en Markdown, no un diario binario\n", f);
+    fclose(f);
+
+    int opened = gw_journal_open(TEST_JOURNAL_FILE);
+    long replayed = gw_journal_replay(TEST_JOURNAL_FILE, NULL, summarize_record, NULL);
+    long missing = gw_journal_replay("no_existe.journal", NULL, NULL, NULL);
+
+    bool passed = opened == -1 && !gw_journal_is_open() && replayed == -1 && missing == -1;
+    snprintf(details, sizeof(details), "Apertura: %d, reproducción: %ld, fichero inexistente: %ld",
+             opened, replayed, missing);
+    write_test_result("test_journal_rejects_foreign_file",
+                     "Verifica que no se anexa ni se reproduce un fichero ajeno",
+                     passed, details);
+
+    CU_ASSERT_EQUAL(opened, -1);
+    CU_ASSERT_FALSE(gw_journal_is_open());
+    CU_ASSERT_EQUAL(replayed, -1);
+    CU_ASSERT_EQUAL(missing, -1);
+}
+
+/**
+ * @brief Limpia y cierra el archivo de reporte
+ */
+void close_report_file(void) {
+    if (report_file) {
+        fprintf(report_file, "=== FIN DEL REPORTE ===\n");
+        fclose(report_file);
+        report_file = NULL;
+    }
+}
+
+/**
+ * @brief Configura la suite de pruebas del diario
+ * @return Puntero a la suite configurada, o NULL si hay error
+ */
+CU_pSuite add_state_journal_tests(void) {
+    CU_pSuite suite = CU_add_suite("State Journal Tests",
+                                   setup_state_journal_tests,
+                                   teardown_state_journal_tests);
+
+    if (suite == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(suite, "test_journal_records_gateway_transitions", test_journal_records_gateway_transitions) == NULL ||
+        CU_add_test(suite, "test_journal_buffer_flush_on_full", test_journal_buffer_flush_on_full) == NULL ||
+        CU_add_test(suite, "test_journal_append_after_partial_record", test_journal_append_after_partial_record) == NULL ||
+        CU_add_test(suite, "test_journal_flush_error_keeps_records_aligned", test_journal_flush_error_keeps_records_aligned) == NULL ||
+        CU_add_test(suite, "test_journal_rejects_foreign_file", test_journal_rejects_foreign_file) == NULL) {
+        return NULL;
+    }
+
+    return suite;
+}
+
+// Main para ejecutar solo estas pruebas
+int main(int argc, char *argv[]) {
+    bool automated = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--automated") == 0) {
+            automated = true;
+        }
+    }
+
+    if (CU_initialize_registry() != CUE_SUCCESS) {
+        return CU_get_error();
+    }
+
+    if (add_state_journal_tests() == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    if (automated) {
+        CU_automated_run_tests();
+        CU_list_tests_to_file();
+    } else {
+        CU_basic_set_mode(CU_BRM_VERBOSE);
+        CU_basic_run_tests();
+    }
+
+    close_report_file();
+
+    printf("\n=== RESUMEN DE PRUEBAS: DIARIO BINARIO ===\n");
+    printf("Pruebas ejecutadas: %u\n", CU_get_number_of_tests_run());
+    printf("Fallos: %u\n", CU_get_number_of_failures());
+    printf("Reporte detallado guardado en: test_state_journal_report.txt\n");
+
+    CU_cleanup_registry();
+    return (CU_get_number_of_failures() == 0) ? 0 : 1;
+}
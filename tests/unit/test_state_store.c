@@ -0,0 +1,325 @@
+/**
+ * @file test_state_store.c
+ * @brief Pruebas unitarias para la persistencia del estado del gateway
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Este archivo contiene las pruebas unitarias para verificar el fichero de
+ * estado mapeado en memoria, incluyendo:
+ * - Recuperación de posiciones y tareas tras un reinicio
+ * - Reenvío de las solicitudes CAN que quedaron en vuelo
+ * - Volcado solo cuando el estado ha cambiado
+ * - Arranque en frío con un fichero corrupto o de otra configuración
+ *
+ * @see state_store.h
+ * @see api_gateway/state_store.c
+ */
+
+#include <CUnit/CUnit.h>
+#include <CUnit/Basic.h>
+#include <CUnit/Automated.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "api_gateway/state_store.h"
+#include "api_gateway/building_registry.h"
+#include "api_gateway/request_tracker.h"
+
+#define TEST_STATE_FILE "test_state_store.state"
+
+static FILE *report_file = NULL;
+
+/**
+ * @brief Solicitudes recibidas por el callback de reenvío
+ */
+static int resubmitted_count = 0;
+static can_origin_tracker_t last_resubmitted;
+
+static void count_resubmitted(const can_origin_tracker_t *request, void *arg) {
+    (void)arg;
+    resubmitted_count++;
+    last_resubmitted = *request;
+}
+
+/**
+ * @brief Simula un arranque del gateway: registro de edificios y slab vacíos
+ * @param e2_elevators Ascensores del segundo edificio
+ */
+static void fresh_gateway(int e2_elevators) {
+    gw_building_registry_init();
+    gw_tracker_init();
+    gw_building_add("E1", 4, 14);
+    gw_building_add("E2", e2_elevators, 20);
+    resubmitted_count = 0;
+    memset(&last_resubmitted, 0, sizeof(last_resubmitted));
+}
+
+/**
+ * @brief Deja en E1/E2 ascensores en movimiento y una solicitud CAN en vuelo en E2
+ */
+static void populate_gateway_state(void) {
+    assign_task_to_elevator(gw_building_get(0), "E1A3", "T_100", 9, 2);
+    gw_building_get(0)->piso_actual[2] = 4;
+    elevator_group_state_t *e2 = gw_building_get(1);
+    assign_task_to_elevator(e2, "E2A1", "T_200", 0, 15);
+    e2->piso_actual[0] = 12;
+
+    uint8_t token[GW_TRACKER_TOKEN_LEN];
+    gw_tracker_slot_t *slot = gw_tracker_alloc(GW_TRACKER_ORIGIN_CAN, token);
+    if (slot) {
+        slot->data.can.original_can_id = 0x100;
+        slot->data.can.building_index = 1;
+        slot->data.can.request_type = GW_REQUEST_TYPE_FLOOR_CALL;
+        slot->data.can.call_reference_floor = 6;
+        slot->data.can.requested_direction = MOVING_DOWN;
+    }
+}
+
+/**
+ * @brief Función de setup para la suite de pruebas del fichero de estado
+ * @return 0 si el setup es exitoso
+ */
+int setup_state_store_tests(void) {
+    unlink(TEST_STATE_FILE);
+
+    if (!report_file) {
+        report_file = fopen("test_state_store_report.txt", "w");
+        if (report_file) {
+            time_t now = time(NULL);
+            fprintf(report_file, "=== REPORTE DE PRUEBAS: ESTADO PERSISTENTE ===\n");
+            fprintf(report_file, "Fecha: %s\n", ctime(&now));
+            fprintf(report_file, "===============================================\n\n");
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Función de teardown para la suite de pruebas del fichero de estado
+ * @return 0 si el teardown es exitoso
+ */
+int teardown_state_store_tests(void) {
+    gw_state_store_close();
+    gw_tracker_cleanup();
+    gw_building_registry_cleanup();
+    unlink(TEST_STATE_FILE);
+    return 0;
+}
+
+/**
+ * @brief Escribe el resultado de una prueba individual al archivo de reporte
+ * @param test_name Nombre de la prueba ejecutada
+ * @param description Descripción de lo que verifica la prueba
+ * @param passed Indica si la prueba pasó (true) o falló (false)
+ * @param details Detalles específicos del resultado de la prueba
+ */
+void write_test_result(const char* test_name, const char* description, bool passed, const char* details) {
+    if (report_file) {
+        fprintf(report_file, "PRUEBA: %s\n", test_name);
+        fprintf(report_file, "Descripción: %s\n", description);
+        fprintf(report_file, "Resultado: %s\n", passed ? "PASÓ" : "FALLÓ");
+        if (details) {
+            fprintf(report_file, "Detalles: %s\n", details);
+        }
+        fprintf(report_file, "----------------------------------------\n\n");
+        fflush(report_file);
+    }
+}
+
+// Test: Un gateway reiniciado recupera posiciones, tareas y solicitudes CAN en vuelo
+void test_state_store_warm_restart(void) {
+    char details[256];
+    unlink(TEST_STATE_FILE);
+    fresh_gateway(3);
+
+    CU_ASSERT_EQUAL_FATAL(gw_state_store_open(TEST_STATE_FILE), 0);
+    bool cold_start = !gw_state_store_has_snapshot();
+    populate_gateway_state();
+    bool first_sync = gw_state_store_sync();
+    bool idle_sync = gw_state_store_sync();
+    gw_state_store_close();
+
+    // Reinicio: mismos edificios, estado vacío
+    fresh_gateway(3);
+    CU_ASSERT_EQUAL_FATAL(gw_state_store_open(TEST_STATE_FILE), 0);
+    bool has_snapshot = gw_state_store_has_snapshot();
+    int restored = gw_state_store_restore(count_resubmitted, NULL);
+
+    elevator_group_state_t *e1 = gw_building_get(0);
+    elevator_group_state_t *e2 = gw_building_get(1);
+    bool e1_ok = e1->piso_actual[2] == 4 && e1->destino_actual[2] == 9 && e1->ocupado[2] &&
+                 strcmp(e1->ids[2].tarea_actual_id, "T_100") == 0 && !e1->ocupado[0];
+    bool e2_ok = e2->piso_actual[0] == 12 && e2->destino_actual[0] == 0 &&
+                 strcmp(e2->ids[0].tarea_actual_id, "T_200") == 0 &&
+                 strcmp(e2->ids[0].ascensor_id, "E2A1") == 0;
+    bool request_ok = resubmitted_count == 1 && last_resubmitted.building_index == 1 &&
+                      last_resubmitted.original_can_id == 0x100 &&
+                      last_resubmitted.call_reference_floor == 6 &&
+                      last_resubmitted.requested_direction == MOVING_DOWN;
+    gw_state_store_close();
+
+    bool passed = cold_start && first_sync && !idle_sync && has_snapshot && restored == 2 &&
+                  e1_ok && e2_ok && request_ok;
+    snprintf(details, sizeof(details),
+             "Volcados: %d/%d, edificios recuperados: %d, E1: %s, E2: %s, solicitudes reenviadas: %d",
+             first_sync, idle_sync, restored, e1_ok ? "OK" : "MAL", e2_ok ? "OK" : "MAL", resubmitted_count);
+    write_test_result("test_state_store_warm_restart",
+                     "Verifica la recuperación del estado y el reenvío de solicitudes CAN tras reiniciar",
+                     passed, details);
+
+    CU_ASSERT_TRUE(cold_start);
+    CU_ASSERT_TRUE(first_sync);
+    CU_ASSERT_FALSE(idle_sync);
+    CU_ASSERT_TRUE(has_snapshot);
+    CU_ASSERT_EQUAL(restored, 2);
+    CU_ASSERT_TRUE(e1_ok);
+    CU_ASSERT_TRUE(e2_ok);
+    CU_ASSERT_TRUE(request_ok);
+}
+
+// Test: Un fichero con el contenido dañado no se recupera
+void test_state_store_corrupted_file_cold_start(void) {
+    char details[256];
+    unlink(TEST_STATE_FILE);
+    fresh_gateway(3);
+
+    CU_ASSERT_EQUAL_FATAL(gw_state_store_open(TEST_STATE_FILE), 0);
+    populate_gateway_state();
+    gw_state_store_sync();
+    gw_state_store_close();
+
+    // Un byte cambiado dentro del primer registro de edificio
+    FILE *f = fopen(TEST_STATE_FILE, "r+b");
+    CU_ASSERT_PTR_NOT_NULL_FATAL(f);
+    fseek(f, 64, SEEK_SET);
+    int c = fgetc(f);
+    fseek(f, 64, SEEK_SET);
+    fputc(c ^ 0x5A, f);
+    fclose(f);
+
+    fresh_gateway(3);
+    CU_ASSERT_EQUAL_FATAL(gw_state_store_open(TEST_STATE_FILE), 0);
+    bool has_snapshot = gw_state_store_has_snapshot();
+    int restored = gw_state_store_restore(count_resubmitted, NULL);
+    bool untouched = gw_building_get(0)->piso_actual[2] == 0 && !gw_building_get(0)->ocupado[2];
+    gw_state_store_close();
+
+    bool passed = !has_snapshot && restored == 0 && resubmitted_count == 0 && untouched;
+    snprintf(details, sizeof(details), "Recuperable: %d, edificios: %d, solicitudes: %d",
+             has_snapshot, restored, resubmitted_count);
+    write_test_result("test_state_store_corrupted_file_cold_start",
+                     "Verifica que un checksum inválido provoca un arranque en frío",
+                     passed, details);
+
+    CU_ASSERT_FALSE(has_snapshot);
+    CU_ASSERT_EQUAL(restored, 0);
+    CU_ASSERT_EQUAL(resubmitted_count, 0);
+    CU_ASSERT_TRUE(untouched);
+}
+
+// Test: Los edificios con otra configuración se ignoran sin afectar al resto
+void test_state_store_configuration_mismatch(void) {
+    char details[256];
+    unlink(TEST_STATE_FILE);
+    fresh_gateway(3);
+
+    CU_ASSERT_EQUAL_FATAL(gw_state_store_open(TEST_STATE_FILE), 0);
+    populate_gateway_state();
+    gw_state_store_sync();
+    gw_state_store_close();
+
+    // E2 pasa a tener 5 ascensores: su estado guardado ya no encaja
+    fresh_gateway(5);
+    CU_ASSERT_EQUAL_FATAL(gw_state_store_open(TEST_STATE_FILE), 0);
+    int restored = gw_state_store_restore(count_resubmitted, NULL);
+    bool e1_restored = gw_building_get(0)->piso_actual[2] == 4;
+    bool e2_untouched = gw_building_get(1)->piso_actual[0] == 0 && !gw_building_get(1)->ocupado[0];
+    gw_state_store_close();
+
+    bool passed = restored == 1 && e1_restored && e2_untouched && resubmitted_count == 1;
+    snprintf(details, sizeof(details), "Edificios recuperados: %d, E1: %d, E2 intacto: %d, solicitudes: %d",
+             restored, e1_restored, e2_untouched, resubmitted_count);
+    write_test_result("test_state_store_configuration_mismatch",
+                     "Verifica que solo se recuperan los edificios con el mismo número de ascensores",
+                     passed, details);
+
+    CU_ASSERT_EQUAL(restored, 1);
+    CU_ASSERT_TRUE(e1_restored);
+    CU_ASSERT_TRUE(e2_untouched);
+    CU_ASSERT_EQUAL(resubmitted_count, 1);
+}
+
+/**
+ * @brief Limpia y cierra el archivo de reporte
+ */
+void close_report_file(void) {
+    if (report_file) {
+        fprintf(report_file, "=== FIN DEL REPORTE ===\n");
+        fclose(report_file);
+        report_file = NULL;
+    }
+}
+
+/**
+ * @brief Configura la suite de pruebas del fichero de estado
+ * @return Puntero a la suite configurada, o NULL si hay error
+ */
+CU_pSuite add_state_store_tests(void) {
+    CU_pSuite suite = CU_add_suite("State Store Tests",
+                                   setup_state_store_tests,
+                                   teardown_state_store_tests);
+
+    if (suite == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(suite, "test_state_store_warm_restart", test_state_store_warm_restart) == NULL ||
+        CU_add_test(suite, "test_state_store_corrupted_file_cold_start", test_state_store_corrupted_file_cold_start) == NULL ||
+        CU_add_test(suite, "test_state_store_configuration_mismatch", test_state_store_configuration_mismatch) == NULL) {
+        return NULL;
+    }
+
+    return suite;
+}
+
+// Main para ejecutar solo estas pruebas
+int main(int argc, char *argv[]) {
+    bool automated = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--automated") == 0) {
+            automated = true;
+        }
+    }
+
+    if (CU_initialize_registry() != CUE_SUCCESS) {
+        return CU_get_error();
+    }
+
+    if (add_state_store_tests() == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    if (automated) {
+        CU_automated_run_tests();
+        CU_list_tests_to_file();
+    } else {
+        CU_basic_set_mode(CU_BRM_VERBOSE);
+        CU_basic_run_tests();
+    }
+
+    close_report_file();
+
+    printf("\n=== RESUMEN DE PRUEBAS: ESTADO PERSISTENTE ===\n");
+    printf("Pruebas ejecutadas: %u\n", CU_get_number_of_tests_run());
+    printf("Fallos: %u\n", CU_get_number_of_failures());
+    printf("Reporte detallado guardado en: test_state_store_report.txt\n");
+
+    CU_cleanup_registry();
+    return (CU_get_number_of_failures() == 0) ? 0 : 1;
+}
@@ -0,0 +1,496 @@
+/**
+ * @file test_traffic_generator.c
+ * @brief Pruebas unitarias para el generador de tráfico sintético
+ * @author Sistema de Control de Ascensores
+ * @date 2025
+ * @version 1.0
+ *
+ * Este archivo contiene las pruebas unitarias para verificar el
+ * generador de traffic_generator.c y el generador de prng.c, incluyendo:
+ * - Reproducibilidad con la misma semilla e independencia entre flujos
+ * - Patrones de subida, bajada, entre plantas y matriz origen/destino
+ * - Tasas de llegada, tamaño de grupo y fases
+ * - Inyección en la cola de eventos y volcado al formato binario
+ *
+ * @see traffic_generator.h
+ * @see prng.h
+ */
+
+#include <CUnit/CUnit.h>
+#include <CUnit/Basic.h>
+#include <CUnit/Automated.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "api_gateway/traffic_generator.h"
+#include "api_gateway/prng.h"
+#include "api_gateway/scenario_binary.h"
+#include "api_gateway/simulation_loader.h"
+
+#define TEST_SEED 20250101u
+#define TEST_OD_FILE "test_traffic_generator_od.csv"
+#define TEST_BIN_FILE "test_traffic_generator.bin"
+
+static FILE *report_file = NULL;
+
+/**
+ * @brief Resumen de una secuencia generada
+ */
+typedef struct {
+    int llamadas;          ///< Llamadas de piso
+    int cabinas;           ///< Solicitudes de cabina
+    uint64_t pasajeros;    ///< Pasajeros de las llamadas de piso
+    bool ordenada;         ///< Instantes no decrecientes
+    bool con_instante;     ///< Todas las peticiones tienen instante
+    bool origen_acceso;    ///< Todas las llamadas salen del acceso
+    bool destino_acceso;   ///< Todas las cabinas van al acceso
+    bool sin_acceso;       ///< Ninguna petición toca el acceso
+    uint32_t ultima_ms;    ///< Instante de la última petición
+} resumen_trafico_t;
+
+/**
+ * @brief Genera toda la secuencia de un perfil y la resume
+ */
+static resumen_trafico_t resumir(const gw_traffic_profile_t *perfil, uint64_t semilla, uint64_t flujo) {
+    resumen_trafico_t r;
+    memset(&r, 0, sizeof(r));
+    r.ordenada = r.con_instante = r.origen_acceso = r.destino_acceso = r.sin_acceso = true;
+    gw_traffic_generator_t *g = gw_traffic_create(perfil, semilla, flujo);
+    if (!g) {
+        r.ordenada = false;
+        return r;
+    }
+    peticion_simulacion_t p;
+    while (gw_traffic_next(g, &p)) {
+        r.ordenada = r.ordenada && p.instante_ms >= r.ultima_ms;
+        r.con_instante = r.con_instante && p.tiene_instante && p.pasajeros >= 1;
+        r.ultima_ms = p.instante_ms;
+        if (p.tipo == PETICION_LLAMADA_PISO) {
+            r.llamadas++;
+            r.pasajeros += p.pasajeros;
+            r.origen_acceso = r.origen_acceso && p.piso_origen == perfil->lobby_floor;
+            r.destino_acceso = r.destino_acceso && p.piso_origen != perfil->lobby_floor;
+            r.sin_acceso = r.sin_acceso && p.piso_origen != perfil->lobby_floor;
+        } else {
+            r.cabinas++;
+            r.origen_acceso = r.origen_acceso && p.piso_destino != perfil->lobby_floor;
+            r.destino_acceso = r.destino_acceso && p.piso_destino == perfil->lobby_floor;
+            r.sin_acceso = r.sin_acceso && p.piso_destino != perfil->lobby_floor;
+            r.con_instante = r.con_instante && p.indice_ascensor >= 0 && p.indice_ascensor < perfil->num_elevators;
+        }
+    }
+    gw_traffic_destroy(g);
+    return r;
+}
+
+/**
+ * @brief Indica si dos generadores producen exactamente la misma secuencia
+ */
+static bool mismas_secuencias(const gw_traffic_profile_t *perfil, uint64_t semilla_a, uint64_t flujo_a,
+                              uint64_t semilla_b, uint64_t flujo_b) {
+    gw_traffic_generator_t *a = gw_traffic_create(perfil, semilla_a, flujo_a);
+    gw_traffic_generator_t *b = gw_traffic_create(perfil, semilla_b, flujo_b);
+    bool iguales = a && b;
+    peticion_simulacion_t pa, pb;
+    while (iguales) {
+        bool hay_a = gw_traffic_next(a, &pa);
+        bool hay_b = gw_traffic_next(b, &pb);
+        if (hay_a != hay_b) {
+            iguales = false;
+        } else if (!hay_a) {
+            break;
+        } else {
+            iguales = memcmp(&pa, &pb, sizeof(pa)) == 0;
+        }
+    }
+    gw_traffic_destroy(a);
+    gw_traffic_destroy(b);
+    return iguales;
+}
+
+/**
+ * @brief Función de setup para la suite del generador de tráfico
+ * @return 0 si el setup es exitoso
+ */
+int setup_traffic_generator_tests(void) {
+    if (!report_file) {
+        report_file = fopen("test_traffic_generator_report.txt", "w");
+        if (report_file) {
+            time_t now = time(NULL);
+            fprintf(report_file, "=== REPORTE DE PRUEBAS: GENERADOR DE TRÁFICO ===\n");
+            fprintf(report_file, "Fecha: %s\n", ctime(&now));
+            fprintf(report_file, "================================================\n\n");
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Función de teardown para la suite del generador de tráfico
+ * @return 0 si el teardown es exitoso
+ */
+int teardown_traffic_generator_tests(void) {
+    remove(TEST_OD_FILE);
+    remove(TEST_BIN_FILE);
+    return 0;
+}
+
+/**
+ * @brief Escribe el resultado de una prueba individual al archivo de reporte
+ * @param test_name Nombre de la prueba ejecutada
+ * @param description Descripción de lo que verifica la prueba
+ * @param passed true si la prueba pasó, false si falló
+ * @param details Detalles adicionales sobre el resultado
+ */
+void write_test_result(const char* test_name, const char* description, bool passed, const char* details) {
+    if (report_file) {
+        fprintf(report_file, "PRUEBA: %s\n", test_name);
+        fprintf(report_file, "Descripción: %s\n", description);
+        fprintf(report_file, "Resultado: %s\n", passed ? "PASÓ" : "FALLÓ");
+        if (details) {
+            fprintf(report_file, "Detalles: %s\n", details);
+        }
+        fprintf(report_file, "----------------------------------------\n\n");
+        fflush(report_file);
+    }
+}
+
+/**
+ * @brief Prueba: la misma semilla reproduce la secuencia y los flujos son independientes
+ */
+void test_traffic_determinism(void) {
+    gw_traffic_profile_t perfil;
+    gw_traffic_profile_defaults(&perfil);
+    perfil.duration_ms = 600000;
+    perfil.mean_group_size = 2.0;
+    CU_ASSERT_TRUE(gw_traffic_parse_phases(&perfil, "0:mixed:30"));
+
+    bool misma = mismas_secuencias(&perfil, TEST_SEED, 3, TEST_SEED, 3);
+    bool otro_flujo = !mismas_secuencias(&perfil, TEST_SEED, 3, TEST_SEED, 4);
+    bool otra_semilla = !mismas_secuencias(&perfil, TEST_SEED, 3, TEST_SEED + 1, 3);
+    CU_ASSERT_TRUE(misma);
+    CU_ASSERT_TRUE(otro_flujo);
+    CU_ASSERT_TRUE(otra_semilla);
+
+    // Dos generadores con la misma semilla avanzan igual; below() respeta el límite
+    gw_prng_t a, b, c;
+    gw_prng_seed(&a, 42);
+    gw_prng_seed(&b, 42);
+    gw_prng_seed(&c, 42);
+    bool prng_igual = true;
+    bool below_ok = true;
+    for (int i = 0; i < 1000; ++i) {
+        prng_igual = prng_igual && gw_prng_next(&a) == gw_prng_next(&b);
+        below_ok = below_ok && gw_prng_below(&c, 7) < 7;
+    }
+    CU_ASSERT_TRUE(prng_igual);
+    CU_ASSERT_TRUE(below_ok);
+
+    resumen_trafico_t r = resumir(&perfil, TEST_SEED, 0);
+    CU_ASSERT_TRUE(r.ordenada);
+    CU_ASSERT_TRUE(r.con_instante);
+    CU_ASSERT_EQUAL(r.llamadas, r.cabinas);
+    CU_ASSERT_TRUE(r.llamadas > 0);
+
+    char details[256];
+    snprintf(details, sizeof(details), "misma semilla: %s, otro flujo distinto: %s, otra semilla distinta: %s, %d llamadas ordenadas: %s",
+             misma ? "igual" : "distinta", otro_flujo ? "sí" : "no", otra_semilla ? "sí" : "no",
+             r.llamadas, r.ordenada ? "sí" : "no");
+    write_test_result("test_traffic_determinism",
+                      "Misma semilla y flujo dan la misma secuencia; flujos y semillas distintos la cambian",
+                      misma && otro_flujo && otra_semilla && prng_igual && below_ok && r.ordenada &&
+                      r.con_instante && r.llamadas == r.cabinas, details);
+}
+
+/**
+ * @brief Prueba: cada patrón genera los viajes que le corresponden
+ */
+void test_traffic_patterns(void) {
+    gw_traffic_profile_t perfil;
+    gw_traffic_profile_defaults(&perfil);
+    perfil.num_floors = 10;
+    perfil.lobby_floor = 2;
+    perfil.duration_ms = 1800000;
+
+    CU_ASSERT_TRUE(gw_traffic_parse_phases(&perfil, "0:up-peak:20"));
+    resumen_trafico_t subida = resumir(&perfil, TEST_SEED, 0);
+    CU_ASSERT_TRUE(subida.origen_acceso);
+
+    CU_ASSERT_TRUE(gw_traffic_parse_phases(&perfil, "0:down-peak:20"));
+    resumen_trafico_t bajada = resumir(&perfil, TEST_SEED, 0);
+    CU_ASSERT_TRUE(bajada.destino_acceso);
+
+    CU_ASSERT_TRUE(gw_traffic_parse_phases(&perfil, "0:inter-floor:20"));
+    resumen_trafico_t entre = resumir(&perfil, TEST_SEED, 0);
+    CU_ASSERT_TRUE(entre.sin_acceso);
+
+    // Matriz con un único viaje posible: 7 -> 4 (la diagonal se ignora)
+    FILE *f = fopen(TEST_OD_FILE, "w");
+    CU_ASSERT_PTR_NOT_NULL_FATAL(f);
+    fprintf(f, "# origen por filas, destino por columnas\n");
+    for (int o = 0; o < perfil.num_floors; ++o) {
+        for (int d = 0; d < perfil.num_floors; ++d) {
+            fprintf(f, "%s%s", d ? "," : "", (o == 7 && d == 4) ? "2.5" : (o == d ? "9" : "0"));
+        }
+        fprintf(f, "\n");
+    }
+    fclose(f);
+    double *od = gw_traffic_load_od(TEST_OD_FILE, perfil.num_floors);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(od);
+    CU_ASSERT_PTR_NULL(gw_traffic_load_od(TEST_OD_FILE, perfil.num_floors + 1));
+    perfil.od_matrix = od;
+    CU_ASSERT_TRUE(gw_traffic_parse_phases(&perfil, "0:od:20"));
+    gw_traffic_generator_t *g = gw_traffic_create(&perfil, TEST_SEED, 0);
+    free(od); // El generador guarda su propia copia
+    CU_ASSERT_PTR_NOT_NULL_FATAL(g);
+    bool solo_od = true;
+    int viajes = 0;
+    peticion_simulacion_t p;
+    while (gw_traffic_next(g, &p)) {
+        viajes++;
+        solo_od = solo_od && (p.tipo == PETICION_LLAMADA_PISO
+                                  ? p.piso_origen == 7 && p.direccion == MOVING_DOWN
+                                  : p.piso_destino == 4);
+    }
+    gw_traffic_destroy(g);
+    CU_ASSERT_TRUE(solo_od);
+    CU_ASSERT_TRUE(viajes > 0);
+
+    // Sin viajes posibles el perfil se rechaza
+    perfil.num_floors = 2;
+    perfil.lobby_floor = 0;
+    perfil.od_matrix = NULL;
+    CU_ASSERT_TRUE(gw_traffic_parse_phases(&perfil, "0:inter-floor:20"));
+    bool rechazado = gw_traffic_create(&perfil, TEST_SEED, 0) == NULL;
+    CU_ASSERT_TRUE(rechazado);
+
+    char details[256];
+    snprintf(details, sizeof(details), "subida desde el acceso: %s, bajada al acceso: %s, entre plantas sin acceso: %s, matriz 7->4: %s, sin viajes rechazado: %s",
+             subida.origen_acceso ? "sí" : "no", bajada.destino_acceso ? "sí" : "no",
+             entre.sin_acceso ? "sí" : "no", solo_od ? "sí" : "no", rechazado ? "sí" : "no");
+    write_test_result("test_traffic_patterns",
+                      "Subida, bajada, entre plantas y matriz origen/destino generan solo sus viajes",
+                      subida.origen_acceso && bajada.destino_acceso && entre.sin_acceso && solo_od && rechazado, details);
+}
+
+/**
+ * @brief Prueba: tasas de llegada, tamaño de grupo y fases
+ */
+void test_traffic_rates_and_phases(void) {
+    gw_traffic_profile_t perfil;
+    gw_traffic_profile_defaults(&perfil);
+    perfil.duration_ms = 3600000;
+    perfil.mean_group_size = 3.0;
+    CU_ASSERT_TRUE(gw_traffic_parse_phases(&perfil, "0:mixed:60"));
+
+    // 3600 llegadas esperadas: la desviación típica es 60, se admiten 5
+    resumen_trafico_t r = resumir(&perfil, TEST_SEED, 0);
+    bool tasa_ok = abs(r.llamadas - 3600) < 300;
+    double media_grupo = r.llamadas ? (double)r.pasajeros / r.llamadas : 0.0;
+    bool grupo_ok = fabs(media_grupo - 3.0) < 0.15;
+    CU_ASSERT_TRUE(tasa_ok);
+    CU_ASSERT_TRUE(grupo_ok);
+
+    // Fase sin llegadas entre 600 s y 1200 s; la subida de después sale del acceso
+    CU_ASSERT_TRUE(gw_traffic_parse_phases(&perfil, "0:down-peak:30,600:mixed:0,1200:up-peak:30"));
+    perfil.duration_ms = 1800000;
+    perfil.boarding_ms = 1000;
+    gw_traffic_generator_t *g = gw_traffic_create(&perfil, TEST_SEED, 1);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(g);
+    bool hueco = true, fases_ok = true;
+    peticion_simulacion_t p;
+    while (gw_traffic_next(g, &p)) {
+        if (p.tipo != PETICION_LLAMADA_PISO) {
+            continue;
+        }
+        hueco = hueco && (p.instante_ms < 600000 || p.instante_ms >= 1200000);
+        fases_ok = fases_ok && (p.instante_ms < 600000 ? p.direccion == MOVING_DOWN
+                                                       : p.piso_origen == perfil.lobby_floor);
+    }
+    gw_traffic_destroy(g);
+    CU_ASSERT_TRUE(hueco);
+    CU_ASSERT_TRUE(fases_ok);
+
+    // Especificaciones inválidas no modifican el perfil
+    bool invalidas = !gw_traffic_parse_phases(&perfil, "10:mixed:5") &&
+                     !gw_traffic_parse_phases(&perfil, "0:mixed:5,0:up-peak:5") &&
+                     !gw_traffic_parse_phases(&perfil, "0:sideways:5") &&
+                     !gw_traffic_parse_phases(&perfil, "0:mixed:-1") &&
+                     !gw_traffic_parse_phases(&perfil, "0:mixed:5,") &&
+                     perfil.num_phases == 3;
+    CU_ASSERT_TRUE(invalidas);
+
+    char details[256];
+    snprintf(details, sizeof(details), "llegadas en 1 h a 60/min: %d, pasajeros por grupo: %.2f, fase vacía respetada: %s, cambio de patrón: %s",
+             r.llamadas, media_grupo, hueco ? "sí" : "no", fases_ok ? "sí" : "no");
+    write_test_result("test_traffic_rates_and_phases",
+                      "La tasa y el tamaño de grupo siguen el perfil y cada fase aplica su tasa y patrón",
+                      tasa_ok && grupo_ok && hueco && fases_ok && invalidas, details);
+}
+
+/**
+ * @brief Acción de prueba: cuenta peticiones y comprueba el orden temporal
+ */
+static int entregadas = 0;
+static bool entregas_ordenadas = true;
+static uint64_t ultima_entrega_ms = 0;
+
+static void contar_peticion(gw_sim_queue_t *cola, const gw_sim_event_t *evento) {
+    const peticion_simulacion_t *p = evento->arg;
+    entregas_ordenadas = entregas_ordenadas && evento->value == entregadas &&
+                         evento->time_ms == 5000 + p->instante_ms && evento->time_ms >= ultima_entrega_ms;
+    ultima_entrega_ms = evento->time_ms;
+    entregadas++;
+    (void)cola;
+}
+
+/**
+ * @brief Prueba: inyección en la cola de eventos y volcado al formato binario
+ */
+void test_traffic_queue_and_binary(void) {
+    gw_traffic_profile_t perfil;
+    gw_traffic_profile_defaults(&perfil);
+    perfil.duration_ms = 900000;
+    CU_ASSERT_TRUE(gw_traffic_parse_phases(&perfil, "0:up-peak:40,300:inter-floor:20"));
+    resumen_trafico_t r = resumir(&perfil, TEST_SEED, 5);
+
+    // La cola solo contiene la próxima petición de cada generador
+    gw_sim_queue_t cola;
+    gw_sim_queue_init(&cola, 5000);
+    gw_traffic_plan_t plan;
+    memset(&plan, 0, sizeof(plan));
+    plan.generator = gw_traffic_create(&perfil, TEST_SEED, 5);
+    plan.building_index = 0;
+    plan.inicio_ms = 5000;
+    plan.accion = contar_peticion;
+    CU_ASSERT_TRUE(gw_traffic_schedule(&cola, &plan));
+    bool cola_corta = gw_sim_queue_size(&cola) == 1;
+    gw_sim_queue_run_until(&cola, UINT64_MAX);
+    gw_sim_queue_free(&cola);
+    gw_traffic_destroy(plan.generator);
+    bool cola_ok = cola_corta && entregas_ordenadas && entregadas == r.llamadas + r.cabinas;
+    CU_ASSERT_TRUE(cola_ok);
+
+    // Dos edificios al formato binario; la carga devuelve las mismas peticiones
+    gw_scenario_bin_writer_t *w = gw_scenario_bin_writer_open(TEST_BIN_FILE, 2000);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(w);
+    bool escrito = true;
+    for (int b = 0; b < 2 && escrito; ++b) {
+        char id[16];
+        snprintf(id, sizeof(id), "T%02d", b);
+        escrito = gw_scenario_bin_writer_building(w, id);
+        gw_traffic_generator_t *g = gw_traffic_create(&perfil, TEST_SEED, (uint64_t)b);
+        peticion_simulacion_t p;
+        while (escrito && gw_traffic_next(g, &p)) {
+            escrito = gw_scenario_bin_writer_request(w, &p);
+        }
+        gw_traffic_destroy(g);
+    }
+    escrito = gw_scenario_bin_writer_close(w, escrito);
+    CU_ASSERT_TRUE(escrito);
+
+    datos_simulacion_t datos;
+    memset(&datos, 0, sizeof(datos));
+    bool cargado = escrito && cargar_datos_simulacion(TEST_BIN_FILE, &datos) && datos.num_edificios == 2;
+    bool iguales = cargado;
+    for (int b = 0; iguales && b < 2; ++b) {
+        gw_traffic_generator_t *g = gw_traffic_create(&perfil, TEST_SEED, (uint64_t)b);
+        peticion_simulacion_t p;
+        int k = 0;
+        while (iguales && gw_traffic_next(g, &p)) {
+            const peticion_simulacion_t *q = &datos.edificios[b].peticiones[k++];
+            iguales = k <= datos.edificios[b].num_peticiones && q->tipo == p.tipo &&
+                      q->instante_ms == p.instante_ms && q->tiene_instante && q->pasajeros == p.pasajeros &&
+                      (p.tipo == PETICION_LLAMADA_PISO
+                           ? q->piso_origen == p.piso_origen && q->direccion == p.direccion
+                           : q->indice_ascensor == p.indice_ascensor && q->piso_destino == p.piso_destino);
+        }
+        iguales = iguales && k == datos.edificios[b].num_peticiones;
+        gw_traffic_destroy(g);
+    }
+    liberar_datos_simulacion(&datos);
+    CU_ASSERT_TRUE(iguales);
+
+    char details[256];
+    snprintf(details, sizeof(details), "peticiones entregadas por la cola: %d de %d (orden: %s), binario: %s, equivalente: %s",
+             entregadas, r.llamadas + r.cabinas, entregas_ordenadas ? "sí" : "no",
+             escrito ? "escrito" : "fallido", iguales ? "sí" : "no");
+    write_test_result("test_traffic_queue_and_binary",
+                      "El plan de tráfico entrega cada petición en su instante y el volcado binario se carga igual",
+                      cola_ok && escrito && iguales, details);
+}
+
+/**
+ * @brief Limpia y cierra el archivo de reporte
+ */
+void close_report_file(void) {
+    if (report_file) {
+        fprintf(report_file, "=== FIN DEL REPORTE ===\n");
+        fclose(report_file);
+        report_file = NULL;
+    }
+}
+
+/**
+ * @brief Configura la suite de pruebas del generador de tráfico
+ * @return Puntero a la suite configurada, o NULL si hay error
+ */
+CU_pSuite add_traffic_generator_tests(void) {
+    CU_pSuite suite = CU_add_suite("Traffic Generator Tests",
+                                   setup_traffic_generator_tests,
+                                   teardown_traffic_generator_tests);
+
+    if (suite == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(suite, "test_traffic_determinism", test_traffic_determinism) == NULL ||
+        CU_add_test(suite, "test_traffic_patterns", test_traffic_patterns) == NULL ||
+        CU_add_test(suite, "test_traffic_rates_and_phases", test_traffic_rates_and_phases) == NULL ||
+        CU_add_test(suite, "test_traffic_queue_and_binary", test_traffic_queue_and_binary) == NULL) {
+        return NULL;
+    }
+
+    return suite;
+}
+
+// Main para ejecutar solo estas pruebas
+int main(int argc, char *argv[]) {
+    bool automated = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--automated") == 0) {
+            automated = true;
+        }
+    }
+
+    if (CU_initialize_registry() != CUE_SUCCESS) {
+        return CU_get_error();
+    }
+
+    if (add_traffic_generator_tests() == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    if (automated) {
+        CU_automated_run_tests();
+        CU_list_tests_to_file();
+    } else {
+        CU_basic_set_mode(CU_BRM_VERBOSE);
+        CU_basic_run_tests();
+    }
+
+    close_report_file();
+
+    printf("\n=== RESUMEN DE PRUEBAS: GENERADOR DE TRÁFICO ===\n");
+    printf("Pruebas ejecutadas: %u\n", CU_get_number_of_tests_run());
+    printf("Fallos: %u\n", CU_get_number_of_failures());
+    printf("Reporte detallado guardado en: test_traffic_generator_report.txt\n");
+
+    CU_cleanup_registry();
+    return (CU_get_number_of_failures() == 0) ? 0 : 1;
+}